@@ -50,8 +50,10 @@ void createMemoryInfoTable(
 )
 {
   uint64_t   *MemoryInfoTable;
+  uint32_t   mem_info_end_index = 1; //Additional index for mem alloc to store the end value
   MemoryInfoTable = val_aligned_alloc(SIZE_4K, sizeof(MEMORY_INFO_TABLE)
-                    + (PLATFORM_OVERRIDE_MEMORY_ENTRY_COUNT * sizeof(MEM_INFO_BLOCK)));
+                    + ((PLATFORM_OVERRIDE_MEMORY_ENTRY_COUNT + mem_info_end_index)
+                    * sizeof(MEM_INFO_BLOCK)));
   val_memory_create_info_table(MemoryInfoTable);
 }
 
@@ -94,6 +96,7 @@ createGicInfoTable(
                     + ((PLATFORM_OVERRIDE_GICITS_COUNT
                     + PLATFORM_OVERRIDE_GICC_GICRD_COUNT + PLATFORM_OVERRIDE_GICR_GICRD_COUNT
                     + PLATFORM_OVERRIDE_GICC_COUNT + PLATFORM_OVERRIDE_GICD_COUNT
+                    + PLATFORM_OVERRIDE_GICH_COUNT + PLATFORM_OVERRIDE_GICMSIFRAME_COUNT
                     + gic_info_end_index) * sizeof(GIC_INFO_ENTRY)));
 
     Status = val_gic_create_info_table(GicInfoTable);
@@ -149,7 +152,8 @@ createPeripheralInfoTable(
     val_peripheral_create_info_table(PeripheralInfoTable);
 
     MemoryInfoTable = val_aligned_alloc(SIZE_4K, sizeof(MEMORY_INFO_TABLE)
-                        + (PLATFORM_OVERRIDE_MEMORY_ENTRY_COUNT * sizeof(MEM_INFO_BLOCK)));
+                        + ((PLATFORM_OVERRIDE_MEMORY_ENTRY_COUNT + per_info_end_index)
+                            * sizeof(MEM_INFO_BLOCK)));
     val_memory_create_info_table(MemoryInfoTable);
 }
 
@@ -244,8 +248,8 @@ createPccInfoTable(
 {
     uint64_t      *PccInfoTable;
 
-    PccInfoTable = val_aligned_alloc(SIZE_4K,
-                                        PLATFORM_PCC_SUBSPACE_COUNT * sizeof(PCC_INFO));
+    PccInfoTable = val_aligned_alloc(SIZE_4K, sizeof(PCC_INFO_TABLE)
+                                        + PLATFORM_PCC_SUBSPACE_COUNT * sizeof(PCC_INFO));
     val_pcc_create_info_table(PccInfoTable);
 }
 
@@ -85,8 +85,16 @@ acs_load_execution_policy_defaults(acs_execution_policy_t *policy)
       policy->pcie_p2p = defaults->pcie_p2p;
       policy->pcie_cache_present = defaults->pcie_cache_present;
       policy->pcie_skip_dp_nic_ms = defaults->pcie_skip_dp_nic_ms;
+      policy->pcie_cfg_cache = defaults->pcie_cfg_cache;
+      policy->pcie_enum_prune = defaults->pcie_enum_prune;
+      policy->pcie_bf_parallel = defaults->pcie_bf_parallel;
       policy->print_level = defaults->print_level;
       policy->print_mmio = defaults->print_mmio;
+      policy->mmio_record = defaults->mmio_record;
+      policy->binary_log = defaults->binary_log;
+      policy->pe_resident = defaults->pe_resident;
+      policy->rule_profile = defaults->rule_profile;
+      policy->rule_parallel = defaults->rule_parallel;
       policy->timeout_pass = defaults->timeout_pass;
       policy->timeout_fail = defaults->timeout_fail;
       policy->timer_timeout_us = defaults->timer_timeout_us;
@@ -103,6 +111,14 @@ acs_load_execution_policy_defaults(acs_execution_policy_t *policy)
   policy->pcie_p2p = platform_defaults->pcie_p2p;
   policy->pcie_cache_present = platform_defaults->pcie_cache_present;
   policy->pcie_skip_dp_nic_ms = platform_defaults->pcie_skip_dp_nic_ms;
+  policy->pcie_cfg_cache = platform_defaults->pcie_cfg_cache;
+  policy->pcie_enum_prune = platform_defaults->pcie_enum_prune;
+  policy->pcie_bf_parallel = platform_defaults->pcie_bf_parallel;
+  policy->mmio_record = platform_defaults->mmio_record;
+  policy->binary_log = platform_defaults->binary_log;
+  policy->pe_resident = platform_defaults->pe_resident;
+  policy->rule_profile = platform_defaults->rule_profile;
+  policy->rule_parallel = platform_defaults->rule_parallel;
   policy->crypto_support = platform_defaults->crypto_support;
   policy->sys_last_lvl_cache = platform_defaults->sys_last_lvl_cache;
   policy->el1skiptrap_mask = platform_defaults->el1skiptrap_mask;
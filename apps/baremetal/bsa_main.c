@@ -232,7 +232,8 @@ ShellAppMainbsa()
     if (acs_is_module_enabled(PE))
         createSmbiosInfoTable();
 
-    val_allocate_shared_mem();
+    if (val_allocate_shared_mem() != ACS_STATUS_PASS)
+        goto exit_acs;
 
     /* Initialise exception vector, so any unexpected exception gets handled
     *  by default exception handler.
@@ -251,6 +252,10 @@ ShellAppMainbsa()
                 return -1;
             }
 
+            /* Record MMIO accesses of the run for offline analysis */
+            if (acs_policy_get_mmio_record())
+                pal_mmio_record_start(acs_policy_get_mmio_record());
+
             /* Run rule based test orchestrator */
             run_tests(ctx);
     } else {
@@ -263,7 +268,9 @@ print_test_status:
     val_print_acs_test_status_summary();
     val_print(INFO, "\n      *** BSA tests complete. Reset the system. ***\n\n");
 exit_acs:
+    pal_mmio_record_dump();
     freeAcsMeM();
+    pal_heap_print_stats();
     /* Release any request-owned CLI/EL3 selection lists before leaving ACS. */
     acs_release_run_request(ctx);
 
@@ -247,7 +247,8 @@ ShellAppMainpcbsa(void)
 
     createDmaInfoTable();
     createSmbiosInfoTable();
-    val_allocate_shared_mem();
+    if (val_allocate_shared_mem() != ACS_STATUS_PASS)
+        goto exit_acs;
 
 
     if ((ctx->rule_count > 0 && ctx->rule_list != NULL) || (ctx->arch_selection != ARCH_NONE)) {
@@ -259,6 +260,10 @@ ShellAppMainpcbsa(void)
             return -1;
         }
 
+        /* Record MMIO accesses of the run for offline analysis */
+        if (acs_policy_get_mmio_record())
+            pal_mmio_record_start(acs_policy_get_mmio_record());
+
         /* Run rule based test orchestrator */
         run_tests(ctx);
     } else {
@@ -272,7 +277,9 @@ print_test_status:
     val_print(INFO, "\n      *** PC BSA tests complete. Reset the system. ***\n\n");
 
 exit_acs:
+    pal_mmio_record_dump();
     freeAcsMem();
+    pal_heap_print_stats();
     /* Release any request-owned CLI/EL3 selection lists before leaving ACS. */
     acs_release_run_request(ctx);
 
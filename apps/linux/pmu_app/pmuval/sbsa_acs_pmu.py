@@ -15,19 +15,32 @@
 
 """
 Test SBSA PMU events
+
+The events of all relations are packed into counter groups that fit the PMU
+of the CPU, and the groups are counted together over one workload window.
+Groups the kernel could not schedule in that window are counted again in a
+window of their own. With --cpus, one worker per CPU runs in parallel.
 """
 
 from __future__ import print_function
 
-import os, sys, subprocess, argparse
+import os, sys, subprocess, argparse, multiprocessing
 
 import pysweep
 from pyperf.perf_enum import *
 from pyperf.perf_attr import *
 import pyperf.perf_util as perf_util
+import pyperf.perf_sysfs as perf_sysfs
 import pyperf.perf_events as pp
 
 g_workload = None
+g_cpu = None        # CPU of this worker with --cpus, else None
+
+# Arm PMUv3 counts CPU_CYCLES on the dedicated cycle counter, so it doesn't
+# take a general-purpose counter in a group.
+EV_CPU_CYCLES = 0x11
+EV_INST_RETIRED = 0x08
+MAX_PROBE_COUNTERS = 32
 
 
 def ecode(s):
@@ -37,6 +50,9 @@ def ecode(s):
 
 parser = argparse.ArgumentParser(description="test relationships between PMU events")
 parser.add_argument("-a", "--all-cpus", action="store_true", help="collect on all CPUs")
+parser.add_argument("--cpus", type=perf_util.cpusetstr_list, help="test on these CPUs in parallel, e.g. 0-3")
+parser.add_argument("--counters", type=int, help="counters per group (default: from sysfs, else probed)")
+parser.add_argument("--window-groups", type=int, default=0, help="counter groups per workload window (default: all)")
 parser.add_argument("--sleep", type=float, default=0.1, help="time to wait")
 parser.add_argument("--data", type=perf_util.str_memsize, help="use a data working set as the workload")
 parser.add_argument("--data-dispersion", type=int, help="expansion factor for data working set")
@@ -49,7 +65,6 @@ parser.add_argument("command", nargs=argparse.REMAINDER, help="command to execut
 
 opts = parser.parse_args([])
 
-total = [0, 0, 0]
 
 class BadEvent(Exception):
     pass
@@ -78,8 +93,6 @@ class EventProperty:
 
 class Relation(EventProperty):
     def __init__(self):
-        self.n_tests = 0
-        self.n_fails = 0
         self.sup = None       # The event code.
         self.reason = None    # Event description
         self.rule = None      # SBSA rule ID assosiated with event
@@ -124,7 +137,7 @@ def read_relations():
             continue
         yield r
 
-def open_event(en, group=None, enabled=True):
+def open_event(en, group=None, enabled=True, leader=False, weak=True):
     """
     Open a hardware PMU event to monitor the workload.
 
@@ -132,24 +145,30 @@ def open_event(en, group=None, enabled=True):
      - we don't have privilege
      - we're on an inappropriate target that doesn't support this hardware event code
      - we are opening as a group member, and haven't got enough physical counters
+
+    A group leader (leader=True) reads the values of the whole group. Without
+    weak=True, a member that doesn't fit in the group raises ValueError
+    instead of being opened on its own.
     """
     if opts.all_cpus:
         pid = -1
-        cpu = 0
+        cpu = g_cpu if g_cpu is not None else 0
     else:
         pid = g_workload.pid
         cpu = -1
     # Tool verbosity=1: no event messages; tool verbosity=2 (-vv), minimal event messages
     event_verbose = max(0, (opts.verbose - 1))
     rf = PERF_FORMAT_TOTAL_TIME_RUNNING|PERF_FORMAT_TOTAL_TIME_ENABLED
+    if leader or group is not None:
+        rf |= PERF_FORMAT_GROUP
     attr = PerfEventAttr(type=PERF_TYPE_RAW, config=en, read_format=rf, exclude_kernel=False, inherit=True)
-    flags = pp.PERF_FLAG_WEAK_GROUP
+    flags = pp.PERF_FLAG_WEAK_GROUP if weak else 0
     e = None
     try:
         if event_verbose:
             print("open_event: %s" % attr)
-        if group is not None:
-            print("  in group: %s" % group)
+            if group is not None:
+                print("  in group: %s" % group)
         e = pp.Event(attr, pid=pid, cpu=cpu, enabled=enabled, group=group, verbose=event_verbose, flags=flags)
     except OSError:
         print("** could not open hardware performance event - retrying as userspace only", file=sys.stderr)
@@ -160,30 +179,6 @@ def open_event(en, group=None, enabled=True):
     return e
 
 
-class Monitor:
-    """
-    Set up the events to monitor a relationship.
-    """
-    def __init__(self, r, x):
-        self.r = r
-        self.x = x
-        self.supe = open_event(r.sup, enabled=False)
-
-    def enable(self):
-        self.supe.enable()   # Enable the group
-        return self
-
-    def read(self):
-        return Witness(self)
-
-    def disable(self):
-        self.supe.disable()  # Disable the group
-        return self
-
-    def close(self):
-        self.supe.close()
-        return self
-
 def read_events_values(el):
     """
     Read a set of values from a list of events. The first event may be a
@@ -200,32 +195,133 @@ def read_events_values(el):
     values += [e.read().value for e in el[ix:]]
     return values
 
-class Witness:
+
+def probe_counters():
+    """
+    The kernel refuses to open a group that can't be scheduled on the PMU as
+    a whole, so the largest group of INST_RETIRED events that opens gives the
+    number of general-purpose counters.
+    """
+    group = []
+    try:
+        while len(group) < MAX_PROBE_COUNTERS:
+            leader = group[0] if group else None
+            group.append(open_event(EV_INST_RETIRED, group=leader, enabled=False,
+                                    leader=(leader is None), weak=False))
+    except ValueError:
+        pass
+    for e in reversed(group):
+        e.close()
+    return max(1, len(group))
+
+
+def pmu_counters():
+    """
+    Counters available for one group: --counters, else the number the PMU
+    driver publishes in sysfs, else probed.
+    """
+    if opts.counters:
+        return opts.counters
+    pmu_name = perf_sysfs.cpu_pmu_name(g_cpu if g_cpu is not None else 0)
+    if pmu_name is not None:
+        n = perf_sysfs.SysPMU(pmu_name).num_counters()
+        if n:
+            return n
+    return probe_counters()
+
+
+def plan_groups(events, n_counters):
+    """
+    Pack event codes into groups of at most n_counters events.
+    CPU_CYCLES joins the first group on top of the general-purpose counters.
+    """
+    groups = []
+    group = []
+    for en in events:
+        if en == EV_CPU_CYCLES:
+            continue
+        if len(group) == n_counters:
+            groups.append(group)
+            group = []
+        group.append(en)
+    if group:
+        groups.append(group)
+    if EV_CPU_CYCLES in events:
+        if groups:
+            groups[0].append(EV_CPU_CYCLES)
+        else:
+            groups.append([EV_CPU_CYCLES])
+    return groups
+
+
+class CounterGroup:
     """
-    Take a reading from a monitor, to get a set of event values to check against the relationship.
+    Events counted together as one perf group. An event that doesn't fit on
+    the PMU with the rest of the group is left in 'rejected' for another
+    group; an event the PMU doesn't support at all is in 'unsupported'.
     """
-    def __init__(self, m):
-        self.m = m
-        self.read()
+    def __init__(self, events):
+        self.events = []
+        self.members = []
+        self.rejected = []
+        self.unsupported = []
+        for en in events:
+            try:
+                if self.members:
+                    e = open_event(en, group=self.members[0], enabled=False, weak=False)
+                else:
+                    e = open_event(en, enabled=False, leader=True)
+            except ValueError:
+                if self.members and self.fits_alone(en):
+                    self.rejected.append(en)
+                else:
+                    self.unsupported.append(en)
+                continue
+            self.events.append(en)
+            self.members.append(e)
+
+    def counters(self):
+        # General-purpose counters the group took
+        return len([en for en in self.events if en != EV_CPU_CYCLES])
+
+    def fits_alone(self, en):
+        try:
+            open_event(en, enabled=False).close()
+        except ValueError:
+            return False
+        return True
+
+    def enable(self):
+        if self.members:
+            self.members[0].enable()    # Enable the group
+        return self
+
+    def disable(self):
+        if self.members:
+            self.members[0].disable()   # Disable the group
+        return self
+
     def read(self):
-        vs = read_events_values([self.m.supe])
-        self.sup_value = vs[0]
-        total[self.m.x] = self.sup_value
-        self.ok = self.accepts()
+        """
+        Return {event: count}. The count is None if the group was never
+        scheduled, and 0 for unsupported events.
+        """
+        values = dict((en, 0) for en in self.unsupported)
+        if self.members:
+            values.update(zip(self.events, read_events_values(self.members)))
+        return values
+
+    def close(self):
+        for e in reversed(self.members):
+            e.close()
+        self.members = []
         return self
 
-    def accepts(self):
-        if opts.scaling:
-            if x == 2:
-                return self.m.r.accepts(total)
-            else :
-                return 1
-        else: 
-            return self.m.r.accepts(total)
 
 class Workload:
     def __init__(self):
-        self.pid = None
+        self.pid = os.getpid()
+        self.load = None
 
     def prepare(self):
         if opts.data or opts.code:
@@ -239,6 +335,11 @@ class Workload:
         else:
             self.pid = os.getpid()
 
+    def finish(self):
+        if self.load is not None:
+            self.load.stop()
+            self.load = None
+
     def run(self):
         if opts.verbose:
             print("reltest: run")
@@ -260,56 +361,122 @@ class Workload:
             # Just sleep for the --sleep duration, e.g. to pick up background system activity
             pysweep.sleep(opts.sleep)
 
-def test_relation(r,x):
+def run_window(groups, x):
     """
-    Test a relationship between events. Because each relationship involves a specific
-    set of events and these all need to be counted at the same time, we run a separate
-    test for each relationship, with just those events configured.
+    Count groups of events over one workload window.
+    Return ({event: count}, [events left out of their group], counters), where
+    counters is the size of the smallest group that had to leave events out.
     """
-
     if opts.scaling:
         opts.data = (x + 1) * 100
         opts.code = (x + 1) * 100
 
     g_workload.prepare()
-    m = Monitor(r, x)
-    m.enable()
+    cgs = [CounterGroup(events) for events in groups]
+    for cg in cgs:
+        cg.enable()
     g_workload.run() # Dynamic code & data gen
     if opts.scaling:
         pysweep.br_pred(opts.data)
     else:
         pysweep.br_pred(1);
-    m.disable()
-    w = m.read()
-    m.close()
-
-    if opts.scaling:
-        if x == 2:  # Update test count on third itration
-            r.n_tests += 1
-            if not w.ok:
-                r.n_fails += 1
-            show_witness(w)
-    else:
-        r.n_tests += 1
-        if not w.ok:
-            r.n_fails += 1
-        show_witness(w)
+    values = {}
+    rejected = []
+    counters = None
+    for cg in cgs:
+        cg.disable()
+    for cg in cgs:
+        values.update(cg.read())
+        if cg.rejected:
+            rejected += cg.rejected
+            counters = min(counters or cg.counters(), cg.counters())
+        cg.close()
+    g_workload.finish()
+    if opts.verbose:
+        print("reltest: window of %u groups, %u events" % (len(groups), len(values)))
+    return (values, rejected, counters)
+
+
+def count_events(events, n_counters, x):
+    """
+    Count every event once: all planned groups share workload windows, up to
+    --window-groups per window. Events that didn't fit in their group are
+    planned again, and groups the kernel multiplexed out of a shared window
+    get windows of their own. Events never counted read as 0. If the groups were planned for more
+    counters than the PMU has free, the size of the groups that did open is
+    used for the rest of the plan.
+    """
+    counts = dict((en, 0) for en in events)
+    per_window = opts.window_groups if opts.window_groups > 0 else None
+    pending = plan_groups(events, n_counters)
+    solo = []
+    while pending:
+        n = per_window or len(pending)
+        (window, pending) = (pending[:n], pending[n:])
+        (values, rejected, counters) = run_window(window, x)
+        if counters:
+            n_counters = max(1, counters)
+        missed = [en for en in values if values[en] is None]
+        if len(window) > 1:
+            solo += plan_groups(missed, n_counters)
+        counts.update((en, v) for (en, v) in values.items() if v is not None)
+        pending += plan_groups(rejected, n_counters)
+    for group in solo:
+        (values, rejected, _) = run_window([group], x)
+        counts.update((en, v) for (en, v) in values.items() if v is not None)
+        for en in rejected:
+            (values, _, _) = run_window([[en]], x)
+            counts.update((en, v) for (en, v) in values.items() if v is not None)
+    return counts
+
+
+def test_relations(rels):
+    """
+    Test all relations on this CPU. Events are shared between relations,
+    so each distinct event is counted once per scaling step.
+    Return a (counts, ok) pair per relation.
+    """
+    events = []
+    for r in rels:
+        if r.sup not in events:
+            events.append(r.sup)
+    n_counters = pmu_counters()
+    if opts.verbose:
+        print("reltest: %u events, %u counters per group" % (len(events), n_counters))
+
+    steps = range(0, 3) if opts.scaling else [0]
+    counts = [count_events(events, n_counters, x) for x in steps]
+    results = []
+    for r in rels:
+        vsub = [c[r.sup] for c in counts]
+        results.append((vsub, r.accepts(vsub)))
+    return results
+
+
+def cpu_worker(args):
+    """
+    Test the relations with the workload and this process pinned to one CPU.
+    """
+    global g_cpu, g_workload
+    (cpu, rels) = args
+    g_cpu = cpu
+    if hasattr(os, "sched_setaffinity"):
+        os.sched_setaffinity(0, [cpu])
+    pysweep.setaffinity([cpu])
+    g_workload = Workload()
+    return test_relations(rels)
 
-    return w.ok
 
-def show_witness(w):
-    # Print more detail about how these values contradict the relationship.
-    # (Or perhaps not - when verbose, we also show this for all tests.)
-    r = w.m.r
+def show_result(r, vsub, ok):
     if opts.scaling:
-        print(" Rule : %s, event : %04x, count[%08u,%08u,%08u]" % (r.rule, r.sup, total[0], total[1], total[2]), end="")
+        print(" Rule : %s, event : %04x, count[%08u,%08u,%08u]" % (r.rule, r.sup, vsub[0], vsub[1], vsub[2]), end="")
     else :
-        print(" Rule : %s, event : %04x, count[%08u]" % (r.rule, r.sup, total[0]), end="")
+        print(" Rule : %s, event : %04x, count[%08u]" % (r.rule, r.sup, vsub[0]), end="")
 
     string_revised=r.reason.ljust(30)
     print("  %s" % (string_revised), end="")
 
-    if not w.ok:
+    if not ok:
         print(" :FAIL")
     else:
         print(" :PASS")
@@ -331,18 +498,23 @@ if __name__ == "__main__":
     print("")
     
     for i in range(opts.repeat):
-        for r in rels:
-            total[0] = 0
-            total[1] = 0
-            total[2] = 0
-            if opts.scaling:
-                for x in range(0, 3):
-                    test_relation(r, x)
-            else:
-                test_relation(r, 0)
-
-            total_tests += r.n_tests
-            total_fails += r.n_fails
+        if opts.cpus:
+            # One worker per CPU; results are printed in CPU order
+            pool = multiprocessing.Pool(len(opts.cpus))
+            results = pool.map(cpu_worker, [(cpu, rels) for cpu in opts.cpus])
+            pool.close()
+            pool.join()
+        else:
+            results = [test_relations(rels)]
+
+        for (cpu, res) in zip(opts.cpus or [None], results):
+            if cpu is not None:
+                print(" CPU %u" % cpu)
+            for (r, (vsub, ok)) in zip(rels, res):
+                total_tests += 1
+                if not ok:
+                    total_fails += 1
+                show_result(r, vsub, ok)
 
         print("----------------------------------------------------------")
         print(" Total tets: %d , Total Passed: %d, Total Failed: %d" % (total_tests, (total_tests - total_fails), total_fails))
@@ -18,13 +18,26 @@ Bridge between ARM SPE and perf.
 
 Currently this module provides a function to translate ARM SPE samples (from arm_pe.py)
 into objects that behave like perf.data records (from perf_abi.py).
+
+When the perf_spe extension is built, AUX buffers are decoded in C, in parallel across
+buffers, into columns (see arm_spe_columns()).
 """
 
 from __future__ import print_function
 
 from pyperf.perf_enum import *
 from pyperf.perf_data import *
-import arm_spe
+import array
+
+try:
+    import pyperf.perf_spe as perf_spe
+except ImportError:
+    perf_spe = None
+
+try:
+    import arm_spe
+except ImportError:
+    arm_spe = None      # only needed for packet dumps, or when perf_spe is not built
 
 
 def hw_time_to_kernel_time(t):
@@ -32,6 +45,43 @@ def hw_time_to_kernel_time(t):
     return t
 
 
+# Operation class, in bits 9:8 of the 'op' column
+SPE_OP_CLASS_OTHER        = 0
+SPE_OP_CLASS_LD_ST_ATOMIC = 1
+SPE_OP_CLASS_BR_ERET      = 2
+
+SPE_EV_RETIRED            = 0x02
+
+
+def spe_data_src(is_access, is_store, subclass_bit, data_source):
+    """
+    Make a perf_mem_data_src value for an SPE sample.
+    subclass_bit(n) tests bit n of the Operation Type payload.
+    """
+    ds = 0
+    if is_access:
+        if not is_store:
+            ds |= (PERF_MEM_OP_LOAD << PERF_MEM_OP_SHIFT)
+            if data_source == 0:
+                ds |= ((PERF_MEM_LVL_HIT|PERF_MEM_LVL_L1) << PERF_MEM_LVL_SHIFT)
+            elif data_source == 8:
+                ds |= ((PERF_MEM_LVL_HIT|PERF_MEM_LVL_L2) << PERF_MEM_LVL_SHIFT)
+            elif data_source == 11:
+                ds |= ((PERF_MEM_LVL_HIT|PERF_MEM_LVL_L3) << PERF_MEM_LVL_SHIFT)
+            elif data_source == 13:
+                ds |= (PERF_MEM_REMOTE_REMOTE << PERF_MEM_REMOTE_SHIFT)
+            elif data_source == 14:
+                ds |= ((PERF_MEM_LVL_HIT|PERF_MEM_LVL_LOC_RAM) << PERF_MEM_LVL_SHIFT)
+            else:
+                print("UNKNOWN LEVEL: %u" % data_source)
+        else:
+            ds |= (PERF_MEM_OP_STORE << PERF_MEM_OP_SHIFT)
+        if subclass_bit(1):    # atomic, exclusive etc.
+            if subclass_bit(2) or subclass_bit(3):
+                ds |= (PERF_MEM_LOCK_LOCKED << PERF_MEM_LOCK_SHIFT)
+    return ds
+
+
 class SPERecord:
     """
     This record object is derived from an SPE sample record, and behaves like a PerfData record.
@@ -41,6 +91,8 @@ class SPERecord:
         self.misc = 0
         self.pid = pid
         self.cpu = cpu
+        if p is None:
+            return      # fields set by from_columns()
         self.ip = p.inst_address
         if p.EL > 0:
             self.misc |= PERF_RECORD_MISC_KERNEL
@@ -48,28 +100,82 @@ class SPERecord:
         self.phys_addr = p.phys_address
         self.weight = p.total_latency() - p.issue_latency()
         self.t = hw_time_to_kernel_time(p.timestamp)
-        ds = 0
-        if p.op.is_access():
-            if not p.op.is_store():
-                ds |= (PERF_MEM_OP_LOAD << PERF_MEM_OP_SHIFT)
-                if p.data_source == 0:
-                    ds |= ((PERF_MEM_LVL_HIT|PERF_MEM_LVL_L1) << PERF_MEM_LVL_SHIFT)
-                elif p.data_source == 8:
-                    ds |= ((PERF_MEM_LVL_HIT|PERF_MEM_LVL_L2) << PERF_MEM_LVL_SHIFT)
-                elif p.data_source == 11:
-                    ds |= ((PERF_MEM_LVL_HIT|PERF_MEM_LVL_L3) << PERF_MEM_LVL_SHIFT)
-                elif p.data_source == 13:
-                    ds |= (PERF_MEM_REMOTE_REMOTE << PERF_MEM_REMOTE_SHIFT)
-                elif p.data_source == 14:
-                    ds |= ((PERF_MEM_LVL_HIT|PERF_MEM_LVL_LOC_RAM) << PERF_MEM_LVL_SHIFT)
-                else:
-                    print("UNKNOWN LEVEL: %u" % p.data_source)
-            else:
-                ds |= (PERF_MEM_OP_STORE << PERF_MEM_OP_SHIFT)
-            if p.op.subclass_bit(1):    # atomic, exclusive etc.
-                if p.op.subclass_bit(2) or p.op.subclass_bit(3):
-                    ds |= (PERF_MEM_LOCK_LOCKED << PERF_MEM_LOCK_SHIFT)
-        self.data_src = ds
+        self.data_src = spe_data_src(p.op.is_access(), p.op.is_store(), p.op.subclass_bit, p.data_source)
+
+    @classmethod
+    def from_columns(cls, c, i, pid=None, cpu=None):
+        """
+        Make a record from sample i of an SPEColumns.
+        """
+        r = cls(None, pid=pid, cpu=cpu)
+        r.ip = c.pc[i]
+        if c.el[i] > 0:
+            r.misc |= PERF_RECORD_MISC_KERNEL
+        r.addr = c.vaddr[i]
+        r.phys_addr = c.paddr[i]
+        r.weight = c.total_lat[i] - c.issue_lat[i]
+        r.t = hw_time_to_kernel_time(c.timestamp[i])
+        op = c.op[i]
+        r.data_src = spe_data_src((op >> 8) == SPE_OP_CLASS_LD_ST_ATOMIC, (op & 1) != 0,
+                                  lambda n: (op >> n) & 1, c.data_source[i])
+        return r
+
+
+def column_array(data, fmt):
+    # View a column from perf_spe.decode() as an array, without copying where possible
+    try:
+        return memoryview(data).cast(fmt)
+    except (AttributeError, TypeError):
+        a = array.array(fmt)
+        a.fromstring(data)
+        return a
+
+
+class SPEColumns:
+    """
+    SPE samples decoded from a list of PERF_RECORD_AUXTRACE buffers, as one array per field
+    (see src/pyperf_spe.c for the fields). The 'segment' column is the index in 'buffers'
+    of the buffer each sample came from. Convert to numpy with numpy.asarray(c.pc) etc.
+    """
+    formats = {
+        "segment": "I", "timestamp": "Q", "pc": "Q", "el": "B", "vaddr": "Q", "paddr": "Q",
+        "total_lat": "I", "issue_lat": "I", "xlat_lat": "I", "events": "Q", "op": "H",
+        "data_source": "H", "context": "I",
+    }
+
+    def __init__(self, columns, buffers, errors=0):
+        self.buffers = buffers
+        self.errors = errors       # packets the decoder could not decode
+        self.names = sorted(columns.keys())
+        for name in self.names:
+            setattr(self, name, column_array(columns[name], self.formats[name]))
+
+    def __len__(self):
+        return len(self.segment)
+
+    def buffer(self, i):
+        # The PERF_RECORD_AUXTRACE that sample i came from
+        return self.buffers[self.segment[i]]
+
+    def records(self):
+        for i in range(len(self)):
+            b = self.buffer(i)
+            yield SPERecord.from_columns(self, i, pid=getattr(b, "pid", None), cpu=b.cpu)
+
+
+def arm_spe_columns(pd, buffers=None, threads=0, access_only=False):
+    """
+    Decode ARM SPE AUX buffers into an SPEColumns, in parallel across buffers.
+    buffers is a list of PERF_RECORD_AUXTRACE records, by default all those of the file.
+    threads is the number of decoding threads, 0 for one per online CPU.
+    With access_only, only retired loads, stores and atomics are kept.
+    """
+    assert perf_spe is not None, "SPE decoder extension (perf_spe) is not built"
+    if buffers is None:
+        buffers = list(pd.auxtrace_buffers())
+    data = [pd.auxtrace_data(r) for r in buffers]
+    (columns, errors) = perf_spe.decode(data, threads=threads, access_only=access_only)
+    return SPEColumns(columns, buffers, errors)
 
 
 def arm_spe_records(r):
@@ -77,6 +183,12 @@ def arm_spe_records(r):
     From an AUXTRACE record conaining ARM SPE data, yield a series of SPERecords that behave like samples.
     """
     assert r.type == PERF_RECORD_AUXTRACE and r.auxtrace_info_type == PERF_AUXTRACE_ARM_SPE, "expected AUX with ARM SPE data"
+    if perf_spe is not None:
+        (columns, errors) = perf_spe.decode([r.aux_data], threads=1, access_only=True)
+        c = SPEColumns(columns, [r], errors)
+        for i in range(len(c)):
+            yield SPERecord.from_columns(c, i, pid=r.pid, cpu=r.cpu)
+        return
     for p in arm_spe.Decoder().records(bytearray(r.aux_data)):
         if p.op.is_access() and p.is_retired():
             yield SPERecord(p, pid=r.pid, cpu=r.cpu)
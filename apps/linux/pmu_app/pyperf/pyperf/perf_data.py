@@ -34,7 +34,12 @@ import pyperf.perf_buildid as perf_buildid
 from pyperf.hexdump import print_hex_dump
 import pyperf.datamap as datamap
 
-import os, sys, struct, time, copy, platform
+import os, sys, struct, time, copy, platform, mmap
+
+try:
+    import pyperf.perf_records as perf_records
+except ImportError:
+    perf_records = None     # C extension not built: scan_records_py() is used
 
 
 PERF_MAGIC = struct.unpack("Q", b"PERFILE2")[0]
@@ -145,6 +150,78 @@ for s in list(globals()):
         PERF_DATA_RECORD[globals()[s]] = s
 
 
+# Record index entries from the scanner: offset, type, misc, size and the size
+# of the AUX data following a PERF_RECORD_AUXTRACE (see src/pyperf_records.c).
+RECORD_INDEX_FORMAT = "QIHHQ"
+RECORD_INDEX_SIZE = struct.calcsize(RECORD_INDEX_FORMAT)
+SCAN_END       = 0    # reached the end of the buffer
+SCAN_MORE      = 1    # batch is full
+SCAN_TRUNCATED = 2    # last record extends beyond the buffer
+SCAN_INVALID   = 3    # record header with size < 8
+
+
+def scan_records_py(buf, offset=0, end=-1, filter=None, max=4096):
+    """
+    Python version of perf_records.scan(), used when the extension isn't built.
+    Return (index entries, offset after the last record scanned, status).
+    """
+    if end < 0 or end > len(buf):
+        end = len(buf)
+    entries = []
+    status = SCAN_END
+    while offset < end:
+        if end - offset < 8:
+            status = SCAN_TRUNCATED
+            break
+        (type, misc, size) = struct.unpack_from("IHH", buf, offset)
+        aux_size = 0
+        if size < 8 or (type == PERF_RECORD_AUXTRACE and size < 16):
+            status = SCAN_INVALID
+            break
+        if type == PERF_RECORD_AUXTRACE:
+            if end - offset < 16:
+                status = SCAN_TRUNCATED
+                break
+            aux_size = struct.unpack_from("Q", buf, offset+8)[0]
+        if offset + size + aux_size > end:
+            status = SCAN_TRUNCATED
+            break
+        if filter is None or (type < len(filter) and filter[type]):
+            if len(entries) == max:
+                status = SCAN_MORE
+                break
+            entries.append(struct.pack(RECORD_INDEX_FORMAT, offset, type, misc, size, aux_size))
+        offset += size + aux_size
+    return (b"".join(entries), offset, status)
+
+
+if perf_records is not None:
+    scan_records = perf_records.scan
+else:
+    scan_records = scan_records_py
+
+
+def record_index_entries(entries):
+    # Unpack a batch of index entries into (offset, type, misc, size, aux_size) tuples
+    if hasattr(struct, "iter_unpack"):
+        return struct.iter_unpack(RECORD_INDEX_FORMAT, entries)
+    return (struct.unpack_from(RECORD_INDEX_FORMAT, entries, i) for i in range(0, len(entries), RECORD_INDEX_SIZE))
+
+
+def record_type_filter(types):
+    """
+    Build the scanner filter for a collection of record types, or None for all records.
+    PERF_RECORD_COMPRESSED always passes so that its contents can be filtered in turn.
+    """
+    if types is None:
+        return None
+    types = set(types) | set([PERF_RECORD_COMPRESSED])
+    filter = bytearray(max(types) + 1)
+    for t in types:
+        filter[t] = 1
+    return filter
+
+
 def record_type_str(type, short=False):
     if type < FIRST_SYNTHETIC_PERF_RECORD:
         rname = str_PERF_RECORD(type, short=False)
@@ -406,6 +483,7 @@ class PerfData:
         self.kcore_dir = None
         self.auxtrace_info_type = None
         self.auxtrace_buffer_cache = None
+        self.mm = None           # copy-on-write mapping of the file, see mapped()
         # Map the section descriptors. This doesn't read the actual descriptors.
         self.section_attr = PerfFileSection(self, 24)       # Section containing some number of perf_event_attr's
         self.section_data = PerfFileSection(self, 40)
@@ -602,6 +680,12 @@ class PerfData:
         self.need_to_write_headers = False
 
     def close(self):
+        if self.mm is not None:
+            try:
+                self.mm.close()
+            except BufferError:
+                pass     # record views still in use; the mapping goes with the last one
+            self.mm = None
         if self.f is None:
             return
         if self.is_writing:
@@ -973,6 +1057,15 @@ class PerfData:
     def read(self, size):
         return self.f.read(size)      # returns str (Python2) or bytes (Python3)
 
+    def mapped(self):
+        """
+        Return the file mapped copy-on-write, so that records can be sliced out of it
+        (and passed to C code) without copying. None in pipe mode or for an empty file.
+        """
+        if self.mm is None and not self.is_pipe_mode and not self.is_writing and self.file_size:
+            self.mm = mmap.mmap(self.f.fileno(), 0, access=mmap.ACCESS_COPY)
+        return self.mm
+
     def readat(self, offset, size, preserve=False):
         """
         Read data at a given position, and leave the read pointer following the data.
@@ -1044,6 +1137,18 @@ class PerfData:
             r.aux_data = self.readat(r.auxtrace_file_offset, r.auxtrace_size)
         return r
 
+    def auxtrace_data(self, r):
+        """
+        Get the AUX data following a PERF_RECORD_AUXTRACE record: a view of the
+        mapped file where possible, otherwise the data read from the file.
+        """
+        assert r.type == PERF_RECORD_AUXTRACE
+        if getattr(r, "aux_data", None) is not None:
+            return r.aux_data
+        if r.file_offset is not None and self.mapped() is not None:
+            return memoryview(self.mm)[r.auxtrace_file_offset:r.auxtrace_file_offset+r.auxtrace_size]
+        return self.readat(r.auxtrace_file_offset, r.auxtrace_size)
+
     def unpack_record(self, r):
         # Unpack the record fields for kernel records (and some others), including samples
         if r.is_kernel_type():
@@ -1099,9 +1204,15 @@ class PerfData:
             e = h + self.read(size-8)
         except IOError:
             print("** %s: could not read %u-byte payload for record type %u at 0x%x" % (self.fn, size-8, type, eoff))
-        r = PerfDataRecord(e, file=self, file_offset=eoff)
+        return self.condition_record(PerfDataRecord(e, file=self, file_offset=eoff))
+
+    def condition_record(self, r):
+        """
+        Decode the fields that relate a record just read to its AUX data.
+        """
         if r.type == PERF_RECORD_AUXTRACE:
-            r.auxtrace_file_offset = eoff + r.size
+            if r.file_offset is not None:
+                r.auxtrace_file_offset = r.file_offset + r.size
             (r.auxtrace_size, r.auxtrace_offset, r.ref, r.idx, r.tid, r.cpu) = struct.unpack("QQQIii", r.raw[8:44])
         elif r.type == PERF_RECORD_AUX:
             self.unpack_record(r)
@@ -1117,89 +1228,121 @@ class PerfData:
             r.idx = aux_event.id_index(r.id)     # To correspond with PERF_RECORD_AUXTRACE
         return r
 
-    def raw0_records(self, data=True):
+    def record_views(self, types=None, batch=4096):
+        """
+        Iterate over the records of the data section without copying them, yielding
+        (file offset, type, misc, record, aux) where record is a memoryview of the whole
+        record and aux a memoryview of the AUX data following a PERF_RECORD_AUXTRACE
+        (None for other records). The views stay valid while they are referenced.
+        If types is given, other record types are skipped by the scanner, before any
+        Python object is built. Records inside PERF_RECORD_COMPRESSED are decompressed
+        as a stream and filtered the same way; they have no file offset.
+        Not available in pipe mode.
+        """
+        assert self.file_is_valid, "%s: attempt to read records from invalid file" % (self.fn)
+        assert not self.is_pipe_mode, "%s: record views need a seekable file" % (self.fn)
+        filter = record_type_filter(types)
+        offset = self.section_data.offset
+        end = offset + self.section_data.size
+        if self.mapped() is None or end <= offset:
+            return
+        view = memoryview(self.mm)
+        while True:
+            (entries, offset, status) = scan_records(view, offset, end, filter, batch)
+            for (off, type, misc, size, aux_size) in record_index_entries(entries):
+                if type == PERF_RECORD_COMPRESSED:
+                    for (type, misc, rec) in self.decompressed_views(view[off+8:off+size], filter, batch):
+                        yield (None, type, misc, rec, None)
+                elif type == PERF_RECORD_AUXTRACE:
+                    yield (off, type, misc, view[off:off+size], view[off+size:off+size+aux_size])
+                else:
+                    yield (off, type, misc, view[off:off+size], None)
+            if status != SCAN_MORE:
+                break
+        assert status != SCAN_INVALID, "%s: invalid record at file offset 0x%x" % (self.fn, offset)
+        if status == SCAN_TRUNCATED:
+            print("%s: data section truncated at file offset 0x%x" % (self.fn, offset), file=sys.stderr)
+
+    def decompressed_views(self, comp, filter=None, batch=4096):
+        """
+        Decompress the payload of a PERF_RECORD_COMPRESSED record as a stream, yielding
+        (type, misc, record view) for the records in it that pass the scanner filter.
+        Only a record split across two output chunks is copied.
+        """
+        import pyperf.perf_zstd as perf_zstd
+        zstd_magic = struct.unpack_from("I", comp, 0)[0]
+        assert zstd_magic == 0xFD2FB528, "%s: bad Zstd magic: 0x%X" % (self.fn, zstd_magic)
+        carry = b""
+        for chunk in perf_zstd.decompress_stream(comp):
+            buf = carry + chunk if carry else chunk
+            view = memoryview(buf)
+            pos = 0
+            while True:
+                (entries, pos, status) = scan_records(buf, pos, -1, filter, batch)
+                for (off, type, misc, size, aux_size) in record_index_entries(entries):
+                    yield (type, misc, view[off:off+size])
+                if status != SCAN_MORE:
+                    break
+            assert status != SCAN_INVALID, "%s: invalid record in compressed data" % (self.fn)
+            carry = buf[pos:]
+        assert not carry, "%s: compressed data ends inside a record" % (self.fn)
+
+    def raw0_records(self, data=True, types=None):
         """
         Iterate over the records, returning raw PerfRecord objects, in the order they occur in perf.data.
         The only processing and conditioning we do here:
           - get (or skip over) the raw data buffer following PERF_RECORD_AUXTRACE
           - expand PERF_RECORD_COMPRESSED
+        If types is given, only records of those types are returned.
         """
         assert self.file_is_valid, "%s: attempt to read records from invalid file" % (self.fn)
         if not self.is_pipe_mode:
-            eoff = self.section_data.offset
+            # Index the mapped data section and only build records for the ones wanted.
             self.data_end = self.section_data.offset + self.section_data.size
-            self.seek(eoff)
-        else:
-            # Reading from stdin - non-seekable. Or possibly reading from a file saved via a pipe.
-            #if self.f != sys.stdin:
-            #    self.seek(16)
-            eoff = 0 
-            self.data_end = None
+            for (eoff, type, misc, rec, aux) in self.record_views(types=types):
+                r = self.condition_record(PerfDataRecord(bytes(rec), file=self, file_offset=eoff))
+                if r.type == PERF_RECORD_AUXTRACE:
+                    r.aux_data = bytes(aux) if data else None
+                yield r
+            return
+        # Reading from stdin - non-seekable. Or possibly reading from a file saved via a pipe.
+        eoff = 0
+        self.data_end = None
         # Loop through the raw records. Note that a PERF_RECORD_AUXTRACE record will be immediately
         # followed by the contents of an AUX buffer, which we need to account for.
-        itrace_tid = None
-        while self.data_end is None or eoff < self.data_end:
+        while True:
             r = self.read_record(eoff, already_here=True)
-            if r is None and self.is_pipe_mode:
+            if r is None:
                 break
             eoff += r.size
             # if the record has AUX data immediately following, read it now to avoid getting confused about the offset
             if r.type == PERF_RECORD_AUXTRACE:
-                if data or self.is_pipe_mode:
-                    r.aux_data = self.f.read(r.auxtrace_size)
-                else:
-                    r.aux_data = None
-                    self.seek(eoff + r.auxtrace_size)   # Not reading it this time, so step past it
+                r.aux_data = self.f.read(r.auxtrace_size)
                 eoff += r.auxtrace_size
             elif r.type == PERF_RECORD_COMPRESSED:
-                # TBD this section is work-in-progress
-                # We use our perf_zstd module. zstandard/zstd don't seem to work.
-                zstd_magic = struct.unpack("I",r.raw[8:12])[0]
-                assert zstd_magic == 0xFD2FB528, "%s: bad Zstd magic: 0x%X" % (self.fn, zstd_magic)
-                import pyperf.perf_zstd as perf_zstd
-                ucd = perf_zstd.decompress(r.raw[8:], ratio=8)
-                print_hex_dump(ucd)
-                print("decompressed %u bytes to %u bytes" % (len(r.raw)-8, len(ucd)))
-                while len(ucd) > 0:
-                    (type, misc, size) = struct.unpack("IHH", ucd[:8])
-                    e = ucd[:size]
-                    print("uncompressed: %u %u %u" % (type, misc, size))
-                    r = PerfDataRecord(e, file=self)
-                    #print(r)
-                    yield r
-                    ucd = ucd[size:]
+                for (type, misc, rec) in self.decompressed_views(memoryview(r.raw)[8:], record_type_filter(types)):
+                    yield self.condition_record(PerfDataRecord(bytes(rec), file=self))
                 continue
-                # Old abandoned ways
-                try:
-                    import zstandard
-                except:
-                    print("** %s: compressed file needs 'zstandard' module to uncompress" % (self.fn), file=sys.stderr)
-                if False:
-                    ddd = zstd.ZSTD_compress("ABCD",1,4)
-                    print_hex_dump(ddd)
-                    eee = zstd.ZSTD_uncompress(ddd)
-                    print_hex_dump(eee)
-                if True:
-                    print("Compressed data:")
-                    print_hex_dump(r.raw[:32])
-                    fp = zstandard.get_frame_parameters(r.raw[8:])
-                    print("  content size: 0x%x" % (fp.content_size))
-                    print("  window size:  0x%x" % (fp.window_size))
-                max_size = (self.compression_ratio + 1) * len(r.raw)
-                print("trying %u bytes -> %u bytes" % (len(r.raw), max_size))
-                ucd = zstandard.ZstdDecompressor().decompress(r.raw[8:], max_output_size=max_size)
-                print_hex_dump(ucd)
-            yield r
+            if types is None or r.type in types:
+                yield r
 
-    def raw_records(self, event=False, unpack=False, time=False, data=True):
+    def raw_records(self, event=False, unpack=False, time=False, data=True, types=None):
         """
         Iterate over the records, returning raw PerfRecord objects, in the order they occur in perf.data.
 
         This also updates metadata in response to some record types - this is especially important
         in pipe mode when we don't have a proper header.
+        If types is given, only records of those types are returned; the records that carry
+        metadata are still read, but other records are never built.
         """
         pending_aux = {}     # indexed by event ID: AUX records waiting for AUXTRACE
-        for r in self.raw0_records(data=data):
+        wanted = None
+        if types is not None:
+            wanted = set(types)
+            types = wanted | set([PERF_RECORD_HEADER_FEATURE, PERF_RECORD_HEADER_ATTR, PERF_RECORD_AUXTRACE_INFO])
+            if wanted & set([PERF_RECORD_AUX, PERF_RECORD_AUXTRACE]):
+                types |= set([PERF_RECORD_AUX, PERF_RECORD_AUXTRACE, PERF_RECORD_ITRACE_START])
+        for r in self.raw0_records(data=data, types=types):
             if r.type == PERF_RECORD_HEADER_FEATURE:
                 # pipe mode: this supplies a sub-header
                 # Process some record types to add global context that we'd normally get from subheaders.
@@ -1303,9 +1446,11 @@ class PerfData:
             if (not data) and r.file_offset is not None and not self.is_pipe_mode:
                 # If data is not needed now, and we can re-read from disk, discard it to save memory
                 r.raw = None
+            if wanted is not None and r.type not in wanted:
+                continue
             yield r
 
-    def records(self, sorted_time=False, unpack=True, time=True):
+    def records(self, sorted_time=False, unpack=True, time=True, types=None):
         """
         Iterate over the perf records, returning PerfRecord objects.
         These aren't guaranteed to be in time order, as the perf
@@ -1316,6 +1461,7 @@ class PerfData:
         the main mmap is immediately followed by the raw data from the AUX mmap.
         We try to avoid doing too much record processing before sorting -
         instead, we get the time and not much else, then unpack after sorting.
+        If types is given, only records of those types are returned.
         """
         if sorted_time:
             def rectime(r):
@@ -1323,14 +1469,14 @@ class PerfData:
                 if t is None:
                     return 0
                 return t
-            sorted_recs = sorted(list(self.raw_records(unpack=False, time=True, data=False)), key=rectime)
+            sorted_recs = sorted(list(self.raw_records(unpack=False, time=True, data=False, types=types)), key=rectime)
             for r in sorted_recs:
                 self.get_record_data(r)
                 if unpack:
                     self.unpack_record(r)
                 yield r
         else:
-            for r in self.raw_records(event=True, time=time, unpack=unpack):
+            for r in self.raw_records(event=True, time=time, unpack=unpack, types=types):
                 yield r
 
     def reader(self):
@@ -19,7 +19,10 @@ This module interfaces to the PMU event descriptions in sysfs.
 
 from __future__ import print_function
 
-import perf_util as utils
+try:
+    from . import perf_util as utils
+except (ImportError, ValueError):
+    import perf_util as utils     # run as a script, or from the pyperf directory
 
 import os
 
@@ -109,6 +112,37 @@ class SysPMU(object):
         else:
             return None
 
+    def cpus(self):
+        # CPU PMUs of heterogeneous systems list the CPUs they cover.
+        cpus_file = os.path.join(self.pmu_dir, "cpus")
+        if os.path.isfile(cpus_file):
+            return utils.cpusetstr_list(utils.file_word(cpus_file))
+        else:
+            return None
+
+    def caps(self):
+        # Capabilities published by the driver, e.g. "slots" for Arm PMUv3.
+        caps_dir = os.path.join(self.pmu_dir, "caps")
+        caps = {}
+        if os.path.isdir(caps_dir):
+            for p in os.listdir(caps_dir):
+                caps[p] = utils.file_word(os.path.join(caps_dir, p))
+        return caps
+
+    def num_counters(self):
+        """
+        Number of general-purpose counters, if the driver publishes it.
+        Not all drivers do (the Arm PMUv3 driver doesn't), so None means unknown.
+        """
+        caps = self.caps()
+        for cap in ["num_counters", "counters", "max_counters"]:
+            if cap in caps:
+                try:
+                    return int(caps[cap], 0)
+                except ValueError:
+                    pass
+        return None
+
     @property
     def nr_addr_filters(self):
         try:
@@ -184,6 +218,21 @@ def pmu_name_by_type(n):
     return None
 
 
+def cpu_pmu_name(cpu):
+    """
+    Return the name of the PMU that counts PERF_TYPE_RAW events on a CPU:
+    "cpu" where there is a single CPU PMU, otherwise the PMU listing the CPU
+    (e.g. "armv8_pmuv3_0" on Arm big.LITTLE). None if not found.
+    """
+    if pmu_exists("cpu"):
+        return "cpu"
+    for pmu_name in system_pmu_names():
+        cpus = SysPMU(pmu_name).cpus()
+        if cpus is not None and cpu in cpus:
+            return pmu_name
+    return None
+
+
 def tracepoint_group_dir(egroup):
     events = debugfs_dir() + "/tracing/events"
     egdir = "%s/%s" % (events, egroup)
@@ -225,6 +274,8 @@ if __name__ == "__main__":
             print("    CPU mask: %s" % utils.mask_cpusetstr(cpumask))
         if P.nr_addr_filters:
             print("    Address filters: %u" % P.nr_addr_filters)
+        if P.num_counters() is not None:
+            print("    Counters: %u" % P.num_counters())
         if P.field_names():
             if opts.detail:
                 print("    Fields:")
@@ -128,11 +128,45 @@ class ZSTD:
     def compress(self, src):
         return self.decompress(src, ratio=1.1, compress=True) 
 
+    def decompress_stream(self, src, chunk_size=0x100000):
+        """
+        Decompress src (bytes or any buffer) a chunk at a time, yielding the
+        output chunks as bytes, so that the whole output is never held at once.
+        A writable buffer, e.g. a slice of a mapped file, is read in place.
+        """
+        try:
+            src_buf = (c_char * len(src)).from_buffer(src)
+        except TypeError:
+            src_buf = create_string_buffer(bytes(src), len(src))
+        input = ZSTD_inBuffer()
+        input.src = addressof(src_buf)
+        input.size = len(src)
+        input.pos = 0
+        dst = create_string_buffer(chunk_size)
+        output = ZSTD_outBuffer()
+        s = ZDS(self)
+        while True:
+            output.dst = addressof(dst)
+            output.size = chunk_size
+            output.pos = 0
+            rc = s.processStream(output, input)
+            if self.isError(rc):
+                assert False, "error in decompressStream"
+            if output.pos > 0:
+                yield string_at(addressof(dst), output.pos)
+            # Done when the frame is complete, or all input is consumed and
+            # the decoder had room to flush everything it holds.
+            if rc == 0 or (input.pos == input.size and output.pos < chunk_size):
+                break
+
 
 g_ZSTD = ZSTD()
 
 def decompress(src, ratio=10):
-    return g_ZSTD.decompress(src, ratio=ratio)
+    return b"".join(g_ZSTD.decompress_stream(src, chunk_size=int(min(max(64, len(src) * ratio), 0x100000))))
+
+def decompress_stream(src, chunk_size=0x100000):
+    return g_ZSTD.decompress_stream(src, chunk_size=chunk_size)
 
 def compress(src):
     return g_ZSTD.compress(src)
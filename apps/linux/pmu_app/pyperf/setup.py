@@ -23,7 +23,9 @@ setup(
     packages=['pyperf'],
     ext_package='pyperf',
     ext_modules=[
-        Extension('perf_events', ['src/pyperf_events.c'], extra_compile_args=['-Wall'])
+        Extension('perf_events', ['src/pyperf_events.c'], extra_compile_args=['-Wall']),
+        Extension('perf_records', ['src/pyperf_records.c'], extra_compile_args=['-Wall']),
+        Extension('perf_spe', ['src/pyperf_spe.c'], extra_compile_args=['-Wall'])
     ],
     license='Apache 2.0',
     description='Python interface to Linux perf events'
@@ -0,0 +1,243 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+/*
+ * Fast scan of the record stream in perf.data.
+ *
+ * scan() walks the record headers of a buffer (typically an mmap of the
+ * data section) and returns a batch of index entries, one per record that
+ * passes the type filter. Records that are filtered out never become
+ * Python objects. Each index entry is packed as
+ *
+ *   u64 offset, u32 type, u16 misc, u16 size, u64 aux_size
+ *
+ * (struct format "QIHHQ", 24 bytes), where aux_size is the size of the AUX
+ * data that immediately follows a PERF_RECORD_AUXTRACE record, and zero for
+ * any other record. The caller slices the records out of its buffer.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME perf_records
+#endif /* !MODULE_NAME */
+
+#define MODULE_NAME_STRING3(m) #m
+#define MODULE_NAME_STRING2(m) MODULE_NAME_STRING3(m)
+#define MODULE_NAME_STRING MODULE_NAME_STRING2(MODULE_NAME)
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#if PY_MAJOR_VERSION < 3
+#define MyBytes_FromStringAndSize PyString_FromStringAndSize
+#define MyBytes_AsString PyString_AsString
+#define MyBytes_Resize _PyString_Resize
+#else
+#define MyBytes_FromStringAndSize PyBytes_FromStringAndSize
+#define MyBytes_AsString PyBytes_AsString
+#define MyBytes_Resize _PyBytes_Resize
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+/* Synthetic record type of perf.data: the record is followed by AUX data */
+#define PERF_RECORD_AUXTRACE   71
+
+#define SCAN_ENTRY_SIZE        24
+#define SCAN_DEFAULT_BATCH     4096
+
+/* Scan status, returned with each batch */
+#define SCAN_END               0    /* reached the end of the buffer */
+#define SCAN_MORE              1    /* batch is full, call again from next_offset */
+#define SCAN_TRUNCATED         2    /* last record extends beyond the buffer */
+#define SCAN_INVALID           3    /* record header with size < 8 */
+
+struct scan_state {
+    unsigned char const *data;
+    uint64_t pos;
+    uint64_t end;
+    unsigned char const *filter;    /* NULL: all records */
+    uint64_t filter_len;
+    unsigned char *out;
+    unsigned int max_entries;
+    unsigned int n_entries;
+};
+
+static int scan_records(struct scan_state *s)
+{
+    while (s->pos < s->end) {
+        uint32_t type;
+        uint16_t misc, size;
+        uint64_t aux_size = 0, next;
+        unsigned char *ent;
+
+        if (s->end - s->pos < 8) {
+            return SCAN_TRUNCATED;
+        }
+        memcpy(&type, s->data + s->pos, 4);
+        memcpy(&misc, s->data + s->pos + 4, 2);
+        memcpy(&size, s->data + s->pos + 6, 2);
+        if (size < 8) {
+            return SCAN_INVALID;
+        }
+        if (type == PERF_RECORD_AUXTRACE) {
+            if (size < 16 || s->end - s->pos < 16) {
+                return (size < 16) ? SCAN_INVALID : SCAN_TRUNCATED;
+            }
+            memcpy(&aux_size, s->data + s->pos + 8, 8);
+        }
+        next = s->pos + size + aux_size;
+        if (next < s->pos || next > s->end) {
+            return SCAN_TRUNCATED;
+        }
+        if (s->filter == NULL || (type < s->filter_len && s->filter[type])) {
+            if (s->n_entries == s->max_entries) {
+                return SCAN_MORE;
+            }
+            ent = s->out + (size_t)s->n_entries * SCAN_ENTRY_SIZE;
+            memcpy(ent, &s->pos, 8);
+            memcpy(ent + 8, &type, 4);
+            memcpy(ent + 12, &misc, 2);
+            memcpy(ent + 14, &size, 2);
+            memcpy(ent + 16, &aux_size, 8);
+            s->n_entries++;
+        }
+        s->pos = next;
+    }
+    return SCAN_END;
+}
+
+
+static PyObject *perf_records_scan(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"buffer", "offset", "end", "filter", "max", NULL};
+    Py_buffer buf, filter;
+    unsigned long long offset = 0;
+    long long end = -1;
+    PyObject *filter_obj = Py_None;
+    unsigned int max_entries = SCAN_DEFAULT_BATCH;
+    PyObject *entries;
+    struct scan_state s;
+    int status;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s*|KLOI", kwlist,
+                                     &buf, &offset, &end, &filter_obj, &max_entries)) {
+        return NULL;
+    }
+    memset(&filter, 0, sizeof filter);
+    if (filter_obj != Py_None) {
+        if (PyObject_GetBuffer(filter_obj, &filter, PyBUF_SIMPLE) < 0) {
+            PyBuffer_Release(&buf);
+            return NULL;
+        }
+    }
+    if (max_entries == 0) {
+        max_entries = SCAN_DEFAULT_BATCH;
+    }
+
+    s.data = (unsigned char const *)buf.buf;
+    s.pos = offset;
+    s.end = (end < 0 || (unsigned long long)end > (unsigned long long)buf.len) ?
+            (uint64_t)buf.len : (uint64_t)end;
+    s.filter = (filter_obj != Py_None) ? (unsigned char const *)filter.buf : NULL;
+    s.filter_len = (filter_obj != Py_None) ? (uint64_t)filter.len : 0;
+    s.max_entries = max_entries;
+    s.n_entries = 0;
+
+    entries = MyBytes_FromStringAndSize(NULL, (Py_ssize_t)max_entries * SCAN_ENTRY_SIZE);
+    if (entries == NULL) {
+        goto fail;
+    }
+    s.out = (unsigned char *)MyBytes_AsString(entries);
+
+    Py_BEGIN_ALLOW_THREADS
+    status = scan_records(&s);
+    Py_END_ALLOW_THREADS
+
+    if (MyBytes_Resize(&entries, (Py_ssize_t)s.n_entries * SCAN_ENTRY_SIZE) < 0) {
+        goto fail;
+    }
+    if (filter_obj != Py_None) {
+        PyBuffer_Release(&filter);
+    }
+    PyBuffer_Release(&buf);
+    return Py_BuildValue("(NKi)", entries, (unsigned long long)s.pos, status);
+
+fail:
+    if (filter_obj != Py_None) {
+        PyBuffer_Release(&filter);
+    }
+    PyBuffer_Release(&buf);
+    return NULL;
+}
+
+
+static PyMethodDef funcs[] = {
+    {"scan", (PyCFunction)&perf_records_scan, METH_VARARGS|METH_KEYWORDS,
+     PyDoc_STR("(buffer, offset=0, end=-1, filter=None, max=4096) -> (entries, next_offset, status): "
+               "index the records of a perf.data record stream")},
+    {NULL}
+};
+
+
+#define CON(x) { #x, x }
+static struct {
+    char const *name;
+    long value;
+} constants[] = {
+    CON(SCAN_ENTRY_SIZE),
+    CON(SCAN_END),
+    CON(SCAN_MORE),
+    CON(SCAN_TRUNCATED),
+    CON(SCAN_INVALID),
+};
+
+
+#if PY_MAJOR_VERSION < 3
+#define INIT_NAME2(m) init##m
+#else
+#define INIT_NAME2(m) PyInit_##m
+#endif
+#define INIT_NAME(m) INIT_NAME2(m)
+
+PyMODINIT_FUNC INIT_NAME(MODULE_NAME)(void)
+{
+    PyObject *pmod;
+#if PY_MAJOR_VERSION < 3
+    pmod = Py_InitModule3(MODULE_NAME_STRING, funcs, "perf.data record scanner");
+#else
+    static struct PyModuleDef moduledef = {
+        PyModuleDef_HEAD_INIT,
+        .m_name = MODULE_NAME_STRING,
+        .m_doc = PyDoc_STR("perf.data record scanner"),
+        .m_size = -1,
+        .m_methods = funcs
+    };
+    pmod = PyModule_Create(&moduledef);
+#endif
+    {
+        unsigned int i;
+        for (i = 0; i < (sizeof constants / sizeof constants[0]); ++i) {
+            PyModule_AddIntConstant(pmod, constants[i].name, constants[i].value);
+        }
+    }
+#if PY_MAJOR_VERSION >= 3
+    return pmod;
+#endif
+}
+
+/* end of pyperf_records.c */
@@ -0,0 +1,551 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+/*
+ * Decode Arm Statistical Profiling Extension (SPE) data into columns.
+ *
+ * decode() takes a list of AUX buffers (any objects with the buffer
+ * interface, e.g. slices of a mapped perf.data file) and decodes them
+ * on a pool of threads, one buffer at a time per thread, with the GIL
+ * released. The samples of all buffers are returned in buffer order as
+ * one bytes object per column, suitable for memoryview.cast() or
+ * numpy.frombuffer():
+ *
+ *   segment      u32   index of the buffer the sample came from
+ *   timestamp    u64   Timestamp packet, 0 if the record ended with End
+ *   pc           u64   instruction virtual address
+ *   el           u8    exception level of the instruction
+ *   vaddr        u64   data virtual address
+ *   paddr        u64   data physical address
+ *   total_lat    u32   total latency
+ *   issue_lat    u32   issue latency
+ *   xlat_lat     u32   translation latency
+ *   events       u64   Events packet
+ *   op           u16   operation class (bits 9:8) and Operation Type payload
+ *   data_source  u16   Data Source packet
+ *   context      u32   CONTEXTIDR
+ *
+ * Fields without a packet in the record are zero.
+ * The packet format follows Arm ARM chapter D10 (Statistical Profiling
+ * Extension), as decoded by the Linux perf tool.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#ifndef MODULE_NAME
+#define MODULE_NAME perf_spe
+#endif /* !MODULE_NAME */
+
+#define MODULE_NAME_STRING3(m) #m
+#define MODULE_NAME_STRING2(m) MODULE_NAME_STRING3(m)
+#define MODULE_NAME_STRING MODULE_NAME_STRING2(MODULE_NAME)
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#if PY_MAJOR_VERSION < 3
+#define MyBytes_FromStringAndSize PyString_FromStringAndSize
+#define MyBytes_AsString PyString_AsString
+#else
+#define MyBytes_FromStringAndSize PyBytes_FromStringAndSize
+#define MyBytes_AsString PyBytes_AsString
+#endif
+
+#include <pthread.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Packet headers */
+#define SPE_HEADER0_PAD              0x00
+#define SPE_HEADER0_END              0x01
+#define SPE_HEADER0_TIMESTAMP        0x71
+#define SPE_HEADER0_MASK1            0xCF
+#define SPE_HEADER0_EVENTS           0x42
+#define SPE_HEADER0_SOURCE           0x43
+#define SPE_HEADER0_MASK2            0xFC
+#define SPE_HEADER0_CONTEXT          0x64
+#define SPE_HEADER0_OP_TYPE          0x48
+#define SPE_HEADER0_EXTENDED         0x20
+#define SPE_HEADER0_MASK3            0xF8
+#define SPE_HEADER0_ADDRESS          0xB0
+#define SPE_HEADER0_COUNTER          0x98
+#define SPE_HEADER1_ALIGNMENT        0x00
+
+#define SPE_PAYLOAD_SIZE(h)          (1u << (((h) >> 4) & 3))
+
+/* Address packet index */
+#define SPE_ADDR_INS                 0
+#define SPE_ADDR_BRANCH              1
+#define SPE_ADDR_DATA_VIRT           2
+#define SPE_ADDR_DATA_PHYS           3
+
+/* Counter packet index */
+#define SPE_CNT_TOTAL_LAT            0
+#define SPE_CNT_ISSUE_LAT            1
+#define SPE_CNT_TRANS_LAT            2
+
+/* Operation class and Events packet bits used by the access filter */
+#define SPE_OP_CLASS_LD_ST_ATOMIC    1
+#define SPE_EV_RETIRED               (1u << 1)
+
+#define SPE_DEFAULT_ROWS             1024
+
+struct spe_row {
+    uint64_t timestamp;
+    uint64_t pc;
+    uint64_t vaddr;
+    uint64_t paddr;
+    uint64_t events;
+    uint32_t total_lat;
+    uint32_t issue_lat;
+    uint32_t xlat_lat;
+    uint32_t context;
+    uint16_t op;
+    uint16_t data_source;
+    uint8_t el;
+};
+
+struct spe_segment {
+    Py_buffer buf;
+    struct spe_row *rows;
+    size_t n_rows;
+    size_t max_rows;
+    unsigned long errors;       /* undecodable packets, skipped a byte at a time */
+    int nomem;
+};
+
+struct spe_job {
+    struct spe_segment *segs;
+    unsigned int n_segs;
+    unsigned int next;          /* next segment to decode, taken atomically */
+    int access_only;
+};
+
+
+static uint64_t spe_payload(unsigned char const *p, unsigned int size)
+{
+    uint64_t v = 0;
+    unsigned int i;
+    for (i = 0; i < size; ++i) {
+        v |= (uint64_t)p[i] << (i * 8);
+    }
+    return v;
+}
+
+
+static void spe_address(struct spe_row *row, unsigned int index, uint64_t v)
+{
+    uint64_t addr = v & 0x00FFFFFFFFFFFFFFull;
+    unsigned int ns = (v >> 63) & 1;
+    unsigned int el = (v >> 61) & 3;
+
+    switch (index) {
+    case SPE_ADDR_INS:
+        /* Fill the top byte for kernel (EL1, or EL2 with VHE) addresses */
+        if (ns && (el == 1 || el == 2)) {
+            addr |= 0xFF00000000000000ull;
+        }
+        row->pc = addr;
+        row->el = el;
+        break;
+    case SPE_ADDR_DATA_VIRT:
+        /* Top byte is a tag: restore it for kernel addresses */
+        if (((addr >> 52) & 0xF) == 0xF) {
+            addr |= 0xFF00000000000000ull;
+        }
+        row->vaddr = addr;
+        break;
+    case SPE_ADDR_DATA_PHYS:
+        row->paddr = addr;
+        break;
+    default:
+        break;
+    }
+}
+
+
+static void spe_counter(struct spe_row *row, unsigned int index, uint64_t v)
+{
+    switch (index) {
+    case SPE_CNT_TOTAL_LAT:
+        row->total_lat = (uint32_t)v;
+        break;
+    case SPE_CNT_ISSUE_LAT:
+        row->issue_lat = (uint32_t)v;
+        break;
+    case SPE_CNT_TRANS_LAT:
+        row->xlat_lat = (uint32_t)v;
+        break;
+    default:
+        break;
+    }
+}
+
+
+static void spe_emit(struct spe_segment *seg, struct spe_row const *row, int access_only)
+{
+    if (access_only &&
+        ((row->op >> 8) != SPE_OP_CLASS_LD_ST_ATOMIC || !(row->events & SPE_EV_RETIRED))) {
+        return;
+    }
+    if (seg->n_rows == seg->max_rows) {
+        size_t n = seg->max_rows ? seg->max_rows * 2 : SPE_DEFAULT_ROWS;
+        struct spe_row *rows = (struct spe_row *)realloc(seg->rows, n * sizeof(struct spe_row));
+        if (rows == NULL) {
+            seg->nomem = 1;
+            return;
+        }
+        seg->rows = rows;
+        seg->max_rows = n;
+    }
+    seg->rows[seg->n_rows++] = *row;
+}
+
+
+/*
+ * Check that a header (h0, or h0 h1 for an extended header) starts a packet
+ * that has a payload.
+ */
+static int spe_known_header(unsigned int h0, unsigned int h1, int extended)
+{
+    if (!extended) {
+        if (h0 == SPE_HEADER0_TIMESTAMP ||
+            (h0 & SPE_HEADER0_MASK1) == SPE_HEADER0_EVENTS ||
+            (h0 & SPE_HEADER0_MASK1) == SPE_HEADER0_SOURCE ||
+            (h0 & SPE_HEADER0_MASK2) == SPE_HEADER0_CONTEXT ||
+            (h0 & SPE_HEADER0_MASK2) == SPE_HEADER0_OP_TYPE) {
+            return 1;
+        }
+    }
+    return (h1 & SPE_HEADER0_MASK3) == SPE_HEADER0_ADDRESS ||
+           (h1 & SPE_HEADER0_MASK3) == SPE_HEADER0_COUNTER;
+}
+
+
+/*
+ * Decode one AUX buffer. A record is a sequence of packets ending with
+ * an End or Timestamp packet. An incomplete record at the end of the
+ * buffer is dropped.
+ */
+static void spe_decode_segment(struct spe_segment *seg, int access_only)
+{
+    unsigned char const *p = (unsigned char const *)seg->buf.buf;
+    size_t len = (size_t)seg->buf.len;
+    size_t pos = 0;
+    struct spe_row row;
+    int in_record = 0;
+
+    memset(&row, 0, sizeof row);
+    while (pos < len && !seg->nomem) {
+        unsigned int h0 = p[pos];
+        unsigned int h = h0;
+        unsigned int hlen = 1, plen, index;
+        uint64_t v;
+
+        if (h0 == SPE_HEADER0_PAD) {
+            pos++;
+            continue;
+        }
+        if (h0 == SPE_HEADER0_END) {
+            if (in_record) {
+                spe_emit(seg, &row, access_only);
+            }
+            memset(&row, 0, sizeof row);
+            in_record = 0;
+            pos++;
+            continue;
+        }
+        if ((h0 & SPE_HEADER0_MASK2) == SPE_HEADER0_EXTENDED) {
+            if (pos + 1 >= len) {
+                break;
+            }
+            h = p[pos+1];
+            if (h == SPE_HEADER1_ALIGNMENT) {
+                size_t align = (size_t)1 << ((h0 & 0xF) + 1);
+                pos += align - (pos & (align - 1));
+                continue;
+            }
+            hlen = 2;
+        }
+        if (!spe_known_header(h0, h, hlen == 2)) {
+            /* Unknown packet: resynchronize on the next byte */
+            seg->errors++;
+            pos++;
+            continue;
+        }
+        plen = SPE_PAYLOAD_SIZE(h);
+        if (pos + hlen + plen > len) {
+            break;
+        }
+        v = spe_payload(p + pos + hlen, plen);
+        if (h0 == SPE_HEADER0_TIMESTAMP) {
+            if (in_record) {
+                row.timestamp = v;
+                spe_emit(seg, &row, access_only);
+            }
+            memset(&row, 0, sizeof row);
+            in_record = 0;
+        } else if ((h0 & SPE_HEADER0_MASK1) == SPE_HEADER0_EVENTS) {
+            row.events = v;
+        } else if ((h0 & SPE_HEADER0_MASK1) == SPE_HEADER0_SOURCE) {
+            row.data_source = (uint16_t)v;
+        } else if ((h0 & SPE_HEADER0_MASK2) == SPE_HEADER0_CONTEXT) {
+            row.context = (uint32_t)v;
+        } else if ((h0 & SPE_HEADER0_MASK2) == SPE_HEADER0_OP_TYPE) {
+            row.op = (uint16_t)(((h0 & 3) << 8) | (v & 0xFF));
+        } else if ((h & SPE_HEADER0_MASK3) == SPE_HEADER0_ADDRESS) {
+            index = (hlen == 2) ? (((h0 & 3) << 3) | (h & 7)) : (h & 7);
+            spe_address(&row, index, v);
+        } else {
+            index = (hlen == 2) ? (((h0 & 3) << 3) | (h & 7)) : (h & 7);
+            spe_counter(&row, index, v);
+        }
+        if (h0 != SPE_HEADER0_TIMESTAMP) {
+            in_record = 1;
+        }
+        pos += hlen + plen;
+    }
+}
+
+
+static void *spe_worker(void *arg)
+{
+    struct spe_job *job = (struct spe_job *)arg;
+    for (;;) {
+        unsigned int i = __sync_fetch_and_add(&job->next, 1);
+        if (i >= job->n_segs) {
+            break;
+        }
+        spe_decode_segment(&job->segs[i], job->access_only);
+    }
+    return NULL;
+}
+
+
+/*
+ * Decode all segments, using up to n_threads threads (including the caller).
+ * Called without the GIL.
+ */
+static void spe_decode_all(struct spe_job *job, unsigned int n_threads)
+{
+    pthread_t *threads = NULL;
+    unsigned int i, n_started = 0;
+
+    if (n_threads > job->n_segs) {
+        n_threads = job->n_segs;
+    }
+    if (n_threads > 1) {
+        threads = (pthread_t *)calloc(n_threads - 1, sizeof(pthread_t));
+    }
+    if (threads != NULL) {
+        for (i = 0; i < n_threads - 1; ++i) {
+            if (pthread_create(&threads[i], NULL, spe_worker, job) != 0) {
+                break;
+            }
+            n_started++;
+        }
+    }
+    spe_worker(job);
+    for (i = 0; i < n_started; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
+
+
+/* Column layout: name, element size, and where to find it in a row */
+enum spe_column_id {
+    COL_SEGMENT, COL_TIMESTAMP, COL_PC, COL_EL, COL_VADDR, COL_PADDR,
+    COL_TOTAL_LAT, COL_ISSUE_LAT, COL_XLAT_LAT, COL_EVENTS, COL_OP,
+    COL_DATA_SOURCE, COL_CONTEXT, N_COLUMNS
+};
+
+static struct {
+    char const *name;
+    unsigned int size;
+    size_t offset;
+} const spe_columns[N_COLUMNS] = {
+    { "segment",     4, 0 },
+    { "timestamp",   8, offsetof(struct spe_row, timestamp) },
+    { "pc",          8, offsetof(struct spe_row, pc) },
+    { "el",          1, offsetof(struct spe_row, el) },
+    { "vaddr",       8, offsetof(struct spe_row, vaddr) },
+    { "paddr",       8, offsetof(struct spe_row, paddr) },
+    { "total_lat",   4, offsetof(struct spe_row, total_lat) },
+    { "issue_lat",   4, offsetof(struct spe_row, issue_lat) },
+    { "xlat_lat",    4, offsetof(struct spe_row, xlat_lat) },
+    { "events",      8, offsetof(struct spe_row, events) },
+    { "op",          2, offsetof(struct spe_row, op) },
+    { "data_source", 2, offsetof(struct spe_row, data_source) },
+    { "context",     4, offsetof(struct spe_row, context) },
+};
+
+
+/*
+ * Scatter the rows of all segments into the column buffers, in segment order.
+ * Called without the GIL.
+ */
+static void spe_fill_columns(struct spe_job const *job, unsigned char **cols)
+{
+    size_t n = 0;
+    unsigned int s, c;
+
+    for (s = 0; s < job->n_segs; ++s) {
+        struct spe_segment const *seg = &job->segs[s];
+        size_t r;
+        for (r = 0; r < seg->n_rows; ++r, ++n) {
+            unsigned char const *row = (unsigned char const *)&seg->rows[r];
+            uint32_t segment = s;
+            memcpy(cols[COL_SEGMENT] + n * 4, &segment, 4);
+            for (c = COL_SEGMENT + 1; c < N_COLUMNS; ++c) {
+                unsigned int size = spe_columns[c].size;
+                memcpy(cols[c] + n * size, row + spe_columns[c].offset, size);
+            }
+        }
+    }
+}
+
+
+static PyObject *perf_spe_decode(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"buffers", "threads", "access_only", NULL};
+    PyObject *buffers, *seq = NULL, *result = NULL, *columns = NULL;
+    unsigned int n_threads = 0;
+    int access_only = 0;
+    struct spe_job job;
+    unsigned char *cols[N_COLUMNS];
+    unsigned long errors = 0;
+    size_t n_rows = 0;
+    unsigned int i, n_acquired = 0;
+    int nomem = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|Ii", kwlist, &buffers, &n_threads, &access_only)) {
+        return NULL;
+    }
+    seq = PySequence_Fast(buffers, "expected a sequence of AUX buffers");
+    if (seq == NULL) {
+        return NULL;
+    }
+    memset(&job, 0, sizeof job);
+    job.n_segs = (unsigned int)PySequence_Fast_GET_SIZE(seq);
+    job.access_only = access_only;
+    job.segs = (struct spe_segment *)calloc(job.n_segs ? job.n_segs : 1, sizeof(struct spe_segment));
+    if (job.segs == NULL) {
+        PyErr_NoMemory();
+        goto out;
+    }
+    for (i = 0; i < job.n_segs; ++i) {
+        if (PyObject_GetBuffer(PySequence_Fast_GET_ITEM(seq, i), &job.segs[i].buf, PyBUF_SIMPLE) < 0) {
+            goto out;
+        }
+        n_acquired++;
+    }
+    if (n_threads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        n_threads = (n > 0) ? (unsigned int)n : 1;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    spe_decode_all(&job, n_threads);
+    Py_END_ALLOW_THREADS
+
+    for (i = 0; i < job.n_segs; ++i) {
+        n_rows += job.segs[i].n_rows;
+        errors += job.segs[i].errors;
+        nomem |= job.segs[i].nomem;
+    }
+    if (nomem) {
+        PyErr_NoMemory();
+        goto out;
+    }
+    columns = PyDict_New();
+    if (columns == NULL) {
+        goto out;
+    }
+    for (i = 0; i < N_COLUMNS; ++i) {
+        PyObject *col = MyBytes_FromStringAndSize(NULL, (Py_ssize_t)(n_rows * spe_columns[i].size));
+        if (col == NULL || PyDict_SetItemString(columns, spe_columns[i].name, col) < 0) {
+            Py_XDECREF(col);
+            goto out;
+        }
+        cols[i] = (unsigned char *)MyBytes_AsString(col);
+        Py_DECREF(col);     /* the dict holds it */
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    spe_fill_columns(&job, cols);
+    Py_END_ALLOW_THREADS
+
+    result = Py_BuildValue("(Ok)", columns, errors);
+
+out:
+    Py_XDECREF(columns);
+    if (job.segs != NULL) {
+        for (i = 0; i < job.n_segs; ++i) {
+            if (i < n_acquired) {
+                PyBuffer_Release(&job.segs[i].buf);
+            }
+            free(job.segs[i].rows);
+        }
+        free(job.segs);
+    }
+    Py_DECREF(seq);
+    return result;
+}
+
+
+static PyMethodDef funcs[] = {
+    {"decode", (PyCFunction)&perf_spe_decode, METH_VARARGS|METH_KEYWORDS,
+     PyDoc_STR("(buffers, threads=0, access_only=False) -> (columns, errors): "
+               "decode SPE AUX buffers into a dict of columns")},
+    {NULL}
+};
+
+
+#if PY_MAJOR_VERSION < 3
+#define INIT_NAME2(m) init##m
+#else
+#define INIT_NAME2(m) PyInit_##m
+#endif
+#define INIT_NAME(m) INIT_NAME2(m)
+
+PyMODINIT_FUNC INIT_NAME(MODULE_NAME)(void)
+{
+    PyObject *pmod;
+#if PY_MAJOR_VERSION < 3
+    pmod = Py_InitModule3(MODULE_NAME_STRING, funcs, "Arm SPE decoder");
+#else
+    static struct PyModuleDef moduledef = {
+        PyModuleDef_HEAD_INIT,
+        .m_name = MODULE_NAME_STRING,
+        .m_doc = PyDoc_STR("Arm SPE decoder"),
+        .m_size = -1,
+        .m_methods = funcs
+    };
+    pmod = PyModule_Create(&moduledef);
+#endif
+#if PY_MAJOR_VERSION >= 3
+    return pmod;
+#endif
+}
+
+/* end of pyperf_spe.c */
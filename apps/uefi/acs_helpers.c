@@ -622,6 +622,30 @@ command_init (void)
         policy->print_mmio = FALSE;
     }
 
+    if (ShellCommandLineGetFlag (ParamPackage, L"-binlog")) {
+        policy->binary_log = TRUE;
+    } else {
+        policy->binary_log = FALSE;
+    }
+
+    if (ShellCommandLineGetFlag (ParamPackage, L"-peresident")) {
+        policy->pe_resident = TRUE;
+    } else {
+        policy->pe_resident = FALSE;
+    }
+
+    if (ShellCommandLineGetFlag (ParamPackage, L"-profile")) {
+        policy->rule_profile = TRUE;
+    } else {
+        policy->rule_profile = FALSE;
+    }
+
+    if (ShellCommandLineGetFlag (ParamPackage, L"-ruleparallel")) {
+        policy->rule_parallel = TRUE;
+    } else {
+        policy->rule_parallel = FALSE;
+    }
+
     /* -f logfile option */
     CmdLineArg  = ShellCommandLineGetValue (ParamPackage, L"-f");
     if (CmdLineArg == NULL) {
@@ -1004,6 +1028,24 @@ command_init (void)
         policy->pcie_cache_present = FALSE;
     }
 
+    if (ShellCommandLineGetFlag (ParamPackage, L"-cfgcache")) {
+        policy->pcie_cfg_cache = TRUE;
+    } else {
+        policy->pcie_cfg_cache = FALSE;
+    }
+
+    if (ShellCommandLineGetFlag (ParamPackage, L"-pcieprune")) {
+        policy->pcie_enum_prune = TRUE;
+    } else {
+        policy->pcie_enum_prune = FALSE;
+    }
+
+    if (ShellCommandLineGetFlag (ParamPackage, L"-pcieparallel")) {
+        policy->pcie_bf_parallel = TRUE;
+    } else {
+        policy->pcie_bf_parallel = FALSE;
+    }
+
     /* -el1skiptrap <params>: skip specific EL1 register accesses known to trap under hypervisors */
     CmdLineArg  = ShellCommandLineGetValue (ParamPackage, L"-el1skiptrap");
     if (CmdLineArg != NULL) {
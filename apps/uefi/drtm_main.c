@@ -319,7 +319,10 @@ execute_tests()
   if (Status)
     return Status;
 
-  val_allocate_shared_mem();
+  Status = val_allocate_shared_mem();
+  if (Status)
+    return Status;
+
   g_acs_tests_pass  = 0;
   g_acs_tests_fail  = 0;
 
@@ -744,7 +744,8 @@ execute_tests()
   createPeripheralInfoTable();
   createSmbiosInfoTable();
 
-  val_allocate_shared_mem();
+  if (val_allocate_shared_mem() != ACS_STATUS_PASS)
+    goto print_test_status;
 
   FlushImage();
   val_bsa_execute_tests(g_sw_view);
@@ -437,7 +437,8 @@ execute_tests()
         goto print_test_status;
     }
 
-    val_allocate_shared_mem();
+    if (val_allocate_shared_mem() != ACS_STATUS_PASS)
+        goto print_test_status;
 
     /*
      * Initialise exception vector, so any unexpected exception gets handled
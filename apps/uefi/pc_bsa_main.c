@@ -181,7 +181,8 @@ execute_tests()
     createTpm2InfoTable();
     createSratInfoTable();
     val_drtm_create_info_table();
-    val_allocate_shared_mem();
+    if (val_allocate_shared_mem() != ACS_STATUS_PASS)
+        goto exit_acs;
 
     FlushImage();
 
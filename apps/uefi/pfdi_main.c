@@ -119,7 +119,8 @@ execute_tests()
   if (Status)
       goto exit_close;
 
-  val_allocate_shared_mem();
+  if (val_allocate_shared_mem() != ACS_STATUS_PASS)
+      goto exit_close;
 
   Status = val_pfdi_check_implementation();
   if (Status == PFDI_ACS_NOT_IMPLEMENTED) {
@@ -25,6 +25,7 @@
 #include "val/include/acs_pe.h"
 #include "val/include/acs_val.h"
 #include "val/include/acs_memory.h"
+#include "val/include/acs_nist.h"
 
 #include "acs.h"
 
@@ -316,7 +317,7 @@ HelpMsg (
   )
 {
    Print (L"\nUsage: Sbsa.efi [-v <n>] | [-l <n>] | [-only] | [-fr] | [-f <filename>] | "
-         "[-skip <n>] | [-nist] | [-t <n>] | [-m <n>]\n"
+         "[-skip <n>] | [-nist] | [-nistmem <n>] | [-t <n>] | [-m <n>]\n"
          "Options:\n"
          "-v      Verbosity of the Prints\n"
          "        1 shows all prints, 5 shows Errors\n"
@@ -335,6 +336,9 @@ HelpMsg (
          "        To skip a module, use Module ID as mentioned in user guide\n"
          "        To skip a particular test within a module, use the exact testcase number\n"
          "-nist   Enable the NIST Statistical test suite\n"
+         "-nistmem <bits>\n"
+         "        Run the NIST tests on packed in-memory sequences of <bits> bits\n"
+         "        (minimum 100000) instead of the file based suite. Use with -nist\n"
          "-t      If Test ID(s) set, will only run the specified test, all others will be skipped.\n"
          "-m      If Module ID(s) set, will only run the specified module, all others will be skipped.\n"
          "-no_crypto_ext  Pass this flag if cryptography extension not supported due to export restrictions\n"
@@ -364,6 +368,7 @@ CONST SHELL_PARAM_ITEM ParamList[] = {
   {L"-help" , TypeFlag},     // -help # help : info about commands
   {L"-h"    , TypeFlag},     // -h    # help : info about commands
   {L"-nist" , TypeFlag},     // -nist # Binary Flag to enable the execution of NIST STS
+  {L"-nistmem", TypeValue},  // -nistmem # Bits per in-memory NIST sequence
   {L"-mmio" , TypeValue},    // -mmio # Enable pal_mmio prints
   {L"-t"    , TypeValue},    // -t    # Test to be run
   {L"-m"    , TypeValue},    // -m    # Module to be run
@@ -657,6 +662,18 @@ command_init ()
     g_execute_nist = FALSE;
   }
 
+  CmdLineArg  = ShellCommandLineGetValue (ParamPackage, L"-nistmem");
+  if (CmdLineArg != NULL) {
+    UINTN StreamBits = StrDecimalToUintn(CmdLineArg);
+
+    if ((StreamBits < NIST_STREAM_MIN_BITS) || (StreamBits > MAX_UINT32)) {
+      Print(L"Invalid -nistmem: stream length must be %d to %u bits\n",
+            NIST_STREAM_MIN_BITS, MAX_UINT32);
+      return SHELL_INVALID_PARAMETER;
+    }
+    policy->nist_stream_bits = (UINT32)StreamBits;
+  }
+
   CmdLineArg  = ShellCommandLineGetValue (ParamPackage, L"-el1skiptrap");
   if (CmdLineArg != NULL) {
     UINTN arg_len = StrLen(CmdLineArg);
@@ -765,7 +782,8 @@ execute_tests()
   createPmuInfoTable();
   createRasInfoTable();
 
-  val_allocate_shared_mem();
+  if (val_allocate_shared_mem() != ACS_STATUS_PASS)
+    goto print_test_status;
 
   FlushImage();
   val_sbsa_execute_tests(g_sbsa_level);
@@ -29,7 +29,9 @@
 
 /* CLI parameter table for VBSA ACS, for description refer HelpMsg */
 CONST SHELL_PARAM_ITEM ParamList[] = {
+    {L"-binlog", TypeFlag},
     {L"-cache", TypeFlag},
+    {L"-cfgcache", TypeFlag},
     {L"-el1skiptrap", TypeValue},
     {L"-f", TypeValue},
     {L"-fr", TypeFlag},
@@ -41,7 +43,12 @@ CONST SHELL_PARAM_ITEM ParamList[] = {
     {L"-no_crypto_ext", TypeFlag},
     {L"-only", TypeValue},
     {L"-p2p", TypeFlag},
+    {L"-pcieparallel", TypeFlag},
+    {L"-pcieprune", TypeFlag},
+    {L"-peresident", TypeFlag},
+    {L"-profile", TypeFlag},
     {L"-r", TypeValue},
+    {L"-ruleparallel", TypeFlag},
     {L"-skip", TypeValue},
     {L"-skip-dp-nic-ms", TypeFlag},
     {L"-skipmodule", TypeValue},
@@ -57,8 +64,12 @@ HelpMsg (VOID)
 {
     Print (L"\nUsage: Vbsa.efi [options]\n"
         "Options:\n"
+        "-binlog Record TRACE/DEBUG prints in binary form and dump them at test end,\n"
+        "        decode with tools/scripts/acs_log_decode.py\n"
         "-cache  Pass this flag to indicate that if the test system supports\n"
         "        PCIe address translation cache\n"
+        "-cfgcache \n"
+        "        Serve repeated PCIe config reads from a per-BDF snapshot cache\n"
         "-el1skiptrap <list>\n"
         "        Skip specific EL1 register reads known to trap under hypervisors.\n"
         "        Tokens: cntpct, devmem, pmsidr\n"
@@ -78,10 +89,20 @@ HelpMsg (VOID)
         "-only <n> \n"
         "        Only run tests for rules at level <n> \n"
         "-p2p    Pass this flag to indicate that PCIe Hierarchy Supports Peer-to-Peer\n"
+        "-pcieparallel \n"
+        "        Split PCIe bit-field compliance checks across PEs\n"
+        "-pcieprune \n"
+        "        Enumerate PCIe following bridge bus ranges and multi-function bits\n"
+        "-peresident \n"
+        "        Keep secondary PEs parked between payloads instead of PSCI power cycling\n"
+        "-profile \n"
+        "        Print per-rule duration, PE count, PSCI and MMIO counts as @ACSPROF lines\n"
         "-r      Run tests for passed comma-separated Rule IDs or a rules file\n"
         "        Examples: -r B_PE_01,B_PE_02,B_GIC_01\n"
         "                  -r rules.txt  (file may mix commas/newlines; lines \n"
         "                     starting with # are comments)\n"
+        "-ruleparallel \n"
+        "        Run independent single-PE rules on idle secondary PEs\n"
         "-skip   Rule ID(s) to be skipped (comma-separated, like -r)\n"
         "        Example: -skip B_PE_01,B_GIC_02\n"
         "-skip-dp-nic-ms \n"
@@ -182,7 +203,8 @@ execute_tests()
     createPcieVirtInfoTable();
     createPeripheralInfoTable();
     createSmbiosInfoTable();
-    val_allocate_shared_mem();
+    if (val_allocate_shared_mem() != ACS_STATUS_PASS)
+        goto exit_acs;
 
     FlushImage();
 
@@ -32,6 +32,7 @@ typedef char     char8_t;
 
 extern uint32_t g_curr_module;
 extern uint32_t g_enable_module;
+extern uint64_t g_psci_call_count;
 
 #define MEM_ALIGN_4K       0x1000
 #define MEM_ALIGN_8K       0x2000
@@ -48,6 +49,7 @@ extern uint32_t g_enable_module;
 
 void pal_mem_free_aligned(void *Buffer);
 void *pal_aligned_alloc( uint32_t alignment, uint32_t size );
+uint64_t pal_timer_get_counter_frequency(void);
 
 #define PCIE_EXTRACT_BDF_SEG(bdf)  ((bdf >> 24) & 0xFF)
 #define PCIE_EXTRACT_BDF_BUS(bdf)  ((bdf >> 16) & 0xFF)
@@ -30,6 +30,7 @@
 #define TYPE01_RIDR        0x8
 
 #define PCIE_HEADER_TYPE(header_value) ((header_value >> 16) & 0x3)
+#define PCIE_HEADER_MF(header_value)   ((header_value >> 23) & 0x1)
 #define BUS_NUM_REG_CFG(sub_bus, sec_bus, pri_bus) (sub_bus << 16 | sec_bus << 8 | bus)
 
 #define DEVICE_ID_OFFSET   16
@@ -98,5 +99,6 @@ uint32_t pal_pci_cfg_read(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fun
 uint32_t pal_pcie_read_cfg(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t func, uint32_t offset, uint32_t *value);
 
 uint64_t pal_pcie_ecam_base(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t func);
+void pal_pcie_set_ecam_resolver(uint64_t (*resolve)(uint32_t seg, uint32_t bus));
 
 #endif
@@ -0,0 +1,585 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/* Baremetal heap allocator shared by all targets.
+
+   The heap region (PLATFORM_HEAP_REGION_BASE/SIZE) is carved into blocks, each
+   starting with a 16 byte header holding the block size, an in-use flag and the
+   size of the physically preceding block. Free blocks are kept on segregated
+   free lists, one per power-of-two size class, and are merged with their free
+   neighbours when released. Small blocks are additionally recycled through a
+   per-PE cache so that short lived allocations do not take the global lock.
+*/
+
+#include "acs_stdint.h"
+#include "pal_common_support.h"
+#include "platform_image_def.h"
+#include "platform_override_struct.h"
+#include "pal_sysreg.h"
+#include "acs_pe_index.h"
+
+extern const PE_INFO_TABLE platform_pe_cfg;
+
+#define __ADDR_ALIGN_MASK(a, mask)    (((a) + (mask)) & ~(mask))
+#define ADDR_ALIGN(a, b)              __ADDR_ALIGN_MASK(a, (typeof(a))(b) - 1)
+
+#define HEAP_GRANULE          16
+#define HEAP_MIN_BLOCK        32       /* header + free list links */
+#define HEAP_MIN_SHIFT        5        /* log2(HEAP_MIN_BLOCK) */
+#define HEAP_NUM_CLASSES      32
+
+#define HEAP_FLAG_USED        0x1ULL
+#define HEAP_FLAG_CACHED      0x2ULL   /* in use, parked in a per-PE cache */
+#define HEAP_MAGIC_SHIFT      48
+#define HEAP_BLOCK_MAGIC      (0xACE5ULL << HEAP_MAGIC_SHIFT)
+#define HEAP_MAGIC_MASK       (0xFFFFULL << HEAP_MAGIC_SHIFT)
+#define HEAP_SIZE_MASK        (~(HEAP_MAGIC_MASK | (HEAP_GRANULE - 1)))
+
+/* Per-PE cache of small blocks: classes of 32, 64, 128 and 256 bytes */
+#define HEAP_CACHE_CLASSES    4
+#define HEAP_CACHE_MAX_BLOCK  (HEAP_MIN_BLOCK << (HEAP_CACHE_CLASSES - 1))
+#define HEAP_CACHE_DEPTH      8
+#define HEAP_CACHE_MAX_PE     PLATFORM_OVERRIDE_PE_CNT
+#define HEAP_NO_PE            0xFFFFFFFF
+
+#define HEAP_MPIDR_AFF_MASK   0xFF00FFFFFFULL
+
+typedef struct heap_block {
+  uint64_t           hdr;        /* magic | size | in-use flag */
+  uint64_t           prev_size;  /* size of the preceding block, 0 for the first one */
+  struct heap_block  *next;      /* free list / PE cache link, valid when not in use */
+  struct heap_block  *prev;      /* free list link, valid when free */
+} HEAP_BLOCK;
+
+#define HEAP_HDR_SIZE         16
+
+typedef struct {
+  HEAP_BLOCK *head[HEAP_CACHE_CLASSES];
+  uint32_t   count[HEAP_CACHE_CLASSES];
+  uint64_t   hits;
+} HEAP_PE_CACHE;
+
+typedef struct {
+  uint64_t in_use;         /* bytes taken out of the free lists, headers included */
+  uint64_t peak;           /* high-water mark of in_use */
+  uint64_t num_alloc;
+  uint64_t num_free;
+  uint64_t num_failed;
+} HEAP_STATS;
+
+static HEAP_BLOCK     *heap_bins[HEAP_NUM_CLASSES];
+static uint32_t       heap_bin_map;
+static uint64_t       heap_start;
+static uint64_t       heap_end;     /* address of the end sentinel block */
+static uint8_t        heap_init_done;
+static volatile uint32_t heap_lock;
+static HEAP_STATS     heap_stats;
+static HEAP_PE_CACHE  heap_pe_cache[HEAP_CACHE_MAX_PE];
+
+static int is_power_of_2(uint32_t n)
+{
+    return n && !(n & (n - 1));
+}
+
+#ifdef TARGET_HOSTSIM
+static void heap_lock_acquire(void)
+{
+  while (__atomic_exchange_n(&heap_lock, 1, __ATOMIC_ACQUIRE))
+    ;
+}
+
+static void heap_lock_release(void)
+{
+  __atomic_store_n(&heap_lock, 0, __ATOMIC_RELEASE);
+}
+#else
+static void heap_lock_acquire(void)
+{
+  uint32_t tmp, fail;
+
+  __asm__ volatile (
+    "   sevl\n"
+    "1: wfe\n"
+    "2: ldaxr   %w0, [%2]\n"
+    "   cbnz    %w0, 1b\n"
+    "   stxr    %w1, %w3, [%2]\n"
+    "   cbnz    %w1, 2b\n"
+    : "=&r" (tmp), "=&r" (fail)
+    : "r" (&heap_lock), "r" (1)
+    : "memory");
+}
+
+static void heap_lock_release(void)
+{
+  /* Store-release clears the exclusive monitor and wakes any waiter in WFE */
+  __asm__ volatile ("stlr wzr, [%0]" :: "r" (&heap_lock) : "memory");
+}
+#endif
+
+static inline uint64_t heap_block_size(HEAP_BLOCK *blk)
+{
+  return blk->hdr & HEAP_SIZE_MASK;
+}
+
+static inline uint32_t heap_block_used(HEAP_BLOCK *blk)
+{
+  return (blk->hdr & HEAP_FLAG_USED) ? 1 : 0;
+}
+
+/* Writes the block header and records its size in the following block */
+static void heap_set_block(HEAP_BLOCK *blk, uint64_t size, uint32_t used)
+{
+  HEAP_BLOCK *next = (HEAP_BLOCK *)((uint64_t)blk + size);
+
+  blk->hdr = HEAP_BLOCK_MAGIC | size | (used ? HEAP_FLAG_USED : 0);
+  next->prev_size = size;
+}
+
+static uint32_t heap_class(uint64_t size)
+{
+  uint32_t msb = 63 - __builtin_clzll(size);
+
+  if (msb <= HEAP_MIN_SHIFT)
+      return 0;
+  if (msb - HEAP_MIN_SHIFT >= HEAP_NUM_CLASSES)
+      return HEAP_NUM_CLASSES - 1;
+  return msb - HEAP_MIN_SHIFT;
+}
+
+static void heap_bin_insert(HEAP_BLOCK *blk)
+{
+  uint32_t cls = heap_class(heap_block_size(blk));
+
+  blk->prev = NULL;
+  blk->next = heap_bins[cls];
+  if (blk->next)
+      blk->next->prev = blk;
+  heap_bins[cls] = blk;
+  heap_bin_map |= (1U << cls);
+}
+
+static void heap_bin_remove(HEAP_BLOCK *blk)
+{
+  uint32_t cls = heap_class(heap_block_size(blk));
+
+  if (blk->prev)
+      blk->prev->next = blk->next;
+  else
+      heap_bins[cls] = blk->next;
+  if (blk->next)
+      blk->next->prev = blk->prev;
+  if (heap_bins[cls] == NULL)
+      heap_bin_map &= ~(1U << cls);
+}
+
+/**
+  @brief  Checks whether a free block can hold an allocation.
+
+  @param  blk       - Free block
+  @param  need      - Block size required, header included
+  @param  alignment - Payload alignment
+
+  @return Payload address if the allocation fits, else 0. Any gap in front of
+          the aligned payload is large enough to become a free block itself.
+**/
+static uint64_t heap_fit(HEAP_BLOCK *blk, uint64_t need, uint64_t alignment)
+{
+  uint64_t base = (uint64_t)blk;
+  uint64_t payload = ADDR_ALIGN(base + HEAP_HDR_SIZE, alignment);
+
+  while ((payload - HEAP_HDR_SIZE != base) &&
+         (payload - HEAP_HDR_SIZE - base < HEAP_MIN_BLOCK))
+      payload += alignment;
+
+  if (payload - HEAP_HDR_SIZE + need > base + heap_block_size(blk))
+      return 0;
+
+  return payload;
+}
+
+/* Returns a block to the free lists, merging it with free neighbours */
+static void heap_release(HEAP_BLOCK *blk)
+{
+  uint64_t size = heap_block_size(blk);
+  HEAP_BLOCK *next = (HEAP_BLOCK *)((uint64_t)blk + size);
+  HEAP_BLOCK *prev;
+
+  heap_stats.in_use -= size;
+  heap_stats.num_free++;
+
+  if (!heap_block_used(next)) {
+      heap_bin_remove(next);
+      size += heap_block_size(next);
+  }
+
+  if ((uint64_t)blk != heap_start) {
+      prev = (HEAP_BLOCK *)((uint64_t)blk - blk->prev_size);
+      if (!heap_block_used(prev)) {
+          heap_bin_remove(prev);
+          size += heap_block_size(prev);
+          blk = prev;
+      }
+  }
+
+  heap_set_block(blk, size, 0);
+  heap_bin_insert(blk);
+}
+
+/* Validates a pointer handed back to mem_free and returns its block header */
+static HEAP_BLOCK *heap_lookup(void *ptr)
+{
+  uint64_t addr = (uint64_t)ptr;
+  HEAP_BLOCK *blk;
+
+  if ((addr < heap_start + HEAP_HDR_SIZE) || (addr >= heap_end) ||
+      (addr & (HEAP_GRANULE - 1)))
+      return NULL;
+
+  blk = (HEAP_BLOCK *)(addr - HEAP_HDR_SIZE);
+  if (((blk->hdr & HEAP_MAGIC_MASK) != HEAP_BLOCK_MAGIC) ||
+      (heap_block_size(blk) < HEAP_MIN_BLOCK) ||
+      ((uint64_t)blk + heap_block_size(blk) > heap_end))
+      return NULL;
+
+  return blk;
+}
+
+/*
+ * PE index of the caller. VAL caches it in TPIDR_ELx, in the order of
+ * platform_pe_cfg, once the PE info table exists. Until then, the MPIDR is
+ * looked up in the platform table.
+ */
+static uint32_t heap_pe_index(void)
+{
+  uint64_t cached;
+  uint64_t mpidr;
+  uint32_t index;
+
+  if (((read_CurrentEL() >> 2) & 0x3) == 2)
+      cached = read_tpidr_el2();
+  else
+      cached = read_tpidr_el1();
+
+  if ((cached & PE_INDEX_TPIDR_TAG_MASK) == PE_INDEX_TPIDR_TAG) {
+      index = PE_INDEX_TPIDR_INDEX(cached);
+      return (index < HEAP_CACHE_MAX_PE) ? index : HEAP_NO_PE;
+  }
+
+  mpidr = read_mpidr_el1() & HEAP_MPIDR_AFF_MASK;
+  for (index = 0; index < platform_pe_cfg.header.num_of_pe && index < HEAP_CACHE_MAX_PE; index++)
+  {
+      if ((platform_pe_cfg.pe_info[index].mpidr & HEAP_MPIDR_AFF_MASK) == mpidr)
+          return index;
+  }
+
+  return HEAP_NO_PE;
+}
+
+/* Maps a block size to its per-PE cache class, or HEAP_CACHE_CLASSES if uncached */
+static uint32_t heap_cache_class(uint64_t size)
+{
+  uint32_t cls;
+
+  for (cls = 0; cls < HEAP_CACHE_CLASSES; cls++)
+  {
+      if (size == ((uint64_t)HEAP_MIN_BLOCK << cls))
+          return cls;
+  }
+
+  return HEAP_CACHE_CLASSES;
+}
+
+/**
+ * @brief  Initialisation of allocation data structure
+ * @param  void
+ * @return Void
+ **/
+void mem_alloc_init(void)
+{
+    uint64_t top = (PLATFORM_HEAP_REGION_BASE + PLATFORM_HEAP_REGION_SIZE) &
+                   ~((uint64_t)HEAP_GRANULE - 1);
+    HEAP_BLOCK *blk;
+    uint32_t index, cls;
+
+    heap_start = ADDR_ALIGN((uint64_t)PLATFORM_HEAP_REGION_BASE, HEAP_GRANULE);
+    heap_end = top - HEAP_HDR_SIZE;
+    heap_bin_map = 0;
+    heap_lock = 0;
+
+    for (index = 0; index < HEAP_NUM_CLASSES; index++)
+        heap_bins[index] = NULL;
+
+    for (index = 0; index < HEAP_CACHE_MAX_PE; index++)
+    {
+        for (cls = 0; cls < HEAP_CACHE_CLASSES; cls++)
+        {
+            heap_pe_cache[index].head[cls] = NULL;
+            heap_pe_cache[index].count[cls] = 0;
+        }
+        heap_pe_cache[index].hits = 0;
+    }
+
+    heap_stats.in_use = 0;
+    heap_stats.peak = 0;
+    heap_stats.num_alloc = 0;
+    heap_stats.num_free = 0;
+    heap_stats.num_failed = 0;
+
+    /* End sentinel: a zero sized in-use block stops forward coalescing */
+    blk = (HEAP_BLOCK *)heap_end;
+    blk->hdr = HEAP_BLOCK_MAGIC | HEAP_FLAG_USED;
+    blk->prev_size = 0;
+
+    if (heap_end >= heap_start + HEAP_MIN_BLOCK) {
+        blk = (HEAP_BLOCK *)heap_start;
+        blk->prev_size = 0;
+        heap_set_block(blk, heap_end - heap_start, 0);
+        heap_bin_insert(blk);
+    }
+
+    heap_init_done = HEAP_INITIALISED;
+}
+
+/**
+ * @brief Allocates a block from the global free lists. Caller holds the heap lock.
+ * @param alignment - alignment for the address. It must be in power of 2 and at least 16.
+ * @param Size - Size of the region. It must not be zero.
+ * @return - Returns allocated memory base address if allocation is successful.
+ *           Otherwise returns NULL.
+ **/
+void *heap_alloc(size_t alignment, size_t size)
+{
+    uint64_t need, payload = 0, gap, rest;
+    uint32_t cls;
+    HEAP_BLOCK *blk = NULL, *split;
+
+    if (size > heap_end - heap_start)
+        return NULL;
+
+    need = ADDR_ALIGN((uint64_t)size, HEAP_GRANULE) + HEAP_HDR_SIZE;
+    if (need < HEAP_MIN_BLOCK)
+        need = HEAP_MIN_BLOCK;
+
+    /* First fit, starting at the class of the request and moving up */
+    for (cls = heap_class(need); cls < HEAP_NUM_CLASSES && !payload; cls++)
+    {
+        if (!(heap_bin_map & (1U << cls)))
+            continue;
+        for (blk = heap_bins[cls]; blk != NULL; blk = blk->next)
+        {
+            payload = heap_fit(blk, need, alignment);
+            if (payload)
+                break;
+        }
+    }
+
+    if (!payload)
+        return NULL;
+
+    heap_bin_remove(blk);
+    rest = heap_block_size(blk);
+
+    /* Give the alignment gap in front of the payload back to the free lists */
+    gap = payload - HEAP_HDR_SIZE - (uint64_t)blk;
+    if (gap) {
+        heap_set_block(blk, gap, 0);
+        heap_bin_insert(blk);
+        blk = (HEAP_BLOCK *)(payload - HEAP_HDR_SIZE);
+        rest -= gap;
+    }
+
+    /* Split off the tail if it can hold a block of its own */
+    if (rest - need >= HEAP_MIN_BLOCK) {
+        split = (HEAP_BLOCK *)((uint64_t)blk + need);
+        heap_set_block(split, rest - need, 0);
+        heap_bin_insert(split);
+        rest = need;
+    }
+
+    heap_set_block(blk, rest, 1);
+
+    heap_stats.in_use += rest;
+    heap_stats.num_alloc++;
+    if (heap_stats.in_use > heap_stats.peak)
+        heap_stats.peak = heap_stats.in_use;
+
+    return (void *)payload;
+}
+
+/**
+ * @brief Allocates contiguous memory of requested size(no_of_bytes) and alignment.
+ * @param alignment - alignment for the address. It must be in power of 2.
+ * @param Size - Size of the region. It must not be zero.
+ * @return - Returns allocated memory base address if allocation is successful.
+ *           Otherwise returns NULL.
+ **/
+void *mem_alloc(size_t alignment, size_t size)
+{
+  void *addr = NULL;
+  HEAP_PE_CACHE *cache;
+  HEAP_BLOCK *blk;
+  uint64_t block_size;
+  uint32_t pe_index, cls;
+
+  if (heap_init_done != HEAP_INITIALISED)
+    mem_alloc_init();
+
+  if (size == 0)
+  {
+    return NULL;
+  }
+
+  if (!is_power_of_2((uint32_t)alignment))
+  {
+    return NULL;
+  }
+
+  if (alignment < HEAP_GRANULE)
+    alignment = HEAP_GRANULE;
+
+  /* Small requests are rounded up to a cache class and served from the PE cache */
+  if ((alignment == HEAP_GRANULE) && (size <= HEAP_CACHE_MAX_BLOCK - HEAP_HDR_SIZE)) {
+    block_size = HEAP_MIN_BLOCK;
+    while (block_size - HEAP_HDR_SIZE < size)
+      block_size <<= 1;
+    size = block_size - HEAP_HDR_SIZE;
+
+    pe_index = heap_pe_index();
+    if (pe_index != HEAP_NO_PE) {
+      cache = &heap_pe_cache[pe_index];
+      cls = heap_cache_class(block_size);
+      blk = cache->head[cls];
+      if (blk) {
+        cache->head[cls] = blk->next;
+        cache->count[cls]--;
+        blk->hdr &= ~HEAP_FLAG_CACHED;
+        cache->hits++;
+        return (void *)((uint64_t)blk + HEAP_HDR_SIZE);
+      }
+    }
+  }
+
+  heap_lock_acquire();
+  addr = heap_alloc(alignment, size);
+  if (addr == NULL)
+    heap_stats.num_failed++;
+  heap_lock_release();
+
+  return addr;
+}
+
+/**
+ * @brief Frees memory returned by mem_alloc. Pointers outside the heap are ignored.
+ * @param ptr - Base address returned by mem_alloc.
+ * @return None
+ **/
+void mem_free(void *ptr)
+{
+  HEAP_PE_CACHE *cache;
+  HEAP_BLOCK *blk;
+  uint32_t pe_index, cls;
+
+  if (!ptr || heap_init_done != HEAP_INITIALISED)
+    return;
+
+  blk = heap_lookup(ptr);
+  if (blk == NULL)
+    return;
+
+  if (!heap_block_used(blk) || (blk->hdr & HEAP_FLAG_CACHED)) {
+    print(ACS_PRINT_WARN, "\n       Heap: double free of 0x%llx ignored", (uint64_t)ptr);
+    return;
+  }
+
+  /* Cached blocks stay marked in use so that neighbours never merge with them */
+  cls = heap_cache_class(heap_block_size(blk));
+  if (cls < HEAP_CACHE_CLASSES) {
+    pe_index = heap_pe_index();
+    if (pe_index != HEAP_NO_PE) {
+      cache = &heap_pe_cache[pe_index];
+      if (cache->count[cls] < HEAP_CACHE_DEPTH) {
+        blk->hdr |= HEAP_FLAG_CACHED;
+        blk->next = cache->head[cls];
+        cache->head[cls] = blk;
+        cache->count[cls]++;
+        return;
+      }
+    }
+  }
+
+  heap_lock_acquire();
+  heap_release(blk);
+  heap_lock_release();
+}
+
+/**
+  @brief  Returns the blocks held in the per-PE caches to the free lists and
+          prints heap usage and fragmentation statistics at debug verbosity.
+          Must be called from the primary PE once the secondary PEs are idle.
+
+  @return None
+**/
+void
+pal_heap_print_stats(void)
+{
+  HEAP_BLOCK *blk;
+  uint64_t free_bytes = 0, largest = 0, hits = 0, size;
+  uint32_t free_blocks = 0, frag = 0, index, cls;
+
+  if (heap_init_done != HEAP_INITIALISED)
+    return;
+
+  heap_lock_acquire();
+
+  for (index = 0; index < HEAP_CACHE_MAX_PE; index++)
+  {
+      hits += heap_pe_cache[index].hits;
+      for (cls = 0; cls < HEAP_CACHE_CLASSES; cls++)
+      {
+          while ((blk = heap_pe_cache[index].head[cls]) != NULL) {
+              heap_pe_cache[index].head[cls] = blk->next;
+              heap_release(blk);
+          }
+          heap_pe_cache[index].count[cls] = 0;
+      }
+  }
+
+  for (cls = 0; cls < HEAP_NUM_CLASSES; cls++)
+  {
+      for (blk = heap_bins[cls]; blk != NULL; blk = blk->next)
+      {
+          size = heap_block_size(blk);
+          free_bytes += size;
+          free_blocks++;
+          if (size > largest)
+              largest = size;
+      }
+  }
+
+  heap_lock_release();
+
+  /* Share of free memory that cannot be handed out as one contiguous block */
+  if (free_bytes)
+      frag = (uint32_t)(100 - (largest * 100) / free_bytes);
+
+  print(ACS_PRINT_DEBUG, "\n Heap: size 0x%llx, peak usage 0x%llx, in use 0x%llx",
+        heap_end - heap_start, heap_stats.peak, heap_stats.in_use);
+  print(ACS_PRINT_DEBUG, "\n Heap: free 0x%llx in %d blocks, largest 0x%llx, fragmentation %d%%\n",
+        free_bytes, free_blocks, largest, frag);
+  print(ACS_PRINT_INFO, "\n Heap: allocs %lld, frees %lld, failed %lld, PE cache hits %lld\n",
+        heap_stats.num_alloc, heap_stats.num_free, heap_stats.num_failed, hits);
+}
@@ -20,6 +20,7 @@
 #include "pal_pcie_enum.h"
 #include "pal_common_support.h"
 #include "pal_pl011_uart.h"
+#include "pal_sysreg.h"
 
 extern void* g_sbsa_log_file_handle;
 uint8_t   *gSharedMemory;
@@ -34,6 +35,76 @@ uint8_t   *gSharedMemory;
     (((_lcount) == 1) ? va_arg(_args, unsigned long int) :      \
                 va_arg(_args, unsigned int)))
 
+/* A target that models the device registers defines these before this file */
+#ifndef PAL_MMIO_READ
+#define PAL_MMIO_READ(type, addr)         (*(volatile type *)(addr))
+#define PAL_MMIO_WRITE(type, addr, data)  (*(volatile type *)(addr) = (data))
+#endif
+
+#define MMIO_RECORD_WRITE     0x1
+#define MMIO_RECORD_AFF_MASK  0xFF00FFFFFFULL
+#define MMIO_RECORD_MAX       (1u << 26)    /* 2GB ring, pal_mem_alloc takes 32 bits */
+#define MMIO_RECORD_DRAIN_MS  1000          /* wait for in-flight records at dump */
+
+/* One MMIO access, 32 bytes, dumped field by field by pal_mmio_record_dump() */
+typedef struct {
+  uint64_t addr;
+  uint64_t value;
+  uint64_t timestamp;   /* CNTVCT_EL0 at the time of the access */
+  uint32_t mpidr;       /* Aff2:Aff1:Aff0, Aff3 in bits [31:24] */
+  uint8_t  width;       /* access size in bytes */
+  uint8_t  flags;       /* MMIO_RECORD_WRITE */
+  uint16_t reserved;
+} MMIO_RECORD;
+
+/* Run before every print, see pal_print_set_sync_hook() */
+static void (*g_print_sync_hook)(void);
+
+/* Ring of the most recent accesses, NULL when recording is off */
+static MMIO_RECORD *g_mmio_ring;
+static uint64_t    g_mmio_ring_mask;
+static uint64_t    g_mmio_ring_next;
+static uint32_t    g_mmio_ring_writers;   /* PEs between ring load and record */
+
+/**
+  @brief  Appends an MMIO access to the record ring. Any PE may call this;
+          each access claims its own slot so no lock is needed. The writer
+          count keeps pal_mmio_record_dump() from freeing the ring under it.
+
+  @param  addr   Accessed address
+  @param  value  Value read or written
+  @param  width  Access size in bytes
+  @param  flags  MMIO_RECORD_WRITE for writes
+
+  @return None
+**/
+static inline void
+pal_mmio_record(uint64_t addr, uint64_t value, uint8_t width, uint8_t flags)
+{
+  MMIO_RECORD *ring;
+  MMIO_RECORD *rec;
+  uint64_t mpidr;
+
+  __atomic_fetch_add(&g_mmio_ring_writers, 1, __ATOMIC_SEQ_CST);
+  ring = __atomic_load_n(&g_mmio_ring, __ATOMIC_SEQ_CST);
+  if (ring == NULL) {
+      __atomic_fetch_sub(&g_mmio_ring_writers, 1, __ATOMIC_RELEASE);
+      return;
+  }
+
+  rec = &ring[__atomic_fetch_add(&g_mmio_ring_next, 1, __ATOMIC_RELAXED) & g_mmio_ring_mask];
+  mpidr = read_mpidr_el1() & MMIO_RECORD_AFF_MASK;
+
+  rec->addr      = addr;
+  rec->value     = value;
+  rec->timestamp = read_cntvct_el0();
+  rec->mpidr     = (uint32_t)((mpidr & 0xFFFFFF) | ((mpidr >> 8) & 0xFF000000));
+  rec->width     = width;
+  rec->flags     = flags;
+
+  __atomic_fetch_sub(&g_mmio_ring_writers, 1, __ATOMIC_RELEASE);
+}
+
 /**
   @brief  Provides a single point of abstraction to read from all
           Memory Mapped IO address
@@ -47,7 +118,9 @@ pal_mmio_read8(uint64_t addr)
 {
   uint8_t data;
 
-  data = (*(volatile uint8_t *)addr);
+  data = PAL_MMIO_READ(uint8_t, addr);
+  if (g_mmio_ring != NULL)
+      pal_mmio_record(addr, data, 1, 0);
   if (acs_policy_get_print_mmio() || (g_curr_module & g_enable_module))
       print(ACS_PRINT_INFO, " pal_mmio_read8 Address = %llx  Data = %lx\n", addr, data);
 
@@ -67,7 +140,9 @@ pal_mmio_read16(uint64_t addr)
 {
   uint16_t data;
 
-  data = (*(volatile uint16_t *)addr);
+  data = PAL_MMIO_READ(uint16_t, addr);
+  if (g_mmio_ring != NULL)
+      pal_mmio_record(addr, data, 2, 0);
   if (acs_policy_get_print_mmio() || (g_curr_module & g_enable_module))
       print(ACS_PRINT_INFO, " pal_mmio_read16 Address = %llx  Data = %lx\n", addr, data);
 
@@ -87,7 +162,9 @@ pal_mmio_read64(uint64_t addr)
 {
   uint64_t data;
 
-  data = (*(volatile uint64_t *)addr);
+  data = PAL_MMIO_READ(uint64_t, addr);
+  if (g_mmio_ring != NULL)
+      pal_mmio_record(addr, data, 8, 0);
   if (acs_policy_get_print_mmio() || (g_curr_module & g_enable_module))
       print(ACS_PRINT_INFO, " pal_mmio_read64 Address = %llx  Data = %llx\n", addr, data);
 
@@ -108,7 +185,9 @@ pal_mmio_read(uint64_t addr)
 
   uint32_t data;
 
-  data = (*(volatile uint32_t *)addr);
+  data = PAL_MMIO_READ(uint32_t, addr);
+  if (g_mmio_ring != NULL)
+      pal_mmio_record(addr, data, 4, 0);
   if (acs_policy_get_print_mmio() || (g_curr_module & g_enable_module))
       print(ACS_PRINT_INFO, " pal_mmio_read Address = %8x  Data = %x\n", addr, data);
 
@@ -131,7 +210,9 @@ pal_mmio_write8(uint64_t addr, uint8_t data)
   if (acs_policy_get_print_mmio() || (g_curr_module & g_enable_module))
       print(ACS_PRINT_INFO, " pal_mmio_write8 Address = %llx  Data = %lx\n", addr, data);
 
-  *(volatile uint8_t *)addr = data;
+  PAL_MMIO_WRITE(uint8_t, addr, data);
+  if (g_mmio_ring != NULL)
+      pal_mmio_record(addr, data, 1, MMIO_RECORD_WRITE);
 }
 
 /**
@@ -149,7 +230,9 @@ pal_mmio_write16(uint64_t addr, uint16_t data)
   if (acs_policy_get_print_mmio() || (g_curr_module & g_enable_module))
       print(ACS_PRINT_INFO, " pal_mmio_write16 Address = %llx  Data = %lx\n", addr, data);
 
-  *(volatile uint16_t *)addr = data;
+  PAL_MMIO_WRITE(uint16_t, addr, data);
+  if (g_mmio_ring != NULL)
+      pal_mmio_record(addr, data, 2, MMIO_RECORD_WRITE);
 }
 
 /**
@@ -167,7 +250,9 @@ pal_mmio_write64(uint64_t addr, uint64_t data)
   if (acs_policy_get_print_mmio() || (g_curr_module & g_enable_module))
       print(ACS_PRINT_INFO, " pal_mmio_write64 Address = %llx  Data = %llx\n", addr, data);
 
-  *(volatile uint64_t *)addr = data;
+  PAL_MMIO_WRITE(uint64_t, addr, data);
+  if (g_mmio_ring != NULL)
+      pal_mmio_record(addr, data, 8, MMIO_RECORD_WRITE);
 }
 
 /**
@@ -186,7 +271,9 @@ pal_mmio_write(uint64_t addr, uint32_t data)
   if (acs_policy_get_print_mmio() || (g_curr_module & g_enable_module))
       print(ACS_PRINT_INFO, " pal_mmio_write Address = %8x  Data = %x\n", addr, data);
 
-    *(volatile uint32_t *)addr = data;
+    PAL_MMIO_WRITE(uint32_t, addr, data);
+    if (g_mmio_ring != NULL)
+        pal_mmio_record(addr, data, 4, MMIO_RECORD_WRITE);
 }
 
 /**
@@ -203,6 +290,10 @@ pal_print_raw(uint64_t addr, char *string, uint64_t data)
 {
     uint8_t j, buffer[16];
     uint8_t  i=0;
+
+    if (g_print_sync_hook != NULL)
+        g_print_sync_hook();
+
     for(;*string!='\0';++string){
         if(*string == '%'){
             ++string;
@@ -223,12 +314,12 @@ pal_print_raw(uint64_t addr, char *string, uint64_t data)
             }
             if(i>0) {
                 while(i!=0)
-                    *(volatile uint8_t *)addr = buffer[--i];
+                    PAL_MMIO_WRITE(uint8_t, addr, buffer[--i]);
             } else
-                *(volatile uint8_t *)addr = 48;
+                PAL_MMIO_WRITE(uint8_t, addr, 48);
 
         } else
-            *(volatile uint8_t *)addr = *string;
+            PAL_MMIO_WRITE(uint8_t, addr, *string);
     }
 }
 
@@ -319,6 +410,91 @@ pal_mem_calloc(uint32_t num, uint32_t Size)
 }
 
 
+/**
+  @brief  Starts recording every pal_mmio_* access in a memory ring. Once the
+          ring is full the oldest records are overwritten.
+
+  @param  num_records  Ring size in records, rounded down to a power of two
+
+  @return 0 on success, 1 if the ring could not be allocated
+**/
+uint32_t
+pal_mmio_record_start(uint32_t num_records)
+{
+  MMIO_RECORD *ring;
+  uint32_t size = 1;
+
+  if (num_records == 0 || g_mmio_ring != NULL)
+      return 1;
+
+  while (size <= num_records / 2 && size < MMIO_RECORD_MAX)
+      size <<= 1;
+
+  ring = pal_mem_alloc(size * sizeof(MMIO_RECORD));
+  if (ring == NULL) {
+      print(ACS_PRINT_WARN, "\n MMIO record: ring of %d records not allocated", size);
+      return 1;
+  }
+
+  g_mmio_ring_mask = size - 1;
+  g_mmio_ring_next = 0;
+  __atomic_store_n(&g_mmio_ring, ring, __ATOMIC_RELEASE);
+  return 0;
+}
+
+/**
+  @brief  Stops recording and dumps the ring to the console, oldest record
+          first, as a block that tools/scripts/acs_mmio_replay.py reads:
+
+          @ACSMMIO records=<n> total=<accesses seen> freq=<CNTFRQ>
+          <addr:16><value:16><timestamp:16><mpidr:8><width:2><flags:2>
+          @ACSMMIO end
+
+          The block is printed whatever the verbosity and the ring is freed
+          once no PE is still writing a record. A ring that does not drain
+          in MMIO_RECORD_DRAIN_MS is dumped as is and left allocated.
+
+  @return None
+**/
+void
+pal_mmio_record_dump(void)
+{
+  MMIO_RECORD *ring = __atomic_exchange_n(&g_mmio_ring, NULL, __ATOMIC_SEQ_CST);
+  MMIO_RECORD *rec;
+  uint64_t total, count, index, timeout;
+  uint32_t writers;
+
+  if (ring == NULL)
+      return;
+
+  /* New accesses now skip the ring, wait for the ones that already hold it */
+  timeout = read_cntvct_el0() +
+            pal_timer_get_counter_frequency() * MMIO_RECORD_DRAIN_MS / 1000;
+  while ((writers = __atomic_load_n(&g_mmio_ring_writers, __ATOMIC_SEQ_CST)) != 0 &&
+         read_cntvct_el0() < timeout)
+      pal_pe_data_cache_ops_by_va((uint64_t)&g_mmio_ring_writers, INVALIDATE);
+
+  total = g_mmio_ring_next;
+  count = (total > g_mmio_ring_mask) ? g_mmio_ring_mask + 1 : total;
+
+  print(ACS_PRINT_ERR, "\n@ACSMMIO records=%lld total=%lld freq=%lld\n",
+        count, total, pal_timer_get_counter_frequency());
+  for (index = total - count; index < total; index++) {
+      rec = &ring[index & g_mmio_ring_mask];
+      print(ACS_PRINT_ERR, "%016llx%016llx%016llx%08x%02x%02x\n", rec->addr, rec->value,
+            rec->timestamp, rec->mpidr, rec->width, rec->flags);
+  }
+  print(ACS_PRINT_ERR, "@ACSMMIO end\n");
+
+  if (writers != 0) {
+      print(ACS_PRINT_WARN, "\n MMIO record: %d writers still active, ring not freed\n",
+            writers);
+      return;
+  }
+
+  pal_mem_free(ring);
+}
+
 /**
   @brief  Allocate memory which is to be used to share data across PEs
 
@@ -616,11 +792,27 @@ const char *log_get_prefix(int log_level)
         return prefix_str[level - 1];
 }
 
+/**
+  @brief  Registers a function run before every PAL print, which VAL uses to
+          put out its pending binary log records ahead of the PAL text.
+
+  @param  hook  Function to run, NULL for none
+
+  @return None
+**/
+void pal_print_set_sync_hook(void (*hook)(void))
+{
+        g_print_sync_hook = hook;
+}
+
 void pal_uart_print(int log, const char *fmt, ...)
 {
         va_list args;
         const char *prefix_str;
 
+        if (g_print_sync_hook != NULL)
+                g_print_sync_hook();
+
         prefix_str = log_get_prefix(log);
 
         while (*prefix_str != '\0') {
@@ -24,6 +24,8 @@ extern const PCIE_INFO_TABLE platform_pcie_cfg;
 extern const PCIE_READ_TABLE platform_pcie_device_hierarchy;
 extern PERIPHERAL_INFO_TABLE  *g_peripheral_info_table;
 
+static uint64_t (*g_pcie_ecam_resolver)(uint32_t seg, uint32_t bus);
+
 uint64_t
 pal_pcie_get_mcfg_ecam(uint32_t bdf)
 {
@@ -64,6 +66,20 @@ pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable)
   return;
 }
 
+/**
+  @brief  Registers the ECAM resolver backed by the VAL segment/bus map.
+          NULL drops back to scanning the platform PCIe table.
+
+  @param  resolve  Resolver returning the ECAM base of a segment/bus, 0 if unknown
+
+  @return None
+**/
+void
+pal_pcie_set_ecam_resolver(uint64_t (*resolve)(uint32_t seg, uint32_t bus))
+{
+  g_pcie_ecam_resolver = resolve;
+}
+
 /**
   @brief  Returns the ECAM address of the input PCIe bridge function
 
@@ -86,6 +102,12 @@ pal_pcie_ecam_base(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t func)
   ecam_index = 0;
   ecam_base = 0;
 
+  /* Resolve through the ECAM map once VAL has registered it */
+  if (g_pcie_ecam_resolver != NULL) {
+      ecam_base = g_pcie_ecam_resolver(seg, bus);
+      if (ecam_base)
+          return ecam_base;
+  }
 
   while (ecam_index < platform_pcie_cfg.num_entries)
   {
@@ -118,7 +140,6 @@ pal_pcie_read_cfg(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t func, uint3
   uint32_t cfg_addr;
   uint64_t ecam_base = pal_pcie_ecam_base(seg, bus, dev, func);
 
-  ecam_base = pal_pcie_ecam_base(seg, bus, dev, func);
   cfg_addr = (bus * PCIE_MAX_DEV * PCIE_MAX_FUNC * 4096) + \
                (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
 
@@ -38,6 +38,9 @@ static uint32_t g_bar32_p_max;
 static uint32_t g_np_bar_size, g_p_bar_size;
 static uint32_t g_np_bus, g_p_bus;
 
+/* Vendor ID probes issued by the enumeration */
+static uint32_t g_enum_probes;
+
 /**
   @brief   This API reads 32-bit data from PCIe config space pointed by Bus,
            Device, Function and register offset.
@@ -438,6 +441,7 @@ uint32_t pal_pcie_enumerate_device(uint32_t bus, uint32_t sec_bus)
   uint32_t com_reg_value;
   uint32_t bar32_p_limit;
   uint32_t bar32_np_limit;
+  uint32_t max_func;
 
   seg = g_pcie_info_table->block[pcie_index].segment_num;
   if (bus == ((g_pcie_info_table->block[pcie_index].end_bus_num) + 1))
@@ -449,11 +453,22 @@ uint32_t pal_pcie_enumerate_device(uint32_t bus, uint32_t sec_bus)
 
   for (dev = 0; dev < PCIE_MAX_DEV; dev++)
   {
-    for (func = 0; func < PCIE_MAX_FUNC; func++)
+    max_func = PCIE_MAX_FUNC;
+    for (func = 0; func < max_func; func++)
     {
+        g_enum_probes++;
         pal_pci_cfg_read(seg, bus, dev, func, 0, &vendor_id);
-        if ((vendor_id == 0x0) || (vendor_id == 0xFFFFFFFF))
+        if ((vendor_id == 0x0) || (vendor_id == 0xFFFFFFFF)) {
+                /* A device without function 0 has no other function */
+                if ((func == 0) && acs_policy_get_pcie_enum_prune())
+                        break;
                 continue;
+        }
+
+        /* Functions 1-7 exist only in multi-function devices */
+        pal_pci_cfg_read(seg, bus, dev, func, HEADER_OFFSET, &header_value);
+        if ((func == 0) && !PCIE_HEADER_MF(header_value) && acs_policy_get_pcie_enum_prune())
+                max_func = 1;
 
         /*Skip Hostbridge configuration*/
         pal_pci_cfg_read(seg, bus, dev, func, TYPE01_RIDR, &class_code);
@@ -463,7 +478,6 @@ uint32_t pal_pcie_enumerate_device(uint32_t bus, uint32_t sec_bus)
 
         print(ACS_PRINT_INFO, "The Vendor id read is %x\n", vendor_id);
         print(ACS_PRINT_INFO, "Valid PCIe device found at %x %x %x\n ", bus, dev, func);
-        pal_pci_cfg_read(seg, bus, dev, func, HEADER_OFFSET, &header_value);
         if (PCIE_HEADER_TYPE(header_value) == TYPE1_HEADER)
         {
             print(ACS_PRINT_INFO, "TYPE1 HEADER found\n", 0);
@@ -535,19 +549,29 @@ pal_clear_pri_bus()
     uint32_t bus_value;
     uint32_t header_value;
     uint32_t vendor_id;
+    uint32_t max_func;
 
     seg = g_pcie_info_table->block[pcie_index].segment_num;
     for (bus = 0; bus <= g_pcie_info_table->block[pcie_index].end_bus_num; bus++)
     {
         for (dev = 0; dev < PCIE_MAX_DEV; dev++)
         {
-            for (func = 0; func < PCIE_MAX_FUNC; func++)
+            max_func = PCIE_MAX_FUNC;
+            for (func = 0; func < max_func; func++)
             {
+                g_enum_probes++;
                 pal_pci_cfg_read(seg, bus, dev, func, 0, &vendor_id);
-                if ((vendor_id == 0x0) || (vendor_id == 0xFFFFFFFF))
+                if ((vendor_id == 0x0) || (vendor_id == 0xFFFFFFFF)) {
+                        if ((func == 0) && acs_policy_get_pcie_enum_prune())
+                                break;
                         continue;
+                }
 
                 pal_pci_cfg_read(seg, bus, dev, func, HEADER_OFFSET, &header_value);
+                if ((func == 0) && !PCIE_HEADER_MF(header_value) &&
+                    acs_policy_get_pcie_enum_prune())
+                        max_func = 1;
+
                 if (PCIE_HEADER_TYPE(header_value) == TYPE1_HEADER)
                 {
                     pal_pci_cfg_read(seg, bus, dev, func, BUS_NUM_REG_OFFSET, &bus_value);
@@ -574,6 +598,7 @@ void pal_pcie_enumerate(void)
     g_p_bar_size   = 0;
     g_np_bus       = 0;
     g_p_bus        = 0;
+    g_enum_probes  = 0;
 
     if (g_pcie_info_table->num_entries == 0)
     {
@@ -603,6 +628,7 @@ void pal_pcie_enumerate(void)
        }
        pcie_index++;
     }
+    print(ACS_PRINT_INFO, "Enumeration config probes : %d\n", g_enum_probes);
     enumerate = 0;
     pcie_index = 0;
 }
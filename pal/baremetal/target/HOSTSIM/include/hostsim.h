@@ -0,0 +1,158 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#ifndef _HOSTSIM_H_
+#define _HOSTSIM_H_
+
+/*
+ * Internal interface of the HOSTSIM platform model.
+ *
+ * Every simulated PE is a host thread. The model keeps per-PE system
+ * registers, a GICv3, the generic timers and watchdogs, the SMMUv3 register
+ * files and a PCIe hierarchy behind ECAM; a recorded MMIO trace can stand in
+ * for the other devices. MMIO from the PAL reaches the
+ * models through pal_hostsim_mmio_read/write(); plain loads and stores from
+ * tests reach lazily mapped RAM, and anything else raises a synchronous
+ * exception on the PE that made the access.
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+
+#define HS_MAX_PE             256
+#define HS_MAX_SYSREG         512
+#define HS_NUM_PRIV_INTR      32        /* SGIs and PPIs */
+#define HS_MAX_INTR           1024      /* SGIs, PPIs and SPIs */
+
+/* DAIF bits as held in the DAIF register */
+#define HS_DAIF_F             (1u << 6)
+#define HS_DAIF_I             (1u << 7)
+#define HS_DAIF_ALL           0x3C0u
+
+/* Exception types passed to common_exception_handler() */
+#define HS_EXC_SYNC           0
+#define HS_EXC_IRQ            1
+
+typedef struct hs_pe HS_PE;
+
+/* Register model hooks, called with the state of the accessing PE */
+typedef uint64_t (*hs_sysreg_read_fn)(HS_PE *pe, uint32_t slot);
+typedef void     (*hs_sysreg_write_fn)(HS_PE *pe, uint32_t slot, uint64_t value);
+
+typedef uint64_t (*hs_mmio_read_fn)(void *ctx, uint64_t offset, uint32_t width);
+typedef void     (*hs_mmio_write_fn)(void *ctx, uint64_t offset, uint64_t value, uint32_t width);
+
+struct hs_pe {
+  uint32_t          index;
+  uint64_t          mpidr;            /* MPIDR_EL1 as read by the PE */
+  pthread_t         thread;
+  volatile uint32_t state;            /* HS_PE_OFF, HS_PE_ON_PENDING, HS_PE_ON */
+  uint64_t          entry;            /* CPU_ON entry point and context */
+  uint64_t          context_id;
+
+  /* Exception state */
+  uint64_t          elr;
+  uint64_t          esr;
+  uint64_t          far;
+  uint32_t          exc_depth;
+
+  /* Interrupt delivery */
+  volatile uint32_t in_model;         /* > 0 while the PE executes model code */
+  volatile uint32_t irq_deferred;     /* kick received while in_model */
+  volatile uint32_t wake;             /* futex word for WFI/WFE */
+
+  uint64_t          sysreg[HS_MAX_SYSREG];
+};
+
+enum {
+  HS_PE_OFF = 0,
+  HS_PE_ON_PENDING,
+  HS_PE_ON
+};
+
+/* Global simulation parameters, set by hostsim_main.c */
+typedef struct {
+  uint32_t num_pe;
+  uint64_t cntfrq;                    /* counter frequency reported to the PEs */
+  uint32_t timescale;                 /* counter ticks this much faster than host time */
+  uint32_t trace;                     /* print model events */
+  const char *topology;               /* PCIe topology file, NULL for the platform default */
+  const char *replay;                 /* exported MMIO recording, NULL for none */
+  uint32_t check;                     /* run the host checks instead of the suite */
+  uint32_t check_print_level;
+} HS_CONFIG;
+
+extern HS_CONFIG g_hs_config;
+extern HS_PE     g_hs_pe[HS_MAX_PE];
+extern __thread HS_PE *hs_self;
+
+/* hostsim_main.c */
+void hs_fatal(const char *fmt, ...) __attribute__((noreturn, format(printf, 1, 2)));
+void hs_trace(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/* hostsim_pe.c */
+void     hs_pe_init(void);
+void     hs_pe_start_primary(void (*entry)(void));
+void     hs_model_enter(HS_PE *pe);
+void     hs_model_exit(HS_PE *pe);
+void     hs_pe_kick(HS_PE *pe);
+HS_PE   *hs_pe_by_mpidr(uint64_t mpidr);
+uint32_t hs_sysreg_define(const char *name, uint64_t reset,
+                          hs_sysreg_read_fn read, hs_sysreg_write_fn write);
+uint64_t hs_sysreg_get(HS_PE *pe, uint32_t slot);
+void     hs_sysreg_set(HS_PE *pe, uint32_t slot, uint64_t value);
+
+/* hostsim_mem.c */
+void     hs_mem_init(void);
+void     hs_region_add(const char *name, uint64_t base, uint64_t size, void *ctx,
+                       hs_mmio_read_fn read, hs_mmio_write_fn write);
+int      hs_region_overlaps(uint64_t base, uint64_t size);
+int      hs_mem_lazy_map(uint64_t addr);
+int      hs_mem_emulate(void *ucontext, uint64_t addr);
+uint32_t hs_mem_insn_length(uint64_t ip);
+void     hs_symbols_load(void);
+uint64_t hs_symbol_function(uint64_t addr, const char **name);
+
+/* hostsim_gic.c */
+void     hs_gic_init(void);
+void     hs_gic_set_level(HS_PE *pe, uint32_t intid, uint32_t level);
+void     hs_gic_set_pending(HS_PE *pe, uint32_t intid);
+uint32_t hs_gic_irq_pending(HS_PE *pe);
+
+/* hostsim_timer.c */
+void     hs_timer_init(void);
+uint64_t hs_timer_counter(void);
+void     hs_timer_update_pe(HS_PE *pe);
+
+/* hostsim_smmu.c */
+void     hs_smmu_init(void);
+
+/* hostsim_pcie.c */
+void     hs_pcie_init(void);
+int      hs_pcie_bar_contains(uint64_t addr);
+
+/* hostsim_check.c */
+void     hs_check_select(const char *list);
+void     hs_check_usage(void);
+void     hs_check_main(void);
+uint32_t hs_check_failed(void);
+
+/* hostsim_replay.c */
+void     hs_replay_init(const char *path);
+void     hs_replay_report(void);
+
+#endif /* _HOSTSIM_H_ */
@@ -0,0 +1,81 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#ifndef _HOSTSIM_SYSREG_H_
+#define _HOSTSIM_SYSREG_H_
+
+/*
+ * Included ahead of every source of the HOSTSIM build (see CMakeLists.txt).
+ * The generator macros of val_sysreg.h and pal_sysreg.h are only defined
+ * there when they are not defined yet, so the accessors they create call
+ * the model of the simulated PE instead of executing system instructions.
+ * The MMIO accessors of pal_misc.c are hooked the same way and reach the
+ * device models of hostsim_mem.c.
+ */
+
+unsigned long pal_hostsim_sysreg_read(const char *reg_name);
+void pal_hostsim_sysreg_write(const char *reg_name, unsigned long v);
+void pal_hostsim_sysop(const char *op);
+unsigned long pal_hostsim_mmio_read(unsigned long addr, unsigned int width);
+void pal_hostsim_mmio_write(unsigned long addr, unsigned long data,
+                            unsigned int width);
+
+#define PAL_MMIO_READ(type, addr)                       \
+    ((type)pal_hostsim_mmio_read(addr, sizeof(type)))
+
+#define PAL_MMIO_WRITE(type, addr, data)                \
+    pal_hostsim_mmio_write(addr, data, sizeof(type))
+
+#define SYSOP_FUNC(_op)                                 \
+static inline void _op(void)                            \
+{                                                       \
+    pal_hostsim_sysop(#_op);                            \
+}
+
+#define SYSOP_TYPE_FUNC(_op, _type)                     \
+static inline void _op ## _type(void)                   \
+{                                                       \
+    pal_hostsim_sysop(#_op);                            \
+}
+
+#define SYSOP_TYPE_PARAM_FUNC(_op, _type)               \
+static inline void _op ## _type(unsigned long long v)   \
+{                                                       \
+    (void)v;                                            \
+    pal_hostsim_sysop(#_op);                            \
+}
+
+#define _SYSREG_READ_FUNC(_name, _reg_name)             \
+static inline unsigned long read_ ## _name(void)        \
+{                                                       \
+    return pal_hostsim_sysreg_read(#_reg_name);         \
+}
+
+#define _SYSREG_WRITE_FUNC(_name, _reg_name)            \
+static inline void write_ ## _name(unsigned long v)     \
+{                                                       \
+    pal_hostsim_sysreg_write(#_reg_name, v);            \
+}
+
+#define SYSREG_WRITE_CONST(reg_name, v)                 \
+    pal_hostsim_sysreg_write(#reg_name, v)
+
+/* Define read function for system register */
+#define SYSREG_READ_FUNC(_name)             \
+    _SYSREG_READ_FUNC(_name, _name)
+
+#endif /* _HOSTSIM_SYSREG_H_ */
@@ -0,0 +1,764 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * Host checks of the HOSTSIM platform.
+ *
+ * With -check, the primary PE runs the named checks instead of the ACS main
+ * of the build. They exercise VAL and PAL code paths directly, against the
+ * same platform models as the rules, and print one PASSED or FAILED line
+ * each. Benchmarks print their rates and fail only when their results are
+ * wrong.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hostsim.h"
+#include "acs.h"
+#include "acs_runtime_init.h"
+#include "val/include/acs_val.h"
+#include "val/include/acs_common.h"
+#include "val/include/acs_pe.h"
+#include "val/include/acs_pcie.h"
+#include "val/include/val_interface.h"
+#include "val/include/acs_execution_policy.h"
+#include "val/include/acs_run_request.h"
+#include "val/include/acs_nist.h"
+#include "val/include/pal_interface.h"
+#include "val/driver/gic/its/acs_gic_its.h"
+
+#define HS_BENCH_SECONDS      0.2
+
+#define HS_HEAP_SLOTS         32
+#define HS_HEAP_ROUNDS        20000
+#define HS_HEAP_MAX_SIZE      16384
+
+#define HS_NIST_SEED          0x9E3779B97F4A7C15ULL
+
+typedef struct {
+  const char *name;
+  const char *desc;
+  uint32_t  (*run)(void);
+} HS_CHECK;
+
+static double
+elapsed(const struct timespec *start)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) +
+         (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* ecam: BDF to ECAM resolution and config reads per second */
+
+typedef struct {
+  uint64_t ecam_base;
+  uint32_t segment;
+  uint32_t start_bus;
+  uint32_t end_bus;
+} HS_ECAM_BLOCK;
+
+/* The lookup VAL did before the segment/bus map: a scan of the ECAM blocks */
+static uint64_t
+ecam_scan_config_addr(const HS_ECAM_BLOCK *block, uint32_t num_ecam, uint32_t bdf)
+{
+  uint32_t seg = PCIE_EXTRACT_BDF_SEG(bdf);
+  uint32_t bus = PCIE_EXTRACT_BDF_BUS(bdf);
+  uint32_t dev = PCIE_EXTRACT_BDF_DEV(bdf);
+  uint32_t func = PCIE_EXTRACT_BDF_FUNC(bdf);
+  uint32_t i;
+
+  for (i = 0; i < num_ecam; i++) {
+      if ((bus >= block[i].start_bus) && (bus <= block[i].end_bus) &&
+          (seg == block[i].segment))
+          return block[i].ecam_base + (bus * PCIE_MAX_DEV * PCIE_MAX_FUNC * 4096) +
+                 (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
+  }
+  return 0;
+}
+
+static uint32_t
+check_ecam(void)
+{
+  HS_ECAM_BLOCK *block;
+  uint32_t *bdf;
+  uint32_t num_ecam, num_bdf = 0, i, bus, dev, func, data, status = ACS_STATUS_PASS;
+  uint64_t lookups, reads;
+  double map_s, scan_s, read_s;
+  struct timespec start;
+  volatile uint64_t sink = 0;
+
+  createPcieInfoTable();
+  num_ecam = (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
+  if (num_ecam == 0) {
+      val_print(ERROR, "\n       No ECAM in the platform description");
+      return ACS_STATUS_FAIL;
+  }
+
+  block = calloc(num_ecam, sizeof(HS_ECAM_BLOCK));
+  for (i = 0; i < num_ecam; i++) {
+      block[i].ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, i);
+      block[i].segment = (uint32_t)val_pcie_get_info(PCIE_INFO_SEGMENT, i);
+      block[i].start_bus = (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, i);
+      block[i].end_bus = (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, i);
+      num_bdf += (block[i].end_bus - block[i].start_bus + 1) * PCIE_MAX_DEV * PCIE_MAX_FUNC;
+  }
+
+  /* Every function that the ECAM blocks decode */
+  bdf = calloc(num_bdf, sizeof(uint32_t));
+  num_bdf = 0;
+  for (i = 0; i < num_ecam; i++)
+      for (bus = block[i].start_bus; bus <= block[i].end_bus; bus++)
+          for (dev = 0; dev < PCIE_MAX_DEV; dev++)
+              for (func = 0; func < PCIE_MAX_FUNC; func++)
+                  bdf[num_bdf++] = PCIE_CREATE_BDF(block[i].segment, bus, dev, func);
+
+  /* Both lookups must agree before they are timed */
+  for (i = 0; i < num_bdf; i++) {
+      if (val_pcie_get_bdf_config_addr(bdf[i]) !=
+          ecam_scan_config_addr(block, num_ecam, bdf[i])) {
+          val_print(ERROR, "\n       ECAM map and table scan differ for BDF 0x%x", bdf[i]);
+          status = ACS_STATUS_FAIL;
+          break;
+      }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (lookups = 0; elapsed(&start) < HS_BENCH_SECONDS; lookups += num_bdf)
+      for (i = 0; i < num_bdf; i++)
+          sink += val_pcie_get_bdf_config_addr(bdf[i]);
+  map_s = lookups / elapsed(&start);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (lookups = 0; elapsed(&start) < HS_BENCH_SECONDS; lookups += num_bdf)
+      for (i = 0; i < num_bdf; i++)
+          sink += ecam_scan_config_addr(block, num_ecam, bdf[i]);
+  scan_s = lookups / elapsed(&start);
+
+  /* Config reads go through the ECAM model of the platform */
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (reads = 0; elapsed(&start) < HS_BENCH_SECONDS; reads++) {
+      val_pcie_read_cfg(bdf[reads % num_bdf], TYPE01_VIDR, &data);
+      sink += data;
+  }
+  read_s = reads / elapsed(&start);
+
+  val_print(INFO, "\n       ECAM blocks %d, functions decoded %d", num_ecam, num_bdf);
+  val_print(INFO, "\n       Lookups/s, segment/bus map  : %ld", (uint64_t)map_s);
+  val_print(INFO, "\n       Lookups/s, ECAM table scan  : %ld", (uint64_t)scan_s);
+  val_print(INFO, "\n       Config reads/s              : %ld", (uint64_t)read_s);
+
+  free(bdf);
+  free(block);
+  val_pcie_free_info_table();
+  return status;
+}
+
+/* rescan: re-enumeration of the functions below one bridge */
+
+static uint32_t
+rescan_table_matches(const pcie_device_bdf_table *table, const pcie_device_bdf_table *ref)
+{
+  uint32_t i;
+
+  if (table->num_entries != ref->num_entries) {
+      val_print(ERROR, "\n       BDF table has %d entries,", table->num_entries);
+      val_print(ERROR, " %d expected", ref->num_entries);
+      return 0;
+  }
+
+  for (i = 0; i < ref->num_entries; i++) {
+      if ((table->device[i].bdf != ref->device[i].bdf) ||
+          (table->device[i].rp_bdf != ref->device[i].rp_bdf)) {
+          val_print(ERROR, "\n       BDF table entry %d is 0x%x", i, table->device[i].bdf);
+          val_print(ERROR, ", 0x%x expected", ref->device[i].bdf);
+          return 0;
+      }
+      if (val_pcie_hierarchy_get_node(table->device[i].bdf) == NULL) {
+          val_print(ERROR, "\n       BDF 0x%x missing from the hierarchy", table->device[i].bdf);
+          return 0;
+      }
+  }
+  return 1;
+}
+
+static uint32_t
+check_rescan(void)
+{
+  pcie_device_bdf_table *table, *ref;
+  uint32_t i, count, bdf, bridge = 0, endpoint = 0, below = 0, reg_value;
+  uint32_t sec_bus, sub_bus, bus, probes, status = ACS_STATUS_PASS;
+  size_t size;
+
+  createPcieInfoTable();
+  table = val_pcie_bdf_table_ptr();
+  if ((table == NULL) || (table->num_entries == 0)) {
+      val_print(ERROR, "\n       No PCIe functions enumerated");
+      val_pcie_free_info_table();
+      return ACS_STATUS_FAIL;
+  }
+
+  size = sizeof(pcie_device_bdf_table) + table->num_entries * sizeof(pcie_device_attr);
+  ref = malloc(size);
+  memcpy(ref, table, size);
+
+  /* The bridge with the most functions below it, and any Type-0 function */
+  for (i = 0; i < ref->num_entries; i++) {
+      bdf = ref->device[i].bdf;
+      if (val_pcie_function_header_type(bdf) != TYPE1_HEADER) {
+          endpoint = endpoint ? endpoint : bdf;
+          continue;
+      }
+      val_pcie_read_cfg(bdf, TYPE1_PBN, &reg_value);
+      sec_bus = (reg_value >> SECBN_SHIFT) & SECBN_MASK;
+      sub_bus = (reg_value >> SUBBN_SHIFT) & SUBBN_MASK;
+      for (count = 0, bus = 0; bus < ref->num_entries; bus++)
+          if ((PCIE_EXTRACT_BDF_SEG(ref->device[bus].bdf) == PCIE_EXTRACT_BDF_SEG(bdf)) &&
+              (PCIE_EXTRACT_BDF_BUS(ref->device[bus].bdf) >= sec_bus) &&
+              (PCIE_EXTRACT_BDF_BUS(ref->device[bus].bdf) <= sub_bus))
+              count++;
+      if (count > below) {
+          below = count;
+          bridge = bdf;
+      }
+  }
+
+  if (below == 0) {
+      val_print(ERROR, "\n       No bridge with functions below it");
+      status = ACS_STATUS_FAIL;
+      goto done;
+  }
+  val_print(INFO, "\n       Bridge 0x%x", bridge);
+  val_print(INFO, ", functions below %d", below);
+
+  if (endpoint && (val_pcie_rescan_subtree(endpoint) == 0)) {
+      val_print(ERROR, "\n       Rescan of Type-0 BDF 0x%x accepted", endpoint);
+      status = ACS_STATUS_FAIL;
+  }
+
+  /* Unchanged hierarchy: the table must come back as enumerated */
+  if (val_pcie_rescan_subtree(bridge) || !rescan_table_matches(table, ref)) {
+      val_print(ERROR, "\n       Rescan of an unchanged bridge altered the BDF table");
+      status = ACS_STATUS_FAIL;
+  }
+
+  /* Functions lost from the table, as after a link reset, are found again */
+  val_pcie_read_cfg(bridge, TYPE1_PBN, &reg_value);
+  sec_bus = (reg_value >> SECBN_SHIFT) & SECBN_MASK;
+  sub_bus = (reg_value >> SUBBN_SHIFT) & SUBBN_MASK;
+  for (count = 0, i = 0; i < table->num_entries; i++) {
+      bus = PCIE_EXTRACT_BDF_BUS(table->device[i].bdf);
+      if ((PCIE_EXTRACT_BDF_SEG(table->device[i].bdf) == PCIE_EXTRACT_BDF_SEG(bridge)) &&
+          (bus >= sec_bus) && (bus <= sub_bus))
+          continue;
+      table->device[count++] = table->device[i];
+  }
+  table->num_entries = count;
+
+  probes = val_pcie_get_enum_probe_count();
+  if (val_pcie_rescan_subtree(bridge) || !rescan_table_matches(table, ref)) {
+      val_print(ERROR, "\n       Rescan did not restore the functions below the bridge");
+      status = ACS_STATUS_FAIL;
+  }
+  val_print(INFO, "\n       Rescan probes %d", val_pcie_get_enum_probe_count() - probes);
+
+done:
+  free(ref);
+  val_pcie_free_info_table();
+  return status;
+}
+
+/* heap: allocator stress on every PE */
+
+static uint32_t g_hs_heap_errors[PLATFORM_OVERRIDE_PE_CNT];
+
+static uint64_t
+heap_rand(uint64_t *state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+/* Largest block the heap hands out, found by bisection */
+static uint64_t
+heap_largest_block(void)
+{
+  uint64_t lo = 0, hi = (uint64_t)PLATFORM_HEAP_REGION_SIZE, mid;
+  void *p;
+
+  while (lo < hi) {
+      mid = lo + (hi - lo + 1) / 2;
+      p = pal_aligned_alloc(16, (uint32_t)mid);
+      if (p) {
+          pal_mem_free_aligned(p);
+          lo = mid;
+      } else
+          hi = mid - 1;
+  }
+  return lo;
+}
+
+/* Random sizes and alignments, each block filled and checked before it is freed */
+static void
+heap_stress_payload(void)
+{
+  uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
+  uint8_t *ptr[HS_HEAP_SLOTS] = { NULL };
+  uint32_t size[HS_HEAP_SLOTS];
+  uint64_t state = 0x9E3779B97F4A7C15ULL * (index + 1), r, align;
+  uint32_t round, slot, i, errors = 0;
+
+  for (round = 0; round < HS_HEAP_ROUNDS + HS_HEAP_SLOTS; round++) {
+      r = heap_rand(&state);
+      /* The last rounds free every slot still in use */
+      slot = (round < HS_HEAP_ROUNDS) ? (uint32_t)(r % HS_HEAP_SLOTS) : round - HS_HEAP_ROUNDS;
+
+      if (ptr[slot]) {
+          for (i = 0; i < size[slot]; i++)
+              if (ptr[slot][i] != (uint8_t)(index * HS_HEAP_SLOTS + slot))
+                  break;
+          if (i != size[slot])
+              errors++;
+          pal_mem_free_aligned(ptr[slot]);
+          ptr[slot] = NULL;
+          continue;
+      }
+      if (round >= HS_HEAP_ROUNDS)
+          continue;
+
+      /* Mostly small blocks of the PE cache classes, some large aligned ones */
+      if ((r >> 8) % 4) {
+          size[slot] = 1 + (uint32_t)((r >> 16) % 240);
+          align = 16;
+      } else {
+          size[slot] = 1 + (uint32_t)((r >> 16) % HS_HEAP_MAX_SIZE);
+          align = 1ULL << ((r >> 40) % 13);
+      }
+
+      ptr[slot] = pal_aligned_alloc((uint32_t)align, size[slot]);
+      if ((ptr[slot] == NULL) || ((uint64_t)ptr[slot] & (align - 1))) {
+          errors++;
+          ptr[slot] = NULL;
+          continue;
+      }
+      memset(ptr[slot], index * HS_HEAP_SLOTS + slot, size[slot]);
+  }
+
+  g_hs_heap_errors[index] = errors;
+  val_set_status(index, errors ? RESULT_FAIL(1) : RESULT_PASS);
+}
+
+static uint32_t
+check_heap(void)
+{
+  uint32_t num_pe = val_pe_get_num(), i, status = ACS_STATUS_PASS;
+  uint64_t before, after;
+  struct timespec start;
+  double secs;
+
+  if (num_pe > PLATFORM_OVERRIDE_PE_CNT)
+      num_pe = PLATFORM_OVERRIDE_PE_CNT;
+
+  /* The PE caches go back to the free lists before each measurement */
+  pal_heap_print_stats();
+  before = heap_largest_block();
+
+  for (i = 0; i < num_pe; i++)
+      val_set_status(i, RESULT_PENDING(0));
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  val_run_test_payload(0, num_pe, heap_stress_payload, 0);
+  secs = elapsed(&start);
+
+  for (i = 0; i < num_pe; i++) {
+      if (!IS_TEST_PASS(val_get_status(i))) {
+          val_print(ERROR, "\n       PE %d: ", i);
+          val_print(ERROR, "%d blocks misaligned, lost or overwritten", g_hs_heap_errors[i]);
+          status = ACS_STATUS_FAIL;
+      }
+  }
+
+  pal_heap_print_stats();
+  after = heap_largest_block();
+
+  val_print(INFO, "\n       PEs %d", num_pe);
+  val_print(INFO, ", allocations/s %ld", (uint64_t)(num_pe * HS_HEAP_ROUNDS / 2 / secs));
+  val_print(INFO, "\n       Largest block before 0x%llx", before);
+  val_print(INFO, ", after 0x%llx", after);
+  if (after != before) {
+      val_print(ERROR, "\n       Heap did not coalesce back after the stress");
+      status = ACS_STATUS_FAIL;
+  }
+
+  return status;
+}
+
+/* its: one ITT per DeviceID in batched LPI mappings */
+
+extern GIC_ITS_INFO *g_gic_its_info;
+
+typedef struct {
+  uint32_t num_mapd;
+  uint32_t num_unmapd;
+  uint32_t num_mapti;
+  uint32_t device_id[8];
+  uint64_t itt[8];
+  uint32_t size[8];
+} HS_ITS_CMDS;
+
+/* Decodes the commands queued on ITS 0 since GITS_CWRITER was cwriter */
+static uint64_t
+its_decode(uint64_t cwriter, HS_ITS_CMDS *cmds)
+{
+  uint64_t base = g_gic_its_info->GicIts[0].Base;
+  uint64_t *queue = (uint64_t *)(val_mmio_read64(base + ARM_GITS_CBASER) &
+                                 ARM_GITS_CBASER_PA_MASK);
+  uint64_t end = val_mmio_read64(base + ARM_GITS_CWRITER) & ITS_CMDQ_OFFSET_MASK;
+  uint64_t *cmd;
+
+  memset(cmds, 0, sizeof(*cmds));
+  for (cwriter &= ITS_CMDQ_OFFSET_MASK; cwriter != end;
+       cwriter = (cwriter + 32) % (ITS_CMDQ_SIZE_DW * NUM_BYTES_IN_DW)) {
+      cmd = queue + cwriter / NUM_BYTES_IN_DW;
+      if ((cmd[0] & 0xFF) == ARM_ITS_CMD_MAPTI)
+          cmds->num_mapti++;
+      if ((cmd[0] & 0xFF) != ARM_ITS_CMD_MAPD)
+          continue;
+      if (!(cmd[2] >> ITS_CMD_SHIFT_VALID)) {
+          cmds->num_unmapd++;
+          continue;
+      }
+      if (cmds->num_mapd < 8) {
+          cmds->device_id[cmds->num_mapd] = (uint32_t)(cmd[0] >> ITS_CMD_SHIFT_DEVID);
+          cmds->itt[cmds->num_mapd] = cmd[2] & ITT_PAR_MASK;
+          cmds->size[cmds->num_mapd] = (uint32_t)(cmd[1] & 0x1F);
+      }
+      cmds->num_mapd++;
+  }
+  return end;
+}
+
+static uint32_t
+check_its(void)
+{
+  ITS_LPI_MAP map[] = {
+    { 0x10, ARM_LPI_MINID + 1 },
+    { 0x11, ARM_LPI_MINID + 256 },
+    { 0x10, ARM_LPI_MINID + 3 },
+    { 0x12, ARM_LPI_MINID + 5000 },
+  };
+  ITS_LPI_MAP extra[] = {
+    { 0x10, ARM_LPI_MINID + 2 },
+    { 0x10, ARM_LPI_MINID + 1000 },
+  };
+  HS_ITS_CMDS cmds;
+  uint64_t cwriter, entry_size, lo, hi;
+  uint32_t i, j, k, status = ACS_STATUS_PASS;
+
+  if (val_gic_its_configure() || (g_gic_its_info == NULL) ||
+      (g_gic_its_info->GicNumIts == 0)) {
+      val_print(ERROR, "\n       No ITS configured");
+      return ACS_STATUS_FAIL;
+  }
+  entry_size = ARM_GITS_TYPER_ITT_ENTRY_SIZE(
+                 val_mmio_read64(g_gic_its_info->GicIts[0].Base + ARM_GITS_TYPER)) + 1;
+
+  /* Three devices in one batch: three MAPDs with disjoint ITTs */
+  cwriter = val_mmio_read64(g_gic_its_info->GicIts[0].Base + ARM_GITS_CWRITER);
+  if (val_its_create_lpi_map_batch(0, map, 4, LPI_PRIORITY1)) {
+      val_print(ERROR, "\n       Batch of three devices not mapped");
+      return ACS_STATUS_FAIL;
+  }
+  cwriter = its_decode(cwriter, &cmds);
+  if ((cmds.num_mapd != 3) || (cmds.num_mapti != 4)) {
+      val_print(ERROR, "\n       %d MAPD,", cmds.num_mapd);
+      val_print(ERROR, " %d MAPTI for 3 devices and 4 LPIs", cmds.num_mapti);
+      status = ACS_STATUS_FAIL;
+  }
+
+  for (i = 0; i < cmds.num_mapd && i < 8; i++) {
+      val_print(INFO, "\n       DeviceID 0x%x", cmds.device_id[i]);
+      val_print(INFO, " ITT 0x%llx", cmds.itt[i]);
+      val_print(INFO, " EventID bits %d", cmds.size[i] + 1);
+
+      for (k = 0; k < 4; k++)
+          if ((map[k].device_id == cmds.device_id[i]) &&
+              ((map[k].int_id - ARM_LPI_MINID) >> (cmds.size[i] + 1))) {
+              val_print(ERROR, "\n       LPI 0x%x outside the ITT of its device", map[k].int_id);
+              status = ACS_STATUS_FAIL;
+          }
+
+      lo = cmds.itt[i];
+      hi = lo + (entry_size << (cmds.size[i] + 1));
+      for (j = 0; j < i; j++)
+          if ((cmds.itt[j] < hi) &&
+              (lo < cmds.itt[j] + (entry_size << (cmds.size[j] + 1)))) {
+              val_print(ERROR, "\n       ITTs of DeviceID 0x%x", cmds.device_id[i]);
+              val_print(ERROR, " and 0x%x overlap", cmds.device_id[j]);
+              status = ACS_STATUS_FAIL;
+          }
+  }
+
+  /* A mapped device keeps its ITT: no MAPD for an LPI that fits, an error otherwise */
+  if (val_its_create_lpi_map_batch(0, &extra[0], 1, LPI_PRIORITY1)) {
+      val_print(ERROR, "\n       LPI within the ITT of a mapped device not mapped");
+      status = ACS_STATUS_FAIL;
+  }
+  cwriter = its_decode(cwriter, &cmds);
+  if ((cmds.num_mapd != 0) || (cmds.num_mapti != 1)) {
+      val_print(ERROR, "\n       Mapped device remapped by MAPD");
+      status = ACS_STATUS_FAIL;
+  }
+
+  if (!val_its_create_lpi_map_batch(0, &extra[1], 1, LPI_PRIORITY1)) {
+      val_print(ERROR, "\n       LPI beyond the ITT of a mapped device accepted");
+      status = ACS_STATUS_FAIL;
+  }
+  cwriter = its_decode(cwriter, &cmds);
+  if (cmds.num_mapd || cmds.num_mapti) {
+      val_print(ERROR, "\n       Commands queued for a refused LPI");
+      status = ACS_STATUS_FAIL;
+  }
+
+  /* Unmapping frees the ITTs, so the devices can be mapped again */
+  if (val_its_clear_lpi_map_batch(0, map, 4) ||
+      val_its_clear_lpi_map_batch(0, &extra[0], 1)) {
+      val_print(ERROR, "\n       Batch not unmapped");
+      status = ACS_STATUS_FAIL;
+  }
+  cwriter = its_decode(cwriter, &cmds);
+  if (cmds.num_unmapd != 4) {
+      val_print(ERROR, "\n       %d MAPD V=0 for 3 devices, then 1", cmds.num_unmapd);
+      status = ACS_STATUS_FAIL;
+  }
+
+  if (val_its_create_lpi_map_batch(0, &extra[1], 1, LPI_PRIORITY1) ||
+      val_its_clear_lpi_map_batch(0, &extra[1], 1)) {
+      val_print(ERROR, "\n       Unmapped device could not be mapped again");
+      status = ACS_STATUS_FAIL;
+  }
+
+  return status;
+}
+
+/* nist: word-parallel STS kernels against the bit-serial reference */
+
+typedef enum {
+  HS_NIST_RANDOM = 0,
+  HS_NIST_SPARSE,
+  HS_NIST_BURSTS,
+  HS_NIST_ZEROS,
+  HS_NIST_ONES,
+  HS_NIST_ALTERNATE,
+  HS_NIST_NUM_FILL
+} HS_NIST_FILL;
+
+static const char *g_hs_nist_fill[HS_NIST_NUM_FILL] = {
+  "random", "sparse", "bursts", "zeros", "ones", "alternate"
+};
+
+static uint64_t
+nist_xorshift(uint64_t *x)
+{
+  *x ^= *x << 13;
+  *x ^= *x >> 7;
+  *x ^= *x << 17;
+  return *x;
+}
+
+/* Fills a stream of num_bits bits, clears the bits past the end and the padding word */
+static void
+nist_fill(uint64_t *words, uint64_t num_bits, HS_NIST_FILL fill, uint64_t seed)
+{
+  uint64_t num_words = NIST_STREAM_WORDS(num_bits), i, bit = 0, len, x = seed;
+
+  for (i = 0; i < num_words; i++) {
+      switch (fill) {
+      case HS_NIST_RANDOM:
+          words[i] = nist_xorshift(&x);
+          break;
+      case HS_NIST_SPARSE:
+          words[i] = nist_xorshift(&x) & nist_xorshift(&x) & nist_xorshift(&x);
+          break;
+      case HS_NIST_ZEROS:
+          words[i] = 0;
+          break;
+      case HS_NIST_ONES:
+          words[i] = ~0ULL;
+          break;
+      case HS_NIST_ALTERNATE:
+          words[i] = 0x5555555555555555ULL;
+          break;
+      default:
+          words[i] = 0;
+          break;
+      }
+  }
+
+  /* Runs of 1 to 64 equal bits, long enough to reach every LongestRun class */
+  if (fill == HS_NIST_BURSTS) {
+      while (bit < num_bits) {
+          len = 1 + (nist_xorshift(&x) & 63);
+          if ((x >> 32) & 1) {
+              for (i = bit; (i < bit + len) && (i < num_bits); i++)
+                  words[i >> 6] |= 1ULL << (63 - (i & 63));
+          }
+          bit += len;
+      }
+  }
+
+  if (num_bits & 63)
+      words[num_words - 1] &= ~0ULL << (64 - (num_bits & 63));
+  words[num_words] = 0;
+}
+
+static uint32_t
+check_nist(void)
+{
+  static const uint64_t bits[] = {
+    NIST_STREAM_MIN_BITS,
+    NIST_STREAM_MIN_BITS + 1,
+    NIST_STREAM_MIN_BITS + 63,
+    131072,
+    1000037,
+  };
+  uint64_t max_bits = bits[sizeof(bits) / sizeof(bits[0]) - 1];
+  uint64_t *words, seed = HS_NIST_SEED;
+  uint32_t *count, i, fill, num = 0, status = ACS_STATUS_PASS;
+
+  words = val_memory_alloc(NIST_STREAM_ALLOC_WORDS(max_bits) * sizeof(uint64_t));
+  count = val_memory_calloc(NIST_PATTERN_ENTRIES, sizeof(uint32_t));
+  if ((words == NULL) || (count == NULL)) {
+      val_print(ERROR, "\n       Stream buffers not allocated");
+      status = ACS_STATUS_ERR;
+      goto free_buffers;
+  }
+
+  for (i = 0; i < sizeof(bits) / sizeof(bits[0]); i++) {
+      for (fill = 0; fill < HS_NIST_NUM_FILL; fill++) {
+          nist_fill(words, bits[i], fill, seed);
+          seed += HS_NIST_SEED;
+          num++;
+          if (val_nist_stream_compare(words, bits[i], count) != ACS_STATUS_PASS) {
+              val_print(ERROR, "\n       Sequence %s", g_hs_nist_fill[fill]);
+              val_print(ERROR, " of %ld bits", bits[i]);
+              status = ACS_STATUS_FAIL;
+          }
+      }
+  }
+
+  val_print(INFO, "\n       Sequences compared %d", num);
+
+free_buffers:
+  if (words)
+      val_memory_free(words);
+  if (count)
+      val_memory_free(count);
+  return status;
+}
+
+static const HS_CHECK g_hs_check[] = {
+  { "ecam", "BDF to ECAM lookup and config read rate", check_ecam },
+  { "rescan", "Subtree rescan of the PCIe BDF table", check_rescan },
+  { "heap", "Heap allocator stress on every PE", check_heap },
+  { "its", "Per-device ITTs of batched ITS mappings", check_its },
+  { "nist", "Bit-exact NIST kernels against the reference", check_nist },
+};
+
+#define HS_NUM_CHECK  (sizeof(g_hs_check) / sizeof(g_hs_check[0]))
+
+static uint32_t g_hs_check_selected[HS_NUM_CHECK];
+static uint32_t g_hs_check_failed;
+
+void
+hs_check_select(const char *list)
+{
+  char *copy = strdup(list), *tok, *save = NULL;
+  uint32_t i;
+
+  for (tok = strtok_r(copy, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+      for (i = 0; i < HS_NUM_CHECK; i++) {
+          if (!strcasecmp(tok, "all") || !strcasecmp(tok, g_hs_check[i].name))
+              g_hs_check_selected[i] = 1;
+      }
+      if (strcasecmp(tok, "all")) {
+          for (i = 0; i < HS_NUM_CHECK && strcasecmp(tok, g_hs_check[i].name); i++)
+              ;
+          if (i == HS_NUM_CHECK) {
+              fprintf(stderr, "hostsim: unknown check '%s'\n", tok);
+              exit(2);
+          }
+      }
+  }
+  free(copy);
+}
+
+void
+hs_check_usage(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < HS_NUM_CHECK; i++)
+      fprintf(stderr, "      %-18s %s\n", g_hs_check[i].name, g_hs_check[i].desc);
+}
+
+uint32_t
+hs_check_failed(void)
+{
+  return g_hs_check_failed;
+}
+
+/* Entry of the primary PE in place of the ACS main */
+void
+hs_check_main(void)
+{
+  acs_execution_policy_t *policy = acs_get_execution_policy_mut();
+  uint32_t i, status;
+
+  acs_reset_run_request();
+  acs_load_run_request_defaults(acs_get_run_request_mut());
+  acs_load_execution_policy_defaults(policy);
+  policy->print_level = g_hs_config.check_print_level;
+
+  if (createPeInfoTable() || createGicInfoTable() ||
+      (val_allocate_shared_mem() != ACS_STATUS_PASS)) {
+      val_print(ERROR, "\n hostsim: platform information tables not created\n");
+      g_hs_check_failed++;
+      return;
+  }
+  val_pe_initialize_default_exception_handler(val_pe_default_esr);
+
+  for (i = 0; i < HS_NUM_CHECK; i++) {
+      if (!g_hs_check_selected[i])
+          continue;
+
+      val_print(INFO, "\n hostsim check %s: %s\n", g_hs_check[i].name, g_hs_check[i].desc);
+      status = g_hs_check[i].run();
+      if (status != ACS_STATUS_PASS)
+          g_hs_check_failed++;
+      val_print(INFO, "\n   Result:  %s\n", (status == ACS_STATUS_PASS) ? "PASSED" : "FAILED");
+  }
+
+  val_free_shared_mem();
+}
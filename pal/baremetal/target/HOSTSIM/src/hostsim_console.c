@@ -0,0 +1,47 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * Console of the HOSTSIM platform. It replaces the PL011 driver of the base
+ * PAL (see CMakeLists.txt): pal_uart_putc() writes to the standard output of
+ * the process, a line at a time so that the output of concurrent PEs does
+ * not interleave within a line. The PL011 model of hostsim_mem.c sends the
+ * characters written to its data register here as well.
+ */
+
+#include <unistd.h>
+
+#include "hostsim.h"
+#include "pal_pl011_uart.h"
+
+#define HS_CONSOLE_LINE       256
+
+static __thread char     g_line[HS_CONSOLE_LINE];
+static __thread uint32_t g_line_len;
+
+void
+pal_uart_putc(char c)
+{
+  hs_model_enter(hs_self);
+  g_line[g_line_len++] = c;
+  if (c == '\n' || g_line_len == HS_CONSOLE_LINE) {
+      if (write(STDOUT_FILENO, g_line, g_line_len) < 0)
+          g_line_len = 0;
+      g_line_len = 0;
+  }
+  hs_model_exit(hs_self);
+}
@@ -0,0 +1,281 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * Host versions of the routines that the baremetal build implements in
+ * AArch64 assembly (val/src/AArch64, val/driver/gic/AArch64 and
+ * pal/baremetal/base/src/AArch64).
+ */
+
+#include <sched.h>
+#include <string.h>
+
+#include "hostsim.h"
+#include "val/include/val_memops.h"
+
+typedef uint64_t u_register_t;
+
+/* Translation tables written by val_setup_mmu(); the host never walks them */
+uint64_t tt_l0_base[512] __attribute__((aligned(4096)));
+
+/*
+ * The mains save the stack pointer to return through the default exception
+ * handler. The host resumes at the saved label on the right frame by itself
+ * (see hostsim_pe.c), so the saved slot only has to be readable.
+ */
+static uint64_t g_hs_saved_frame[2];
+
+uint64_t
+AA64ReadSp(void)
+{
+  return (uint64_t)g_hs_saved_frame;
+}
+
+uint64_t
+AA64WriteSp(uint64_t write_data)
+{
+  return write_data;
+}
+
+/* Vector length in bytes of the simulated SVE unit */
+uint64_t
+ArmRdvl(void)
+{
+  return 16;
+}
+
+/* FP/AdvSIMD is reported as trapped */
+uint64_t
+MemOpsSimdAccess(void)
+{
+  return 0;
+}
+
+void
+MemOpsUpdateBits(volatile uint64_t *word, uint64_t clear, uint64_t set)
+{
+  uint64_t old = *word;
+
+  while (!__atomic_compare_exchange_n(word, &old, (old & ~clear) | set, 1,
+                                      __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+      ;
+}
+
+/* Bandwidth generators used by the MPAM tests */
+void
+MemTrafficRead(const void *src, uint64_t len)
+{
+  const volatile uint64_t *p = src;
+  uint64_t i;
+
+  for (i = 0; i < len / 8; i++)
+      (void)p[i];
+}
+
+void
+MemTrafficWrite(void *dst, uint64_t len, uint64_t pattern)
+{
+  volatile uint64_t *p = dst;
+  uint64_t i;
+
+  for (i = 0; i < len / 8; i++)
+      p[i] = pattern;
+}
+
+void
+MemTrafficCopy(void *dst, const void *src, uint64_t len)
+{
+  memcpy(dst, src, len);
+}
+
+void
+MemTrafficCopyNt(void *dst, const void *src, uint64_t len)
+{
+  memcpy(dst, src, len);
+}
+
+/* Host caches are coherent with every simulated agent */
+void
+DataCacheCleanInvalidateVA(uint64_t addr)
+{
+  (void)addr;
+}
+
+void
+DataCacheCleanVA(uint64_t addr)
+{
+  (void)addr;
+}
+
+/*
+ * An invalidate is how a PE polls a location that another PE writes, as
+ * val_get_status() does. Those loops are bounded by an iteration count
+ * (TIMEOUT_LARGE), so hand the host CPU over to let the writer run when
+ * there are fewer host CPUs than simulated PEs.
+ */
+void
+DataCacheInvalidateVA(uint64_t addr)
+{
+  (void)addr;
+  sched_yield();
+}
+
+void
+DataCacheInvalidateVAPoC(uint64_t addr)
+{
+  (void)addr;
+}
+
+void
+DisableSpe(void)
+{
+}
+
+/* Trace unit and TRBE (val/src/AArch64/PeRegSysSupport.S), not modelled */
+void
+AA64EnableTFO(void)
+{
+}
+
+void
+AA64DisableTFO(void)
+{
+}
+
+uint64_t
+AA64SetupTraceAccess(void)
+{
+  return 0;
+}
+
+uint64_t
+AA64EnableTRBUTrace(uint32_t index, uint64_t buffer_addr, uint32_t trbu_mode)
+{
+  (void)index;
+  (void)buffer_addr;
+  (void)trbu_mode;
+  return 0;
+}
+
+uint64_t
+AA64DisableTRBUTrace(void)
+{
+  return 0;
+}
+
+uint64_t
+AA64EnableETETrace(void)
+{
+  return 0;
+}
+
+uint64_t
+AA64GenerateETETrace(void)
+{
+  return 0;
+}
+
+uint64_t
+AA64DisableETETrace(void)
+{
+  return 0;
+}
+
+/* Exception state of the current PE (val/driver/gic/AArch64) */
+uint64_t
+bsa_gic_ack_intr(void)
+{
+  return pal_hostsim_sysreg_read("icc_iar1_el1");
+}
+
+void
+bsa_gic_end_intr(uint32_t interrupt_id)
+{
+  pal_hostsim_sysreg_write("icc_eoir1_el1", interrupt_id);
+}
+
+uint64_t
+bsa_gic_get_esr(void)
+{
+  return hs_self->esr;
+}
+
+uint64_t
+bsa_gic_get_far(void)
+{
+  return hs_self->far;
+}
+
+uint64_t
+bsa_gic_get_elr(void)
+{
+  return hs_self->elr;
+}
+
+void
+bsa_gic_update_elr(uint64_t elr_value)
+{
+  hs_self->elr = elr_value;
+}
+
+void
+bsa_gic_set_el2_vector_table(void)
+{
+}
+
+/* MMU control (val/src/AArch64/MmuSupport.S), kept in the register file */
+void
+val_mair_write(uint64_t value, uint64_t el_num)
+{
+  pal_hostsim_sysreg_write(el_num == 1 ? "mair_el1" : "mair_el2", value);
+}
+
+void
+val_tcr_write(uint64_t value, uint64_t el_num)
+{
+  pal_hostsim_sysreg_write(el_num == 1 ? "tcr_el1" : "tcr_el2", value);
+}
+
+void
+val_ttbr0_write(uint64_t value, uint64_t el_num)
+{
+  pal_hostsim_sysreg_write(el_num == 1 ? "ttbr0_el1" : "ttbr0_el2", value);
+}
+
+uint64_t
+val_ttbr0_read(uint64_t el_num)
+{
+  return pal_hostsim_sysreg_read(el_num == 1 ? "ttbr0_el1" : "ttbr0_el2");
+}
+
+void
+val_sctlr_write(uint64_t value, uint64_t el_num)
+{
+  pal_hostsim_sysreg_write(el_num == 1 ? "sctlr_el1" : "sctlr_el2", value);
+}
+
+uint64_t
+val_sctlr_read(uint64_t el_num)
+{
+  return pal_hostsim_sysreg_read(el_num == 1 ? "sctlr_el1" : "sctlr_el2");
+}
+
+uint64_t
+val_read_current_el(void)
+{
+  return pal_hostsim_sysreg_read("currentel");
+}
@@ -0,0 +1,854 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * GICv3 model of the HOSTSIM platform.
+ *
+ * The distributor, one redistributor per PE and the CPU interface system
+ * registers are modelled with affinity routing enabled and a single security
+ * state, which is what the ACS sees when it runs at NS-EL2. SGIs, PPIs and
+ * SPIs follow the GICv3 pending/active state machine; the ITS register files
+ * accept the ACS initialisation sequence and complete every command
+ * immediately, but do not generate LPIs.
+ */
+
+#include <string.h>
+
+#include "hostsim.h"
+#include "pal_common_support.h"
+#include "platform_override_struct.h"
+#include "platform_override_fvp.h"
+
+extern const PLATFORM_OVERRIDE_GIC_INFO_TABLE platform_gic_cfg;
+extern const PE_INFO_TABLE platform_pe_cfg;
+
+#define HS_INTR_WORDS         (HS_MAX_INTR / 32)
+#define HS_SPURIOUS           1023
+#define HS_IDLE_PRIORITY      0x100
+#define HS_MAX_ACTIVE         32
+
+#define HS_GICR_FRAME         0x20000   /* RD_base + SGI_base */
+#define HS_GITS_FRAME         0x20000
+
+/* GICD/GICR PIDR2.ArchRev = 3 */
+#define HS_GIC_PIDR2          0x3B
+#define HS_GIC_IIDR           0x0200043B
+
+#define GICD_TYPER_LPIS       (1u << 17)
+#define GICD_TYPER_IDBITS     (15u << 19)
+
+#define GICR_WAKER_PS         (1u << 1)
+#define GICR_WAKER_CA         (1u << 2)
+
+#define ICC_CTLR_EOIMODE      (1u << 1)
+
+#define ICH_HCR_EN            (1u << 0)
+#define ICH_HCR_UIE           (1u << 1)
+#define ICH_HCR_NPIE          (1u << 3)
+#define ICH_MISR_U            (1u << 1)
+#define ICH_MISR_NP           (1u << 3)
+
+/* Interrupt state for a bank of INTIDs, the SPIs or the SGIs/PPIs of a PE */
+typedef struct {
+  uint32_t enable[HS_INTR_WORDS];
+  uint32_t pend[HS_INTR_WORDS];       /* latched pending state */
+  uint32_t active[HS_INTR_WORDS];
+  uint32_t line[HS_INTR_WORDS];       /* input level */
+  uint32_t edge[HS_INTR_WORDS];       /* ICFGR: 1 = edge-triggered */
+  uint32_t group[HS_INTR_WORDS];
+  uint32_t grpmod[HS_INTR_WORDS];
+  uint8_t  prio[HS_MAX_INTR];
+} HS_IRQ_BANK;
+
+typedef struct {
+  uint32_t    ctlr;
+  HS_IRQ_BANK spi;
+  uint64_t    irouter[HS_MAX_INTR];
+  int32_t     target[HS_MAX_INTR];    /* PE index, -1 when not routed */
+} HS_GICD;
+
+/* Redistributor and CPU interface of one PE */
+typedef struct {
+  uint32_t    ctlr;
+  uint32_t    waker;
+  uint64_t    propbaser;
+  uint64_t    pendbaser;
+  HS_IRQ_BANK priv;
+
+  uint32_t    pmr;
+  uint32_t    bpr1;
+  uint32_t    igrpen1;
+  uint32_t    icc_ctlr;
+  uint32_t    active_depth;           /* running priority stack */
+  uint32_t    active_prio[HS_MAX_ACTIVE];
+} HS_GICR;
+
+typedef struct {
+  uint32_t ctlr;
+  uint64_t cbaser;
+  uint64_t cwriter;
+  uint64_t baser[8];
+} HS_GITS;
+
+static HS_GICD         g_gicd;
+static HS_GICR         g_gicr[HS_MAX_PE];
+static HS_GITS         g_gits[PLATFORM_OVERRIDE_GICITS_COUNT];
+static pthread_mutex_t g_gic_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* PEs to notify once the lock is dropped */
+static uint64_t        g_gic_notify[HS_MAX_PE / 64];
+
+static HS_IRQ_BANK *
+bank_of(uint32_t pe, uint32_t intid)
+{
+  return (intid < HS_NUM_PRIV_INTR) ? &g_gicr[pe].priv : &g_gicd.spi;
+}
+
+static inline uint32_t
+bit_get(const uint32_t *words, uint32_t intid)
+{
+  return (words[intid / 32] >> (intid % 32)) & 1;
+}
+
+static inline void
+bit_set(uint32_t *words, uint32_t intid, uint32_t value)
+{
+  if (value)
+      words[intid / 32] |= 1u << (intid % 32);
+  else
+      words[intid / 32] &= ~(1u << (intid % 32));
+}
+
+/* Pending state as seen by the CPU interface: latched or level asserted */
+static inline uint32_t
+pend_word(const HS_IRQ_BANK *b, uint32_t w)
+{
+  return b->pend[w] | (b->line[w] & ~b->edge[w]);
+}
+
+static void
+notify_pe(uint32_t pe)
+{
+  g_gic_notify[pe / 64] |= 1ULL << (pe % 64);
+}
+
+static void
+notify_intid(uint32_t pe, uint32_t intid)
+{
+  uint32_t i;
+
+  if (intid < HS_NUM_PRIV_INTR) {
+      notify_pe(pe);
+  } else if (g_gicd.target[intid] >= 0) {
+      notify_pe(g_gicd.target[intid]);
+  } else {
+      for (i = 0; i < g_hs_config.num_pe; i++)
+          notify_pe(i);
+  }
+}
+
+static void
+gic_unlock_and_notify(void)
+{
+  uint64_t notify[HS_MAX_PE / 64];
+  uint32_t i;
+
+  memcpy(notify, g_gic_notify, sizeof(notify));
+  memset(g_gic_notify, 0, sizeof(g_gic_notify));
+  pthread_mutex_unlock(&g_gic_lock);
+
+  for (i = 0; i < g_hs_config.num_pe; i++) {
+      if ((notify[i / 64] >> (i % 64)) & 1) {
+          if (hs_gic_irq_pending(&g_hs_pe[i]) < HS_MAX_INTR)
+              hs_pe_kick(&g_hs_pe[i]);
+      }
+  }
+}
+
+/* SPIs with IRM = 1 are taken by the primary PE */
+static void
+update_route(uint32_t intid)
+{
+  uint64_t route = g_gicd.irouter[intid];
+  HS_PE *pe;
+
+  if (route & (1ULL << 31)) {
+      g_gicd.target[intid] = 0;
+      return;
+  }
+  pe = hs_pe_by_mpidr((route & 0xFFFFFF) | ((route >> 32 & 0xFF) << 32));
+  g_gicd.target[intid] = pe ? (int32_t)pe->index : -1;
+}
+
+/*
+ * Highest priority pending interrupt for a PE, called with g_gic_lock held.
+ * With masked set, only an interrupt that the CPU interface would signal is
+ * returned: enabled, not active, above the priority mask and the running
+ * priority, with group 1 enabled in the distributor and the CPU interface.
+ */
+static uint32_t
+highest_pending_locked(uint32_t pe, int masked)
+{
+  HS_GICR *r = &g_gicr[pe];
+  uint32_t best = HS_MAX_INTR, best_prio = HS_IDLE_PRIORITY;
+  uint32_t limit = HS_IDLE_PRIORITY;
+  uint32_t w, bits, intid, prio;
+
+  if (masked) {
+      if (!(g_gicd.ctlr & 0x3) || !(r->igrpen1 & 1))
+          return HS_MAX_INTR;
+      limit = r->pmr;
+      if (r->active_depth && r->active_prio[r->active_depth - 1] < limit)
+          limit = r->active_prio[r->active_depth - 1];
+  }
+
+  for (w = 0; w < HS_INTR_WORDS; w++) {
+      const HS_IRQ_BANK *b = (w == 0) ? &r->priv : &g_gicd.spi;
+
+      bits = pend_word(b, w) & b->enable[w] & ~b->active[w];
+      while (bits) {
+          intid = w * 32 + __builtin_ctz(bits);
+          bits &= bits - 1;
+          if (w != 0 && g_gicd.target[intid] != (int32_t)pe)
+              continue;
+          prio = b->prio[intid];
+          if (prio < best_prio && prio < limit) {
+              best = intid;
+              best_prio = prio;
+          }
+      }
+  }
+  return best;
+}
+
+uint32_t
+hs_gic_irq_pending(HS_PE *pe)
+{
+  uint32_t intid;
+
+  pthread_mutex_lock(&g_gic_lock);
+  intid = highest_pending_locked(pe->index, 1);
+  pthread_mutex_unlock(&g_gic_lock);
+
+  return intid;
+}
+
+void
+hs_gic_set_level(HS_PE *pe, uint32_t intid, uint32_t level)
+{
+  uint32_t idx = pe ? pe->index : 0;
+  HS_IRQ_BANK *b = bank_of(idx, intid);
+
+  pthread_mutex_lock(&g_gic_lock);
+  if (bit_get(b->line, intid) != !!level) {
+      if (level && bit_get(b->edge, intid))
+          bit_set(b->pend, intid, 1);
+      bit_set(b->line, intid, level);
+      if (level)
+          notify_intid(idx, intid);
+  }
+  gic_unlock_and_notify();
+}
+
+void
+hs_gic_set_pending(HS_PE *pe, uint32_t intid)
+{
+  uint32_t idx = pe ? pe->index : 0;
+
+  pthread_mutex_lock(&g_gic_lock);
+  bit_set(bank_of(idx, intid)->pend, intid, 1);
+  notify_intid(idx, intid);
+  gic_unlock_and_notify();
+}
+
+/*
+ * Registers with one bit per INTID: base_off selects the register block,
+ * off is the byte offset of the register within the block.
+ */
+static uint32_t
+bank_bits_read(HS_IRQ_BANK *b, uint32_t base_off, uint32_t off)
+{
+  uint32_t w = off / 4;
+
+  switch (base_off) {
+  case 0x080: return b->group[w];
+  case 0x100:
+  case 0x180: return b->enable[w];
+  case 0x200:
+  case 0x280: return pend_word(b, w);
+  case 0x300:
+  case 0x380: return b->active[w];
+  case 0xD00: return b->grpmod[w];
+  default:    return 0;
+  }
+}
+
+static void
+bank_bits_write(HS_IRQ_BANK *b, uint32_t base_off, uint32_t off, uint32_t value)
+{
+  uint32_t w = off / 4;
+
+  switch (base_off) {
+  case 0x080: b->group[w] = value; break;
+  case 0x100: b->enable[w] |= value; break;
+  case 0x180: b->enable[w] &= ~value; break;
+  case 0x200: b->pend[w] |= value; break;
+  case 0x280: b->pend[w] &= ~value; break;
+  case 0x300: b->active[w] |= value; break;
+  case 0x380: b->active[w] &= ~value; break;
+  case 0xD00: b->grpmod[w] = value; break;
+  default:    break;
+  }
+}
+
+/* Common layout of the GICD and SGI_base interrupt registers */
+static int
+bank_read(HS_IRQ_BANK *b, uint64_t off, uint32_t width, uint32_t words, uint64_t *value)
+{
+  uint32_t i, w;
+
+  if (off >= 0x080 && off < 0x400) {
+      if ((off & 0x7F) / 4 >= words)
+          *value = 0;
+      else
+          *value = bank_bits_read(b, off & ~0x7FULL, off & 0x7F);
+      return 1;
+  }
+  if (off >= 0x400 && off < 0x400 + words * 32) {
+      *value = 0;
+      for (i = 0; i < width; i++)
+          *value |= (uint64_t)b->prio[off - 0x400 + i] << (8 * i);
+      return 1;
+  }
+  if (off >= 0xC00 && off < 0xC00 + words * 8) {
+      w = (off - 0xC00) / 4;
+      *value = 0;
+      for (i = 0; i < 16; i++) {
+          if (bit_get(b->edge, w * 16 + i))
+              *value |= 2u << (2 * i);
+      }
+      return 1;
+  }
+  if (off >= 0xD00 && off < 0xD00 + words * 4) {
+      *value = bank_bits_read(b, 0xD00, off - 0xD00);
+      return 1;
+  }
+  return 0;
+}
+
+/* INTIDs below first are reserved in this frame and ignore writes */
+static int
+bank_write(HS_IRQ_BANK *b, uint32_t pe, uint32_t first, uint64_t off, uint64_t value,
+           uint32_t width, uint32_t words)
+{
+  uint32_t i, w;
+
+  if (off >= 0x080 && off < 0x400) {
+      w = (off & 0x7F) / 4;
+      if (w < words && w >= first / 32) {
+          bank_bits_write(b, off & ~0x7FULL, off & 0x7F, value);
+          for (i = 0; i < 32; i++) {
+              if (value >> i & 1)
+                  notify_intid(pe, w * 32 + i);
+          }
+      }
+      return 1;
+  }
+  if (off >= 0x400 && off < 0x400 + words * 32) {
+      if (off - 0x400 >= first) {
+          for (i = 0; i < width; i++)
+              b->prio[off - 0x400 + i] = value >> (8 * i);
+      }
+      return 1;
+  }
+  if (off >= 0xC00 && off < 0xC00 + words * 8) {
+      w = (off - 0xC00) / 4;
+      /* SGIs are always edge-triggered */
+      for (i = 0; i < 16 && w * 16 + i >= 16; i++)
+          bit_set(b->edge, w * 16 + i, (value >> (2 * i + 1)) & 1);
+      return 1;
+  }
+  if (off >= 0xD00 && off < 0xD00 + words * 4) {
+      bank_bits_write(b, 0xD00, off - 0xD00, value);
+      return 1;
+  }
+  return 0;
+}
+
+/* Distributor */
+
+static uint64_t
+gicd_read(void *ctx, uint64_t off, uint32_t width)
+{
+  uint64_t value = 0;
+  uint32_t n;
+
+  (void)ctx;
+  pthread_mutex_lock(&g_gic_lock);
+  if (off == 0x0000) {
+      value = g_gicd.ctlr;
+  } else if (off == 0x0004) {
+      value = ((HS_MAX_INTR / 32) - 1) | GICD_TYPER_IDBITS | GICD_TYPER_LPIS |
+              ((g_hs_config.num_pe > 8 ? 7 : g_hs_config.num_pe - 1) << 5);
+  } else if (off == 0x0008) {
+      value = HS_GIC_IIDR;
+  } else if (off == 0xFFE8) {
+      value = HS_GIC_PIDR2;
+  } else if (off >= 0x6000 && off < 0x6000 + HS_MAX_INTR * 8) {
+      n = (off - 0x6000) / 8;
+      value = g_gicd.irouter[n] >> (8 * (off & 7));
+      if (width == 4)
+          value &= 0xFFFFFFFF;
+  } else if (bank_read(&g_gicd.spi, off, width, HS_INTR_WORDS, &value)) {
+      /* SGIs and PPIs are in the redistributors when affinity routing is on */
+      if (off >= 0x80 && off < 0x400 && (off & 0x7F) == 0)
+          value = 0;
+  }
+  pthread_mutex_unlock(&g_gic_lock);
+
+  return value;
+}
+
+static void
+gicd_write(void *ctx, uint64_t off, uint64_t value, uint32_t width)
+{
+  uint32_t n, i;
+
+  (void)ctx;
+  pthread_mutex_lock(&g_gic_lock);
+  if (off == 0x0000) {
+      g_gicd.ctlr = value & 0x7FFFFFFF;
+      for (i = 0; i < g_hs_config.num_pe; i++)
+          notify_pe(i);
+  } else if (off >= 0x6000 && off < 0x6000 + HS_MAX_INTR * 8) {
+      n = (off - 0x6000) / 8;
+      if (n >= HS_NUM_PRIV_INTR) {
+          if (width == 8) {
+              g_gicd.irouter[n] = value;
+          } else if (off & 4) {
+              g_gicd.irouter[n] = (g_gicd.irouter[n] & 0xFFFFFFFFULL) | (value << 32);
+          } else {
+              g_gicd.irouter[n] = (g_gicd.irouter[n] & ~0xFFFFFFFFULL) | (value & 0xFFFFFFFF);
+          }
+          update_route(n);
+          notify_intid(0, n);
+      }
+  } else {
+      bank_write(&g_gicd.spi, 0, HS_NUM_PRIV_INTR, off, value, width, HS_INTR_WORDS);
+  }
+  gic_unlock_and_notify();
+}
+
+/* Redistributors: RD_base and SGI_base frames of each PE */
+
+static uint64_t
+gicr_read(void *ctx, uint64_t off, uint32_t width)
+{
+  uint32_t pe = off / HS_GICR_FRAME;
+  uint64_t value = 0;
+  HS_GICR *r;
+
+  (void)ctx;
+  if (pe >= g_hs_config.num_pe)
+      return 0;
+  r = &g_gicr[pe];
+  off %= HS_GICR_FRAME;
+
+  pthread_mutex_lock(&g_gic_lock);
+  switch (off) {
+  case 0x0000: value = r->ctlr; break;
+  case 0x0004: value = HS_GIC_IIDR; break;
+  case 0x0008:
+  case 0x000C:
+      value = ((g_hs_pe[pe].mpidr & 0xFFFFFF) | ((g_hs_pe[pe].mpidr >> 32 & 0xFF) << 24)) << 32 |
+              (uint64_t)pe << 8 | (pe == g_hs_config.num_pe - 1 ? (1u << 4) : 0) | 1;
+      value >>= 8 * (off & 4);
+      if (width == 4)
+          value &= 0xFFFFFFFF;
+      break;
+  case 0x0014: value = r->waker; break;
+  case 0x0070: value = r->propbaser; break;
+  case 0x0078: value = r->pendbaser; break;
+  case 0xFFE8: value = HS_GIC_PIDR2; break;
+  case 0x1FFE8: value = HS_GIC_PIDR2; break;
+  default:
+      if (off >= 0x10000)
+          bank_read(&r->priv, off - 0x10000, width, 1, &value);
+      break;
+  }
+  pthread_mutex_unlock(&g_gic_lock);
+
+  return value;
+}
+
+static void
+gicr_write(void *ctx, uint64_t off, uint64_t value, uint32_t width)
+{
+  uint32_t pe = off / HS_GICR_FRAME;
+  HS_GICR *r;
+
+  (void)ctx;
+  if (pe >= g_hs_config.num_pe)
+      return;
+  r = &g_gicr[pe];
+  off %= HS_GICR_FRAME;
+
+  pthread_mutex_lock(&g_gic_lock);
+  switch (off) {
+  case 0x0000: r->ctlr = value & 1; break;
+  case 0x0014:
+      /* ChildrenAsleep follows ProcessorSleep without delay */
+      r->waker = (value & GICR_WAKER_PS) ? (GICR_WAKER_PS | GICR_WAKER_CA) : 0;
+      break;
+  case 0x0070: r->propbaser = value; break;
+  case 0x0078: r->pendbaser = value; break;
+  default:
+      if (off >= 0x10000)
+          bank_write(&r->priv, pe, 0, off - 0x10000, value, width, 1);
+      break;
+  }
+  notify_pe(pe);
+  gic_unlock_and_notify();
+}
+
+/* ITS: register files only, commands complete as soon as they are queued */
+
+static uint64_t
+gits_read(void *ctx, uint64_t off, uint32_t width)
+{
+  HS_GITS *its = ctx;
+  uint64_t value = 0;
+
+  switch (off & ~7ULL) {
+  case 0x0000:
+      /* GITS_CTLR.Quiescent, GITS_IIDR */
+      value = (its->ctlr | (1u << 31)) | ((uint64_t)HS_GIC_IIDR << 32);
+      break;
+  case 0x0008:
+      /* Physical LPIs, 8-byte ITT entries, 16 EventID, DeviceID and CollectionID bits */
+      value = 1 | (7u << 4) | (15u << 8) | (15u << 13) | (1ULL << 36) | (15ULL << 32);
+      break;
+  case 0x0080: value = its->cbaser; break;
+  case 0x0088:
+  case 0x0090: value = its->cwriter; break;
+  case 0xFFE8: value = HS_GIC_PIDR2; break;
+  default:
+      if (off >= 0x100 && off < 0x140)
+          value = its->baser[(off - 0x100) / 8];
+      break;
+  }
+  value >>= 8 * (off & 4);
+  if (width == 4)
+      value &= 0xFFFFFFFF;
+  return value;
+}
+
+static void
+gits_write(void *ctx, uint64_t off, uint64_t value, uint32_t width)
+{
+  HS_GITS *its = ctx;
+  uint32_t n;
+
+  if (width == 4 && (off & 4) && off != 0x0004)
+      value <<= 32;
+
+  switch (off & ~7ULL) {
+  case 0x0000:
+      if (off == 0)
+          its->ctlr = value & 1;
+      break;
+  case 0x0080: its->cbaser = value; break;
+  case 0x0088: its->cwriter = value & ~1ULL; break;
+  default:
+      if (off >= 0x100 && off < 0x140) {
+          n = (off - 0x100) / 8;
+          /* Type and Entry_Size are read-only: table 0 devices, table 1 collections */
+          value &= ~(0x7ULL << 56 | 0x1FULL << 48);
+          if (n < 2)
+              value |= (n == 0 ? 1ULL : 4ULL) << 56 | 7ULL << 48;
+          else
+              value = 0;
+          its->baser[n] = value;
+      }
+      /* GITS_TRANSLATER: LPIs are not modelled */
+      break;
+  }
+}
+
+static void
+gits_reset(HS_GITS *its)
+{
+  its->baser[0] = 1ULL << 56 | 7ULL << 48;
+  its->baser[1] = 4ULL << 56 | 7ULL << 48;
+}
+
+/* Virtual interface control (GICH) is not implemented */
+static uint64_t
+raz_read(void *ctx, uint64_t off, uint32_t width)
+{
+  (void)ctx;
+  (void)off;
+  (void)width;
+  return 0;
+}
+
+static void
+wi_write(void *ctx, uint64_t off, uint64_t value, uint32_t width)
+{
+  (void)ctx;
+  (void)off;
+  (void)value;
+  (void)width;
+}
+
+/* CPU interface system registers */
+
+static uint64_t
+icc_iar1_read(HS_PE *pe, uint32_t slot)
+{
+  HS_GICR *r = &g_gicr[pe->index];
+  HS_IRQ_BANK *b;
+  uint32_t intid;
+
+  (void)slot;
+  pthread_mutex_lock(&g_gic_lock);
+  intid = highest_pending_locked(pe->index, 1);
+  if (intid >= HS_MAX_INTR) {
+      pthread_mutex_unlock(&g_gic_lock);
+      return HS_SPURIOUS;
+  }
+  b = bank_of(pe->index, intid);
+  bit_set(b->pend, intid, 0);
+  bit_set(b->active, intid, 1);
+  if (r->active_depth < HS_MAX_ACTIVE)
+      r->active_prio[r->active_depth++] = b->prio[intid];
+  pthread_mutex_unlock(&g_gic_lock);
+
+  hs_trace("ack INTID %u", intid);
+  return intid;
+}
+
+static void
+deactivate(HS_PE *pe, uint32_t intid)
+{
+  if (intid >= HS_MAX_INTR)
+      return;
+  bit_set(bank_of(pe->index, intid)->active, intid, 0);
+  notify_intid(pe->index, intid);
+}
+
+static void
+icc_eoir1_write(HS_PE *pe, uint32_t slot, uint64_t value)
+{
+  HS_GICR *r = &g_gicr[pe->index];
+  uint32_t intid = value & 0xFFFFFF;
+
+  (void)slot;
+  if (intid == HS_SPURIOUS)
+      return;
+
+  pthread_mutex_lock(&g_gic_lock);
+  if (r->active_depth)
+      r->active_depth--;
+  if (!(r->icc_ctlr & ICC_CTLR_EOIMODE))
+      deactivate(pe, intid);
+  notify_pe(pe->index);
+  gic_unlock_and_notify();
+}
+
+static void
+icc_dir_write(HS_PE *pe, uint32_t slot, uint64_t value)
+{
+  (void)slot;
+  pthread_mutex_lock(&g_gic_lock);
+  deactivate(pe, value & 0xFFFFFF);
+  gic_unlock_and_notify();
+}
+
+static uint64_t
+icc_hppir1_read(HS_PE *pe, uint32_t slot)
+{
+  uint32_t intid;
+
+  (void)slot;
+  pthread_mutex_lock(&g_gic_lock);
+  intid = highest_pending_locked(pe->index, 0);
+  pthread_mutex_unlock(&g_gic_lock);
+
+  return intid < HS_MAX_INTR ? intid : HS_SPURIOUS;
+}
+
+static uint64_t
+icc_rpr_read(HS_PE *pe, uint32_t slot)
+{
+  HS_GICR *r = &g_gicr[pe->index];
+
+  (void)slot;
+  return r->active_depth ? r->active_prio[r->active_depth - 1] : 0xFF;
+}
+
+static uint32_t g_slot_pmr, g_slot_igrpen1, g_slot_bpr1, g_slot_icc_ctlr;
+static uint32_t g_slot_ich_hcr;
+
+static void
+icc_cpuif_write(HS_PE *pe, uint32_t slot, uint64_t value)
+{
+  HS_GICR *r = &g_gicr[pe->index];
+
+  pthread_mutex_lock(&g_gic_lock);
+  if (slot == g_slot_pmr) {
+      value &= 0xFF;
+      r->pmr = value;
+  } else if (slot == g_slot_igrpen1) {
+      value &= 1;
+      r->igrpen1 = value;
+  } else if (slot == g_slot_bpr1) {
+      value &= 7;
+      r->bpr1 = value;
+  } else if (slot == g_slot_icc_ctlr) {
+      value &= ICC_CTLR_EOIMODE | 1;
+      r->icc_ctlr = value;
+  }
+  hs_sysreg_set(pe, slot, value);
+  notify_pe(pe->index);
+  gic_unlock_and_notify();
+}
+
+/* ICC_SGI1R_EL1: INTID[27:24], TargetList[15:0] in Aff3.Aff2.Aff1, IRM[40] */
+static void
+icc_sgi1r_write(HS_PE *pe, uint32_t slot, uint64_t value)
+{
+  uint32_t intid = (value >> 24) & 0xF;
+  uint64_t aff = ((value >> 48) & 0xFF) << 32 | ((value >> 32) & 0xFF) << 16 |
+                 ((value >> 16) & 0xFF) << 8;
+  uint32_t i, t;
+  HS_PE *target;
+
+  (void)slot;
+  pthread_mutex_lock(&g_gic_lock);
+  if (value & (1ULL << 40)) {
+      for (i = 0; i < g_hs_config.num_pe; i++) {
+          if (i != pe->index) {
+              bit_set(g_gicr[i].priv.pend, intid, 1);
+              notify_pe(i);
+          }
+      }
+  } else {
+      for (t = 0; t < 16; t++) {
+          if (!(value >> t & 1))
+              continue;
+          target = hs_pe_by_mpidr(aff | t);
+          if (target) {
+              bit_set(g_gicr[target->index].priv.pend, intid, 1);
+              notify_pe(target->index);
+          }
+      }
+  }
+  gic_unlock_and_notify();
+  hs_trace("SGI %u (0x%llx)", intid, (unsigned long long)value);
+}
+
+static uint64_t
+spurious_read(HS_PE *pe, uint32_t slot)
+{
+  (void)pe;
+  (void)slot;
+  return HS_SPURIOUS;
+}
+
+/*
+ * Virtual CPU interface control. No list register is ever in use, so the
+ * underflow and no-pending conditions hold whenever they are enabled, and
+ * the maintenance interrupt follows ICH_HCR_EL2 alone.
+ */
+static uint64_t
+ich_misr_read(HS_PE *pe, uint32_t slot)
+{
+  uint64_t hcr = hs_sysreg_get(pe, g_slot_ich_hcr);
+  uint64_t misr = 0;
+
+  (void)slot;
+  if (!(hcr & ICH_HCR_EN))
+      return 0;
+  if (hcr & ICH_HCR_UIE)
+      misr |= ICH_MISR_U;
+  if (hcr & ICH_HCR_NPIE)
+      misr |= ICH_MISR_NP;
+  return misr;
+}
+
+static void
+ich_hcr_write(HS_PE *pe, uint32_t slot, uint64_t value)
+{
+  hs_sysreg_set(pe, slot, value);
+  hs_gic_set_level(pe, platform_pe_cfg.pe_info[pe->index].gmain_gsiv,
+                   ich_misr_read(pe, slot) != 0);
+}
+
+static void
+gic_define_sysregs(void)
+{
+  hs_sysreg_define("icc_iar1_el1", 0, icc_iar1_read, NULL);
+  hs_sysreg_define("icc_eoir1_el1", 0, NULL, icc_eoir1_write);
+  hs_sysreg_define("icc_dir_el1", 0, NULL, icc_dir_write);
+  hs_sysreg_define("icc_hppir1_el1", 0, icc_hppir1_read, NULL);
+  hs_sysreg_define("icc_rpr_el1", 0, icc_rpr_read, NULL);
+  hs_sysreg_define("icc_sgi1r_el1", 0, NULL, icc_sgi1r_write);
+  hs_sysreg_define("icc_sgi1r", 0, NULL, icc_sgi1r_write);
+  g_slot_pmr = hs_sysreg_define("icc_pmr_el1", 0, NULL, icc_cpuif_write);
+  g_slot_igrpen1 = hs_sysreg_define("icc_igrpen1_el1", 0, NULL, icc_cpuif_write);
+  g_slot_bpr1 = hs_sysreg_define("icc_bpr1_el1", 0, NULL, icc_cpuif_write);
+  g_slot_icc_ctlr = hs_sysreg_define("icc_ctlr_el1", 0, NULL, icc_cpuif_write);
+
+  /* Group 0 is owned by EL3 and never signalled to the ACS */
+  hs_sysreg_define("icc_iar0_el1", 0, spurious_read, NULL);
+  hs_sysreg_define("icc_hppir0_el1", 0, spurious_read, NULL);
+  hs_sysreg_define("icc_sre_el1", 0x7, NULL, NULL);
+  hs_sysreg_define("icc_sre_el2", 0xF, NULL, NULL);
+
+  g_slot_ich_hcr = hs_sysreg_define("ich_hcr_el2", 0, NULL, ich_hcr_write);
+  hs_sysreg_define("ich_misr_el2", 0, ich_misr_read, NULL);
+}
+
+void
+hs_gic_init(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < HS_MAX_INTR; i++)
+      g_gicd.target[i] = -1;
+
+  for (i = 0; i < g_hs_config.num_pe; i++) {
+      g_gicr[i].waker = GICR_WAKER_PS | GICR_WAKER_CA;
+      /* SGIs are edge-triggered, PPIs reset to level */
+      g_gicr[i].priv.edge[0] = 0xFFFF;
+      g_gicr[i].priv.enable[0] = 0;
+  }
+
+  hs_region_add("gicd", platform_gic_cfg.gicd_base[0], 0x10000, NULL, gicd_read, gicd_write);
+  hs_region_add("gicr", platform_gic_cfg.gicr_rd_base[0],
+                (uint64_t)g_hs_config.num_pe * HS_GICR_FRAME, NULL, gicr_read, gicr_write);
+  for (i = 0; i < platform_gic_cfg.num_gicits; i++) {
+      gits_reset(&g_gits[i]);
+      hs_region_add("gits", platform_gic_cfg.gicits_base[i], HS_GITS_FRAME, &g_gits[i],
+                    gits_read, gits_write);
+  }
+  for (i = 0; i < platform_gic_cfg.num_gich; i++)
+      hs_region_add("gich", platform_gic_cfg.gich_base[i], 0x10000, NULL, raz_read, wi_write);
+
+  gic_define_sysregs();
+}
@@ -0,0 +1,303 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * Host entry point of the HOSTSIM platform.
+ *
+ * The command line is converted into the EL3 parameter block that the
+ * baremetal image already understands (val/include/acs_el3_param.h), the
+ * platform models are created and the ACS main of the build runs on PE0,
+ * which is the main thread of the process.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "hostsim.h"
+#include "platform_override_fvp.h"
+#include "val/include/acs_el3_param.h"
+#include "val/include/rule_based_execution_enum.h"
+#include "val/include/acs_interface.h"
+
+extern uint64_t g_el3_param_magic;
+extern uint64_t g_el3_param_addr;
+extern char *rule_id_string[RULE_ID_SENTINEL];
+extern char *module_name_string[MODULE_ID_SENTINEL];
+
+#if defined(BSA)
+extern int32_t ShellAppMainbsa(void);
+#define HS_ACS_MAIN   ShellAppMainbsa
+#define HS_ACS_NAME   "bsa"
+#define HS_ACS_LEVEL  PLATFORM_OVERRIDE_BSA_LEVEL
+#elif defined(SBSA)
+extern int32_t ShellAppMainsbsa(void);
+#define HS_ACS_MAIN   ShellAppMainsbsa
+#define HS_ACS_NAME   "sbsa"
+#define HS_ACS_LEVEL  PLATFORM_OVERRIDE_SBSA_LEVEL
+#elif defined(PC_BSA)
+extern int32_t ShellAppMainpcbsa(void);
+#define HS_ACS_MAIN   ShellAppMainpcbsa
+#define HS_ACS_NAME   "pc_bsa"
+#define HS_ACS_LEVEL  PLATFORM_OVERRIDE_PCBSA_LEVEL
+#else
+#error "HOSTSIM needs one of BSA, SBSA or PC_BSA"
+#endif
+
+HS_CONFIG g_hs_config = {
+  .cntfrq    = 100000000,
+  .timescale = 1,
+};
+
+static acs_el3_params g_hs_params;
+static RULE_ID_e      g_hs_rules[RULE_ID_SENTINEL];
+static RULE_ID_e      g_hs_skip_rules[RULE_ID_SENTINEL];
+static uint32_t       g_hs_modules[MODULE_ID_SENTINEL];
+static uint32_t       g_hs_skip_modules[MODULE_ID_SENTINEL];
+static uint32_t       g_hs_params_used;
+
+static struct timespec g_hs_start;
+
+void
+hs_fatal(const char *fmt, ...)
+{
+  va_list ap;
+
+  fflush(stdout);
+  fprintf(stderr, "hostsim: PE%d: ",
+          hs_self ? (int)hs_self->index : -1);
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+  va_end(ap);
+  fprintf(stderr, "\n");
+  abort();
+}
+
+void
+hs_trace(const char *fmt, ...)
+{
+  struct timespec now;
+  va_list ap;
+  char buf[256];
+  int len;
+
+  if (!g_hs_config.trace)
+      return;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  len = snprintf(buf, sizeof(buf), "[hostsim %6.3f PE%d] ",
+                 (double)(now.tv_sec - g_hs_start.tv_sec) +
+                 (double)(now.tv_nsec - g_hs_start.tv_nsec) / 1e9,
+                 hs_self ? (int)hs_self->index : -1);
+  va_start(ap, fmt);
+  len += vsnprintf(buf + len, sizeof(buf) - len - 1, fmt, ap);
+  va_end(ap);
+  if (len > (int)sizeof(buf) - 2)
+      len = sizeof(buf) - 2;
+  buf[len++] = '\n';
+  if (write(STDERR_FILENO, buf, len) < 0)
+      return;
+}
+
+static void
+usage(const char *prog)
+{
+  fprintf(stderr,
+    "Usage: %s [options]\n"
+    "  -r <rule,...>         Run only these rules (e.g. B_PE_01,B_GIC_02)\n"
+    "  -skip <rule,...>      Skip these rules\n"
+    "  -m <module,...>       Run only these modules (e.g. PE,GIC,PCIE)\n"
+    "  -skipmodule <mod,...> Skip these modules\n"
+    "  -v <1-5>              Print verbosity (1 = TRACE ... 5 = ERROR)\n"
+    "  -l <level>            Run rules up to this level\n"
+    "  -timeout <us>         Wakeup test timeout (500 us - 2 s)\n"
+    "  -p2p                  PCIe hierarchy supports peer-to-peer\n"
+    "  -cache                PCIe address translation cache is present\n"
+    "  -mmio                 Print pal_mmio_read/write accesses\n"
+    "  -topology <file>      PCIe topology file (default: platform hierarchy)\n"
+    "  -replay <file>        Serve unmodelled devices from an exported MMIO recording\n"
+    "  -timescale <n>        Run the generic counter n times faster than host time\n"
+    "  -trace                Print model events on stderr\n"
+    "  -check <name,...>     Run these host checks instead of the suite ('all' for every one):\n",
+    prog);
+  hs_check_usage();
+  exit(2);
+}
+
+static uint32_t
+lookup_name(char **table, uint32_t count, const char *name)
+{
+  uint32_t i;
+
+  for (i = 0; i < count; i++) {
+      if (table[i] && strcasecmp(table[i], name) == 0)
+          return i;
+  }
+  return count;
+}
+
+static uint32_t
+parse_list(const char *arg, char **table, uint32_t count, void *out, uint32_t width)
+{
+  char *copy = strdup(arg), *tok, *save = NULL;
+  uint32_t n = 0, id;
+
+  for (tok = strtok_r(copy, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+      id = lookup_name(table, count, tok);
+      if (id == count) {
+          fprintf(stderr, "hostsim: unknown name '%s'\n", tok);
+          exit(2);
+      }
+      if (width == sizeof(RULE_ID_e))
+          ((RULE_ID_e *)out)[n++] = (RULE_ID_e)id;
+      else
+          ((uint32_t *)out)[n++] = id;
+  }
+  free(copy);
+  return n;
+}
+
+static void
+parse_args(int argc, char **argv)
+{
+  int i;
+
+  /* Same knobs as an unmodified run, the command line then overrides them */
+  g_hs_params.version = ACS_EL3_PARAM_VERSION;
+  g_hs_params.verbose = PLATFORM_OVERRIDE_PRINT_LEVEL;
+  g_hs_params.timeout = PLATFORM_OVERRIDE_TIMEOUT;
+  g_hs_params.level = HS_ACS_LEVEL;
+  g_hs_params.level_selection = LVL_FILTER_MAX;
+
+  for (i = 1; i < argc; i++) {
+      const char *opt = argv[i];
+      const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+      if (!strcmp(opt, "-r") && val) {
+          g_hs_params.rule_array_count = parse_list(val, rule_id_string, RULE_ID_SENTINEL,
+                                                    g_hs_rules, sizeof(RULE_ID_e));
+          g_hs_params.rule_array_addr = (uint64_t)g_hs_rules;
+      } else if (!strcmp(opt, "-skip") && val) {
+          g_hs_params.skip_rule_array_count = parse_list(val, rule_id_string,
+                                                         RULE_ID_SENTINEL, g_hs_skip_rules,
+                                                         sizeof(RULE_ID_e));
+          g_hs_params.skip_rule_array_addr = (uint64_t)g_hs_skip_rules;
+      } else if (!strcmp(opt, "-m") && val) {
+          g_hs_params.module_array_count = parse_list(val, module_name_string,
+                                                      MODULE_ID_SENTINEL, g_hs_modules,
+                                                      sizeof(uint32_t));
+          g_hs_params.module_array_addr = (uint64_t)g_hs_modules;
+      } else if (!strcmp(opt, "-skipmodule") && val) {
+          g_hs_params.skip_module_array_count = parse_list(val, module_name_string,
+                                                           MODULE_ID_SENTINEL,
+                                                           g_hs_skip_modules,
+                                                           sizeof(uint32_t));
+          g_hs_params.skip_module_array_addr = (uint64_t)g_hs_skip_modules;
+      } else if (!strcmp(opt, "-v") && val) {
+          g_hs_params.verbose = strtoul(val, NULL, 0);
+      } else if (!strcmp(opt, "-l") && val) {
+          g_hs_params.level = strtoul(val, NULL, 0);
+      } else if (!strcmp(opt, "-timeout") && val) {
+          g_hs_params.timeout = strtoul(val, NULL, 0);
+      } else if (!strcmp(opt, "-topology") && val) {
+          g_hs_config.topology = val;
+      } else if (!strcmp(opt, "-replay") && val) {
+          g_hs_config.replay = val;
+      } else if (!strcmp(opt, "-check") && val) {
+          hs_check_select(val);
+          g_hs_config.check = 1;
+      } else if (!strcmp(opt, "-timescale") && val) {
+          g_hs_config.timescale = strtoul(val, NULL, 0);
+          if (g_hs_config.timescale == 0)
+              g_hs_config.timescale = 1;
+      } else if (!strcmp(opt, "-p2p")) {
+          g_hs_params.p2p = 1;
+          g_hs_params_used = 1;
+          continue;
+      } else if (!strcmp(opt, "-cache")) {
+          g_hs_params.cache = 1;
+          g_hs_params_used = 1;
+          continue;
+      } else if (!strcmp(opt, "-mmio")) {
+          g_hs_params.mmio = 1;
+          g_hs_params_used = 1;
+          continue;
+      } else if (!strcmp(opt, "-trace")) {
+          g_hs_config.trace = 1;
+          continue;
+      } else {
+          usage(argv[0]);
+      }
+
+      if (strcmp(opt, "-topology") && strcmp(opt, "-timescale") && strcmp(opt, "-replay") &&
+          strcmp(opt, "-check"))
+          g_hs_params_used = 1;
+      i++;
+  }
+
+  g_hs_config.check_print_level = g_hs_params.verbose;
+
+  if (g_hs_params_used) {
+      g_el3_param_magic = ACS_EL3_PARAM_MAGIC;
+      g_el3_param_addr = (uint64_t)&g_hs_params;
+  }
+}
+
+/* Linked in place of pal_exit_acs() of the platform PAL, which parks the PE:
+   the suite returns to main() instead */
+uint32_t
+__wrap_pal_exit_acs(void)
+{
+  return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+  clock_gettime(CLOCK_MONOTONIC, &g_hs_start);
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  parse_args(argc, argv);
+
+  hs_symbols_load();
+  hs_mem_init();
+  hs_pe_init();
+  hs_gic_init();
+  hs_timer_init();
+  hs_smmu_init();
+  hs_pcie_init();
+
+  /* After the other models, which keep the frames they cover */
+  if (g_hs_config.replay)
+      hs_replay_init(g_hs_config.replay);
+
+  if (g_hs_config.check) {
+      hs_trace("starting the host checks on %u PEs", g_hs_config.num_pe);
+      hs_pe_start_primary(hs_check_main);
+      return hs_check_failed() ? 1 : 0;
+  }
+
+  hs_trace("starting %s on %u PEs", HS_ACS_NAME, g_hs_config.num_pe);
+  hs_pe_start_primary((void (*)(void))HS_ACS_MAIN);
+
+  /* The suite returns after its report; the secondaries are parked or off */
+  hs_replay_report();
+  return acs_get_test_status()->failed ? 1 : 0;
+}
@@ -0,0 +1,650 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * Physical address space of the HOSTSIM platform.
+ *
+ * The simulated address space is the host address space of the process:
+ *  - the ACS memory pool is mapped at its platform address at start-up,
+ *  - RAM and device windows described by the platform (memory map, PCIe
+ *    BARs) are mapped on first touch,
+ *  - device register files are model regions. pal_mmio_read/write() calls
+ *    reach them directly; a plain load or store from a test faults and the
+ *    faulting MOV is emulated against the model.
+ * Any other address raises a data abort on the accessing PE.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <elf.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "hostsim.h"
+#include "pal_common_support.h"
+#include "platform_image_def.h"
+#include "platform_override_struct.h"
+#include "platform_override_fvp.h"
+#include "pal_pl011_uart.h"
+
+extern const PLATFORM_OVERRIDE_MEMORY_INFO_TABLE platform_mem_cfg;
+
+#define HS_MAX_REGION         256
+#define HS_MAX_WINDOW         32
+#define HS_LAZY_CHUNK         0x100000ULL
+
+typedef struct {
+  const char       *name;
+  uint64_t          base;
+  uint64_t          size;
+  void             *ctx;
+  hs_mmio_read_fn   read;
+  hs_mmio_write_fn  write;
+} HS_REGION;
+
+static HS_REGION g_region[HS_MAX_REGION];
+static uint32_t  g_region_count;
+
+static struct {
+  uint64_t base;
+  uint64_t size;
+} g_window[HS_MAX_WINDOW];
+static uint32_t g_window_count;
+
+void
+hs_region_add(const char *name, uint64_t base, uint64_t size, void *ctx,
+              hs_mmio_read_fn read, hs_mmio_write_fn write)
+{
+  uint32_t i;
+
+  if (g_region_count == HS_MAX_REGION)
+      hs_fatal("too many model regions");
+
+  /* Keep the table sorted by base for the lookup */
+  for (i = g_region_count; i > 0 && g_region[i - 1].base > base; i--)
+      g_region[i] = g_region[i - 1];
+
+  g_region[i].name = name;
+  g_region[i].base = base;
+  g_region[i].size = size;
+  g_region[i].ctx = ctx;
+  g_region[i].read = read;
+  g_region[i].write = write;
+  g_region_count++;
+
+  hs_trace("region %-12s 0x%012lx - 0x%012lx", name, base, base + size - 1);
+}
+
+static HS_REGION *
+region_find(uint64_t addr)
+{
+  static __thread HS_REGION *last;
+  uint32_t lo = 0, hi = g_region_count;
+
+  if (last && (addr - last->base) < last->size)
+      return last;
+
+  while (lo < hi) {
+      uint32_t mid = (lo + hi) / 2;
+
+      if (addr < g_region[mid].base)
+          hi = mid;
+      else if (addr - g_region[mid].base >= g_region[mid].size)
+          lo = mid + 1;
+      else
+          return (last = &g_region[mid]);
+  }
+  return NULL;
+}
+
+int
+hs_region_overlaps(uint64_t base, uint64_t size)
+{
+  uint32_t i;
+
+  for (i = 0; i < g_region_count; i++) {
+      if (g_region[i].base < base + size && base < g_region[i].base + g_region[i].size)
+          return 1;
+  }
+  return 0;
+}
+
+static void
+window_add(uint64_t base, uint64_t size)
+{
+  if (g_window_count == HS_MAX_WINDOW)
+      hs_fatal("too many memory windows");
+  g_window[g_window_count].base = base;
+  g_window[g_window_count].size = size;
+  g_window_count++;
+}
+
+/* Called from the SIGSEGV handler, so only async-signal-safe calls */
+int
+hs_mem_lazy_map(uint64_t addr)
+{
+  uint64_t base = 0, end = 0, chunk;
+  uint32_t i;
+  void *p;
+
+  if (region_find(addr))
+      return 0;
+
+  for (i = 0; i < g_window_count; i++) {
+      if (addr - g_window[i].base < g_window[i].size) {
+          base = g_window[i].base;
+          end = base + g_window[i].size;
+          break;
+      }
+  }
+  if (i == g_window_count && !hs_pcie_bar_contains(addr))
+      return 0;
+  if (i == g_window_count) {
+      base = addr & ~0xFFFULL;
+      end = base + 0x1000;
+  }
+
+  chunk = addr & ~(HS_LAZY_CHUNK - 1);
+  if (chunk < base)
+      chunk = base;
+  if (chunk + HS_LAZY_CHUNK < end)
+      end = chunk + HS_LAZY_CHUNK;
+
+  /* Model regions inside a window, such as replayed devices, stay unmapped.
+     A region sharing the page of the access cannot be kept out. */
+  for (i = 0; i < g_region_count; i++) {
+      uint64_t r_base = g_region[i].base & ~0xFFFULL;
+      uint64_t r_end = (g_region[i].base + g_region[i].size + 0xFFF) & ~0xFFFULL;
+
+      if (r_base >= end || r_end <= chunk)
+          continue;
+      if (r_base > addr)
+          end = r_base;
+      else if (r_end <= addr)
+          chunk = r_end;
+  }
+
+  p = mmap((void *)chunk, end - chunk, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE | MAP_NORESERVE, -1, 0);
+  if (p == MAP_FAILED)
+      /* Another PE mapped it first: retry the access */
+      return 1;
+  if (p != (void *)chunk) {
+      munmap(p, end - chunk);
+      return 0;
+  }
+  return 1;
+}
+
+/* MMIO from the PAL */
+
+uint64_t
+pal_hostsim_mmio_read(uint64_t addr, uint32_t width)
+{
+  HS_REGION *r = region_find(addr);
+  uint64_t value;
+
+  if (r) {
+      hs_model_enter(hs_self);
+      value = r->read ? r->read(r->ctx, addr - r->base, width) : 0;
+      hs_model_exit(hs_self);
+      return value;
+  }
+
+  switch (width) {
+  case 1:
+      return *(volatile uint8_t *)addr;
+  case 2:
+      return *(volatile uint16_t *)addr;
+  case 4:
+      return *(volatile uint32_t *)addr;
+  default:
+      return *(volatile uint64_t *)addr;
+  }
+}
+
+void
+pal_hostsim_mmio_write(uint64_t addr, uint64_t data, uint32_t width)
+{
+  HS_REGION *r = region_find(addr);
+
+  if (r) {
+      hs_model_enter(hs_self);
+      if (r->write)
+          r->write(r->ctx, addr - r->base, data, width);
+      hs_model_exit(hs_self);
+      return;
+  }
+
+  switch (width) {
+  case 1:
+      *(volatile uint8_t *)addr = (uint8_t)data;
+      break;
+  case 2:
+      *(volatile uint16_t *)addr = (uint16_t)data;
+      break;
+  case 4:
+      *(volatile uint32_t *)addr = (uint32_t)data;
+      break;
+  default:
+      *(volatile uint64_t *)addr = data;
+      break;
+  }
+}
+
+/*
+ * Emulation of a faulting plain load or store to a model region. Only the
+ * MOV forms that compilers emit for volatile accesses are decoded:
+ * 88/89/8A/8B, C6/C7, 0F B6/B7/BE/BF and REX.W 63.
+ */
+static const int g_x86_gpr[16] = {
+  REG_RAX, REG_RCX, REG_RDX, REG_RBX, REG_RSP, REG_RBP, REG_RSI, REG_RDI,
+  REG_R8,  REG_R9,  REG_R10, REG_R11, REG_R12, REG_R13, REG_R14, REG_R15
+};
+
+static void
+set_gpr(greg_t *gregs, uint32_t reg, uint32_t size, uint64_t value, int rex)
+{
+  uint64_t *r;
+  uint32_t shift = 0;
+
+  /* AH, CH, DH and BH without a REX prefix */
+  if (size == 1 && !rex && reg >= 4 && reg < 8) {
+      reg -= 4;
+      shift = 8;
+  }
+  r = (uint64_t *)&gregs[g_x86_gpr[reg]];
+
+  switch (size) {
+  case 1:
+      *r = (*r & ~(0xFFULL << shift)) | ((value & 0xFF) << shift);
+      break;
+  case 2:
+      *r = (*r & ~0xFFFFULL) | (value & 0xFFFF);
+      break;
+  case 4:
+      *r = value & 0xFFFFFFFFULL;
+      break;
+  default:
+      *r = value;
+      break;
+  }
+}
+
+static uint64_t
+get_gpr(greg_t *gregs, uint32_t reg, uint32_t size, int rex)
+{
+  uint64_t v;
+
+  if (size == 1 && !rex && reg >= 4 && reg < 8)
+      return (gregs[g_x86_gpr[reg - 4]] >> 8) & 0xFF;
+
+  v = gregs[g_x86_gpr[reg]];
+  return (size == 8) ? v : v & ((1ULL << (size * 8)) - 1);
+}
+
+static uint64_t
+sign_extend(uint64_t v, uint32_t size)
+{
+  uint32_t shift = 64 - size * 8;
+
+  return (uint64_t)(((int64_t)(v << shift)) >> shift);
+}
+
+typedef struct {
+  uint32_t len;
+  uint32_t is_store;
+  uint32_t mem_size;
+  uint32_t reg_size;
+  uint32_t reg;
+  uint32_t rex;
+  uint32_t ext;             /* 1: zero extend, 2: sign extend */
+  uint32_t has_imm;
+  uint64_t imm;
+} HS_MOV;
+
+/* Decodes the MOV forms the compiler emits for volatile device accesses */
+static int
+decode_mov(const uint8_t *ip, HS_MOV *m)
+{
+  const uint8_t *p = ip;
+  uint32_t opsize16 = 0, op, op2 = 0, modrm, mod, rm;
+
+  memset(m, 0, sizeof(*m));
+  for (;; p++) {
+      if (*p == 0x66)
+          opsize16 = 1;
+      else if (*p == 0x2E || *p == 0x3E || *p == 0x26 || *p == 0x36 ||
+               *p == 0x64 || *p == 0x65 || *p == 0x67)
+          continue;
+      else
+          break;
+  }
+  if ((*p & 0xF0) == 0x40)
+      m->rex = *p++;
+
+  op = *p++;
+  if (op == 0x0F)
+      op2 = *p++;
+
+  modrm = *p++;
+  mod = modrm >> 6;
+  m->reg = ((modrm >> 3) & 7) | ((m->rex & 4) << 1);
+  rm = modrm & 7;
+  if (mod == 3)
+      return 0;
+  if (rm == 4) {
+      uint32_t sib = *p++;
+      if ((sib & 7) == 5 && mod == 0)
+          p += 4;
+  } else if (rm == 5 && mod == 0) {
+      p += 4;
+  }
+  p += (mod == 1) ? 1 : (mod == 2) ? 4 : 0;
+
+  m->reg_size = (m->rex & 8) ? 8 : opsize16 ? 2 : 4;
+  switch (op) {
+  case 0x88: m->is_store = 1; m->mem_size = m->reg_size = 1; break;
+  case 0x89: m->is_store = 1; m->mem_size = m->reg_size; break;
+  case 0x8A: m->mem_size = m->reg_size = 1; break;
+  case 0x8B: m->mem_size = m->reg_size; break;
+  case 0xC6:
+      m->is_store = 1; m->mem_size = 1; m->has_imm = 1;
+      m->imm = *p++;
+      break;
+  case 0xC7:
+      m->is_store = 1; m->mem_size = m->reg_size; m->has_imm = 1;
+      if (opsize16) {
+          m->imm = *(const uint16_t *)p;
+          p += 2;
+      } else {
+          m->imm = sign_extend(*(const uint32_t *)p, 4);
+          p += 4;
+      }
+      break;
+  case 0x63:
+      if (!(m->rex & 8))
+          return 0;
+      m->mem_size = 4; m->ext = 2;
+      break;
+  case 0x0F:
+      if (op2 == 0xB6 || op2 == 0xBE)
+          m->mem_size = 1;
+      else if (op2 == 0xB7 || op2 == 0xBF)
+          m->mem_size = 2;
+      else
+          return 0;
+      m->ext = (op2 >= 0xBE) ? 2 : 1;
+      break;
+  default:
+      return 0;
+  }
+  m->len = p - ip;
+  return 1;
+}
+
+int
+hs_mem_emulate(void *ucontext, uint64_t addr)
+{
+  greg_t *gregs = ((ucontext_t *)ucontext)->uc_mcontext.gregs;
+  HS_REGION *r = region_find(addr);
+  uint64_t value;
+  HS_MOV m;
+
+  if (r == NULL || !decode_mov((const uint8_t *)gregs[REG_RIP], &m))
+      return 0;
+
+  /* Pending interrupts are taken after the faulting instruction completes */
+  hs_self->in_model++;
+  if (m.is_store) {
+      value = m.has_imm ? m.imm : get_gpr(gregs, m.reg, m.mem_size, m.rex);
+      if (r->write)
+          r->write(r->ctx, addr - r->base, value, m.mem_size);
+  } else {
+      value = r->read ? r->read(r->ctx, addr - r->base, m.mem_size) : 0;
+      if (m.mem_size < 8)
+          value &= (1ULL << (m.mem_size * 8)) - 1;
+      if (m.ext == 2)
+          value = sign_extend(value, m.mem_size);
+      set_gpr(gregs, m.reg, m.ext ? m.reg_size : m.mem_size, value, m.rex);
+  }
+  hs_self->in_model--;
+
+  gregs[REG_RIP] += m.len;
+  return 1;
+}
+
+uint32_t
+hs_mem_insn_length(uint64_t ip)
+{
+  HS_MOV m;
+
+  return decode_mov((const uint8_t *)ip, &m) ? m.len : 0;
+}
+
+/*
+ * PL011 at the console address, for pal_print_raw() and the UART tests.
+ * Characters go out as soon as they are written, so the transmit FIFO is
+ * always empty: the TX interrupt is raised again by every write to UARTDR
+ * and only UARTICR takes it down.
+ */
+#define HS_UART_DR            0x00
+#define HS_UART_FR            0x18
+#define HS_UART_IMSC          0x38
+#define HS_UART_RIS           0x3C
+#define HS_UART_MIS           0x40
+#define HS_UART_ICR           0x44
+#define HS_UART_TXI           (1u << 5)
+
+extern const PLATFORM_OVERRIDE_UART_INFO_TABLE platform_uart_cfg;
+
+static uint32_t g_uart_reg[0x1000 / 4];
+static uint32_t g_uart_ris = HS_UART_TXI;
+static pthread_mutex_t g_uart_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Called with g_uart_lock held */
+static void
+uart_update_locked(void)
+{
+  uint32_t mis = g_uart_ris & g_uart_reg[HS_UART_IMSC / 4];
+
+  if (platform_uart_cfg.GlobalSystemInterrupt)
+      hs_gic_set_level(NULL, platform_uart_cfg.GlobalSystemInterrupt, mis != 0);
+}
+
+static uint64_t
+uart_read(void *ctx, uint64_t offset, uint32_t width)
+{
+  uint64_t value;
+
+  (void)ctx;
+  (void)width;
+
+  switch (offset) {
+  case HS_UART_FR:                    /* TX FIFO empty, RX FIFO empty */
+      return 0x90;
+  case HS_UART_RIS:
+      return g_uart_ris;
+  case HS_UART_MIS:
+      pthread_mutex_lock(&g_uart_lock);
+      value = g_uart_ris & g_uart_reg[HS_UART_IMSC / 4];
+      pthread_mutex_unlock(&g_uart_lock);
+      return value;
+  case 0xFE0:                         /* UARTPeriphID0..3 */
+      return 0x11;
+  case 0xFE4:
+      return 0x10;
+  case 0xFE8:
+      return 0x34;
+  case 0xFEC:
+      return 0x00;
+  default:
+      return g_uart_reg[(offset & 0xFFF) / 4];
+  }
+}
+
+static void
+uart_write(void *ctx, uint64_t offset, uint64_t value, uint32_t width)
+{
+  (void)ctx;
+  (void)width;
+
+  switch (offset) {
+  case HS_UART_DR:
+      pal_uart_putc((char)value);
+      pthread_mutex_lock(&g_uart_lock);
+      g_uart_ris |= HS_UART_TXI;
+      uart_update_locked();
+      pthread_mutex_unlock(&g_uart_lock);
+      return;
+  case HS_UART_FR:                    /* read-only */
+  case HS_UART_RIS:
+  case HS_UART_MIS:
+      return;
+  case HS_UART_ICR:
+      pthread_mutex_lock(&g_uart_lock);
+      g_uart_ris &= ~(uint32_t)value;
+      uart_update_locked();
+      pthread_mutex_unlock(&g_uart_lock);
+      return;
+  case HS_UART_IMSC:
+      pthread_mutex_lock(&g_uart_lock);
+      g_uart_reg[HS_UART_IMSC / 4] = (uint32_t)value;
+      uart_update_locked();
+      pthread_mutex_unlock(&g_uart_lock);
+      return;
+  default:
+      g_uart_reg[(offset & 0xFFF) / 4] = (uint32_t)value;
+  }
+}
+
+/* Function symbols of the executable, to unwind to exception return labels */
+
+typedef struct {
+  uint64_t    start;
+  uint64_t    size;
+  const char *name;
+} HS_SYMBOL;
+
+static HS_SYMBOL *g_symbol;
+static uint32_t   g_symbol_count;
+
+static int
+symbol_cmp(const void *a, const void *b)
+{
+  const HS_SYMBOL *x = a, *y = b;
+
+  return (x->start > y->start) - (x->start < y->start);
+}
+
+void
+hs_symbols_load(void)
+{
+  struct stat st;
+  Elf64_Ehdr *eh;
+  Elf64_Shdr *sh;
+  uint8_t *image;
+  uint32_t i, j;
+  int fd;
+
+  fd = open("/proc/self/exe", O_RDONLY);
+  if (fd < 0 || fstat(fd, &st) < 0)
+      hs_fatal("cannot read /proc/self/exe");
+  image = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (image == MAP_FAILED)
+      hs_fatal("cannot map /proc/self/exe");
+
+  eh = (Elf64_Ehdr *)image;
+  sh = (Elf64_Shdr *)(image + eh->e_shoff);
+  for (i = 0; i < eh->e_shnum; i++) {
+      Elf64_Sym *sym;
+      const char *str;
+      uint32_t count;
+
+      if (sh[i].sh_type != SHT_SYMTAB)
+          continue;
+
+      sym = (Elf64_Sym *)(image + sh[i].sh_offset);
+      str = (const char *)(image + sh[sh[i].sh_link].sh_offset);
+      count = sh[i].sh_size / sizeof(Elf64_Sym);
+      g_symbol = calloc(count, sizeof(HS_SYMBOL));
+      for (j = 0; j < count; j++) {
+          if (ELF64_ST_TYPE(sym[j].st_info) != STT_FUNC || sym[j].st_value == 0)
+              continue;
+          g_symbol[g_symbol_count].start = sym[j].st_value;
+          g_symbol[g_symbol_count].size = sym[j].st_size;
+          g_symbol[g_symbol_count].name = str + sym[j].st_name;
+          g_symbol_count++;
+      }
+      break;
+  }
+
+  if (g_symbol_count == 0)
+      hs_fatal("the executable has no symbol table; do not strip it");
+  qsort(g_symbol, g_symbol_count, sizeof(HS_SYMBOL), symbol_cmp);
+}
+
+uint64_t
+hs_symbol_function(uint64_t addr, const char **name)
+{
+  uint32_t lo = 0, hi = g_symbol_count;
+
+  while (lo < hi) {
+      uint32_t mid = (lo + hi) / 2;
+
+      if (g_symbol[mid].start <= addr)
+          lo = mid + 1;
+      else
+          hi = mid;
+  }
+  if (lo == 0 || addr - g_symbol[lo - 1].start >= g_symbol[lo - 1].size)
+      return 0;
+  if (name)
+      *name = g_symbol[lo - 1].name;
+  return g_symbol[lo - 1].start;
+}
+
+void
+hs_mem_init(void)
+{
+  uint32_t i;
+  void *p;
+
+  /* Shared region and heap of the PAL */
+  p = mmap((void *)PLATFORM_MEMORY_POOL_BASE, PLATFORM_MEMORY_POOL_SIZE,
+           PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE | MAP_NORESERVE, -1, 0);
+  if (p != (void *)PLATFORM_MEMORY_POOL_BASE)
+      hs_fatal("cannot map the memory pool at 0x%lx",
+               (uint64_t)PLATFORM_MEMORY_POOL_BASE);
+
+  for (i = 0; i < platform_mem_cfg.count; i++) {
+      const MEMORY_INFO *m = &platform_mem_cfg.info[i];
+
+      if (m->type == MEMORY_TYPE_NORMAL || m->type == MEMORY_TYPE_DEVICE ||
+          m->type == MEMORY_TYPE_PERSISTENT)
+          window_add(m->phy_addr, m->size);
+  }
+
+  hs_region_add("uart", PLATFORM_UART_BASE, 0x1000, NULL, uart_read, uart_write);
+}
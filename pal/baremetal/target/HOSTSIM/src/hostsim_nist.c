@@ -0,0 +1,149 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * NIST support of the HOSTSIM platform: the PAL random number source and the
+ * STS special functions of the in-memory NIST pipeline of VAL.
+ *
+ * Random numbers come from the host getrandom(). The NIST build takes the
+ * special functions from cephes.c of the STS sources, which are fetched at
+ * build time and are not part of the tree. These stand-ins follow the same
+ * Cephes algorithms on top of the host libm and the erf() of VAL. The
+ * bit-exact check of the word-parallel kernels does not depend on them: the
+ * kernels and the bit-serial reference feed the same statistics through the
+ * same functions.
+ */
+
+#include <math.h>
+#include <sys/random.h>
+
+#include "hostsim.h"
+#include "pal_common_support.h"
+
+#define HS_MACHEP   1.11022302462515654042E-16
+#define HS_MAXLOG   7.09782712893383996843E2
+#define HS_BIG      4.503599627370496e15
+#define HS_BIGINV   2.22044604925031308085e-16
+
+double cephes_igamc(double a, double x);
+double cephes_normal(double x);
+
+uint32_t
+pal_nist_generate_rng(uint32_t *rng_buffer)
+{
+  if (getrandom(rng_buffer, sizeof(*rng_buffer), 0) != sizeof(*rng_buffer))
+      return PAL_STATUS_ERROR;
+
+  return PAL_STATUS_SUCCESS;
+}
+
+/* Lower regularized incomplete gamma function, power series */
+static double
+hs_igam(double a, double x)
+{
+  double ans, ax, c, r;
+
+  if ((x <= 0) || (a <= 0))
+      return 0.0;
+
+  if ((x > 1.0) && (x > a))
+      return 1.0 - cephes_igamc(a, x);
+
+  ax = a * log(x) - x - lgamma(a);
+  if (ax < -HS_MAXLOG)
+      return 0.0;
+  ax = exp(ax);
+
+  r = a;
+  c = 1.0;
+  ans = 1.0;
+  do {
+      r += 1.0;
+      c *= x / r;
+      ans += c;
+  } while (c / ans > HS_MACHEP);
+
+  return ans * ax / a;
+}
+
+/* Upper regularized incomplete gamma function, continued fraction */
+double
+cephes_igamc(double a, double x)
+{
+  double ans, ax, c, r, t, y, z, yc;
+  double pk, pkm1, pkm2, qk, qkm1, qkm2;
+
+  if ((x <= 0) || (a <= 0))
+      return 1.0;
+
+  if ((x < 1.0) || (x < a))
+      return 1.0 - hs_igam(a, x);
+
+  ax = a * log(x) - x - lgamma(a);
+  if (ax < -HS_MAXLOG)
+      return 0.0;
+  ax = exp(ax);
+
+  y = 1.0 - a;
+  z = x + y + 1.0;
+  c = 0.0;
+  pkm2 = 1.0;
+  qkm2 = x;
+  pkm1 = x + 1.0;
+  qkm1 = z * x;
+  ans = pkm1 / qkm1;
+
+  do {
+      c += 1.0;
+      y += 1.0;
+      z += 2.0;
+      yc = y * c;
+      pk = pkm1 * z - pkm2 * yc;
+      qk = qkm1 * z - qkm2 * yc;
+      if (qk != 0) {
+          r = pk / qk;
+          t = fabs((ans - r) / r);
+          ans = r;
+      } else {
+          t = 1.0;
+      }
+      pkm2 = pkm1;
+      pkm1 = pk;
+      qkm2 = qkm1;
+      qkm1 = qk;
+      if (fabs(pk) > HS_BIG) {
+          pkm2 *= HS_BIGINV;
+          pkm1 *= HS_BIGINV;
+          qkm2 *= HS_BIGINV;
+          qkm1 *= HS_BIGINV;
+      }
+  } while (t > HS_MACHEP);
+
+  return ans * ax;
+}
+
+/* Standard normal distribution function */
+double
+cephes_normal(double x)
+{
+  double sqrt2 = 1.414213562373095048801688724209698078569672;
+
+  if (x > 0)
+      return 0.5 * (1 + erf(x / sqrt2));
+
+  return 0.5 * (1 - erf(-x / sqrt2));
+}
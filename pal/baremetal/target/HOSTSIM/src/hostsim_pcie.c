@@ -0,0 +1,424 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * PCIe model of the HOSTSIM platform.
+ *
+ * The configuration space of every function is served through the first
+ * ECAM of the platform description. The hierarchy is read from the
+ * -topology file, or built from platform_pcie_device_hierarchy when no file
+ * is given. Functions are placed at the bus numbers that the depth-first
+ * enumeration of the PAL assigns, as in the platform hierarchy table.
+ *
+ * Topology file, one function per line, '#' starts a comment:
+ *
+ *   <bus>:<dev>.<func> <vendor>:<device> <class_rev> [barN=<size>[:64][:pref] ...]
+ *
+ *   00:01.0 13b5:0def 06040000
+ *   01:00.0 13b5:ff80 ed000000 bar0=64K:64:pref bar2=16K
+ *
+ * Class 0604 functions are bridges (type 1 header), anything else is a type 0
+ * function. Each function has a PM capability, a PCI Express capability whose
+ * port type follows its place in the hierarchy, and bridges have an ACS
+ * extended capability. BAR memory is ordinary RAM mapped on first access.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "hostsim.h"
+#include "pal_common_support.h"
+#include "platform_override_struct.h"
+#include "platform_override_fvp.h"
+
+extern const PCIE_INFO_TABLE platform_pcie_cfg;
+extern const PCIE_READ_TABLE platform_pcie_device_hierarchy;
+
+#define HS_PCIE_MAX_FN        256
+#define HS_CFG_SIZE           0x1000
+#define HS_PCIE_EP_DEVICE_ID  0xFF80     /* exerciser slots of the default topology */
+
+#define CAP_PM                0x40
+#define CAP_PCIE              0x60
+#define ECAP_ACS              0x100
+
+/* PCI Express capability device/port types */
+#define PORT_EP               0x0
+#define PORT_RP               0x4
+#define PORT_USP              0x5
+#define PORT_DSP              0x6
+#define PORT_RCIEP            0x9
+
+typedef struct {
+  uint32_t bus, dev, func;
+  uint32_t bridge;
+  uint64_t bar_size[6];               /* 0: not implemented */
+  uint32_t bar_flags[6];              /* BAR bits [3:0] */
+  uint8_t  cfg[HS_CFG_SIZE];
+  uint8_t  wmask[HS_CFG_SIZE];
+  uint8_t  w1c[HS_CFG_SIZE];
+} HS_PCIE_FN;
+
+static HS_PCIE_FN      *g_fn[HS_PCIE_MAX_FN];
+static uint32_t         g_fn_count;
+static HS_PCIE_FN      *g_fn_map[256][32][8];
+static uint64_t         g_ecam_base;
+static uint32_t         g_ecam_start_bus;
+static pthread_mutex_t  g_pcie_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+put(uint8_t *a, uint32_t off, uint64_t value, uint32_t width)
+{
+  uint32_t i;
+
+  for (i = 0; i < width; i++)
+      a[off + i] = value >> (8 * i);
+}
+
+static uint64_t
+get(const uint8_t *a, uint32_t off, uint32_t width)
+{
+  uint64_t value = 0;
+  uint32_t i;
+
+  for (i = 0; i < width; i++)
+      value |= (uint64_t)a[off + i] << (8 * i);
+  return value;
+}
+
+/* Bridge whose secondary bus is the bus of fn, NULL on the root bus */
+static HS_PCIE_FN *
+parent_of(const HS_PCIE_FN *fn)
+{
+  uint32_t i;
+
+  for (i = 0; i < g_fn_count; i++) {
+      if (g_fn[i]->bridge && g_fn[i]->cfg[0x19] == fn->bus && fn->bus != 0)
+          return g_fn[i];
+  }
+  return NULL;
+}
+
+static uint32_t
+port_type(const HS_PCIE_FN *fn)
+{
+  const HS_PCIE_FN *parent;
+
+  if (!fn->bridge)
+      return fn->bus == g_ecam_start_bus ? PORT_RCIEP : PORT_EP;
+  if (fn->bus == g_ecam_start_bus)
+      return PORT_RP;
+  parent = parent_of(fn);
+  if (parent && port_type(parent) == PORT_RP)
+      return PORT_USP;
+  return PORT_DSP;
+}
+
+/* Fields of the PCI Express capability that depend on the hierarchy */
+static void
+refresh_pcie_cap(HS_PCIE_FN *fn)
+{
+  uint32_t type = port_type(fn);
+  uint32_t downstream = (type == PORT_RP || type == PORT_DSP);
+
+  put(fn->cfg, CAP_PCIE + 0x02, 0x2 | (type << 4) | (downstream ? 1u << 8 : 0), 2);
+  /* Link capabilities: 16 GT/s x4, DLL Link Active reporting on downstream ports */
+  put(fn->cfg, CAP_PCIE + 0x0C, 0x4 | (4u << 4) | (downstream ? 1u << 20 : 0) |
+      (fn->dev << 24), 4);
+  put(fn->cfg, CAP_PCIE + 0x12, 0x4 | (4u << 4) | (downstream ? 1u << 13 : 0), 2);
+  /* Device capabilities 2: completion timeout ranges, ARI forwarding on downstream ports */
+  put(fn->cfg, CAP_PCIE + 0x24, 0xF | (1u << 4) | (downstream ? 1u << 5 : 0), 4);
+}
+
+static HS_PCIE_FN *
+fn_create(uint32_t bus, uint32_t dev, uint32_t func, uint32_t vendor, uint32_t device,
+          uint32_t class_rev)
+{
+  HS_PCIE_FN *fn;
+  uint32_t i;
+
+  if (bus > 255 || dev > 31 || func > 7)
+      hs_fatal("PCIe function %x:%x.%x out of range", bus, dev, func);
+  if (g_fn_map[bus][dev][func])
+      hs_fatal("PCIe function %x:%x.%x defined twice", bus, dev, func);
+  if (g_fn_count == HS_PCIE_MAX_FN)
+      hs_fatal("too many PCIe functions");
+
+  fn = calloc(1, sizeof(*fn));
+  fn->bus = bus;
+  fn->dev = dev;
+  fn->func = func;
+  fn->bridge = (class_rev >> 16) == 0x0604;
+
+  put(fn->cfg, 0x00, vendor | (device << 16), 4);
+  put(fn->cfg, 0x08, class_rev, 4);
+  put(fn->cfg, 0x06, 1u << 4, 2);                 /* Capabilities List */
+  put(fn->wmask, 0x04, 0x0547, 2);                /* Command */
+  put(fn->w1c, 0x06, 0xF900, 2);                  /* Status */
+  fn->wmask[0x0C] = 0xFF;                         /* Cache Line Size */
+  fn->cfg[0x0E] = fn->bridge ? 0x01 : 0x00;
+  fn->cfg[0x34] = CAP_PM;
+  fn->wmask[0x3C] = 0xFF;                         /* Interrupt Line */
+
+  if (fn->bridge) {
+      put(fn->wmask, 0x18, 0x00FFFFFF, 4);        /* bus numbers */
+      put(fn->w1c, 0x1E, 0xF900, 2);              /* Secondary Status */
+      put(fn->wmask, 0x20, 0xFFF0FFF0, 4);        /* memory base/limit */
+      put(fn->cfg, 0x24, 0x00010001, 4);          /* 64-bit prefetchable base/limit */
+      put(fn->wmask, 0x24, 0xFFF0FFF0, 4);
+      put(fn->wmask, 0x28, 0xFFFFFFFFFFFFFFFFULL, 8);
+      put(fn->wmask, 0x3E, 0x005F, 2);            /* Bridge Control */
+  }
+
+  /* Power Management, version 3 */
+  fn->cfg[CAP_PM] = 0x01;
+  fn->cfg[CAP_PM + 1] = CAP_PCIE;
+  put(fn->cfg, CAP_PM + 2, 0x0003, 2);
+  put(fn->wmask, CAP_PM + 4, 0x8103, 2);
+
+  /* PCI Express, version 2 */
+  fn->cfg[CAP_PCIE] = 0x10;
+  put(fn->cfg, CAP_PCIE + 0x04, (1u << 15) | 0x2 | (fn->bridge ? 0 : 1u << 28), 4);
+  put(fn->cfg, CAP_PCIE + 0x08, 0x2810, 2);
+  put(fn->wmask, CAP_PCIE + 0x08, 0xFFFF, 2);
+  put(fn->w1c, CAP_PCIE + 0x0A, 0x000F, 2);
+  put(fn->wmask, CAP_PCIE + 0x10, 0x0FFF, 2);     /* Link Control */
+  put(fn->wmask, CAP_PCIE + 0x18, 0xFFFF, 2);     /* Slot Control */
+  put(fn->w1c, CAP_PCIE + 0x1A, 0x011F, 2);
+  put(fn->wmask, CAP_PCIE + 0x1C, 0x001F, 2);     /* Root Control */
+  put(fn->w1c, CAP_PCIE + 0x20, 0x00010000, 4);   /* Root Status */
+  put(fn->wmask, CAP_PCIE + 0x28, 0xFFFF, 2);     /* Device Control 2 */
+  put(fn->cfg, CAP_PCIE + 0x2C, 0x1E, 4);         /* Link Capabilities 2: 2.5-16 GT/s */
+  put(fn->wmask, CAP_PCIE + 0x30, 0xFFFF, 2);     /* Link Control 2 */
+
+  /* ACS on switch and root ports: SV, TB, RR, CR, UF */
+  if (fn->bridge) {
+      put(fn->cfg, ECAP_ACS, 0x000D | (1u << 16), 4);
+      put(fn->cfg, ECAP_ACS + 4, 0x001F, 2);
+      put(fn->wmask, ECAP_ACS + 6, 0x001F, 2);
+  }
+
+  for (i = 0; i < 6; i++)
+      fn->bar_size[i] = 0;
+
+  g_fn_map[bus][dev][func] = fn;
+  g_fn[g_fn_count++] = fn;
+  refresh_pcie_cap(fn);
+  return fn;
+}
+
+static void
+fn_add_bar(HS_PCIE_FN *fn, uint32_t bar, uint64_t size, uint32_t is64, uint32_t pref)
+{
+  uint32_t flags = (is64 ? 0x4 : 0) | (pref ? 0x8 : 0);
+  uint64_t mask;
+
+  if (bar > (fn->bridge ? 1u : 5u) || (is64 && bar == (fn->bridge ? 1u : 5u)) ||
+      size < 16 || (size & (size - 1)))
+      hs_fatal("invalid BAR%u of %x:%x.%x", bar, fn->bus, fn->dev, fn->func);
+
+  mask = ~(size - 1);
+  fn->bar_size[bar] = size;
+  fn->bar_flags[bar] = flags;
+  put(fn->cfg, 0x10 + 4 * bar, flags, 4);
+  put(fn->wmask, 0x10 + 4 * bar, mask & 0xFFFFFFF0, 4);
+  if (is64)
+      put(fn->wmask, 0x14 + 4 * bar, mask >> 32, 4);
+}
+
+/* Functions with a function 1-7 sibling report a multi-function header */
+static void
+mark_multifunction(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < g_fn_count; i++) {
+      if (g_fn[i]->func != 0 && g_fn_map[g_fn[i]->bus][g_fn[i]->dev][0])
+          g_fn_map[g_fn[i]->bus][g_fn[i]->dev][0]->cfg[0x0E] |= 0x80;
+  }
+}
+
+static uint64_t
+parse_size(const char *s)
+{
+  char *end;
+  uint64_t v = strtoull(s, &end, 0);
+
+  switch (toupper((unsigned char)*end)) {
+  case 'K': v <<= 10; break;
+  case 'M': v <<= 20; break;
+  case 'G': v <<= 30; break;
+  default: break;
+  }
+  return v;
+}
+
+static void
+load_topology(const char *path)
+{
+  FILE *f = fopen(path, "r");
+  char line[512], *tok, *save, *p;
+  uint32_t bus, dev, func, vendor, device, class_rev, bar, lineno = 0;
+  HS_PCIE_FN *fn;
+
+  if (f == NULL)
+      hs_fatal("cannot open topology file %s", path);
+
+  while (fgets(line, sizeof(line), f)) {
+      lineno++;
+      if ((p = strchr(line, '#')))
+          *p = 0;
+      tok = strtok_r(line, " \t\r\n", &save);
+      if (tok == NULL)
+          continue;
+      if (sscanf(tok, "%x:%x.%x", &bus, &dev, &func) != 3)
+          hs_fatal("%s:%u: expected <bus>:<dev>.<func>", path, lineno);
+      tok = strtok_r(NULL, " \t\r\n", &save);
+      if (tok == NULL || sscanf(tok, "%x:%x", &vendor, &device) != 2)
+          hs_fatal("%s:%u: expected <vendor>:<device>", path, lineno);
+      tok = strtok_r(NULL, " \t\r\n", &save);
+      if (tok == NULL || sscanf(tok, "%x", &class_rev) != 1)
+          hs_fatal("%s:%u: expected <class_rev>", path, lineno);
+
+      fn = fn_create(bus, dev, func, vendor, device, class_rev);
+      while ((tok = strtok_r(NULL, " \t\r\n", &save))) {
+          if (sscanf(tok, "bar%u=", &bar) != 1 || !(p = strchr(tok, '=')))
+              hs_fatal("%s:%u: unknown attribute %s", path, lineno, tok);
+          fn_add_bar(fn, bar, parse_size(p + 1), strstr(p, ":64") != NULL,
+                     strstr(p, ":pref") != NULL);
+      }
+  }
+  fclose(f);
+}
+
+/*
+ * Platform hierarchy table: endpoints get a 64-bit prefetchable and a 32-bit
+ * BAR. Exerciser cards are not modelled, so they are presented with another
+ * device ID and the exerciser rules skip instead of polling a plain BAR.
+ */
+static void
+load_platform_hierarchy(void)
+{
+  const PCIE_READ_BLOCK *d;
+  HS_PCIE_FN *fn;
+  uint32_t i, device;
+
+  for (i = 0; i < platform_pcie_device_hierarchy.num_entries; i++) {
+      d = &platform_pcie_device_hierarchy.device[i];
+      device = d->device_id;
+      if ((d->vendor_id | (device << 16)) == EXERCISER_ID)
+          device = HS_PCIE_EP_DEVICE_ID;
+      fn = fn_create(d->bus, d->dev, d->func, d->vendor_id, device,
+                     (uint32_t)d->class_code);
+      if (!fn->bridge) {
+          fn_add_bar(fn, 0, 0x10000, 1, 1);
+          fn_add_bar(fn, 2, 0x4000, 0, 0);
+      }
+  }
+}
+
+static uint64_t
+ecam_read(void *ctx, uint64_t off, uint32_t width)
+{
+  uint32_t bus = g_ecam_start_bus + (off >> 20), reg = off & 0xFFF;
+  HS_PCIE_FN *fn;
+  uint64_t value;
+
+  (void)ctx;
+  fn = (bus < 256) ? g_fn_map[bus][(off >> 15) & 0x1F][(off >> 12) & 7] : NULL;
+  if (fn == NULL)
+      return width == 8 ? ~0ULL : ((1ULL << (8 * width)) - 1);
+
+  pthread_mutex_lock(&g_pcie_lock);
+  if (reg >= CAP_PCIE && reg < CAP_PCIE + 0x34)
+      refresh_pcie_cap(fn);
+  value = get(fn->cfg, reg, (reg + width <= HS_CFG_SIZE) ? width : HS_CFG_SIZE - reg);
+  pthread_mutex_unlock(&g_pcie_lock);
+
+  return value;
+}
+
+static void
+ecam_write(void *ctx, uint64_t off, uint64_t value, uint32_t width)
+{
+  uint32_t bus = g_ecam_start_bus + (off >> 20), reg = off & 0xFFF, i;
+  HS_PCIE_FN *fn;
+  uint8_t b;
+
+  (void)ctx;
+  fn = (bus < 256) ? g_fn_map[bus][(off >> 15) & 0x1F][(off >> 12) & 7] : NULL;
+  if (fn == NULL || reg + width > HS_CFG_SIZE)
+      return;
+
+  pthread_mutex_lock(&g_pcie_lock);
+  for (i = 0; i < width; i++) {
+      b = value >> (8 * i);
+      fn->cfg[reg + i] = (fn->cfg[reg + i] & ~fn->wmask[reg + i]) | (b & fn->wmask[reg + i]);
+      fn->cfg[reg + i] &= ~(b & fn->w1c[reg + i]);
+  }
+  pthread_mutex_unlock(&g_pcie_lock);
+}
+
+int
+hs_pcie_bar_contains(uint64_t addr)
+{
+  const HS_PCIE_FN *fn;
+  uint64_t base;
+  uint32_t i, bar;
+
+  for (i = 0; i < g_fn_count; i++) {
+      fn = g_fn[i];
+      for (bar = 0; bar < 6; bar++) {
+          if (fn->bar_size[bar] == 0)
+              continue;
+          base = get(fn->cfg, 0x10 + 4 * bar, 4) & ~0xFULL;
+          if (fn->bar_flags[bar] & 0x4)
+              base |= get(fn->cfg, 0x14 + 4 * bar, 4) << 32;
+          if (base != 0 && addr >= base && addr - base < fn->bar_size[bar])
+              return 1;
+      }
+  }
+  return 0;
+}
+
+void
+hs_pcie_init(void)
+{
+  const PCIE_INFO_BLOCK *ecam;
+
+  if (platform_pcie_cfg.num_entries == 0)
+      return;
+
+  /* A single ECAM (segment) is modelled */
+  ecam = &platform_pcie_cfg.block[0];
+  g_ecam_base = ecam->ecam_base;
+  g_ecam_start_bus = ecam->start_bus_num;
+
+  if (g_hs_config.topology)
+      load_topology(g_hs_config.topology);
+  else
+      load_platform_hierarchy();
+  mark_multifunction();
+
+  hs_region_add("ecam", g_ecam_base,
+                (uint64_t)(ecam->end_bus_num - ecam->start_bus_num + 1) << 20, NULL,
+                ecam_read, ecam_write);
+  hs_trace("%u PCIe functions behind ECAM 0x%llx", g_fn_count,
+           (unsigned long long)g_ecam_base);
+}
@@ -0,0 +1,788 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * Simulated PEs of the HOSTSIM platform.
+ *
+ * Each PE is a host thread; the primary PE is the main thread. This file
+ * holds the per-PE system register file, the PSCI firmware reached through
+ * ArmCallSmc(), the system instructions (WFI, WFE, SEV, barriers) and the
+ * exception entry:
+ *
+ *  - IRQ: the GIC model kicks the target PE with SIGUSR1. The signal handler
+ *    runs common_exception_handler(IRQ) on the interrupted stack, as the
+ *    vector table would. A kick that arrives while the PE is inside the
+ *    model is deferred to hs_model_exit().
+ *  - Synchronous external abort: a host SIGSEGV/SIGBUS on an address that is
+ *    not simulated RAM is reported as a data abort with ESR/FAR set. When the
+ *    handler moved ELR to a label, execution resumes at that label on the
+ *    frame of the function that owns it.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <signal.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "hostsim.h"
+#include "pal_common_support.h"
+#include "pal_sysreg.h"
+#include "val/include/acs_std_smc.h"
+
+extern const PE_INFO_TABLE platform_pe_cfg;
+extern uint64_t g_primary_mpidr;
+extern uint32_t common_exception_handler(uint32_t exception_type);
+extern void ModuleEntryPoint(void);
+
+HS_PE g_hs_pe[HS_MAX_PE];
+__thread HS_PE *hs_self;
+
+/* MPIDR_EL1 bit 31 is RES1 and the platform PEs are multi-threaded (MT) */
+#define HS_MPIDR_FIXED        0x81000000ULL
+#define HS_MPIDR_AFF_MASK     0xFF00FFFFFFULL
+
+#define HS_PE_STACK_SIZE      (8 * 1024 * 1024)
+#define HS_WAIT_NS            200000     /* upper bound for a WFI/WFE sleep */
+
+/*
+ * System register file. Every register has a slot in HS_PE.sysreg; a
+ * register with model behaviour also has read and/or write hooks. The
+ * accessors pass the register name as a string literal, so lookups are
+ * cached by the address of that literal.
+ */
+typedef struct {
+  char               name[32];
+  uint64_t           reset;
+  hs_sysreg_read_fn  read;
+  hs_sysreg_write_fn write;
+} HS_SYSREG;
+
+#define HS_SYSREG_CACHE       4096
+
+static HS_SYSREG          g_sysreg[HS_MAX_SYSREG];
+static uint32_t           g_sysreg_count;
+static pthread_mutex_t    g_sysreg_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct {
+  const char * volatile key;
+  uint32_t              slot;
+} g_sysreg_cache[HS_SYSREG_CACHE];
+
+static uint32_t g_slot_daif;
+static uint32_t g_slot_csselr;
+
+/* WFE event stream shared by all PEs */
+static volatile uint32_t g_hs_event;
+
+static long
+futex_wait(volatile uint32_t *addr, uint32_t val, long ns)
+{
+  struct timespec ts = { 0, ns };
+
+  return syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, &ts, NULL, 0);
+}
+
+static void
+futex_wake(volatile uint32_t *addr)
+{
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 0x7fffffff, NULL, NULL, 0);
+}
+
+/* Called with g_sysreg_lock held */
+static uint32_t
+sysreg_find_locked(const char *name, int create)
+{
+  uint32_t i;
+
+  for (i = 0; i < g_sysreg_count; i++) {
+      if (strcasecmp(g_sysreg[i].name, name) == 0)
+          return i;
+  }
+  if (!create)
+      return HS_MAX_SYSREG;
+  if (g_sysreg_count == HS_MAX_SYSREG || strlen(name) >= sizeof(g_sysreg[0].name))
+      hs_fatal("cannot model system register %s", name);
+
+  i = g_sysreg_count;
+  strcpy(g_sysreg[i].name, name);
+  __atomic_store_n(&g_sysreg_count, i + 1, __ATOMIC_RELEASE);
+  return i;
+}
+
+uint32_t
+hs_sysreg_define(const char *name, uint64_t reset,
+                 hs_sysreg_read_fn read, hs_sysreg_write_fn write)
+{
+  uint32_t slot, i;
+
+  pthread_mutex_lock(&g_sysreg_lock);
+  slot = sysreg_find_locked(name, 1);
+  g_sysreg[slot].reset = reset;
+  g_sysreg[slot].read = read;
+  g_sysreg[slot].write = write;
+  for (i = 0; i < HS_MAX_PE; i++)
+      g_hs_pe[i].sysreg[slot] = reset;
+  pthread_mutex_unlock(&g_sysreg_lock);
+
+  return slot;
+}
+
+static uint32_t
+sysreg_slot(const char *name)
+{
+  uint32_t h = ((uintptr_t)name >> 3) & (HS_SYSREG_CACHE - 1);
+  uint32_t slot;
+
+  while (1) {
+      const char *key = __atomic_load_n(&g_sysreg_cache[h].key, __ATOMIC_ACQUIRE);
+
+      if (key == name)
+          return g_sysreg_cache[h].slot;
+      if (key == NULL)
+          break;
+      h = (h + 1) & (HS_SYSREG_CACHE - 1);
+  }
+
+  /* First access through this literal: resolve it by name */
+  pthread_mutex_lock(&g_sysreg_lock);
+  slot = sysreg_find_locked(name, 1);
+  h = ((uintptr_t)name >> 3) & (HS_SYSREG_CACHE - 1);
+  while (g_sysreg_cache[h].key != NULL && g_sysreg_cache[h].key != name)
+      h = (h + 1) & (HS_SYSREG_CACHE - 1);
+  g_sysreg_cache[h].slot = slot;
+  __atomic_store_n(&g_sysreg_cache[h].key, name, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&g_sysreg_lock);
+
+  return slot;
+}
+
+uint64_t
+hs_sysreg_get(HS_PE *pe, uint32_t slot)
+{
+  return pe->sysreg[slot];
+}
+
+void
+hs_sysreg_set(HS_PE *pe, uint32_t slot, uint64_t value)
+{
+  pe->sysreg[slot] = value;
+}
+
+static HS_PE *
+current_pe(const char *what)
+{
+  if (hs_self == NULL)
+      hs_fatal("%s from a thread that is not a simulated PE", what);
+  return hs_self;
+}
+
+u_register_t
+pal_hostsim_sysreg_read(const char *reg_name)
+{
+  HS_PE *pe = current_pe(reg_name);
+  uint32_t slot;
+  uint64_t value;
+
+  hs_model_enter(pe);
+  slot = sysreg_slot(reg_name);
+  if (g_sysreg[slot].read)
+      value = g_sysreg[slot].read(pe, slot);
+  else
+      value = pe->sysreg[slot];
+  hs_model_exit(pe);
+
+  return value;
+}
+
+void
+pal_hostsim_sysreg_write(const char *reg_name, u_register_t v)
+{
+  HS_PE *pe = current_pe(reg_name);
+  uint32_t slot;
+
+  hs_model_enter(pe);
+  slot = sysreg_slot(reg_name);
+  if (g_sysreg[slot].write)
+      g_sysreg[slot].write(pe, slot, v);
+  else
+      pe->sysreg[slot] = v;
+  hs_model_exit(pe);
+}
+
+/* Interrupt delivery */
+
+static void
+take_irq(HS_PE *pe)
+{
+  uint32_t budget = 64;
+
+  while (!(pe->sysreg[g_slot_daif] & HS_DAIF_I) && budget--) {
+      uint64_t daif = pe->sysreg[g_slot_daif];
+      uint32_t intid;
+
+      /* The GIC lock must not be held when a kick interrupts this PE */
+      pe->in_model++;
+      pe->irq_deferred = 0;
+      intid = hs_gic_irq_pending(pe);
+      pe->in_model--;
+      if (intid >= HS_MAX_INTR) {
+          if (pe->irq_deferred)
+              continue;
+          return;
+      }
+
+      pe->sysreg[g_slot_daif] = daif | HS_DAIF_I | HS_DAIF_F;
+      pe->exc_depth++;
+      common_exception_handler(HS_EXC_IRQ);
+      pe->exc_depth--;
+      pe->sysreg[g_slot_daif] = daif;
+  }
+}
+
+void
+hs_model_enter(HS_PE *pe)
+{
+  if (pe)
+      pe->in_model++;
+  __atomic_signal_fence(__ATOMIC_SEQ_CST);
+}
+
+void
+hs_model_exit(HS_PE *pe)
+{
+  __atomic_signal_fence(__ATOMIC_SEQ_CST);
+  if (pe == NULL || --pe->in_model != 0)
+      return;
+  if (pe->irq_deferred) {
+      pe->irq_deferred = 0;
+      take_irq(pe);
+  }
+}
+
+void
+hs_pe_kick(HS_PE *pe)
+{
+  __atomic_add_fetch(&pe->wake, 1, __ATOMIC_SEQ_CST);
+  futex_wake(&pe->wake);
+
+  if (pe == hs_self) {
+      pe->irq_deferred = 1;
+      return;
+  }
+  if (pe->state == HS_PE_ON)
+      pthread_kill(pe->thread, SIGUSR1);
+}
+
+static void
+irq_signal(int sig, siginfo_t *si, void *uc)
+{
+  HS_PE *pe = hs_self;
+  int saved_errno = errno;
+
+  (void)sig;
+  (void)si;
+  (void)uc;
+
+  if (pe != NULL) {
+      if (pe->in_model)
+          pe->irq_deferred = 1;
+      else
+          take_irq(pe);
+  }
+  errno = saved_errno;
+}
+
+/* Synchronous exceptions */
+
+static void
+resume_at(HS_PE *pe, ucontext_t *uc, uint64_t target)
+{
+  greg_t *gregs = uc->uc_mcontext.gregs;
+  const char *name = NULL;
+  uint64_t target_fn = hs_symbol_function(target, &name);
+  uint64_t rbp = gregs[REG_RBP];
+  uint64_t rsp = gregs[REG_RSP];
+  uint64_t fn = hs_symbol_function(gregs[REG_RIP], NULL);
+  uint64_t prev = 0;
+  uint32_t depth;
+
+  /*
+   * The label belongs to a function that is live on this stack (the test
+   * saved it with &&label before the access). Unwind the frame pointer chain
+   * to that function's frame and continue there with the stack pointer it
+   * had when it made the call.
+   */
+  for (depth = 0; target_fn && depth < 256; depth++) {
+      if (fn == target_fn) {
+          if (depth)
+              rsp = prev + 16;
+          gregs[REG_RIP] = target;
+          gregs[REG_RBP] = rbp;
+          gregs[REG_RSP] = rsp;
+          return;
+      }
+      if (rbp == 0 || (rbp & 7))
+          break;
+      prev = rbp;
+      fn = hs_symbol_function(((uint64_t *)rbp)[1] - 1, NULL);
+      rbp = ((uint64_t *)rbp)[0];
+  }
+
+  hs_fatal("exception return to 0x%lx (%s) is not in a frame of PE%u",
+           target, name ? name : "?", pe->index);
+}
+
+static void
+sync_signal(int sig, siginfo_t *si, void *ctx)
+{
+  ucontext_t *uc = ctx;
+  greg_t *gregs = uc->uc_mcontext.gregs;
+  HS_PE *pe = hs_self;
+  uint64_t addr = (uint64_t)si->si_addr;
+  uint64_t rip = gregs[REG_RIP];
+  uint64_t daif;
+  int saved_errno = errno;
+  const char *name = NULL;
+
+  if (pe == NULL || pe->in_model) {
+      hs_symbol_function(rip, &name);
+      hs_fatal("signal %d at %s+0x%lx accessing 0x%lx inside the model",
+               sig, name ? name : "?", rip - hs_symbol_function(rip, NULL), addr);
+  }
+
+  if (sig == SIGSEGV && (hs_mem_emulate(uc, addr) || hs_mem_lazy_map(addr))) {
+      errno = saved_errno;
+      return;
+  }
+
+  /* Data abort taken to the current EL, synchronous external abort */
+  pe->far = addr;
+  pe->esr = (0x25ULL << 26) | (1ULL << 25) | 0x10;
+  if (gregs[REG_ERR] & 2)
+      pe->esr |= (1ULL << 6);
+  pe->elr = rip;
+
+  hs_trace("data abort at 0x%lx, FAR 0x%lx", rip, addr);
+
+  daif = pe->sysreg[g_slot_daif];
+  pe->sysreg[g_slot_daif] = daif | HS_DAIF_ALL;
+  pe->exc_depth++;
+  common_exception_handler(HS_EXC_SYNC);
+  pe->exc_depth--;
+  pe->sysreg[g_slot_daif] = daif;
+
+  /*
+   * The target PAL cannot move ELR from a handler (pal_pe_update_elr() is
+   * empty), so a handled abort on a plain access resumes after it.
+   */
+  if (pe->elr == rip) {
+      pe->elr = rip + hs_mem_insn_length(rip);
+      if (pe->elr == rip) {
+          hs_symbol_function(rip, &name);
+          hs_fatal("unhandled data abort at %s+0x%lx, FAR 0x%lx",
+                   name ? name : "?", rip - hs_symbol_function(rip, NULL), addr);
+      }
+  }
+
+  resume_at(pe, uc, pe->elr);
+  errno = saved_errno;
+}
+
+/* System instructions */
+
+static void
+wait_for_wake(HS_PE *pe, int any_event)
+{
+  uint32_t wake = __atomic_load_n(&pe->wake, __ATOMIC_ACQUIRE);
+  uint32_t event = g_hs_event;
+
+  hs_timer_update_pe(pe);
+  if (hs_gic_irq_pending(pe) < HS_MAX_INTR)
+      return;
+
+  if (any_event)
+      futex_wait(&g_hs_event, event, HS_WAIT_NS);
+  else
+      futex_wait(&pe->wake, wake, HS_WAIT_NS);
+}
+
+void
+pal_hostsim_sysop(const char *op)
+{
+  HS_PE *pe;
+
+  if (op[0] == 'd' && (op[1] == 's' || op[1] == 'm')) {
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      return;
+  }
+  if (op[0] == 'i' && op[1] == 's') {
+      __atomic_signal_fence(__ATOMIC_SEQ_CST);
+      return;
+  }
+
+  if (strcmp(op, "sev") == 0) {
+      __atomic_add_fetch(&g_hs_event, 1, __ATOMIC_SEQ_CST);
+      futex_wake(&g_hs_event);
+      return;
+  }
+
+  if (strcmp(op, "wfi") == 0 || strcmp(op, "wfe") == 0) {
+      pe = current_pe(op);
+      hs_model_enter(pe);
+      wait_for_wake(pe, op[2] == 'e');
+      pe->irq_deferred = 1;
+      hs_model_exit(pe);
+      if (op[2] == 'e')
+          sched_yield();
+      return;
+  }
+
+  /* TLB, cache and address translation maintenance have no effect here */
+}
+
+/* PSCI */
+
+HS_PE *
+hs_pe_by_mpidr(uint64_t mpidr)
+{
+  uint32_t i;
+
+  mpidr &= HS_MPIDR_AFF_MASK;
+  for (i = 0; i < g_hs_config.num_pe; i++) {
+      if ((g_hs_pe[i].mpidr & HS_MPIDR_AFF_MASK) == mpidr)
+          return &g_hs_pe[i];
+  }
+  return NULL;
+}
+
+static void
+pe_reset(HS_PE *pe)
+{
+  struct sched_param param = { 0 };
+
+  pe->sysreg[g_slot_daif] = HS_DAIF_ALL;
+  pe->exc_depth = 0;
+  pe->in_model = 0;
+  pe->irq_deferred = 0;
+
+  /*
+   * PEs spin while they wait for interrupts. As idle class threads they
+   * never delay the timer tick, whatever the number of host CPUs.
+   */
+  pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+}
+
+static void *
+pe_thread(void *arg)
+{
+  HS_PE *pe = arg;
+  sigset_t set;
+
+  hs_self = pe;
+  sigemptyset(&set);
+  sigaddset(&set, SIGUSR1);
+  pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+
+  pe_reset(pe);
+  __atomic_store_n(&pe->state, HS_PE_ON, __ATOMIC_RELEASE);
+  hs_trace("CPU_ON entry 0x%lx", pe->entry);
+
+  ((void (*)(uint64_t))pe->entry)(pe->context_id);
+
+  /* The payload returned instead of calling CPU_OFF */
+  __atomic_store_n(&pe->state, HS_PE_OFF, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+static int64_t
+psci_cpu_on(uint64_t mpidr, uint64_t entry, uint64_t context_id)
+{
+  HS_PE *pe = hs_pe_by_mpidr(mpidr);
+  pthread_attr_t attr;
+  uint32_t off = HS_PE_OFF;
+
+  if (pe == NULL)
+      return ARM_SMC_PSCI_RET_INVALID_PARAMS;
+  if (!__atomic_compare_exchange_n(&pe->state, &off, HS_PE_ON_PENDING, 0,
+                                   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+      return (off == HS_PE_ON) ? ARM_SMC_PSCI_RET_ALREADY_ON : ARM_SMC_PSCI_RET_ON_PENDING;
+
+  pe->entry = entry;
+  pe->context_id = context_id;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  pthread_attr_setstacksize(&attr, HS_PE_STACK_SIZE);
+  if (pthread_create(&pe->thread, &attr, pe_thread, pe) != 0) {
+      pe->state = HS_PE_OFF;
+      pthread_attr_destroy(&attr);
+      return ARM_SMC_PSCI_RET_INTERN_FAIL;
+  }
+  pthread_attr_destroy(&attr);
+
+  return ARM_SMC_PSCI_RET_SUCCESS;
+}
+
+static void
+psci_cpu_off(HS_PE *pe)
+{
+  hs_trace("CPU_OFF");
+  if (pe == &g_hs_pe[0])
+      hs_fatal("CPU_OFF on the primary PE");
+
+  __atomic_store_n(&pe->state, HS_PE_OFF, __ATOMIC_RELEASE);
+  pthread_exit(NULL);
+}
+
+static int64_t
+psci_features(uint64_t fid)
+{
+  switch (fid) {
+  case ARM_SMC_ID_PSCI_VERSION:
+  case ARM_SMC_ID_PSCI_CPU_SUSPEND_AARCH64:
+  case ARM_SMC_ID_PSCI_CPU_SUSPEND_AARCH32:
+  case ARM_SMC_ID_PSCI_CPU_OFF:
+  case ARM_SMC_ID_PSCI_CPU_ON_AARCH64:
+  case ARM_SMC_ID_PSCI_CPU_ON_AARCH32:
+  case ARM_SMC_ID_PSCI_AFFINITY_INFO_AARCH64:
+  case ARM_SMC_ID_PSCI_AFFINITY_INFO_AARCH32:
+  case ARM_SMC_ID_PSCI_SYSTEM_OFF:
+  case ARM_SMC_ID_PSCI_SYSTEM_RESET:
+  case ARM_SMC_ID_PSCI_FEATURES:
+      return ARM_SMC_PSCI_RET_SUCCESS;
+  default:
+      return ARM_SMC_PSCI_RET_NOT_SUPPORTED;
+  }
+}
+
+void
+ArmCallSmc(ARM_SMC_ARGS *args, int32_t conduit)
+{
+  HS_PE *pe = current_pe("SMC");
+  HS_PE *target;
+  int64_t ret;
+
+  (void)conduit;
+
+  switch ((uint32_t)args->Arg0) {
+  case ARM_SMC_ID_PSCI_CPU_OFF:
+      psci_cpu_off(pe);
+      return;
+
+  case ARM_SMC_ID_PSCI_SYSTEM_OFF:
+  case ARM_SMC_ID_PSCI_SYSTEM_RESET:
+      fflush(stdout);
+      exit(0);
+
+  case ARM_SMC_ID_PSCI_CPU_SUSPEND_AARCH64:
+  case ARM_SMC_ID_PSCI_CPU_SUSPEND_AARCH32:
+      /* Any suspend state returns on the next interrupt, masked or not */
+      hs_model_enter(pe);
+      wait_for_wake(pe, 0);
+      pe->irq_deferred = 1;
+      hs_model_exit(pe);
+      args->Arg0 = ARM_SMC_PSCI_RET_SUCCESS;
+      return;
+  }
+
+  hs_model_enter(pe);
+  switch ((uint32_t)args->Arg0) {
+  case ARM_SMC_ID_PSCI_VERSION:
+      ret = 0x10001;                  /* PSCI 1.1 */
+      break;
+  case ARM_SMC_ID_PSCI_SMCCC_VERSION:
+      ret = 0x10002;                  /* SMCCC 1.2 */
+      break;
+  case ARM_SMC_ID_PSCI_CPU_ON_AARCH64:
+  case ARM_SMC_ID_PSCI_CPU_ON_AARCH32:
+      ret = psci_cpu_on(args->Arg1, args->Arg2, args->Arg3);
+      break;
+  case ARM_SMC_ID_PSCI_AFFINITY_INFO_AARCH64:
+  case ARM_SMC_ID_PSCI_AFFINITY_INFO_AARCH32:
+      target = hs_pe_by_mpidr(args->Arg1);
+      if (target == NULL)
+          ret = ARM_SMC_PSCI_RET_INVALID_PARAMS;
+      else if (target->state == HS_PE_ON)
+          ret = 0;
+      else if (target->state == HS_PE_OFF)
+          ret = 1;
+      else
+          ret = 2;
+      break;
+  case ARM_SMC_ID_PSCI_FEATURES:
+      ret = psci_features(args->Arg1);
+      break;
+  default:
+      hs_trace("SMC 0x%lx not supported", args->Arg0);
+      ret = ARM_SMC_PSCI_RET_NOT_SUPPORTED;
+      break;
+  }
+  hs_model_exit(pe);
+
+  args->Arg0 = (uint64_t)ret;
+}
+
+void
+ModuleEntryPoint(void)
+{
+  extern void val_test_entry(void);
+
+  /* The MMU and caches need no setup on the host */
+  val_test_entry();
+}
+
+/* PE register hooks */
+
+static uint64_t
+mpidr_read(HS_PE *pe, uint32_t slot)
+{
+  (void)slot;
+  return pe->mpidr;
+}
+
+static void
+daif_write(HS_PE *pe, uint32_t slot, uint64_t value)
+{
+  pe->sysreg[slot] = value & HS_DAIF_ALL;
+  pe->irq_deferred = 1;
+}
+
+static void
+daifset_write(HS_PE *pe, uint32_t slot, uint64_t value)
+{
+  (void)slot;
+  pe->sysreg[g_slot_daif] |= (value & 0xF) << 6;
+}
+
+static void
+daifclr_write(HS_PE *pe, uint32_t slot, uint64_t value)
+{
+  (void)slot;
+  pe->sysreg[g_slot_daif] &= ~((value & 0xF) << 6);
+  pe->irq_deferred = 1;
+}
+
+static uint64_t
+isr_read(HS_PE *pe, uint32_t slot)
+{
+  (void)slot;
+  return (hs_gic_irq_pending(pe) < HS_MAX_INTR) ? (1u << 7) : 0;
+}
+
+static uint64_t
+ccsidr_read(HS_PE *pe, uint32_t slot)
+{
+  (void)slot;
+
+  /* 64-byte lines: 64KB 4-way L1 caches and a 1MB 8-way L2 */
+  switch (pe->sysreg[g_slot_csselr] & 0xF) {
+  case 0:
+  case 1:
+      return (255ULL << 13) | (3ULL << 3) | 2;
+  case 2:
+      return (2047ULL << 13) | (7ULL << 3) | 2;
+  default:
+      return 0;
+  }
+}
+
+/*
+ * ID registers of the simulated PE: an Armv9.0 PE similar to Neoverse N2,
+ * without SPE, the trace unit and the trace buffer, which are not modelled.
+ */
+static const struct {
+  const char *name;
+  uint64_t    reset;
+} g_pe_id_regs[] = {
+  { "midr_el1",             0x410FD490ULL },
+  { "revidr_el1",           0 },
+  { "id_aa64pfr0_el1",      0x1101111121111112ULL },
+  { "id_aa64pfr1_el1",      0x0000000000010021ULL },
+  { "id_aa64dfr0_el1",      0x00000F0010305608ULL },
+  { "id_aa64isar0_el1",     0x1221100110212120ULL },
+  { "id_aa64isar1_el1",     0x0010111101211012ULL },
+  { "id_aa64mmfr0_el1",     0x0000000000101125ULL },
+  { "id_aa64mmfr1_el1",     0x0000000010212122ULL },
+  { "id_aa64mmfr2_el1",     0x1221011100001011ULL },
+  { "id_aa64zfr0_el1",      0x0000100100110021ULL },
+  { "ctr_el0",              0x000000009444C004ULL },
+  { "clidr_el1",            0x000000000A000023ULL },
+  { "currentel",            0x8 },
+  { "pmcr_el0",             0x41003000ULL },
+};
+
+void
+hs_pe_init(void)
+{
+  struct sigaction sa;
+  uint32_t i;
+
+  g_hs_config.num_pe = platform_pe_cfg.header.num_of_pe;
+  if (g_hs_config.num_pe == 0 || g_hs_config.num_pe > HS_MAX_PE)
+      hs_fatal("platform describes %u PEs", g_hs_config.num_pe);
+
+  for (i = 0; i < g_hs_config.num_pe; i++) {
+      g_hs_pe[i].index = i;
+      g_hs_pe[i].mpidr = HS_MPIDR_FIXED | platform_pe_cfg.pe_info[i].mpidr;
+      g_hs_pe[i].state = HS_PE_OFF;
+  }
+
+  g_slot_daif = hs_sysreg_define("daif", HS_DAIF_ALL, NULL, daif_write);
+  g_slot_csselr = hs_sysreg_define("csselr_el1", 0, NULL, NULL);
+  hs_sysreg_define("daifset", 0, NULL, daifset_write);
+  hs_sysreg_define("daifclr", 0, NULL, daifclr_write);
+  hs_sysreg_define("mpidr_el1", 0, mpidr_read, NULL);
+  hs_sysreg_define("isr_el1", 0, isr_read, NULL);
+  hs_sysreg_define("ccsidr_el1", 0, ccsidr_read, NULL);
+  hs_sysreg_define("cntfrq_el0", g_hs_config.cntfrq, NULL, NULL);
+  for (i = 0; i < sizeof(g_pe_id_regs) / sizeof(g_pe_id_regs[0]); i++)
+      hs_sysreg_define(g_pe_id_regs[i].name, g_pe_id_regs[i].reset, NULL, NULL);
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = irq_signal;
+  sa.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGUSR1, &sa, NULL);
+
+  sa.sa_sigaction = sync_signal;
+  sa.sa_flags = SA_SIGINFO;
+  sigaddset(&sa.sa_mask, SIGUSR1);
+  sigaction(SIGSEGV, &sa, NULL);
+  sigaction(SIGBUS, &sa, NULL);
+}
+
+void
+hs_pe_start_primary(void (*entry)(void))
+{
+  HS_PE *pe = &g_hs_pe[0];
+
+  hs_self = pe;
+  pe->thread = pthread_self();
+  pe_reset(pe);
+  pe->state = HS_PE_ON;
+  g_primary_mpidr = pe->mpidr & HS_MPIDR_AFF_MASK;
+
+  entry();
+}
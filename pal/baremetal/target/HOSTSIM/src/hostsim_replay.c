@@ -0,0 +1,250 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * MMIO replay model of the HOSTSIM platform.
+ *
+ * With -replay, the accesses recorded by the mmio_record policy on a real
+ * platform, exported with tools/scripts/acs_mmio_replay.py --export, stand in
+ * for the devices HOSTSIM does not model. Every recorded 4KB frame that no
+ * other model covers becomes a replay region. A read of a recorded register
+ * returns the values the platform returned, in trace order, and keeps
+ * returning the last one once they are used up. Writes are accepted and
+ * dropped: the recorded reads already carry their effect.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hostsim.h"
+
+#define HS_REPLAY_MAGIC       "ACSMMIO1"
+#define HS_REPLAY_WRITE       0x1
+#define HS_REPLAY_FRAME       0x1000ULL
+#define HS_REPLAY_MERGE_GAP   0x10000ULL  /* frames this close share a region */
+
+/* Layout of acs_mmio_replay.py --export, little-endian */
+typedef struct {
+  char     magic[8];
+  uint32_t count;
+  uint32_t freq;
+} __attribute__((packed)) HS_REPLAY_FILE_HDR;
+
+typedef struct {
+  uint64_t addr;
+  uint64_t value;
+  uint64_t timestamp;
+  uint32_t mpidr;
+  uint8_t  width;
+  uint8_t  flags;
+  uint16_t reserved;
+} __attribute__((packed)) HS_REPLAY_FILE_REC;
+
+/* Recorded reads of one register address */
+typedef struct {
+  uint64_t          addr;
+  uint64_t         *reads;
+  uint32_t          num_reads;
+  volatile uint32_t next;           /* shared by all PEs, in trace order */
+} HS_REPLAY_REG;
+
+typedef struct {
+  uint64_t addr;
+  uint64_t value;
+  uint32_t seq;
+} HS_REPLAY_READ;
+
+static HS_REPLAY_REG *g_replay_reg;
+static uint32_t       g_replay_reg_count;
+
+static volatile uint64_t g_replay_served;
+static volatile uint64_t g_replay_exhausted;
+static volatile uint64_t g_replay_unrecorded;
+
+static int
+read_cmp(const void *a, const void *b)
+{
+  const HS_REPLAY_READ *x = a, *y = b;
+
+  if (x->addr != y->addr)
+      return (x->addr < y->addr) ? -1 : 1;
+  return (x->seq < y->seq) ? -1 : (x->seq > y->seq);
+}
+
+static int
+addr_cmp(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+  return (x < y) ? -1 : (x > y);
+}
+
+static HS_REPLAY_REG *
+reg_find(uint64_t addr)
+{
+  uint32_t lo = 0, hi = g_replay_reg_count;
+
+  while (lo < hi) {
+      uint32_t mid = (lo + hi) / 2;
+
+      if (addr < g_replay_reg[mid].addr)
+          hi = mid;
+      else if (addr > g_replay_reg[mid].addr)
+          lo = mid + 1;
+      else
+          return &g_replay_reg[mid];
+  }
+  return NULL;
+}
+
+static uint64_t
+replay_read(void *ctx, uint64_t offset, uint32_t width)
+{
+  uint64_t addr = (uint64_t)(uintptr_t)ctx + offset;
+  HS_REPLAY_REG *reg = reg_find(addr);
+  uint32_t n;
+  uint64_t value;
+
+  if (reg == NULL || reg->num_reads == 0) {
+      __atomic_fetch_add(&g_replay_unrecorded, 1, __ATOMIC_RELAXED);
+      hs_trace("replay: read%u of unrecorded 0x%lx", width * 8, addr);
+      return 0;
+  }
+
+  n = __atomic_fetch_add(&reg->next, 1, __ATOMIC_RELAXED);
+  if (n >= reg->num_reads) {
+      __atomic_fetch_add(&g_replay_exhausted, 1, __ATOMIC_RELAXED);
+      n = reg->num_reads - 1;
+  } else {
+      __atomic_fetch_add(&g_replay_served, 1, __ATOMIC_RELAXED);
+  }
+
+  value = reg->reads[n];
+  if (width < 8)
+      value &= (1ULL << (width * 8)) - 1;
+  return value;
+}
+
+static void
+replay_write(void *ctx, uint64_t offset, uint64_t value, uint32_t width)
+{
+  hs_trace("replay: write%u 0x%lx = 0x%lx dropped", width * 8,
+           (uint64_t)(uintptr_t)ctx + offset, value);
+}
+
+/* Adds one replay region for [base, end) unless a model already covers it */
+static uint32_t
+replay_region_add(uint64_t base, uint64_t end)
+{
+  uint64_t frame;
+
+  for (frame = base; frame < end; frame += HS_REPLAY_FRAME) {
+      if (hs_region_overlaps(frame, HS_REPLAY_FRAME)) {
+          /* Split around the frames of other models */
+          return ((frame > base) ? replay_region_add(base, frame) : 0) +
+                 replay_region_add(frame + HS_REPLAY_FRAME, end);
+      }
+  }
+
+  if (base == end)
+      return 0;
+
+  hs_region_add("replay", base, end - base, (void *)(uintptr_t)base,
+                replay_read, replay_write);
+  return 1;
+}
+
+void
+hs_replay_init(const char *path)
+{
+  HS_REPLAY_FILE_HDR hdr;
+  HS_REPLAY_FILE_REC rec;
+  HS_REPLAY_READ *reads;
+  uint64_t *frames, *values;
+  uint32_t num_reads = 0, num_frames = 0, num_regions = 0, i, j;
+  FILE *file;
+
+  file = fopen(path, "rb");
+  if (file == NULL)
+      hs_fatal("cannot open the replay file %s", path);
+  if (fread(&hdr, sizeof(hdr), 1, file) != 1 ||
+      memcmp(hdr.magic, HS_REPLAY_MAGIC, sizeof(hdr.magic)) != 0)
+      hs_fatal("%s is not an acs_mmio_replay.py --export file", path);
+
+  reads = calloc(hdr.count ? hdr.count : 1, sizeof(HS_REPLAY_READ));
+  frames = calloc(hdr.count ? hdr.count : 1, sizeof(uint64_t));
+  if (reads == NULL || frames == NULL)
+      hs_fatal("out of memory for %u replay records", hdr.count);
+
+  for (i = 0; i < hdr.count; i++) {
+      if (fread(&rec, sizeof(rec), 1, file) != 1)
+          hs_fatal("%s: truncated after %u of %u records", path, i, hdr.count);
+
+      frames[num_frames++] = rec.addr & ~(HS_REPLAY_FRAME - 1);
+      if (rec.flags & HS_REPLAY_WRITE)
+          continue;
+      reads[num_reads].addr = rec.addr;
+      reads[num_reads].value = rec.value;
+      reads[num_reads].seq = i;
+      num_reads++;
+  }
+  fclose(file);
+
+  /* One register per address, its reads in trace order */
+  qsort(reads, num_reads, sizeof(HS_REPLAY_READ), read_cmp);
+  g_replay_reg = calloc(num_reads ? num_reads : 1, sizeof(HS_REPLAY_REG));
+  values = calloc(num_reads ? num_reads : 1, sizeof(uint64_t));
+  if (g_replay_reg == NULL || values == NULL)
+      hs_fatal("out of memory for %u replay reads", num_reads);
+
+  for (i = 0; i < num_reads; i++) {
+      if (i == 0 || reads[i].addr != reads[i - 1].addr) {
+          g_replay_reg[g_replay_reg_count].addr = reads[i].addr;
+          g_replay_reg[g_replay_reg_count].reads = &values[i];
+          g_replay_reg_count++;
+      }
+      values[i] = reads[i].value;
+      g_replay_reg[g_replay_reg_count - 1].num_reads++;
+  }
+  free(reads);
+
+  /* Frames close to each other share one region */
+  qsort(frames, num_frames, sizeof(uint64_t), addr_cmp);
+  for (i = 0; i < num_frames; i = j) {
+      for (j = i + 1; j < num_frames &&
+           frames[j] - frames[j - 1] <= HS_REPLAY_MERGE_GAP; j++)
+          ;
+      num_regions += replay_region_add(frames[i], frames[j - 1] + HS_REPLAY_FRAME);
+  }
+  free(frames);
+
+  hs_trace("replay: %u records, %u registers read, %u regions from %s",
+           hdr.count, g_replay_reg_count, num_regions, path);
+}
+
+void
+hs_replay_report(void)
+{
+  if (g_replay_reg == NULL)
+      return;
+
+  fprintf(stderr, "hostsim: replay served %lu recorded reads, %lu past the end of "
+          "their register, %lu of unrecorded addresses\n",
+          (uint64_t)g_replay_served, (uint64_t)g_replay_exhausted,
+          (uint64_t)g_replay_unrecorded);
+}
@@ -0,0 +1,203 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * SMMUv3 model of the HOSTSIM platform.
+ *
+ * The register files of the SMMUs in the IORT description accept the
+ * driver programming sequence: CR0/IRQ_CTRL updates are acknowledged at
+ * once, and the command queue is consumed as soon as SMMU_CMDQ_PROD is
+ * written. CMD_SYNC completion is signalled through its MSI write. The
+ * simulated PCIe functions do not issue DMA, so no translation is performed
+ * and the event queue stays empty.
+ */
+
+#include <string.h>
+
+#include "hostsim.h"
+#include "pal_common_support.h"
+#include "platform_override_struct.h"
+#include "platform_override_fvp.h"
+
+extern const PLATFORM_OVERRIDE_NODE_DATA platform_node_type;
+
+#define HS_SMMU_SIZE          0x20000   /* Page 0 and Page 1 */
+
+/* Two-level stream table, 2-level CD tables, S1 and S2, AArch64, MSI, HYP */
+#define HS_SMMU_IDR0          ((1u << 27) | (1u << 19) | (1u << 13) | (1u << 12) | \
+                               (1u << 9) | (1u << 4) | (2u << 2) | 0x3 | (1u << 18))
+/* CMDQS = 8, EVENTQS = 7, SSIDSIZE = 16, SIDSIZE = 16 */
+#define HS_SMMU_IDR1          ((8u << 21) | (7u << 16) | (16u << 6) | 16u)
+#define HS_SMMU_IDR3          (1u << 10)
+/* 4KB, 16KB and 64KB granules, 48-bit OAS */
+#define HS_SMMU_IDR5          ((1u << 6) | (1u << 5) | (1u << 4) | 5u)
+#define HS_SMMU_AIDR          0x2       /* SMMUv3.2 */
+
+#define CR0_CMDQEN            (1u << 3)
+#define GBPA_UPDATE           (1u << 31)
+
+#define CMDQ_OP_CMD_SYNC      0x46
+#define CMDQ_SYNC_CS_IRQ      1
+#define CMDQ_SYNC_MSIADDR     0x000FFFFFFFFFFFFCULL
+
+typedef struct {
+  uint64_t base;
+  uint32_t cr0;
+  uint32_t cr1;
+  uint32_t cr2;
+  uint32_t gbpa;
+  uint32_t irq_ctrl;
+  uint32_t gerror;
+  uint32_t gerrorn;
+  uint64_t strtab_base;
+  uint32_t strtab_base_cfg;
+  uint64_t cmdq_base;
+  uint32_t cmdq_prod;
+  uint32_t cmdq_cons;
+  uint64_t evtq_base;
+  uint32_t evtq_prod;
+  uint32_t evtq_cons;
+  uint64_t regs[HS_SMMU_SIZE / 8];    /* everything else reads back */
+  pthread_mutex_t lock;
+} HS_SMMU;
+
+static HS_SMMU g_smmu[IOVIRT_SMMUV3_COUNT];
+
+/* Consume the command queue up to SMMU_CMDQ_PROD, called with smmu->lock held */
+static void
+cmdq_consume_locked(HS_SMMU *smmu)
+{
+  uint32_t log2n = smmu->cmdq_base & 0x1F;
+  uint32_t mask = (1u << log2n) - 1;
+  uint64_t base = smmu->cmdq_base & 0x000FFFFFFFFFFFE0ULL;
+  uint32_t cons = smmu->cmdq_cons;
+  volatile uint64_t *cmd;
+  uint64_t msiaddr;
+
+  if (!(smmu->cr0 & CR0_CMDQEN) || base == 0)
+      return;
+
+  /* Index and wrap bit of PROD and CONS */
+  while ((cons & ((mask << 1) | 1)) != (smmu->cmdq_prod & ((mask << 1) | 1))) {
+      cmd = (volatile uint64_t *)(base + (uint64_t)(cons & mask) * 16);
+      if ((cmd[0] & 0xFF) == CMDQ_OP_CMD_SYNC && ((cmd[0] >> 12) & 3) == CMDQ_SYNC_CS_IRQ) {
+          msiaddr = cmd[1] & CMDQ_SYNC_MSIADDR;
+          if (msiaddr)
+              *(volatile uint32_t *)msiaddr = cmd[0] >> 32;
+      }
+      cons = (cons + 1) & ((mask << 1) | 1);
+  }
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  smmu->cmdq_cons = cons;
+}
+
+static uint64_t
+smmu_read(void *ctx, uint64_t off, uint32_t width)
+{
+  HS_SMMU *smmu = ctx;
+  uint64_t value;
+
+  pthread_mutex_lock(&smmu->lock);
+  switch (off) {
+  case 0x00:    value = HS_SMMU_IDR0; break;
+  case 0x04:    value = HS_SMMU_IDR1; break;
+  case 0x08:    value = 0; break;
+  case 0x0C:    value = HS_SMMU_IDR3; break;
+  case 0x10:    value = 0; break;
+  case 0x14:    value = HS_SMMU_IDR5; break;
+  case 0x18:    value = 0x0000043B; break;    /* IIDR */
+  case 0x1C:    value = HS_SMMU_AIDR; break;
+  case 0x20:
+  case 0x24:    value = smmu->cr0; break;     /* CR0, CR0ACK */
+  case 0x28:    value = smmu->cr1; break;
+  case 0x2C:    value = smmu->cr2; break;
+  case 0x44:    value = smmu->gbpa; break;
+  case 0x50:
+  case 0x54:    value = smmu->irq_ctrl; break;
+  case 0x60:    value = smmu->gerror; break;
+  case 0x64:    value = smmu->gerrorn; break;
+  case 0x80:    value = smmu->strtab_base; break;
+  case 0x88:    value = smmu->strtab_base_cfg; break;
+  case 0x90:    value = smmu->cmdq_base; break;
+  case 0x98:    value = smmu->cmdq_prod; break;
+  case 0x9C:    value = smmu->cmdq_cons; break;
+  case 0xA0:    value = smmu->evtq_base; break;
+  case 0x100A8: value = smmu->evtq_prod; break;
+  case 0x100AC: value = smmu->evtq_cons; break;
+  default:
+      value = smmu->regs[off / 8] >> (8 * (off & 4));
+      break;
+  }
+  pthread_mutex_unlock(&smmu->lock);
+
+  return width == 8 ? value : (value & 0xFFFFFFFF);
+}
+
+static void
+smmu_write(void *ctx, uint64_t off, uint64_t value, uint32_t width)
+{
+  HS_SMMU *smmu = ctx;
+  uint64_t *reg;
+
+  pthread_mutex_lock(&smmu->lock);
+  switch (off) {
+  case 0x20:
+      smmu->cr0 = value;
+      cmdq_consume_locked(smmu);
+      break;
+  case 0x28:    smmu->cr1 = value; break;
+  case 0x2C:    smmu->cr2 = value; break;
+  case 0x44:    smmu->gbpa = value & ~GBPA_UPDATE; break;
+  case 0x50:    smmu->irq_ctrl = value; break;
+  case 0x64:    smmu->gerrorn = value; break;
+  case 0x80:    smmu->strtab_base = value; break;
+  case 0x88:    smmu->strtab_base_cfg = value; break;
+  case 0x90:    smmu->cmdq_base = value; break;
+  case 0x98:
+      smmu->cmdq_prod = value;
+      cmdq_consume_locked(smmu);
+      break;
+  case 0x9C:    smmu->cmdq_cons = value; break;
+  case 0xA0:    smmu->evtq_base = value; break;
+  case 0x100A8: smmu->evtq_prod = value; break;
+  case 0x100AC: smmu->evtq_cons = value; break;
+  default:
+      reg = &smmu->regs[off / 8];
+      if (width == 8)
+          *reg = value;
+      else if (off & 4)
+          *reg = (*reg & 0xFFFFFFFFULL) | (value << 32);
+      else
+          *reg = (*reg & ~0xFFFFFFFFULL) | (value & 0xFFFFFFFF);
+      break;
+  }
+  pthread_mutex_unlock(&smmu->lock);
+}
+
+void
+hs_smmu_init(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < IOVIRT_SMMUV3_COUNT; i++) {
+      if (platform_node_type.smmu[i].base == 0)
+          continue;
+      g_smmu[i].base = platform_node_type.smmu[i].base;
+      pthread_mutex_init(&g_smmu[i].lock, NULL);
+      hs_region_add("smmu", g_smmu[i].base, HS_SMMU_SIZE, &g_smmu[i], smmu_read, smmu_write);
+  }
+}
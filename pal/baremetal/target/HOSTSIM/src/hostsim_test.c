@@ -0,0 +1,61 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * Host versions of the test pool entries whose source issues A64
+ * instructions inline and is left out of the host build (see
+ * CMakeLists.txt). Each one takes the path the test takes on a platform
+ * without the device under test.
+ */
+
+#include "val/include/acs_val.h"
+#include "val/include/acs_common.h"
+#include "val/include/acs_cxl.h"
+#include "val/include/acs_pe.h"
+#include "val/include/val_interface.h"
+
+/* test_pool/cxl/cxl013.c: no CXL Type-3 memory is modelled */
+#define CXL013_TEST_NUM   (ACS_CXL_TEST_NUM_BASE + 13)
+#define CXL013_TEST_RULE  "CXL_13"
+#define CXL013_TEST_DESC  "Validate CXL Type3 atomic memory features      "
+
+static void
+cxl013_payload(void)
+{
+  uint32_t pe_index = val_pe_get_index_mpid(val_pe_get_mpid());
+
+  val_print(TRACE, "\n       No CXL Type-3 memory target found");
+  val_set_status(pe_index, RESULT_SKIP(1));
+}
+
+uint32_t
+cxl013_entry(uint32_t num_pe)
+{
+  uint32_t status;
+
+  num_pe = 1;
+
+  val_log_context((char8_t *)__FILE__, (char8_t *)__func__, __LINE__);
+  status = val_initialize_test(CXL013_TEST_NUM, CXL013_TEST_DESC, num_pe);
+  if (status != ACS_STATUS_SKIP)
+      val_run_test_payload(CXL013_TEST_NUM, num_pe, cxl013_payload, 0);
+
+  status = val_check_for_error(CXL013_TEST_NUM, num_pe, CXL013_TEST_RULE);
+  val_report_status(0, ACS_END(CXL013_TEST_NUM), NULL);
+
+  return status;
+}
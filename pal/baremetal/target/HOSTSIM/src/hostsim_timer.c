@@ -0,0 +1,558 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * Generic timer model of the HOSTSIM platform.
+ *
+ * The system counter follows host CLOCK_MONOTONIC, scaled by -timescale.
+ * Each PE has the EL1 physical and virtual timers and the EL2 physical and
+ * virtual timers, which drive their PPIs as level-sensitive inputs. The
+ * memory-mapped timer frames and the generic watchdogs of the platform
+ * description are modelled on the same counter. A tick thread re-evaluates
+ * the compare conditions; WFI re-evaluates the timers of the waiting PE.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+
+#include "hostsim.h"
+#include "pal_common_support.h"
+#include "platform_override_struct.h"
+#include "platform_override_fvp.h"
+
+extern const PLATFORM_OVERRIDE_TIMER_INFO_TABLE platform_timer_cfg;
+extern const WD_INFO_TABLE platform_wd_cfg;
+
+#define HS_TICK_NS            100000
+#define HS_MAX_FRAME          8
+#define HS_MAX_WD             4
+
+#define CNT_CTL_ENABLE        (1u << 0)
+#define CNT_CTL_IMASK         (1u << 1)
+#define CNT_CTL_ISTATUS       (1u << 2)
+
+#define WCS_EN                (1u << 0)
+#define WCS_WS0               (1u << 1)
+#define WCS_WS1               (1u << 2)
+
+/* PE timers, in the order of their PPIs in g_timer_ppi */
+enum {
+  HS_TIMER_P = 0,                     /* CNTP, EL1 physical */
+  HS_TIMER_V,                         /* CNTV, EL1 virtual */
+  HS_TIMER_HP,                        /* CNTHP, EL2 physical */
+  HS_TIMER_HV,                        /* CNTHV, EL2 virtual */
+  HS_NUM_PE_TIMER
+};
+
+enum {
+  HS_TREG_CTL = 0,
+  HS_TREG_CVAL,
+  HS_TREG_TVAL
+};
+
+typedef struct {
+  uint32_t ctl;
+  uint64_t cval;
+} HS_TIMER;
+
+/* Memory-mapped timer frame (CNTBaseN) */
+typedef struct {
+  uint64_t base;
+  uint32_t gsiv;
+  HS_TIMER phys;
+  HS_TIMER virt;
+  uint64_t cntvoff;
+  uint32_t el0acr;
+  uint32_t level;
+} HS_TIMER_FRAME;
+
+/* Generic watchdog: control and refresh frames */
+typedef struct {
+  uint64_t ctrl_base;
+  uint64_t refresh_base;
+  uint32_t gsiv;
+  uint32_t wcs;
+  uint64_t wor;
+  uint64_t wcv;
+  uint32_t level;
+} HS_WD;
+
+static struct timespec  g_start;
+static HS_TIMER         g_pe_timer[HS_MAX_PE][HS_NUM_PE_TIMER];
+static uint32_t         g_pe_level[HS_MAX_PE];
+static uint32_t         g_timer_ppi[HS_NUM_PE_TIMER];
+
+static uint32_t         g_cntacr[HS_MAX_FRAME];
+static HS_TIMER_FRAME   g_frame[HS_MAX_FRAME];
+static uint32_t         g_frame_count;
+static HS_WD            g_wd[HS_MAX_WD];
+static uint32_t         g_wd_count;
+
+static pthread_mutex_t  g_timer_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* System register slot -> timer and register, for the timer hooks */
+static uint8_t          g_slot_timer[HS_MAX_SYSREG];
+static uint8_t          g_slot_treg[HS_MAX_SYSREG];
+static uint32_t         g_slot_cntvoff;
+
+uint64_t
+hs_timer_counter(void)
+{
+  struct timespec now;
+  unsigned __int128 ns;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  ns = (unsigned __int128)(now.tv_sec - g_start.tv_sec) * 1000000000u +
+       (now.tv_nsec - g_start.tv_nsec);
+  return (uint64_t)(ns * g_hs_config.timescale * g_hs_config.cntfrq / 1000000000u);
+}
+
+/* ISTATUS of a timer for the given count */
+static uint32_t
+timer_status(const HS_TIMER *t, uint64_t count)
+{
+  return (t->ctl & CNT_CTL_ENABLE) && count >= t->cval;
+}
+
+static uint64_t
+timer_count(HS_PE *pe, uint32_t timer)
+{
+  uint64_t count = hs_timer_counter();
+
+  if (timer == HS_TIMER_V || timer == HS_TIMER_HV)
+      count -= hs_sysreg_get(pe, g_slot_cntvoff);
+  return count;
+}
+
+void
+hs_timer_update_pe(HS_PE *pe)
+{
+  uint32_t i, level, changed;
+  uint64_t count;
+  HS_TIMER *t;
+
+  pthread_mutex_lock(&g_timer_lock);
+  level = 0;
+  for (i = 0; i < HS_NUM_PE_TIMER; i++) {
+      t = &g_pe_timer[pe->index][i];
+      count = timer_count(pe, i);
+      if (timer_status(t, count) && !(t->ctl & CNT_CTL_IMASK))
+          level |= 1u << i;
+  }
+  changed = level ^ g_pe_level[pe->index];
+  g_pe_level[pe->index] = level;
+
+  /* Lines are updated under the timer lock so that they follow the state */
+  for (i = 0; i < HS_NUM_PE_TIMER; i++) {
+      if ((changed >> i) & 1)
+          hs_gic_set_level(pe, g_timer_ppi[i], (level >> i) & 1);
+  }
+  pthread_mutex_unlock(&g_timer_lock);
+}
+
+/* CNT*_CTL, CNT*_CVAL and CNT*_TVAL of the PE timers */
+static uint64_t
+pe_timer_read(HS_PE *pe, uint32_t slot)
+{
+  uint32_t timer = g_slot_timer[slot];
+  HS_TIMER *t = &g_pe_timer[pe->index][timer];
+  uint64_t count = timer_count(pe, timer);
+
+  switch (g_slot_treg[slot]) {
+  case HS_TREG_CTL:
+      return t->ctl | (timer_status(t, count) ? CNT_CTL_ISTATUS : 0);
+  case HS_TREG_CVAL:
+      return t->cval;
+  default:
+      return (uint32_t)(t->cval - count);
+  }
+}
+
+static void
+pe_timer_write(HS_PE *pe, uint32_t slot, uint64_t value)
+{
+  uint32_t timer = g_slot_timer[slot];
+  HS_TIMER *t = &g_pe_timer[pe->index][timer];
+
+  pthread_mutex_lock(&g_timer_lock);
+  switch (g_slot_treg[slot]) {
+  case HS_TREG_CTL:
+      t->ctl = value & (CNT_CTL_ENABLE | CNT_CTL_IMASK);
+      break;
+  case HS_TREG_CVAL:
+      t->cval = value;
+      break;
+  default:
+      t->cval = timer_count(pe, timer) + (int64_t)(int32_t)value;
+      break;
+  }
+  pthread_mutex_unlock(&g_timer_lock);
+
+  hs_timer_update_pe(pe);
+}
+
+static uint64_t
+cntpct_read(HS_PE *pe, uint32_t slot)
+{
+  (void)pe;
+  (void)slot;
+  return hs_timer_counter();
+}
+
+static uint64_t
+cntvct_read(HS_PE *pe, uint32_t slot)
+{
+  (void)slot;
+  return hs_timer_counter() - hs_sysreg_get(pe, g_slot_cntvoff);
+}
+
+static void
+define_pe_timer(const char *name, uint32_t timer, uint32_t treg)
+{
+  uint32_t slot = hs_sysreg_define(name, 0, pe_timer_read, pe_timer_write);
+
+  g_slot_timer[slot] = timer;
+  g_slot_treg[slot] = treg;
+}
+
+static void
+timer_define_sysregs(void)
+{
+  static const struct {
+    const char *prefix;
+    const char *suffix;
+    uint32_t    timer;
+  } regs[] = {
+    /* With HCR_EL2.E2H set, the _EL02 names reach the EL1 timers */
+    { "cntp",  "el0",  HS_TIMER_P  },
+    { "cntp",  "el02", HS_TIMER_P  },
+    { "cntv",  "el0",  HS_TIMER_V  },
+    { "cntv",  "el02", HS_TIMER_V  },
+    { "cnthp", "el2",  HS_TIMER_HP },
+    { "cnthv", "el2",  HS_TIMER_HV },
+  };
+  static const char *treg_name[] = { "ctl", "cval", "tval" };
+  char name[32];
+  uint32_t i, r;
+
+  for (i = 0; i < sizeof(regs) / sizeof(regs[0]); i++) {
+      for (r = 0; r < 3; r++) {
+          snprintf(name, sizeof(name), "%s_%s_%s", regs[i].prefix, treg_name[r],
+                   regs[i].suffix);
+          define_pe_timer(name, regs[i].timer, r);
+      }
+  }
+
+  hs_sysreg_define("cntpct_el0", 0, cntpct_read, NULL);
+  hs_sysreg_define("cntpctss_el0", 0, cntpct_read, NULL);
+  hs_sysreg_define("cntvct_el0", 0, cntvct_read, NULL);
+  hs_sysreg_define("cntvctss_el0", 0, cntvct_read, NULL);
+  g_slot_cntvoff = hs_sysreg_define("cntvoff_el2", 0, NULL, NULL);
+}
+
+/* CNTCTLBase: frame identification and access control */
+static uint64_t
+cntctl_read(void *ctx, uint64_t off, uint32_t width)
+{
+  uint32_t i, tidr = 0;
+
+  (void)ctx;
+  (void)width;
+  if (off == 0x00)
+      return g_hs_config.cntfrq;
+  if (off == 0x08) {
+      /* Every frame is implemented and has a virtual timer */
+      for (i = 0; i < g_frame_count; i++)
+          tidr |= 0x3u << (4 * platform_timer_cfg.gt_info.frame_num[i]);
+      return tidr;
+  }
+  if (off >= 0x40 && off < 0x40 + 4 * HS_MAX_FRAME)
+      return g_cntacr[(off - 0x40) / 4];
+  if (off >= 0x80 && off < 0x80 + 8 * HS_MAX_FRAME && (off & 7) == 0 &&
+      (off - 0x80) / 8 < g_frame_count)
+      return g_frame[(off - 0x80) / 8].cntvoff;
+  return 0;
+}
+
+static void
+cntctl_write(void *ctx, uint64_t off, uint64_t value, uint32_t width)
+{
+  (void)ctx;
+  (void)width;
+  if (off >= 0x40 && off < 0x40 + 4 * HS_MAX_FRAME)
+      g_cntacr[(off - 0x40) / 4] = value & 0x3F;
+  else if (off >= 0x80 && off < 0x80 + 8 * HS_MAX_FRAME && (off & 7) == 0 &&
+           (off - 0x80) / 8 < g_frame_count)
+      g_frame[(off - 0x80) / 8].cntvoff = value;
+}
+
+/* Called with g_timer_lock held, returns the new interrupt level */
+static uint32_t
+frame_update_locked(HS_TIMER_FRAME *f, uint64_t count)
+{
+  return (timer_status(&f->phys, count) && !(f->phys.ctl & CNT_CTL_IMASK)) ||
+         (timer_status(&f->virt, count - f->cntvoff) && !(f->virt.ctl & CNT_CTL_IMASK));
+}
+
+static uint64_t
+frame_read(void *ctx, uint64_t off, uint32_t width)
+{
+  HS_TIMER_FRAME *f = ctx;
+  uint64_t count = hs_timer_counter(), value;
+
+  switch (off & ~7ULL) {
+  case 0x00: value = count; break;
+  case 0x08: value = count - f->cntvoff; break;
+  case 0x10: value = g_hs_config.cntfrq | ((uint64_t)f->el0acr << 32); break;
+  case 0x18: value = f->cntvoff; break;
+  case 0x20: value = f->phys.cval; break;
+  case 0x28:
+      value = (uint32_t)(f->phys.cval - count) |
+              (uint64_t)(f->phys.ctl | (timer_status(&f->phys, count) ? CNT_CTL_ISTATUS : 0)) << 32;
+      break;
+  case 0x30: value = f->virt.cval; break;
+  case 0x38:
+      value = (uint32_t)(f->virt.cval - (count - f->cntvoff)) |
+              (uint64_t)(f->virt.ctl | (timer_status(&f->virt, count - f->cntvoff) ?
+                                        CNT_CTL_ISTATUS : 0)) << 32;
+      break;
+  default: value = 0; break;
+  }
+  value >>= 8 * (off & 4);
+  return width == 8 ? value : (value & 0xFFFFFFFF);
+}
+
+static void
+frame_write(void *ctx, uint64_t off, uint64_t value, uint32_t width)
+{
+  HS_TIMER_FRAME *f = ctx;
+  uint64_t count = hs_timer_counter();
+  uint32_t level;
+
+  pthread_mutex_lock(&g_timer_lock);
+  switch (off) {
+  case 0x14: f->el0acr = value; break;
+  case 0x20:
+      f->phys.cval = (width == 8) ? value : ((f->phys.cval & ~0xFFFFFFFFULL) | (uint32_t)value);
+      break;
+  case 0x24: f->phys.cval = (f->phys.cval & 0xFFFFFFFF) | (value << 32); break;
+  case 0x28: f->phys.cval = count + (int64_t)(int32_t)value; break;
+  case 0x2C: f->phys.ctl = value & (CNT_CTL_ENABLE | CNT_CTL_IMASK); break;
+  case 0x30:
+      f->virt.cval = (width == 8) ? value : ((f->virt.cval & ~0xFFFFFFFFULL) | (uint32_t)value);
+      break;
+  case 0x34: f->virt.cval = (f->virt.cval & 0xFFFFFFFF) | (value << 32); break;
+  case 0x38: f->virt.cval = count - f->cntvoff + (int64_t)(int32_t)value; break;
+  case 0x3C: f->virt.ctl = value & (CNT_CTL_ENABLE | CNT_CTL_IMASK); break;
+  default: break;
+  }
+  level = frame_update_locked(f, count);
+  f->level = level;
+  hs_gic_set_level(NULL, f->gsiv, level);
+  pthread_mutex_unlock(&g_timer_lock);
+}
+
+/* Generic watchdog, SBSA architecture revision 0 (32-bit WOR) */
+static void
+wd_refresh_locked(HS_WD *wd)
+{
+  wd->wcs &= ~(WCS_WS0 | WCS_WS1);
+  wd->wcv = hs_timer_counter() + wd->wor;
+}
+
+static uint64_t
+wd_ctrl_read(void *ctx, uint64_t off, uint32_t width)
+{
+  HS_WD *wd = ctx;
+  uint64_t value;
+
+  switch (off & ~3ULL) {
+  case 0x000: value = wd->wcs; break;
+  case 0x008: value = wd->wor; break;
+  case 0x010: value = wd->wcv; break;
+  case 0x014: value = wd->wcv >> 32; break;
+  case 0xFCC: value = 0x0000043B; break;
+  default:    value = 0; break;
+  }
+  return width == 8 ? value : (value & 0xFFFFFFFF);
+}
+
+static void
+wd_ctrl_write(void *ctx, uint64_t off, uint64_t value, uint32_t width)
+{
+  HS_WD *wd = ctx;
+
+  (void)width;
+  pthread_mutex_lock(&g_timer_lock);
+  switch (off) {
+  case 0x000:
+      if ((value & WCS_EN) && !(wd->wcs & WCS_EN)) {
+          wd->wcs |= WCS_EN;
+          wd_refresh_locked(wd);
+      } else if (!(value & WCS_EN)) {
+          wd->wcs &= ~WCS_EN;
+      }
+      break;
+  case 0x008:
+      wd->wor = (uint32_t)value;
+      wd_refresh_locked(wd);
+      break;
+  case 0x010:
+      wd->wcv = value;
+      break;
+  default:
+      break;
+  }
+  wd->level = (wd->wcs & (WCS_EN | WCS_WS0)) == (WCS_EN | WCS_WS0);
+  hs_gic_set_level(NULL, wd->gsiv, wd->level);
+  pthread_mutex_unlock(&g_timer_lock);
+}
+
+static uint64_t
+wd_refresh_read(void *ctx, uint64_t off, uint32_t width)
+{
+  (void)ctx;
+  (void)width;
+  return off == 0xFCC ? 0x0000043B : 0;
+}
+
+static void
+wd_refresh_write(void *ctx, uint64_t off, uint64_t value, uint32_t width)
+{
+  HS_WD *wd = ctx;
+
+  (void)value;
+  (void)width;
+  if (off != 0)
+      return;
+  pthread_mutex_lock(&g_timer_lock);
+  wd_refresh_locked(wd);
+  wd->level = 0;
+  hs_gic_set_level(NULL, wd->gsiv, 0);
+  pthread_mutex_unlock(&g_timer_lock);
+}
+
+/* Watchdog timeout: first signal raises WS0, the second one would reset */
+static void
+wd_update(HS_WD *wd, uint64_t count)
+{
+  uint32_t level;
+
+  pthread_mutex_lock(&g_timer_lock);
+  if ((wd->wcs & WCS_EN) && count >= wd->wcv) {
+      if (!(wd->wcs & WCS_WS0)) {
+          wd->wcs |= WCS_WS0;
+          wd->wcv = count + wd->wor;
+      } else if (!(wd->wcs & WCS_WS1)) {
+          wd->wcs |= WCS_WS1;
+          hs_trace("watchdog 0x%llx: WS1 (system reset ignored)",
+                   (unsigned long long)wd->ctrl_base);
+      }
+  }
+  level = (wd->wcs & (WCS_EN | WCS_WS0)) == (WCS_EN | WCS_WS0);
+  wd->level = level;
+  hs_gic_set_level(NULL, wd->gsiv, level);
+  pthread_mutex_unlock(&g_timer_lock);
+}
+
+static void *
+tick_thread(void *arg)
+{
+  struct timespec delay = { 0, HS_TICK_NS };
+  sigset_t all;
+  uint64_t count;
+  uint32_t i, level;
+
+  (void)arg;
+  sigfillset(&all);
+  pthread_sigmask(SIG_BLOCK, &all, NULL);
+
+  while (1) {
+      nanosleep(&delay, NULL);
+      count = hs_timer_counter();
+
+      for (i = 0; i < g_hs_config.num_pe; i++) {
+          if (g_hs_pe[i].state == HS_PE_ON)
+              hs_timer_update_pe(&g_hs_pe[i]);
+      }
+      for (i = 0; i < g_frame_count; i++) {
+          pthread_mutex_lock(&g_timer_lock);
+          level = frame_update_locked(&g_frame[i], count);
+          g_frame[i].level = level;
+          hs_gic_set_level(NULL, g_frame[i].gsiv, level);
+          pthread_mutex_unlock(&g_timer_lock);
+      }
+      for (i = 0; i < g_wd_count; i++)
+          wd_update(&g_wd[i], count);
+  }
+  return NULL;
+}
+
+void
+hs_timer_init(void)
+{
+  const PLATFORM_OVERRIDE_TIMER_INFO_GTBLOCK *gt = &platform_timer_cfg.gt_info;
+  pthread_t thread;
+  uint32_t i, j;
+
+  clock_gettime(CLOCK_MONOTONIC, &g_start);
+
+  g_timer_ppi[HS_TIMER_P] = platform_timer_cfg.header.ns_el1_timer_gsiv;
+  g_timer_ppi[HS_TIMER_V] = platform_timer_cfg.header.virtual_timer_gsiv;
+  g_timer_ppi[HS_TIMER_HP] = platform_timer_cfg.header.el2_timer_gsiv;
+  g_timer_ppi[HS_TIMER_HV] = platform_timer_cfg.header.el2_virt_timer_gsiv;
+  timer_define_sysregs();
+
+  if (platform_timer_cfg.header.num_platform_timer && gt->block_cntl_base) {
+      hs_region_add("cntctl", gt->block_cntl_base, 0x1000, NULL, cntctl_read, cntctl_write);
+      for (i = 0; i < gt->timer_count && i < HS_MAX_FRAME; i++) {
+          g_frame[i].base = gt->GtCntBase[i];
+          g_frame[i].gsiv = gt->gsiv[i];
+          /* NS access is granted by the firmware for non-secure frames */
+          g_cntacr[gt->frame_num[i]] = (gt->flags[i] & (1u << 16)) ? 0x3F : 0;
+          hs_region_add("cntbase", gt->GtCntBase[i], 0x1000, &g_frame[i],
+                        frame_read, frame_write);
+      }
+      g_frame_count = i;
+  }
+
+  /* Watchdog entries that share a register frame are one watchdog */
+  for (i = 0; i < platform_wd_cfg.header.num_wd; i++) {
+      const WD_INFO_BLOCK *w = &platform_wd_cfg.wd_info[i];
+
+      for (j = 0; j < g_wd_count; j++) {
+          if (g_wd[j].ctrl_base == w->wd_ctrl_base)
+              break;
+      }
+      if (j < g_wd_count || g_wd_count == HS_MAX_WD)
+          continue;
+      g_wd[j].ctrl_base = w->wd_ctrl_base;
+      g_wd[j].refresh_base = w->wd_refresh_base;
+      g_wd[j].gsiv = w->wd_gsiv;
+      hs_region_add("wd_ctrl", w->wd_ctrl_base, 0x1000, &g_wd[j], wd_ctrl_read, wd_ctrl_write);
+      hs_region_add("wd_refresh", w->wd_refresh_base, 0x1000, &g_wd[j],
+                    wd_refresh_read, wd_refresh_write);
+      g_wd_count++;
+  }
+
+  if (pthread_create(&thread, NULL, tick_thread, NULL))
+      hs_fatal("cannot start the timer thread");
+  pthread_detach(thread);
+}
@@ -876,21 +876,9 @@ pal_peripheral_uart_setup(void)
 
 /** MISC PAL API's */
 
-#define __ADDR_ALIGN_MASK(a, mask)    (((a) + (mask)) & ~(mask))
-#define ADDR_ALIGN(a, b)              __ADDR_ALIGN_MASK(a, (typeof(a))(b) - 1)
-
 void *mem_alloc(size_t alignment, size_t size);
 void mem_free(void *ptr);
 
-typedef struct {
-    uint64_t base;
-    uint64_t size;
-} val_host_alloc_region_ts;
-
-static uint64_t heap_base;
-static uint64_t heap_top;
-static uint8_t  heap_init_done;
-
 /**
   @brief  Sends a formatted string to the output console
 
@@ -988,8 +976,8 @@ pal_mem_alloc_pages(uint32_t NumPages)
 void
 pal_mem_free_pages(void *PageBase, uint32_t NumPages)
 {
-  (void) PageBase;
   (void) NumPages;
+  mem_free(PageBase);
 }
 
 /**
@@ -1057,96 +1045,6 @@ pal_mem_free_at_address(uint64_t mem_base,
   (void) Size;
 }
 
-/* Functions implemented below are used to allocate memory from heap. Baremetal implementation
-   of memory allocation.
-*/
-
-static int is_power_of_2(uint32_t n)
-{
-    return n && !(n & (n - 1));
-}
-
-/**
- * @brief Allocates contiguous memory of requested size(no_of_bytes) and alignment.
- * @param alignment - alignment for the address. It must be in power of 2.
- * @param Size - Size of the region. It must not be zero.
- * @return - Returns allocated memory base address if allocation is successful.
- *           Otherwise returns NULL.
- **/
-void *heap_alloc(size_t alignment, size_t size)
-{
-    uint64_t addr;
-
-    addr = ADDR_ALIGN(heap_base, alignment);
-    size += addr - heap_base;
-
-    if ((heap_top - heap_base) < size)
-    {
-       return NULL;
-    }
-
-    heap_base += size;
-
-    return (void *)addr;
-}
-
-/**
- * @brief  Initialisation of allocation data structure
- * @param  void
- * @return Void
- **/
-void mem_alloc_init(void)
-{
-    heap_base = PLATFORM_HEAP_REGION_BASE;
-    heap_top = PLATFORM_HEAP_REGION_BASE + PLATFORM_HEAP_REGION_SIZE;
-    heap_init_done = HEAP_INITIALISED;
-}
-
-/**
- * @brief Allocates contiguous memory of requested size(no_of_bytes) and alignment.
- * @param alignment - alignment for the address. It must be in power of 2.
- * @param Size - Size of the region. It must not be zero.
- * @return - Returns allocated memory base address if allocation is successful.
- *           Otherwise returns NULL.
- **/
-void *mem_alloc(size_t alignment, size_t size)
-{
-  void *addr = NULL;
-
-  if (heap_init_done != HEAP_INITIALISED)
-    mem_alloc_init();
-
-  if (size <= 0)
-  {
-    return NULL;
-  }
-
-  if (!is_power_of_2((uint32_t)alignment))
-  {
-    return NULL;
-  }
-
-  size += alignment - 1;
-  addr = heap_alloc(alignment, size);
-
-  return addr;
-}
-
-/**
- * TODO: Free the memory for given memory address
- * Currently acs code is initialisazing from base for every test,
- * the regions data structure is internal and below code only setting to zero
- * not actually freeing memory.
- * If require can revisit in future.
- **/
-void mem_free(void *ptr)
-{
-  if (!ptr)
-    return;
-
-  return;
-}
-
 /**
   @brief  Allocates memory of the requested size.
 
@@ -1180,8 +1078,8 @@ pal_mem_free_cacheable(uint32_t Bdf, uint32_t Size, void *Va, void *Pa)
 
   (void) Bdf;
   (void) Size;
-  (void) Va;
   (void) Pa;
+  mem_free(Va);
 
 }
 
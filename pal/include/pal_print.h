@@ -35,6 +35,7 @@
 
 #if defined(TARGET_BAREMETAL)
 void pal_uart_print(int log, const char *fmt, ...);
+void pal_print_set_sync_hook(void (*hook)(void));
 
 #define PAL_PRINT_FORMAT(verbose, string, ...) \
     PAL_PRINT_IF((verbose), pal_uart_print((verbose), (string), ##__VA_ARGS__))
@@ -42,6 +42,7 @@ static inline u_register_t read_ ## _name(void)            \
 #endif
 
 SYSREG_READ_FUNC(mpidr_el1)
+SYSREG_READ_FUNC(cntvct_el0)
 SYSREG_READ_FUNC(CurrentEL)
 SYSREG_READ_FUNC(ttbr0_el1)
 SYSREG_READ_FUNC(ttbr0_el2)
@@ -53,6 +54,8 @@ SYSREG_READ_FUNC(mair_el1)
 SYSREG_READ_FUNC(mair_el2)
 SYSREG_READ_FUNC(sctlr_el1)
 SYSREG_READ_FUNC(sctlr_el2)
+SYSREG_READ_FUNC(tpidr_el1)
+SYSREG_READ_FUNC(tpidr_el2)
 #endif
 
 #endif  /* PAL_SYSREG_H */
@@ -35,6 +35,7 @@ UINT64 pal_get_acpi_table_ptr(UINT32 table_signature);
 extern VOID* g_acs_log_file_handle;
 extern UINT32 g_curr_module;
 extern UINT32 g_enable_module;
+extern UINT64 g_psci_call_count;
 VOID pal_warn_not_implemented(const CHAR8 *api_name);
 
 #define PCIE_SUCCESS            0x00000000  /* Operation completed successfully */
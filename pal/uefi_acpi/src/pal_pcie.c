@@ -39,6 +39,20 @@ static EFI_ACPI_MEMORY_MAPPED_CONFIGURATION_BASE_ADDRESS_TABLE_HEADER *gMcfgHdr;
 UINT64
 pal_get_mcfg_ptr();
 
+/**
+  @brief  Registers the VAL ECAM resolver. Config accesses in this PAL
+          resolve ECAM on their own, so the resolver is not used.
+
+  @param  resolve  Resolver returning the ECAM base of a segment/bus
+
+  @return None
+**/
+VOID
+pal_pcie_set_ecam_resolver(UINT64 (*resolve)(UINT32 seg, UINT32 bus))
+{
+  (VOID) resolve;
+}
+
 /**
   @brief  Returns the PCI ECAM address from the ACPI MCFG Table address
 
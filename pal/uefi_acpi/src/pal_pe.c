@@ -487,6 +487,10 @@ pal_pe_install_esr(UINT32 ExceptionType,  VOID (*esr)(UINT64, VOID *))
 VOID
 pal_pe_call_smc(ARM_SMC_ARGS *ArmSmcArgs, INT32 Conduit)
 {
+  /* PSCI function IDs are 0x84000000-0x8400001F (SMC32) and 0xC4000000-0xC400001F (SMC64) */
+  if ((ArmSmcArgs->Arg0 & ~0x4000001FULL) == 0x84000000)
+    g_psci_call_count++;
+
   ArmCallSmc (ArmSmcArgs, Conduit);
 }
 
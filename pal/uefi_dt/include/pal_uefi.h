@@ -24,6 +24,7 @@
 extern VOID* g_acs_log_file_handle;
 extern UINT32 g_curr_module;
 extern UINT32 g_enable_module;
+extern UINT64 g_psci_call_count;
 VOID pal_warn_not_implemented(const CHAR8 *api_name);
 
 #define PCIE_SUCCESS            0x00000000  /* Operation completed successfully */
@@ -183,6 +183,20 @@ pal_mmio_write(UINT64 addr, UINT32 data)
   *(volatile UINT32 *)addr = data;
 }
 
+/**
+  @brief  Registers a function to run before every PAL print. PAL prints in
+          this PAL go straight to Print(), so the hook is not used.
+
+  @param  hook  Function to run, NULL for none
+
+  @return None
+**/
+VOID
+pal_print_set_sync_hook(VOID (*hook)(VOID))
+{
+  (VOID) hook;
+}
+
 /**
   @brief  Sends a formatted string to the output console
 
@@ -48,6 +48,20 @@ PCIE_INFO_TABLE *g_pal_pcie_info_table;
 UINT64
 pal_get_mcfg_ptr();
 
+/**
+  @brief  Registers the VAL ECAM resolver. Config accesses in this PAL
+          resolve ECAM on their own, so the resolver is not used.
+
+  @param  resolve  Resolver returning the ECAM base of a segment/bus
+
+  @return None
+**/
+VOID
+pal_pcie_set_ecam_resolver(UINT64 (*resolve)(UINT32 seg, UINT32 bus))
+{
+  (VOID) resolve;
+}
+
 /**
   @brief  Returns the PCI ECAM address from the ACPI MCFG Table address
 
@@ -31,6 +31,7 @@
 static uint32_t irq_pending;
 static uint32_t lpi_int_id = 0x204C;
 static uint32_t instance;
+static uint32_t current_int_id;
 
 static
 void
@@ -39,11 +40,69 @@ intr_handler(void)
   /* Clear the interrupt pending state */
   irq_pending = 0;
 
-  val_print(TRACE, "\n       Received MSI interrupt %x       ", lpi_int_id + instance);
-  val_gic_end_of_interrupt(lpi_int_id + instance);
+  val_print(TRACE, "\n       Received MSI interrupt %x       ", current_int_id);
+  val_gic_end_of_interrupt(current_int_id);
   return;
 }
 
+/* Maps the MSIs of a set of exercisers in one ITS batch, and checks that a PE
+   write to GITS_TRANSLATER raises none of them. Returns 0, or the failing check. */
+static
+uint32_t
+check_msi_batch(GIC_MSI_REQUEST *req, uint32_t num_req)
+{
+  uint32_t i;
+  uint32_t timeout;
+  uint64_t its_base = 0;
+  uint32_t status = 0;
+
+  val_print(DEBUG, "\n       Mapping the MSIs of %d exercisers", num_req);
+  if (val_gic_request_msi_batch(req, num_req)) {
+      val_print(ERROR, "\n       MSI Assignment failed for %d exercisers", num_req);
+      return 2;
+  }
+
+  for (i = 0; i < num_req && !status; i++)
+  {
+    if (val_gic_install_isr(req[i].int_id, intr_handler)) {
+        val_print(ERROR,
+            "\n       Intr handler registration failed Interrupt : 0x%x", req[i].int_id);
+        status = 3;
+        break;
+    }
+
+    /* Get ITS Base for current ITS */
+    if (val_gic_its_get_base(req[i].its_id, &its_base)) {
+        val_print(ERROR,
+            "\n       Could not find ITS Base for its_id : 0x%x", req[i].its_id);
+        status = 4;
+        break;
+    }
+
+    /* Set the interrupt trigger status to pending */
+    current_int_id = req[i].int_id;
+    irq_pending = 1;
+
+    /* Trigger the interrupt by writing to GITS_TRANSLATER from PE */
+    val_mmio_write(its_base + GITS_TRANSLATER, req[i].int_id - ARM_LPI_MINID);
+
+    /* PE busy polls to check the completion of interrupt service routine */
+    timeout = TIMEOUT_MEDIUM;
+    while ((--timeout > 0) && irq_pending)
+        {};
+
+    /* Interrupt must not be generated */
+    if (irq_pending == 0) {
+        val_print(ERROR,
+            "\n       Interrupt triggered from PE for bdf : 0x%x, ", req[i].bdf);
+        status = 5;
+    }
+  }
+
+  val_gic_free_msi_batch(req, num_req);
+  return status;
+}
+
 static
 void
 payload (void)
@@ -51,18 +110,17 @@ payload (void)
 
   uint32_t index;
   uint32_t e_bdf = 0;
-  uint32_t timeout;
   uint32_t status;
   uint32_t num_cards;
   uint32_t num_smmus;
+  uint32_t num_req = 0;
   uint32_t test_skip = 1;
-  uint32_t msi_index = 0;
   uint32_t msi_cap_offset = 0;
 
   uint32_t device_id = 0;
   uint32_t stream_id = 0;
   uint32_t its_id = 0;
-  uint64_t its_base = 0;
+  GIC_MSI_REQUEST req[MAX_EXERCISER_CARDS];
 
   index = val_pe_get_index_mpid (val_pe_get_mpid());
 
@@ -80,6 +138,7 @@ payload (void)
   for (instance = 0; instance < num_smmus; ++instance)
      val_smmu_disable(instance);
 
+  /* The MSIs of up to MAX_EXERCISER_CARDS exercisers are mapped by one ITS batch */
   for (instance = 0; instance < num_cards; instance++)
   {
 
@@ -111,52 +170,29 @@ payload (void)
         return;
     }
 
-    status = val_gic_request_msi(e_bdf, device_id, its_id, lpi_int_id + instance, msi_index);
-    if (status) {
-        val_print(ERROR,
-            "\n       MSI Assignment failed for bdf : 0x%x", e_bdf);
-        val_set_status(index, RESULT_FAIL(2));
-        return;
-    }
-
-    status = val_gic_install_isr(lpi_int_id + instance, intr_handler);
-
-    if (status) {
-        val_print(ERROR,
-            "\n       Intr handler registration failed Interrupt : 0x%x", lpi_int_id + instance);
-        val_set_status(index, RESULT_FAIL(3));
-        return;
-    }
-
-    /* Set the interrupt trigger status to pending */
-    irq_pending = 1;
-
-    /* Get ITS Base for current ITS */
-    if (val_gic_its_get_base(its_id, &its_base)) {
-        val_print(ERROR,
-            "\n       Could not find ITS Base for its_id : 0x%x", its_id);
-        val_set_status(index, RESULT_FAIL(4));
-        return;
-    }
-
-    /* Trigger the interrupt by writing to GITS_TRANSLATER from PE */
-    val_mmio_write(its_base + GITS_TRANSLATER, (lpi_int_id - ARM_LPI_MINID) + instance);
-
-    /* PE busy polls to check the completion of interrupt service routine */
-    timeout = TIMEOUT_MEDIUM;
-    while ((--timeout > 0) && irq_pending)
-        {};
-
-    /* Interrupt must not be generated */
-    if (irq_pending == 0) {
-        val_print(ERROR,
-            "\n       Interrupt triggered from PE for bdf : 0x%x, ", e_bdf);
-        val_set_status(index, RESULT_FAIL(5));
-        val_gic_free_msi(e_bdf, device_id, its_id, lpi_int_id + instance, msi_index);
-        return;
+    req[num_req].bdf = e_bdf;
+    req[num_req].device_id = device_id;
+    req[num_req].its_id = its_id;
+    req[num_req].int_id = lpi_int_id + instance;
+    req[num_req].msi_index = 0;
+    num_req++;
+
+    if (num_req == MAX_EXERCISER_CARDS) {
+        status = check_msi_batch(req, num_req);
+        if (status) {
+            val_set_status(index, RESULT_FAIL(status));
+            return;
+        }
+        num_req = 0;
     }
+  }
 
-    val_gic_free_msi(e_bdf, device_id, its_id, lpi_int_id + instance, msi_index);
+  if (num_req) {
+      status = check_msi_batch(req, num_req);
+      if (status) {
+          val_set_status(index, RESULT_FAIL(status));
+          return;
+      }
   }
 
   if (test_skip) {
@@ -27,6 +27,8 @@
 #define TEST_RULE  ""
 
 #define MBWMAX_SCENARIO_MAX 10
+/* PEs copying the buffer together, so that the PARTID can reach its bandwidth limit */
+#define MBWMAX_TRAFFIC_STREAMS 4
 static uint64_t mpam2_el2_temp;
 
 typedef struct {
@@ -79,6 +81,70 @@ get_buffer_size(uint32_t msc_index, uint32_t rsrc_index, uint64_t addr_len, uint
     return buffer_size;
 }
 
+/* Copy src to dst with up to MBWMAX_TRAFFIC_STREAMS PEs, each moving its own slice
+   of the buffers under the given PARTID. The slices are whole traffic blocks; the
+   primary PE, which runs under the same PARTID, copies the remaining tail so that
+   the MBWU monitor still sees the whole buffer. Returns the status of the traffic run. */
+static
+uint32_t
+mbwmax_copy(void *dst, void *src, uint64_t size, uint16_t partid, uint32_t pe_index)
+{
+    MEM_TRAFFIC_STREAM_t streams[MBWMAX_TRAFFIC_STREAMS];
+    uint32_t num_pe = val_pe_get_num();
+    uint32_t num_streams;
+    uint32_t pe;
+    uint32_t i;
+    uint64_t slice;
+    uint64_t copied;
+    uint64_t total_bw = 0;
+    uint32_t status;
+
+    num_streams = GET_MIN_VALUE(num_pe, MBWMAX_TRAFFIC_STREAMS);
+    slice = (size / num_streams) & ~((uint64_t)MEM_TRAFFIC_ALIGN - 1);
+    if (slice == 0) {
+        num_streams = 1;
+        slice = size & ~((uint64_t)MEM_TRAFFIC_ALIGN - 1);
+    }
+
+    val_memory_set(streams, sizeof(streams), 0);
+    for (i = 0, pe = 0; i < num_streams; i++) {
+        /* The primary PE takes the first slice, other PEs the rest */
+        if (i == 0) {
+            streams[i].pe_index = pe_index;
+        } else {
+            if (pe == pe_index)
+                pe++;
+            streams[i].pe_index = pe++;
+        }
+        streams[i].type = MEM_TRAFFIC_COPY;
+        streams[i].partid = partid;
+        streams[i].pmg = DEFAULT_PMG;
+        streams[i].src = (uint64_t)src + i * slice;
+        streams[i].dst = (uint64_t)dst + i * slice;
+        streams[i].size = slice;
+        streams[i].passes = 1;
+    }
+
+    if (slice) {
+        status = val_mem_traffic_run(streams, num_streams);
+        if (status != ACS_STATUS_PASS)
+            return status;
+    }
+
+    /* Less than num_streams traffic blocks are left over */
+    copied = num_streams * slice;
+    if (copied < size)
+        val_memcpy((uint8_t *)dst + copied, (uint8_t *)src + copied, (uint32_t)(size - copied));
+
+    for (i = 0; i < num_streams; i++)
+        total_bw += streams[i].bytes_per_sec;
+
+    val_print(DEBUG, "\n       %d PE(s) copied", num_streams);
+    val_print(DEBUG, " at %lld MB/s", total_bw / (1024 * 1024));
+
+    return ACS_STATUS_PASS;
+}
+
 static
 void payload(void)
 {
@@ -287,7 +353,18 @@ void payload(void)
                 val_print(INFO, "\n        Start count is %llx", start_count);
 
                 /* perform memory operation */
-                val_memcpy(src_buf, dest_buf, buf_size);
+                if (mbwmax_copy(src_buf, dest_buf, buf_size, minmax_partid, pe_index)) {
+                    val_print(ERROR, "\n       Buffer copy did not complete");
+                    val_set_status(pe_index, RESULT_FAIL(03));
+
+                    val_mpam_memory_mbwumon_disable(msc_index);
+                    val_mem_free_at_address((uint64_t)src_buf, buf_size);
+                    val_mem_free_at_address((uint64_t)dest_buf, buf_size);
+
+                    /* Restore MPAM2_EL2 settings */
+                    val_mpam_reg_write(MPAM2_EL2, mpam2_el2_temp);
+                    return;
+                }
                 /* Wait for some time before the memcpy settles and counters update */
                 val_time_delay_ms(TIMEOUT_MEDIUM);
 
@@ -23,6 +23,11 @@
 #include "acs_val.h"
 #include "val_interface.h"
 #include "acs_nist.h"
+#include "acs_memory.h"
+#include "acs_execution_policy.h"
+#include "val_libc.h"
+#include "val_sysreg.h"
+#include "val_memops.h"
 
 #define TEST_NUM   (ACS_NIST_TEST_NUM_BASE + 1)
 #define TEST_RULE "S_L7ENT_1"
@@ -35,6 +40,7 @@
 #define NIST_SUITE_1    0xFE
 #define NIST_SUITE_2    0xDE00   /* Test 1 - 7 */
 #define MIN_NIST_TEST   0x0000   /* Test 9 - 12, 13 - 14 */
+#define NIST_MEM_NUM_SEQ 10      /* Sequences tested by the in-memory pipeline */
 
 extern int main(int argc, char *argv[]);
 
@@ -172,6 +178,312 @@ create_random_file(void)
   val_print(TRACE, "\nA random file with sequence of ASCII 0's and 1's created");
   return ACS_STATUS_PASS;
 }
+
+/* Control block of one PE of the in-memory run, on cache lines of its own */
+typedef struct {
+  uint64_t words;      /* first sequence of the batch */
+  uint64_t stride;     /* words from one sequence to the next */
+  uint64_t count;      /* pattern count table of the PE */
+  uint64_t slot;       /* result slots of the batch */
+  uint32_t num_bits;
+  uint32_t first;      /* first sequence tested by the PE */
+  uint32_t step;       /* sequences between two tested by the PE */
+  uint32_t num_seq;    /* sequences in the batch */
+  volatile uint32_t done;
+  uint32_t reserved;
+  uint8_t  pad[72];
+} NIST_MEM_CTL_t;
+
+/* Result of one sequence, padded so that two PEs never write the same line */
+typedef struct {
+  NIST_STREAM_RESULT_t result;
+  volatile uint32_t    done;
+  uint32_t             status;
+  uint8_t              pad[48];
+} NIST_MEM_SLOT_t;
+
+#define NIST_MEM_LINE         64
+/* Time allowed for a batch: a fixed part plus one second per 8 Mbit per sequence */
+#define NIST_MEM_TIMEOUT_SEC  60
+
+static
+void
+nist_mem_sync(void *addr, uint32_t size, uint32_t type)
+{
+  uint32_t offset;
+
+  for (offset = 0; offset < size; offset += NIST_MEM_LINE)
+      val_data_cache_ops_by_va((addr_t)addr + offset, type);
+}
+
+/* The kernels use floating point. The PE must implement it and not trap it
+ * at EL2. Traps to EL3 cannot be read from here: EL3 firmware configures them
+ * alike on every PE and the primary PE already ran the kernel self check, so a
+ * PE that still traps stops answering and fails the batch on its timeout.
+ */
+static
+uint32_t
+nist_mem_fp_usable(void)
+{
+  if (val_pe_feat_check(PE_FEAT_ADVSIMD) != ACS_STATUS_PASS)
+      return 0;
+
+  return (uint32_t)(MemOpsSimdAccess() & 1);
+}
+
+/* Test the sequences of one PE. A PE that cannot use floating point leaves its
+ * sequences undone and the primary PE tests them instead.
+ */
+static
+void
+nist_mem_worker(NIST_MEM_CTL_t *ctl)
+{
+  NIST_MEM_SLOT_t *slot = (NIST_MEM_SLOT_t *)ctl->slot;
+  uint32_t seq;
+
+  if (nist_mem_fp_usable()) {
+      for (seq = ctl->first; seq < ctl->num_seq; seq += ctl->step) {
+          slot[seq].status = val_nist_stream_test((uint64_t *)ctl->words + seq * ctl->stride,
+                                                  ctl->num_bits, (uint32_t *)ctl->count,
+                                                  &slot[seq].result);
+          slot[seq].done = 1;
+          nist_mem_sync(&slot[seq], sizeof(NIST_MEM_SLOT_t), CLEAN_AND_INVALIDATE);
+      }
+  }
+
+  ctl->done = 1;
+  nist_mem_sync(ctl, sizeof(NIST_MEM_CTL_t), CLEAN_AND_INVALIDATE);
+}
+
+/* Secondary PE entry point, the control block address is passed as test data */
+static
+void
+nist_mem_payload(void)
+{
+  uint64_t data0, ctl_addr;
+  uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
+
+  val_get_test_data(index, &data0, &ctl_addr);
+  nist_mem_sync((void *)ctl_addr, sizeof(NIST_MEM_CTL_t), INVALIDATE);
+  nist_mem_worker((NIST_MEM_CTL_t *)ctl_addr);
+}
+
+/**
+  @brief   Test one batch of sequences on up to num_workers PEs, the primary PE
+           being worker 0. Sequences left undone by a worker are tested on the
+           primary PE.
+
+  @return  ACS_STATUS_PASS, or ACS_STATUS_FAIL if a PE did not complete in time.
+           Its control blocks may still be written and must not be reused.
+**/
+static
+uint32_t
+nist_mem_run_batch(NIST_MEM_CTL_t *ctl, NIST_MEM_SLOT_t *slot, uint32_t *count,
+                   const uint32_t *pe_index, uint32_t num_workers, uint64_t *words,
+                   uint64_t stride, uint32_t num_bits, uint32_t num_seq)
+{
+  uint32_t w, seq, pending;
+  uint64_t deadline, per_pe;
+
+  if (num_workers > num_seq)
+      num_workers = num_seq;
+
+  val_memory_set(slot, num_seq * sizeof(NIST_MEM_SLOT_t), 0);
+  nist_mem_sync(slot, num_seq * sizeof(NIST_MEM_SLOT_t), CLEAN_AND_INVALIDATE);
+
+  for (w = 0; w < num_workers; w++) {
+      ctl[w].words = (uint64_t)words;
+      ctl[w].stride = stride;
+      ctl[w].count = (uint64_t)(count + w * NIST_PATTERN_ENTRIES);
+      ctl[w].slot = (uint64_t)slot;
+      ctl[w].num_bits = num_bits;
+      ctl[w].first = w;
+      ctl[w].step = num_workers;
+      ctl[w].num_seq = num_seq;
+      ctl[w].done = 0;
+      nist_mem_sync(&ctl[w], sizeof(NIST_MEM_CTL_t), CLEAN_AND_INVALIDATE);
+  }
+
+  for (w = 1; w < num_workers; w++)
+      val_execute_on_pe_resident(pe_index[w], nist_mem_payload, (uint64_t)&ctl[w]);
+
+  nist_mem_worker(&ctl[0]);
+
+  per_pe = (num_seq + num_workers - 1) / num_workers;
+  deadline = virtualcounter_read() + val_get_counter_frequency() *
+             (NIST_MEM_TIMEOUT_SEC + per_pe * (num_bits >> 23));
+  do {
+      pending = 0;
+      for (w = 1; w < num_workers; w++) {
+          nist_mem_sync(&ctl[w], sizeof(NIST_MEM_CTL_t), INVALIDATE);
+          if (!ctl[w].done)
+              pending++;
+      }
+  } while (pending && (virtualcounter_read() < deadline));
+
+  if (pending) {
+      val_print(ERROR, "\n       %d PE(s) did not complete the NIST batch", pending);
+      return ACS_STATUS_FAIL;
+  }
+
+  for (seq = 0; seq < num_seq; seq++) {
+      nist_mem_sync(&slot[seq], sizeof(NIST_MEM_SLOT_t), INVALIDATE);
+      if (!slot[seq].done)
+          slot[seq].status = val_nist_stream_test(words + seq * stride, num_bits, count,
+                                                  &slot[seq].result);
+  }
+
+  return ACS_STATUS_PASS;
+}
+
+/**
+  @brief   Run the in-memory STS tests on NIST_MEM_NUM_SEQ packed sequences and
+           apply the STS proportion rule to every statistic. The primary PE
+           generates a batch of sequences, one per PE, and the PEs test them in
+           parallel.
+
+  @return  ACS_STATUS_PASS, ACS_STATUS_FAIL, or ACS_STATUS_SKIP when the PAL has
+           no RNG or the buffers cannot be allocated.
+**/
+static
+int32_t
+nist_run_in_memory(uint32_t num_bits)
+{
+  NIST_MEM_CTL_t  *ctl = NULL;
+  NIST_MEM_SLOT_t *slot;
+  NIST_STREAM_RESULT_t *result;
+  uint64_t *words;
+  uint64_t  stride = NIST_STREAM_ALLOC_WORDS(num_bits), start;
+  uint32_t *count;
+  uint32_t  pe_index[NIST_MEM_NUM_SEQ];
+  uint32_t  seq, base, stat, threshold, p_scaled, batch, num_workers, num_pe, my_index, i;
+  uint32_t  passed[NIST_STAT_COUNT] = {0}, tested[NIST_STAT_COUNT] = {0};
+  double    p_min[NIST_STAT_COUNT], p_hat = 1.0 - NIST_ALPHA;
+  int32_t   status;
+
+  /* The word-parallel kernels must match the bit-serial STS computation */
+  status = val_nist_stream_self_check();
+  if (status != ACS_STATUS_PASS) {
+      val_print(ERROR, "\n       NIST kernel self check failed");
+      return (status == ACS_STATUS_FAIL) ? ACS_STATUS_FAIL : ACS_STATUS_SKIP;
+  }
+
+  /* One sequence per PE and batch, within the 32-bit allocation size */
+  num_pe = val_pe_get_num();
+  batch = (num_pe < NIST_MEM_NUM_SEQ) ? num_pe : NIST_MEM_NUM_SEQ;
+  if ((uint64_t)batch * stride * sizeof(uint64_t) > 0xFFFFFFFFULL)
+      batch = (uint32_t)(0xFFFFFFFFULL / (stride * sizeof(uint64_t)));
+  num_workers = batch;
+
+  my_index = val_pe_get_index_mpid(val_pe_get_mpid());
+  pe_index[0] = my_index;
+  for (i = 0, seq = 1; seq < num_workers; i++)
+      if (i != my_index)
+          pe_index[seq++] = i;
+
+  words = val_memory_alloc(batch * stride * sizeof(uint64_t));
+  ctl = val_aligned_alloc(NIST_MEM_LINE, num_workers * sizeof(NIST_MEM_CTL_t) +
+                          batch * sizeof(NIST_MEM_SLOT_t) +
+                          num_workers * NIST_PATTERN_ENTRIES * sizeof(uint32_t));
+  if ((words == NULL) || (ctl == NULL)) {
+      val_print(ERROR, "\n       Unable to allocate the NIST stream buffers");
+      status = ACS_STATUS_SKIP;
+      goto free_buffers;
+  }
+  slot = (NIST_MEM_SLOT_t *)&ctl[num_workers];
+  count = (uint32_t *)&slot[batch];
+
+  for (stat = 0; stat < NIST_STAT_COUNT; stat++)
+      p_min[stat] = 1.0;
+
+  val_print(TRACE, "\n       In-memory NIST STS, %d sequences", NIST_MEM_NUM_SEQ);
+  val_print(TRACE, " of %d bits", num_bits);
+  val_print(TRACE, " on %d PE(s)", num_workers);
+
+  start = virtualcounter_read();
+  for (base = 0; base < NIST_MEM_NUM_SEQ; base += batch) {
+      if (batch > NIST_MEM_NUM_SEQ - base)
+          batch = NIST_MEM_NUM_SEQ - base;
+
+      /* The RNG is only used on the primary PE */
+      for (seq = 0; seq < batch; seq++) {
+          status = val_nist_generate_stream(words + seq * stride, num_bits);
+          if (status == NOT_IMPLEMENTED) {
+              val_print(ERROR, "\n       PAL API pal_nist_generate_rng is unimplemented");
+              val_print(ERROR, "\n       Implement the PAL API for the test to run");
+              status = ACS_STATUS_SKIP;
+              goto free_buffers;
+          }
+
+          if (status != ACS_STATUS_PASS) {
+              val_print(ERROR, "\n       Random number generation failed");
+              status = ACS_STATUS_FAIL;
+              goto free_buffers;
+          }
+      }
+
+      if (nist_mem_run_batch(ctl, slot, count, pe_index, num_workers, words, stride,
+                             num_bits, batch) != ACS_STATUS_PASS) {
+          /* A late PE may still read the stream and write its blocks, keep them */
+          ctl = NULL;
+          words = NULL;
+          status = ACS_STATUS_FAIL;
+          goto free_buffers;
+      }
+
+      for (seq = 0; seq < batch; seq++) {
+          if (slot[seq].status != ACS_STATUS_PASS) {
+              status = ACS_STATUS_FAIL;
+              goto free_buffers;
+          }
+
+          result = &slot[seq].result;
+          for (stat = 0; stat < NIST_STAT_COUNT; stat++) {
+              if (result->p_value[stat] < 0)
+                  continue;
+              tested[stat]++;
+              if (result->p_value[stat] >= NIST_ALPHA)
+                  passed[stat]++;
+              if (result->p_value[stat] < p_min[stat])
+                  p_min[stat] = result->p_value[stat];
+          }
+      }
+  }
+
+  val_print(TRACE, "\n       Generated and tested in %d ms",
+            (uint32_t)(((virtualcounter_read() - start) * 1000) / val_get_counter_frequency()));
+
+  /* Minimum pass proportion of the STS final analysis report */
+  status = ACS_STATUS_PASS;
+  for (stat = 0; stat < NIST_STAT_COUNT; stat++) {
+      if (tested[stat] == 0)
+          continue;
+
+      threshold = (uint32_t)((p_hat - 3.0 * sqrt((p_hat * NIST_ALPHA) / tested[stat])) *
+                             tested[stat]);
+      /* val_print has no floating point conversion, print p with six decimals */
+      p_scaled = (uint32_t)(p_min[stat] * 1000000.0 + 0.5);
+      val_print(TRACE, "\n       %2d/", passed[stat]);
+      val_print(TRACE, "%-2d  min p ", tested[stat]);
+      val_print(TRACE, "%d.", p_scaled / 1000000);
+      val_print(TRACE, "%06d  ", p_scaled % 1000000);
+      val_print(TRACE, "%s", val_nist_stream_stat_name(stat));
+
+      if (passed[stat] < threshold) {
+          val_print(ERROR, "\n       NIST %s below the minimum pass proportion",
+                    val_nist_stream_stat_name(stat));
+          status = ACS_STATUS_FAIL;
+      }
+  }
+
+free_buffers:
+  if (words)
+      val_memory_free(words);
+  if (ctl)
+      val_memory_free_aligned(ctl);
+  return status;
+}
+
 static
 void
 payload()
@@ -182,6 +494,19 @@ payload()
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
   uint32_t test_list[] = {NIST_SUITE_1, NIST_SUITE_2};
   size_t   test_listsize = sizeof(test_list) / sizeof(test_list[0]);
+  uint32_t stream_bits = acs_policy_get_nist_stream_bits();
+
+  if (stream_bits) {
+      /* Packed in-memory sequences, no file system access */
+      status = nist_run_in_memory(stream_bits);
+      if (status == ACS_STATUS_PASS)
+          val_set_status(index, RESULT_PASS);
+      else if (status == ACS_STATUS_SKIP)
+          val_set_status(index, RESULT_SKIP(06));
+      else
+          val_set_status(index, RESULT_FAIL(01));
+      return;
+  }
 
   status = check_prerequisite_nist();
   if (status != ACS_STATUS_PASS) {
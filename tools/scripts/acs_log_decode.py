@@ -0,0 +1,397 @@
+## @file
+ # Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ # SPDX-License-Identifier : Apache-2.0
+ #
+ # Licensed under the Apache License, Version 2.0 (the "License");
+ # you may not use this file except in compliance with the License.
+ # You may obtain a copy of the License at
+ #
+ #  http://www.apache.org/licenses/LICENSE-2.0
+ #
+ # Unless required by applicable law or agreed to in writing, software
+ # distributed under the License is distributed on an "AS IS" BASIS,
+ # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ # See the License for the specific language governing permissions and
+ # limitations under the License.
+ ##
+
+"""Decode ACS binary log output (-binlog) back into text.
+
+The ACS image records TRACE/DEBUG messages as binary records holding the
+run-time address of the format string and the raw arguments. The records are
+printed in call order with the text output, as lines of the form
+
+    @ACSBIN anchor=<hex address of val_printf> primary=<index of the primary PE>
+    @ACSBIN <pe>+<base64>     records continue on the next line
+    @ACSBIN <pe>:<base64>     last line of a run of records
+    @ACSBIN <pe> dropped=<n>
+
+See the binary trace mode comment in val/src/val_logger.c for the record
+layout. This script copies the console log to stdout, replacing the lines
+above with the formatted messages. Format strings are read from the ELF image
+the ACS binary was built from; the anchor maps run-time addresses to ELF
+addresses.
+
+Usage: acs_log_decode.py <acs elf image> <console log> [-o output]
+"""
+
+import argparse
+import base64
+import re
+import struct
+import sys
+
+MARKER = "@ACSBIN"
+ANCHOR_RE = re.compile(MARKER + r" anchor=([0-9a-fA-F]+) primary=(\d+)")
+RUN_RE = re.compile(MARKER + r" (\d+)([+:])([A-Za-z0-9+/=]*)")
+DROPPED_RE = re.compile(MARKER + r" (\d+) dropped=(\d+)")
+TAG_RE = re.compile(r"PE(\d+): ")
+ANCHOR_SYMBOL = "val_printf"
+
+# Prefixes printed by val_printf at the start of a line, per verbosity
+PREFIX = {1: "\t", 2: "\t", 3: "", 4: "\tWARN : ", 5: "\tERROR: ", 6: "\tFATAL: "}
+
+
+class ElfImage:
+    """Minimal ELF64 little-endian reader: loadable sections and the symbol table."""
+
+    def __init__(self, path):
+        with open(path, "rb") as elf_file:
+            self.data = elf_file.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 2 or self.data[5] != 1:
+            raise ValueError(f"{path}: not a little-endian ELF64 image")
+
+        (shoff,) = struct.unpack_from("<Q", self.data, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x3A)
+        self.sections = []
+        for index in range(shnum):
+            fields = struct.unpack_from("<IIQQQQIIQQ", self.data, shoff + index * shentsize)
+            self.sections.append(fields)
+        self.symbols = self._read_symbols()
+
+    def _read_symbols(self):
+        symbols = {}
+        for (_name, sh_type, _flags, _addr, offset, size, link, _info, _align,
+             entsize) in self.sections:
+            if sh_type not in (2, 11):    # SHT_SYMTAB, SHT_DYNSYM
+                continue
+            strtab = self.sections[link]
+            for pos in range(offset, offset + size, entsize or 24):
+                st_name, _st_info, _other, _shndx, value, _size = struct.unpack_from(
+                    "<IBBHQQ", self.data, pos)
+                name = self._cstring(strtab[4] + st_name)
+                if name:
+                    symbols.setdefault(name, value)
+        return symbols
+
+    def _cstring(self, offset):
+        end = self.data.find(b"\0", offset)
+        return self.data[offset:end].decode("latin-1")
+
+    def string_at(self, addr):
+        """Return the NUL-terminated string at an ELF virtual address, or None."""
+        for (_name, sh_type, flags, sec_addr, offset, size, _link, _info, _align,
+             _entsize) in self.sections:
+            # Allocated sections with file contents (SHT_NOBITS is 8)
+            if not flags & 0x2 or sh_type == 8:
+                continue
+            if sec_addr <= addr < sec_addr + size:
+                start = offset + (addr - sec_addr)
+                end = self.data.find(b"\0", start, offset + size)
+                if end < 0:
+                    end = offset + size
+                return self.data[start:end].decode("latin-1")
+        return None
+
+
+def parse_spec(fmt, pos):
+    """Parse one conversion after '%'. Returns (flags, star, width, mod, conv, pos)."""
+    flags = set()
+    while pos < len(fmt) and fmt[pos] in "-+ #0":
+        flags.add(fmt[pos])
+        pos += 1
+    star = False
+    width = 0
+    if pos < len(fmt) and fmt[pos] == "*":
+        star = True
+        pos += 1
+    else:
+        while pos < len(fmt) and fmt[pos].isdigit():
+            width = width * 10 + int(fmt[pos])
+            pos += 1
+    mod = ""
+    for candidate in ("hh", "h", "ll", "l", "j", "z", "t"):
+        if fmt.startswith(candidate, pos):
+            mod = candidate
+            pos += len(candidate)
+            break
+    conv = fmt[pos] if pos < len(fmt) else ""
+    return flags, star, width, mod, conv, pos + 1
+
+
+def pad(prefix, digits, width, flags, fill):
+    """Apply the padding rules of print_string() in val_logger.c."""
+    total = len(prefix) + len(digits)
+    if "-" in flags:
+        return prefix + digits + " " * max(0, width - total)
+    if fill == " ":
+        return " " * max(0, width - total) + prefix + digits
+    return prefix + fill * max(0, width - total) + digits
+
+
+def format_int(value, conv, mod, width, flags):
+    bits = {"hh": 8, "h": 16, "l": 64, "ll": 64}.get(mod, 32)
+    value &= (1 << bits) - 1
+    sign = ""
+    if conv in "di":
+        if value >> (bits - 1):
+            value = (1 << bits) - value
+            sign = "-"
+    base = {"b": 2, "B": 2, "o": 8, "x": 16, "X": 16, "p": 16}.get(conv, 10)
+    digits = ""
+    while True:
+        digits = "0123456789abcdef"[value % base] + digits
+        value //= base
+        if not value:
+            break
+    prefix = ""
+    if "#" in flags:
+        prefix = {16: "0x", 2: "0b", 8: "0"}.get(base, "")
+    if conv in "XB":
+        digits = digits.upper()
+        prefix = prefix.upper()
+    if not sign:
+        sign = "+" if "+" in flags else (" " if " " in flags else "")
+    return pad(sign + prefix, digits, width, flags, "0" if "0" in flags else " ")
+
+
+def format_record(fmt, values, strings):
+    """Render a record the way val_log() would have rendered the call.
+
+    Returns None for a format val_log() rejects, as val_printf() then prints
+    nothing at all.
+    """
+    out = []
+    pos = 0
+    args = iter(values)
+    strs = iter(strings)
+    while pos < len(fmt):
+        char = fmt[pos]
+        if char != "%":
+            out.append(char)
+            pos += 1
+            continue
+        flags, star, width, mod, conv, pos = parse_spec(fmt, pos + 1)
+        if star:
+            width = next(args, 0)
+            if width >= 1 << 63:
+                width = (1 << 64) - width
+                flags.add("-")
+        if mod in ("j", "z", "t"):
+            return None
+        if conv == "%":
+            out.append("%")
+        elif conv == "s":
+            next(args, 0)
+            out.append(pad("", next(strs, ""), width, flags, " "))
+        elif conv == "c":
+            out.append(pad("", chr(next(args, 0) & 0xFF), width, flags, " "))
+        elif conv == "p":
+            out.append(format_int(next(args, 0), "p", "l", 18, flags | {"#", "0"}))
+        elif conv and conv in "diuxXoBb":
+            out.append(format_int(next(args, 0), conv, mod, width, flags))
+        else:
+            return None
+    return "".join(out)
+
+
+def read_varint(blob, pos):
+    """Read one LEB128 varint. Returns (value, new position)."""
+    value = 0
+    shift = 0
+    while True:
+        byte = blob[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def unzigzag(value):
+    """Undo zigzag encoding, returning the 64-bit two's complement value."""
+    return ((value >> 1) ^ -(value & 1)) & 0xFFFFFFFFFFFFFFFF
+
+
+def arg_kinds(fmt, num_args):
+    """Return the kind of each argument slot of a record: 's', 'signed' or 'unsigned'."""
+    kinds = []
+    pos = 0
+    while pos < len(fmt) and len(kinds) < num_args:
+        if fmt[pos] != "%":
+            pos += 1
+            continue
+        _flags, star, _width, mod, conv, pos = parse_spec(fmt, pos + 1)
+        if star:
+            kinds.append("signed")
+            if len(kinds) >= num_args:
+                break
+        if mod in ("j", "z", "t") or not conv:
+            break
+        if conv == "%":
+            continue
+        if conv == "s":
+            kinds.append("s")
+        elif conv in "cdi":
+            kinds.append("signed")
+        else:
+            kinds.append("unsigned")
+    return kinds
+
+
+def decode_records(elf, anchor, blob):
+    """Yield (verbosity, text, format string) for every record of a run."""
+    delta = elf.symbols[ANCHOR_SYMBOL] - anchor
+    pos = 0
+    while pos < len(blob):
+        size, pos = read_varint(blob, pos)
+        end = pos + size
+        head = blob[pos]
+        verbosity, num_args = head >> 5, head & 0x1F
+        fmt_offset, arg_pos = read_varint(blob, pos + 1)
+        _timestamp_delta, arg_pos = read_varint(blob, arg_pos)
+        fmt_addr = (anchor + unzigzag(fmt_offset)) & 0xFFFFFFFFFFFFFFFF
+        fmt = elf.string_at((fmt_addr + delta) & 0xFFFFFFFFFFFFFFFF)
+        if fmt is None:
+            yield verbosity, f"<unresolved format string 0x{fmt_addr:x}>\n", None
+            pos = end
+            continue
+
+        values = []
+        strings = []
+        for kind in arg_kinds(fmt, num_args):
+            value, arg_pos = read_varint(blob, arg_pos)
+            if kind == "s":
+                strings.append(blob[arg_pos:arg_pos + value].decode("latin-1"))
+                arg_pos += value
+            elif kind == "signed":
+                value = unzigzag(value)
+            values.append(value)
+        yield verbosity, format_record(fmt, values, strings), fmt
+        pos = end
+
+
+class LineState:
+    """Tracks the val_printf line-prefix state of one PE stream."""
+
+    def __init__(self):
+        self.at_line_start = True
+
+    def skip(self, fmt):
+        """Update the state for a call val_printf() rejected without output."""
+        self.at_line_start = fmt.endswith("\n")
+
+    def render(self, verbosity, text, tag):
+        out = []
+        while text.startswith("\n"):
+            out.append("\r\n")
+            self.at_line_start = True
+            text = text[1:]
+        if not text:
+            return "".join(out)
+        if self.at_line_start:
+            out.append(tag + PREFIX.get(verbosity, ""))
+        self.at_line_start = text.endswith("\n")
+        out.append(text.replace("\r\n", "\n").replace("\n", "\r\n"))
+        return "".join(out)
+
+
+def decode_log(elf, lines, output):
+    states = {}
+    pending = {}
+    text_seen = set()
+    open_pe = None
+    anchor = None
+    primary = None
+
+    for line in lines:
+        stripped = line.strip()
+
+        match = ANCHOR_RE.search(stripped)
+        if match:
+            anchor = int(match.group(1), 16)
+            primary = int(match.group(2))
+            continue
+
+        match = DROPPED_RE.search(stripped)
+        if match:
+            output.write(line[:line.index(MARKER)])
+            output.write(f"\tWARN : {match.group(2)} binary log records dropped "
+                         f"on PE{match.group(1)}\r\n")
+            continue
+
+        match = RUN_RE.search(stripped)
+        if not match:
+            output.write(line)
+            # Text of a PE since its last run of records. Secondary PE lines are
+            # tagged, unless they continue a line the records left open.
+            tag = TAG_RE.match(line)
+            if open_pe is not None:
+                text_seen.add(open_pe)
+            else:
+                text_seen.add(int(tag.group(1)) if tag else primary)
+            open_pe = None
+            continue
+
+        # Records go out in the middle of a line when a PE prints the rest later
+        before = line[:line.index(MARKER)]
+        output.write(before)
+
+        pe = int(match.group(1))
+        state = states.setdefault(pe, LineState())
+        if pe not in pending:
+            if before:
+                state.at_line_start = False
+            elif pe in text_seen:
+                state.at_line_start = True
+            text_seen.discard(pe)
+
+        pending[pe] = pending.get(pe, b"") + base64.b64decode(match.group(3))
+        if match.group(2) == "+":
+            continue
+        blob = pending.pop(pe)
+        if anchor is None:
+            output.write(f"<{len(blob)} bytes of PE{pe} records before the anchor line>\r\n")
+            continue
+        tag = "" if pe == primary else f"PE{pe}: "
+        for verbosity, text, fmt in decode_records(elf, anchor, blob):
+            if text is None:
+                state.skip(fmt)
+            else:
+                output.write(state.render(verbosity, text, tag))
+        open_pe = None if state.at_line_start else pe
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode ACS -binlog console dumps")
+    parser.add_argument("elf", help="ELF image of the ACS binary that produced the log")
+    parser.add_argument("log", help="console log containing @ACSBIN blocks")
+    parser.add_argument("-o", "--output", help="output file (default: stdout)")
+    args = parser.parse_args()
+
+    elf = ElfImage(args.elf)
+    if ANCHOR_SYMBOL not in elf.symbols:
+        sys.exit(f"{args.elf}: symbol {ANCHOR_SYMBOL} not found, image built without symbols?")
+
+    with open(args.log, "r", encoding="latin-1", newline="") as log_file:
+        lines = log_file.readlines()
+
+    if args.output:
+        with open(args.output, "w", encoding="latin-1", newline="") as out_file:
+            decode_log(elf, lines, out_file)
+    else:
+        decode_log(elf, lines, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,302 @@
+## @file
+ # Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ # SPDX-License-Identifier : Apache-2.0
+ #
+ # Licensed under the Apache License, Version 2.0 (the "License");
+ # you may not use this file except in compliance with the License.
+ # You may obtain a copy of the License at
+ #
+ #  http://www.apache.org/licenses/LICENSE-2.0
+ #
+ # Unless required by applicable law or agreed to in writing, software
+ # distributed under the License is distributed on an "AS IS" BASIS,
+ # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ # See the License for the specific language governing permissions and
+ # limitations under the License.
+ ##
+
+"""Summarise, compare or export ACS MMIO recordings.
+
+With a non-zero mmio_record execution policy the baremetal ACS image records
+every pal_mmio_* access in a memory ring and dumps it at the end of the run:
+
+    @ACSMMIO records=<n> total=<accesses seen> freq=<CNTFRQ>
+    <addr:16><value:16><timestamp:16><mpidr:8><width:2><flags:2>
+    @ACSMMIO end
+
+one hex line per access, oldest first. When total exceeds records the ring
+wrapped and only the most recent accesses are kept.
+
+Given one console log, the script summarises the trace per PE and per 4KB
+frame, or lists the accesses with --list. Given two, it replays the second
+trace against a register model built from the first and reports, per PE, the
+first access that differs in address, width or direction and every read that
+returned another value than the model predicts. --export writes the trace as
+a binary file of 32-byte little-endian records behind a 16-byte header
+("ACSMMIO1", record count, CNTFRQ), which the HOSTSIM build of the suite
+replays with -replay for the devices it does not model.
+
+Usage: acs_mmio_replay.py <log> [<new log>] [--pe MPIDR] [--range LO:HI]
+                          [--list] [--top N] [--export FILE]
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+MARKER = "@ACSMMIO"
+HEADER_RE = re.compile(MARKER + r" records=(\d+) total=(\d+) freq=(\d+)")
+END_RE = re.compile(MARKER + r" end")
+LINE_RE = re.compile(r"^([0-9a-fA-F]{16})([0-9a-fA-F]{16})([0-9a-fA-F]{16})"
+                     r"([0-9a-fA-F]{8})([0-9a-fA-F]{2})([0-9a-fA-F]{2})$")
+FILE_HDR = struct.Struct("<8sII")
+FILE_REC = struct.Struct("<QQQIBBH")
+FILE_MAGIC = b"ACSMMIO1"
+FLAG_WRITE = 0x1
+FRAME_SHIFT = 12
+
+
+class Access:
+    """One recorded MMIO access."""
+
+    __slots__ = ("addr", "value", "timestamp", "mpidr", "width", "write")
+
+    def __init__(self, addr, value, timestamp, mpidr, width, flags):
+        self.addr = addr
+        self.value = value
+        self.timestamp = timestamp
+        self.mpidr = mpidr
+        self.width = width
+        self.write = bool(flags & FLAG_WRITE)
+
+    def key(self):
+        """What must match between two runs executing the same code path."""
+        return (self.addr, self.width, self.write)
+
+    def __str__(self):
+        op = "W" if self.write else "R"
+        return (f"pe 0x{self.mpidr:08x} {op}{self.width * 8:<2} 0x{self.addr:016x} = "
+                f"0x{self.value:0{self.width * 2}x}")
+
+
+class Trace:
+    """Accesses of the last @ACSMMIO block of one console log."""
+
+    def __init__(self, path):
+        self.path = path
+        self.accesses = []
+        self.total = 0
+        self.freq = 0
+        block = None
+        with open(path, "r", encoding="latin-1") as log_file:
+            for line_no, line in enumerate(log_file, 1):
+                stripped = line.strip()
+                match = HEADER_RE.search(stripped)
+                if match:
+                    # A log holding several runs keeps the last one
+                    block = []
+                    self.total = int(match.group(2))
+                    self.freq = int(match.group(3))
+                    continue
+                if block is None:
+                    continue
+                if not stripped:
+                    # Consoles ending lines with CR LF leave empty lines
+                    continue
+                if END_RE.search(stripped):
+                    self.accesses = block
+                    block = None
+                    continue
+                fields = LINE_RE.match(stripped)
+                if not fields:
+                    print(f"{path}:{line_no}: malformed {MARKER} record skipped",
+                          file=sys.stderr)
+                    continue
+                block.append(Access(*(int(field, 16) for field in fields.groups())))
+        if block is not None:
+            print(f"{path}: {MARKER} block not terminated, run ended early?", file=sys.stderr)
+            self.accesses = block
+        if not self.accesses:
+            raise ValueError(f"{path}: no {MARKER} records, was mmio_record set?")
+        self.recorded = len(self.accesses)
+
+    def wrapped(self):
+        return self.total > self.recorded
+
+    def filter(self, mpidr, addr_range):
+        if mpidr is not None:
+            self.accesses = [acc for acc in self.accesses if acc.mpidr == mpidr]
+        if addr_range is not None:
+            low, high = addr_range
+            self.accesses = [acc for acc in self.accesses if low <= acc.addr < high]
+
+    def per_pe(self):
+        """Return {mpidr: [accesses in program order]}."""
+        streams = {}
+        for acc in self.accesses:
+            streams.setdefault(acc.mpidr, []).append(acc)
+        return streams
+
+    def duration_us(self, accesses):
+        if not self.freq or len(accesses) < 2:
+            return 0
+        return (accesses[-1].timestamp - accesses[0].timestamp) * 1000000 // self.freq
+
+
+class RegisterModel:
+    """Platform model built from a trace.
+
+    Reads of an address are served in the order they were recorded; once the
+    recorded reads of an address are used up, the model returns the last value
+    written to or read from it.
+    """
+
+    def __init__(self, accesses):
+        self.reads = {}
+        self.last = {}
+        for acc in accesses:
+            if not acc.write:
+                self.reads.setdefault((acc.addr, acc.width), []).append(acc.value)
+        self.pos = {}
+
+    def access(self, acc):
+        """Apply one access. Returns the predicted value of a read, else None."""
+        key = (acc.addr, acc.width)
+        if acc.write:
+            self.last[key] = acc.value
+            return None
+        values = self.reads.get(key, [])
+        index = self.pos.get(key, 0)
+        if index < len(values):
+            self.pos[key] = index + 1
+            self.last[key] = values[index]
+        return self.last.get(key)
+
+
+def parse_range(text):
+    try:
+        low, high = text.split(":")
+        return int(low, 0), int(high, 0)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"expected LO:HI, got {text}")
+
+
+def report_single(trace, top, listing):
+    print(f"{trace.path}: {len(trace.accesses)} accesses"
+          + (f" (last of {trace.total}, ring wrapped)" if trace.wrapped() else ""))
+    if listing:
+        start = trace.accesses[0].timestamp
+        for acc in trace.accesses:
+            delta = acc.timestamp - start
+            stamp = f"{delta * 1000000 // trace.freq:>10}us" if trace.freq else f"{delta:>12}"
+            print(f"{stamp}  {acc}")
+        return
+
+    print()
+    print(f"{'pe':<10} {'reads':>10} {'writes':>10} {'span':>12}")
+    for mpidr, stream in sorted(trace.per_pe().items()):
+        writes = sum(1 for acc in stream if acc.write)
+        print(f"0x{mpidr:08x} {len(stream) - writes:>10} {writes:>10} "
+              f"{trace.duration_us(stream):>10}us")
+
+    frames = {}
+    for acc in trace.accesses:
+        counts = frames.setdefault(acc.addr >> FRAME_SHIFT, [0, 0])
+        counts[acc.write] += 1
+    print()
+    print(f"{'4KB frame':<18} {'reads':>10} {'writes':>10}")
+    ranked = sorted(frames.items(), key=lambda item: -sum(item[1]))
+    for frame, (reads, writes) in ranked[:top]:
+        print(f"0x{frame << FRAME_SHIFT:016x} {reads:>10} {writes:>10}")
+
+
+def report_replay(base, new, top):
+    """Replay new against a model of base. Returns the number of differences."""
+    print(f"model : {base.path}: {len(base.accesses)} accesses")
+    print(f"replay: {new.path}: {len(new.accesses)} accesses")
+    if base.wrapped() or new.wrapped():
+        print("note  : a ring wrapped, the start of the run is missing from the comparison")
+    print()
+
+    differences = 0
+    base_pe = base.per_pe()
+    for mpidr, stream in sorted(new.per_pe().items()):
+        expected = base_pe.get(mpidr, [])
+        model = RegisterModel(expected)
+        diverged = False
+        shown = 0
+        for index, acc in enumerate(stream):
+            if not diverged and (index >= len(expected) or expected[index].key() != acc.key()):
+                diverged = True
+                differences += 1
+                print(f"pe 0x{mpidr:08x}: sequence diverges at access {index}")
+                print(f"    model : {expected[index] if index < len(expected) else '<end>'}")
+                print(f"    replay: {acc}")
+            predicted = model.access(acc)
+            if predicted is not None and predicted != acc.value:
+                differences += 1
+                if top is None or shown < top:
+                    print(f"pe 0x{mpidr:08x}: access {index}: {acc}, model "
+                          f"0x{predicted:0{acc.width * 2}x}")
+                shown += 1
+        if not diverged and len(expected) > len(stream):
+            differences += 1
+            print(f"pe 0x{mpidr:08x}: replay stops after {len(stream)} of {len(expected)} accesses")
+    for mpidr in sorted(set(base_pe) - set(new.per_pe())):
+        differences += 1
+        print(f"pe 0x{mpidr:08x}: no accesses in the replay")
+
+    print()
+    print(f"{differences} difference(s)")
+    return differences
+
+
+def export(trace, path):
+    with open(path, "wb") as out_file:
+        out_file.write(FILE_HDR.pack(FILE_MAGIC, len(trace.accesses), trace.freq & 0xFFFFFFFF))
+        for acc in trace.accesses:
+            out_file.write(FILE_REC.pack(acc.addr, acc.value, acc.timestamp, acc.mpidr,
+                                         acc.width, FLAG_WRITE if acc.write else 0, 0))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Summarise, compare or export ACS MMIO "
+                                                 "recordings")
+    parser.add_argument("log", help="console log with an @ACSMMIO block (model when comparing)")
+    parser.add_argument("new_log", nargs="?", help="console log to replay against the model")
+    parser.add_argument("--pe", type=lambda text: int(text, 0), default=None,
+                        help="only keep the accesses of this MPIDR")
+    parser.add_argument("--range", type=parse_range, default=None,
+                        help="only keep the accesses to addresses in [LO, HI)")
+    parser.add_argument("--list", action="store_true", help="list the accesses of one log")
+    parser.add_argument("--top", type=int, default=None,
+                        help="rows to list (default: 20 frames, all mismatching reads)")
+    parser.add_argument("--export", metavar="FILE", help="write the trace as a binary file")
+    args = parser.parse_args()
+
+    try:
+        base = Trace(args.log)
+        new = Trace(args.new_log) if args.new_log else None
+    except (OSError, ValueError) as err:
+        sys.exit(str(err))
+
+    for trace in (base, new):
+        if trace is not None:
+            trace.filter(args.pe, args.range)
+            if not trace.accesses:
+                sys.exit(f"{trace.path}: no accesses left after filtering")
+
+    if args.export:
+        export(base, args.export)
+
+    if new is None:
+        report_single(base, args.top if args.top is not None else 20, args.list)
+        return
+
+    if report_replay(base, new, args.top):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,208 @@
+## @file
+ # Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ # SPDX-License-Identifier : Apache-2.0
+ #
+ # Licensed under the Apache License, Version 2.0 (the "License");
+ # you may not use this file except in compliance with the License.
+ # You may obtain a copy of the License at
+ #
+ #  http://www.apache.org/licenses/LICENSE-2.0
+ #
+ # Unless required by applicable law or agreed to in writing, software
+ # distributed under the License is distributed on an "AS IS" BASIS,
+ # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ # See the License for the specific language governing permissions and
+ # limitations under the License.
+ ##
+
+"""Summarise or compare ACS rule profiles (-profile).
+
+With -profile the ACS image prints one JSON object per rule that ran at the
+end of the run, followed by a run summary:
+
+    @ACSPROF {"rule":"B_PE_01","module":"PE","type":"base","top":1,...,"us":52,...}
+    @ACSPROF {"summary":1,"rules":120,"pe":8,"freq":...,"ticks":...,"us":...}
+
+Given one console log, the script lists the slowest rules and the time spent
+per module. Given two, it lists the rules whose duration changed the most
+between the baseline and the new run, with their PSCI, MMIO and payload
+dispatch counts, and flags rules whose result changed.
+
+Usage: acs_profile_compare.py <log> [<new log>] [--top N] [--threshold PCT]
+"""
+
+import argparse
+import json
+import re
+import sys
+
+MARKER = "@ACSPROF"
+LINE_RE = re.compile(re.escape(MARKER) + r"\s+(\{.*\})")
+COUNTERS = ("psci", "mmio", "dispatch")
+
+
+class Profile:
+    """Rule records and run summary of one console log."""
+
+    def __init__(self, path):
+        self.path = path
+        self.rules = {}
+        self.summary = None
+        with open(path, "r", encoding="latin-1") as log_file:
+            for line_no, line in enumerate(log_file, 1):
+                match = LINE_RE.search(line)
+                if not match:
+                    continue
+                try:
+                    record = json.loads(match.group(1))
+                except json.JSONDecodeError:
+                    print(f"{path}:{line_no}: malformed {MARKER} line skipped", file=sys.stderr)
+                    continue
+                if record.get("summary"):
+                    self.summary = record
+                else:
+                    # A log holding several runs keeps the last one
+                    self.rules[record["rule"]] = record
+        if not self.rules:
+            raise ValueError(f"{path}: no {MARKER} records, was the run made with -profile?")
+
+    def top_level(self):
+        """Rules of the run list; base rules reached through an alias are excluded."""
+        return [rec for rec in self.rules.values() if rec.get("top")]
+
+    def modules(self):
+        """Return {module: total us} over the top-level rules."""
+        totals = {}
+        for rec in self.top_level():
+            totals[rec["module"]] = totals.get(rec["module"], 0) + rec["us"]
+        return totals
+
+    def total_us(self):
+        if self.summary:
+            return self.summary["us"]
+        return sum(rec["us"] for rec in self.top_level())
+
+
+def fmt_us(value):
+    """Format microseconds with a readable unit."""
+    if abs(value) >= 1000000:
+        return f"{value / 1000000:.2f}s"
+    if abs(value) >= 1000:
+        return f"{value / 1000:.1f}ms"
+    return f"{value}us"
+
+
+def percent(old, new):
+    if old == 0:
+        return "   new" if new else "     -"
+    return f"{(new - old) * 100.0 / old:+6.1f}%"
+
+
+def report_single(profile, top):
+    print(f"{profile.path}: {len(profile.top_level())} rules, {fmt_us(profile.total_us())}")
+    print()
+    print(f"{'rule':<24} {'module':<10} {'state':<18} {'time':>10} {'pre':>9} "
+          f"{'pe':>4} {'dispatch':>8} {'psci':>6} {'mmio':>10}")
+    ranked = sorted(profile.rules.values(), key=lambda rec: rec["us"], reverse=True)
+    for rec in ranked[:top]:
+        name = rec["rule"] if rec.get("top") else "  " + rec["rule"]
+        print(f"{name:<24} {rec['module']:<10} {rec['state']:<18} {fmt_us(rec['us']):>10} "
+              f"{fmt_us(rec['precheck_us']):>9} {rec['pe']:>4} {rec['dispatch']:>8} "
+              f"{rec['psci']:>6} {rec['mmio']:>10}")
+
+    print()
+    print(f"{'module':<10} {'time':>10} {'share':>7}")
+    total = profile.total_us() or 1
+    for module, value in sorted(profile.modules().items(), key=lambda item: -item[1]):
+        print(f"{module:<10} {fmt_us(value):>10} {value * 100.0 / total:6.1f}%")
+
+
+def report_compare(base, new, top, threshold):
+    """Print the comparison and return the number of rules slower than threshold."""
+    print(f"baseline: {base.path}: {len(base.top_level())} rules, {fmt_us(base.total_us())}")
+    print(f"new     : {new.path}: {len(new.top_level())} rules, {fmt_us(new.total_us())} "
+          f"({percent(base.total_us(), new.total_us()).strip()})")
+    print()
+
+    rows = []
+    for rule in set(base.rules) | set(new.rules):
+        old_rec = base.rules.get(rule)
+        new_rec = new.rules.get(rule)
+        old_us = old_rec["us"] if old_rec else 0
+        new_us = new_rec["us"] if new_rec else 0
+        rows.append((new_us - old_us, rule, old_rec, new_rec))
+    rows.sort(key=lambda row: abs(row[0]), reverse=True)
+
+    print(f"{'rule':<24} {'baseline':>10} {'new':>10} {'delta':>10} {'change':>7}  "
+          f"{'psci':>11} {'mmio':>15} {'dispatch':>11}  note")
+    slower = 0
+    shown = 0
+    for delta, rule, old_rec, new_rec in rows:
+        old_us = old_rec["us"] if old_rec else 0
+        new_us = new_rec["us"] if new_rec else 0
+        notes = []
+        if old_rec is None:
+            notes.append("only in new run")
+        elif new_rec is None:
+            notes.append("only in baseline")
+        elif old_rec["state"] != new_rec["state"]:
+            notes.append(f"{old_rec['state']} -> {new_rec['state']}")
+        if (threshold is not None and old_rec and new_rec and old_us
+                and (new_us - old_us) * 100.0 / old_us > threshold):
+            notes.append("SLOWER")
+            slower += 1
+
+        if top is not None and shown >= top and not notes:
+            continue
+        shown += 1
+
+        counts = []
+        for counter in COUNTERS:
+            old_val = old_rec[counter] if old_rec else 0
+            new_val = new_rec[counter] if new_rec else 0
+            counts.append(f"{old_val}->{new_val}" if old_val != new_val else str(new_val))
+        top_level = (new_rec or old_rec).get("top")
+        name = rule if top_level else "  " + rule
+        print(f"{name:<24} {fmt_us(old_us):>10} {fmt_us(new_us):>10} {fmt_us(delta):>10} "
+              f"{percent(old_us, new_us):>7}  {counts[0]:>11} {counts[1]:>15} "
+              f"{counts[2]:>11}  {', '.join(notes)}")
+
+    print()
+    print(f"{'module':<10} {'baseline':>10} {'new':>10} {'delta':>10} {'change':>7}")
+    old_mod = base.modules()
+    new_mod = new.modules()
+    for module in sorted(set(old_mod) | set(new_mod)):
+        old_us = old_mod.get(module, 0)
+        new_us = new_mod.get(module, 0)
+        print(f"{module:<10} {fmt_us(old_us):>10} {fmt_us(new_us):>10} "
+              f"{fmt_us(new_us - old_us):>10} {percent(old_us, new_us):>7}")
+    return slower
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Summarise or compare ACS -profile reports")
+    parser.add_argument("log", help="console log with @ACSPROF lines (baseline when comparing)")
+    parser.add_argument("new_log", nargs="?", help="console log of the run to compare")
+    parser.add_argument("--top", type=int, default=None,
+                        help="rows to list (default: 20 for one log, all for two); rules "
+                             "with a changed result are always listed")
+    parser.add_argument("--threshold", type=float, default=None,
+                        help="flag rules more than PCT percent slower and exit with status 1")
+    args = parser.parse_args()
+
+    try:
+        base = Profile(args.log)
+        new = Profile(args.new_log) if args.new_log else None
+    except (OSError, ValueError, KeyError) as err:
+        sys.exit(str(err))
+
+    if new is None:
+        report_single(base, args.top if args.top is not None else 20)
+        return
+
+    if report_compare(base, new, args.top, args.threshold):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -22,7 +22,9 @@
 
 extern GIC_ITS_INFO    *g_gic_its_info;
 static uint32_t        *g_cwriter_ptr;
+static uint32_t        *g_creadr_ptr;
 static uint32_t        g_its_setup_done;
+static ITS_DEVICE_ITT  g_its_device_itt[ITS_MAX_MAPPED_DEVICES];
 
 uint32_t GET_NUM_BITS(uint64_t value)
 {
@@ -280,18 +282,6 @@ static uint32_t ArmGicSetItsTables(uint32_t its_index)
 
   }
 
-  /* Allocate Memory for Interrupt Translation Table */
-  Address = (uint64_t)val_aligned_alloc(SIZE_64KB, (NUM_PAGES_8 * SIZE_4KB));
-
-  if (!Address) {
-    val_print(ERROR,  "ITS : Could Not Allocate Memory For ITT. Test may not pass.\n");
-    return 1;
-  }
-
-  val_memory_set((void *)Address, (NUM_PAGES_8*SIZE_4KB), 0);
-
-  g_gic_its_info->GicIts[its_index].ITTBase = Address;
-
   return 0;
 }
 
@@ -305,7 +295,58 @@ static void EnableITS(uint64_t GicItsBase)
   val_mmio_write(GicItsBase + ARM_GITS_CTLR, (value | ARM_GITS_CTLR_ENABLE));
 }
 
-static void
+static void PublishCmdQ(uint32_t its_index)
+{
+  /* Make the commands visible before the ITS is told about them */
+  dsbsy();
+  val_mmio_write64((g_gic_its_info->GicIts[its_index].Base + ARM_GITS_CWRITER),
+                   (uint64_t)(g_cwriter_ptr[its_index] * NUM_BYTES_IN_DW));
+}
+
+/**
+  @brief   Write one command at GITS_CWRITER, wrapping at the end of the queue. When the
+           queue is full, the commands written so far are published and the ITS is given
+           time to consume them; GITS_CREADR is not read otherwise. If the ITS does not
+           free a slot the command is dropped rather than written over an unread one.
+  @param   its_index  ITS index
+  @param   CMDQ_BASE  Command queue base
+  @param   dw0..dw3   Command double words
+  @return  0 on success, 1 if the queue stayed full
+**/
+static uint32_t
+WriteCmdQEntry(
+   uint32_t     its_index,
+   uint64_t     *CMDQ_BASE,
+   uint64_t     dw0,
+   uint64_t     dw1,
+   uint64_t     dw2,
+   uint64_t     dw3
+  )
+{
+    uint32_t next = (g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR) % ITS_CMDQ_SIZE_DW;
+    uint32_t count = 0;
+
+    if (next == g_creadr_ptr[its_index]) {
+        PublishCmdQ(its_index);
+        while (next == g_creadr_ptr[its_index]) {
+            g_creadr_ptr[its_index] = (uint32_t)((val_mmio_read64(g_gic_its_info->GicIts[its_index].Base +
+                                        ARM_GITS_CREADR) & ITS_CMDQ_OFFSET_MASK) / NUM_BYTES_IN_DW);
+            if (++count > WAIT_ITS_COMMAND_DONE) {
+                val_print(ERROR, "\n       ITS : Command Queue full, command not written");
+                return 1;
+            }
+        }
+    }
+
+    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]), dw0);
+    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1), dw1);
+    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), dw2);
+    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), dw3);
+    g_cwriter_ptr[its_index] = next;
+    return 0;
+}
+
+static uint32_t
 WriteCmdQMAPD(
    uint32_t     its_index,
    uint64_t     *CMDQ_BASE,
@@ -315,16 +356,14 @@ WriteCmdQMAPD(
    uint64_t     Valid
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPD));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1), (uint64_t)(Size));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2),
-                     (uint64_t)((Valid << ITS_CMD_SHIFT_VALID) | (ITT_BASE & ITT_PAR_MASK)));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    return WriteCmdQEntry(its_index, CMDQ_BASE,
+                   (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPD),
+                   (uint64_t)(Size),
+                   (uint64_t)((Valid << ITS_CMD_SHIFT_VALID) | (ITT_BASE & ITT_PAR_MASK)),
+                   (uint64_t)(0x0));
 }
 
-static void
+static uint32_t
 WriteCmdQMAPC(
    uint32_t     its_index,
    uint64_t     *CMDQ_BASE,
@@ -333,16 +372,14 @@ WriteCmdQMAPC(
    uint64_t     Valid
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)(ARM_ITS_CMD_MAPC));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1), (uint64_t)(0x0));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2),
-                     (uint64_t)((Valid << ITS_CMD_SHIFT_VALID) | RDBase | Clctn_ID));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    return WriteCmdQEntry(its_index, CMDQ_BASE,
+                   (uint64_t)(ARM_ITS_CMD_MAPC),
+                   (uint64_t)(0x0),
+                   (uint64_t)((Valid << ITS_CMD_SHIFT_VALID) | RDBase | Clctn_ID),
+                   (uint64_t)(0x0));
 }
 
-static void
+static uint32_t
 WriteCmdQMAPTI(
    uint32_t     its_index,
    uint64_t     *CMDQ_BASE,
@@ -351,16 +388,14 @@ WriteCmdQMAPTI(
    uint32_t     Clctn_ID
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPTI));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1),
-                     ((uint64_t)(int_id-ARM_LPI_MINID) | ((uint64_t)int_id << 32)));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), (uint64_t)(Clctn_ID));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    return WriteCmdQEntry(its_index, CMDQ_BASE,
+                   (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPTI),
+                   ((uint64_t)(int_id-ARM_LPI_MINID) | ((uint64_t)int_id << 32)),
+                   (uint64_t)(Clctn_ID),
+                   (uint64_t)(0));
 }
 
-static void
+static uint32_t
 WriteCmdQINV(
    uint32_t     its_index,
    uint64_t     *CMDQ_BASE,
@@ -368,16 +403,28 @@ WriteCmdQINV(
    uint32_t     int_id
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_INV));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1),
-                     (uint64_t)(int_id-ARM_LPI_MINID));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), (uint64_t)(0x0));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    return WriteCmdQEntry(its_index, CMDQ_BASE,
+                   (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_INV),
+                   (uint64_t)(int_id-ARM_LPI_MINID),
+                   (uint64_t)(0x0),
+                   (uint64_t)(0x0));
+}
+
+static uint32_t
+WriteCmdQINVALL(
+   uint32_t     its_index,
+   uint64_t     *CMDQ_BASE,
+   uint32_t     Clctn_ID
+  )
+{
+    return WriteCmdQEntry(its_index, CMDQ_BASE,
+                   (uint64_t)(ARM_ITS_CMD_INVALL),
+                   (uint64_t)(0x0),
+                   (uint64_t)(Clctn_ID),
+                   (uint64_t)(0x0));
 }
 
-static void
+static uint32_t
 WriteCmdQDISCARD(
    uint32_t     its_index,
    uint64_t     *CMDQ_BASE,
@@ -385,29 +432,26 @@ WriteCmdQDISCARD(
    uint32_t     int_id
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_DISCARD));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1),
-                     (uint64_t)(int_id-ARM_LPI_MINID));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), (uint64_t)(0x0));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    return WriteCmdQEntry(its_index, CMDQ_BASE,
+                   (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_DISCARD),
+                   (uint64_t)(int_id-ARM_LPI_MINID),
+                   (uint64_t)(0x0),
+                   (uint64_t)(0x0));
 }
 
 
-static void
+static uint32_t
 WriteCmdQSYNC(
    uint32_t     its_index,
    uint64_t     *CMDQ_BASE,
    uint32_t     RDBase
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)(ARM_ITS_CMD_SYNC));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1), (uint64_t)(0x0));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), (uint64_t)(RDBase));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    return WriteCmdQEntry(its_index, CMDQ_BASE,
+                   (uint64_t)(ARM_ITS_CMD_SYNC),
+                   (uint64_t)(0x0),
+                   (uint64_t)(RDBase),
+                   (uint64_t)(0x0));
 }
 
 static void PollTillCommandQueueDone(uint32_t its_index)
@@ -444,6 +488,7 @@ static void PollTillCommandQueueDone(uint32_t its_index)
     creadr_value = val_mmio_read64(ItsBase + ARM_GITS_CREADR);
   }
 
+  g_creadr_ptr[its_index] = (uint32_t)((creadr_value & ITS_CMDQ_OFFSET_MASK) / NUM_BYTES_IN_DW);
 }
 
 static uint64_t GetRDBaseFormat(uint32_t its_index)
@@ -471,97 +516,320 @@ static uint64_t GetRDBaseFormat(uint32_t its_index)
 }
 
 
-void val_its_clear_lpi_map(uint32_t its_index, uint32_t device_id, uint32_t int_id)
+/**
+  @brief   Returns 1 if DeviceID of map[index] already appears earlier in the batch
+**/
+static uint32_t DeviceSeenInBatch(ITS_LPI_MAP *map, uint32_t index)
+{
+  uint32_t i;
+
+  for (i = 0; i < index; i++) {
+    if (map[i].device_id == map[index].device_id)
+      return 1;
+  }
+
+  return 0;
+}
+
+/**
+  @brief   Returns the ITT of a DeviceID mapped on an ITS, or NULL if it is not mapped
+**/
+static ITS_DEVICE_ITT *ItsFindDeviceItt(uint32_t its_index, uint32_t device_id)
+{
+  uint32_t i;
+
+  for (i = 0; i < ITS_MAX_MAPPED_DEVICES; i++) {
+    if (g_its_device_itt[i].base && (g_its_device_itt[i].its_index == its_index) &&
+        (g_its_device_itt[i].device_id == device_id))
+      return &g_its_device_itt[i];
+  }
+
+  return NULL;
+}
+
+static void ItsFreeDeviceItt(ITS_DEVICE_ITT *itt)
+{
+  val_memory_free_aligned((void *)itt->base);
+  itt->base = 0;
+}
+
+/**
+  @brief   Returns the number of EventID bits the ITT of map[index].device_id needs to
+           hold every LPI of that device in the batch
+**/
+static uint32_t ItsDeviceEventBits(ITS_LPI_MAP *map, uint32_t num, uint32_t index)
+{
+  uint32_t i, max_event = 0, bits = 1;
+
+  for (i = index; i < num; i++) {
+    if ((map[i].device_id == map[index].device_id) &&
+        (map[i].int_id - ARM_LPI_MINID > max_event))
+      max_event = map[i].int_id - ARM_LPI_MINID;
+  }
+
+  while ((bits < 32) && (max_event >> bits))
+    bits++;
+
+  return bits;
+}
+
+/**
+  @brief   Allocates an ITT for each DeviceID of the batch that is not mapped yet.
+           Distinct devices must not share an ITT, so each one is sized for the
+           EventIDs of its own LPIs. Nothing is allocated if one allocation fails.
+  @param   its_index  ITS index
+  @param   map        (DeviceID, LPI) pairs
+  @param   num        Number of pairs
+  @param   new_itt    Set to the ITT allocated for map[i], NULL if map[i] needs no MAPD
+  @return  ACS_STATUS_PASS, or ACS_STATUS_ERR
+**/
+static uint32_t ItsAllocDeviceItts(uint32_t its_index, ITS_LPI_MAP *map, uint32_t num,
+                                   ITS_DEVICE_ITT **new_itt)
+{
+  ITS_DEVICE_ITT *itt;
+  uint64_t entry_size;
+  uint32_t i, j, bits, size;
+
+  entry_size = ARM_GITS_TYPER_ITT_ENTRY_SIZE(
+                 val_mmio_read64(g_gic_its_info->GicIts[its_index].Base + ARM_GITS_TYPER)) + 1;
+
+  for (i = 0; i < num; i++) {
+    new_itt[i] = NULL;
+    if (DeviceSeenInBatch(map, i))
+      continue;
+
+    bits = ItsDeviceEventBits(map, num, i);
+    if (bits > g_gic_its_info->GicIts[its_index].IDBits + 1) {
+      val_print(ERROR, "\n       ITS : LPI 0x%x beyond the EventID range", map[i].int_id);
+      goto fail;
+    }
+
+    /* A mapped device keeps its ITT, a larger one would drop its other LPIs */
+    itt = ItsFindDeviceItt(its_index, map[i].device_id);
+    if (itt != NULL) {
+      if (bits > itt->event_bits) {
+        val_print(ERROR, "\n       ITS : LPI 0x%x beyond the ITT", map[i].int_id);
+        val_print(ERROR, " of DeviceID 0x%x", map[i].device_id);
+        goto fail;
+      }
+      continue;
+    }
+
+    for (j = 0; j < ITS_MAX_MAPPED_DEVICES && g_its_device_itt[j].base; j++)
+      ;
+    if (j == ITS_MAX_MAPPED_DEVICES) {
+      val_print(ERROR, "\n       ITS : More than %d devices mapped", ITS_MAX_MAPPED_DEVICES);
+      goto fail;
+    }
+
+    size = (uint32_t)((1ull << bits) * entry_size);
+    if (size < ITS_ITT_ALIGN)
+      size = ITS_ITT_ALIGN;
+
+    itt = &g_its_device_itt[j];
+    itt->base = (uint64_t)val_aligned_alloc(ITS_ITT_ALIGN, size);
+    if (!itt->base) {
+      val_print(ERROR, "\n       ITS : Could Not Allocate Memory For ITT");
+      goto fail;
+    }
+    val_memory_set((void *)itt->base, size, 0);
+    itt->its_index = its_index;
+    itt->device_id = map[i].device_id;
+    itt->event_bits = bits;
+    new_itt[i] = itt;
+  }
+
+  return ACS_STATUS_PASS;
+
+fail:
+  while (i--) {
+    if (new_itt[i] != NULL)
+      ItsFreeDeviceItt(new_itt[i]);
+  }
+  return ACS_STATUS_ERR;
+}
+
+/**
+  @brief   Remove the mappings of a set of (DeviceID, LPI) pairs: one DISCARD per pair,
+           one MAPD (V=0) per distinct device and a single SYNC, published with one
+           GITS_CWRITER update.
+  @param   its_index  ITS index
+  @param   map        (DeviceID, LPI) pairs
+  @param   num        Number of pairs
+  @return  ACS_STATUS_PASS, or ACS_STATUS_ERR if the command queue did not drain
+**/
+uint32_t val_its_clear_lpi_map_batch(uint32_t its_index, ITS_LPI_MAP *map, uint32_t num)
 {
-  uint64_t    value;
   uint64_t    RDBase;
-  uint64_t    ItsBase;
   uint64_t    ItsCommandBase;
+  uint32_t    i;
+  ITS_DEVICE_ITT *itt;
 
-  if (!g_its_setup_done)
-    return;
+  if (!g_its_setup_done || num == 0)
+    return ACS_STATUS_PASS;
 
-  ItsBase        = g_gic_its_info->GicIts[its_index].Base;
   ItsCommandBase = g_gic_its_info->GicIts[its_index].CommandQBase;
 
-  /* Clear Config table for LPI=int_id */
-  ClearConfigTable(int_id);
+  /* Clear Config table for the LPIs */
+  for (i = 0; i < num; i++)
+    ClearConfigTable(map[i].int_id);
 
   /* Get RDBase Depending on GITS_TYPER.PTA */
   RDBase = GetRDBaseFormat(its_index);
 
   /* Discard Mappings */
-  WriteCmdQDISCARD(its_index, (uint64_t *)(ItsCommandBase), device_id, int_id);
-  /* Un Map Device using MAPD */
-  WriteCmdQMAPD(its_index, (uint64_t *)(ItsCommandBase), device_id,
-                g_gic_its_info->GicIts[its_index].ITTBase,
-                0, 0 /*InValid*/);
+  for (i = 0; i < num; i++) {
+    if (WriteCmdQDISCARD(its_index, (uint64_t *)(ItsCommandBase), map[i].device_id,
+                         map[i].int_id))
+      return ACS_STATUS_ERR;
+  }
+
+  /* Un Map Devices using MAPD */
+  for (i = 0; i < num; i++) {
+    if (DeviceSeenInBatch(map, i))
+      continue;
+    if (WriteCmdQMAPD(its_index, (uint64_t *)(ItsCommandBase), map[i].device_id,
+                      0, 0, 0 /*InValid*/))
+      return ACS_STATUS_ERR;
+  }
+
   /* ITS SYNC Command */
-  WriteCmdQSYNC(its_index, (uint64_t *)(ItsCommandBase), RDBase);
+  if (WriteCmdQSYNC(its_index, (uint64_t *)(ItsCommandBase), RDBase))
+    return ACS_STATUS_ERR;
 
-  dsbsy();
   /* Update the CWRITER Register so that all the commands from Command queue gets executed.*/
-  value = ((g_cwriter_ptr[its_index] * NUM_BYTES_IN_DW));
-  val_mmio_write64((ItsBase + ARM_GITS_CWRITER), value);
+  PublishCmdQ(its_index);
 
   /* Check CREADR value which ensures Command Queue is processed */
   PollTillCommandQueueDone(its_index);
   dsbsy();
 
+  /* The ITTs of the unmapped devices are no longer read by the ITS */
+  for (i = 0; i < num; i++) {
+    itt = ItsFindDeviceItt(its_index, map[i].device_id);
+    if (itt != NULL)
+      ItsFreeDeviceItt(itt);
+  }
+
+  return ACS_STATUS_PASS;
+}
+
+uint32_t val_its_clear_lpi_map(uint32_t its_index, uint32_t device_id, uint32_t int_id)
+{
+  ITS_LPI_MAP map;
+
+  map.device_id = device_id;
+  map.int_id = int_id;
+  return val_its_clear_lpi_map_batch(its_index, &map, 1);
 }
 
-void val_its_create_lpi_map(uint32_t its_index, uint32_t device_id,
-                            uint32_t int_id, uint32_t Priority)
+/**
+  @brief   Map a set of (DeviceID, LPI) pairs to collection 1: one MAPD per distinct
+           device, one MAPC, one MAPTI per pair, then INV (single pair) or INVALL and a
+           single SYNC, published with one GITS_CWRITER update. Large batches wrap
+           around the command queue.
+  @param   its_index  ITS index
+  @param   map        (DeviceID, LPI) pairs
+  @param   num        Number of pairs
+  @param   Priority   Priority of the LPIs
+  @return  ACS_STATUS_PASS, or ACS_STATUS_ERR if the command queue did not drain
+**/
+uint32_t val_its_create_lpi_map_batch(uint32_t its_index, ITS_LPI_MAP *map, uint32_t num,
+                                      uint32_t Priority)
 {
-  uint64_t    value;
   uint64_t    RDBase;
   uint64_t    ItsBase;
   uint64_t    ItsCommandBase;
+  uint32_t    i;
+  ITS_DEVICE_ITT **new_itt;
 
-  if (!g_its_setup_done)
-    return;
+  if (!g_its_setup_done || num == 0)
+    return ACS_STATUS_PASS;
+
+  new_itt = val_memory_alloc(num * sizeof(ITS_DEVICE_ITT *));
+  if (new_itt == NULL)
+    return ACS_STATUS_ERR;
+
+  /* Every command of the batch can be written once each device has its ITT */
+  if (ItsAllocDeviceItts(its_index, map, num, new_itt)) {
+    val_memory_free(new_itt);
+    return ACS_STATUS_ERR;
+  }
 
   ItsBase        = g_gic_its_info->GicIts[its_index].Base;
   ItsCommandBase = g_gic_its_info->GicIts[its_index].CommandQBase;
 
-  /* Set Config table with enable the LPI = int_id, Priority. */
-  SetConfigTable(int_id, Priority);
+  /* Set Config table with enable the LPIs, Priority. */
+  for (i = 0; i < num; i++)
+    SetConfigTable(map[i].int_id, Priority);
 
-  /* Enable Redistributor */
-  EnableLPIsRD(g_gic_its_info->GicRdBase);
+  /* Enable Redistributor, if not done yet */
+  if (!(val_mmio_read(g_gic_its_info->GicRdBase + ARM_GICR_CTLR) & ARM_GICR_CTLR_ENABLE_LPIS))
+    EnableLPIsRD(g_gic_its_info->GicRdBase);
 
-  /* Enable ITS */
-  EnableITS(ItsBase);
+  /* Enable ITS, if not done yet */
+  if (!(val_mmio_read(ItsBase + ARM_GITS_CTLR) & ARM_GITS_CTLR_ENABLE))
+    EnableITS(ItsBase);
 
   /* Get RDBase Depending on GITS_TYPER.PTA */
   RDBase = GetRDBaseFormat(its_index);
 
-  /* Map Device using MAPD */
-  WriteCmdQMAPD(its_index, (uint64_t *)(ItsCommandBase), device_id,
-                g_gic_its_info->GicIts[its_index].ITTBase,
-                g_gic_its_info->GicIts[its_index].IDBits, 0x1 /*Valid*/);
+  /* Map Devices using MAPD, Size is the number of EventID bits minus one */
+  for (i = 0; i < num; i++) {
+    if (new_itt[i] == NULL)
+      continue;
+    if (WriteCmdQMAPD(its_index, (uint64_t *)(ItsCommandBase), map[i].device_id,
+                      new_itt[i]->base, new_itt[i]->event_bits - 1, 0x1 /*Valid*/)) {
+      val_memory_free(new_itt);
+      return ACS_STATUS_ERR;
+    }
+  }
+  val_memory_free(new_itt);
+
   /* Map Collection using MAPC */
-  WriteCmdQMAPC(its_index, (uint64_t *)(ItsCommandBase),
-                0x1 /*Clctn_ID*/, RDBase, 0x1 /*Valid*/);
-  /* Map Interrupt using MAPI */
-  WriteCmdQMAPTI(its_index, (uint64_t *)(ItsCommandBase), device_id, int_id, 0x1 /*Clctn_ID*/);
-  /* Invalid Entry */
-  WriteCmdQINV(its_index, (uint64_t *)(ItsCommandBase), device_id, int_id);
-  /* ITS SYNC Command */
-  WriteCmdQSYNC(its_index, (uint64_t *)(ItsCommandBase), RDBase);
+  if (WriteCmdQMAPC(its_index, (uint64_t *)(ItsCommandBase),
+                    0x1 /*Clctn_ID*/, RDBase, 0x1 /*Valid*/))
+    return ACS_STATUS_ERR;
+
+  /* Map Interrupts using MAPTI */
+  for (i = 0; i < num; i++) {
+    if (WriteCmdQMAPTI(its_index, (uint64_t *)(ItsCommandBase), map[i].device_id,
+                       map[i].int_id, 0x1 /*Clctn_ID*/))
+      return ACS_STATUS_ERR;
+  }
 
-  dsbsy();
+  /* Invalid Entries */
+  if (num == 1) {
+    if (WriteCmdQINV(its_index, (uint64_t *)(ItsCommandBase), map[0].device_id, map[0].int_id))
+      return ACS_STATUS_ERR;
+  } else {
+    if (WriteCmdQINVALL(its_index, (uint64_t *)(ItsCommandBase), 0x1 /*Clctn_ID*/))
+      return ACS_STATUS_ERR;
+  }
+
+  /* ITS SYNC Command */
+  if (WriteCmdQSYNC(its_index, (uint64_t *)(ItsCommandBase), RDBase))
+    return ACS_STATUS_ERR;
 
   /* Update the CWRITER Register so that all the commands from Command queue gets executed.*/
-  value = ((g_cwriter_ptr[its_index] * NUM_BYTES_IN_DW));
-  val_mmio_write64((ItsBase + ARM_GITS_CWRITER), value);
+  PublishCmdQ(its_index);
 
   /* Check CREADR value which ensures Command Queue is processed */
   PollTillCommandQueueDone(its_index);
   dsbsy();
 
+  return ACS_STATUS_PASS;
 }
 
+uint32_t val_its_create_lpi_map(uint32_t its_index, uint32_t device_id,
+                                uint32_t int_id, uint32_t Priority)
+{
+  ITS_LPI_MAP map;
+
+  map.device_id = device_id;
+  map.int_id = int_id;
+  return val_its_create_lpi_map_batch(its_index, &map, 1, Priority);
+}
 
 uint32_t val_its_get_max_lpi(void)
 {
@@ -635,8 +903,18 @@ uint32_t val_its_init(void)
     return 0;
   }
 
-  for (index = 0; index < g_gic_its_info->GicNumIts; index++)
+  g_creadr_ptr = (uint32_t *)pal_aligned_alloc(MEM_ALIGN_4K,
+                                               sizeof(uint32_t) * (g_gic_its_info->GicNumIts));
+
+  if (g_creadr_ptr == NULL) {
+    val_print(ERROR, "ITS : Could Not Allocate Memory CReadR. Test may not pass.\n");
+    return 0;
+  }
+
+  for (index = 0; index < g_gic_its_info->GicNumIts; index++) {
     g_cwriter_ptr[index] = 0;
+    g_creadr_ptr[index] = 0;
+  }
 
   for (index = 0; index < g_gic_its_info->GicNumIts; index++)
   {
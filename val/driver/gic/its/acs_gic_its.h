@@ -127,6 +127,7 @@
 #define ARM_GITS_TYPER_CIDBits(its_typer)           ((its_typer >> 32) & 0xF)
 #define ARM_GITS_TYPER_IDbits(its_typer)            ((its_typer >> 8) & 0x1F)
 #define ARM_GITS_TYPER_PTA                          (1 << 19)
+#define ARM_GITS_TYPER_ITT_ENTRY_SIZE(its_typer)    ((its_typer >> 4) & 0xF)
 
 /* GITS_CREADR Bits */
 #define ARM_GITS_CREADR_STALL       (1 << 0)
@@ -173,6 +174,7 @@
 #define ARM_ITS_CMD_MAPI    0xB
 #define ARM_ITS_CMD_MAPTI   0xA
 #define ARM_ITS_CMD_INV     0xC
+#define ARM_ITS_CMD_INVALL  0xD
 #define ARM_ITS_CMD_DISCARD 0xF
 #define ARM_ITS_CMD_SYNC    0x5
 
@@ -184,6 +186,27 @@
 #define ITS_NEXT_CMD_PTR    4
 #define NUM_BYTES_IN_DW     8
 
+/* Command queue size in double words, and the CREADR/CWRITER offset field */
+#define ITS_CMDQ_SIZE_DW        ((NUM_PAGES_8 * SIZE_4KB) / NUM_BYTES_IN_DW)
+#define ITS_CMDQ_OFFSET_MASK    0xFFFE0
+
+/* One (DeviceID, LPI) pair of a batched mapping */
+typedef struct {
+  uint32_t device_id;
+  uint32_t int_id;
+} ITS_LPI_MAP;
+
+/* ITT of a mapped DeviceID, sized for the EventIDs of its LPIs */
+#define ITS_MAX_MAPPED_DEVICES  32
+#define ITS_ITT_ALIGN           256
+
+typedef struct {
+  uint32_t its_index;
+  uint32_t device_id;
+  uint32_t event_bits;    /* MAPD Size + 1 */
+  uint64_t base;          /* 0 if the entry is free */
+} ITS_DEVICE_ITT;
+
 uint32_t ArmGicRedistributorConfigurationForLPI(uint64_t rd_base);
 
 void ClearConfigTable(uint32_t int_id);
@@ -194,9 +217,12 @@ uint32_t val_its_gicr_lpi_support(uint64_t rd_base);
 
 
 void EnableLPIsRD(uint64_t rd_base);
-void val_its_create_lpi_map(uint32_t its_index, uint32_t device_id,
-                            uint32_t int_id, uint32_t Priority);
-void val_its_clear_lpi_map(uint32_t its_index, uint32_t device_id, uint32_t int_id);
+uint32_t val_its_create_lpi_map(uint32_t its_index, uint32_t device_id,
+                                uint32_t int_id, uint32_t Priority);
+uint32_t val_its_clear_lpi_map(uint32_t its_index, uint32_t device_id, uint32_t int_id);
+uint32_t val_its_create_lpi_map_batch(uint32_t its_index, ITS_LPI_MAP *map, uint32_t num,
+                                      uint32_t Priority);
+uint32_t val_its_clear_lpi_map_batch(uint32_t its_index, ITS_LPI_MAP *map, uint32_t num);
 
 uint64_t val_its_get_translater_addr(uint32_t its_index);
 uint32_t val_its_get_max_lpi(void);
@@ -201,9 +201,23 @@ BITFIELD_DECL(uint64_t, STRTAB_STE_3_S2TTB, 51, 4)
 #define CMDQ_DWORDS_PER_ENT  2
 #define EVNTQ_DWORDS_PER_ENT 4
 BITFIELD_DECL(uint64_t, CMDQ_0_OP, 7, 0)
+BITFIELD_DECL(uint64_t, CMDQ_CFGI_0_SID, 63, 32)
 BITFIELD_DECL(uint64_t, CMDQ_CFGI_1_RANGE, 4, 0)
+#define CMDQ_CFGI_1_LEAF     (1UL << 0)
 #define CMDQ_CFGI_1_ALL_STES 31
 
+BITFIELD_DECL(uint64_t, CMDQ_TLBI_0_VMID, 47, 32)
+BITFIELD_DECL(uint64_t, CMDQ_TLBI_0_ASID, 63, 48)
+
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_CS, 13, 12)
+#define CMDQ_SYNC_0_CS_NONE  0
+#define CMDQ_SYNC_0_CS_IRQ   1
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSH, 23, 22)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSIATTR, 27, 24)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSIDATA, 63, 32)
+#define CMDQ_SYNC_0_MSIATTR_OIWB 0xf
+#define CMDQ_SYNC_1_MSIADDR_MASK 0x000FFFFFFFFFFFFCULL  /* MSIADDR[51:2] */
+
 #define SMMU_CMDQ_POLL_TIMEOUT 0x100000
 
 #define CDTAB_SPLIT             10
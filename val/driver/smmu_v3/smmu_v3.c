@@ -56,100 +56,222 @@ static uint32_t smmu_queue_empty(smmu_queue_t *q)
            ((q->prod & wrap_mask) == (q->cons & wrap_mask));
 }
 
-static int smmu_cmdq_build_cmd(uint64_t *cmd, uint8_t opcode)
+static int smmu_cmdq_build_cmd(uint64_t *cmd, smmu_cmdq_ent_t *ent)
 {
-    val_memory_set(cmd, CMDQ_DWORDS_PER_ENT << 3, 0);
-    cmd[0] |= BITFIELD_SET(CMDQ_0_OP, opcode);
+    cmd[0] = BITFIELD_SET(CMDQ_0_OP, ent->opcode);
+    cmd[1] = 0;
 
-    switch (opcode) {
+    switch (ent->opcode) {
     case CMDQ_OP_TLBI_EL2_ALL:
     case CMDQ_OP_TLBI_NSNH_ALL:
-    case CMDQ_OP_CMD_SYNC:
         break;
     case CMDQ_OP_CFGI_ALL:
         cmd[1] |= BITFIELD_SET(CMDQ_CFGI_1_RANGE, CMDQ_CFGI_1_ALL_STES);
         break;
+    case CMDQ_OP_CFGI_STE:
+        cmd[0] |= BITFIELD_SET(CMDQ_CFGI_0_SID, (uint64_t)ent->cfgi.sid);
+        cmd[1] |= ent->cfgi.leaf ? CMDQ_CFGI_1_LEAF : 0;
+        break;
+    case CMDQ_OP_CFGI_CD_ALL:
+        cmd[0] |= BITFIELD_SET(CMDQ_CFGI_0_SID, (uint64_t)ent->cfgi.sid);
+        break;
+    case CMDQ_OP_TLBI_NH_ASID:
+        cmd[0] |= BITFIELD_SET(CMDQ_TLBI_0_VMID, (uint64_t)ent->tlbi.vmid) |
+                  BITFIELD_SET(CMDQ_TLBI_0_ASID, (uint64_t)ent->tlbi.asid);
+        break;
+    case CMDQ_OP_TLBI_S12_VMALL:
+        cmd[0] |= BITFIELD_SET(CMDQ_TLBI_0_VMID, (uint64_t)ent->tlbi.vmid);
+        break;
+    case CMDQ_OP_CMD_SYNC:
+        if (ent->sync.msiaddr) {
+            cmd[0] |= BITFIELD_SET(CMDQ_SYNC_0_CS, CMDQ_SYNC_0_CS_IRQ) |
+                      BITFIELD_SET(CMDQ_SYNC_0_MSH, SMMU_SH_ISH) |
+                      BITFIELD_SET(CMDQ_SYNC_0_MSIATTR, CMDQ_SYNC_0_MSIATTR_OIWB) |
+                      BITFIELD_SET(CMDQ_SYNC_0_MSIDATA, (uint64_t)ent->sync.msidata);
+            cmd[1] |= ent->sync.msiaddr & CMDQ_SYNC_1_MSIADDR_MASK;
+        } else {
+            cmd[0] |= BITFIELD_SET(CMDQ_SYNC_0_CS, CMDQ_SYNC_0_CS_NONE);
+        }
+        break;
     default:
-        val_print(ERROR, "\n       Unsupported SMMU command 0x%x    ", opcode);
+        val_print(ERROR, "\n       Unsupported SMMU command 0x%x    ", ent->opcode);
         return -1;
     }
 
     return 0;
 }
 
-static int smmu_cmdq_write_cmd(smmu_dev_t *smmu, uint64_t *cmd)
+/**
+  @brief Make the commands written so far visible to the SMMU with one SMMU_CMDQ_PROD update
+  @param smmu - SMMU owning the command queue
+  @return None
+**/
+static void smmu_cmdq_publish(smmu_dev_t *smmu)
 {
-    uint32_t timeout = SMMU_CMDQ_POLL_TIMEOUT;
-    int ret = 0, i;
-    uint64_t *cmd_dst;
-    smmu_cmd_queue_t *cmdq = &smmu->cmdq;
-    smmu_queue_t
-        queue =
-            {
-                .log2nent = cmdq->queue.log2nent,
-            };
-
-    while (smmu_queue_full(&cmdq->queue) && timeout) {
-        timeout--;
-    }
-
-    if (!timeout) {
-        val_print(ERROR, "\n       SMMU CMD queue is full     ");
-        return -1;
-    }
-
-    queue.prod = val_mmio_read((uint64_t)cmdq->prod_reg);
-    cmd_dst = (uint64_t *)(cmdq->base + ((queue.prod & ((0x1ull << queue.log2nent) - 1)) * (cmdq->entry_size)));
-    for (i = 0; i < CMDQ_DWORDS_PER_ENT; ++i)
-        cmd_dst[i] = cmd[i];
-    queue.prod = smmu_inc_prod(&queue);
-
 #ifndef TARGET_LINUX
     dmbsy();
 #endif
-    val_mmio_write((uint64_t)cmdq->prod_reg, queue.prod);
-
-    return ret;
+    val_mmio_write((uint64_t)smmu->cmdq.prod_reg, smmu->cmdq.queue.prod);
 }
 
-static int smmu_cmdq_issue_cmd(smmu_dev_t *smmu,
-                   uint8_t opcode)
+/**
+  @brief Copy commands into the command queue and publish them. The producer index is
+         tracked in memory, so SMMU_CMDQ_CONS is only read when the queue looks full.
+  @param smmu - SMMU owning the command queue
+  @param cmds - commands, CMDQ_DWORDS_PER_ENT double words each
+  @param num  - number of commands
+  @return 0 on success, -1 if the queue did not drain
+**/
+static int smmu_cmdq_write_cmds(smmu_dev_t *smmu, uint64_t *cmds, uint32_t num)
 {
-    uint64_t cmd[CMDQ_DWORDS_PER_ENT];
+    smmu_cmd_queue_t *cmdq = &smmu->cmdq;
+    smmu_queue_t *q = &cmdq->queue;
+    uint32_t index_mask = (0x1ul << q->log2nent) - 1;
+    uint32_t ptr_mask = (0x1ul << (q->log2nent + 1)) - 1;
+    uint32_t timeout, i, j;
+    uint64_t *cmd_dst;
 
-    if (smmu_cmdq_build_cmd(cmd, opcode)) {
-        return -1;
+    for (i = 0; i < num; i++) {
+        if (smmu_queue_full(q)) {
+            /* Let the SMMU consume what is queued so far, then wait for a free slot */
+            smmu_cmdq_publish(smmu);
+            timeout = SMMU_CMDQ_POLL_TIMEOUT;
+            do {
+                q->cons = val_mmio_read((uint64_t)cmdq->cons_reg) & ptr_mask;
+            } while (smmu_queue_full(q) && --timeout);
+
+            if (!timeout) {
+                val_print(ERROR, "\n       SMMU CMD queue is full     ");
+                return -1;
+            }
+        }
+
+        cmd_dst = (uint64_t *)(cmdq->base + ((q->prod & index_mask) * (cmdq->entry_size)));
+        for (j = 0; j < CMDQ_DWORDS_PER_ENT; ++j)
+            cmd_dst[j] = cmds[i * CMDQ_DWORDS_PER_ENT + j];
+        q->prod = smmu_inc_prod(q);
     }
 
-    return smmu_cmdq_write_cmd(smmu, cmd);
+    smmu_cmdq_publish(smmu);
+    return 0;
 }
 
-static void smmu_cmdq_poll_until_consumed(smmu_dev_t *smmu)
+static int smmu_cmdq_poll_until_consumed(smmu_dev_t *smmu)
 {
     uint32_t timeout = SMMU_CMDQ_POLL_TIMEOUT;
-    smmu_cmd_queue_t *cmdq = &smmu->cmdq;
-    smmu_queue_t queue = {
-                .log2nent = smmu->cmdq.queue.log2nent,
-                .prod = val_mmio_read((uint64_t)smmu->cmdq.prod_reg),
-                .cons = val_mmio_read((uint64_t)smmu->cmdq.cons_reg)
-            };
+    smmu_queue_t *q = &smmu->cmdq.queue;
+    uint32_t ptr_mask = (0x1ul << (q->log2nent + 1)) - 1;
 
     while (timeout > 0) {
-        if (smmu_queue_empty(&queue))
-            break;
-        queue.cons = val_mmio_read((uint64_t)cmdq->cons_reg);
+        q->cons = val_mmio_read((uint64_t)smmu->cmdq.cons_reg) & ptr_mask;
+        if (smmu_queue_empty(q))
+            return 0;
         timeout--;
     }
 
-    if (!timeout) {
-        val_print(ERROR, "\n       CMDQ poll timeout at 0x%08x", queue.prod);
-        val_print(ERROR, "\n       prod_reg = 0x%08x,",
+    val_print(ERROR, "\n       CMDQ poll timeout at 0x%08x", q->prod);
+    val_print(ERROR, "\n       prod_reg = 0x%08x,",
 val_mmio_read((uint64_t)smmu->cmdq.prod_reg));
-        val_print(ERROR, "\n       cons_reg = 0x%08x",
+    val_print(ERROR, "\n       cons_reg = 0x%08x",
 val_mmio_read((uint64_t)smmu->cmdq.cons_reg));
-        val_print(ERROR, "\n       gerror   = 0x%08x     ",
+    val_print(ERROR, "\n       gerror   = 0x%08x     ",
 val_mmio_read(smmu->base + SMMU_GERROR_OFFSET));
+    return -1;
+}
+
+/**
+  @brief Wait for the CMD_SYNC that ends a batch. With MSI completion the SMMU writes
+         the sequence number to memory and no MMIO polling is needed; otherwise, or if
+         the MSI never arrives, SMMU_CMDQ_CONS is polled.
+  @param smmu - SMMU owning the command queue
+  @param seq  - MSI data of the CMD_SYNC, 0 if it has no MSI
+  @return 0 on success, -1 on timeout
+**/
+static int smmu_cmdq_wait_sync(smmu_dev_t *smmu, uint32_t seq)
+{
+    smmu_cmd_queue_t *cmdq = &smmu->cmdq;
+    uint32_t timeout = SMMU_CMDQ_POLL_TIMEOUT;
+
+    if (seq) {
+        while (timeout--) {
+            val_data_cache_ops_by_va((addr_t)cmdq->sync_ptr, INVALIDATE);
+            if (*cmdq->sync_ptr == seq) {
+                /* Everything up to and including the CMD_SYNC has been consumed */
+                cmdq->queue.cons = cmdq->queue.prod;
+                return 0;
+            }
+        }
+
+        val_print(WARN, "\n       SMMU CMD_SYNC MSI not received, polling CMDQ_CONS     ");
+        smmu->supported.msi = 0;
     }
+
+    return smmu_cmdq_poll_until_consumed(smmu);
+}
+
+static void smmu_cmdq_batch_init(smmu_cmdq_batch_t *batch)
+{
+    batch->num = 0;
+}
+
+/**
+  @brief Append a command to a batch. A full batch is written to the queue without a
+         CMD_SYNC so that any number of commands can be collected.
+  @param smmu  - SMMU owning the command queue
+  @param batch - batch being built
+  @param ent   - command to append
+  @return 0 on success, -1 on failure
+**/
+static int smmu_cmdq_batch_add(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch,
+                               smmu_cmdq_ent_t *ent)
+{
+    if (batch->num == SMMU_CMDQ_BATCH_ENTS) {
+        if (smmu_cmdq_write_cmds(smmu, batch->cmds, batch->num))
+            return -1;
+        batch->num = 0;
+    }
+
+    if (smmu_cmdq_build_cmd(&batch->cmds[batch->num * CMDQ_DWORDS_PER_ENT], ent))
+        return -1;
+
+    batch->num++;
+    return 0;
+}
+
+/**
+  @brief Terminate a batch with a single CMD_SYNC, publish it with one SMMU_CMDQ_PROD
+         write and wait for its completion.
+  @param smmu  - SMMU owning the command queue
+  @param batch - batch to submit, empty on return
+  @return 0 on success, -1 on failure
+**/
+static int smmu_cmdq_batch_submit(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch)
+{
+    smmu_cmd_queue_t *cmdq = &smmu->cmdq;
+    smmu_cmdq_ent_t sync;
+    uint32_t seq = 0;
+    int ret;
+
+    sync.opcode = CMDQ_OP_CMD_SYNC;
+    sync.sync.msiaddr = 0;
+    sync.sync.msidata = 0;
+    if (smmu->supported.msi && cmdq->sync_ptr != NULL) {
+        /* Sequence 0 is reserved for "no MSI" */
+        seq = ++cmdq->sync_seq;
+        if (seq == 0)
+            seq = ++cmdq->sync_seq;
+        sync.sync.msiaddr = cmdq->sync_phys;
+        sync.sync.msidata = seq;
+    }
+
+    ret = smmu_cmdq_batch_add(smmu, batch, &sync);
+    if (!ret)
+        ret = smmu_cmdq_write_cmds(smmu, batch->cmds, batch->num);
+    batch->num = 0;
+    if (ret)
+        return ret;
+
+    return smmu_cmdq_wait_sync(smmu, seq);
 }
 
 static void smmu_strtab_write_ste(smmu_master_t *master, uint64_t *ste)
@@ -260,6 +382,21 @@ static uint32_t smmu_cmd_queue_init(smmu_dev_t *smmu)
                        BITFIELD_SET(QUEUE_BASE_LOG2SIZE, cmdq->queue.log2nent);
 
     cmdq->queue.prod = cmdq->queue.cons = 0;
+
+    /* Target of CMD_SYNC MSIs; without it completion is polled through SMMU_CMDQ_CONS */
+    cmdq->sync_ptr = NULL;
+    cmdq->sync_seq = 0;
+    if (smmu->supported.msi) {
+        /* The SMMU writes this buffer behind the PE's caches, so nothing else may share
+           its writeback granule: a write back of a neighbour would overwrite the MSI */
+        cmdq->sync_size = val_pe_cache_writeback_granule();
+        cmdq->sync_ptr = val_aligned_alloc(cmdq->sync_size, cmdq->sync_size);
+        if (cmdq->sync_ptr != NULL) {
+            val_memory_set((void *)cmdq->sync_ptr, cmdq->sync_size, 0);
+            cmdq->sync_phys = (uint64_t)val_memory_virt_to_phys((void *)cmdq->sync_ptr);
+            val_pe_cache_clean_invalidate_range((uint64_t)cmdq->sync_ptr, cmdq->sync_size);
+        }
+    }
     return 1;
 }
 
@@ -442,7 +579,7 @@ static int smmu_reg_write_sync(smmu_dev_t *smmu, uint32_t val,
     return 1;
 }
 
-static smmu_master_t *smmu_master_at(uint32_t sid)
+static smmu_master_t *smmu_master_find(uint32_t sid)
 {
     struct smmu_master_node *node = g_smmu_master_list_head;
 
@@ -453,6 +590,17 @@ static smmu_master_t *smmu_master_at(uint32_t sid)
         node = node->next;
     }
 
+    return NULL;
+}
+
+static smmu_master_t *smmu_master_at(uint32_t sid)
+{
+    struct smmu_master_node *node;
+    smmu_master_t *master = smmu_master_find(sid);
+
+    if (master != NULL)
+        return master;
+
     node = val_memory_alloc(sizeof(struct smmu_master_node));
     if (node == NULL)
         return NULL;
@@ -653,18 +801,89 @@ static int smmu_dev_disable(smmu_dev_t *smmu)
     return ret;
 }
 
+/**
+  @brief Queue the invalidation of the cached STE of a StreamID and of any context
+         descriptors cached for it.
+  @param smmu  - SMMU owning the command queue
+  @param batch - batch being built
+  @param sid   - StreamID
+  @return 0 on success, -1 on failure
+**/
+static int smmu_cmdq_batch_add_cfgi(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch, uint32_t sid)
+{
+    smmu_cmdq_ent_t ent;
+
+    ent.opcode = CMDQ_OP_CFGI_STE;
+    ent.cfgi.sid = sid;
+    ent.cfgi.leaf = 1;
+    if (smmu_cmdq_batch_add(smmu, batch, &ent))
+        return -1;
+
+    if (smmu->supported.s1p) {
+        ent.opcode = CMDQ_OP_CFGI_CD_ALL;
+        if (smmu_cmdq_batch_add(smmu, batch, &ent))
+            return -1;
+    }
+
+    return 0;
+}
+
+/**
+  @brief Queue the invalidation of every TLB entry tagged with the ASID (stage 1) or
+         VMID (stage 2) a master translates with. Stage 1 STEs leave S2VMID at 0.
+  @param smmu  - SMMU owning the command queue
+  @param batch - batch being built
+  @param stage - SMMU_STAGE_S1 or SMMU_STAGE_S2
+  @param asid  - ASID of the stage 1 context descriptor
+  @param vmid  - VMID of the stage 2 STE
+  @return 0 on success, -1 on failure
+**/
+static int smmu_cmdq_batch_add_tlbi_tag(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch,
+                                        uint32_t stage, uint16_t asid, uint16_t vmid)
+{
+    smmu_cmdq_ent_t ent;
+
+    if (stage == SMMU_STAGE_S2) {
+        ent.opcode = CMDQ_OP_TLBI_S12_VMALL;
+        ent.tlbi.vmid = vmid;
+    } else {
+        ent.opcode = CMDQ_OP_TLBI_NH_ASID;
+        ent.tlbi.asid = asid;
+        ent.tlbi.vmid = 0;
+    }
+
+    return smmu_cmdq_batch_add(smmu, batch, &ent);
+}
+
+static uint16_t smmu_master_asid(smmu_master_t *master)
+{
+    return master->stage == SMMU_STAGE_S1 ? master->stage1_config.cd.asid : 0;
+}
+
+static uint16_t smmu_master_vmid(smmu_master_t *master)
+{
+    return master->stage == SMMU_STAGE_S2 ? master->stage2_config.vmid : 0;
+}
+
 static void smmu_tlbi_cfgi(smmu_dev_t *smmu)
 {
+    smmu_cmdq_batch_t batch;
+    smmu_cmdq_ent_t ent;
+
+    smmu_cmdq_batch_init(&batch);
+
     /* Invalidate any cached configuration */
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CFGI_ALL);
+    ent.opcode = CMDQ_OP_CFGI_ALL;
+    smmu_cmdq_batch_add(smmu, &batch, &ent);
     if (smmu->supported.hyp) {
-        smmu_cmdq_issue_cmd(smmu, CMDQ_OP_TLBI_EL2_ALL);
+        ent.opcode = CMDQ_OP_TLBI_EL2_ALL;
+        smmu_cmdq_batch_add(smmu, &batch, &ent);
     }
 
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_TLBI_NSNH_ALL);
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CMD_SYNC);
+    ent.opcode = CMDQ_OP_TLBI_NSNH_ALL;
+    smmu_cmdq_batch_add(smmu, &batch, &ent);
 
-    smmu_cmdq_poll_until_consumed(smmu);
+    smmu_cmdq_batch_submit(smmu, &batch);
 }
 
 static int smmu_reset(smmu_dev_t *smmu)
@@ -861,6 +1080,9 @@ static uint32_t smmu_probe(smmu_dev_t *smmu)
     if (data & IDR0_S2P)
         smmu->supported.s2p = 1;
 
+    if (data & IDR0_MSI)
+        smmu->supported.msi = 1;
+
     if (!(data & (IDR0_S1P | IDR0_S2P))) {
         val_print(ERROR, "  no translation support!\n ");
         return 0;
@@ -1110,7 +1332,10 @@ uint64_t val_smmu_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt
 {
     smmu_master_t *master;
     smmu_dev_t *smmu;
+    smmu_cmdq_batch_t batch;
     uint64_t *ste;
+    uint32_t remapped = 0, old_stage = SMMU_STAGE_S1;
+    uint16_t old_asid = 0, old_vmid = 0;
 
     if (g_smmu == NULL)
         return 1;
@@ -1136,6 +1361,12 @@ uint64_t val_smmu_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt
         master->smmu = smmu;
         master->sid = master_attr.streamid;
         master->ssid_bits = master_attr.ssid_bits;
+    } else {
+        /* Remapped master: TLB entries of the old translation must go as well */
+        remapped = 1;
+        old_stage = master->stage;
+        old_asid = smmu_master_asid(master);
+        old_vmid = smmu_master_vmid(master);
     }
 
     /* TODO: Support for stage 1 and stage 2 translations in one stream table entry(STE)
@@ -1215,7 +1446,21 @@ uint64_t val_smmu_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt
     if (acs_policy_get_print_level() <= TRACE)
         dump_strtab(ste);
 
-    smmu_tlbi_cfgi(smmu);
+    /* Only this master's STE, CDs and TLB entries can be stale, leave the rest cached */
+    smmu_cmdq_batch_init(&batch);
+    if (smmu_cmdq_batch_add_cfgi(smmu, &batch, master->sid) ||
+        smmu_cmdq_batch_add_tlbi_tag(smmu, &batch, master->stage,
+                                     smmu_master_asid(master), smmu_master_vmid(master)))
+        return 1;
+
+    if (remapped && (old_stage != master->stage || old_asid != smmu_master_asid(master) ||
+                      old_vmid != smmu_master_vmid(master))) {
+        if (smmu_cmdq_batch_add_tlbi_tag(smmu, &batch, old_stage, old_asid, old_vmid))
+            return 1;
+    }
+
+    if (smmu_cmdq_batch_submit(smmu, &batch))
+        return 1;
 
     return 0;
 }
@@ -1261,6 +1506,7 @@ uint32_t val_smmu_config_ste_dcp(smmu_master_attributes_t master_attr, uint32_t
 void val_smmu_unmap(smmu_master_attributes_t master_attr)
 {
     smmu_master_t *master;
+    smmu_cmdq_batch_t batch;
     uint64_t *strtab;
 
     if ((master = smmu_master_at(master_attr.streamid)) == NULL)
@@ -1275,8 +1521,14 @@ void val_smmu_unmap(smmu_master_attributes_t master_attr)
     strtab = master->smmu->strtab_cfg.strtab64 + master_attr.streamid * STRTAB_STE_DWORDS;
     smmu_strtab_write_ste(NULL, strtab);
 
+    /* Drop the cached STE, CDs and TLB entries of this master only */
+    smmu_cmdq_batch_init(&batch);
+    if (!smmu_cmdq_batch_add_cfgi(master->smmu, &batch, master->sid) &&
+        !smmu_cmdq_batch_add_tlbi_tag(master->smmu, &batch, master->stage,
+                                      smmu_master_asid(master), smmu_master_vmid(master)))
+        smmu_cmdq_batch_submit(master->smmu, &batch);
+
     smmu_cdtab_free(master);
-    smmu_tlbi_cfgi(master->smmu);
     val_memory_set(master, sizeof(smmu_master_t), 0);
 }
 
@@ -1324,6 +1576,8 @@ void val_smmu_stop(void)
         smmu_dev_disable(smmu);
         if (smmu->cmdq.base_ptr)
             val_memory_free(smmu->cmdq.base_ptr);
+        if (smmu->cmdq.sync_ptr)
+            val_memory_free_aligned((void *)smmu->cmdq.sync_ptr);
         if (smmu->evntq.base_ptr)
             val_memory_free(smmu->evntq.base_ptr);
         smmu_free_strtab(smmu);
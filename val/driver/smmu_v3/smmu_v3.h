@@ -37,10 +37,39 @@ static inline uint64_t get_max(uint64_t x, uint64_t y)
 
 #define CMDQ_OP_CFGI_STE 0x3
 #define CMDQ_OP_CFGI_ALL 0x4
+#define CMDQ_OP_CFGI_CD_ALL 0x6
+#define CMDQ_OP_TLBI_NH_ASID 0x11
 #define CMDQ_OP_TLBI_EL2_ALL 0x20
+#define CMDQ_OP_TLBI_S12_VMALL 0x28
 #define CMDQ_OP_TLBI_NSNH_ALL 0x30
 #define CMDQ_OP_CMD_SYNC 0x46
 
+/* Commands collected before the batch is written to the queue */
+#define SMMU_CMDQ_BATCH_ENTS 64
+
+typedef struct {
+    uint8_t opcode;
+    union {
+        struct {
+            uint32_t sid;
+            uint8_t  leaf;
+        } cfgi;
+        struct {
+            uint16_t asid;
+            uint16_t vmid;
+        } tlbi;
+        struct {
+            uint32_t msidata;
+            uint64_t msiaddr;  /* 0: no MSI, completion is seen through SMMU_CMDQ_CONS */
+        } sync;
+    };
+} smmu_cmdq_ent_t;
+
+typedef struct {
+    uint64_t cmds[SMMU_CMDQ_BATCH_ENTS * CMDQ_DWORDS_PER_ENT];
+    uint32_t num;
+} smmu_cmdq_batch_t;
+
 typedef struct {
     uint32_t prod;
     uint32_t cons;
@@ -56,6 +85,10 @@ typedef struct {
     uint64_t entry_size;
     uint32_t *prod_reg;
     uint32_t *cons_reg;
+    volatile uint32_t *sync_ptr;   /* CMD_SYNC MSI target, NULL if MSIs are not used */
+    uint32_t sync_size;            /* sync_ptr owns whole writeback granules */
+    uint64_t sync_phys;
+    uint32_t sync_seq;
 } smmu_cmd_queue_t;
 
 typedef struct {
@@ -26,17 +26,66 @@
  * invocation. It contains only "how to run" inputs gathered from platform
  * defaults, build overrides, CLI parsing, or EL3-provided parameters:
  * - print verbosity and MMIO-print enablement
+ * - binary MMIO access recording (baremetal)
+ * - binary trace logging of TRACE/DEBUG messages
+ * - resident secondary-PE workers
+ * - per-rule timing and PSCI/MMIO count report
+ * - parallel execution of independent rules on secondary PEs
  * - PCIe/CXL behavior hints
+ * - PCIe config-space snapshot cache enablement
+ * - PCIe pruned enumeration enablement
+ * - PCIe bit-field checks split across PEs
  * - wakeup/watchdog/timer timeout controls
  * - crypto-extension and EL1 trap workarounds
+ * - in-memory NIST STS stream length
  * - system last-level cache hinting
  */
 typedef struct acs_execution_policy {
     uint32_t pcie_p2p;
     uint32_t pcie_cache_present;
     bool     pcie_skip_dp_nic_ms;
+    /*
+     * Serve repeated PCIe config reads from a per-BDF snapshot. Status
+     * registers always bypass the snapshot and writes invalidate it.
+     */
+    uint32_t pcie_cfg_cache;
+    /*
+     * Enumerate PCIe functions following bridge bus ranges and the
+     * multi-function bit instead of probing every bus/dev/func.
+     */
+    uint32_t pcie_enum_prune;
+    /*
+     * Split the BDFs of PCIe bit-field compliance checks across PEs.
+     * Failures are still reported in BDF table order.
+     */
+    uint32_t pcie_bf_parallel;
     uint32_t print_level;
     uint32_t print_mmio;
+    /*
+     * Record this many most recent pal_mmio_* accesses in a memory ring and
+     * dump them as an @ACSMMIO block at end of run. 0 disables recording.
+     */
+    uint32_t mmio_record;
+    /*
+     * Record TRACE and DEBUG messages in per-PE binary buffers instead of
+     * formatting them, and dump the buffers at test boundaries.
+     */
+    uint32_t binary_log;
+    /*
+     * Keep secondary PEs parked in a WFE loop on their mailbox between
+     * payloads instead of powering them off and on through PSCI.
+     */
+    uint32_t pe_resident;
+    /*
+     * Time every rule with the virtual counter, count the PSCI calls and
+     * MMIO accesses it issues, and print a JSON-lines report at end of run.
+     */
+    uint32_t rule_profile;
+    /*
+     * Run the rules marked RULE_EXEC_PARALLEL_SAFE on idle secondary PEs
+     * before the serial pass, which prints their buffered output in order.
+     */
+    uint32_t rule_parallel;
     uint32_t timeout_pass;
     uint32_t timeout_fail;
     uint32_t timer_timeout_us;
@@ -53,6 +102,11 @@ typedef struct acs_execution_policy {
      * not safely expose them. Compose with EL1SKIPTRAP_* flags.
      */
     uint32_t el1skiptrap_mask;
+    /*
+     * Run the NIST STS tests on packed in-memory sequences of this many bits
+     * instead of the file based suite. 0 keeps the file based suite.
+     */
+    uint32_t nist_stream_bits;
 } acs_execution_policy_t;
 
 void acs_reset_execution_policy(void);
@@ -60,14 +114,23 @@ acs_execution_policy_t *acs_get_execution_policy_mut(void);
 const acs_execution_policy_t *acs_get_execution_policy(void);
 uint32_t acs_policy_get_print_level(void);
 uint32_t acs_policy_get_print_mmio(void);
+uint32_t acs_policy_get_mmio_record(void);
+uint32_t acs_policy_get_binary_log(void);
+uint32_t acs_policy_get_pe_resident(void);
+uint32_t acs_policy_get_rule_profile(void);
+uint32_t acs_policy_get_rule_parallel(void);
 uint32_t acs_policy_get_pcie_p2p(void);
 uint32_t acs_policy_get_pcie_cache_present(void);
 bool acs_policy_get_pcie_skip_dp_nic_ms(void);
+uint32_t acs_policy_get_pcie_cfg_cache(void);
+uint32_t acs_policy_get_pcie_enum_prune(void);
+uint32_t acs_policy_get_pcie_bf_parallel(void);
 uint32_t acs_policy_get_timeout_pass(void);
 uint32_t acs_policy_get_timeout_fail(void);
 uint32_t acs_policy_get_timer_timeout_us(void);
 uint32_t acs_policy_get_crypto_support(void);
 uint32_t acs_policy_get_sys_last_lvl_cache(void);
 uint32_t acs_policy_get_el1skiptrap_mask(void);
+uint32_t acs_policy_get_nist_stream_bits(void);
 
 #endif /* __ACS_EXECUTION_POLICY_H__ */
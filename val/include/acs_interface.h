@@ -35,4 +35,16 @@ typedef struct {
 acs_test_status_counters_t *acs_get_test_status(void);
 void acs_reset_test_status(void);
 
+/* Activity counters sampled around every rule for the -profile report. They
+   are incremented without atomics, so PEs running concurrently may lose counts */
+extern uint64_t g_psci_call_count;     /* PSCI calls issued through pal_pe_call_smc */
+extern uint64_t g_pe_dispatch_count;   /* payloads dispatched to secondary PEs */
+
+/* Per-PE counters of the -profile report, kept only while profiling */
+uint32_t val_pe_profile_start(void);
+void     val_pe_profile_stop(void);
+void     val_pe_profile_dispatch(uint32_t index);
+uint64_t val_pe_profile_mmio_count(void);
+uint32_t val_pe_profile_pe_count(uint64_t since);
+
 #endif /* __ACS_INTERFACE_H__ */
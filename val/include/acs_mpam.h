@@ -162,6 +162,40 @@ uint32_t val_mpam_mbwu_is_overflow_set(uint32_t msc_index);
 uint32_t val_mpam_mbwu_clear_overflow_status(uint32_t msc_index);
 void     val_mpam_mbwu_wait_for_update(uint32_t msc_index);
 
+/* Multi-PE memory traffic engine */
+typedef enum {
+    MEM_TRAFFIC_READ = 0,
+    MEM_TRAFFIC_WRITE,
+    MEM_TRAFFIC_COPY,
+    MEM_TRAFFIC_COPY_NT
+} MEM_TRAFFIC_TYPE_e;
+
+/* partid value that leaves MPAM2_EL2 of the stream's PE untouched */
+#define MEM_TRAFFIC_NO_PARTID        0xFFFFFFFF
+/* Alignment of src/dst and granule of size for a traffic stream */
+#define MEM_TRAFFIC_ALIGN            64
+/* Time allowed for all streams to complete, in seconds */
+#define MEM_TRAFFIC_TIMEOUT_SEC      120
+
+typedef struct {
+    /* Inputs */
+    uint32_t pe_index;         /* PE running the stream, may be the primary PE */
+    MEM_TRAFFIC_TYPE_e type;
+    uint32_t partid;           /* PARTID_D programmed in MPAM2_EL2 or MEM_TRAFFIC_NO_PARTID */
+    uint32_t pmg;              /* PMG_D programmed in MPAM2_EL2 */
+    uint64_t src;              /* Read, copy and non-temporal copy streams */
+    uint64_t dst;              /* Write, copy and non-temporal copy streams */
+    uint64_t size;             /* Bytes accessed per pass */
+    uint32_t passes;
+    /* Outputs */
+    uint32_t status;           /* ACS_STATUS_PASS once the stream has completed */
+    uint64_t bytes;            /* Bytes read plus bytes written */
+    uint64_t ticks;            /* CNTVCT ticks taken by the stream */
+    uint64_t bytes_per_sec;
+} MEM_TRAFFIC_STREAM_t;
+
+uint32_t val_mem_traffic_run(MEM_TRAFFIC_STREAM_t *streams, uint32_t num_streams);
+
 uint32_t mpam001_entry(uint32_t num_pe);
 uint32_t mpam002_entry(uint32_t num_pe);
 uint32_t mpam003_entry(uint32_t num_pe);
@@ -1,5 +1,5 @@
 /** @file
- * Copyright (c) 2024-2025, Arm Limited or its affiliates. All rights reserved.
+ * Copyright (c) 2024-2026, Arm Limited or its affiliates. All rights reserved.
  * SPDX-License-Identifier : Apache-2.0
 
  * Licensed under the Apache License, Version 2.0 (the "License");
@@ -20,7 +20,65 @@
 
 extern uint32_t test_select;
 
+/* Significance level of a single STS p-value */
+#define NIST_ALPHA              0.01
+
+/* Smallest stream accepted by the in-memory pipeline (STS LongestRun needs 128 bits,
+ * the default STS sequence length is used as the floor)
+ */
+#define NIST_STREAM_MIN_BITS    100000
+
+/* STS default block lengths */
+#define NIST_BLOCK_FREQ_M       128
+#define NIST_APEN_M             10
+#define NIST_SERIAL_M           16
+
+/* Bit i of a packed stream is bit (63 - i % 64) of word i / 64: the first bit
+ * of the stream is the MSB of the first word, as in the ASCII data file.
+ */
+#define NIST_STREAM_BIT(words, i) \
+        ((uint32_t)(((words)[(i) >> 6] >> (63 - ((i) & 63))) & 1))
+#define NIST_STREAM_WORDS(bits) (((bits) + 63) >> 6)
+/* Stream buffers carry one zero word past the data, so the word-parallel kernels
+ * can read 64 bits at any bit offset of the stream.
+ */
+#define NIST_STREAM_ALLOC_WORDS(bits) (NIST_STREAM_WORDS(bits) + 1)
+
+/* Entries of the pattern count table passed to val_nist_stream_test() */
+#define NIST_PATTERN_ENTRIES    (1u << NIST_SERIAL_M)
+
+typedef enum {
+  NIST_STAT_FREQUENCY = 0,
+  NIST_STAT_BLOCK_FREQUENCY,
+  NIST_STAT_CUSUM_FORWARD,
+  NIST_STAT_CUSUM_REVERSE,
+  NIST_STAT_RUNS,
+  NIST_STAT_LONGEST_RUN,
+  NIST_STAT_APEN,
+  NIST_STAT_SERIAL_1,
+  NIST_STAT_SERIAL_2,
+  NIST_STAT_COUNT
+} NIST_STAT_e;
+
+/* p-values of one sequence, NIST_P_VALUE_NA when a test does not apply */
+#define NIST_P_VALUE_NA         (-1.0)
+
+typedef struct {
+  double p_value[NIST_STAT_COUNT];
+} NIST_STREAM_RESULT_t;
+
 uint32_t n001_entry(uint32_t num_pe);
 double erf(double x);
 double erfc(double x);
+
+/* Special functions of the STS (cephes.c) */
+double cephes_igamc(double a, double x);
+double cephes_normal(double x);
+
+uint32_t val_nist_generate_stream(uint64_t *words, uint64_t num_bits);
+const char8_t *val_nist_stream_stat_name(uint32_t stat);
+uint32_t val_nist_stream_test(const uint64_t *words, uint64_t num_bits, uint32_t *count,
+                              NIST_STREAM_RESULT_t *result);
+uint32_t val_nist_stream_compare(const uint64_t *words, uint64_t num_bits, uint32_t *count);
+uint32_t val_nist_stream_self_check(void);
 #endif
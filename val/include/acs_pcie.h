@@ -84,6 +84,27 @@
 /* Allows storage of 2048 valid BDFs */
 #define PCIE_DEVICE_BDF_TABLE_SZ 8192
 
+/* Config space snapshot cache sizing */
+#define PCIE_CFG_CACHE_MAX_BDF   2048  /* Entries of the BDF table */
+#define PCIE_CFG_CACHE_MAX_CAP   32
+
+#define PCIE_HIER_NONE           0xFFFFFFFF
+
+/**
+  @brief PCIe segment/bus to ECAM lookup map, built once from the PCIe Info Table
+**/
+#define PCIE_ECAM_MAP_MAX_SEG     16
+#define PCIE_ECAM_MAP_NUM_BUS     256
+#define PCIE_ECAM_MAP_NUM_SEG_IDS 256
+
+typedef struct {
+  uint32_t num_segments;                          ///< Segments with a slot in the map
+  uint32_t overflow;                              ///< Info blocks left out of the map
+  uint8_t  seg_slot[PCIE_ECAM_MAP_NUM_SEG_IDS];   ///< Segment to slot + 1, 0 if not mapped
+  uint8_t  ecam_index[PCIE_ECAM_MAP_MAX_SEG][PCIE_ECAM_MAP_NUM_BUS]; ///< Info block + 1
+  uint64_t ecam_base[PCIE_ECAM_MAP_MAX_SEG][PCIE_ECAM_MAP_NUM_BUS];  ///< 0 if not mapped
+} PCIE_ECAM_MAP;
+
 typedef enum {
   HEADER = 0,
   PCIE_CAP = 1,
@@ -161,6 +182,45 @@ typedef struct {
   pcie_device_attr device[];         ///< in the format of Segment/Bus/Dev/Func
 } pcie_device_bdf_table;
 
+/**
+  @brief    Config space snapshot cache counters
+  @hits             Config reads served from a BDF snapshot
+  @misses           Config reads that filled a BDF snapshot from ECAM
+  @bypass           Config reads of status registers, always read from ECAM
+  @invalidations    Number of BDF snapshots dropped by config writes
+  @cap_hits         Capability lookups served from the capability index
+  @mmio_saved       ECAM reads avoided by snapshot hits and capability index hits
+**/
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t bypass;
+  uint64_t invalidations;
+  uint64_t cap_hits;
+  uint64_t mmio_saved;
+} pcie_cfg_cache_stats;
+
+/**
+  @brief    Node of the PCIe hierarchy index, one per BDF table entry
+  @bdf              Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @dp_type          Device/port type as returned by val_pcie_device_port_type
+  @hdr_type         Header layout, TYPE0_HEADER or TYPE1_HEADER
+  @sec_bus          Secondary bus number, Type 1 functions only
+  @sub_bus          Subordinate bus number, Type 1 functions only
+  @rootport         Node of the Root Port above this function
+  @dsf              Node returned by val_pcie_get_downstream_function
+**/
+typedef struct {
+  uint32_t bdf;
+  uint32_t dp_type;
+  uint8_t  hdr_type;
+  uint8_t  sec_bus;
+  uint8_t  sub_bus;
+  uint8_t  reserved;
+  uint32_t rootport;
+  uint32_t dsf;
+} pcie_hier_node;
+
 void     val_pcie_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data);
 void     val_pcie_io_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data);
 uint32_t val_pcie_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data);
@@ -203,6 +263,19 @@ uint32_t val_pcie_get_atomicop_requester_capable(uint32_t bdf);
 uint32_t val_pcie_get_cap_ptr(uint32_t bdf);
 uint32_t val_pcie_get_bist(uint32_t bdf);
 uint32_t val_pcie_ari_forwarding_support(uint32_t bdf);
+uint32_t val_pcie_cfg_cache_init(void);
+void     val_pcie_cfg_cache_invalidate(uint32_t bdf);
+void     val_pcie_cfg_cache_invalidate_all(void);
+void     val_pcie_cfg_cache_suspend(void);
+void     val_pcie_cfg_cache_resume(void);
+void     val_pcie_cfg_cache_print_stats(void);
+void     val_pcie_cfg_cache_free(void);
+uint32_t val_pcie_rescan_subtree(uint32_t bdf);
+uint32_t val_pcie_get_enum_probe_count(void);
+uint32_t val_pcie_hierarchy_build(void);
+void     val_pcie_hierarchy_invalidate(void);
+void     val_pcie_hierarchy_free(void);
+pcie_hier_node *val_pcie_hierarchy_get_node(uint32_t bdf);
 
 uint32_t p001_entry(uint32_t num_pe);
 uint32_t p002_entry(uint32_t num_pe);
@@ -151,6 +151,7 @@
 #define TYPE1_P_MEM     0x24
 #define TYPE1_P_MEM_BU  0x28    /* Prefetchable Base Upper Offset */
 #define TYPE1_P_MEM_LU  0x2C    /* Prefetchable Limit Upper Offset */
+#define TYPE1_IO_BLU    0x30    /* I/O Base and Limit Upper Offset */
 
 /* Type 1 Bridge Control Register */
 #define BRIDGE_CTRL_SBR_SET     0x400000
@@ -221,6 +222,8 @@
 #define DCTLR_OFFSET   0x8
 #define LCAPR_OFFSET   0xC
 #define LCTRLR_OFFSET  0x10
+#define SLCTRLR_OFFSET 0x18
+#define RSTSR_OFFSET   0x20
 #define DCAP2R_OFFSET  0x24
 #define DCTL2R_OFFSET  0x28
 #define LCAP2R_OFFSET  0x2C
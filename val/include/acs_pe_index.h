@@ -0,0 +1,30 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#ifndef __ACS_PE_INDEX_H__
+#define __ACS_PE_INDEX_H__
+
+/*
+ * Every PE caches its own PE index in TPIDR_EL2, or TPIDR_EL1 when running
+ * at EL1. Bits [63:32] hold the tag, bits [31:0] the index. A value without
+ * the tag was not written by ACS and must not be taken for an index.
+ */
+#define PE_INDEX_TPIDR_TAG       0x4143530000000000ULL
+#define PE_INDEX_TPIDR_TAG_MASK  0xFFFFFFFF00000000ULL
+#define PE_INDEX_TPIDR_INDEX(v)  ((uint32_t)((v) & 0xFFFFFFFFULL))
+
+#endif /* __ACS_PE_INDEX_H__ */
@@ -24,12 +24,38 @@
 #include "acs_common.h"
 
 
+/* Per-PE test data, padded to a shared line */
 typedef struct {
   uint64_t    data0;
   uint64_t    data1;
   uint32_t    status;
+  uint8_t     reserved[VAL_SHARED_LINE_SIZE - 20];
 }VAL_SHARED_MEM_t;
 
+/* Resident worker mailbox states, written by the secondary PE */
+#define PE_WORKER_OFF       0
+#define PE_WORKER_PARKED    1
+#define PE_WORKER_BUSY      2
+
+/* Resident worker mailbox commands, written by the primary PE */
+#define PE_WORKER_RUN       1
+#define PE_WORKER_EXIT      2
+
+/* Per-PE mailbox of a resident worker, two shared lines. The primary PE owns
+   the command line and the secondary PE the reply line that follows it. */
+typedef struct {
+  volatile uint32_t    seq;      /* Bumped by the primary PE for every posted command */
+  volatile uint32_t    cmd;
+  volatile uint32_t    lost;     /* Worker stopped answering, the PE is not used again */
+  uint8_t              reserved[VAL_SHARED_LINE_SIZE - 12];
+}VAL_PE_MAILBOX_t;
+
+typedef struct {
+  volatile uint32_t    ack;      /* Last seq taken by the secondary PE */
+  volatile uint32_t    state;
+  uint8_t              reserved[VAL_SHARED_LINE_SIZE - 8];
+}VAL_PE_MAILBOX_REPLY_t;
+
 uint64_t
 val_pe_reg_read(uint32_t reg_id);
 
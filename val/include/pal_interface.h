@@ -66,6 +66,10 @@
   #define TIMEOUT_MEDIUM              PLATFORM_BM_OVERRIDE_TIMEOUT_MEDIUM
   #define TIMEOUT_SMALL               PLATFORM_BM_OVERRIDE_TIMEOUT_SMALL
   #define SYS_TIMEOUT_MAX             PLATFORM_OVERRIDE_SYS_TIMEOUT_MAX
+
+  void pal_heap_print_stats(void);
+  uint32_t pal_mmio_record_start(uint32_t num_records);
+  void pal_mmio_record_dump(void);
 #endif // TARGET_BAREMETAL
 
 #ifdef TARGET_LINUX
@@ -304,7 +308,6 @@ typedef struct {
  uint64_t     Base;
  uint64_t     CommandQBase;
  uint32_t     IDBits;
- uint64_t     ITTBase;
 } GIC_ITS_BLOCK;
 
 typedef struct {
@@ -426,6 +429,7 @@ void     pal_pci_cfg_write(uint32_t bus, uint32_t dev, uint32_t func, int offset
 uint32_t pal_pci_cfg_read(uint32_t bus, uint32_t dev, uint32_t func, int offset, uint32_t *value);
 
 uint64_t pal_pcie_get_mcfg_ecam(uint32_t bdf);
+void     pal_pcie_set_ecam_resolver(uint64_t (*resolve)(uint32_t seg, uint32_t bus));
 void     pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable);
 uint32_t pal_pcie_io_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data);
 uint32_t pal_pcie_get_bdf_wrapper(uint32_t class_code, uint32_t start_bdf);
@@ -789,6 +793,7 @@ uint32_t pal_mem_set_wb_executable(void *addr, uint32_t size);
 /* Common Definitions */
 void     pal_print(uint64_t data);
 void     pal_uart_print(int log, const char *fmt, ...);
+void     pal_print_set_sync_hook(void (*hook)(void));
 void     pal_print_raw(uint64_t addr, char8_t *string, uint64_t data);
 void     pal_uart_putc(char c);
 uint32_t pal_strncmp(char8_t *str1, char8_t *str2, uint32_t len);
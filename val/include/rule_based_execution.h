@@ -40,8 +40,18 @@ typedef struct {
     uint32_t         test_num;
     char8_t          platform_bitmask;
     char8_t          rule_desc[RULE_DESC_SIZE];
+    uint8_t          exec_flags;    /* RULE_EXEC_* */
 } rule_test_map_t;
 
+/* rule_test_map_t.exec_flags
+ * RULE_EXEC_PARALLEL_SAFE: the test runs on the calling PE only, does not
+ * change state shared with other tests (GIC, SMMU, system timers and
+ * watchdogs, RAS error records, power, exception vectors, config space writes,
+ * memory allocation) and uses no firmware service that is restricted to the
+ * primary PE. With -ruleparallel such rules may run on a
+ * secondary PE while other rules run elsewhere. */
+#define RULE_EXEC_PARALLEL_SAFE  0x1
+
 /* Alias rules to Base rule mapping definition
  * base_rule_list must be terminated with RULE_ID_SENTINEL */
 typedef struct {
@@ -82,6 +92,65 @@ typedef struct {
     PFDI_LEVEL_e level;
 } pfdi_rule_entry_t;
 
+/* Per-rule profile record, accumulated by run_tests() when -profile is set.
+ * Ticks are virtual counter ticks; an alias rule includes its precheck and
+ * the base rules it ran. */
+typedef struct {
+    uint64_t ticks;
+    uint64_t precheck_ticks;
+    uint64_t psci_calls;
+    uint64_t mmio_accesses;
+    uint64_t pe_dispatches;
+    uint32_t pe_count;      /* most secondary PEs a run of the rule dispatched to */
+    uint32_t runs;
+    uint32_t top_level;     /* rule was in the run list, not only reached through an alias */
+} rule_profile_t;
+
+/* Counter values captured when a profiled section starts */
+typedef struct {
+    uint64_t start;
+    uint64_t psci_calls;
+    uint64_t mmio_accesses;
+    uint64_t pe_dispatches;
+} rule_profile_sample_t;
+
+/* Set of rule IDs, one bit per RULE_ID_e */
+#define RULE_BITSET_WORDS  ((RULE_ID_SENTINEL + 63) / 64)
+
+typedef struct {
+    uint64_t word[RULE_BITSET_WORDS];
+} rule_bitset_t;
+
+static inline void rule_bitset_set(rule_bitset_t *set, RULE_ID_e rule_id)
+{
+    set->word[rule_id / 64] |= 1ULL << (rule_id % 64);
+}
+
+static inline bool rule_bitset_test(const rule_bitset_t *set, RULE_ID_e rule_id)
+{
+    return (set->word[rule_id / 64] >> (rule_id % 64)) & 1;
+}
+
+/* -skip, -skipmodule and -m selections of a run request, see rule_filter_init() */
+typedef struct {
+    rule_bitset_t skip_rules;
+    uint64_t      skip_modules;     /* bit per MODULE_NAME_e */
+    uint64_t      run_modules;      /* bit per MODULE_NAME_e, used if module_select */
+    bool          module_select;
+} rule_filter_t;
+
+/* Levels and software views of the rules of one architecture lookup table
+ * (rule_lookup.c), indexed by RULE_ID_e. See rule_arch_index_get(). */
+typedef struct {
+    uint32_t      arch;             /* ARCH_SEL_e */
+    uint32_t      count;            /* entries in order[] */
+    uint32_t      fr_level;         /* level value of FR, 0 if the table has none */
+    rule_bitset_t present;
+    RULE_ID_e     order[RULE_ID_SENTINEL];  /* table order, duplicates dropped */
+    uint8_t       level[RULE_ID_SENTINEL];
+    uint8_t       sw_view[RULE_ID_SENTINEL];
+} rule_arch_index_t;
+
 /* ---------------------------- Helper functions declarations ---------------------------------- */
 void     quick_sort_rule_list(RULE_ID_e *rule_list, uint32_t list_size);
 uint32_t check_module_init(MODULE_NAME_e module_id);
@@ -90,10 +159,23 @@ void     print_rule_test_start(uint32_t rule_enum, uint32_t indent);
 void     print_rule_test_status(uint32_t rule_enum, uint32_t indent, uint32_t status);
 void     rule_status_map_reset(void);
 bool     rule_in_list(RULE_ID_e rid, const RULE_ID_e *list, uint32_t count);
+void     rule_filter_init(const acs_run_request_t *ctx, rule_filter_t *filter);
+bool     rule_filter_skips(const rule_filter_t *filter, RULE_ID_e rule_id);
+bool     rule_filter_module_selected(const rule_filter_t *filter, RULE_ID_e rule_id);
+const rule_arch_index_t *rule_arch_index_get(uint32_t arch);
+bool     rule_arch_level_selected(const rule_arch_index_t *index, const acs_run_request_t *ctx,
+                                  RULE_ID_e rule_id);
 void     print_pal_validation_info(uint32_t rule_enum, uint32_t indent);
+void     rule_profile_reset(void);
+void     rule_profile_start(rule_profile_sample_t *sample);
+void     rule_profile_stop(RULE_ID_e rule_id, const rule_profile_sample_t *sample,
+                           uint32_t top_level);
+void     rule_profile_precheck_stop(RULE_ID_e rule_id, const rule_profile_sample_t *sample);
+void     rule_profile_report(uint32_t num_pe);
 
 /* ---------------------------- Externs ---------------------------- */
 extern uint32_t rule_status_map[RULE_ID_SENTINEL];
+extern rule_profile_t rule_profile_map[RULE_ID_SENTINEL];
 
 /* Rule lookup tables (defined in rule_lookup.c) */
 extern const bsa_rule_entry_t bsa_rule_list[];
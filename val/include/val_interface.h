@@ -91,8 +91,11 @@ typedef enum {
 typedef char char8_t;
 
 /* GENERIC VAL APIs */
-void val_allocate_shared_mem(void);
+uint32_t val_allocate_shared_mem(void);
+uint32_t val_get_shared_line_size(void);
 uintptr_t val_get_status_region_base(void);
+uintptr_t val_get_done_bitmap_base(void);
+uintptr_t val_get_mailbox_region_base(void);
 void val_free_shared_mem(void);
 //void val_print(uint32_t level, char8_t *string, uint64_t data);
 void val_print_raw(uint64_t uart_addr, uint32_t level, char8_t *string, uint64_t data);
@@ -117,13 +120,19 @@ typedef enum {
   PE_FEAT_MPAM,
   PE_FEAT_PMU,
   PE_FEAT_RAS,
-  PE_FEAT_RME
+  PE_FEAT_RME,
+  PE_FEAT_ADVSIMD
 } PE_FEAT_NAME;
 
 void     val_pe_cache_clean_invalidate_range(uint64_t start_addr, uint64_t length);
 void     val_pe_cache_invalidate_range(uint64_t start_addr, uint64_t length);
+uint32_t val_pe_cache_writeback_granule(void);
 void     val_pe_free_info_table(void);
 void     val_execute_on_pe(uint32_t index, void (*payload)(void), uint64_t args);
+void     val_execute_on_pe_resident(uint32_t index, void (*payload)(void), uint64_t args);
+uint32_t val_pe_usable(uint32_t index);
+void     val_pe_mark_lost(uint32_t index);
+void     val_pe_worker_pool_stop(void);
 void     val_smbios_create_info_table(uint64_t *smbios_info_table);
 void     val_smbios_free_info_table(void);
 
@@ -199,6 +208,18 @@ uint32_t val_gic_its_get_base(uint32_t its_id, uint64_t *its_base);
 uint32_t val_gic_request_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id,
                              uint32_t int_id, uint32_t msi_index);
 
+/* One device MSI of a batched request */
+typedef struct {
+  uint32_t bdf;
+  uint32_t device_id;
+  uint32_t its_id;
+  uint32_t int_id;
+  uint32_t msi_index;
+} GIC_MSI_REQUEST;
+
+uint32_t val_gic_request_msi_batch(GIC_MSI_REQUEST *req, uint32_t num);
+void     val_gic_free_msi_batch(GIC_MSI_REQUEST *req, uint32_t num);
+
 uint32_t val_bsa_gic_execute_tests(uint32_t num_pe, uint32_t *g_sw_view);
 uint32_t val_gic_route_interrupt_to_pe(uint32_t int_id, uint64_t mpidr);
 uint32_t val_gic_get_interrupt_state(uint32_t int_id);
@@ -31,5 +31,22 @@ uint32_t val_printf(print_verbosity_t verbosity, const char *msg, ...);
 
 void val_mem_copy(char *dest, const char *src, size_t len);
 
+/* Per-PE logging, see val_logger.c */
+#define LOG_PE_RING_SIZE      0x800     /* per-PE text ring of a secondary PE */
+
+void val_log_init(uint32_t num_pe);
+void val_log_flush(void);
+void val_log_drain(void);
+void val_log_free(void);
+uint32_t val_log_capture_start(char *buf, uint32_t size);
+uint32_t val_log_capture_stop(void);
+void val_log_replay(const char *text, uint32_t len);
+
+/* Binary trace mode, see val_logger.c and tools/scripts/acs_log_decode.py */
+#define LOG_TRACE_BUF_SIZE    0x4000    /* per-PE record buffer */
+#define LOG_TRACE_MAX_ARGS    16
+#define LOG_TRACE_LINE_BYTES  72        /* record bytes per base64 line, multiple of 3 */
+#define LOG_TRACE_MARKER      "@ACSBIN"
+
 #endif /* VAL_LOG_H */
 
@@ -0,0 +1,42 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __VAL_MEMOPS_H__
+#define __VAL_MEMOPS_H__
+
+#include "pal_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef TARGET_LINUX
+/* AArch64/MemOps.S */
+uint64_t MemOpsSimdAccess(void);
+void MemOpsUpdateBits(volatile uint64_t *word, uint64_t clear, uint64_t set);
+
+void MemTrafficRead(const void *src, uint64_t len);
+void MemTrafficWrite(void *dst, uint64_t len, uint64_t pattern);
+void MemTrafficCopy(void *dst, const void *src, uint64_t len);
+void MemTrafficCopyNt(void *dst, const void *src, uint64_t len);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __VAL_MEMOPS_H__ */
@@ -23,13 +23,24 @@
 
 #include "pal_interface.h"
 
-/* Structure to capture test state */
+/* Every PE owns one line of each shared memory region. val_allocate_shared_mem()
+   widens the line to the CTR_EL0.CWG writeback granule when that is larger */
+#ifndef VAL_SHARED_LINE_SIZE
+#define VAL_SHARED_LINE_SIZE   64u
+#endif
+
+/* Structure to capture test state, padded to a cache line */
 typedef struct {
     uint32_t index;
     uint8_t  state;
     uint16_t status_code;
+    uint8_t  reserved[VAL_SHARED_LINE_SIZE - 8];
 } val_test_status_t;
 
+/* Completion bitmap: one bit per PE, set while the PE status is not pending */
+#define VAL_DONE_BITMAP_SIZE(num_pe) \
+    ((((num_pe) + 511u) / 512u) * VAL_SHARED_LINE_SIZE)
+
 /* =========================================================
  * TEST STATES
  * ========================================================= */
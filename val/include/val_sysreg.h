@@ -33,9 +33,11 @@ typedef unsigned long u_register_t;
 #endif
 
 /**********************************************************************
- * Macros to create inline functions for system instructions
+ * Macros to create inline functions for system instructions. A build
+ * that does not run on the PE itself defines them before this header.
  *********************************************************************/
 
+#ifndef SYSOP_FUNC
 /* Define function for simple system instruction */
 #define SYSOP_FUNC(_op)                     \
 static inline void _op(void)                \
@@ -56,6 +58,7 @@ static inline void _op ## _type(uint64_t v)                             \
 {                                                                       \
      __asm__ volatile (#_op " " #_type ", %0" :: "r"(v) : "memory");    \
 }
+#endif
 
 SYSOP_FUNC(isb)
 
@@ -64,6 +67,7 @@ SYSOP_FUNC(isb)
  * registers
  *********************************************************************/
 
+#ifndef _SYSREG_READ_FUNC
 #define _SYSREG_READ_FUNC(_name, _reg_name)        \
 static inline u_register_t read_ ## _name(void)            \
 {                                \
@@ -71,7 +75,9 @@ static inline u_register_t read_ ## _name(void)            \
     __asm__ volatile ("mrs %0, " #_reg_name : "=r" (v));    \
     return v;                        \
 }
+#endif
 
+#ifndef _SYSREG_WRITE_FUNC
 #define _SYSREG_WRITE_FUNC(_name, _reg_name)            \
 static inline void write_ ## _name(u_register_t v)            \
 {                                    \
@@ -84,6 +90,7 @@ static inline void write_ ## _name(u_register_t v)            \
         __asm__ volatile ("msr " #reg_name ", %0" : : "i" (v)); \
         isb();                                                 \
     } while (0)
+#endif
 
 /* Define read function for system register */
 #define SYSREG_READ_FUNC(_name)             \
@@ -150,6 +157,7 @@ SYSOP_TYPE_FUNC(tlbi, alle3is)
 #endif
 SYSOP_TYPE_FUNC(tlbi, vmalle1)
 
+SYSOP_TYPE_PARAM_FUNC(tlbi, ipas2e1is)
 SYSOP_TYPE_PARAM_FUNC(tlbi, vaae1is)
 SYSOP_TYPE_PARAM_FUNC(tlbi, vaale1is)
 SYSOP_TYPE_PARAM_FUNC(tlbi, vae2is)
@@ -368,6 +376,8 @@ SYSREG_READ_FUNC(cntvct_el0)
 #define clr_cntp_ctl_enable(x)  ((x) &= ~(U(1) << CNTP_CTL_ENABLE_SHIFT))
 #define clr_cntp_ctl_imask(x)   ((x) &= ~(U(1) << CNTP_CTL_IMASK_SHIFT))
 
+SYSREG_RW_FUNCS(tpidr_el1)
+SYSREG_RW_FUNCS(tpidr_el2)
 SYSREG_RW_FUNCS(tpidr_el3)
 
 SYSREG_READ_FUNC(isr_el1)
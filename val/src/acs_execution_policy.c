@@ -53,6 +53,31 @@ uint32_t acs_policy_get_print_mmio(void)
     return g_execution_policy.print_mmio;
 }
 
+uint32_t acs_policy_get_mmio_record(void)
+{
+    return g_execution_policy.mmio_record;
+}
+
+uint32_t acs_policy_get_binary_log(void)
+{
+    return g_execution_policy.binary_log;
+}
+
+uint32_t acs_policy_get_pe_resident(void)
+{
+    return g_execution_policy.pe_resident;
+}
+
+uint32_t acs_policy_get_rule_profile(void)
+{
+    return g_execution_policy.rule_profile;
+}
+
+uint32_t acs_policy_get_rule_parallel(void)
+{
+    return g_execution_policy.rule_parallel;
+}
+
 uint32_t acs_policy_get_pcie_p2p(void)
 {
     return g_execution_policy.pcie_p2p;
@@ -68,6 +93,21 @@ bool acs_policy_get_pcie_skip_dp_nic_ms(void)
     return g_execution_policy.pcie_skip_dp_nic_ms;
 }
 
+uint32_t acs_policy_get_pcie_cfg_cache(void)
+{
+    return g_execution_policy.pcie_cfg_cache;
+}
+
+uint32_t acs_policy_get_pcie_enum_prune(void)
+{
+    return g_execution_policy.pcie_enum_prune;
+}
+
+uint32_t acs_policy_get_pcie_bf_parallel(void)
+{
+    return g_execution_policy.pcie_bf_parallel;
+}
+
 uint32_t acs_policy_get_timeout_pass(void)
 {
     return g_execution_policy.timeout_pass;
@@ -97,3 +137,8 @@ uint32_t acs_policy_get_el1skiptrap_mask(void)
 {
     return g_execution_policy.el1skiptrap_mask;
 }
+
+uint32_t acs_policy_get_nist_stream_bits(void)
+{
+    return g_execution_policy.nist_stream_bits;
+}
@@ -145,6 +145,8 @@ uint32_t val_exerciser_set_param(EXERCISER_PARAM_TYPE type, uint64_t value1, uin
     status = pal_exerciser_set_param(type, value1, value2,
                                    g_exerciser_info_table.e_info[instance].bdf);
     val_mem_issue_dsb();
+    /* The PAL programs config space directly */
+    val_pcie_cfg_cache_invalidate_all();
     return status;
 }
 
@@ -254,6 +256,8 @@ uint32_t val_exerciser_ops(EXERCISER_OPS ops, uint64_t param, uint32_t instance)
 
     status = pal_exerciser_ops(ops, param, g_exerciser_info_table.e_info[instance].bdf);
     val_mem_issue_dsb();
+    /* The PAL programs config space directly */
+    val_pcie_cfg_cache_invalidate_all();
     return status;
 }
 
@@ -340,6 +344,7 @@ void val_exerciser_disable_rp_pio_register(uint32_t bdf)
 {
 
   pal_exerciser_disable_rp_pio_register(bdf);
+  val_pcie_cfg_cache_invalidate_all();
   return;
 }
 
@@ -364,7 +369,11 @@ val_exerciser_get_ras_status(uint32_t ras_node, uint32_t e_bdf, uint32_t erp_bdf
 uint32_t
 val_exerciser_set_bar_response(uint32_t bdf)
 {
-  return pal_exerciser_set_bar_response(bdf);
+  uint32_t status;
+
+  status = pal_exerciser_set_bar_response(bdf);
+  val_pcie_cfg_cache_invalidate_all();
+  return status;
 }
 
 uint32_t
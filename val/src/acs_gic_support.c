@@ -459,39 +459,100 @@ static uint32_t fill_msi_table(uint32_t bdf, uint64_t msi_addr, uint32_t msi_dat
 }
 
 /**
-  @brief   This function clear the MSI related mappings.
+  @brief   This function clears the MSI-X/MSI table entry of a device.
+
+  @param   bdf          B:D:F for the device
+  @param   msi_index    msi index in the table
+
+  @return  None
+**/
+static void clear_device_msi(uint32_t bdf, uint32_t msi_index)
+{
+  uint32_t msi_cap_offset;
+
+  /* Get MSI-X/MSI Capability Offset */
+  if (!(val_pcie_find_capability(bdf, PCIE_CAP, CID_MSIX, &msi_cap_offset)))
+    clear_msi_x_table(bdf, msi_index, msi_cap_offset);
+  else if (!(val_pcie_find_capability(bdf, PCIE_CAP, CID_MSI, &msi_cap_offset)))
+    clear_msi_table(bdf, msi_cap_offset);
+}
+
+/**
+  @brief   This function programs the MSI-X/MSI table entry of a device to write
+           int_id to the GITS_TRANSLATER of an ITS.
 
   @param   bdf          B:D:F for the device
+  @param   its_index    Index of the ITS in the ITS info table
   @param   int_id       Interrupt ID
   @param   msi_index    msi index in the table
 
   @return  status
 **/
-void val_gic_free_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id,
-                      uint32_t int_id, uint32_t msi_index)
+static uint32_t fill_device_msi(uint32_t bdf, uint32_t its_index, uint32_t int_id,
+                                uint32_t msi_index)
 {
-  uint32_t its_index;
+  uint64_t msi_addr;
+  uint32_t msi_data;
   uint32_t msi_cap_offset;
 
-  its_index = get_its_index(its_id);
-  if (its_index >= g_gic_its_info->GicNumIts)
-  {
+  msi_addr = val_its_get_translater_addr(its_index);
+  msi_data = int_id-ARM_LPI_MINID;
+
+  /* Get MSI-X/MSI Capability Offset */
+  if (!(val_pcie_find_capability(bdf, PCIE_CAP, CID_MSIX, &msi_cap_offset)))
+    return fill_msi_x_table(bdf, msi_index, msi_addr, msi_data, msi_cap_offset);
+  else if (!(val_pcie_find_capability(bdf, PCIE_CAP, CID_MSI, &msi_cap_offset)))
+    return fill_msi_table(bdf, msi_addr, msi_data, msi_cap_offset);
+  else
+    return ACS_STATUS_SKIP;
+}
+
+/**
+  @brief   This function checks that the ITS and GIC bases needed for an MSI are known.
+
+  @param   its_id       ITS ID
+  @param   its_index    Returns the index of the ITS in the ITS info table
+
+  @return  status
+**/
+static uint32_t msi_its_lookup(uint32_t its_id, uint32_t *its_index)
+{
+  if ((g_gic_its_info == NULL) || (g_gic_its_info->GicNumIts == 0))
+    return ACS_STATUS_ERR;
+
+  *its_index = get_its_index(its_id);
+  if (*its_index >= g_gic_its_info->GicNumIts) {
     val_print(ERROR, "\n       Could not find ITS ID [%x]", its_id);
-    return;
+    return ACS_STATUS_ERR;
   }
 
-  if ((g_gic_its_info->GicRdBase == 0) || (g_gic_its_info->GicDBase == 0))
-  {
-    val_print(ERROR, "\n       GICD/GICRD Base Invalid value");
-    return;
+  if ((g_gic_its_info->GicRdBase == 0) || (g_gic_its_info->GicDBase == 0)) {
+    val_print(DEBUG, "\n       GICD/GICRD Base Invalid value");
+    return ACS_STATUS_ERR;
   }
 
+  return ACS_STATUS_PASS;
+}
+
+/**
+  @brief   This function clear the MSI related mappings.
+
+  @param   bdf          B:D:F for the device
+  @param   int_id       Interrupt ID
+  @param   msi_index    msi index in the table
+
+  @return  status
+**/
+void val_gic_free_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id,
+                      uint32_t int_id, uint32_t msi_index)
+{
+  uint32_t its_index;
+
+  if (msi_its_lookup(its_id, &its_index))
+    return;
+
   val_its_clear_lpi_map(its_index, device_id, int_id);
-  /* Get MSI-X/MSI Capability Offset */
-  if (!(val_pcie_find_capability(bdf, PCIE_CAP, CID_MSIX, &msi_cap_offset)))
-    clear_msi_x_table(bdf, msi_index, msi_cap_offset);
-  else if (!(val_pcie_find_capability(bdf, PCIE_CAP, CID_MSI, &msi_cap_offset)))
-    clear_msi_table(bdf, msi_cap_offset);
+  clear_device_msi(bdf, msi_index);
 }
 
 /**
@@ -508,46 +569,165 @@ void val_gic_free_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id,
 uint32_t val_gic_request_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id,
                              uint32_t int_id, uint32_t msi_index)
 {
-  uint32_t status;
-  uint64_t msi_addr;
-  uint32_t msi_data;
   uint32_t its_index;
-  uint32_t msi_cap_offset;
 
-   if ((g_gic_its_info == NULL) || (g_gic_its_info->GicNumIts == 0))
+  if (msi_its_lookup(its_id, &its_index))
     return ACS_STATUS_ERR;
 
-  its_index = get_its_index(its_id);
-
-  if (its_index >= g_gic_its_info->GicNumIts) {
-    val_print(ERROR, "\n       Could not find ITS ID [%x]", its_id);
+  if (val_its_create_lpi_map(its_index, device_id, int_id, LPI_PRIORITY1))
     return ACS_STATUS_ERR;
+
+  return fill_device_msi(bdf, its_index, int_id, msi_index);
+}
+
+/**
+  @brief   This function collects the (DeviceID, LPI) pairs of the MSI requests that go
+           to the ITS of req[first].
+
+  @param   req          MSI requests
+  @param   num          Number of requests
+  @param   first        Index of the first request of the ITS
+  @param   map          Filled with the pairs
+
+  @return  Number of pairs
+**/
+static uint32_t msi_batch_its_group(GIC_MSI_REQUEST *req, uint32_t num, uint32_t first,
+                                    ITS_LPI_MAP *map)
+{
+  uint32_t i, count = 0;
+
+  for (i = first; i < num; i++) {
+    if (req[i].its_id != req[first].its_id)
+      continue;
+    map[count].device_id = req[i].device_id;
+    map[count].int_id = req[i].int_id;
+    count++;
   }
 
-  if ((g_gic_its_info->GicRdBase == 0) || (g_gic_its_info->GicDBase == 0))
-  {
-    val_print(DEBUG, "\n       GICD/GICRD Base Invalid value");
+  return count;
+}
+
+/**
+  @brief   Returns 1 if req[index] is the first request of its ITS
+**/
+static uint32_t msi_batch_its_first(GIC_MSI_REQUEST *req, uint32_t index)
+{
+  uint32_t i;
+
+  for (i = 0; i < index; i++) {
+    if (req[i].its_id == req[index].its_id)
+      return 0;
+  }
+
+  return 1;
+}
+
+/**
+  @brief   This function maps or unmaps the LPIs of a set of MSI requests with one
+           command batch per ITS. If mapping fails on one ITS, the mappings already
+           made on the other ITSs are removed.
+
+  @param   req          MSI requests
+  @param   num          Number of requests
+  @param   create       1 to map the LPIs, 0 to remove the mappings
+
+  @return  status
+**/
+static uint32_t msi_batch_lpi_map(GIC_MSI_REQUEST *req, uint32_t num, uint32_t create)
+{
+  ITS_LPI_MAP *map;
+  uint32_t i, j, count;
+  uint32_t status = ACS_STATUS_PASS;
+
+  map = val_memory_alloc(num * sizeof(ITS_LPI_MAP));
+  if (map == NULL)
     return ACS_STATUS_ERR;
+
+  for (i = 0; i < num && status == ACS_STATUS_PASS; i++) {
+    if (!msi_batch_its_first(req, i))
+      continue;
+
+    count = msi_batch_its_group(req, num, i, map);
+    if (create)
+      status = val_its_create_lpi_map_batch(get_its_index(req[i].its_id), map, count,
+                                            LPI_PRIORITY1);
+    else
+      status = val_its_clear_lpi_map_batch(get_its_index(req[i].its_id), map, count);
+
+    if (status && create) {
+      for (j = 0; j < i; j++) {
+        if (!msi_batch_its_first(req, j))
+          continue;
+        count = msi_batch_its_group(req, num, j, map);
+        val_its_clear_lpi_map_batch(get_its_index(req[j].its_id), map, count);
+      }
+    }
   }
 
-  val_its_create_lpi_map(its_index, device_id, int_id, LPI_PRIORITY1);
+  val_memory_free(map);
+  return status;
+}
 
-  msi_addr = val_its_get_translater_addr(its_index);
-  msi_data = int_id-ARM_LPI_MINID;
+/**
+  @brief   This function creates the MSI mappings of several devices, with one ITS
+           command batch per ITS instead of one per device, and programs their MSI
+           Tables. On failure nothing is left mapped or programmed.
 
-  /* Get MSI-X/MSI Capability Offset */
-  if (!(val_pcie_find_capability(bdf, PCIE_CAP, CID_MSIX, &msi_cap_offset)))
-  {
-    status = fill_msi_x_table(bdf, msi_index, msi_addr, msi_data, msi_cap_offset);
-    return status;
+  @param   req          MSI requests
+  @param   num          Number of requests
+
+  @return  status
+**/
+uint32_t val_gic_request_msi_batch(GIC_MSI_REQUEST *req, uint32_t num)
+{
+  uint32_t its_index;
+  uint32_t status;
+  uint32_t i;
+
+  for (i = 0; i < num; i++) {
+    if (msi_its_lookup(req[i].its_id, &its_index))
+      return ACS_STATUS_ERR;
   }
-  else if (!(val_pcie_find_capability(bdf, PCIE_CAP, CID_MSI, &msi_cap_offset)))
-  {
-    status = fill_msi_table(bdf, msi_addr, msi_data, msi_cap_offset);
-    return status;
+
+  if (msi_batch_lpi_map(req, num, 1))
+    return ACS_STATUS_ERR;
+
+  for (i = 0; i < num; i++) {
+    status = fill_device_msi(req[i].bdf, get_its_index(req[i].its_id), req[i].int_id,
+                             req[i].msi_index);
+    if (status) {
+      while (i--)
+        clear_device_msi(req[i].bdf, req[i].msi_index);
+      msi_batch_lpi_map(req, num, 0);
+      return status;
+    }
   }
-  else
-    return ACS_STATUS_SKIP;
+
+  return ACS_STATUS_PASS;
+}
+
+/**
+  @brief   This function clears the MSI mappings made by val_gic_request_msi_batch.
+
+  @param   req          MSI requests
+  @param   num          Number of requests
+
+  @return  None
+**/
+void val_gic_free_msi_batch(GIC_MSI_REQUEST *req, uint32_t num)
+{
+  uint32_t its_index;
+  uint32_t i;
+
+  for (i = 0; i < num; i++) {
+    if (msi_its_lookup(req[i].its_id, &its_index))
+      return;
+  }
+
+  msi_batch_lpi_map(req, num, 0);
+
+  for (i = 0; i < num; i++)
+    clear_device_msi(req[i].bdf, req[i].msi_index);
 }
 
 /**
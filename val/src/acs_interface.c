@@ -185,6 +185,9 @@ int64_t val_drtm_features(uint64_t fid, uint64_t *feat1, uint64_t *feat2)
  */
 int64_t val_drtm_dynamic_launch(DRTM_PARAMETERS *drtm_params)
 {
+    /* Dynamic launch expects every other PE to be off, including parked workers */
+    val_pe_worker_pool_stop();
+
     return val_drtm_simulate_dl(drtm_params);
 }
 
@@ -24,6 +24,7 @@
 #include "acs_memory.h"
 #include "acs_mpam_reg.h"
 #include "acs_gic_its.h"
+#include "val_memops.h"
 
 static MPAM_INFO_TABLE *g_mpam_info_table;
 static SRAT_INFO_TABLE *g_srat_info_table;
@@ -2251,7 +2252,8 @@ val_mpam_msc_request_msi(uint32_t msc_index, uint32_t device_id, uint32_t its_id
         return ACS_STATUS_ERR;
     }
 
-    val_its_create_lpi_map(its_index, device_id, int_id, LPI_PRIORITY1);
+    if (val_its_create_lpi_map(its_index, device_id, int_id, LPI_PRIORITY1))
+        return ACS_STATUS_ERR;
 
     msi_addr = val_its_get_translater_addr(its_index);
     msi_data = int_id - ARM_LPI_MINID;
@@ -2295,3 +2297,302 @@ val_mpam_msc_enable_msi(uint32_t msc_index, uint32_t is_oflow_msi)
 
     return ACS_STATUS_PASS;
 }
+
+/* State shared with the PE running one traffic stream, padded to two cache lines
+   so that PEs reporting progress never write the same line */
+typedef struct {
+    uint64_t src;
+    uint64_t dst;
+    uint64_t size;
+    uint64_t go_addr;
+    uint64_t deadline;
+    uint32_t type;
+    uint32_t partid;
+    uint32_t pmg;
+    uint32_t passes;
+    volatile uint32_t ready;
+    volatile uint32_t done;
+    volatile uint32_t status;
+    uint32_t reserved;
+    uint64_t start;
+    uint64_t end;
+    uint8_t  pad[40];
+} MEM_TRAFFIC_CTL_t;
+
+/* Values of the go flag */
+#define MEM_TRAFFIC_WAIT    0
+#define MEM_TRAFFIC_START   1
+#define MEM_TRAFFIC_ABORT   2
+
+/* Time allowed for every PE to bind its PARTID and report ready, in seconds */
+#define MEM_TRAFFIC_READY_TIMEOUT_SEC  5
+
+static void mem_traffic_ctl_sync(MEM_TRAFFIC_CTL_t *ctl, uint32_t type)
+{
+    uint32_t offset;
+
+    for (offset = 0; offset < sizeof(MEM_TRAFFIC_CTL_t); offset += MEM_TRAFFIC_ALIGN)
+        val_data_cache_ops_by_va((addr_t)ctl + offset, type);
+}
+
+/**
+  * @brief   Runs one traffic stream on the current PE. Binds the PARTID/PMG,
+  *          reports ready, waits for the go flag and times the stream with CNTVCT.
+  *
+  * @param   ctl - Control block of the stream.
+  *
+  * @return  None
+**/
+static void mem_traffic_stream_run(MEM_TRAFFIC_CTL_t *ctl)
+{
+    volatile uint32_t *go = (volatile uint32_t *)ctl->go_addr;
+    uint64_t mpam2_el2 = 0;
+    uint32_t pass;
+
+    ctl->status = ACS_STATUS_FAIL;
+
+    if (ctl->partid != MEM_TRAFFIC_NO_PARTID) {
+        mpam2_el2 = val_mpam_reg_read(MPAM2_EL2);
+        if (val_mpam_program_el2((uint16_t)ctl->partid, (uint8_t)ctl->pmg)) {
+            ctl->ready = 1;
+            ctl->done = 1;
+            mem_traffic_ctl_sync(ctl, CLEAN_AND_INVALIDATE);
+            return;
+        }
+    }
+
+    ctl->ready = 1;
+    mem_traffic_ctl_sync(ctl, CLEAN_AND_INVALIDATE);
+
+    while (*go == MEM_TRAFFIC_WAIT) {
+        if (virtualcounter_read() > ctl->deadline)
+            break;
+        val_data_cache_ops_by_va((addr_t)go, INVALIDATE);
+    }
+
+    if (*go == MEM_TRAFFIC_START) {
+        ctl->start = virtualcounter_read();
+        for (pass = 0; pass < ctl->passes; pass++) {
+            switch (ctl->type) {
+            case MEM_TRAFFIC_READ:
+                MemTrafficRead((const void *)ctl->src, ctl->size);
+                break;
+            case MEM_TRAFFIC_WRITE:
+                MemTrafficWrite((void *)ctl->dst, ctl->size, ctl->start);
+                break;
+            case MEM_TRAFFIC_COPY:
+                MemTrafficCopy((void *)ctl->dst, (const void *)ctl->src, ctl->size);
+                break;
+            default:
+                MemTrafficCopyNt((void *)ctl->dst, (const void *)ctl->src, ctl->size);
+                break;
+            }
+        }
+        dsbsy();
+        ctl->end = virtualcounter_read();
+        ctl->status = ACS_STATUS_PASS;
+    }
+
+    if (ctl->partid != MEM_TRAFFIC_NO_PARTID)
+        val_mpam_reg_write(MPAM2_EL2, mpam2_el2);
+
+    ctl->done = 1;
+    mem_traffic_ctl_sync(ctl, CLEAN_AND_INVALIDATE);
+}
+
+/* Secondary PE entry point, the control block address is passed as test data */
+static void mem_traffic_payload(void)
+{
+    uint64_t data0;
+    uint64_t ctl_addr;
+    uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
+
+    val_get_test_data(index, &data0, &ctl_addr);
+    mem_traffic_stream_run((MEM_TRAFFIC_CTL_t *)ctl_addr);
+}
+
+/* bytes * freq / ticks without overflowing 64 bits */
+static uint64_t mem_traffic_rate(uint64_t bytes, uint64_t ticks, uint64_t freq)
+{
+    uint64_t rate;
+    uint64_t rem;
+
+    if (ticks == 0)
+        return 0;
+
+    rate = (bytes / ticks) * freq;
+    rem = bytes % ticks;
+
+    /* rem < ticks, so ticks stays non-zero while both lose precision */
+    while (rem > (~0ULL / freq)) {
+        rem >>= 1;
+        ticks >>= 1;
+    }
+
+    return rate + (rem * freq) / ticks;
+}
+
+/* Waits until every secondary stream reports ready (or done) or the deadline
+   passes. Returns the number of streams that did not set it. */
+static uint32_t mem_traffic_wait(MEM_TRAFFIC_CTL_t *ctl, uint32_t num_streams, uint32_t local,
+                                 uint32_t wait_done, uint64_t deadline)
+{
+    uint32_t i;
+    uint32_t pending;
+
+    do {
+        pending = 0;
+        for (i = 0; i < num_streams; i++) {
+            if (i == local)
+                continue;
+            mem_traffic_ctl_sync(&ctl[i], INVALIDATE);
+            if (!(wait_done ? ctl[i].done : ctl[i].ready))
+                pending++;
+        }
+    } while (pending && virtualcounter_read() < deadline);
+
+    return pending;
+}
+
+/**
+  * @brief   Runs memory traffic streams on several PEs at once. Each stream is
+  *          bound to its PARTID/PMG through MPAM2_EL2, all streams are released
+  *          together and the achieved bandwidth is measured per PE with CNTVCT.
+  *          A stream on the primary PE runs inline once the others are released.
+  *
+  * @param   streams     - Stream descriptors, the output fields are filled in.
+  * @param   num_streams - Number of streams, at most one per PE.
+  *
+  * @return  ACS_STATUS_PASS if every stream completed, ACS_STATUS_FAIL if a
+  *          stream did not complete, ACS_STATUS_ERR on invalid input.
+**/
+uint32_t val_mem_traffic_run(MEM_TRAFFIC_STREAM_t *streams, uint32_t num_streams)
+{
+    MEM_TRAFFIC_CTL_t *ctl;
+    volatile uint32_t *go;
+    uint32_t num_pe = val_pe_get_num();
+    uint32_t local = num_streams;
+    uint32_t status = ACS_STATUS_PASS;
+    uint32_t pending;
+    uint32_t i, j;
+    uint64_t freq;
+    uint64_t now;
+    MEM_TRAFFIC_STREAM_t *s;
+
+    if ((streams == NULL) || (num_streams == 0) || (num_streams > num_pe))
+        return ACS_STATUS_ERR;
+
+    freq = val_get_counter_frequency();
+    if (freq == 0) {
+        val_print(ERROR, "\n       Traffic: counter frequency not known");
+        return ACS_STATUS_ERR;
+    }
+
+    for (i = 0; i < num_streams; i++) {
+        s = &streams[i];
+        if ((s->pe_index >= num_pe) || (s->type > MEM_TRAFFIC_COPY_NT) ||
+            (s->size == 0) || (s->size % MEM_TRAFFIC_ALIGN) || (s->passes == 0) ||
+            ((s->type != MEM_TRAFFIC_WRITE) && (s->src % MEM_TRAFFIC_ALIGN)) ||
+            ((s->type != MEM_TRAFFIC_READ) && (s->dst % MEM_TRAFFIC_ALIGN))) {
+            val_print(ERROR, "\n       Traffic: invalid stream %d", i);
+            return ACS_STATUS_ERR;
+        }
+
+        for (j = 0; j < i; j++) {
+            if (streams[j].pe_index == s->pe_index) {
+                val_print(ERROR, "\n       Traffic: PE %d has more than one stream",
+                          s->pe_index);
+                return ACS_STATUS_ERR;
+            }
+        }
+
+        if ((s->partid != MEM_TRAFFIC_NO_PARTID) && val_pe_feat_check(PE_FEAT_MPAM)) {
+            val_print(ERROR, "\n       Traffic: PE does not implement MPAM");
+            return ACS_STATUS_ERR;
+        }
+
+        if (s->pe_index == val_pe_get_index_mpid(val_pe_get_mpid()))
+            local = i;
+
+        s->status = ACS_STATUS_FAIL;
+        s->bytes = 0;
+        s->ticks = 0;
+        s->bytes_per_sec = 0;
+    }
+
+    /* One extra block holds the go flag on a line of its own */
+    ctl = (MEM_TRAFFIC_CTL_t *)val_aligned_alloc(MEM_TRAFFIC_ALIGN,
+                                                 (num_streams + 1) * sizeof(MEM_TRAFFIC_CTL_t));
+    if (ctl == NULL) {
+        val_print(ERROR, "\n       Traffic: control block allocation failed");
+        return ACS_STATUS_ERR;
+    }
+
+    val_memory_set(ctl, (num_streams + 1) * sizeof(MEM_TRAFFIC_CTL_t), 0);
+    go = (volatile uint32_t *)&ctl[num_streams];
+    *go = MEM_TRAFFIC_WAIT;
+    mem_traffic_ctl_sync(&ctl[num_streams], CLEAN_AND_INVALIDATE);
+
+    now = virtualcounter_read();
+    for (i = 0; i < num_streams; i++) {
+        ctl[i].src = streams[i].src;
+        ctl[i].dst = streams[i].dst;
+        ctl[i].size = streams[i].size;
+        ctl[i].go_addr = (uint64_t)go;
+        ctl[i].deadline = now + freq * MEM_TRAFFIC_TIMEOUT_SEC;
+        ctl[i].type = streams[i].type;
+        ctl[i].partid = streams[i].partid;
+        ctl[i].pmg = streams[i].pmg;
+        ctl[i].passes = streams[i].passes;
+        mem_traffic_ctl_sync(&ctl[i], CLEAN_AND_INVALIDATE);
+    }
+
+    for (i = 0; i < num_streams; i++) {
+        if (i != local)
+            val_execute_on_pe_resident(streams[i].pe_index, mem_traffic_payload,
+                                       (uint64_t)&ctl[i]);
+    }
+
+    /* Release the streams together, or none of them if a PE did not come up */
+    pending = mem_traffic_wait(ctl, num_streams, local, 0,
+                               now + freq * MEM_TRAFFIC_READY_TIMEOUT_SEC);
+    if (pending)
+        val_print(ERROR, "\n       Traffic: %d PE(s) did not start, aborting", pending);
+
+    *go = pending ? MEM_TRAFFIC_ABORT : MEM_TRAFFIC_START;
+    mem_traffic_ctl_sync(&ctl[num_streams], CLEAN_AND_INVALIDATE);
+
+    if ((local < num_streams) && !pending)
+        mem_traffic_stream_run(&ctl[local]);
+
+    pending = mem_traffic_wait(ctl, num_streams, local, 1, ctl[0].deadline);
+
+    for (i = 0; i < num_streams; i++) {
+        s = &streams[i];
+        if (!ctl[i].done || (ctl[i].status != ACS_STATUS_PASS)) {
+            val_print(ERROR, "\n       Traffic: stream on PE %d did not complete", s->pe_index);
+            status = ACS_STATUS_FAIL;
+            continue;
+        }
+
+        s->bytes = s->size * s->passes;
+        if ((s->type == MEM_TRAFFIC_COPY) || (s->type == MEM_TRAFFIC_COPY_NT))
+            s->bytes *= 2;
+        s->ticks = ctl[i].end - ctl[i].start;
+        s->bytes_per_sec = mem_traffic_rate(s->bytes, s->ticks, freq);
+        s->status = ACS_STATUS_PASS;
+
+        val_print(DEBUG, "\n       Traffic: PE %d", s->pe_index);
+        val_print(DEBUG, " moved 0x%llx bytes", s->bytes);
+        val_print(DEBUG, " in 0x%llx ticks", s->ticks);
+        val_print(DEBUG, " (%lld MB/s)", s->bytes_per_sec / (1024 * 1024));
+    }
+
+    /* A PE that never reported done may still write its control block */
+    if (pending)
+        val_print(WARN, "\n       Traffic: %d PE(s) still running, control blocks kept", pending);
+    else
+        val_memory_free_aligned(ctl);
+
+    return status;
+}
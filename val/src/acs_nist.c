@@ -36,6 +36,41 @@ val_nist_generate_rng(uint32_t *rng_buffer)
   return status;
 }
 
+/**
+  @brief   Fill a packed bitstream with random data. Every 64-bit word holds two
+           32-bit random numbers, the first one in the upper half, so the bit order
+           matches the ASCII data file written for the STS.
+  @param   words     - Buffer of NIST_STREAM_ALLOC_WORDS(num_bits) words.
+  @param   num_bits  - Number of stream bits. Bits past num_bits and the padding
+                       word are cleared.
+
+  @return  success/failure, NOT_IMPLEMENTED if the PAL has no RNG.
+**/
+uint32_t
+val_nist_generate_stream(uint64_t *words, uint64_t num_bits)
+{
+  uint32_t status, hi, lo;
+  uint64_t i, num_words = NIST_STREAM_WORDS(num_bits);
+
+  for (i = 0; i < num_words; i++) {
+      status = val_nist_generate_rng(&hi);
+      if (status != ACS_STATUS_PASS)
+          return status;
+
+      status = val_nist_generate_rng(&lo);
+      if (status != ACS_STATUS_PASS)
+          return status;
+
+      words[i] = ((uint64_t)hi << 32) | lo;
+  }
+
+  if (num_bits & 63)
+      words[num_words - 1] &= ~0ULL << (64 - (num_bits & 63));
+  words[num_words] = 0;
+
+  return ACS_STATUS_PASS;
+}
+
 double
 erf(double x)
 {
@@ -0,0 +1,739 @@
+/** @file
+ * Copyright (c) 2026, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+/*
+ * In-memory NIST STS pipeline. The tests below read a packed bitstream
+ * produced by val_nist_generate_stream() and return their p-values in a
+ * NIST_STREAM_RESULT_t, so no data file, result directory or report file is
+ * needed. Each test follows the computation of the STS 2.1.2 source of the
+ * same name, including the order of floating point operations, and uses the
+ * STS special functions, so the p-values match the file based run of the
+ * same sequence.
+ *
+ * The nist_ref_* kernels walk the stream one bit at a time like the STS. The
+ * kernels used by val_nist_stream_test() work on 64-bit words: bit counts
+ * come from popcount, cumulative sums from per-byte walk tables, longest runs
+ * from leading/trailing one counts, and all Serial and ApproximateEntropy
+ * pattern tables are folded down from a single 16-bit pattern count. They
+ * produce the same integer statistics as the reference kernels and feed them
+ * through the same floating point code, so the p-values are bit-exact;
+ * val_nist_stream_compare() verifies this on a given sequence and
+ * val_nist_stream_self_check() on a known vector.
+ */
+
+#include "acs_val.h"
+#include "acs_nist.h"
+#include "val_interface.h"
+#include "acs_common.h"
+#include "acs_memory.h"
+#include <math.h>
+
+static const char8_t *g_nist_stat_name[NIST_STAT_COUNT] = {
+  "Frequency",
+  "BlockFrequency",
+  "CumulativeSums (forward)",
+  "CumulativeSums (reverse)",
+  "Runs",
+  "LongestRun",
+  "ApproximateEntropy",
+  "Serial (1)",
+  "Serial (2)"
+};
+
+/**
+  @brief   Return the printable name of a NIST_STAT_e entry.
+**/
+const char8_t *
+val_nist_stream_stat_name(uint32_t stat)
+{
+  if (stat >= NIST_STAT_COUNT)
+      return "Unknown";
+
+  return g_nist_stat_name[stat];
+}
+
+static
+double
+nist_ref_frequency(const uint64_t *words, uint64_t n)
+{
+  uint64_t i;
+  double   sum = 0.0, s_obs;
+
+  for (i = 0; i < n; i++)
+      sum += 2 * (int32_t)NIST_STREAM_BIT(words, i) - 1;
+
+  s_obs = fabs(sum) / sqrt(n);
+  return erfc(s_obs / sqrt(2));
+}
+
+static
+double
+nist_ref_block_frequency(const uint64_t *words, uint64_t n, uint32_t m)
+{
+  uint64_t i, j, num_blocks = n / m;
+  uint32_t block_sum;
+  double   sum = 0.0, pi, v;
+
+  for (i = 0; i < num_blocks; i++) {
+      block_sum = 0;
+      for (j = 0; j < m; j++)
+          block_sum += NIST_STREAM_BIT(words, j + i * m);
+      pi = (double)block_sum / (double)m;
+      v = pi - 0.5;
+      sum += v * v;
+  }
+
+  return cephes_igamc(num_blocks / 2.0, (4.0 * m * sum) / 2.0);
+}
+
+static
+double
+nist_cusum_p_value(int64_t n, int64_t z)
+{
+  int64_t k;
+  double  sum1 = 0.0, sum2 = 0.0;
+
+  for (k = (-n / z + 1) / 4; k <= (n / z - 1) / 4; k++) {
+      sum1 += cephes_normal(((4 * k + 1) * z) / sqrt(n));
+      sum1 -= cephes_normal(((4 * k - 1) * z) / sqrt(n));
+  }
+
+  for (k = (-n / z - 3) / 4; k <= (n / z - 1) / 4; k++) {
+      sum2 += cephes_normal(((4 * k + 3) * z) / sqrt(n));
+      sum2 -= cephes_normal(((4 * k + 1) * z) / sqrt(n));
+  }
+
+  return 1.0 - sum1 + sum2;
+}
+
+static
+void
+nist_ref_cusum(const uint64_t *words, uint64_t n, double *p_forward, double *p_reverse)
+{
+  uint64_t k;
+  int64_t  s = 0, sup = 0, inf = 0, z, zrev;
+
+  for (k = 0; k < n; k++) {
+      s += NIST_STREAM_BIT(words, k) ? 1 : -1;
+      if (s > sup)
+          sup++;
+      if (s < inf)
+          inf--;
+  }
+
+  z = (sup > -inf) ? sup : -inf;
+  zrev = (sup - s > s - inf) ? sup - s : s - inf;
+
+  *p_forward = nist_cusum_p_value(n, z);
+  *p_reverse = nist_cusum_p_value(n, zrev);
+}
+
+static
+double
+nist_ref_runs(const uint64_t *words, uint64_t n)
+{
+  uint64_t k, ones = 0, v_obs = 1;
+  double   pi;
+
+  for (k = 0; k < n; k++)
+      ones += NIST_STREAM_BIT(words, k);
+
+  pi = (double)ones / (double)n;
+  if (fabs(pi - 0.5) > (2.0 / sqrt(n)))
+      return 0.0;
+
+  for (k = 1; k < n; k++)
+      if (NIST_STREAM_BIT(words, k) != NIST_STREAM_BIT(words, k - 1))
+          v_obs++;
+
+  return erfc(fabs(v_obs - 2.0 * n * pi * (1 - pi)) /
+              (2.0 * pi * (1 - pi) * sqrt(2 * n)));
+}
+
+static
+double
+nist_ref_longest_run(const uint64_t *words, uint64_t n)
+{
+  static const uint32_t v_small[] = {1, 2, 3, 4};
+  static const uint32_t v_mid[] = {4, 5, 6, 7, 8, 9};
+  static const uint32_t v_large[] = {10, 11, 12, 13, 14, 15, 16};
+  static const double pi_small[] = {0.21484375, 0.3671875, 0.23046875, 0.1875};
+  static const double pi_mid[] = {0.1174035788, 0.242955959, 0.249363483,
+                                  0.17517706, 0.102701071, 0.112398847};
+  static const double pi_large[] = {0.0882, 0.2092, 0.2483, 0.1933,
+                                    0.1208, 0.0675, 0.0727};
+  const uint32_t *v;
+  const double   *pi;
+  uint32_t k, m, nu[7] = {0}, run, v_obs;
+  uint64_t i, j, num_blocks;
+  double   chi2 = 0.0;
+
+  if (n < 128)
+      return NIST_P_VALUE_NA;
+
+  if (n < 6272) {
+      k = 3; m = 8; v = v_small; pi = pi_small;
+  } else if (n < 750000) {
+      k = 5; m = 128; v = v_mid; pi = pi_mid;
+  } else {
+      k = 6; m = 10000; v = v_large; pi = pi_large;
+  }
+
+  num_blocks = n / m;
+  for (i = 0; i < num_blocks; i++) {
+      v_obs = 0;
+      run = 0;
+      for (j = 0; j < m; j++) {
+          if (NIST_STREAM_BIT(words, i * m + j)) {
+              run++;
+              if (run > v_obs)
+                  v_obs = run;
+          } else
+              run = 0;
+      }
+
+      if (v_obs < v[0])
+          nu[0]++;
+      for (j = 0; j <= k; j++)
+          if (v_obs == v[j])
+              nu[j]++;
+      if (v_obs > v[k])
+          nu[k]++;
+  }
+
+  for (i = 0; i <= k; i++)
+      chi2 += ((nu[i] - num_blocks * pi[i]) * (nu[i] - num_blocks * pi[i])) /
+              (num_blocks * pi[i]);
+
+  return cephes_igamc((double)(k / 2.0), chi2 / 2.0);
+}
+
+/* Count the overlapping m-bit patterns of the stream, wrapping at the end */
+static
+void
+nist_ref_count_patterns(const uint64_t *words, uint64_t n, uint32_t m, uint32_t *count)
+{
+  uint64_t i;
+  uint32_t mask = (1u << m) - 1, pattern = 0;
+
+  val_memory_set(count, sizeof(uint32_t) << m, 0);
+
+  for (i = 0; i < m; i++)
+      pattern = (pattern << 1) | NIST_STREAM_BIT(words, i);
+
+  for (i = 0; i < n; i++) {
+      count[pattern]++;
+      pattern = ((pattern << 1) | NIST_STREAM_BIT(words, (i + m) % n)) & mask;
+  }
+}
+
+/* psi-squared statistic of the Serial test from an m-bit pattern count */
+static
+double
+nist_psi2(const uint32_t *count, uint32_t m, uint64_t n)
+{
+  uint32_t i;
+  double   sum = 0.0;
+
+  if (m == 0)
+      return 0.0;
+
+  for (i = 0; i < (1u << m); i++)
+      sum += (double)count[i] * count[i];
+
+  return (sum * pow(2, m) / (double)n) - (double)n;
+}
+
+/* phi statistic of the ApproximateEntropy test from an m-bit pattern count */
+static
+double
+nist_phi(const uint32_t *count, uint32_t m, uint64_t n)
+{
+  uint32_t i;
+  double   sum = 0.0;
+
+  if (m == 0)
+      return 0.0;
+
+  for (i = 0; i < (1u << m); i++)
+      if (count[i] > 0)
+          sum += count[i] * log(count[i] / (double)n);
+
+  return sum / (double)n;
+}
+
+static
+void
+nist_serial_p_values(double psim0, double psim1, double psim2, uint32_t m,
+                     double *p_value1, double *p_value2)
+{
+  *p_value1 = cephes_igamc(pow(2, m - 1) / 2, (psim0 - psim1) / 2.0);
+  *p_value2 = cephes_igamc(pow(2, m - 2) / 2, (psim0 - 2.0 * psim1 + psim2) / 2.0);
+}
+
+static
+double
+nist_apen_p_value(double phi0, double phi1, uint32_t m, uint64_t n)
+{
+  return cephes_igamc(pow(2, m - 1), (2.0 * n * (log(2) - (phi0 - phi1))) / 2.0);
+}
+
+static
+void
+nist_ref_serial(const uint64_t *words, uint64_t n, uint32_t m, uint32_t *count,
+                double *p_value1, double *p_value2)
+{
+  double psim[3];
+  uint32_t i;
+
+  for (i = 0; i < 3; i++) {
+      if (m - i)
+          nist_ref_count_patterns(words, n, m - i, count);
+      psim[i] = nist_psi2(count, m - i, n);
+  }
+
+  nist_serial_p_values(psim[0], psim[1], psim[2], m, p_value1, p_value2);
+}
+
+static
+double
+nist_ref_approximate_entropy(const uint64_t *words, uint64_t n, uint32_t m, uint32_t *count)
+{
+  double   phi[2];
+  uint32_t i;
+
+  for (i = 0; i < 2; i++) {
+      if (m + i)
+          nist_ref_count_patterns(words, n, m + i, count);
+      phi[i] = nist_phi(count, m + i, n);
+  }
+
+  return nist_apen_p_value(phi[0], phi[1], m, n);
+}
+
+/* Bit-serial STS computation, kept as the reference of the self check */
+static
+void
+nist_ref_stream_test(const uint64_t *words, uint64_t n, uint32_t *count,
+                     NIST_STREAM_RESULT_t *result)
+{
+  double *p = result->p_value;
+
+  p[NIST_STAT_FREQUENCY] = nist_ref_frequency(words, n);
+  p[NIST_STAT_BLOCK_FREQUENCY] = nist_ref_block_frequency(words, n, NIST_BLOCK_FREQ_M);
+  nist_ref_cusum(words, n, &p[NIST_STAT_CUSUM_FORWARD], &p[NIST_STAT_CUSUM_REVERSE]);
+  p[NIST_STAT_RUNS] = nist_ref_runs(words, n);
+  p[NIST_STAT_LONGEST_RUN] = nist_ref_longest_run(words, n);
+  p[NIST_STAT_APEN] = nist_ref_approximate_entropy(words, n, NIST_APEN_M, count);
+  nist_ref_serial(words, n, NIST_SERIAL_M, count,
+                  &p[NIST_STAT_SERIAL_1], &p[NIST_STAT_SERIAL_2]);
+}
+
+/*
+ * Word-parallel kernels. Streams carry a zero padding word (see
+ * NIST_STREAM_ALLOC_WORDS), so nist_bits_at() may read one word past the data.
+ */
+
+#if (NIST_APEN_M + 1) > (NIST_SERIAL_M - 2)
+#error "ApproximateEntropy pattern tables are folded from the Serial pattern count"
+#endif
+
+#define NIST_POPCOUNT(x)  ((uint32_t)__builtin_popcountll(x))
+
+/* 64 stream bits starting at bit pos, the first one in bit 63 */
+static inline
+uint64_t
+nist_bits_at(const uint64_t *words, uint64_t pos)
+{
+  uint64_t index = pos >> 6;
+  uint32_t shift = pos & 63;
+
+  if (shift == 0)
+      return words[index];
+
+  return (words[index] << shift) | (words[index + 1] >> (64 - shift));
+}
+
+/* Number of ones in bits [start, start + len) */
+static
+uint64_t
+nist_count_ones(const uint64_t *words, uint64_t start, uint64_t len)
+{
+  uint64_t ones = 0;
+
+  for (; len >= 64; start += 64, len -= 64)
+      ones += NIST_POPCOUNT(nist_bits_at(words, start));
+
+  if (len)
+      ones += NIST_POPCOUNT(nist_bits_at(words, start) >> (64 - len));
+
+  return ones;
+}
+
+static
+double
+nist_frequency(const uint64_t *words, uint64_t n)
+{
+  double sum = (double)(2 * (int64_t)nist_count_ones(words, 0, n) - (int64_t)n);
+
+  return erfc((fabs(sum) / sqrt(n)) / sqrt(2));
+}
+
+static
+double
+nist_block_frequency(const uint64_t *words, uint64_t n, uint32_t m)
+{
+  uint64_t i, num_blocks = n / m;
+  double   sum = 0.0, pi, v;
+
+  for (i = 0; i < num_blocks; i++) {
+      pi = (double)(uint32_t)nist_count_ones(words, i * m, m) / (double)m;
+      v = pi - 0.5;
+      sum += v * v;
+  }
+
+  return cephes_igamc(num_blocks / 2.0, (4.0 * m * sum) / 2.0);
+}
+
+static
+void
+nist_cusum(const uint64_t *words, uint64_t n, double *p_forward, double *p_reverse)
+{
+  int8_t   net[256], high[256], low[256];
+  int64_t  s = 0, sup = 0, inf = 0, z, zrev;
+  uint64_t k, num_bytes = n >> 3;
+  uint32_t b, bit, byte;
+  int32_t  walk;
+
+  /* Net step, highest and lowest point of the walk over each byte value */
+  for (b = 0; b < 256; b++) {
+      walk = 0;
+      high[b] = -8;
+      low[b] = 8;
+      for (bit = 0; bit < 8; bit++) {
+          walk += ((b >> (7 - bit)) & 1) ? 1 : -1;
+          if (walk > high[b])
+              high[b] = walk;
+          if (walk < low[b])
+              low[b] = walk;
+      }
+      net[b] = walk;
+  }
+
+  for (k = 0; k < num_bytes; k++) {
+      byte = (words[k >> 3] >> (56 - 8 * (k & 7))) & 0xFF;
+      if (s + high[byte] > sup)
+          sup = s + high[byte];
+      if (s + low[byte] < inf)
+          inf = s + low[byte];
+      s += net[byte];
+  }
+
+  for (k = num_bytes << 3; k < n; k++) {
+      s += NIST_STREAM_BIT(words, k) ? 1 : -1;
+      if (s > sup)
+          sup = s;
+      if (s < inf)
+          inf = s;
+  }
+
+  z = (sup > -inf) ? sup : -inf;
+  zrev = (sup - s > s - inf) ? sup - s : s - inf;
+
+  *p_forward = nist_cusum_p_value(n, z);
+  *p_reverse = nist_cusum_p_value(n, zrev);
+}
+
+static
+double
+nist_runs(const uint64_t *words, uint64_t n)
+{
+  uint64_t pos, pairs, ones, v_obs = 1;
+  double   pi;
+
+  ones = nist_count_ones(words, 0, n);
+  pi = (double)ones / (double)n;
+  if (fabs(pi - 0.5) > (2.0 / sqrt(n)))
+      return 0.0;
+
+  /* Bit j of word ^ (word shifted by one bit) is set where bit j + 1 differs */
+  for (pos = 0, pairs = n - 1; pairs >= 64; pos += 64, pairs -= 64)
+      v_obs += NIST_POPCOUNT(words[pos >> 6] ^ nist_bits_at(words, pos + 1));
+
+  if (pairs)
+      v_obs += NIST_POPCOUNT((words[pos >> 6] ^ nist_bits_at(words, pos + 1)) >> (64 - pairs));
+
+  return erfc(fabs(v_obs - 2.0 * n * pi * (1 - pi)) /
+              (2.0 * pi * (1 - pi) * sqrt(2 * n)));
+}
+
+/* Longest run of ones in bits [start, start + len) */
+static
+uint32_t
+nist_longest_ones(const uint64_t *words, uint64_t start, uint32_t len)
+{
+  uint32_t best = 0, run = 0, chunk, lead, inner;
+  uint64_t x, y;
+
+  for (; len; start += chunk, len -= chunk) {
+      chunk = (len < 64) ? len : 64;
+      x = nist_bits_at(words, start);
+      if (chunk < 64)
+          x &= ~0ULL << (64 - chunk);
+
+      lead = (~x == 0) ? 64 : (uint32_t)__builtin_clzll(~x);
+      run += lead;
+      if (run > best)
+          best = run;
+      if (lead == chunk)
+          continue;
+
+      /* Each step clears the last one of every run */
+      for (inner = 0, y = x; y; inner++)
+          y &= y << 1;
+      if (inner > best)
+          best = inner;
+
+      run = (uint32_t)__builtin_ctzll(~(x >> (64 - chunk)));
+  }
+
+  return best;
+}
+
+static
+double
+nist_longest_run(const uint64_t *words, uint64_t n)
+{
+  static const uint32_t v_small[] = {1, 2, 3, 4};
+  static const uint32_t v_mid[] = {4, 5, 6, 7, 8, 9};
+  static const uint32_t v_large[] = {10, 11, 12, 13, 14, 15, 16};
+  static const double pi_small[] = {0.21484375, 0.3671875, 0.23046875, 0.1875};
+  static const double pi_mid[] = {0.1174035788, 0.242955959, 0.249363483,
+                                  0.17517706, 0.102701071, 0.112398847};
+  static const double pi_large[] = {0.0882, 0.2092, 0.2483, 0.1933,
+                                    0.1208, 0.0675, 0.0727};
+  const uint32_t *v;
+  const double   *pi;
+  uint32_t k, m, j, nu[7] = {0}, v_obs;
+  uint64_t i, num_blocks;
+  double   chi2 = 0.0;
+
+  if (n < 128)
+      return NIST_P_VALUE_NA;
+
+  if (n < 6272) {
+      k = 3; m = 8; v = v_small; pi = pi_small;
+  } else if (n < 750000) {
+      k = 5; m = 128; v = v_mid; pi = pi_mid;
+  } else {
+      k = 6; m = 10000; v = v_large; pi = pi_large;
+  }
+
+  num_blocks = n / m;
+  for (i = 0; i < num_blocks; i++) {
+      v_obs = nist_longest_ones(words, i * m, m);
+      if (v_obs < v[0])
+          nu[0]++;
+      for (j = 0; j <= k; j++)
+          if (v_obs == v[j])
+              nu[j]++;
+      if (v_obs > v[k])
+          nu[k]++;
+  }
+
+  for (i = 0; i <= k; i++)
+      chi2 += ((nu[i] - num_blocks * pi[i]) * (nu[i] - num_blocks * pi[i])) /
+              (num_blocks * pi[i]);
+
+  return cephes_igamc((double)(k / 2.0), chi2 / 2.0);
+}
+
+/* Count the overlapping m-bit patterns of the stream, wrapping at the end,
+ * taking each pattern from a 64-bit window instead of shifting bit by bit.
+ */
+static
+void
+nist_count_patterns(const uint64_t *words, uint64_t n, uint32_t m, uint32_t *count)
+{
+  uint64_t pos, last = n - m, lo, hi, tail;
+  uint32_t j, shift = 64 - m, rest;
+
+  val_memory_set(count, sizeof(uint32_t) << m, 0);
+
+  /* Patterns that end inside the stream, 64 start positions per word */
+  for (pos = 0; pos + 63 <= last; pos += 64) {
+      hi = words[pos >> 6];
+      lo = words[(pos >> 6) + 1];
+      count[hi >> shift]++;
+      for (j = 1; j < 64; j++)
+          count[((hi << j) | (lo >> (64 - j))) >> shift]++;
+  }
+
+  for (; pos <= last; pos++)
+      count[nist_bits_at(words, pos) >> shift]++;
+
+  /* Patterns that wrap around to the start of the stream */
+  for (; pos < n; pos++) {
+      rest = n - pos;
+      tail = nist_bits_at(words, pos) >> (64 - rest);
+      count[(tail << (m - rest)) | (words[0] >> (64 - (m - rest)))]++;
+  }
+}
+
+/* Turn an m-bit pattern count into the (m - 1)-bit count, in place */
+static
+void
+nist_fold_patterns(uint32_t *count, uint32_t m)
+{
+  uint32_t i;
+
+  for (i = 0; i < (1u << (m - 1)); i++)
+      count[i] = count[2 * i] + count[2 * i + 1];
+}
+
+/* Serial on NIST_SERIAL_M, then ApproximateEntropy on NIST_APEN_M, from one count */
+static
+void
+nist_pattern_tests(const uint64_t *words, uint64_t n, uint32_t *count, double *p)
+{
+  double   psim[3], phi[2];
+  uint32_t m = NIST_SERIAL_M;
+
+  nist_count_patterns(words, n, m, count);
+
+  psim[0] = nist_psi2(count, m, n);
+  nist_fold_patterns(count, m--);
+  psim[1] = nist_psi2(count, m, n);
+  nist_fold_patterns(count, m--);
+  psim[2] = nist_psi2(count, m, n);
+  nist_serial_p_values(psim[0], psim[1], psim[2], NIST_SERIAL_M,
+                       &p[NIST_STAT_SERIAL_1], &p[NIST_STAT_SERIAL_2]);
+
+  while (m > NIST_APEN_M + 1)
+      nist_fold_patterns(count, m--);
+  phi[1] = nist_phi(count, m, n);
+  nist_fold_patterns(count, m--);
+  phi[0] = nist_phi(count, m, n);
+  p[NIST_STAT_APEN] = nist_apen_p_value(phi[0], phi[1], NIST_APEN_M, n);
+}
+
+/**
+  @brief   Run the in-memory STS tests on one packed sequence. Safe to call on
+           several PEs at once, each with its own pattern count table.
+  @param   words     - Packed stream of NIST_STREAM_ALLOC_WORDS(num_bits) words.
+  @param   num_bits  - Sequence length in bits, at least NIST_STREAM_MIN_BITS.
+  @param   count     - Pattern count table of NIST_PATTERN_ENTRIES entries.
+  @param   result    - p-value of every NIST_STAT_e entry.
+
+  @return  ACS_STATUS_PASS when the p-values were computed, ACS_STATUS_ERR otherwise.
+**/
+uint32_t
+val_nist_stream_test(const uint64_t *words, uint64_t num_bits, uint32_t *count,
+                     NIST_STREAM_RESULT_t *result)
+{
+  double *p = result->p_value;
+
+  if ((words == NULL) || (count == NULL) || (num_bits < NIST_STREAM_MIN_BITS))
+      return ACS_STATUS_ERR;
+
+  p[NIST_STAT_FREQUENCY] = nist_frequency(words, num_bits);
+  p[NIST_STAT_BLOCK_FREQUENCY] = nist_block_frequency(words, num_bits, NIST_BLOCK_FREQ_M);
+  nist_cusum(words, num_bits, &p[NIST_STAT_CUSUM_FORWARD], &p[NIST_STAT_CUSUM_REVERSE]);
+  p[NIST_STAT_RUNS] = nist_runs(words, num_bits);
+  p[NIST_STAT_LONGEST_RUN] = nist_longest_run(words, num_bits);
+  nist_pattern_tests(words, num_bits, count, p);
+
+  return ACS_STATUS_PASS;
+}
+
+/* Known vector of the self check: xorshift64 output, long enough for the
+ * 10000-bit LongestRun blocks and not a multiple of 64 bits.
+ */
+#define NIST_SELF_CHECK_BITS  1000037
+#define NIST_SELF_CHECK_SEED  0x2545F4914F6CDD1DULL
+
+/**
+  @brief   Run the word-parallel kernels and the bit-serial reference on one
+           packed sequence and compare their p-values, which must be bit-exact.
+  @param   words     - Packed stream of NIST_STREAM_ALLOC_WORDS(num_bits) words.
+  @param   num_bits  - Sequence length in bits, at least NIST_STREAM_MIN_BITS.
+  @param   count     - Pattern count table of NIST_PATTERN_ENTRIES entries.
+
+  @return  ACS_STATUS_PASS, ACS_STATUS_FAIL on a mismatch, ACS_STATUS_ERR if the
+           sequence is too short.
+**/
+uint32_t
+val_nist_stream_compare(const uint64_t *words, uint64_t num_bits, uint32_t *count)
+{
+  NIST_STREAM_RESULT_t ref, fast;
+  uint32_t stat, status = ACS_STATUS_PASS;
+
+  if (val_nist_stream_test(words, num_bits, count, &fast) != ACS_STATUS_PASS)
+      return ACS_STATUS_ERR;
+  nist_ref_stream_test(words, num_bits, count, &ref);
+
+  for (stat = 0; stat < NIST_STAT_COUNT; stat++) {
+      if (val_memory_compare(&ref.p_value[stat], &fast.p_value[stat], sizeof(double))) {
+          val_print(ERROR, "\n       NIST %s kernel differs from the reference",
+                    val_nist_stream_stat_name(stat));
+          status = ACS_STATUS_FAIL;
+      }
+  }
+
+  return status;
+}
+
+/**
+  @brief   Check the word-parallel kernels against the bit-serial reference on a
+           known vector. The p-values must be bit-exact.
+
+  @return  ACS_STATUS_PASS, ACS_STATUS_FAIL on a mismatch, ACS_STATUS_ERR if the
+           buffers cannot be allocated.
+**/
+uint32_t
+val_nist_stream_self_check(void)
+{
+  uint64_t *words, x = NIST_SELF_CHECK_SEED, i;
+  uint64_t  num_words = NIST_STREAM_WORDS(NIST_SELF_CHECK_BITS);
+  uint32_t *count, status;
+
+  words = val_memory_alloc(NIST_STREAM_ALLOC_WORDS(NIST_SELF_CHECK_BITS) * sizeof(uint64_t));
+  count = val_memory_calloc(NIST_PATTERN_ENTRIES, sizeof(uint32_t));
+  if ((words == NULL) || (count == NULL)) {
+      val_print(ERROR, "\n       NIST self check allocation failed");
+      status = ACS_STATUS_ERR;
+      goto free_buffers;
+  }
+
+  for (i = 0; i < num_words; i++) {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      words[i] = x;
+  }
+  words[num_words - 1] &= ~0ULL << (64 - (NIST_SELF_CHECK_BITS & 63));
+  words[num_words] = 0;
+
+  status = val_nist_stream_compare(words, NIST_SELF_CHECK_BITS, count);
+
+free_buffers:
+  if (words)
+      val_memory_free(words);
+  if (count)
+      val_memory_free(count);
+  return status;
+}
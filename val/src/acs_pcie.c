@@ -28,14 +28,848 @@
 pcie_bdf_list_t *pcie_pheripherals_bdf_list = NULL;
 PCIE_INFO_TABLE *g_pcie_info_table;
 pcie_device_bdf_table *g_pcie_bdf_table;
+static PCIE_ECAM_MAP g_pcie_ecam_map;
 
 uint32_t pcie_bdf_table_list_flag;
 uint32_t g_pcie_integrated_devices;
 uint64_t pal_get_mcfg_ptr(void);
 
+/* Config space snapshot cache */
+#define PCIE_CFG_CACHE_DWORDS       (PCIE_CFG_SIZE / 4)
+#define PCIE_CFG_CACHE_MAP_WORDS    (PCIE_CFG_CACHE_DWORDS / 32)
+#define PCIE_CFG_CACHE_HASH_SZ      (PCIE_CFG_CACHE_MAX_BDF * 2)
+#define PCIE_CFG_CACHE_ERR_CAP_SZ   0x48
+
+/* Capability index state of a snapshot */
+#define PCIE_CFG_INDEX_NONE   0
+#define PCIE_CFG_INDEX_READY  1
+#define PCIE_CFG_INDEX_WALK   2  /* List too long to index, walk it on every lookup */
+
+typedef struct {
+  uint32_t bdf;
+  uint32_t index_state;
+  uint32_t cap_list_ret;     /* Non-zero if the capability pointer could not be read */
+  uint32_t cap_list_status;  /* Status returned by the walk when cap_list_ret is set */
+  uint32_t ecap_list_ur;     /* Extended capability list ended with an UR response */
+  uint32_t num_cap;
+  uint32_t num_ecap;
+  uint16_t cap_id[PCIE_CFG_CACHE_MAX_CAP];
+  uint16_t cap_offset[PCIE_CFG_CACHE_MAX_CAP];
+  uint16_t ecap_id[PCIE_CFG_CACHE_MAX_CAP];
+  uint16_t ecap_offset[PCIE_CFG_CACHE_MAX_CAP];
+  uint32_t valid_map[PCIE_CFG_CACHE_MAP_WORDS];
+  uint32_t status_map[PCIE_CFG_CACHE_MAP_WORDS];
+  uint32_t image[PCIE_CFG_CACHE_DWORDS];
+} pcie_cfg_snapshot;
+
+static pcie_cfg_snapshot *g_pcie_cfg_cache;
+static uint16_t *g_pcie_cfg_cache_hash;
+static uint32_t g_pcie_cfg_cache_entries;
+static pcie_cfg_cache_stats g_pcie_cfg_cache_stats;
+static pcie_cfg_snapshot *g_pcie_cfg_cache_suspended;
+
+/* PCIe hierarchy index, nodes share the indexes of g_pcie_bdf_table */
+static pcie_hier_node *g_pcie_hier;
+static uint32_t *g_pcie_hier_bdf_sort;      /* Nodes sorted by BDF */
+static uint32_t *g_pcie_hier_bridge_sort;   /* Bridges sorted by segment/secondary bus */
+static uint32_t *g_pcie_hier_rp_sort;       /* Root Ports sorted by segment/secondary bus */
+static uint32_t g_pcie_hier_entries;
+static uint32_t g_pcie_hier_num_bridge;
+static uint32_t g_pcie_hier_num_rp;
+static uint32_t g_pcie_hier_stale;
+
+/* Result of a Function probe during enumeration */
+#define PCIE_PROBE_ABSENT   0
+#define PCIE_PROBE_FOUND    1
+#define PCIE_PROBE_ERROR    2
+
+#define PCIE_DEVICE_BDF_TABLE_MAX ((PCIE_DEVICE_BDF_TABLE_SZ - sizeof(pcie_device_bdf_table)) / \
+                                   sizeof(pcie_device_attr))
+
+static uint32_t g_pcie_enum_probes;
+
+/* Outcome of a bit-field check */
+#define PCIE_BF_PASS       0
+#define PCIE_BF_BAD_TYPE   1
+#define PCIE_BF_NO_CAP     2
+#define PCIE_BF_VALUE      3
+#define PCIE_BF_BAD_ATTR   4
+#define PCIE_BF_ATTR       5
+
+/* Parallel bit-field checks */
+#define PCIE_BF_MAX_SLOTS    16
+#define PCIE_BF_LINE_SIZE    64   /* Slot results and records never share a line */
+
+typedef struct {
+  uint32_t tbl_index;
+  uint16_t bf_index;
+  uint16_t kind;
+  uint32_t value;
+  uint32_t expected;
+} pcie_bf_record;
+
+typedef struct {
+  uint32_t progress;      /* BDFs checked so far, polled by the primary PE */
+  uint32_t reserved[7];
+  uint32_t num_pass;
+  uint32_t num_fails;
+  uint32_t num_records;
+  uint32_t dp_type;
+  uint32_t reserved1[2];
+  pcie_bf_record *record; /* Room for every check of the slot's BDFs */
+} pcie_bf_slot_result;
+
+typedef struct {
+  uint64_t *bf_info_table;
+  uint32_t num_entries;
+  uint32_t num_slots;
+  pcie_bf_slot_result *result;
+} pcie_bf_job;
+
+static pcie_bf_job g_pcie_bf_job;
+
+static uint32_t val_pcie_read_cfg_ecam(uint32_t bdf, uint32_t offset, uint32_t *data);
+
+/**
+  @brief   Builds the segment/bus to ECAM map from the PCIe Info Table. Every
+           config accessor resolves a BDF to its ECAM through this map.
+           1. Caller       -  val_pcie_create_info_table
+           2. Prerequisite -  pal_pcie_create_info_table
+  @param   None
+
+  @return  None
+**/
+static void
+val_pcie_build_ecam_map(void)
+{
+  uint32_t index;
+  uint32_t seg;
+  uint32_t bus;
+  uint32_t end_bus;
+  uint32_t slot;
+
+  val_memory_set(&g_pcie_ecam_map, sizeof(g_pcie_ecam_map), 0);
+
+  for (index = 0; index < g_pcie_info_table->num_entries; index++)
+  {
+      seg = g_pcie_info_table->block[index].segment_num;
+      if (seg >= PCIE_ECAM_MAP_NUM_SEG_IDS) {
+          g_pcie_ecam_map.overflow++;
+          continue;
+      }
+
+      slot = g_pcie_ecam_map.seg_slot[seg];
+
+      if (slot == 0) {
+          if (g_pcie_ecam_map.num_segments == PCIE_ECAM_MAP_MAX_SEG) {
+              g_pcie_ecam_map.overflow++;
+              continue;
+          }
+          slot = ++g_pcie_ecam_map.num_segments;
+          g_pcie_ecam_map.seg_slot[seg] = slot;
+      }
+
+      /* Block index is stored incremented by one in 8 bits */
+      if (index >= 0xFF) {
+          g_pcie_ecam_map.overflow++;
+          continue;
+      }
+
+      end_bus = g_pcie_info_table->block[index].end_bus_num;
+      if (end_bus >= PCIE_ECAM_MAP_NUM_BUS)
+          end_bus = PCIE_ECAM_MAP_NUM_BUS - 1;
+
+      /* First ECAM block decoding a bus wins, as in a linear scan */
+      for (bus = g_pcie_info_table->block[index].start_bus_num; bus <= end_bus; bus++)
+      {
+          if (g_pcie_ecam_map.ecam_index[slot - 1][bus])
+              continue;
+
+          g_pcie_ecam_map.ecam_index[slot - 1][bus] = index + 1;
+          g_pcie_ecam_map.ecam_base[slot - 1][bus] = g_pcie_info_table->block[index].ecam_base;
+      }
+  }
+
+  if (g_pcie_ecam_map.overflow)
+      val_print(WARN, " PCIE_INFO: %d ECAM regions not in ECAM map\n",
+                g_pcie_ecam_map.overflow);
+}
+
+/**
+  @brief   Resolves a segment and bus number to the ECAM decoding them.
+           1. Caller       -  Validation layer
+           2. Prerequisite -  val_pcie_create_info_table
+  @param   seg        - Segment number
+  @param   bus        - Bus number
+  @param   ecam_index - On return, index of the ECAM in the PCIe Info Table.
+                        May be NULL.
+
+  @return  ECAM base address, 0 if no ECAM decodes the bus
+**/
+static addr_t
+val_pcie_ecam_lookup(uint32_t seg, uint32_t bus, uint32_t *ecam_index)
+{
+  uint32_t slot;
+  uint32_t index;
+
+  if (bus >= PCIE_ECAM_MAP_NUM_BUS)
+      return 0;
+
+  /* Segments beyond the slot table are only reachable by the table scan */
+  slot = (seg < PCIE_ECAM_MAP_NUM_SEG_IDS) ? g_pcie_ecam_map.seg_slot[seg] : 0;
+  if (slot && g_pcie_ecam_map.ecam_index[slot - 1][bus]) {
+      if (ecam_index != NULL)
+          *ecam_index = g_pcie_ecam_map.ecam_index[slot - 1][bus] - 1;
+      return g_pcie_ecam_map.ecam_base[slot - 1][bus];
+  }
+
+  /* Map is complete, nothing decodes this bus */
+  if (g_pcie_ecam_map.num_segments && !g_pcie_ecam_map.overflow)
+      return 0;
+
+  if (g_pcie_info_table == NULL)
+      return 0;
+
+  /* Map not built or partial, fall back to scanning the PCIe Info Table */
+  for (index = 0; index < g_pcie_info_table->num_entries; index++)
+  {
+      if ((bus >= g_pcie_info_table->block[index].start_bus_num) &&
+          (bus <= g_pcie_info_table->block[index].end_bus_num) &&
+          (seg == g_pcie_info_table->block[index].segment_num)) {
+          if (ecam_index != NULL)
+              *ecam_index = index;
+          return g_pcie_info_table->block[index].ecam_base;
+      }
+  }
+
+  return 0;
+}
+
+/**
+  @brief   ECAM resolver handed to the PAL so its config accessors share the
+           ECAM map without reaching into VAL data.
+  @param   seg        - Segment number
+  @param   bus        - Bus number
+
+  @return  ECAM base address, 0 if the map cannot resolve the bus
+**/
+static uint64_t
+val_pcie_ecam_map_resolve(uint32_t seg, uint32_t bus)
+{
+  return val_pcie_ecam_lookup(seg, bus, NULL);
+}
+
+/**
+  @brief   Returns the hash bucket of a BDF in the snapshot cache.
+
+  @param   bdf    - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @return  Hash bucket index
+**/
+static uint32_t
+val_pcie_cfg_cache_hash(uint32_t bdf)
+{
+  return ((PCIE_EXTRACT_BDF_SEG(bdf) * 0x3D) ^ (PCIE_CREATE_BDF_PACKED(bdf)))
+          & (PCIE_CFG_CACHE_HASH_SZ - 1);
+}
+
+/**
+  @brief   Returns the snapshot slot of a BDF without filling it.
+
+  @param   bdf    - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @return  Snapshot pointer, NULL if the cache is disabled or the BDF is not cached
+**/
+static pcie_cfg_snapshot *
+val_pcie_cfg_cache_slot(uint32_t bdf)
+{
+  uint32_t bucket;
+  uint32_t probe;
+  uint16_t slot;
+
+  if (g_pcie_cfg_cache == NULL)
+      return NULL;
+
+  bucket = val_pcie_cfg_cache_hash(bdf);
+  for (probe = 0; probe < PCIE_CFG_CACHE_HASH_SZ; probe++)
+  {
+      slot = g_pcie_cfg_cache_hash[bucket];
+      if (slot == 0)
+          return NULL;
+
+      if (g_pcie_cfg_cache[slot - 1].bdf == bdf)
+          return &g_pcie_cfg_cache[slot - 1];
+
+      bucket = (bucket + 1) & (PCIE_CFG_CACHE_HASH_SZ - 1);
+  }
+
+  return NULL;
+}
+
+/**
+  @brief   Reads one config space dword from ECAM into the snapshot image.
+
+  @param   snap   - BDF snapshot
+  @param   offset - Word aligned register offset
+  @param   *data  - 32-bit data read from the config space
+  @return  success/failure
+**/
+static uint32_t
+val_pcie_cfg_cache_fill(pcie_cfg_snapshot *snap, uint32_t offset, uint32_t *data)
+{
+  uint32_t dword = offset >> 2;
+  uint32_t status;
+
+  status = val_pcie_read_cfg_ecam(snap->bdf, offset, data);
+  if (status)
+      return status;
+
+  snap->image[dword] = *data;
+  snap->valid_map[dword / 32] |= (1u << (dword % 32));
+  g_pcie_cfg_cache_stats.misses++;
+  return 0;
+}
+
+/**
+  @brief   Marks the dwords of a register range as status registers which
+           are always read from ECAM.
+
+  @param   snap   - BDF snapshot
+  @param   offset - Start offset of the range
+  @param   size   - Size of the range in bytes
+  @return  None
+**/
+static void
+val_pcie_cfg_cache_mark_status(pcie_cfg_snapshot *snap, uint32_t offset, uint32_t size)
+{
+  uint32_t dword;
+
+  for (dword = offset >> 2; (dword < ((offset + size) >> 2)) &&
+       (dword < PCIE_CFG_CACHE_DWORDS); dword++)
+      snap->status_map[dword / 32] |= (1u << (dword % 32));
+}
+
+/**
+  @brief   Walks the capability lists of a BDF once and records every
+           capability offset along with the status registers which must
+           bypass the snapshot.
+
+  @param   snap   - BDF snapshot
+  @return  None
+**/
+static void
+val_pcie_cfg_cache_build_index(pcie_cfg_snapshot *snap)
+{
+  uint32_t reg_value;
+  uint32_t next_cap_offset;
+  uint32_t ret;
+  uint32_t index;
+
+  snap->num_cap = 0;
+  snap->num_ecap = 0;
+  snap->cap_list_ret = 0;
+  snap->ecap_list_ur = 0;
+  snap->index_state = PCIE_CFG_INDEX_WALK;
+  val_memory_set(snap->status_map, sizeof(snap->status_map), 0);
+
+  /* PCI capability list */
+  /* A failed read leaves the index in PCIE_CFG_INDEX_WALK, lookups then go to ECAM */
+  ret = val_pcie_cfg_cache_fill(snap, TYPE01_CPR, &reg_value);
+  if (ret == PCIE_NO_MAPPING || (ret == 0 && reg_value == PCIE_UNKNOWN_RESPONSE)) {
+      snap->cap_list_ret = 1;
+      snap->cap_list_status = ret;
+  } else if (ret) {
+      return;
+  } else {
+      next_cap_offset = (reg_value & TYPE01_CPR_MASK);
+      while (next_cap_offset)
+      {
+          if (snap->num_cap == PCIE_CFG_CACHE_MAX_CAP)
+              return;
+
+          if (val_pcie_cfg_cache_fill(snap, next_cap_offset, &reg_value))
+              return;
+
+          snap->cap_id[snap->num_cap] = (reg_value & PCIE_CIDR_MASK);
+          snap->cap_offset[snap->num_cap++] = next_cap_offset;
+          next_cap_offset = ((reg_value >> PCIE_NCPR_SHIFT) & PCIE_NCPR_MASK);
+      }
+  }
+
+  /* PCIe extended capability list */
+  next_cap_offset = PCIE_ECAP_START;
+  while (next_cap_offset)
+  {
+      if (snap->num_ecap == PCIE_CFG_CACHE_MAX_CAP)
+          return;
+
+      if (val_pcie_cfg_cache_fill(snap, next_cap_offset, &reg_value))
+          return;
+
+      if (reg_value == PCIE_UNKNOWN_RESPONSE) {
+          snap->ecap_list_ur = 1;
+          break;
+      }
+
+      snap->ecap_id[snap->num_ecap] = (reg_value & PCIE_ECAP_CIDR_MASK);
+      snap->ecap_offset[snap->num_ecap++] = next_cap_offset;
+      next_cap_offset = ((reg_value >> PCIE_ECAP_NCPR_SHIFT) & PCIE_ECAP_NCPR_MASK);
+  }
+
+  /* Command/Status and bridge Secondary Status change without config writes */
+  val_pcie_cfg_cache_mark_status(snap, TYPE01_CR, 4);
+  if (val_pcie_cfg_cache_fill(snap, TYPE01_CLSR, &reg_value))
+      return;
+
+  if (((((reg_value >> TYPE01_HTR_SHIFT) & TYPE01_HTR_MASK) >> HTR_HL_SHIFT) & HTR_HL_MASK)
+       == TYPE1_HEADER)
+      val_pcie_cfg_cache_mark_status(snap, TYPE1_SEC_STA, 4);
+
+  for (index = 0; index < snap->num_cap; index++)
+  {
+      /* PMCSR, the power state changes under D-state transitions */
+      if (snap->cap_id[index] == CID_PMC)
+          val_pcie_cfg_cache_mark_status(snap, snap->cap_offset[index] + PMCSR_OFFSET, 4);
+
+      if (snap->cap_id[index] != CID_PCIECS)
+          continue;
+
+      /* Device, Link, Slot and Root status registers */
+      val_pcie_cfg_cache_mark_status(snap, snap->cap_offset[index] + DCTLR_OFFSET, 4);
+      val_pcie_cfg_cache_mark_status(snap, snap->cap_offset[index] + LCTRLR_OFFSET, 4);
+      val_pcie_cfg_cache_mark_status(snap, snap->cap_offset[index] + SLCTRLR_OFFSET, 4);
+      val_pcie_cfg_cache_mark_status(snap, snap->cap_offset[index] + RSTSR_OFFSET, 4);
+  }
+
+  for (index = 0; index < snap->num_ecap; index++)
+  {
+      /* Error status and log registers of AER and DPC */
+      if ((snap->ecap_id[index] == ECID_AER) || (snap->ecap_id[index] == ECID_DPC))
+          val_pcie_cfg_cache_mark_status(snap, snap->ecap_offset[index] + 4,
+                                         PCIE_CFG_CACHE_ERR_CAP_SZ - 4);
+  }
+
+  snap->index_state = PCIE_CFG_INDEX_READY;
+}
+
+/**
+  @brief   Returns the snapshot of a BDF, building its capability index on
+           first use.
+
+  @param   bdf    - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @return  Snapshot pointer, NULL if the cache is disabled or the BDF is not cached
+**/
+static pcie_cfg_snapshot *
+val_pcie_cfg_cache_lookup(uint32_t bdf)
+{
+  pcie_cfg_snapshot *snap;
+
+  snap = val_pcie_cfg_cache_slot(bdf);
+  if ((snap != NULL) && (snap->index_state == PCIE_CFG_INDEX_NONE))
+      val_pcie_cfg_cache_build_index(snap);
+
+  return snap;
+}
+
+/**
+  @brief   Reads a config space dword through the BDF snapshot.
+
+  @param   snap   - BDF snapshot
+  @param   offset - Word aligned register offset
+  @param   *data  - 32-bit data read from the config space
+  @return  success/failure
+**/
+static uint32_t
+val_pcie_cfg_cache_read(pcie_cfg_snapshot *snap, uint32_t offset, uint32_t *data)
+{
+  uint32_t dword = offset >> 2;
+  uint32_t bit = (1u << (dword % 32));
+
+  if ((snap->index_state != PCIE_CFG_INDEX_READY) ||
+      (snap->status_map[dword / 32] & bit)) {
+      g_pcie_cfg_cache_stats.bypass++;
+      return val_pcie_read_cfg_ecam(snap->bdf, offset, data);
+  }
+
+  if (snap->valid_map[dword / 32] & bit) {
+      *data = snap->image[dword];
+      g_pcie_cfg_cache_stats.hits++;
+      g_pcie_cfg_cache_stats.mmio_saved++;
+      return 0;
+  }
+
+  return val_pcie_cfg_cache_fill(snap, offset, data);
+}
+
+/**
+  @brief   Drops the snapshot image of a BDF after a config write. The
+           capability index is kept as capability lists are read-only.
+
+  @param   bdf    - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @return  None
+**/
+static void
+val_pcie_cfg_cache_write_notify(uint32_t bdf)
+{
+  pcie_cfg_snapshot *snap;
+
+  snap = val_pcie_cfg_cache_slot(bdf);
+  if (snap == NULL)
+      return;
+
+  val_memory_set(snap->valid_map, sizeof(snap->valid_map), 0);
+  g_pcie_cfg_cache_stats.invalidations++;
+}
+
+/**
+  @brief   Looks up a capability in the capability index of a BDF snapshot.
+           Return codes match the capability list walk of
+           val_pcie_find_capability.
+
+  @param   snap       - BDF snapshot
+  @param   cid_type   - PCI capability or Extended PCIe capability
+  @param   cid        - Capability ID
+  @param   cid_offset - On return, points to cid offset in Function config space
+  @return  PCIE_SUCCESS, PCIE_CAP_NOT_FOUND or the status of the failed walk
+**/
+static uint32_t
+val_pcie_cfg_cache_find_cap(pcie_cfg_snapshot *snap, uint32_t cid_type, uint32_t cid,
+                            uint32_t *cid_offset)
+{
+  uint32_t index;
+
+  g_pcie_cfg_cache_stats.cap_hits++;
+
+  if (cid_type == PCIE_CAP) {
+      if (snap->cap_list_ret) {
+          g_pcie_cfg_cache_stats.mmio_saved++;
+          return snap->cap_list_status;
+      }
+
+      for (index = 0; index < snap->num_cap; index++)
+      {
+          if (snap->cap_id[index] == cid) {
+              *cid_offset = snap->cap_offset[index];
+              g_pcie_cfg_cache_stats.mmio_saved += index + 2;
+              return PCIE_SUCCESS;
+          }
+      }
+      g_pcie_cfg_cache_stats.mmio_saved += snap->num_cap + 1;
+  } else if (cid_type == PCIE_ECAP) {
+      for (index = 0; index < snap->num_ecap; index++)
+      {
+          if (snap->ecap_id[index] == cid) {
+              *cid_offset = snap->ecap_offset[index];
+              g_pcie_cfg_cache_stats.mmio_saved += index + 1;
+              return PCIE_SUCCESS;
+          }
+      }
+      g_pcie_cfg_cache_stats.mmio_saved += snap->num_ecap + snap->ecap_list_ur;
+      if (snap->ecap_list_ur)
+          return PCIE_UNKNOWN_RESPONSE;
+  }
+
+  return PCIE_CAP_NOT_FOUND;
+}
+
+/**
+  @brief   Allocates the config space snapshot cache for the functions in
+           the BDF table, if enabled through the execution policy.
+           1. Caller       -  Validation layer.
+           2. Prerequisite -  val_pcie_create_device_bdf_table
+  @param   None
+
+  @return  0 if success or disabled, 1 if allocation failed
+**/
+uint32_t
+val_pcie_cfg_cache_init(void)
+{
+  uint32_t tbl_index;
+  uint32_t bucket;
+  uint32_t num_entries;
+
+  if (!acs_policy_get_pcie_cfg_cache() || (g_pcie_cfg_cache != NULL) ||
+      (g_pcie_bdf_table == NULL))
+      return 0;
+
+  num_entries = g_pcie_bdf_table->num_entries;
+  if (num_entries > PCIE_CFG_CACHE_MAX_BDF) {
+      val_print(WARN, " PCIE_INFO: Config cache limited to %d BDFs\n",
+                PCIE_CFG_CACHE_MAX_BDF);
+      num_entries = PCIE_CFG_CACHE_MAX_BDF;
+  }
+
+  if (num_entries == 0)
+      return 0;
+
+  g_pcie_cfg_cache_hash = val_memory_calloc(PCIE_CFG_CACHE_HASH_SZ, sizeof(uint16_t));
+  g_pcie_cfg_cache = val_memory_calloc(num_entries, sizeof(pcie_cfg_snapshot));
+  if ((g_pcie_cfg_cache == NULL) || (g_pcie_cfg_cache_hash == NULL)) {
+      val_print(ERROR, "\n       PCIe config cache allocation failed");
+      val_pcie_cfg_cache_free();
+      return 1;
+  }
+
+  for (tbl_index = 0; tbl_index < num_entries; tbl_index++)
+  {
+      g_pcie_cfg_cache[tbl_index].bdf = g_pcie_bdf_table->device[tbl_index].bdf;
+
+      bucket = val_pcie_cfg_cache_hash(g_pcie_cfg_cache[tbl_index].bdf);
+      while (g_pcie_cfg_cache_hash[bucket] != 0)
+          bucket = (bucket + 1) & (PCIE_CFG_CACHE_HASH_SZ - 1);
+
+      g_pcie_cfg_cache_hash[bucket] = tbl_index + 1;
+  }
+
+  g_pcie_cfg_cache_entries = num_entries;
+  val_memory_set(&g_pcie_cfg_cache_stats, sizeof(g_pcie_cfg_cache_stats), 0);
+  val_print(INFO, " PCIE_INFO: Config cache enabled for  :    %d BDFs\n", num_entries);
+
+  return 0;
+}
+
+/**
+  @brief   Drops the snapshot image and the capability index of a BDF. To be
+           used after a reset or a bus number change of the function.
+
+  @param   bdf    - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @return  None
+**/
+void
+val_pcie_cfg_cache_invalidate(uint32_t bdf)
+{
+  pcie_cfg_snapshot *snap;
+
+  snap = val_pcie_cfg_cache_slot(bdf);
+  if (snap == NULL)
+      return;
+
+  val_memory_set(snap->valid_map, sizeof(snap->valid_map), 0);
+  snap->index_state = PCIE_CFG_INDEX_NONE;
+  g_pcie_cfg_cache_stats.invalidations++;
+}
+
+/**
+  @brief   Drops the snapshot images of all BDFs, keeping the capability
+           indexes. Called at test boundaries.
+
+  @param   None
+  @return  None
+**/
+void
+val_pcie_cfg_cache_invalidate_all(void)
+{
+  uint32_t index;
+
+  if (g_pcie_cfg_cache == NULL)
+      return;
+
+  for (index = 0; index < g_pcie_cfg_cache_entries; index++)
+      val_memory_set(g_pcie_cfg_cache[index].valid_map,
+                     sizeof(g_pcie_cfg_cache[index].valid_map), 0);
+}
+
+/**
+  @brief   Drops the snapshot images and capability indexes of the functions
+           on a range of buses of a segment.
+
+  @param   segment - PCIe segment
+  @param   bus_lo  - First bus of the range
+  @param   bus_hi  - Last bus of the range
+  @return  None
+**/
+static void
+val_pcie_cfg_cache_invalidate_buses(uint32_t segment, uint32_t bus_lo, uint32_t bus_hi)
+{
+  uint32_t index;
+  uint32_t bdf;
+
+  if (g_pcie_cfg_cache == NULL)
+      return;
+
+  for (index = 0; index < g_pcie_cfg_cache_entries; index++)
+  {
+      bdf = g_pcie_cfg_cache[index].bdf;
+      if ((PCIE_EXTRACT_BDF_SEG(bdf) == segment) && (PCIE_EXTRACT_BDF_BUS(bdf) >= bus_lo) &&
+          (PCIE_EXTRACT_BDF_BUS(bdf) <= bus_hi))
+          val_pcie_cfg_cache_invalidate(bdf);
+  }
+}
+
+/**
+  @brief   Drops the cached config space state a write can change. Besides
+           the written function, writes to the bus numbers, the windows or
+           the Secondary Bus Reset of a Type-1 header change the hierarchy
+           and the functions below the bridge. Type-0 writes keep both.
+
+  @param   bdf    - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @param   offset - Register offset written
+  @param   data   - Value written
+  @return  None
+**/
+static void
+val_pcie_cfg_write_effects(uint32_t bdf, uint32_t offset, uint32_t data)
+{
+  uint32_t dword = offset & ~WORD_ALIGN_MASK;
+  uint32_t reg_value;
+  uint32_t segment = PCIE_EXTRACT_BDF_SEG(bdf);
+  uint32_t sbr = (dword == TYPE01_ILR) && (data & BRIDGE_CTRL_SBR_SET);
+
+  val_pcie_cfg_cache_write_notify(bdf);
+
+  if ((dword < TYPE1_PBN || dword > TYPE1_IO_BLU) && !sbr)
+      return;
+
+  /* The same offsets are BARs in a Type-0 header */
+  if (val_pcie_read_cfg_ecam(bdf, TYPE01_CLSR, &reg_value) ||
+      (((((reg_value >> TYPE01_HTR_SHIFT) & TYPE01_HTR_MASK) >> HTR_HL_SHIFT) & HTR_HL_MASK)
+       != TYPE1_HEADER))
+      return;
+
+  /* Bridges below a reset bridge lose their bus numbers as well */
+  val_pcie_hierarchy_invalidate();
+
+  if (g_pcie_cfg_cache == NULL)
+      return;
+
+  /* Bus numbers of the whole segment may now resolve to other functions */
+  if (dword == TYPE1_PBN) {
+      val_pcie_cfg_cache_invalidate_buses(segment, 0, PCIE_MAX_BUS - 1);
+      return;
+  }
+
+  /* A window write changes routing only, the functions keep their state */
+  if (!sbr)
+      return;
+
+  /* Secondary Bus Reset: everything below the bridge returns to its reset state */
+  if (val_pcie_read_cfg_ecam(bdf, TYPE1_PBN, &reg_value))
+      return;
+
+  val_pcie_cfg_cache_invalidate_buses(segment, (reg_value >> SECBN_SHIFT) & SECBN_MASK,
+                                      (reg_value >> SUBBN_SHIFT) & SUBBN_MASK);
+}
+
+/**
+  @brief   Bypasses the config space snapshot cache until
+           val_pcie_cfg_cache_resume(). The cache is not safe for concurrent
+           use, so callers running config reads on several PEs suspend it
+           first. Must be called from the primary PE.
+
+  @param   None
+  @return  None
+**/
+void
+val_pcie_cfg_cache_suspend(void)
+{
+  if ((g_pcie_cfg_cache == NULL) || (g_pcie_cfg_cache_suspended != NULL))
+      return;
+
+  g_pcie_cfg_cache_suspended = g_pcie_cfg_cache;
+  g_pcie_cfg_cache = NULL;
+}
+
+/**
+  @brief   Re-enables the cache bypassed by val_pcie_cfg_cache_suspend(),
+           dropping the snapshots as other PEs may have written config space.
+
+  @param   None
+  @return  None
+**/
+void
+val_pcie_cfg_cache_resume(void)
+{
+  if (g_pcie_cfg_cache_suspended == NULL)
+      return;
+
+  g_pcie_cfg_cache = g_pcie_cfg_cache_suspended;
+  g_pcie_cfg_cache_suspended = NULL;
+  val_pcie_cfg_cache_invalidate_all();
+}
+
+/**
+  @brief   Prints the config space snapshot cache counters.
+
+  @param   None
+  @return  None
+**/
+void
+val_pcie_cfg_cache_print_stats(void)
+{
+  if (g_pcie_cfg_cache == NULL)
+      return;
+
+  val_print(INFO, "\n PCIE_INFO: Config cache hits         : %ld", g_pcie_cfg_cache_stats.hits);
+  val_print(INFO, "\n PCIE_INFO: Config cache misses       : %ld",
+            g_pcie_cfg_cache_stats.misses);
+  val_print(INFO, "\n PCIE_INFO: Config cache bypass       : %ld",
+            g_pcie_cfg_cache_stats.bypass);
+  val_print(INFO, "\n PCIE_INFO: Config cache invalidations: %ld",
+            g_pcie_cfg_cache_stats.invalidations);
+  val_print(INFO, "\n PCIE_INFO: Capability index hits     : %ld",
+            g_pcie_cfg_cache_stats.cap_hits);
+  val_print(INFO, "\n PCIE_INFO: ECAM reads saved          : %ld\n",
+            g_pcie_cfg_cache_stats.mmio_saved);
+}
+
+/**
+  @brief   Frees the config space snapshot cache.
+
+  @param   None
+  @return  None
+**/
+void
+val_pcie_cfg_cache_free(void)
+{
+  if (g_pcie_cfg_cache != NULL)
+      val_memory_free(g_pcie_cfg_cache);
+
+  if (g_pcie_cfg_cache_hash != NULL)
+      val_memory_free(g_pcie_cfg_cache_hash);
+
+  g_pcie_cfg_cache = NULL;
+  g_pcie_cfg_cache_hash = NULL;
+  g_pcie_cfg_cache_entries = 0;
+}
+
+/**
+  @brief   Reads 32-bit data from the ECAM of the function, bypassing the
+           config space snapshot cache.
+
+  @param   bdf    - concatenated Bus(8-bits), device(8-bits) & function(8-bits)
+  @param   offset - Register offset within a device PCIe config space
+  @param   *data  - 32-bit data read from the config space
+
+  @return  success/failure
+**/
+static uint32_t
+val_pcie_read_cfg_ecam(uint32_t bdf, uint32_t offset, uint32_t *data)
+{
+  uint32_t bus     = PCIE_EXTRACT_BDF_BUS(bdf);
+  uint32_t dev     = PCIE_EXTRACT_BDF_DEV(bdf);
+  uint32_t func    = PCIE_EXTRACT_BDF_FUNC(bdf);
+  uint32_t segment = PCIE_EXTRACT_BDF_SEG(bdf);
+  uint32_t cfg_addr;
+  addr_t   ecam_base;
+
+  ecam_base = val_pcie_ecam_lookup(segment, bus, NULL);
+
+  if (ecam_base == 0) {
+      val_print(ERROR, "\n       PCIe_CFG_RD ECAM Base is zero %.8x", bdf);
+      return PCIE_NO_MAPPING;
+  }
+
+  /* There are 8 functions / device, 32 devices / Bus and each has a 4KB config space */
+  cfg_addr = (bus * PCIE_MAX_DEV * PCIE_MAX_FUNC * 4096) + \
+               (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
+
+  *data = val_mmio_read(ecam_base + cfg_addr + offset);
+  return 0;
+
+}
+
 /**
   @brief   This API reads 32-bit data from PCIe config space pointed by Bus,
-           Device, Function and register offset.
+           Device, Function and register offset. Reads are served from the
+           config space snapshot cache when it is enabled.
            1. Caller       -  Test Suite
            2. Prerequisite -  val_pcie_create_info_table
   @param   bdf    - concatenated Bus(8-bits), device(8-bits) & function(8-bits)
@@ -50,10 +884,7 @@ val_pcie_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data)
   uint32_t bus     = PCIE_EXTRACT_BDF_BUS(bdf);
   uint32_t dev     = PCIE_EXTRACT_BDF_DEV(bdf);
   uint32_t func    = PCIE_EXTRACT_BDF_FUNC(bdf);
-  uint32_t segment = PCIE_EXTRACT_BDF_SEG(bdf);
-  uint32_t cfg_addr;
-  addr_t   ecam_base = 0;
-  uint32_t i = 0;
+  pcie_cfg_snapshot *snap;
 
   if ((bus >= PCIE_MAX_BUS) || (dev >= PCIE_MAX_DEV) || (func >= PCIE_MAX_FUNC)) {
      val_print(ERROR, "\n       Invalid Bus/Dev/Func  %x", bdf);
@@ -65,30 +896,13 @@ val_pcie_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data)
       return PCIE_NO_MAPPING;
   }
 
-  while (i < (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0))
-  {
-
-      if ((bus >= (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, i)) &&
-           (bus <= (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, i)) &&
-           (segment == (uint32_t)val_pcie_get_info(PCIE_INFO_SEGMENT, i))) {
-          ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, i);
-          break;
-      }
-      i++;
-  }
-
-  if (ecam_base == 0) {
-      val_print(ERROR, "\n       PCIe_CFG_RD ECAM Base is zero %.8x", bdf);
-      return PCIE_NO_MAPPING;
+  if ((g_pcie_cfg_cache != NULL) && !(offset & WORD_ALIGN_MASK) && (offset < PCIE_CFG_SIZE)) {
+      snap = val_pcie_cfg_cache_lookup(bdf);
+      if (snap != NULL)
+          return val_pcie_cfg_cache_read(snap, offset, data);
   }
 
-  /* There are 8 functions / device, 32 devices / Bus and each has a 4KB config space */
-  cfg_addr = (bus * PCIE_MAX_DEV * PCIE_MAX_FUNC * 4096) + \
-               (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
-
-  *data = pal_mmio_read(ecam_base + cfg_addr + offset);
-  return 0;
-
+  return val_pcie_read_cfg_ecam(bdf, offset, data);
 }
 
 /**
@@ -127,9 +941,7 @@ val_pcie_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data)
   uint32_t func     = PCIE_EXTRACT_BDF_FUNC(bdf);
   uint32_t segment  = PCIE_EXTRACT_BDF_SEG(bdf);
   uint32_t cfg_addr;
-  addr_t   ecam_base = 0;
-  uint32_t i = 0;
-
+  addr_t   ecam_base;
 
   if ((bus >= PCIE_MAX_BUS) || (dev >= PCIE_MAX_DEV) || (func >= PCIE_MAX_FUNC)) {
      val_print(ERROR, "\n       Invalid Bus/Dev/Func  %x", bdf);
@@ -141,17 +953,7 @@ val_pcie_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data)
       return;
   }
 
-  while (i < (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0))
-  {
-
-      if ((bus >= (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, i)) &&
-           (bus <= (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, i)) &&
-           (segment == (uint32_t)val_pcie_get_info(PCIE_INFO_SEGMENT, i))) {
-          ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, i);
-          break;
-      }
-      i++;
-  }
+  ecam_base = val_pcie_ecam_lookup(segment, bus, NULL);
 
   if (ecam_base == 0) {
       val_print(ERROR, "\n       PCIe_CFG_WR ECAM Base is zero %.8x", bdf);
@@ -162,8 +964,9 @@ val_pcie_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data)
   cfg_addr = (bus * PCIE_MAX_DEV * PCIE_MAX_FUNC * 4096) + \
                (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
 
-  pal_mmio_write(ecam_base + cfg_addr + offset, data);
+  val_mmio_write(ecam_base + cfg_addr + offset, data);
   val_mem_issue_dsb();
+  val_pcie_cfg_write_effects(bdf, offset, data);
 }
 
 /**
@@ -182,6 +985,7 @@ val_pcie_io_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data)
 {
     pal_pcie_io_write_cfg(bdf, offset, data);
     val_mem_issue_dsb();
+    val_pcie_cfg_write_effects(bdf, offset, data);
     return;
 }
 
@@ -234,9 +1038,7 @@ uint64_t val_pcie_get_bdf_config_addr(uint32_t bdf)
   uint32_t func     = PCIE_EXTRACT_BDF_FUNC(bdf);
   uint32_t segment  = PCIE_EXTRACT_BDF_SEG(bdf);
   uint32_t cfg_addr;
-  uint32_t num_ecam;
-  addr_t   ecam_base = 0;
-  uint32_t i = 0;
+  addr_t   ecam_base;
 
   if ((bus >= PCIE_MAX_BUS) || (dev >= PCIE_MAX_DEV) || (func >= PCIE_MAX_FUNC)) {
      val_print(ERROR, "\n       Invalid Bus/Dev/Func  %x", bdf);
@@ -248,18 +1050,7 @@ uint64_t val_pcie_get_bdf_config_addr(uint32_t bdf)
       return 0;
   }
 
-  num_ecam = (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
-  while (i < num_ecam)
-  {
-
-      if ((bus >= (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, i)) &&
-           (bus <= (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, i)) &&
-           (segment == (uint32_t)val_pcie_get_info(PCIE_INFO_SEGMENT, i))) {
-          ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, i);
-          break;
-      }
-      i++;
-  }
+  ecam_base = val_pcie_ecam_lookup(segment, bus, NULL);
 
   if (ecam_base == 0) {
       val_print(ERROR, "\n       BDF config Read PCIe_CFG: ECAM Base is zero %x", bdf);
@@ -399,83 +1190,502 @@ val_pcie_print_device_info(void)
           uint64_t dev_ecam_base;
           uint32_t bdf;
 
-          bdf = bdf_tbl_ptr->device[tbl_index++].bdf;
-          seg_num  = PCIE_EXTRACT_BDF_SEG(bdf);
-          bus_num  = PCIE_EXTRACT_BDF_BUS(bdf);
-          dev_num  = PCIE_EXTRACT_BDF_DEV(bdf);
-          func_num = PCIE_EXTRACT_BDF_FUNC(bdf);
+          bdf = bdf_tbl_ptr->device[tbl_index++].bdf;
+          seg_num  = PCIE_EXTRACT_BDF_SEG(bdf);
+          bus_num  = PCIE_EXTRACT_BDF_BUS(bdf);
+          dev_num  = PCIE_EXTRACT_BDF_DEV(bdf);
+          func_num = PCIE_EXTRACT_BDF_FUNC(bdf);
+
+          val_pcie_read_cfg(bdf, TYPE01_VIDR, &reg_value);
+          device_id = (reg_value >> TYPE01_DIDR_SHIFT) & TYPE01_DIDR_MASK;
+          vendor_id = (reg_value >> TYPE01_VIDR_SHIFT) & TYPE01_VIDR_MASK;
+
+          dev_ecam_base = val_pcie_get_ecam_base(bdf);
+
+          if ((ecam_base == dev_ecam_base) && (bus_num >= ecam_start_bus)
+              && (bus_num <= ecam_end_bus))
+          {
+              bdf_counter = 1;
+              bdf = PCIE_CREATE_BDF(seg_num, bus_num, dev_num, func_num);
+              val_print(TRACE, "  BDF: 0x%x\n", bdf);
+              val_print(TRACE, "  Seg: 0x%x, ", seg_num);
+              val_print(TRACE, "Bus: 0x%02x, ", bus_num);
+              val_print(TRACE, "Dev: 0x%02x, ", dev_num);
+              val_print(TRACE, "Func: 0x%x, ", func_num);
+              val_print(TRACE, "Dev ID: 0x%04x, ", device_id);
+              val_print(TRACE, "Vendor ID: 0x%04x\n", vendor_id);
+          }
+      }
+      if (bdf_counter == 0)
+          val_print(TRACE, "  No BDF devices in ECAM region index %d\n", ecam_index);
+
+      ecam_index++;
+  }
+}
+
+/**
+  @brief   This API will call PAL layer to fill in the PCIe information
+           into the g_pcie_info_table pointer.
+           1. Caller       -  Application layer.
+           2. Prerequisite -  Memory allocated and passed as argument.
+  @param   pcie_info_table    Memory address where PCIe Information is populated
+
+  @return  Error if Input param is NULL
+**/
+void
+val_pcie_create_info_table(uint64_t *pcie_info_table)
+{
+  uint32_t num_ecam;
+
+  if (pcie_info_table == NULL) {
+      val_print(ERROR, "Input for Create Info table cannot be NULL\n");
+      return;
+  }
+  val_print(TRACE, " Creating PCIe INFO table\n");
+
+  g_pcie_info_table = (PCIE_INFO_TABLE *)pcie_info_table;
+
+  pal_pcie_create_info_table(g_pcie_info_table);
+
+  num_ecam = (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
+  val_print(INFO, " PCIE_INFO: Number of ECAM regions    :    %ld\n", num_ecam);
+  if (num_ecam == 0)
+      return;
+
+  /* Config accessors in VAL and PAL resolve BDFs through this map */
+  val_pcie_build_ecam_map();
+  pal_pcie_set_ecam_resolver(val_pcie_ecam_map_resolve);
+
+  val_pcie_enumerate();
+
+  /* Create the list of valid Pcie Device Functions */
+  if (val_pcie_create_device_bdf_table()) {
+      val_print(ERROR, "   Create Bdf table failed.\n");
+      return;
+  }
+
+  if (pal_pcie_check_device_list()) {
+    pcie_bdf_table_list_flag = 1;
+    val_print(ERROR, "Pcie device list doesn't match \
+                with platform pcie device hierarchy\n");
+  }
+
+  val_pcie_print_device_info();
+}
+
+/**
+  @brief   Returns the segment/secondary bus key of a bridge node, used to
+           order the bridge and Root Port indexes.
+**/
+static uint32_t
+val_pcie_hierarchy_bus_key(uint32_t node)
+{
+  return (PCIE_EXTRACT_BDF_SEG(g_pcie_hier[node].bdf) << 8) | g_pcie_hier[node].sec_bus;
+}
+
+/**
+  @brief   Sorts a list of node indexes by key. Insertion sort is stable and
+           close to linear here, as enumeration already produces the BDF
+           table in segment/bus order.
+  @param   list     - Node indexes to sort
+  @param   count    - Number of entries in the list
+  @param   by_bus   - Sort by segment/secondary bus if set, by BDF otherwise
+
+  @return  None
+**/
+static void
+val_pcie_hierarchy_sort(uint32_t *list, uint32_t count, uint32_t by_bus)
+{
+  uint32_t index;
+  uint32_t pos;
+  uint32_t node;
+  uint32_t key;
+
+  for (index = 1; index < count; index++)
+  {
+      node = list[index];
+      key = by_bus ? val_pcie_hierarchy_bus_key(node) : g_pcie_hier[node].bdf;
+      pos = index;
+
+      while ((pos > 0) &&
+             ((by_bus ? val_pcie_hierarchy_bus_key(list[pos - 1]) :
+                        g_pcie_hier[list[pos - 1]].bdf) > key))
+      {
+          list[pos] = list[pos - 1];
+          pos--;
+      }
+
+      list[pos] = node;
+  }
+}
+
+/**
+  @brief   Returns the position of the first entry of a bus sorted list
+           whose key is greater than the input key.
+  @param   list     - Node indexes sorted by segment/secondary bus
+  @param   count    - Number of entries in the list
+  @param   key      - Segment/bus key to search
+
+  @return  Position in the list, count if all keys are smaller or equal
+**/
+static uint32_t
+val_pcie_hierarchy_upper_bound(uint32_t *list, uint32_t count, uint32_t key)
+{
+  uint32_t low = 0;
+  uint32_t high = count;
+  uint32_t mid;
+
+  while (low < high)
+  {
+      mid = low + (high - low) / 2;
+      if (val_pcie_hierarchy_bus_key(list[mid]) <= key)
+          low = mid + 1;
+      else
+          high = mid;
+  }
+
+  return low;
+}
+
+/**
+  @brief   Returns the node of the Root Port whose bus range decodes the
+           input segment/bus. Misprogrammed Root Ports may have overlapping
+           ranges, so every Root Port of the segment with a secondary bus
+           less than or equal to the input bus is checked and the first one
+           in BDF table order wins, as in a BDF table scan.
+  @param   seg      - Segment number
+  @param   bus      - Bus number
+
+  @return  Node index, PCIE_HIER_NONE if no Root Port decodes the bus
+**/
+static uint32_t
+val_pcie_hierarchy_find_rp(uint32_t seg, uint32_t bus)
+{
+  uint32_t pos;
+  uint32_t key;
+  uint32_t node;
+  uint32_t rp_node;
+
+  key = (seg << 8) | bus;
+  pos = val_pcie_hierarchy_upper_bound(g_pcie_hier_rp_sort, g_pcie_hier_num_rp, key);
+  rp_node = PCIE_HIER_NONE;
+
+  while (pos > 0)
+  {
+      node = g_pcie_hier_rp_sort[--pos];
+      if (PCIE_EXTRACT_BDF_SEG(g_pcie_hier[node].bdf) != seg)
+          break;
+
+      if ((g_pcie_hier[node].sub_bus >= bus) && (node < rp_node))
+          rp_node = node;
+  }
+
+  return rp_node;
+}
+
+/**
+  @brief   Returns the node of the bridge whose secondary bus is the input
+           segment/bus.
+  @param   seg      - Segment number
+  @param   bus      - Bus number
+
+  @return  Node index, PCIE_HIER_NONE if no bridge forwards to the bus
+**/
+static uint32_t
+val_pcie_hierarchy_find_bridge(uint32_t seg, uint32_t bus)
+{
+  uint32_t pos;
+  uint32_t key;
+
+  key = (seg << 8) | bus;
+  pos = val_pcie_hierarchy_upper_bound(g_pcie_hier_bridge_sort, g_pcie_hier_num_bridge, key);
+
+  while (pos > 0)
+  {
+      if (val_pcie_hierarchy_bus_key(g_pcie_hier_bridge_sort[pos - 1]) != key)
+          break;
+      pos--;
+  }
+
+  if ((pos < g_pcie_hier_num_bridge) &&
+      (val_pcie_hierarchy_bus_key(g_pcie_hier_bridge_sort[pos]) == key))
+      return g_pcie_hier_bridge_sort[pos];
+
+  return PCIE_HIER_NONE;
+}
+
+/**
+  @brief   Returns the position of the first entry of the BDF sorted node
+           list whose BDF is greater than or equal to the input BDF.
+  @param   bdf      - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+
+  @return  Position in the list, number of nodes if all BDFs are smaller
+**/
+static uint32_t
+val_pcie_hierarchy_lower_bound(uint32_t bdf)
+{
+  uint32_t low = 0;
+  uint32_t high = g_pcie_hier_entries;
+  uint32_t mid;
+
+  while (low < high)
+  {
+      mid = low + (high - low) / 2;
+      if (g_pcie_hier[g_pcie_hier_bdf_sort[mid]].bdf < bdf)
+          low = mid + 1;
+      else
+          high = mid;
+  }
+
+  return low;
+}
+
+/**
+  @brief   Returns the node of a BDF.
+  @param   bdf      - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+
+  @return  Node index, PCIE_HIER_NONE if the BDF is not in the BDF table
+**/
+static uint32_t
+val_pcie_hierarchy_find_node(uint32_t bdf)
+{
+  uint32_t pos;
+
+  pos = val_pcie_hierarchy_lower_bound(bdf);
+  if ((pos < g_pcie_hier_entries) && (g_pcie_hier[g_pcie_hier_bdf_sort[pos]].bdf == bdf))
+      return g_pcie_hier_bdf_sort[pos];
+
+  return PCIE_HIER_NONE;
+}
+
+/**
+  @brief   Reads the bus numbers of every bridge and links the hierarchy:
+           bus indexes, Root Port and first downstream function of every
+           node. Called at build time and again on the next lookup after a
+           bus number register was written or a bridge was reset.
+  @param   None
+
+  @return  None
+**/
+static void
+val_pcie_hierarchy_link(void)
+{
+  uint32_t node;
+  uint32_t pos;
+  uint32_t seg;
+  uint32_t bus;
+  uint32_t reg_value;
+  uint32_t type1_node;
+  pcie_hier_node *entry;
+  pcie_hier_node *child;
+
+  g_pcie_hier_num_bridge = 0;
+  g_pcie_hier_num_rp = 0;
+
+  for (node = 0; node < g_pcie_hier_entries; node++)
+  {
+      entry = &g_pcie_hier[node];
+      entry->rootport = PCIE_HIER_NONE;
+      entry->dsf = PCIE_HIER_NONE;
+
+      if (entry->hdr_type != TYPE1_HEADER)
+          continue;
+
+      val_pcie_read_cfg(entry->bdf, TYPE1_PBN, &reg_value);
+      entry->sec_bus = (reg_value >> SECBN_SHIFT) & SECBN_MASK;
+      entry->sub_bus = (reg_value >> SUBBN_SHIFT) & SUBBN_MASK;
+
+      /* A bridge without bus numbers assigned is nobody's parent */
+      if (entry->sec_bus > PCIE_EXTRACT_BDF_BUS(entry->bdf))
+          g_pcie_hier_bridge_sort[g_pcie_hier_num_bridge++] = node;
 
-          val_pcie_read_cfg(bdf, TYPE01_VIDR, &reg_value);
-          device_id = (reg_value >> TYPE01_DIDR_SHIFT) & TYPE01_DIDR_MASK;
-          vendor_id = (reg_value >> TYPE01_VIDR_SHIFT) & TYPE01_VIDR_MASK;
+      if ((entry->dp_type == RP) || (entry->dp_type == iEP_RP))
+          g_pcie_hier_rp_sort[g_pcie_hier_num_rp++] = node;
+  }
 
-          dev_ecam_base = val_pcie_get_ecam_base(bdf);
+  val_pcie_hierarchy_sort(g_pcie_hier_bridge_sort, g_pcie_hier_num_bridge, 1);
+  val_pcie_hierarchy_sort(g_pcie_hier_rp_sort, g_pcie_hier_num_rp, 1);
 
-          if ((ecam_base == dev_ecam_base) && (bus_num >= ecam_start_bus)
-              && (bus_num <= ecam_end_bus))
-          {
-              bdf_counter = 1;
-              bdf = PCIE_CREATE_BDF(seg_num, bus_num, dev_num, func_num);
-              val_print(TRACE, "  BDF: 0x%x\n", bdf);
-              val_print(TRACE, "  Seg: 0x%x, ", seg_num);
-              val_print(TRACE, "Bus: 0x%02x, ", bus_num);
-              val_print(TRACE, "Dev: 0x%02x, ", dev_num);
-              val_print(TRACE, "Func: 0x%x, ", func_num);
-              val_print(TRACE, "Dev ID: 0x%04x, ", device_id);
-              val_print(TRACE, "Vendor ID: 0x%04x\n", vendor_id);
+  for (node = 0; node < g_pcie_hier_entries; node++)
+  {
+      entry = &g_pcie_hier[node];
+      seg = PCIE_EXTRACT_BDF_SEG(entry->bdf);
+      bus = PCIE_EXTRACT_BDF_BUS(entry->bdf);
+
+      if ((entry->dp_type == RP) || (entry->dp_type == iEP_RP))
+          entry->rootport = node;
+      else if ((entry->dp_type != RCiEP) && (entry->dp_type != RCEC))
+          entry->rootport = val_pcie_hierarchy_find_rp(seg, bus);
+  }
+
+  /* First Type 0 function below each bridge, else the first Type 1 function */
+  for (node = 0; node < g_pcie_hier_entries; node++)
+  {
+      entry = &g_pcie_hier[node];
+      if (entry->hdr_type != TYPE1_HEADER)
+          continue;
+
+      seg = PCIE_EXTRACT_BDF_SEG(entry->bdf);
+      type1_node = PCIE_HIER_NONE;
+
+      pos = val_pcie_hierarchy_lower_bound(PCIE_CREATE_BDF(seg, entry->sec_bus, 0, 0));
+      for (; pos < g_pcie_hier_entries; pos++)
+      {
+          child = &g_pcie_hier[g_pcie_hier_bdf_sort[pos]];
+          if ((PCIE_EXTRACT_BDF_SEG(child->bdf) != seg) ||
+              (PCIE_EXTRACT_BDF_BUS(child->bdf) > entry->sub_bus))
+              break;
+
+          if (child->hdr_type == TYPE0_HEADER) {
+              entry->dsf = g_pcie_hier_bdf_sort[pos];
+              break;
           }
+
+          if (type1_node == PCIE_HIER_NONE)
+              type1_node = g_pcie_hier_bdf_sort[pos];
       }
-      if (bdf_counter == 0)
-          val_print(TRACE, "  No BDF devices in ECAM region index %d\n", ecam_index);
 
-      ecam_index++;
+      if (entry->dsf == PCIE_HIER_NONE)
+          entry->dsf = type1_node;
   }
+
+  g_pcie_hier_stale = 0;
 }
 
 /**
-  @brief   This API will call PAL layer to fill in the PCIe information
-           into the g_pcie_info_table pointer.
-           1. Caller       -  Application layer.
-           2. Prerequisite -  Memory allocated and passed as argument.
-  @param   pcie_info_table    Memory address where PCIe Information is populated
+  @brief   Returns whether the hierarchy index can answer lookups, relinking
+           it first if a bus number register was written since the last
+           lookup.
+  @param   None
 
-  @return  Error if Input param is NULL
+  @return  1 if the index is usable, 0 otherwise
 **/
-void
-val_pcie_create_info_table(uint64_t *pcie_info_table)
+static uint32_t
+val_pcie_hierarchy_ready(void)
 {
-  uint32_t num_ecam;
+  if (g_pcie_hier == NULL)
+      return 0;
 
-  if (pcie_info_table == NULL) {
-      val_print(ERROR, "Input for Create Info table cannot be NULL\n");
-      return;
-  }
-  val_print(TRACE, " Creating PCIe INFO table\n");
+  if (g_pcie_hier_stale)
+      val_pcie_hierarchy_link();
 
-  g_pcie_info_table = (PCIE_INFO_TABLE *)pcie_info_table;
+  return 1;
+}
 
-  pal_pcie_create_info_table(g_pcie_info_table);
+/**
+  @brief   Builds the PCIe hierarchy index of the functions in the BDF table.
+           Root Port, parent and downstream function lookups are then served
+           from the index instead of scanning the BDF table.
+           1. Caller       -  val_pcie_create_device_bdf_table
+           2. Prerequisite -  val_pcie_create_device_bdf_table
+  @param   None
 
-  num_ecam = (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
-  val_print(INFO, " PCIE_INFO: Number of ECAM regions    :    %ld\n", num_ecam);
-  if (num_ecam == 0)
-      return;
+  @return  0 if success, 1 if allocation failed
+**/
+uint32_t
+val_pcie_hierarchy_build(void)
+{
+  uint32_t node;
+  uint32_t num_entries;
 
-  val_pcie_enumerate();
+  if ((g_pcie_hier != NULL) || (g_pcie_bdf_table == NULL))
+      return 0;
 
-  /* Create the list of valid Pcie Device Functions */
-  if (val_pcie_create_device_bdf_table()) {
-      val_print(ERROR, "   Create Bdf table failed.\n");
-      return;
+  num_entries = g_pcie_bdf_table->num_entries;
+  if (num_entries == 0)
+      return 0;
+
+  g_pcie_hier = val_memory_calloc(num_entries, sizeof(pcie_hier_node));
+  g_pcie_hier_bdf_sort = val_memory_calloc(num_entries, sizeof(uint32_t));
+  g_pcie_hier_bridge_sort = val_memory_calloc(num_entries, sizeof(uint32_t));
+  g_pcie_hier_rp_sort = val_memory_calloc(num_entries, sizeof(uint32_t));
+  if ((g_pcie_hier == NULL) || (g_pcie_hier_bdf_sort == NULL) ||
+      (g_pcie_hier_bridge_sort == NULL) || (g_pcie_hier_rp_sort == NULL)) {
+      val_print(WARN, "\n       PCIe hierarchy index allocation failed");
+      val_pcie_hierarchy_free();
+      return 1;
   }
 
-  if (pal_pcie_check_device_list()) {
-    pcie_bdf_table_list_flag = 1;
-    val_print(ERROR, "Pcie device list doesn't match \
-                with platform pcie device hierarchy\n");
+  for (node = 0; node < num_entries; node++)
+  {
+      g_pcie_hier[node].bdf = g_pcie_bdf_table->device[node].bdf;
+      g_pcie_hier[node].dp_type = val_pcie_device_port_type(g_pcie_hier[node].bdf);
+      g_pcie_hier[node].hdr_type = val_pcie_function_header_type(g_pcie_hier[node].bdf);
+      g_pcie_hier_bdf_sort[node] = node;
   }
 
-  val_pcie_print_device_info();
+  g_pcie_hier_entries = num_entries;
+  val_pcie_hierarchy_sort(g_pcie_hier_bdf_sort, num_entries, 0);
+  val_pcie_hierarchy_link();
+
+  val_print(DEBUG, " PCIE_INFO: Hierarchy bridges        :    %d\n", g_pcie_hier_num_bridge);
+  return 0;
+}
+
+/**
+  @brief   Marks the hierarchy index stale. The bus numbers are read again
+           on the next lookup. To be used after a bus number change.
+
+  @param   None
+  @return  None
+**/
+void
+val_pcie_hierarchy_invalidate(void)
+{
+  if (g_pcie_hier != NULL)
+      g_pcie_hier_stale = 1;
+}
+
+/**
+  @brief   Frees the PCIe hierarchy index.
+
+  @param   None
+  @return  None
+**/
+void
+val_pcie_hierarchy_free(void)
+{
+  if (g_pcie_hier != NULL)
+      val_memory_free(g_pcie_hier);
+
+  if (g_pcie_hier_bdf_sort != NULL)
+      val_memory_free(g_pcie_hier_bdf_sort);
+
+  if (g_pcie_hier_bridge_sort != NULL)
+      val_memory_free(g_pcie_hier_bridge_sort);
+
+  if (g_pcie_hier_rp_sort != NULL)
+      val_memory_free(g_pcie_hier_rp_sort);
+
+  g_pcie_hier = NULL;
+  g_pcie_hier_bdf_sort = NULL;
+  g_pcie_hier_bridge_sort = NULL;
+  g_pcie_hier_rp_sort = NULL;
+  g_pcie_hier_entries = 0;
+  g_pcie_hier_num_bridge = 0;
+  g_pcie_hier_num_rp = 0;
+  g_pcie_hier_stale = 0;
+}
+
+/**
+  @brief   Returns the hierarchy index node of a BDF.
+
+  @param   bdf      - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @return  Pointer to the node, NULL if not indexed
+**/
+pcie_hier_node *
+val_pcie_hierarchy_get_node(uint32_t bdf)
+{
+  uint32_t node;
+
+  if (!val_pcie_hierarchy_ready())
+      return NULL;
+
+  node = val_pcie_hierarchy_find_node(bdf);
+  if (node == PCIE_HIER_NONE)
+      return NULL;
+
+  return &g_pcie_hier[node];
 }
 
 /**
@@ -508,6 +1718,194 @@ uint32_t val_pcie_populate_device_rootport(void)
   return 0;
 }
 
+/**
+  @brief   Probes one Function and adds it to a BDF table if it is a PCIe
+           Function to be tested. Every call is counted as a config probe.
+  @param   bdf      - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @param   table    - BDF table to add the Function to
+
+  @return  PCIE_PROBE_ABSENT, PCIE_PROBE_FOUND or PCIE_PROBE_ERROR
+**/
+static uint32_t
+val_pcie_probe_function(uint32_t bdf, pcie_device_bdf_table *table)
+{
+  uint32_t reg_value;
+  uint32_t cid_offset;
+  uint32_t p_cap;
+  uint32_t status;
+  uint32_t dp_type;
+
+  g_pcie_enum_probes++;
+
+  /* Probe pcie device Function with this bdf */
+  if (val_pcie_read_cfg(bdf, TYPE01_VIDR, &reg_value) == PCIE_NO_MAPPING)
+  {
+      /* Return if there is a bdf mapping issue */
+      val_print(ERROR, "\n       BDF 0x%x mapping issue", bdf);
+      return PCIE_PROBE_ERROR;
+  }
+
+  /* Store the Function's BDF if there was a valid response */
+  if (reg_value == PCIE_UNKNOWN_RESPONSE)
+      return PCIE_PROBE_ABSENT;
+
+  /* Skip if the device is a host bridge */
+  if (val_pcie_is_host_bridge(bdf)) {
+      val_print(DEBUG,
+                 "       BDF 0x%x is a Host Bridge...Skipping\n", bdf);
+      return PCIE_PROBE_FOUND;
+  }
+
+#ifndef TARGET_LINUX
+  /* Enable memory access and bus master enable for all BDF's
+   * For BM systems, these bits are enabled during enumeration in PAL
+   * For linux, the driver takes care.
+  */
+  val_pcie_enable_bme(bdf);
+  val_pcie_enable_msa(bdf);
+#endif
+
+  /* Skip if the device is a PCI legacy device */
+  p_cap = val_pcie_find_capability(
+    bdf,
+    PCIE_CAP,
+    CID_PCIECS,
+    &cid_offset);
+
+  if (p_cap != PCIE_SUCCESS) {
+      val_print(DEBUG,
+      "       BDF 0x%x PCI Express capability not present...Skipping\n", bdf);
+      return PCIE_PROBE_FOUND;
+  }
+
+  status = pal_pcie_check_device_valid(bdf);
+  if (status) {
+      val_print(DEBUG,
+       "       BDF 0x%x Marked as invalid in Platform API...Skipping\n", bdf);
+      return PCIE_PROBE_FOUND;
+  }
+
+  dp_type = val_pcie_device_port_type(bdf);
+
+  /* Disable DPC for RP and DP */
+  if ((dp_type == RP) || (dp_type == DP))
+      val_pcie_disable_dpc(bdf);
+
+  /* RCiEP rules are for SBSA L6 */
+  if ((dp_type == RCiEP) || (dp_type == RCEC))
+      g_pcie_integrated_devices++;
+
+  /* iEP rules are for SBSA L6 */
+  if ((dp_type == iEP_EP) || (dp_type == iEP_RP))
+      g_pcie_integrated_devices++;
+
+  if (table->num_entries >= PCIE_DEVICE_BDF_TABLE_MAX) {
+      val_print(WARN, "\n       BDF table full, BDF 0x%x not added", bdf);
+      return PCIE_PROBE_FOUND;
+  }
+
+  table->device[table->num_entries++].bdf = bdf;
+  return PCIE_PROBE_FOUND;
+}
+
+/**
+  @brief   Probes the Functions of the buses in a range, following bridges
+           to decide which buses to visit.
+           Brute-force mode probes every Function of every bus.
+           Pruned mode probes Functions 1-7 only for multi-function devices
+           and skips the buses that a bridge claims but that are not the
+           secondary bus of any bridge. Buses claimed by no bridge are still
+           probed, as they may be the root bus of another host bridge, unless
+           only a subtree is scanned.
+  @param   seg        - Segment number
+  @param   start_bus  - First bus of the range, always probed
+  @param   end_bus    - Last bus of the range
+  @param   prune      - Pruned mode if set, brute-force mode otherwise
+  @param   subtree    - Range is the bus range of a bridge if set
+  @param   table      - BDF table to add the Functions to
+
+  @return  0 if success, 1 if a bdf mapping issue is found
+**/
+static uint32_t
+val_pcie_probe_bus_range(uint32_t seg, uint32_t start_bus, uint32_t end_bus, uint32_t prune,
+                         uint32_t subtree, pcie_device_bdf_table *table)
+{
+  uint32_t bus_index;
+  uint32_t dev_index;
+  uint32_t func_index;
+  uint32_t bdf;
+  uint32_t status;
+  uint32_t reg_value;
+  uint32_t sec_bus;
+  uint32_t sub_bus;
+  uint32_t hdr_value;
+  uint32_t claimed[PCIE_ECAM_MAP_NUM_BUS / 32];
+  uint32_t secondary[PCIE_ECAM_MAP_NUM_BUS / 32];
+
+  val_memory_set(claimed, sizeof(claimed), 0);
+  val_memory_set(secondary, sizeof(secondary), 0);
+
+  /* Iterate over all buses, devices and functions in this range */
+  for (bus_index = start_bus; bus_index <= end_bus; bus_index++)
+  {
+      if (prune && (bus_index != start_bus) &&
+          !(secondary[bus_index / 32] & (1u << (bus_index % 32))) &&
+          (subtree || (claimed[bus_index / 32] & (1u << (bus_index % 32)))))
+          continue;
+
+      if (pal_pcie_check_bus_valid(bus_index)) {
+          val_print(DEBUG,
+           "       Bus 0x%x marked as invalid in Platform API...Skipping\n", bus_index);
+          continue;
+      }
+
+      for (dev_index = 0; dev_index < PCIE_MAX_DEV; dev_index++)
+      {
+          for (func_index = 0; func_index < PCIE_MAX_FUNC; func_index++)
+          {
+              /* Form bdf using seg, bus, device, function numbers */
+              bdf = PCIE_CREATE_BDF(seg, bus_index, dev_index, func_index);
+
+              status = val_pcie_probe_function(bdf, table);
+              if (status == PCIE_PROBE_ERROR)
+                  return 1;
+
+              if (!prune)
+                  continue;
+
+              /* A device without Function 0 has no other Function */
+              if (status == PCIE_PROBE_ABSENT) {
+                  if (func_index == 0)
+                      break;
+                  continue;
+              }
+
+              val_pcie_read_cfg(bdf, TYPE01_CLSR, &hdr_value);
+              hdr_value = (hdr_value >> TYPE01_HTR_SHIFT) & TYPE01_HTR_MASK;
+
+              /* Note the buses forwarded by this bridge */
+              if (((hdr_value >> HTR_HL_SHIFT) & HTR_HL_MASK) == TYPE1_HEADER) {
+                  val_pcie_read_cfg(bdf, TYPE1_PBN, &reg_value);
+                  sec_bus = (reg_value >> SECBN_SHIFT) & SECBN_MASK;
+                  sub_bus = (reg_value >> SUBBN_SHIFT) & SUBBN_MASK;
+
+                  if ((sec_bus > bus_index) && (sec_bus <= end_bus)) {
+                      secondary[sec_bus / 32] |= 1u << (sec_bus % 32);
+                      for (; (sec_bus <= sub_bus) && (sec_bus <= end_bus); sec_bus++)
+                          claimed[sec_bus / 32] |= 1u << (sec_bus % 32);
+                  }
+              }
+
+              /* Functions 1-7 exist only in multi-function devices */
+              if ((func_index == 0) && !((hdr_value >> HTR_MFD_SHIFT) & HTR_MFD_MASK))
+                  break;
+          }
+      }
+  }
+
+  return 0;
+}
+
 /**
   @brief   This API creates the device bdf table from enumeration
 
@@ -523,16 +1921,8 @@ val_pcie_create_device_bdf_table()
   uint32_t seg_num;
   uint32_t start_bus;
   uint32_t end_bus;
-  uint32_t bus_index;
-  uint32_t dev_index;
-  uint32_t func_index;
   uint32_t ecam_index;
-  uint32_t bdf;
-  uint32_t reg_value;
-  uint32_t cid_offset;
-  uint32_t p_cap;
-  uint32_t status;
-  uint32_t dp_type;
+  uint32_t prune;
 
   /* if table is already present, return success */
   if (g_pcie_bdf_table)
@@ -550,6 +1940,7 @@ val_pcie_create_device_bdf_table()
 
   g_pcie_bdf_table->num_entries = 0;
   g_pcie_integrated_devices = 0;
+  g_pcie_enum_probes = 0;
 
   num_ecam = (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
   if (num_ecam == 0)
@@ -558,6 +1949,8 @@ val_pcie_create_device_bdf_table()
       return 1;
   }
 
+  prune = acs_policy_get_pcie_enum_prune();
+
   for (ecam_index = 0; ecam_index < num_ecam; ecam_index++)
   {
       /* Derive ecam specific information */
@@ -565,100 +1958,172 @@ val_pcie_create_device_bdf_table()
       start_bus = (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, ecam_index);
       end_bus = (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, ecam_index);
 
-      /* Iterate over all buses, devices and functions in this ecam */
-      for (bus_index = start_bus; bus_index <= end_bus; bus_index++)
-      {
-          if (pal_pcie_check_bus_valid(bus_index)) {
-              val_print(DEBUG,
-               "       Bus 0x%x marked as invalid in Platform API...Skipping\n", bus_index);
-              continue;
-          }
-
-          for (dev_index = 0; dev_index < PCIE_MAX_DEV; dev_index++)
-          {
-              for (func_index = 0; func_index < PCIE_MAX_FUNC; func_index++)
-              {
-                  /* Form bdf using seg, bus, device, function numbers */
-                  bdf = PCIE_CREATE_BDF(seg_num, bus_index, dev_index, func_index);
+      if (val_pcie_probe_bus_range(seg_num, start_bus, end_bus, prune, 0, g_pcie_bdf_table))
+          return 1;
+  }
 
-                  /* Probe pcie device Function with this bdf */
-                  if (val_pcie_read_cfg(bdf, TYPE01_VIDR, &reg_value) == PCIE_NO_MAPPING)
-                  {
-                      /* Return if there is a bdf mapping issue */
-                      val_print(ERROR, "\n       BDF 0x%x mapping issue", bdf);
-                      return 1;
-                  }
+  /* Snapshot cache covers the functions found above, if enabled */
+  val_pcie_cfg_cache_init();
 
-                  /* Store the Function's BDF if there was a valid response */
-                  if (reg_value != PCIE_UNKNOWN_RESPONSE)
-                  {
-                      /* Skip if the device is a host bridge */
-                      if (val_pcie_is_host_bridge(bdf)) {
-                          val_print(DEBUG,
-                                     "       BDF 0x%x is a Host Bridge...Skipping\n", bdf);
-                          continue;
-                      }
+  /* Index the topology so that Root Port lookups avoid table scans */
+  val_pcie_hierarchy_build();
 
-#ifndef TARGET_LINUX
-                      /* Enable memory access and bus master enable for all BDF's
-                       * For BM systems, these bits are enabled during enumeration in PAL
-                       * For linux, the driver takes care.
-                      */
-                      val_pcie_enable_bme(bdf);
-                      val_pcie_enable_msa(bdf);
-#endif
+  /* Sanity Check : Confirm all EP (normal, integrated) have a rootport */
+  val_pcie_populate_device_rootport();
 
-                      /* Skip if the device is a PCI legacy device */
-                      p_cap = val_pcie_find_capability(
-                        bdf,
-                        PCIE_CAP,
-                        CID_PCIECS,
-                        &cid_offset);
-
-                      if (p_cap != PCIE_SUCCESS) {
-                          val_print(DEBUG,
-                          "       BDF 0x%x PCI Express capability not present...Skipping\n", bdf);
-                          continue;
-                      }
+  val_print(INFO,
+    " PCIE_INFO: Number of BDFs found      :    %d\n", g_pcie_bdf_table->num_entries);
+  val_print(INFO,
+    " PCIE_INFO: Config probes issued      :    %d\n", g_pcie_enum_probes);
 
-                      status = pal_pcie_check_device_valid(bdf);
-                      if (status) {
-                          val_print(DEBUG,
-                           "       BDF 0x%x Marked as invalid in Platform API...Skipping\n", bdf);
-                          continue;
-                      }
+  return 0;
+}
 
-                      dp_type = val_pcie_device_port_type(bdf);
+/**
+  @brief   Enumerates again the Functions below a bridge, to be used after a
+           test resets a link or changes bus numbers. The BDF table entries in
+           the previous and the current bus range of the bridge are replaced
+           by the Functions found now, and the config cache, hierarchy index
+           and Root Port of every entry are refreshed.
+           1. Caller       -  Test Suite
+           2. Prerequisite -  val_pcie_create_device_bdf_table
+  @param   bdf      - Bridge's Segment/Bus/Dev/Func in PCIE_CREATE_BDF format
 
-                      /* Disable DPC for RP and DP */
-                      if ((dp_type == RP) || (dp_type == DP))
-                          val_pcie_disable_dpc(bdf);
+  @return  0 if Success, 1 otherwise
+**/
+uint32_t
+val_pcie_rescan_subtree(uint32_t bdf)
+{
+  uint32_t seg;
+  uint32_t reg_value;
+  uint32_t sec_bus;
+  uint32_t sub_bus;
+  uint32_t old_sec;
+  uint32_t old_sub;
+  uint32_t bus;
+  uint32_t index;
+  uint32_t count;
+  uint32_t pos;
+  uint32_t probes;
+  uint32_t status;
+  uint32_t dp_type;
+  pcie_hier_node *node;
+  pcie_device_bdf_table *found;
 
-                      /* RCiEP rules are for SBSA L6 */
-                      if ((dp_type == RCiEP) || (dp_type == RCEC))
-                          g_pcie_integrated_devices++;
+  if ((g_pcie_bdf_table == NULL) ||
+      (val_pcie_function_header_type(bdf) != TYPE1_HEADER))
+      return 1;
 
-                      /* iEP rules are for SBSA L6 */
-                      if ((dp_type == iEP_EP) || (dp_type == iEP_RP))
-                          g_pcie_integrated_devices++;
+  seg = PCIE_EXTRACT_BDF_SEG(bdf);
+  val_pcie_read_cfg(bdf, TYPE1_PBN, &reg_value);
+  sec_bus = (reg_value >> SECBN_SHIFT) & SECBN_MASK;
+  sub_bus = (reg_value >> SUBBN_SHIFT) & SUBBN_MASK;
+
+  /* Range last seen by the hierarchy index, before any relink */
+  old_sec = sec_bus;
+  old_sub = sub_bus;
+  if (g_pcie_hier != NULL) {
+      index = val_pcie_hierarchy_find_node(bdf);
+      if (index != PCIE_HIER_NONE) {
+          node = &g_pcie_hier[index];
+          old_sec = node->sec_bus;
+          old_sub = node->sub_bus;
+      }
+  }
 
-                      g_pcie_bdf_table->device[g_pcie_bdf_table->num_entries++].bdf = bdf;
+  found = val_memory_calloc(1, PCIE_DEVICE_BDF_TABLE_SZ);
+  if (found == NULL) {
+      val_print(ERROR, "\n       PCIe rescan memory allocation failed");
+      return 1;
+  }
 
-                  }
-              }
-          }
+  probes = g_pcie_enum_probes;
+  if ((sec_bus > PCIE_EXTRACT_BDF_BUS(bdf)) && (sub_bus >= sec_bus)) {
+      status = val_pcie_probe_bus_range(seg, sec_bus, sub_bus, 1, 1, found);
+      if (status) {
+          val_memory_free(found);
+          return 1;
       }
   }
 
-  /* Sanity Check : Confirm all EP (normal, integrated) have a rootport */
+  /* Drop the entries of the previous and the current range */
+  count = 0;
+  pos = PCIE_HIER_NONE;
+  for (index = 0; index < g_pcie_bdf_table->num_entries; index++)
+  {
+      bus = PCIE_EXTRACT_BDF_BUS(g_pcie_bdf_table->device[index].bdf);
+      if ((PCIE_EXTRACT_BDF_SEG(g_pcie_bdf_table->device[index].bdf) == seg) &&
+          (((bus >= old_sec) && (bus <= old_sub)) || ((bus >= sec_bus) && (bus <= sub_bus))) &&
+          (bus > PCIE_EXTRACT_BDF_BUS(bdf)))
+          continue;
+
+      /* New entries go after the bridge and the Functions on lower buses */
+      if ((pos == PCIE_HIER_NONE) &&
+          (PCIE_EXTRACT_BDF_SEG(g_pcie_bdf_table->device[index].bdf) == seg) &&
+          (g_pcie_bdf_table->device[index].bdf > bdf) && (bus >= sec_bus))
+          pos = count;
+
+      g_pcie_bdf_table->device[count++] = g_pcie_bdf_table->device[index];
+  }
+
+  if (pos == PCIE_HIER_NONE)
+      pos = count;
+
+  if (count + found->num_entries > PCIE_DEVICE_BDF_TABLE_MAX) {
+      val_print(WARN, "\n       BDF table full, rescan of BDF 0x%x truncated", bdf);
+      found->num_entries = PCIE_DEVICE_BDF_TABLE_MAX - count;
+  }
+
+  for (index = count; index > pos; index--)
+      g_pcie_bdf_table->device[index - 1 + found->num_entries] =
+                                                         g_pcie_bdf_table->device[index - 1];
+
+  for (index = 0; index < found->num_entries; index++)
+      g_pcie_bdf_table->device[pos + index] = found->device[index];
+
+  g_pcie_bdf_table->num_entries = count + found->num_entries;
+  val_memory_free(found);
+
+  /* Table indexes moved, rebuild everything keyed by them */
+  val_pcie_cfg_cache_free();
+  val_pcie_cfg_cache_init();
+  val_pcie_hierarchy_free();
+  val_pcie_hierarchy_build();
   val_pcie_populate_device_rootport();
 
-  val_print(INFO,
-    " PCIE_INFO: Number of BDFs found      :    %d\n", g_pcie_bdf_table->num_entries);
+  g_pcie_integrated_devices = 0;
+  for (index = 0; index < g_pcie_bdf_table->num_entries; index++)
+  {
+      node = val_pcie_hierarchy_get_node(g_pcie_bdf_table->device[index].bdf);
+      if (node != NULL)
+          dp_type = node->dp_type;
+      else
+          dp_type = val_pcie_device_port_type(g_pcie_bdf_table->device[index].bdf);
+
+      if ((dp_type == RCiEP) || (dp_type == RCEC) || (dp_type == iEP_EP) || (dp_type == iEP_RP))
+          g_pcie_integrated_devices++;
+  }
+
+  val_print(DEBUG, "\n       Rescan of BDF 0x%x", bdf);
+  val_print(DEBUG, " probes %d", g_pcie_enum_probes - probes);
+  val_print(DEBUG, " BDFs found %d", g_pcie_bdf_table->num_entries - count);
 
   return 0;
 }
 
+/**
+  @brief   Returns the number of config probes issued by the enumeration of
+           the BDF table and by subtree rescans.
+
+  @param   None
+  @return  Number of probes
+**/
+uint32_t
+val_pcie_get_enum_probe_count(void)
+{
+  return g_pcie_enum_probes;
+}
+
 /**
   @brief  Returns the ECAM address of the input PCIe function
 
@@ -668,46 +2133,32 @@ val_pcie_create_device_bdf_table()
 addr_t val_pcie_get_ecam_base(uint32_t bdf)
 {
 
-  uint8_t ecam_index;
-  uint8_t sec_bus;
-  uint8_t sub_bus;
-  uint16_t seg_num;
+  uint32_t ecam_index;
+  uint32_t sec_index;
+  uint32_t sec_bus;
+  uint32_t sub_bus;
   uint32_t reg_value;
   addr_t ecam_base;
 
-  ecam_index = 0;
-  ecam_base = 0;
-
-  seg_num = PCIE_EXTRACT_BDF_SEG(bdf);
+  ecam_base = val_pcie_ecam_lookup(PCIE_EXTRACT_BDF_SEG(bdf), PCIE_EXTRACT_BDF_BUS(bdf),
+                                   &ecam_index);
+  if (ecam_base == 0)
+      return 0;
 
-  while (ecam_index < (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0))
-  {
-      if (seg_num == (uint32_t)val_pcie_get_info(PCIE_INFO_SEGMENT, ecam_index))
-      {
-          if (val_pcie_function_header_type(bdf) == TYPE0_HEADER)
-          {
-              /* Return ecam_base if Type0 Header */
-              ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, ecam_index);
-              break;
-          }
-          else
-          {
-              /* Check for Secondary/Subordinate bus if Type1 Header */
-              val_pcie_read_cfg(bdf, TYPE1_PBN, &reg_value);
-              sec_bus = ((reg_value >> SECBN_SHIFT) & SECBN_MASK);
-              sub_bus = ((reg_value >> SUBBN_SHIFT) & SUBBN_MASK);
+  /* Return ecam_base if Type0 Header */
+  if (val_pcie_function_header_type(bdf) == TYPE0_HEADER)
+      return ecam_base;
 
-              if ((sec_bus >= (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, ecam_index)) &&
-                  (sub_bus <= (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, ecam_index)))
-              {
-                  ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, ecam_index);
-                  break;
-              }
-          }
-      }
+  /* Type1 Header, the Secondary to Subordinate bus range must be in one ECAM */
+  val_pcie_read_cfg(bdf, TYPE1_PBN, &reg_value);
+  sec_bus = ((reg_value >> SECBN_SHIFT) & SECBN_MASK);
+  sub_bus = ((reg_value >> SUBBN_SHIFT) & SUBBN_MASK);
 
-      ecam_index++;
-  }
+  ecam_base = val_pcie_ecam_lookup(PCIE_EXTRACT_BDF_SEG(bdf), sec_bus, &sec_index);
+  if ((ecam_base == 0) ||
+      (val_pcie_ecam_lookup(PCIE_EXTRACT_BDF_SEG(bdf), sub_bus, &ecam_index) == 0) ||
+      (sec_index != ecam_index))
+      return 0;
 
   return ecam_base;
 }
@@ -737,6 +2188,13 @@ val_pcie_bdf_table_ptr()
 void
 val_pcie_free_info_table(void)
 {
+    val_pcie_cfg_cache_print_stats();
+    val_pcie_cfg_cache_free();
+    val_pcie_hierarchy_free();
+
+    pal_pcie_set_ecam_resolver(NULL);
+    val_memory_set(&g_pcie_ecam_map, sizeof(g_pcie_ecam_map), 0);
+
     if (g_pcie_info_table != NULL) {
         pal_mem_free_aligned((void *)g_pcie_info_table);
         g_pcie_info_table = NULL;
@@ -959,6 +2417,12 @@ val_pcie_find_capability(uint32_t bdf, uint32_t cid_type, uint32_t cid, uint32_t
   uint32_t reg_value;
   uint32_t next_cap_offset;
   uint32_t ret;
+  pcie_cfg_snapshot *snap;
+
+  /* Serve the lookup from the capability index, if the BDF is cached */
+  snap = val_pcie_cfg_cache_lookup(bdf);
+  if ((snap != NULL) && (snap->index_state == PCIE_CFG_INDEX_READY))
+      return val_pcie_cfg_cache_find_cap(snap, cid_type, cid, cid_offset);
 
   if (cid_type == PCIE_CAP) {
 
@@ -1293,14 +2757,18 @@ val_pcie_disable_eru(uint32_t bdf)
 }
 
 /**
-  @brief  Returns whether a device's bit-field passed the compliance check or not.
-          The device under test is indicated by input bdf.
+  @brief  Runs the compliance check of one bit-field entry on a device and
+          records the outcome without printing, so that checks run on
+          secondary PEs can be reported later by the primary PE.
 
   @param  bdf           - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
-  @param  bitfield_entry- Expected bit-field entry configuration for the comparison
+  @param  bf_entry      - Expected bit-field entry configuration for the comparison
+  @param  record        - Outcome of the check
   @return Return 0 for success, else 1 for failure.
 **/
-uint32_t val_pcie_bitfield_check(uint32_t bdf, uint64_t *bitfield_entry)
+static uint32_t
+val_pcie_bitfield_eval(uint32_t bdf, pcie_cfgreg_bitfield_entry *bf_entry,
+                       pcie_bf_record *record)
 {
 
   uint32_t bf_value;
@@ -1314,9 +2782,7 @@ uint32_t val_pcie_bitfield_check(uint32_t bdf, uint64_t *bitfield_entry)
   uint32_t alignment_byte_cnt;
   uint32_t status = PCIE_SUCCESS;
 
-  pcie_cfgreg_bitfield_entry *bf_entry;
-
-  bf_entry = (pcie_cfgreg_bitfield_entry *)bitfield_entry;
+  record->kind = PCIE_BF_PASS;
 
   /*
    * Calculate word alignment byte count and adjust
@@ -1340,14 +2806,15 @@ uint32_t val_pcie_bitfield_check(uint32_t bdf, uint64_t *bitfield_entry)
           id = bf_entry->ecap_id;
           break;
       default:
-          val_print(ERROR, "\n       Invalid reg_type  0x%x  ", bf_entry->reg_type);
+          record->kind = PCIE_BF_BAD_TYPE;
+          record->value = bf_entry->reg_type;
           return 1;
   }
 
   if (status != PCIE_SUCCESS)
   {
-      val_print(ERROR, "\n       PCIe Capability 0x%x", id);
-      val_print(ERROR, " not found for BDF 0x%x", bdf);
+      record->kind = PCIE_BF_NO_CAP;
+      record->value = id;
       return status;
   }
 
@@ -1364,10 +2831,9 @@ uint32_t val_pcie_bitfield_check(uint32_t bdf, uint64_t *bitfield_entry)
   /* Check if bit-field value is proper */
   if (bf_value != bf_entry->cfg_value)
   {
-      val_print(ERROR, "\n       BDF 0x%x  ", bdf);
-      val_print(ERROR, bf_entry->err_str1);
-      val_print(ERROR, " 0x%x", bf_value);
-      val_print(ERROR, " instead of 0x%x", bf_entry->cfg_value);
+      record->kind = PCIE_BF_VALUE;
+      record->value = bf_value;
+      record->expected = bf_entry->cfg_value;
       if (!val_strncmp(bf_entry->err_str1, "WARNING", WARN_STR_LEN))
           return 0;
       return 1;
@@ -1415,30 +2881,392 @@ uint32_t val_pcie_bitfield_check(uint32_t bdf, uint64_t *bitfield_entry)
           val_pcie_write_cfg(bdf, cap_base + reg_offset, temp_reg_value);
           break;
       default:
-          val_print(ERROR, "\n       Invalid Attribute  0x%x  ", bf_entry->attr);
+          record->kind = PCIE_BF_BAD_ATTR;
+          record->value = bf_entry->attr;
           return 1;
   }
 
   if (reg_overwrite_value != reg_value)
   {
-      val_print(ERROR, "\n       BDF 0x%x  ", bdf);
-      val_print(ERROR, bf_entry->err_str2);
-      val_print(ERROR, " 0x%x",
-                          reg_overwrite_value >> REG_SHIFT(alignment_byte_cnt, bf_entry->start));
-      val_print(ERROR, " instead of 0x%x",
-                          reg_value >> REG_SHIFT(alignment_byte_cnt, bf_entry->start));
+      record->kind = PCIE_BF_ATTR;
+      record->value = reg_overwrite_value >> REG_SHIFT(alignment_byte_cnt, bf_entry->start);
+      record->expected = reg_value >> REG_SHIFT(alignment_byte_cnt, bf_entry->start);
       if (!val_strncmp(bf_entry->err_str2, "WARNING", WARN_STR_LEN))
           return 0;
       return 1;
   }
 
-  /* Return pass status */
-  val_print(TRACE, "\n       BDF 0x%x  PASS", bdf);
+  return 0;
+}
+
+/**
+  @brief  Prints the outcome of a bit-field check recorded by
+          val_pcie_bitfield_eval.
+
+  @param  bdf           - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @param  bf_entry      - Bit-field entry that was checked
+  @param  record        - Outcome of the check
+  @return None
+**/
+static void
+val_pcie_bitfield_report(uint32_t bdf, pcie_cfgreg_bitfield_entry *bf_entry,
+                         pcie_bf_record *record)
+{
+  switch (record->kind)
+  {
+      case PCIE_BF_BAD_TYPE:
+          val_print(ERROR, "\n       Invalid reg_type  0x%x  ", record->value);
+          break;
+      case PCIE_BF_NO_CAP:
+          val_print(ERROR, "\n       PCIe Capability 0x%x", record->value);
+          val_print(ERROR, " not found for BDF 0x%x", bdf);
+          break;
+      case PCIE_BF_VALUE:
+          val_print(ERROR, "\n       BDF 0x%x  ", bdf);
+          val_print(ERROR, bf_entry->err_str1);
+          val_print(ERROR, " 0x%x", record->value);
+          val_print(ERROR, " instead of 0x%x", record->expected);
+          break;
+      case PCIE_BF_BAD_ATTR:
+          val_print(ERROR, "\n       Invalid Attribute  0x%x  ", record->value);
+          break;
+      case PCIE_BF_ATTR:
+          val_print(ERROR, "\n       BDF 0x%x  ", bdf);
+          val_print(ERROR, bf_entry->err_str2);
+          val_print(ERROR, " 0x%x", record->value);
+          val_print(ERROR, " instead of 0x%x", record->expected);
+          break;
+      default:
+          val_print(TRACE, "\n       BDF 0x%x  PASS", bdf);
+          break;
+  }
+}
+
+/**
+  @brief  Returns whether a device's bit-field passed the compliance check or not.
+          The device under test is indicated by input bdf.
+
+  @param  bdf           - Segment/Bus/Dev/Func in the format of PCIE_CREATE_BDF
+  @param  bitfield_entry- Expected bit-field entry configuration for the comparison
+  @return Return 0 for success, else 1 for failure.
+**/
+uint32_t val_pcie_bitfield_check(uint32_t bdf, uint64_t *bitfield_entry)
+{
+  uint32_t status;
+  pcie_bf_record record;
+  pcie_cfgreg_bitfield_entry *bf_entry;
+
+  bf_entry = (pcie_cfgreg_bitfield_entry *)bitfield_entry;
+
+  status = val_pcie_bitfield_eval(bdf, bf_entry, &record);
+  val_pcie_bitfield_report(bdf, bf_entry, &record);
+
+  return status;
+}
+
+/**
+  @brief  Runs the bit-field checks of the BDF table entries assigned to a
+          work slot. Slot n checks every num_slots-th entry starting at n.
+          Failures are recorded in the slot result in table order.
+
+  @param  slot  - Work slot of the calling PE
+  @return None
+**/
+static void
+val_pcie_bitfield_run_slot(uint32_t slot)
+{
+  uint32_t bdf;
+  uint32_t dp_type;
+  uint32_t tbl_index;
+  uint32_t index;
+  uint32_t first_record;
+  pcie_bf_record record;
+  pcie_bf_slot_result *result;
+  pcie_cfgreg_bitfield_entry *bf_entry;
+
+  result = &g_pcie_bf_job.result[slot];
+  first_record = 0;
+
+  for (tbl_index = slot; tbl_index < g_pcie_bdf_table->num_entries;
+       tbl_index += g_pcie_bf_job.num_slots)
+  {
+      bdf = g_pcie_bdf_table->device[tbl_index].bdf;
+
+      /* Disable error reporting of this Function to the Upstream */
+      val_pcie_disable_eru(bdf);
+
+      /* Get the Function's device/port type from bdf */
+      dp_type = val_pcie_device_port_type(bdf);
+      result->dp_type = dp_type;
+
+      bf_entry = (pcie_cfgreg_bitfield_entry *)g_pcie_bf_job.bf_info_table;
+      for (index = 0; index < g_pcie_bf_job.num_entries; index++, bf_entry++)
+      {
+          /*
+           * Skip this entry checking, if the Function
+           * is not part of it's device/port bit mask.
+           */
+          if (!(dp_type & bf_entry->dev_port_bitmask))
+              continue;
+
+          /* Check for the compliance */
+          if (val_pcie_bitfield_eval(bdf, bf_entry, &record))
+              result->num_fails++;
+          else
+              result->num_pass++;
+
+          if (record.kind == PCIE_BF_PASS)
+              continue;
+
+          record.tbl_index = tbl_index;
+          record.bf_index = index;
+          result->record[result->num_records++] = record;
+      }
+
+      /* Records of a finished BDF stay usable if this PE stalls later */
+      if (result->num_records != first_record)
+          val_pe_cache_clean_invalidate_range((uint64_t)&result->record[first_record],
+                              (result->num_records - first_record) * sizeof(pcie_bf_record));
+      first_record = result->num_records;
+
+      result->progress++;
+      val_pe_cache_clean_invalidate_range((uint64_t)result, sizeof(pcie_bf_slot_result));
+  }
+
+  val_pe_cache_clean_invalidate_range((uint64_t)result, sizeof(pcie_bf_slot_result));
+}
+
+/**
+  @brief  Payload of the secondary PEs taking part in the bit-field checks.
+          The work slot is passed as test data.
+
+  @param  None
+  @return None
+**/
+static void
+val_pcie_bitfield_worker(void)
+{
+  uint32_t pe_index;
+  uint64_t data0;
+  uint64_t slot;
+
+  pe_index = val_pe_get_index_mpid(val_pe_get_mpid());
+  val_get_test_data(pe_index, &data0, &slot);
+
+  val_pe_cache_invalidate_range((uint64_t)&g_pcie_bf_job, sizeof(g_pcie_bf_job));
+  val_pcie_bitfield_run_slot((uint32_t)slot);
+
+  val_set_status(pe_index, RESULT_PASS);
+}
+
+/**
+  @brief  Runs the bit-field checks of all BDFs with the work split across
+          PEs, then prints the recorded failures in BDF table order so the
+          log does not depend on which PE checked which BDF. Each slot has
+          room for a record of every check of its BDFs, so no message is
+          dropped. The BDFs a timed out PE did not finish are reported and
+          counted as failures.
+
+  @param  bf_info_table - table of registers and their bit-fields for checking
+  @param  num_bitfield_entries - Number of entries
+  @param  num_slots     - Number of PEs to split the work across
+  @param  num_fails     - Number of failed checks
+  @param  num_pass      - Number of passed checks
+  @param  dp_type       - Device/port type of the last BDF checked
+  @return 0 if the checks ran, 1 if memory could not be allocated
+**/
+static uint32_t
+val_pcie_bitfield_run_parallel(uint64_t *bf_info_table, uint32_t num_bitfield_entries,
+                               uint32_t num_slots, uint32_t *num_fails, uint32_t *num_pass,
+                               uint32_t *dp_type)
+{
+  uint32_t my_index;
+  uint32_t pe_index;
+  uint32_t slot;
+  uint32_t best;
+  uint32_t timeout;
+  uint32_t pending;
+  uint32_t progress;
+  uint32_t last_progress;
+  uint32_t abandoned;
+  uint32_t tbl_index;
+  uint32_t max_records;
+  uint64_t record_stride;
+  uint32_t slot_pe[PCIE_BF_MAX_SLOTS];
+  uint32_t next[PCIE_BF_MAX_SLOTS];
+  uint32_t unchecked[PCIE_BF_MAX_SLOTS];
+  pcie_bf_record *record;
+  pcie_bf_record *records;
+  pcie_bf_slot_result *result;
+
+  /* Worst case every check of every BDF of the slot reports a message */
+  max_records = ((g_pcie_bdf_table->num_entries + num_slots - 1) / num_slots) *
+                num_bitfield_entries;
+  record_stride = ((uint64_t)max_records * sizeof(pcie_bf_record) + PCIE_BF_LINE_SIZE - 1) &
+                  ~((uint64_t)PCIE_BF_LINE_SIZE - 1);
+
+  result = pal_aligned_alloc(MEM_ALIGN_4K, num_slots * sizeof(pcie_bf_slot_result));
+  if (result == NULL)
+      return 1;
+
+  records = pal_aligned_alloc(MEM_ALIGN_4K, num_slots * record_stride);
+  if (records == NULL) {
+      pal_mem_free_aligned(result);
+      return 1;
+  }
+
+  val_memory_set(result, num_slots * sizeof(pcie_bf_slot_result), 0);
+  for (slot = 0; slot < num_slots; slot++)
+      result[slot].record = (pcie_bf_record *)((uint8_t *)records + slot * record_stride);
+
+  /* The config cache is not safe for concurrent use, bypass it meanwhile */
+  val_pcie_cfg_cache_suspend();
+
+  g_pcie_bf_job.bf_info_table = bf_info_table;
+  g_pcie_bf_job.num_entries = num_bitfield_entries;
+  g_pcie_bf_job.num_slots = num_slots;
+  g_pcie_bf_job.result = result;
+
+  val_pe_cache_clean_invalidate_range((uint64_t)&g_pcie_bf_job, sizeof(g_pcie_bf_job));
+  val_pe_cache_clean_invalidate_range((uint64_t)result,
+                                      num_slots * sizeof(pcie_bf_slot_result));
+  val_pe_cache_clean_invalidate_range((uint64_t)records, num_slots * record_stride);
+  val_pe_cache_clean_invalidate_range((uint64_t)g_pcie_bdf_table, PCIE_DEVICE_BDF_TABLE_SZ);
+
+  /* Slot 0 runs on this PE, the others on the first secondary PEs */
+  my_index = val_pe_get_index_mpid(val_pe_get_mpid());
+  slot_pe[0] = my_index;
+  for (slot = 1, pe_index = 0; slot < num_slots; pe_index++)
+  {
+      if (pe_index == my_index)
+          continue;
+
+      slot_pe[slot] = pe_index;
+      val_set_status(pe_index, RESULT_PENDING(0));
+      val_execute_on_pe_resident(pe_index, val_pcie_bitfield_worker, slot);
+      slot++;
+  }
+
+  val_pcie_bitfield_run_slot(0);
+
+  /* Wait for the other slots, as long as they make progress */
+  timeout = TIMEOUT_LARGE;
+  last_progress = 0;
+  do {
+      pending = 0;
+      progress = 0;
+      for (slot = 1; slot < num_slots; slot++)
+      {
+          if (IS_RESULT_PENDING(val_get_status(slot_pe[slot])))
+              pending++;
+
+          val_pe_cache_invalidate_range((uint64_t)&result[slot].progress,
+                                        sizeof(result[slot].progress));
+          progress += result[slot].progress;
+      }
+
+      if (progress != last_progress) {
+          last_progress = progress;
+          timeout = TIMEOUT_LARGE;
+      }
+  } while (pending && --timeout);
+
+  val_pe_cache_invalidate_range((uint64_t)result, num_slots * sizeof(pcie_bf_slot_result));
+  val_pe_cache_invalidate_range((uint64_t)records, num_slots * record_stride);
+
+  /* Run the slots of PEs that could not be started on this PE */
+  abandoned = 0;
+  val_memory_set(unchecked, sizeof(unchecked), 0);
+  for (slot = 1; slot < num_slots; slot++)
+  {
+      if (IS_TEST_PASS(val_get_status(slot_pe[slot])))
+          continue;
+
+      if (IS_RESULT_PENDING(val_get_status(slot_pe[slot]))) {
+          val_print(ERROR, "\n       PE %d timed out in bit-field checks", slot_pe[slot]);
+          val_set_status(slot_pe[slot], RESULT_FAIL(1));
+          abandoned++;
+          (*num_fails)++;
+
+          /* Keep the records of the BDFs the PE finished */
+          unchecked[slot] = slot + result[slot].progress * num_slots;
+          while (result[slot].num_records &&
+                 (result[slot].record[result[slot].num_records - 1].tbl_index >=
+                  unchecked[slot]))
+              result[slot].num_records--;
+          continue;
+      }
+
+      result[slot].num_pass = 0;
+      result[slot].num_fails = 0;
+      result[slot].num_records = 0;
+      result[slot].progress = 0;
+      val_pcie_bitfield_run_slot(slot);
+  }
+
+  val_pcie_cfg_cache_resume();
+
+  /* Merge the per slot records, each one is in table order already */
+  val_memory_set(next, sizeof(next), 0);
+  while (1)
+  {
+      best = num_slots;
+      for (slot = 0; slot < num_slots; slot++)
+      {
+          if (next[slot] >= result[slot].num_records)
+              continue;
+
+          record = &result[slot].record[next[slot]];
+          if ((best == num_slots) ||
+              (record->tbl_index < result[best].record[next[best]].tbl_index) ||
+              ((record->tbl_index == result[best].record[next[best]].tbl_index) &&
+               (record->bf_index < result[best].record[next[best]].bf_index)))
+              best = slot;
+      }
+
+      if (best == num_slots)
+          break;
+
+      record = &result[best].record[next[best]++];
+      val_pcie_bitfield_report(g_pcie_bdf_table->device[record->tbl_index].bdf,
+                               &((pcie_cfgreg_bitfield_entry *)bf_info_table)[record->bf_index],
+                               record);
+  }
+
+  for (slot = 0; slot < num_slots; slot++)
+  {
+      *num_fails += result[slot].num_fails;
+      *num_pass += result[slot].num_pass;
+
+      if (!unchecked[slot])
+          continue;
+
+      for (tbl_index = unchecked[slot]; tbl_index < g_pcie_bdf_table->num_entries;
+           tbl_index += num_slots)
+      {
+          val_print(ERROR, "\n       BDF 0x%x  not checked",
+                    g_pcie_bdf_table->device[tbl_index].bdf);
+          (*num_fails)++;
+      }
+  }
+
+  /* Device/port type of the last BDF, as reported by the serial walk */
+  if (g_pcie_bdf_table->num_entries)
+      *dp_type = result[(g_pcie_bdf_table->num_entries - 1) % num_slots].dp_type;
+
+  /* A PE that timed out may still write its result */
+  if (!abandoned) {
+      pal_mem_free_aligned(records);
+      pal_mem_free_aligned(result);
+  }
+
   return 0;
 }
 
 /**
   @brief  Returns if a PCIe config register bitfields are as per bsa specification.
+          The BDFs are split across PEs when the pcie_bf_parallel execution
+          policy is set.
 
   @param  bf_info_table - table of registers and their bit-fields for checking
   @param  num_bitfield_entries - Number of entries
@@ -1455,6 +3283,7 @@ val_pcie_register_bitfields_check(uint64_t *bf_info_table, uint32_t num_bitfield
   uint32_t tbl_index;
   uint32_t num_fails;
   uint32_t num_pass;
+  uint32_t num_slots;
   uint32_t index;
   pcie_cfgreg_bitfield_entry *bf_entry;
 
@@ -1463,6 +3292,20 @@ val_pcie_register_bitfields_check(uint64_t *bf_info_table, uint32_t num_bitfield
   val_print(TRACE, "\n       Number of bit-field entries to check %d",
             num_bitfield_entries);
 
+  num_slots = 1;
+  if (acs_policy_get_pcie_bf_parallel()) {
+      num_slots = val_pe_get_num();
+      if (num_slots > PCIE_BF_MAX_SLOTS)
+          num_slots = PCIE_BF_MAX_SLOTS;
+      if (num_slots > g_pcie_bdf_table->num_entries)
+          num_slots = g_pcie_bdf_table->num_entries;
+  }
+
+  if ((num_slots > 1) &&
+      !val_pcie_bitfield_run_parallel(bf_info_table, num_bitfield_entries, num_slots,
+                                      &num_fails, &num_pass, &dp_type))
+      tbl_index = g_pcie_bdf_table->num_entries;
+
   while (tbl_index < g_pcie_bdf_table->num_entries)
   {
       bdf = g_pcie_bdf_table->device[tbl_index++].bdf;
@@ -1636,11 +3479,24 @@ val_pcie_get_downstream_function(uint32_t bdf, uint32_t *dsf_bdf)
   uint32_t reg_value;
   uint32_t type1_bdf;
   uint32_t type1_flag;
+  uint32_t node;
 
   type1_bdf = 0;
   *dsf_bdf = 0;
   type1_flag = 0;
 
+  /* The hierarchy index holds the first downstream function of every bridge */
+  if (val_pcie_hierarchy_ready()) {
+      node = val_pcie_hierarchy_find_node(bdf);
+      if ((node != PCIE_HIER_NONE) && (g_pcie_hier[node].hdr_type == TYPE1_HEADER)) {
+          if (g_pcie_hier[node].dsf == PCIE_HIER_NONE)
+              return 1;
+
+          *dsf_bdf = g_pcie_hier[g_pcie_hier[node].dsf].bdf;
+          return 0;
+      }
+  }
+
   /*
    * Read four bytes of config space starting from Primary Bus num
    * register and extract the Secondary and Subordinate Bus numbers
@@ -1708,10 +3564,20 @@ val_pcie_get_rootport(uint32_t bdf, uint32_t *rp_bdf)
   uint32_t seg_num;
   uint32_t reg_value;
   uint32_t dp_type;
+  uint32_t node;
+  uint32_t indexed;
 
   index = 0;
+  node = PCIE_HIER_NONE;
+  indexed = val_pcie_hierarchy_ready();
 
-  dp_type = val_pcie_device_port_type(bdf);
+  if (indexed)
+      node = val_pcie_hierarchy_find_node(bdf);
+
+  if (node != PCIE_HIER_NONE)
+      dp_type = g_pcie_hier[node].dp_type;
+  else
+      dp_type = val_pcie_device_port_type(bdf);
 
   val_print(TRACE, " type 0x%02x", dp_type);
 
@@ -1729,7 +3595,20 @@ val_pcie_get_rootport(uint32_t bdf, uint32_t *rp_bdf)
       return 1;
   }
 
-  while (index < g_pcie_bdf_table->num_entries)
+  /* Root Port bus ranges are indexed, no need to scan the BDF table */
+  if (indexed) {
+      if (node == PCIE_HIER_NONE)
+          node = val_pcie_hierarchy_find_rp(PCIE_EXTRACT_BDF_SEG(bdf), PCIE_EXTRACT_BDF_BUS(bdf));
+      else
+          node = g_pcie_hier[node].rootport;
+
+      if (node != PCIE_HIER_NONE) {
+          *rp_bdf = g_pcie_hier[node].bdf;
+          return 0;
+      }
+  }
+
+  while (!indexed && (index < g_pcie_bdf_table->num_entries))
   {
       *rp_bdf = g_pcie_bdf_table->device[index++].bdf;
 
@@ -1825,43 +3704,29 @@ val_pcie_get_ecam_index(uint32_t bdf, uint32_t *ecam_index)
 
   uint8_t sec_bus;
   uint8_t sub_bus;
-  uint16_t seg_num;
   uint32_t reg_value;
-  uint32_t bus_num;
-  uint32_t index = 0;
+  uint32_t index;
 
-  seg_num = PCIE_EXTRACT_BDF_SEG(bdf);
-  bus_num = PCIE_EXTRACT_BDF_BUS(bdf);
+  if (val_pcie_ecam_lookup(PCIE_EXTRACT_BDF_SEG(bdf), PCIE_EXTRACT_BDF_BUS(bdf), &index) == 0)
+      return 1;
 
-  while (index < (uint32_t)val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0))
+  if (val_pcie_function_header_type(bdf) == TYPE0_HEADER)
   {
-      if (seg_num == (uint32_t)val_pcie_get_info(PCIE_INFO_SEGMENT, index) &&
-         (bus_num >= (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, index)) &&
-         (bus_num <= (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, index)))
-      {
-          if (val_pcie_function_header_type(bdf) == TYPE0_HEADER)
-          {
-              /* Return ecam index if Type0 Header */
-              *ecam_index = index;
-              return 0;
-          }
-          else
-          {
-              /* Check for Secondary/Subordinate bus if Type1 Header */
-              val_pcie_read_cfg(bdf, TYPE1_PBN, &reg_value);
-              sec_bus = ((reg_value >> SECBN_SHIFT) & SECBN_MASK);
-              sub_bus = ((reg_value >> SUBBN_SHIFT) & SUBBN_MASK);
+      /* Return ecam index if Type0 Header */
+      *ecam_index = index;
+      return 0;
+  }
 
-              if ((sec_bus >= (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, index)) &&
-                  (sub_bus <= (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, index)))
-              {
-                    *ecam_index = index;
-                    return 0;
-              }
-          }
-      }
+  /* Check for Secondary/Subordinate bus if Type1 Header */
+  val_pcie_read_cfg(bdf, TYPE1_PBN, &reg_value);
+  sec_bus = ((reg_value >> SECBN_SHIFT) & SECBN_MASK);
+  sub_bus = ((reg_value >> SUBBN_SHIFT) & SUBBN_MASK);
 
-      index++;
+  if ((sec_bus >= (uint32_t)val_pcie_get_info(PCIE_INFO_START_BUS, index)) &&
+      (sub_bus <= (uint32_t)val_pcie_get_info(PCIE_INFO_END_BUS, index)))
+  {
+      *ecam_index = index;
+      return 0;
   }
 
   return 1;
@@ -2313,12 +4178,27 @@ val_pcie_parent_is_rootport(uint32_t dsf_bdf, uint32_t *rp_bdf)
   uint32_t dp_type;
   uint32_t tbl_index;
   uint32_t reg_value;
+  uint32_t node;
   pcie_device_bdf_table *bdf_tbl_ptr;
 
   tbl_index = 0;
   dsf_bus = PCIE_EXTRACT_BDF_BUS(dsf_bdf);
   bdf_tbl_ptr = val_pcie_bdf_table_ptr();
 
+  /* Parent bridge is found through the hierarchy index when present */
+  if (val_pcie_hierarchy_ready()) {
+      node = val_pcie_hierarchy_find_bridge(PCIE_EXTRACT_BDF_SEG(dsf_bdf), dsf_bus);
+      if ((node == PCIE_HIER_NONE) || (g_pcie_hier[node].sub_bus < dsf_bus))
+          return 1;
+
+      dp_type = g_pcie_hier[node].dp_type;
+      if ((dp_type != RP) && (dp_type != iEP_RP))
+          return 1;
+
+      *rp_bdf = g_pcie_hier[node].bdf;
+      return 0;
+  }
+
   while (tbl_index < bdf_tbl_ptr->num_entries)
   {
       bdf = bdf_tbl_ptr->device[tbl_index++].bdf;
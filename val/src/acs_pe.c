@@ -689,6 +689,12 @@ uint32_t val_pe_feat_check(PE_FEAT_NAME pe_feature)
             return ACS_STATUS_PASS;
         else
             return ACS_STATUS_FAIL;
+    case PE_FEAT_ADVSIMD:
+        /*  ID_AA64PFR0_EL1 AdvSIMD bits [23:20] == 1111 indicate AdvSIMD not implemented */
+        if ((VAL_EXTRACT_BITS(val_pe_reg_read(ID_AA64PFR0_EL1), 20, 23)) != 0xF)
+            return ACS_STATUS_PASS;
+        else
+            return ACS_STATUS_FAIL;
     default:
         val_print(ERROR, "\nPE_FEAT_CHECK: Invalid PE feature");
         return ACS_STATUS_FAIL;
@@ -22,6 +22,8 @@
 #include "acs_exception.h"
 #include "val_interface.h"
 #include "pal_interface.h"
+#include "acs_memory.h"
+#include "acs_pe_index.h"
 
 PE_SMBIOS_PROCESSOR_INFO_TABLE *g_smbios_info_table;
 int32_t gPsciConduit;
@@ -41,6 +43,146 @@ ARM_SMC_ARGS g_smc_args;
 /* global variable to store primary PE index */
 uint32_t g_primary_pe_index = 0;
 
+/* MPIDR to PE index hash table, open addressing with linear probing. Built once
+   the PE info table exists and read-only afterwards. */
+typedef struct {
+  uint64_t mpidr;
+  uint32_t pe_num;
+  uint32_t valid;
+} PE_MPIDR_HASH_ENTRY;
+
+static PE_MPIDR_HASH_ENTRY *g_pe_mpidr_hash;
+static uint32_t g_pe_mpidr_hash_mask;
+
+#ifndef TARGET_LINUX
+/* TPIDR_ELx of the primary PE before ACS took it over */
+static uint64_t g_primary_tpidr;
+
+static uint64_t
+val_pe_index_cache_read(void)
+{
+  if (read_CurrentEL() == AARCH64_EL2)
+      return read_tpidr_el2();
+  return read_tpidr_el1();
+}
+
+static void
+val_pe_index_cache_write(uint64_t value)
+{
+  if (read_CurrentEL() == AARCH64_EL2)
+      write_tpidr_el2(value);
+  else
+      write_tpidr_el1(value);
+}
+#endif
+
+static uint32_t
+val_pe_mpidr_hash(uint64_t mpid)
+{
+  uint32_t hash = (uint32_t)(mpid ^ (mpid >> 32)) * 0x9E3779B1u;
+
+  return hash ^ (hash >> 16);
+}
+
+/**
+  @brief   Builds the MPIDR to PE index hash table from g_pe_info_table.
+           Lookups fall back to a linear scan if the allocation fails.
+  @param   None
+  @return  None
+**/
+static void
+val_pe_build_mpidr_hash(void)
+{
+  PE_INFO_ENTRY *entry = g_pe_info_table->pe_info;
+  uint32_t num_pe = g_pe_info_table->header.num_of_pe;
+  uint32_t size = 1;
+  uint32_t slot;
+  uint32_t i;
+
+  /* Keep the load factor at or below one half */
+  while (size < 2 * num_pe)
+      size <<= 1;
+
+  g_pe_mpidr_hash = val_memory_calloc(size, sizeof(PE_MPIDR_HASH_ENTRY));
+  if (g_pe_mpidr_hash == NULL) {
+      val_print(WARN, " PE_INFO: MPIDR hash table allocation failed\n");
+      return;
+  }
+  g_pe_mpidr_hash_mask = size - 1;
+
+  for (i = 0; i < num_pe; i++) {
+      slot = val_pe_mpidr_hash(entry[i].mpidr) & g_pe_mpidr_hash_mask;
+      while (g_pe_mpidr_hash[slot].valid)
+          slot = (slot + 1) & g_pe_mpidr_hash_mask;
+
+      g_pe_mpidr_hash[slot].mpidr = entry[i].mpidr;
+      g_pe_mpidr_hash[slot].pe_num = entry[i].pe_num;
+      g_pe_mpidr_hash[slot].valid = 1;
+  }
+
+  /* Secondary PEs read the table without further cache maintenance */
+  val_pe_cache_clean_invalidate_range((uint64_t)g_pe_mpidr_hash,
+                                      size * sizeof(PE_MPIDR_HASH_ENTRY));
+  val_data_cache_ops_by_va((addr_t)&g_pe_mpidr_hash, CLEAN_AND_INVALIDATE);
+  val_data_cache_ops_by_va((addr_t)&g_pe_mpidr_hash_mask, CLEAN_AND_INVALIDATE);
+}
+
+/**
+  @brief   Looks up the PE index of an MPIDR without using the TPIDR_ELx cache
+  @param   mpid - the mpidr value of the PE
+  @return  Index of PE, 0 if the MPIDR is not in the PE info table
+**/
+static uint32_t
+val_pe_lookup_index_mpid(uint64_t mpid)
+{
+  PE_INFO_ENTRY *entry;
+  uint32_t i;
+  uint32_t slot;
+
+  if (g_pe_mpidr_hash != NULL) {
+      slot = val_pe_mpidr_hash(mpid) & g_pe_mpidr_hash_mask;
+      while (g_pe_mpidr_hash[slot].valid) {
+          if (g_pe_mpidr_hash[slot].mpidr == mpid)
+              return g_pe_mpidr_hash[slot].pe_num;
+          slot = (slot + 1) & g_pe_mpidr_hash_mask;
+      }
+      return 0x0;  //Return index 0 as a safe failsafe value
+  }
+
+  i = g_pe_info_table->header.num_of_pe;
+  entry = g_pe_info_table->pe_info;
+
+  while (i > 0) {
+    val_data_cache_ops_by_va((addr_t)&entry->mpidr, INVALIDATE);
+    val_data_cache_ops_by_va((addr_t)&entry->pe_num, INVALIDATE);
+
+    if (entry->mpidr == mpid) {
+      return entry->pe_num;
+    }
+    entry++;
+    i--;
+  }
+
+  return 0x0;  //Return index 0 as a safe failsafe value
+}
+
+/**
+  @brief   Caches the index of the current PE in TPIDR_ELx so that
+           val_pe_get_index_mpid() on the own MPIDR is a register read.
+  @param   None
+  @return  Index of the current PE
+**/
+static uint32_t
+val_pe_cache_own_index(void)
+{
+  uint32_t index = val_pe_lookup_index_mpid(val_pe_get_mpid());
+
+#ifndef TARGET_LINUX
+  val_pe_index_cache_write(PE_INDEX_TPIDR_TAG | index);
+#endif
+  return index;
+}
+
 /**
   @brief   This API will call PAL layer to fill in the PE information
            into the g_pe_info_table pointer.
@@ -80,6 +222,7 @@ val_pe_create_info_table(uint64_t *pe_info_table)
 
   pal_pe_create_info_table(g_pe_info_table);
   val_data_cache_ops_by_va((addr_t)&g_pe_info_table, CLEAN_AND_INVALIDATE);
+  val_pe_build_mpidr_hash();
 
   val_print(INFO, " PE_INFO: Number of PE detected       : %4d\n", val_pe_get_num());
 
@@ -95,10 +238,16 @@ val_print(INFO, " Primary PE: MIDR_EL1                 :    0x%llx \n",
 
   /* store primary PE index for debug message printing purposes on
      multi PE tests */
-  g_primary_pe_index = val_pe_get_index_mpid(val_pe_get_mpid());
+#ifndef TARGET_LINUX
+  g_primary_tpidr = val_pe_index_cache_read();
+#endif
+  g_primary_pe_index = val_pe_cache_own_index();
   val_print(DEBUG, " PE_INFO: Primary PE index       : %4d\n",
             g_primary_pe_index);
 
+  /* Per-PE binary log buffers need the PE count and the primary PE index */
+  val_log_init(val_pe_get_num());
+
   return ACS_STATUS_PASS;
 }
 
@@ -113,6 +262,16 @@ void
 val_pe_free_info_table(void)
 {
     if (g_pe_info_table != NULL) {
+        /* Parked workers must be off before the shared region goes away */
+        val_pe_worker_pool_stop();
+        val_log_free();
+        if (g_pe_mpidr_hash != NULL) {
+            val_memory_free(g_pe_mpidr_hash);
+            g_pe_mpidr_hash = NULL;
+        }
+#ifndef TARGET_LINUX
+        val_pe_index_cache_write(g_primary_tpidr);
+#endif
         pal_mem_free_aligned((void *)g_pe_info_table);
         g_pe_info_table = NULL;
     }
@@ -197,30 +356,285 @@ val_pe_get_mpid_index(uint32_t index)
 uint32_t
 val_pe_get_index_mpid(uint64_t mpid)
 {
+#ifndef TARGET_LINUX
+  uint64_t cached = val_pe_index_cache_read();
 
-  PE_INFO_ENTRY *entry;
-  uint32_t i = g_pe_info_table->header.num_of_pe;
+  /* The own index is cached in TPIDR_ELx at PE entry */
+  if (((cached & PE_INDEX_TPIDR_TAG_MASK) == PE_INDEX_TPIDR_TAG) && (mpid == val_pe_get_mpid()))
+      return PE_INDEX_TPIDR_INDEX(cached);
+#endif
 
-  entry = g_pe_info_table->pe_info;
+  return val_pe_lookup_index_mpid(mpid);
+}
 
-  while (i > 0) {
-    val_data_cache_ops_by_va((addr_t)&entry->mpidr, INVALIDATE);
-    val_data_cache_ops_by_va((addr_t)&entry->pe_num, INVALIDATE);
 
-    if (entry->mpidr == mpid) {
-      return entry->pe_num;
-    }
-    entry++;
-    i--;
+#ifndef TARGET_LINUX
+/**
+  @brief   Returns the resident worker mailbox of a PE
+  @param   index - PE index
+  @return  Mailbox address in the shared region
+**/
+static volatile VAL_PE_MAILBOX_t *
+val_pe_mailbox(uint32_t index)
+{
+  return (volatile VAL_PE_MAILBOX_t *)(val_get_mailbox_region_base() +
+                                       (uintptr_t)index * 2 * val_get_shared_line_size());
+}
+
+/**
+  @brief   Returns the reply line of the resident worker mailbox of a PE
+  @param   index - PE index
+  @return  Reply line address, one shared line after the mailbox
+**/
+static volatile VAL_PE_MAILBOX_REPLY_t *
+val_pe_mailbox_reply(uint32_t index)
+{
+  return (volatile VAL_PE_MAILBOX_REPLY_t *)((uintptr_t)val_pe_mailbox(index) +
+                                             val_get_shared_line_size());
+}
+
+/**
+  @brief   Resident worker loop of a secondary PE. Waits in WFE for the primary
+           PE to bump the mailbox sequence number, then runs the payload stored
+           with val_set_test_data. Returns when the primary PE posts PE_WORKER_EXIT.
+  @param   index - Index of the current PE
+  @return  None
+**/
+static void
+val_pe_worker_park(uint32_t index)
+{
+  volatile VAL_PE_MAILBOX_t *mailbox = val_pe_mailbox(index);
+  volatile VAL_PE_MAILBOX_REPLY_t *reply = val_pe_mailbox_reply(index);
+  void (*vector)(uint64_t args);
+  uint64_t test_arg;
+
+  val_data_cache_ops_by_va((addr_t)&mailbox->seq, INVALIDATE);
+  reply->ack = mailbox->seq;
+  reply->state = PE_WORKER_PARKED;
+  val_data_cache_ops_by_va((addr_t)&reply->state, CLEAN_AND_INVALIDATE);
+
+  while (1) {
+      val_data_cache_ops_by_va((addr_t)&mailbox->seq, INVALIDATE);
+      if (mailbox->seq == reply->ack) {
+          /* An SEV sent after the check above leaves the event register set */
+          wfe();
+          continue;
+      }
+
+      /* Read the command only after the new sequence number */
+      dmbish();
+      reply->ack = mailbox->seq;
+      if (mailbox->cmd == PE_WORKER_EXIT) {
+          reply->state = PE_WORKER_OFF;
+          val_data_cache_ops_by_va((addr_t)&reply->state, CLEAN_AND_INVALIDATE);
+          return;
+      }
+
+      reply->state = PE_WORKER_BUSY;
+      val_data_cache_ops_by_va((addr_t)&reply->state, CLEAN_AND_INVALIDATE);
+
+      val_get_test_data(index, (uint64_t *)&vector, &test_arg);
+      vector(test_arg);
+
+      reply->state = PE_WORKER_PARKED;
+      val_data_cache_ops_by_va((addr_t)&reply->state, CLEAN_AND_INVALIDATE);
   }
+}
 
-  return 0x0;  //Return index 0 as a safe failsafe value
+/**
+  @brief   Posts a command to a parked resident worker and wakes it with SEV.
+           A worker still running its previous payload is given timeout
+           polls to park again.
+  @param   index      - Index of the PE
+  @param   cmd        - PE_WORKER_RUN or PE_WORKER_EXIT
+  @param   payload    - Payload for PE_WORKER_RUN
+  @param   test_input - Argument of the payload
+  @param   timeout    - Number of polls to wait for the worker to park
+  @return  ACS_STATUS_PASS if the command was posted, ACS_STATUS_SKIP if the
+           PE is not a resident worker, ACS_STATUS_FAIL if the worker did not
+           park in time.
+**/
+static uint32_t
+val_pe_worker_post(uint32_t index, uint32_t cmd, void (*payload)(void), uint64_t test_input,
+                   uint32_t timeout)
+{
+  volatile VAL_PE_MAILBOX_t *mailbox;
+  volatile VAL_PE_MAILBOX_REPLY_t *reply;
+  uint32_t parked;
+
+  if (index >= val_pe_get_num())
+      return ACS_STATUS_SKIP;
+
+  mailbox = val_pe_mailbox(index);
+  reply = val_pe_mailbox_reply(index);
+  do {
+      val_data_cache_ops_by_va((addr_t)&reply->ack, INVALIDATE);
+      parked = (reply->state == PE_WORKER_PARKED) && (reply->ack == mailbox->seq);
+      if (parked)
+          break;
+      if (reply->state == PE_WORKER_OFF)
+          return ACS_STATUS_SKIP;
+  } while (--timeout);
+
+  if (!parked)
+      return ACS_STATUS_FAIL;
+
+  if (cmd == PE_WORKER_RUN)
+      val_set_test_data(index, (uint64_t)payload, test_input);
+
+  mailbox->cmd = cmd;
+  dsbsy();
+  mailbox->seq = mailbox->seq + 1;
+  val_data_cache_ops_by_va((addr_t)&mailbox->seq, CLEAN_AND_INVALIDATE);
+  dsbsy();
+  sev();
+
+  return ACS_STATUS_PASS;
 }
 
+/**
+  @brief   Asks a parked resident worker to leave its loop and waits until it
+           is about to switch itself off with PSCI_CPU_OFF.
+  @param   index   - Index of the PE
+  @param   timeout - Number of polls to wait for a busy worker to park
+  @return  ACS_STATUS_PASS once the PE is not a worker, ACS_STATUS_FAIL if the
+           worker did not park or leave in time.
+**/
+static uint32_t
+val_pe_worker_exit(uint32_t index, uint32_t timeout)
+{
+  volatile VAL_PE_MAILBOX_REPLY_t *reply;
+  uint32_t wait = TIMEOUT_LARGE;
+  uint32_t status;
+
+  status = val_pe_worker_post(index, PE_WORKER_EXIT, NULL, 0, timeout);
+  if (status != ACS_STATUS_PASS)
+      return (status == ACS_STATUS_SKIP) ? ACS_STATUS_PASS : ACS_STATUS_FAIL;
+
+  reply = val_pe_mailbox_reply(index);
+  do {
+      val_data_cache_ops_by_va((addr_t)&reply->state, INVALIDATE);
+  } while ((reply->state != PE_WORKER_OFF) && --wait);
+
+  return (reply->state == PE_WORKER_OFF) ? ACS_STATUS_PASS : ACS_STATUS_FAIL;
+}
+
+/**
+  @brief   Records that a PE stopped answering, a resident worker or a payload
+           that did not finish. The PE is still on, so PSCI_CPU_ON cannot take
+           it back, and no further payload is sent to it.
+           1. Caller       -  VAL
+           2. Prerequisite -  val_allocate_shared_mem
+  @param   index - Index of the PE
+  @return  None
+**/
+void
+val_pe_mark_lost(uint32_t index)
+{
+  volatile VAL_PE_MAILBOX_t *mailbox;
+
+  if (index >= val_pe_get_num())
+      return;
+
+  mailbox = val_pe_mailbox(index);
+  if (mailbox->lost)
+      return;
+
+  mailbox->lost = 1;
+  val_data_cache_ops_by_va((addr_t)&mailbox->lost, CLEAN_AND_INVALIDATE);
+  val_print(ERROR, "\n       PE index %d is not responding, "
+                   "it is not used for further tests", index);
+}
+
+/**
+  @brief   Retires the resident worker of a PE so that it can be powered on with
+           PSCI again. A worker that does not leave its loop is marked lost.
+  @param   index   - Index of the PE
+  @param   timeout - Number of polls to wait for a busy worker to park
+  @return  ACS_STATUS_PASS if the PE is off or about to switch off,
+           ACS_STATUS_FAIL if the PE is lost.
+**/
+static uint32_t
+val_pe_worker_retire(uint32_t index, uint32_t timeout)
+{
+  if (!acs_policy_get_pe_resident() || (index >= val_pe_get_num()))
+      return ACS_STATUS_PASS;
+
+  if (val_pe_mailbox(index)->lost)
+      return ACS_STATUS_FAIL;
+
+  if (val_pe_worker_exit(index, timeout) != ACS_STATUS_PASS) {
+      val_pe_mark_lost(index);
+      return ACS_STATUS_FAIL;
+  }
+
+  return ACS_STATUS_PASS;
+}
+
+/**
+  @brief   Switches off every parked resident worker. Workers still running a
+           payload are left alone.
+           1. Caller       -  VAL, Application layer
+           2. Prerequisite -  val_allocate_shared_mem
+  @param   None
+  @return  None
+**/
+void
+val_pe_worker_pool_stop(void)
+{
+  uint32_t my_index;
+  uint32_t i;
+
+  if (!acs_policy_get_pe_resident() || (g_pe_info_table == NULL))
+      return;
+
+  my_index = val_pe_get_index_mpid(val_pe_get_mpid());
+  for (i = 0; i < val_pe_get_num(); i++) {
+      if ((i != my_index) && (val_pe_worker_exit(i, 1) != ACS_STATUS_PASS))
+          val_print(WARN, "\n       Resident PE index %d did not leave its mailbox", i);
+  }
+}
+
+/**
+  @brief   Tells whether payloads can still be sent to a PE. A PE marked with
+           val_pe_mark_lost() is unusable for the rest of the run.
+  @param   index - Index of the PE
+  @return  1 if the PE can run payloads, 0 otherwise
+**/
+uint32_t
+val_pe_usable(uint32_t index)
+{
+  if (index >= val_pe_get_num())
+      return 1;
+
+  val_data_cache_ops_by_va((addr_t)&val_pe_mailbox(index)->lost, INVALIDATE);
+  return !val_pe_mailbox(index)->lost;
+}
+#else
+void
+val_pe_worker_pool_stop(void)
+{
+}
+
+void
+val_pe_mark_lost(uint32_t index)
+{
+  (void)index;
+}
+
+uint32_t
+val_pe_usable(uint32_t index)
+{
+  (void)index;
+  return 1;
+}
+#endif
 
 /**
   @brief   'C' Entry point for Secondary PE.
-           Uses PSCI_CPU_OFF to switch off PE after payload execution.
+           Uses PSCI_CPU_OFF to switch off PE after payload execution. With
+           the resident worker policy the PE first parks on its mailbox and
+           runs further payloads until it is retired.
            1. Caller       -  PAL code
            2. Prerequisite -  Stack pointer for this PE is setup by PAL
                               MMU/caches enabled by ModuleEntryPoint
@@ -234,10 +648,20 @@ val_test_entry(void)
   uint64_t test_arg;
   ARM_SMC_ARGS smc_args;
   void (*vector)(uint64_t args);
+  uint32_t index = val_pe_cache_own_index();
 
-  val_get_test_data(val_pe_get_index_mpid(val_pe_get_mpid()), (uint64_t *)&vector, &test_arg);
+  val_get_test_data(index, (uint64_t *)&vector, &test_arg);
   vector(test_arg);
 
+#ifndef TARGET_LINUX
+  /* PEs woken through val_execute_on_pe() find PE_WORKER_EXIT here */
+  if (acs_policy_get_pe_resident()) {
+      val_data_cache_ops_by_va((addr_t)&val_pe_mailbox(index)->cmd, INVALIDATE);
+      if (val_pe_mailbox(index)->cmd == PE_WORKER_RUN)
+          val_pe_worker_park(index);
+  }
+#endif
+
   // We have completed our TEST code. So, switch off the PE now
   smc_args.Arg0 = ARM_SMC_ID_PSCI_CPU_OFF;
   smc_args.Arg1 = val_pe_get_mpid();
@@ -246,17 +670,16 @@ val_test_entry(void)
 
 
 /**
-  @brief   This API initiates the execution of a test on a secondary PE.
-           Uses PSCI_CPU_ON to wake a secondary PE
-           1. Caller       -  Test Suite
-           2. Prerequisite -  val_create_peinfo_table
-  @param   index - Index of the PE to be woken up
-  @param   payload - Function pointer of the test to be executed on the PE
+  @brief   Wakes a secondary PE with PSCI_CPU_ON and runs the payload on it.
+  @param   index      - Index of the PE to be woken up
+  @param   payload    - Function pointer of the test to be executed on the PE
   @param   test_input - arguments to be passed to the test.
+  @param   resident   - Park the PE as a resident worker after the payload
   @return  None
 **/
-void
-val_execute_on_pe(uint32_t index, void (*payload)(void), uint64_t test_input)
+static void
+val_pe_power_on_execute(uint32_t index, void (*payload)(void), uint64_t test_input,
+                        uint32_t resident)
 {
 
   int timeout = TIMEOUT_LARGE;
@@ -266,6 +689,22 @@ val_execute_on_pe(uint32_t index, void (*payload)(void), uint64_t test_input)
       return;
   }
 
+#ifndef TARGET_LINUX
+  if (!val_pe_usable(index)) {
+      val_print(WARN, "\n       WARNING: Skipping test for PE index %d "
+                              "since it is not responding\n", index);
+      val_set_status(index, RESULT_SKIP(0x120 - (int)ARM_SMC_PSCI_RET_ALREADY_ON));
+      return;
+  }
+
+  if (acs_policy_get_pe_resident() && (index < val_pe_get_num())) {
+      val_pe_mailbox(index)->cmd = resident ? PE_WORKER_RUN : PE_WORKER_EXIT;
+      val_data_cache_ops_by_va((addr_t)&val_pe_mailbox(index)->cmd, CLEAN_AND_INVALIDATE);
+  }
+#else
+  (void)resident;
+#endif
+
   do {
       g_smc_args.Arg0 = ARM_SMC_ID_PSCI_CPU_ON_AARCH64;
 
@@ -298,6 +737,78 @@ val_execute_on_pe(uint32_t index, void (*payload)(void), uint64_t test_input)
   val_set_status(index, RESULT_FAIL(0x120 - (int)g_smc_args.Arg0));
 }
 
+/**
+  @brief   This API initiates the execution of a test on a secondary PE.
+           Uses PSCI_CPU_ON to wake a secondary PE, which switches itself off
+           with PSCI_CPU_OFF after the payload. A resident worker parked on the
+           PE is retired first.
+           1. Caller       -  Test Suite
+           2. Prerequisite -  val_create_peinfo_table
+  @param   index - Index of the PE to be woken up
+  @param   payload - Function pointer of the test to be executed on the PE
+  @param   test_input - arguments to be passed to the test.
+  @return  None
+**/
+void
+val_execute_on_pe(uint32_t index, void (*payload)(void), uint64_t test_input)
+{
+  val_pe_profile_dispatch(index);
+
+#ifndef TARGET_LINUX
+  /* A PE still held by a worker would only answer PSCI_CPU_ON with ALREADY_ON */
+  if (val_pe_worker_retire(index, TIMEOUT_LARGE) != ACS_STATUS_PASS) {
+      val_print(WARN, "\n       WARNING: Skipping test for PE index %d "
+                              "since it is not responding\n", index);
+      val_set_status(index, RESULT_SKIP(0x120 - (int)ARM_SMC_PSCI_RET_ALREADY_ON));
+      return;
+  }
+#endif
+
+  val_pe_power_on_execute(index, payload, test_input, 0);
+}
+
+/**
+  @brief   Runs a payload on a secondary PE that stays on afterwards as a
+           resident worker, when the resident worker policy is enabled. The PE
+           keeps the system register, vector, timer and GIC CPU interface state
+           the previous payload left, so only payloads that leave that state as
+           they found it may use this; tests use val_execute_on_pe.
+           A worker that is busy or hung is not powered on again with PSCI:
+           the PE is marked unusable and the payload is skipped on it.
+           1. Caller       -  VAL, Test Suite
+           2. Prerequisite -  val_create_peinfo_table
+  @param   index - Index of the PE to be woken up
+  @param   payload - Function pointer of the payload to be executed on the PE
+  @param   test_input - arguments to be passed to the payload.
+  @return  None
+**/
+void
+val_execute_on_pe_resident(uint32_t index, void (*payload)(void), uint64_t test_input)
+{
+#ifndef TARGET_LINUX
+  uint32_t status;
+
+  if (acs_policy_get_pe_resident() && val_pe_usable(index)) {
+      status = val_pe_worker_post(index, PE_WORKER_RUN, payload, test_input, TIMEOUT_LARGE);
+      if (status == ACS_STATUS_PASS) {
+          val_pe_profile_dispatch(index);
+          return;
+      }
+
+      if (status == ACS_STATUS_FAIL)
+          val_pe_mark_lost(index);
+  }
+
+  if (acs_policy_get_pe_resident()) {
+      val_pe_profile_dispatch(index);
+      val_pe_power_on_execute(index, payload, test_input, 1);
+      return;
+  }
+#endif
+
+  val_execute_on_pe(index, payload, test_input);
+}
+
 /**
   @brief   This API installs the Exception handler pointed
            by the function pointer to the input exception type.
@@ -482,6 +993,25 @@ val_pe_cache_invalidate_range(uint64_t start_addr, uint64_t length)
 #endif
 }
 
+/**
+  @brief  Return the cache writeback granule from CTR_EL0.CWG. A buffer written by
+          another PE or by a device must fill whole granules, otherwise a write back
+          of a neighbouring variable can overwrite it.
+
+  @return Granule size in bytes
+**/
+uint32_t
+val_pe_cache_writeback_granule(void)
+{
+  uint32_t cwg = (val_pe_reg_read(CTR_EL0) >> 24) & 0xf;
+
+  /* A CWG of 0 means the granule is not reported, use the architectural maximum */
+  if (cwg == 0)
+      return 2048;
+
+  return 4u << cwg;
+}
+
 
 /**
   @brief   This API returns the index of primary PE on which system is booted.
@@ -22,9 +22,43 @@
 #include "pal_interface.h"
 #include "val_interface.h"
 #include "val_status.h"
+#include "acs_pcie.h"
+#include "acs_memory.h"
+#ifndef TARGET_LINUX
+#include "val_sysreg_timer.h"
+#endif
 
 uint32_t g_override_skip;
+uint64_t g_psci_call_count;
+uint64_t g_pe_dispatch_count;
+
+/* Per-PE profile counters, one shared line per PE. Each PE counts its own
+   MMIO accesses, the primary PE marks the PEs it dispatches to. */
+typedef struct {
+    uint64_t mmio_accesses;
+    uint64_t dispatch_mark;   /* g_pe_dispatch_count after the last dispatch to the PE */
+    uint8_t  reserved[VAL_SHARED_LINE_SIZE - 16];
+} val_pe_profile_t;
+
+static val_pe_profile_t *g_pe_profile;
 static acs_test_status_counters_t g_rule_test_stats;
+
+/* val_wait_for_test_completion(): overall timeout, rate of secondary log drains,
+   counter frequency assumed if CNTFRQ is not programmed. Platforms whose payloads
+   run longer raise the timeout with cmake -DACS_WAIT_TIMEOUT_MS=<ms>. */
+#ifdef ACS_WAIT_TIMEOUT_MS
+#define VAL_WAIT_TIMEOUT_MS     ACS_WAIT_TIMEOUT_MS
+#else
+#define VAL_WAIT_TIMEOUT_MS     30000
+#endif
+#define VAL_WAIT_DRAIN_HZ       1000
+#define VAL_WAIT_DEFAULT_FREQ   1000000000ULL
+
+/* Timer event stream used to bound WFE: EVNTEN set, EVNTDIR clear, event
+   every 2^(VAL_WAIT_EVNTI + 1) counter ticks */
+#define VAL_WAIT_EVNTI          10
+#define VAL_WAIT_EVNT_MASK      0xFCULL
+#define VAL_WAIT_EVNT_CFG       ((VAL_WAIT_EVNTI << 4) | (1 << 2))
 /**
   @brief  Print standardized log context prefix.
           1. Caller       - Application/VAL layers
@@ -149,6 +183,8 @@ val_print_acs_test_status_summary(void)
 {
   acs_test_status_counters_t *stats = acs_get_test_status();
 
+  val_log_flush();
+
   val_print(INFO, "\n---------- ACS Summary ----------\n");
   val_print(INFO, "   Total Rules Run        : %d\n",
             stats->total_rules_run);
@@ -186,6 +222,121 @@ val_print_raw(uint64_t uart_address, uint32_t level, char8_t *string, uint64_t d
   }
 }
 
+/**
+  @brief  Allocates the per-PE counters of the -profile report. MMIO accesses
+          through VAL are counted from now on.
+          1. Caller       - VAL
+          2. Prerequisite - val_pe_create_info_table
+
+  @return ACS_STATUS_PASS, or ACS_STATUS_ERR if the counters cannot be allocated
+ **/
+uint32_t
+val_pe_profile_start(void)
+{
+  uint32_t size = val_pe_get_num() * sizeof(val_pe_profile_t);
+
+  if (g_pe_profile == NULL) {
+      g_pe_profile = val_aligned_alloc(VAL_SHARED_LINE_SIZE, size);
+      if (g_pe_profile == NULL)
+          return ACS_STATUS_ERR;
+  }
+
+  val_memory_set(g_pe_profile, size, 0);
+  val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)g_pe_profile, size);
+  val_data_cache_ops_by_va((addr_t)&g_pe_profile, CLEAN_AND_INVALIDATE);
+  return ACS_STATUS_PASS;
+}
+
+/**
+  @brief  Releases the per-PE counters of the -profile report and stops counting.
+
+  @return None
+ **/
+void
+val_pe_profile_stop(void)
+{
+  void *profile = g_pe_profile;
+
+  if (profile == NULL)
+      return;
+
+  g_pe_profile = NULL;
+  val_data_cache_ops_by_va((addr_t)&g_pe_profile, CLEAN_AND_INVALIDATE);
+  val_memory_free_aligned(profile);
+}
+
+/**
+  @brief  Counts one payload dispatched to a secondary PE.
+
+  @param  index  Index of the PE the payload is dispatched to
+
+  @return None
+ **/
+void
+val_pe_profile_dispatch(uint32_t index)
+{
+  g_pe_dispatch_count++;
+  if ((g_pe_profile != NULL) && (index < val_pe_get_num()))
+      g_pe_profile[index].dispatch_mark = g_pe_dispatch_count;
+}
+
+/**
+  @brief  Returns the MMIO accesses made through VAL by all PEs since
+          val_pe_profile_start().
+
+  @return Number of accesses, 0 when not profiling
+ **/
+uint64_t
+val_pe_profile_mmio_count(void)
+{
+  uint64_t count = 0;
+  uint32_t i;
+
+  if (g_pe_profile == NULL)
+      return 0;
+
+  /* Other PEs do not clean their counters, pull them with a clean */
+  for (i = 0; i < val_pe_get_num(); i++) {
+      val_data_cache_ops_by_va((addr_t)&g_pe_profile[i], CLEAN_AND_INVALIDATE);
+      count += g_pe_profile[i].mmio_accesses;
+  }
+
+  return count;
+}
+
+/**
+  @brief  Returns the number of PEs that received a payload after the dispatch
+          counter reached since.
+
+  @param  since  g_pe_dispatch_count value to count from
+
+  @return Number of PEs, 0 when not profiling
+ **/
+uint32_t
+val_pe_profile_pe_count(uint64_t since)
+{
+  uint32_t count = 0;
+  uint32_t i;
+
+  if (g_pe_profile == NULL)
+      return 0;
+
+  for (i = 0; i < val_pe_get_num(); i++) {
+      if (g_pe_profile[i].dispatch_mark > since)
+          count++;
+  }
+
+  return count;
+}
+
+/* Counts one MMIO access of the current PE while profiling */
+static void
+val_pe_profile_mmio(void)
+{
+  if (g_pe_profile != NULL)
+      g_pe_profile[val_pe_get_index_mpid(val_pe_get_mpid())].mmio_accesses++;
+}
+
 /**
   @brief  This API calls PAL layer to read from a Memory address
           and return 8-bit data.
@@ -199,6 +350,7 @@ val_print_raw(uint64_t uart_address, uint32_t level, char8_t *string, uint64_t d
 uint8_t
 val_mmio_read8(addr_t addr)
 {
+  val_pe_profile_mmio();
   return pal_mmio_read8(addr);
 
 }
@@ -216,6 +368,7 @@ val_mmio_read8(addr_t addr)
 uint16_t
 val_mmio_read16(addr_t addr)
 {
+  val_pe_profile_mmio();
   return pal_mmio_read16(addr);
 
 }
@@ -233,6 +386,7 @@ val_mmio_read16(addr_t addr)
 uint32_t
 val_mmio_read(addr_t addr)
 {
+  val_pe_profile_mmio();
   return pal_mmio_read(addr);
 
 }
@@ -250,6 +404,7 @@ val_mmio_read(addr_t addr)
 uint64_t
 val_mmio_read64(addr_t addr)
 {
+  val_pe_profile_mmio();
   return pal_mmio_read64(addr);
 
 }
@@ -269,6 +424,7 @@ void
 val_mmio_write8(addr_t addr, uint8_t data)
 {
 
+  val_pe_profile_mmio();
   pal_mmio_write8(addr, data);
 }
 
@@ -287,6 +443,7 @@ void
 val_mmio_write16(addr_t addr, uint16_t data)
 {
 
+  val_pe_profile_mmio();
   pal_mmio_write16(addr, data);
 }
 
@@ -305,6 +462,7 @@ void
 val_mmio_write(addr_t addr, uint32_t data)
 {
 
+  val_pe_profile_mmio();
   pal_mmio_write(addr, data);
 }
 /**
@@ -322,6 +480,7 @@ void
 val_mmio_write64(addr_t addr, uint64_t data)
 {
 
+  val_pe_profile_mmio();
   pal_mmio_write64(addr, data);
 }
 
@@ -372,6 +531,20 @@ val_check_skip_module(uint32_t module_base)
 }
 #endif /* COMPILE_RB_EXE */
 
+/**
+  @brief  Drops state cached by VAL that must not carry over from one test
+          to the next.
+
+  @param  None
+  @return None
+ **/
+static void
+val_test_reset_cached_state(void)
+{
+  /* Config space snapshots are retaken by each test */
+  val_pcie_cfg_cache_invalidate_all();
+}
+
 /**
   @brief  This API prints the test number, description and
           sets the test status to pending for the input number of PEs.
@@ -428,6 +601,8 @@ val_initialize_test(uint32_t test_num, char8_t *desc, uint32_t num_pe)
 
   g_override_skip = 1;
 
+  val_test_reset_cached_state();
+
   val_print(INFO, "%4d : ", test_num); //Always print this
   val_print(INFO, desc);
   val_report_status(0, ACS_START(test_num), NULL);
@@ -442,48 +617,143 @@ uint32_t
 val_initialize_test(uint32_t test_num, char8_t *desc, uint32_t num_pe)
 {
   uint32_t i;
+  uint32_t my_index;
   (void)desc;
-  (void)num_pe;
 
-  /* Set TEST_PENDING_VAL status for all PEs, hint for val_wait_for_test_completion */
-  for (i = 0; i < num_pe; i++)
-      val_set_status(i, RESULT_PENDING(test_num));
+  my_index = val_pe_get_index_mpid(val_pe_get_mpid());
+
+  /* Set TEST_PENDING_VAL status for all PEs, hint for val_wait_for_test_completion.
+     A single-PE test only owns the status of the PE it runs on, which is not
+     the primary PE when the rule was dispatched with -ruleparallel. */
+  if (num_pe == 1)
+      val_set_status(my_index, RESULT_PENDING(test_num));
+  else
+      for (i = 0; i < num_pe; i++)
+          val_set_status(i, RESULT_PENDING(test_num));
 
+  /* Per-test state is reset on the PE that runs the test */
+  val_test_reset_cached_state();
+
+#ifndef TARGET_LINUX
+  /* Baremetal and DT targets keep the handlers in VAL, any PE can reset them.
+     UEFI registers them through boot services, which only the primary PE may
+     call; the rule scheduler resets them there before dispatching. */
+  if ((my_index == val_pe_get_primary_index()) || pal_target_is_bm() || pal_target_is_dt())
+      val_pe_initialize_default_exception_handler(val_pe_default_esr);
+#else
   val_pe_initialize_default_exception_handler(val_pe_default_esr);
+#endif
   return ACS_STATUS_PASS;
 }
 #endif /* COMPILE_RB_EXE */
 
+/* Size of the line every PE owns in each shared region, VAL_SHARED_LINE_SIZE
+   widened to the cache writeback granule by val_allocate_shared_mem() */
+static uint32_t g_shared_line_size = VAL_SHARED_LINE_SIZE;
+
+/**
+  @brief  Returns the size of the line every PE owns in each shared memory
+          region. Per-PE records are this many bytes apart.
+
+  @return Line size in bytes
+**/
+uint32_t val_get_shared_line_size(void)
+{
+    return g_shared_line_size;
+}
+
+/* Test data region, one shared line per PE */
+static uintptr_t val_get_shared_data_base(void)
+{
+    uintptr_t base = (uintptr_t)pal_mem_get_shared_addr();
+
+    return (base + g_shared_line_size - 1) & ~((uintptr_t)g_shared_line_size - 1);
+}
+
+/* Test data record of a PE */
+static volatile VAL_SHARED_MEM_t *val_get_shared_data(uint32_t index)
+{
+    return (volatile VAL_SHARED_MEM_t *)(val_get_shared_data_base() +
+                                         (uintptr_t)index * g_shared_line_size);
+}
+
 /**
-  @brief  Allocate memory which is to be shared across PEs
+  @brief  Allocate memory which is to be shared across PEs. Every PE owns one
+          line of each region. The line is VAL_SHARED_LINE_SIZE bytes, rounded
+          up to the cache writeback granule so that cache maintenance by one PE
+          never discards the record of another.
 
   @param  None
 
-  @result None
+  @result ACS_STATUS_PASS
 **/
-void
+uint32_t
 val_allocate_shared_mem()
 {
   uint32_t num_pe = val_pe_get_num();
+  uint32_t line = VAL_SHARED_LINE_SIZE;
+  uint32_t total_size;
+  uint32_t i;
 
-  uint32_t total_size =
-        (num_pe * sizeof(VAL_SHARED_MEM_t)) +
-        (num_pe * sizeof(val_test_status_t));
+  /* CTR_EL0.CWG of 0 does not report a granule, trust the line size then */
+  if ((((val_pe_reg_read(CTR_EL0) >> 24) & 0xf) != 0) &&
+      (val_pe_cache_writeback_granule() > line))
+      line = val_pe_cache_writeback_granule();
+
+  /* Secondary PEs read the line size to find their records */
+  g_shared_line_size = line;
+  val_data_cache_ops_by_va((addr_t)&g_shared_line_size, CLEAN_AND_INVALIDATE);
+  if (line != VAL_SHARED_LINE_SIZE)
+      val_print(DEBUG, "\n Shared lines padded to the writeback granule %d", line);
+
+  /* Test data, status, bitmap and two mailbox lines. Regions start on a line,
+     allow for rounding up the base. */
+  total_size = (num_pe * line) + (num_pe * line) +
+               ((VAL_DONE_BITMAP_SIZE(num_pe) + line - 1) & ~(line - 1)) +
+               (num_pe * 2 * line) + line;
 
   pal_mem_allocate_shared(1, total_size);
 
+  /* Status records start zeroed, which is not pending, so every PE is done.
+     Mailboxes start zeroed too, which is PE_WORKER_OFF for every PE. */
+  val_memory_set((void *)val_get_shared_data_base(), total_size - line, 0);
+  for (i = 0; i < num_pe; i++)
+      ((volatile uint64_t *)val_get_done_bitmap_base())[i / 64] |= 1ULL << (i % 64);
+
+  /* Push the initial state out before any secondary PE reads it */
+  val_pe_cache_clean_invalidate_range(val_get_shared_data_base(), total_size - line);
+  return ACS_STATUS_PASS;
 }
 
 uintptr_t val_get_status_region_base(void)
 {
-    uintptr_t base = (uintptr_t)pal_mem_get_shared_addr();
+    uintptr_t base = val_get_shared_data_base();
     uint32_t npe = val_pe_get_num();
 
     /* Status region starts after ACS data region */
-    base += (uintptr_t)(npe * sizeof(VAL_SHARED_MEM_t));
+    base += (uintptr_t)npe * g_shared_line_size;
+    return base;
+}
+
+uintptr_t val_get_done_bitmap_base(void)
+{
+    uintptr_t base = val_get_status_region_base();
+    uint32_t npe = val_pe_get_num();
+
+    /* Completion bitmap follows the status region */
+    base += (uintptr_t)npe * g_shared_line_size;
     return base;
 }
 
+uintptr_t val_get_mailbox_region_base(void)
+{
+    uint32_t npe = val_pe_get_num();
+    uint32_t line = g_shared_line_size;
+
+    /* Mailbox region follows the completion bitmap, padded to a line */
+    return val_get_done_bitmap_base() + ((VAL_DONE_BITMAP_SIZE(npe) + line - 1) & ~(line - 1));
+}
+
 /**
   @brief  Free the memory which was allocated by allocate_shared_mem
         1. Caller       - Application Layer
@@ -524,8 +794,7 @@ val_set_test_data(uint32_t index, uint64_t addr, uint64_t test_data)
       return;
   }
 
-  mem = (VAL_SHARED_MEM_t *)pal_mem_get_shared_addr();
-  mem = mem + index;
+  mem = val_get_shared_data(index);
 
   mem->data0 = addr;
   mem->data1 = test_data;
@@ -559,8 +828,7 @@ val_get_test_data(uint32_t index, uint64_t *data0, uint64_t *data1)
       return;
   }
 
-  mem = (VAL_SHARED_MEM_t *) pal_mem_get_shared_addr();
-  mem = mem + index;
+  mem = val_get_shared_data(index);
 
   val_data_cache_ops_by_va((addr_t)&mem->data0, INVALIDATE);
   val_data_cache_ops_by_va((addr_t)&mem->data1, INVALIDATE);
@@ -570,24 +838,128 @@ val_get_test_data(uint32_t index, uint64_t *data0, uint64_t *data1)
 
 }
 
+#ifndef TARGET_LINUX
+/**
+  @brief  Enables the generic timer event stream on the current PE so that WFE
+          returns at least every 2^(VAL_WAIT_EVNTI + 1) counter ticks.
+
+  @return Previous CNTHCTL_EL2 or CNTKCTL_EL1 value, for val_wait_event_stream_restore
+ **/
+static uint64_t
+val_wait_event_stream_enable(void)
+{
+  uint64_t ctl;
+
+  if (read_CurrentEL() == AARCH64_EL2) {
+      ctl = read_cnthctl_el2();
+      write_cnthctl_el2((ctl & ~VAL_WAIT_EVNT_MASK) | VAL_WAIT_EVNT_CFG);
+  } else {
+      ctl = read_cntkctl_el1();
+      write_cntkctl_el1((ctl & ~VAL_WAIT_EVNT_MASK) | VAL_WAIT_EVNT_CFG);
+  }
+  isb();
+  return ctl;
+}
+
+static void
+val_wait_event_stream_restore(uint64_t ctl)
+{
+  if (read_CurrentEL() == AARCH64_EL2)
+      write_cnthctl_el2(ctl);
+  else
+      write_cntkctl_el1(ctl);
+  isb();
+}
+#endif
+
+/* Counter used for the completion timeout */
+static uint64_t
+val_wait_counter_read(void)
+{
+#ifndef TARGET_LINUX
+  return virtualcounter_read();
+#else
+  /* The kernel module has no counter access here, count polls instead */
+  static uint64_t polls;
+
+  return polls++;
+#endif
+}
+
+static uint64_t
+val_wait_counter_freq(void)
+{
+#ifndef TARGET_LINUX
+  uint64_t freq = val_get_counter_frequency();
+
+  return freq ? freq : VAL_WAIT_DEFAULT_FREQ;
+#else
+  /* Polls per second such that the timeout is TIMEOUT_LARGE polls */
+  return ((uint64_t)TIMEOUT_LARGE * 1000) / VAL_WAIT_TIMEOUT_MS;
+#endif
+}
+
+/**
+  @brief  Returns non-zero once the completion bitmap has the bits of PE 0 to
+          num_pe - 1 set, i.e. no PE status is pending.
+
+  @param num_pe    Number of PEs executing the test
+  @param *pending  Index of the last PE still pending
+
+  @return        1 if all PEs are done, 0 otherwise
+ **/
+static uint32_t
+val_all_pe_done(uint32_t num_pe, uint32_t *pending)
+{
+  volatile uint64_t *bitmap = (volatile uint64_t *)val_get_done_bitmap_base();
+  uint64_t expected;
+  uint64_t word;
+  uint32_t i;
+
+  for (i = (num_pe - 1) / 64 + 1; i > 0; i--) {
+      val_data_cache_ops_by_va((addr_t)&bitmap[i - 1], INVALIDATE);
+      word = bitmap[i - 1];
+      expected = ((i * 64) <= num_pe) ? ~0ULL : ((1ULL << (num_pe % 64)) - 1);
+      if ((word & expected) != expected) {
+          *pending = (i - 1) * 64 + 63 - __builtin_clzll(~word & expected);
+          return 0;
+      }
+  }
+
+  /* Status records are read after the bitmap */
+#ifndef TARGET_LINUX
+  dmbish();
+#endif
+  return 1;
+}
+
 /**
   @brief  This function will wait for all PEs to report their status
-          or we timeout and set a failure for the PE which timed-out
+          or we timeout and set a failure for the PE which timed-out.
+          Secondary PEs set their bit in the completion bitmap and send
+          SEV from val_set_status, the primary PE waits for them in WFE.
           1. Caller       - Application layer
           2. Prerequisite - val_set_status
 
-  @param test_num  Unique test number
-  @param num_pe    Number of PE who are executing this test
-  @param timeout   integer value ob expiry the API will timeout and return
+  @param test_num    Unique test number
+  @param num_pe      Number of PE who are executing this test
+  @param timeout_ms  Time after which the API will give up and return
 
   @return        None
  **/
 
 static void
-val_wait_for_test_completion(uint32_t test_num, uint32_t num_pe, uint32_t timeout)
+val_wait_for_test_completion(uint32_t test_num, uint32_t num_pe, uint32_t timeout_ms)
 {
 
-  uint32_t i = 0, j = 0;
+  uint32_t pending = 0;
+  uint64_t freq;
+  uint64_t now;
+  uint64_t deadline;
+  uint64_t next_drain;
+#ifndef TARGET_LINUX
+  uint64_t evnt_ctl;
+#endif
 
   val_print(TRACE, "Test_num= %d\n", test_num);
 
@@ -595,21 +967,40 @@ val_wait_for_test_completion(uint32_t test_num, uint32_t num_pe, uint32_t timeou
   if (num_pe == 1)
       return;
 
-  while(--timeout)
-  {
-      j = 0;
-      for (i = 0; i < num_pe; i++)
-      {
-          if (IS_RESULT_PENDING(val_get_status(i))) {
-              j = i+1;
-          }
+  freq = val_wait_counter_freq();
+  now = val_wait_counter_read();
+  deadline = now + (freq / 1000) * timeout_ms;
+  next_drain = now + freq / VAL_WAIT_DRAIN_HZ;
+
+#ifndef TARGET_LINUX
+  evnt_ctl = val_wait_event_stream_enable();
+#endif
+
+  while (!val_all_pe_done(num_pe, &pending)) {
+      now = val_wait_counter_read();
+      if (now >= deadline)
+          break;
+
+      //Keep the secondary PE log rings from filling up while the payload runs
+      if (now >= next_drain) {
+          val_log_drain();
+          next_drain = now + freq / VAL_WAIT_DRAIN_HZ;
       }
-      //If None of the PE have the status as Pending, return
-      if (!j)
-          return;
+
+#ifndef TARGET_LINUX
+      wfe();
+#endif
   }
-  //We are here if we timed-out, set the last index PE as failed
-  val_set_status(j-1, RESULT_FAIL(0xF));
+
+#ifndef TARGET_LINUX
+  val_wait_event_stream_restore(evnt_ctl);
+#endif
+
+  val_log_drain();
+
+  //We are here if we timed-out, set the last pending PE as failed
+  if (!val_all_pe_done(num_pe, &pending))
+      val_set_status(pending, RESULT_FAIL(0xF));
 }
 
 /**
@@ -641,7 +1032,7 @@ val_run_test_payload(uint32_t test_num, uint32_t num_pe, void (*payload)(void),
           val_execute_on_pe(i, payload, test_input);
   }
 
-  val_wait_for_test_completion(test_num, num_pe, TIMEOUT_LARGE);
+  val_wait_for_test_completion(test_num, num_pe, VAL_WAIT_TIMEOUT_MS);
 }
 
 /**
@@ -687,6 +1078,9 @@ val_check_for_error(uint32_t test_num, uint32_t num_pe, char8_t *ruleid)
   uint32_t my_index = val_pe_get_index_mpid(val_pe_get_mpid());
   (void) test_num;
 
+  /* Test boundary: dump binary log records ahead of the result line */
+  val_log_flush();
+
   /* this special case is needed when the Main PE is not the first entry
      of pe_info_table but num_pe is 1 for SOC tests */
   if (num_pe == 1) {
@@ -740,6 +1134,9 @@ val_check_for_error(uint32_t test_num, uint32_t num_pe, char8_t *ruleid)
   uint32_t status = RESULT_FAIL(0);
   uint32_t my_index = val_pe_get_index_mpid(val_pe_get_mpid());
 
+  /* Test boundary: dump binary log records ahead of the result line */
+  val_log_flush();
+
   if (num_pe == 1) {
       status = val_get_status(my_index);
       overall_status = status;
@@ -17,6 +17,8 @@
 
 #include "rule_based_execution.h"
 #include "val_interface.h"
+#include "val_libc.h"
+#include "val_sysreg.h"
 
 extern rule_test_map_t rule_test_map[RULE_ID_SENTINEL];
 extern char *rule_id_string[RULE_ID_SENTINEL];
@@ -25,6 +27,22 @@ extern const uint32_t alias_rule_map_count;
 extern const alias_rule_map_t alias_rule_map[];
 extern uint8_t g_current_pal;
 
+/* Bitmasks over MODULE_NAME_e and per-rule level bytes must hold every value */
+static_assert(MODULE_ID_SENTINEL <= 64, "module masks of rule_filter_t are 64-bit");
+static_assert((BSA_LEVEL_SENTINEL <= 0x100) && (SBSA_LEVEL_SENTINEL <= 0x100) &&
+              (PCBSA_LEVEL_SENTINEL <= 0x100) && (VBSA_LEVEL_SENTINEL <= 0x100) &&
+              (PFDI_LEVEL_SENTINEL <= 0x100), "rule_arch_index_t levels are 8-bit");
+
+/*
+ * Alias rule to alias_rule_map index, plus one so that 0 means no entry.
+ * Built on first use by a single pass over alias_rule_map.
+ */
+static uint16_t rule_alias_index[RULE_ID_SENTINEL];
+static bool rule_alias_index_ready;
+
+/* Lookup table of the last architecture passed to rule_arch_index_get() */
+static rule_arch_index_t rule_arch_index;
+
 /**
  * @brief Check if a rule ID exists in a list.
  *
@@ -292,7 +310,8 @@ print_rule_test_status(uint32_t rule_enum, uint32_t indent, uint32_t status)
         if (top_level_rule) stats->pal_not_supported++;
         break;
     default:
-        val_print(INFO, "STATUS:0x%08x", status);
+        /* Other states are printed raw by test_report_status() */
+        break;
     }
 
     test_report_status(status);
@@ -315,29 +334,401 @@ void rule_status_map_reset(void)
 }
 
 /**
- * @brief Get the index of an alias rule in alias_rule_map.
+ * @brief Build the alias rule index from alias_rule_map.
  *
- * Performs a linear scan over the compile-time `alias_rule_map` and returns
- * the zero-based index of the entry whose `alias_rule_id` matches the input.
- * If no entry matches, returns `INVALID_IDX`.
+ * Alias rules of rule_test_map without a map entry are reported at DEBUG
+ * verbosity; run_tests() reports them as not found when they are selected.
+ */
+static void
+rule_alias_index_build(void)
+{
+    uint32_t i;
+    RULE_ID_e rule_id;
+
+    for (i = 0; i < alias_rule_map_count; i++) {
+        rule_id = alias_rule_map[i].alias_rule_id;
+        /* Aliases are unique, ALIAS_RULE_MAP checks it at build time */
+        if (rule_id < RULE_ID_SENTINEL && rule_alias_index[rule_id] == 0)
+            rule_alias_index[rule_id] = (uint16_t)(i + 1);
+    }
+
+    for (i = 0; i < RULE_ID_SENTINEL; i++) {
+        if (rule_test_map[i].flag == ALIAS_RULE && rule_alias_index[i] == 0) {
+            val_print(DEBUG, "\n       No alias_rule_map entry for ");
+            val_print(DEBUG, rule_id_string[i]);
+        }
+    }
+
+    rule_alias_index_ready = 1;
+}
+
+/**
+ * @brief Return the index of an alias rule in alias_rule_map.
  *
- * @param alias_rule_id Alias rule identifier to look up.
- * @return uint32_t Zero-based index in `alias_rule_map`, or `INVALID_IDX` if not found.
+ * @param alias_rule_id  Alias rule identifier to find.
+ * @return Index into alias_rule_map if found; INVALID_IDX otherwise.
  */
 uint32_t
 alias_rule_map_get_index(RULE_ID_e alias_rule_id)
 {
+    if (!rule_alias_index_ready)
+        rule_alias_index_build();
 
+    if (alias_rule_id >= RULE_ID_SENTINEL || rule_alias_index[alias_rule_id] == 0)
+        return INVALID_IDX;
+
+    return rule_alias_index[alias_rule_id] - 1;
+}
+
+/**
+ * @brief Turn the -skip, -skipmodule and -m selections of a run request into
+ *        bitsets, so that rule_filter_skips() and rule_filter_module_selected()
+ *        are constant time.
+ *
+ * @param ctx     Run request, may be NULL for no selection.
+ * @param filter  Filter to initialize.
+ */
+void
+rule_filter_init(const acs_run_request_t *ctx, rule_filter_t *filter)
+{
     uint32_t i;
 
-    /* Iterate over all entries in the alias map */
-    for (i = 0; i <  alias_rule_map_count; i++) {
-        /* Check if the current entry's alias matches the requested ID */
-        if (alias_rule_map[i].alias_rule_id == alias_rule_id) {
-            return i;  /* found: return its index */
+    val_memory_set(filter, sizeof(rule_filter_t), 0);
+    if (ctx == NULL)
+        return;
+
+    if (ctx->skip_rule_list != NULL) {
+        for (i = 0; i < ctx->skip_rule_count; i++) {
+            if (ctx->skip_rule_list[i] < RULE_ID_SENTINEL)
+                rule_bitset_set(&filter->skip_rules, ctx->skip_rule_list[i]);
         }
     }
 
-    /* Not found: return sentinel indicating absence */
-    return INVALID_IDX;
+    if (ctx->skip_modules != NULL) {
+        for (i = 0; i < ctx->num_skip_modules; i++) {
+            if (ctx->skip_modules[i] < MODULE_ID_SENTINEL)
+                filter->skip_modules |= 1ULL << ctx->skip_modules[i];
+        }
+    }
+
+    if (ctx->num_modules > 0 && ctx->execute_modules != NULL) {
+        filter->module_select = 1;
+        for (i = 0; i < ctx->num_modules; i++) {
+            if (ctx->execute_modules[i] < MODULE_ID_SENTINEL)
+                filter->run_modules |= 1ULL << ctx->execute_modules[i];
+        }
+    }
+}
+
+/**
+ * @brief Check a rule against the -skip and -skipmodule selections.
+ *
+ * @return true (1) if the rule should be skipped, false (0) otherwise.
+ */
+bool
+rule_filter_skips(const rule_filter_t *filter, RULE_ID_e rule_id)
+{
+    if (rule_id >= RULE_ID_SENTINEL)
+        return 0;
+
+    if (rule_bitset_test(&filter->skip_rules, rule_id))
+        return 1;
+
+    return (filter->skip_modules >> rule_test_map[rule_id].module_id) & 1;
+}
+
+/**
+ * @brief Check a rule against the -m selection.
+ *
+ * @return true (1) if -m was not given or selects the module of the rule.
+ */
+bool
+rule_filter_module_selected(const rule_filter_t *filter, RULE_ID_e rule_id)
+{
+    if (!filter->module_select)
+        return 1;
+
+    return (filter->run_modules >> rule_test_map[rule_id].module_id) & 1;
+}
+
+static void
+rule_arch_index_add(RULE_ID_e rule_id, uint32_t level, uint32_t sw_view)
+{
+    rule_arch_index_t *index = &rule_arch_index;
+
+    /* Duplicates keep their first entry, as with a linear search */
+    if (rule_id >= RULE_ID_SENTINEL || rule_bitset_test(&index->present, rule_id))
+        return;
+
+    rule_bitset_set(&index->present, rule_id);
+    index->order[index->count++] = rule_id;
+    index->level[rule_id] = (uint8_t)level;
+    index->sw_view[rule_id] = (uint8_t)sw_view;
+}
+
+/**
+ * @brief Return the lookup table of an architecture (rule_lookup.c) indexed
+ *        by rule ID. Built in one pass over the table and kept until another
+ *        architecture is requested.
+ *
+ * @param arch  ARCH_SEL_e value.
+ * @return Index, or NULL for ARCH_NONE or an unknown architecture.
+ */
+const rule_arch_index_t *
+rule_arch_index_get(uint32_t arch)
+{
+    rule_arch_index_t *index = &rule_arch_index;
+    uint32_t i;
+
+    if (arch == ARCH_NONE)
+        return NULL;
+
+    if (index->arch == arch)
+        return index;
+
+    val_memory_set(index, sizeof(rule_arch_index_t), 0);
+
+    switch (arch) {
+    case ARCH_BSA:
+        for (i = 0; bsa_rule_list[i].rule_id != RULE_ID_SENTINEL; i++)
+            rule_arch_index_add(bsa_rule_list[i].rule_id, bsa_rule_list[i].level,
+                                bsa_rule_list[i].sw_view);
+        index->fr_level = BSA_LEVEL_FR;
+        break;
+    case ARCH_SBSA:
+        for (i = 0; sbsa_rule_list[i].rule_id != RULE_ID_SENTINEL; i++)
+            rule_arch_index_add(sbsa_rule_list[i].rule_id, sbsa_rule_list[i].level, 0);
+        index->fr_level = SBSA_LEVEL_FR;
+        break;
+    case ARCH_PCBSA:
+        for (i = 0; pcbsa_rule_list[i].rule_id != RULE_ID_SENTINEL; i++)
+            rule_arch_index_add(pcbsa_rule_list[i].rule_id, pcbsa_rule_list[i].level, 0);
+        index->fr_level = PCBSA_LEVEL_FR;
+        break;
+    case ARCH_VBSA:
+        for (i = 0; vbsa_rule_list[i].rule_id != RULE_ID_SENTINEL; i++)
+            rule_arch_index_add(vbsa_rule_list[i].rule_id, vbsa_rule_list[i].level, 0);
+        index->fr_level = VBSA_LEVEL_FR;
+        break;
+    case ARCH_PFDI:
+        /* PFDI has no FR level, -fr keeps every rule */
+        for (i = 0; pfdi_rule_list[i].rule_id != RULE_ID_SENTINEL; i++)
+            rule_arch_index_add(pfdi_rule_list[i].rule_id, pfdi_rule_list[i].level, 0);
+        break;
+    default:
+        return NULL;
+    }
+
+    index->arch = arch;
+    return index;
+}
+
+/**
+ * @brief Apply the level and BSA software view selections to a rule.
+ *
+ * Rules not listed in the architecture table are kept.
+ *
+ * @param index    Table returned by rule_arch_index_get() for ctx->arch_selection.
+ * @param ctx      Run request holding the level filter and software view mask.
+ * @param rule_id  Rule to check.
+ * @return true (1) if the rule is kept, false (0) if it is filtered out.
+ */
+bool
+rule_arch_level_selected(const rule_arch_index_t *index, const acs_run_request_t *ctx,
+                         RULE_ID_e rule_id)
+{
+    uint32_t level;
+
+    if (rule_id >= RULE_ID_SENTINEL || !rule_bitset_test(&index->present, rule_id))
+        return 1;
+
+    /* Software view filter if requested: keep if any selected */
+    if (index->arch == ARCH_BSA && ctx->bsa_sw_view_mask != 0 &&
+        (ctx->bsa_sw_view_mask & (1u << index->sw_view[rule_id])) == 0)
+        return 0;
+
+    level = index->level[rule_id];
+    switch (ctx->level_filter_mode) {
+    case LVL_FILTER_FR:
+        /* Treat FR mode as MAX up to FR */
+        return (index->fr_level == 0) || (level <= index->fr_level);
+    case LVL_FILTER_ONLY:
+        return level == ctx->level_value;
+    case LVL_FILTER_MAX:
+        return level <= ctx->level_value;
+    default:
+        return 1;
+    }
+}
+
+/* Marker that starts every line of the -profile report */
+#define RULE_PROFILE_MARKER "@ACSPROF"
+
+/* Counter frequency used to convert profile ticks to microseconds */
+static uint64_t
+rule_profile_counter_freq(void)
+{
+#ifndef TARGET_LINUX
+    return val_get_counter_frequency();
+#else
+    /* The kernel module does not link the timer VAL, report ticks only */
+    return 0;
+#endif
+}
+
+static uint64_t
+rule_profile_ticks_to_us(uint64_t ticks, uint64_t freq)
+{
+    if (freq == 0)
+        return 0;
+
+    /* Split the conversion so that long runs do not overflow */
+    return (ticks / freq) * 1000000 + ((ticks % freq) * 1000000) / freq;
+}
+
+static const char8_t *
+rule_profile_state_name(uint32_t status)
+{
+    switch (GET_STATE(status)) {
+    case TEST_PASS:
+        return "PASS";
+    case TEST_PARTIAL_COVERED:
+        return "PARTIAL";
+    case TEST_WARNING:
+        return "WARN";
+    case TEST_SKIP:
+        return "SKIP";
+    case TEST_FAIL:
+        return "FAIL";
+    case TEST_NOT_IMPLEMENTED:
+        return "NOT_IMPLEMENTED";
+    case TEST_PAL_NOT_SUPPORTED:
+        return "PAL_NOT_SUPPORTED";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+/**
+ * @brief Clear the per-rule profile map before a run and start the per-PE
+ *        counters.
+ */
+void rule_profile_reset(void)
+{
+    val_memory_set(rule_profile_map, sizeof(rule_profile_map), 0);
+    if (val_pe_profile_start() != ACS_STATUS_PASS)
+        val_print(WARN, "\n Per-PE profile counters not allocated, MMIO and PE counts are 0");
+}
+
+/**
+ * @brief Capture the counters at the start of a profiled section.
+ *
+ * @param sample Filled with the current virtual counter and activity counters.
+ */
+void
+rule_profile_start(rule_profile_sample_t *sample)
+{
+    sample->psci_calls = g_psci_call_count;
+    sample->mmio_accesses = val_pe_profile_mmio_count();
+    sample->pe_dispatches = g_pe_dispatch_count;
+    sample->start = virtualcounter_read();
+}
+
+/**
+ * @brief Account a finished rule run to the rule's profile record.
+ *
+ * A rule run more than once (a base rule shared by several aliases) keeps
+ * the sum of all runs.
+ *
+ * @param rule_id   Rule that ran.
+ * @param sample    Counters captured by rule_profile_start().
+ * @param top_level Non-zero if the rule is in the run list itself.
+ */
+void
+rule_profile_stop(RULE_ID_e rule_id, const rule_profile_sample_t *sample, uint32_t top_level)
+{
+    rule_profile_t *prof = &rule_profile_map[rule_id];
+    uint32_t pe_count = val_pe_profile_pe_count(sample->pe_dispatches);
+
+    prof->ticks += virtualcounter_read() - sample->start;
+    prof->psci_calls += g_psci_call_count - sample->psci_calls;
+    prof->mmio_accesses += val_pe_profile_mmio_count() - sample->mmio_accesses;
+    prof->pe_dispatches += g_pe_dispatch_count - sample->pe_dispatches;
+    if (pe_count > prof->pe_count)
+        prof->pe_count = pe_count;
+    prof->runs++;
+    if (top_level)
+        prof->top_level = 1;
+}
+
+/**
+ * @brief Account the time spent in an alias rule precheck.
+ *
+ * @param rule_id Alias rule whose precheck ran.
+ * @param sample  Counters captured by rule_profile_start() before the precheck.
+ */
+void
+rule_profile_precheck_stop(RULE_ID_e rule_id, const rule_profile_sample_t *sample)
+{
+    rule_profile_map[rule_id].precheck_ticks += virtualcounter_read() - sample->start;
+}
+
+/**
+ * @brief Print the per-rule profile as JSON lines.
+ *
+ * One line per rule that ran, in RULE_ID_e order, then one summary line for
+ * the run. Every line starts with "@ACSPROF " so that
+ * tools/scripts/acs_profile_compare.py can pick them out of a console log.
+ * The "pe" of a rule is the number of secondary PEs a run of it dispatched
+ * to. The per-PE counters are released afterwards.
+ *
+ * Example output
+ * "@ACSPROF {"rule":"B_PE_01","module":"PE","type":"base","top":1,"state":"PASS",
+ *  "status":"0x00000004","runs":1,"ticks":52000,"us":52,"precheck_us":0,"pe":7,
+ *  "dispatch":7,"psci":14,"mmio":0}"
+ *
+ * @param num_pe Number of PEs passed to the test entry functions.
+ */
+void
+rule_profile_report(uint32_t num_pe)
+{
+    uint32_t i;
+    uint32_t num_rules = 0;
+    uint64_t total_ticks = 0;
+    uint64_t freq = rule_profile_counter_freq();
+    const rule_profile_t *prof;
+    const char8_t *module;
+
+    for (i = 0; i < RULE_ID_SENTINEL; i++) {
+        prof = &rule_profile_map[i];
+        if (prof->runs == 0)
+            continue;
+
+        if (prof->top_level) {
+            num_rules++;
+            total_ticks += prof->ticks;
+        }
+
+        module = (rule_test_map[i].module_id < MODULE_ID_SENTINEL) ?
+                 module_name_string[rule_test_map[i].module_id] : "UNKNOWN";
+
+        val_print(INFO, "\n" RULE_PROFILE_MARKER " {\"rule\":\"%s\",\"module\":\"%s\",",
+                  rule_id_string[i], module);
+        val_print(INFO, "\"type\":\"%s\",\"top\":%d,\"state\":\"%s\",\"status\":\"0x%08x\",",
+                  (rule_test_map[i].flag == ALIAS_RULE) ? "alias" : "base",
+                  prof->top_level, rule_profile_state_name(rule_status_map[i]),
+                  rule_status_map[i]);
+        val_print(INFO, "\"runs\":%d,\"ticks\":%llu,\"us\":%llu,\"precheck_us\":%llu,",
+                  prof->runs, prof->ticks, rule_profile_ticks_to_us(prof->ticks, freq),
+                  rule_profile_ticks_to_us(prof->precheck_ticks, freq));
+        val_print(INFO, "\"pe\":%d,\"dispatch\":%llu,\"psci\":%llu,\"mmio\":%llu}",
+                  prof->pe_count, prof->pe_dispatches, prof->psci_calls, prof->mmio_accesses);
+    }
+
+    val_print(INFO, "\n" RULE_PROFILE_MARKER " {\"summary\":1,\"rules\":%d,\"pe\":%d,",
+              num_rules, num_pe);
+    val_print(INFO, "\"freq\":%llu,\"ticks\":%llu,\"us\":%llu}\n",
+              freq, total_ticks, rule_profile_ticks_to_us(total_ticks, freq));
+
+    val_pe_profile_stop();
 }
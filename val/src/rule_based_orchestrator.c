@@ -20,6 +20,7 @@
 #include "val_interface.h"
 #include "acs_pe.h"
 #include "acs_memory.h"
+#include "acs_pcie.h"
 
 extern uint8_t g_current_pal;
 extern rule_test_map_t rule_test_map[RULE_ID_SENTINEL];
@@ -58,39 +59,362 @@ static uint32_t check_rule_support(RULE_ID_e rule_id)
     return TEST_SUPPORTED; /* supported on current PAL */
 }
 
+/*
+ * Parallel rule pass (-ruleparallel). Before the serial pass, the rules marked
+ * RULE_EXEC_PARALLEL_SAFE are run on idle secondary PEs, one rule per PE at a
+ * time, with the val_printf output of each rule captured in its own buffer.
+ * The serial pass then prints the captured output and takes the recorded
+ * status when it reaches the rule, so the log reads as for a serial run. The
+ * primary PE only hands out rules and drains the log rings meanwhile.
+ */
+#define RULE_PARALLEL_OUTPUT_SIZE  0x800     /* captured output per rule */
+#define RULE_PARALLEL_TIMEOUT_S    60        /* per rule, then run serially */
+
+typedef struct {
+    RULE_ID_e          rule_id;
+    volatile uint32_t  started;
+    volatile uint32_t  done;
+    uint32_t           ran;          /* 0: output capture unavailable, run serially */
+    uint32_t           status;
+    uint32_t           output_len;   /* as returned by val_log_capture_stop() */
+    uint64_t           ticks;
+    char               *output;
+    uint8_t            reserved[24]; /* one cache line per job */
+} rule_parallel_job_t;
+
+typedef struct {
+    rule_parallel_job_t *jobs;
+    char                *output;
+    uint32_t            count;
+    uint32_t            lost;        /* jobs left on a PE that did not finish them */
+} rule_parallel_set_t;
+
+#ifndef TARGET_LINUX
+typedef struct {
+    uint32_t job;
+    uint32_t state;
+    uint64_t deadline;
+} rule_parallel_pe_t;
+
+enum {
+    RULE_PARALLEL_PE_IDLE = 0,
+    RULE_PARALLEL_PE_BUSY,
+    RULE_PARALLEL_PE_LOST
+};
+
 /**
- * @brief Determine if a rule should be skipped based on CLI options.
- *
- * Checks whether the provided rule ID is present in the explicit skip list
- * (-skip) or whether its module is present in the skip-modules list
- * (-skipmodule).
+ * @brief Check whether a rule may be run by the parallel pass.
  *
+ * @param filter  -skip and -skipmodule selections of the run.
  * @param rule_id Rule identifier to check.
- * @return true (1) if the rule should be skipped, false(0) otherwise.
+ * @return 1 if the rule is a supported, parallel-safe base rule with a test entry.
  */
-static bool is_rule_skipped(const acs_run_request_t *ctx, RULE_ID_e rule_id)
+static uint32_t rule_parallel_eligible(const rule_filter_t *filter, RULE_ID_e rule_id)
 {
-    uint32_t i;
-    MODULE_NAME_e module;
-
-    if (ctx == NULL)
+    if (!(rule_test_map[rule_id].exec_flags & RULE_EXEC_PARALLEL_SAFE) ||
+        (rule_test_map[rule_id].flag != BASE_RULE) ||
+        (check_rule_support(rule_id) != TEST_SUPPORTED) ||
+        (test_entry_func_table[rule_test_map[rule_id].test_entry_id] == NULL))
         return 0;
 
-    /* Check explicit rule skip list (-skip) */
-    if (ctx->skip_rule_count > 0 && ctx->skip_rule_list != NULL) {
-        for (i = 0; i < ctx->skip_rule_count; i++) {
-            if (ctx->skip_rule_list[i] == rule_id)
-                return 1;
+    return !rule_filter_skips(filter, rule_id);
+}
+
+/**
+ * @brief Payload of the secondary PEs in the parallel pass. Runs the rule of
+ *        the job passed as test data with its output captured.
+ */
+static void rule_parallel_worker(void)
+{
+    uint32_t index;
+    uint64_t data0;
+    uint64_t addr;
+    uint64_t start;
+    rule_parallel_job_t *job;
+
+    index = val_pe_get_index_mpid(val_pe_get_mpid());
+    val_get_test_data(index, &data0, &addr);
+    job = (rule_parallel_job_t *)(uintptr_t)addr;
+    val_pe_cache_invalidate_range((uint64_t)(uintptr_t)job, sizeof(rule_parallel_job_t));
+
+    /* Tells the primary PE that the status of this PE now belongs to the test */
+    job->started = 1;
+    val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)job, sizeof(rule_parallel_job_t));
+    dmbish();
+
+    if (val_log_capture_start(job->output, RULE_PARALLEL_OUTPUT_SIZE) == 0) {
+        start = virtualcounter_read();
+        job->status =
+            test_entry_func_table[rule_test_map[job->rule_id].test_entry_id](val_pe_get_num());
+        job->ticks = virtualcounter_read() - start;
+        job->output_len = val_log_capture_stop();
+        job->ran = 1;
+    }
+
+    val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)job->output,
+                                        RULE_PARALLEL_OUTPUT_SIZE);
+    val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)job, sizeof(rule_parallel_job_t));
+
+    /* Publish the results before the completion flag */
+    dmbish();
+    job->done = 1;
+    val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)&job->done, sizeof(job->done));
+}
+
+/**
+ * @brief Hand out the jobs of a set to the secondary PEs and wait for them.
+ *
+ * A PE that cannot be started, or does not finish its rule within
+ * RULE_PARALLEL_TIMEOUT_S, is marked lost with val_pe_mark_lost() so that no
+ * later dispatch, parallel or serial, uses it. Its rule is left for the serial
+ * pass. PEs lost earlier in the run get no rules.
+ *
+ * @param set  Jobs to run.
+ * @param pe   Per-PE dispatch state, num_pe entries, zeroed.
+ */
+static void rule_parallel_dispatch(rule_parallel_set_t *set, rule_parallel_pe_t *pe)
+{
+    uint32_t num_pe = val_pe_get_num();
+    uint32_t primary = val_pe_get_primary_index();
+    uint32_t next = 0;
+    uint32_t busy = 0;
+    uint32_t usable = num_pe - 1;
+    uint32_t index;
+    uint64_t timeout;
+    rule_parallel_job_t *job;
+
+    timeout = val_get_counter_frequency() * RULE_PARALLEL_TIMEOUT_S;
+
+    for (index = 0; index < num_pe; index++) {
+        if ((index != primary) && !val_pe_usable(index)) {
+            pe[index].state = RULE_PARALLEL_PE_LOST;
+            usable--;
         }
     }
 
-    /* Check module skip list (-skipmodule) */
-    if (ctx->num_skip_modules > 0 && ctx->skip_modules != NULL) {
-        module = rule_test_map[rule_id].module_id;
-        for (i = 0; i < ctx->num_skip_modules; i++) {
-            if (ctx->skip_modules[i] == (uint32_t)module)
-                return 1;
+    while ((next < set->count || busy) && usable) {
+        for (index = 0; index < num_pe; index++) {
+            if (index == primary || pe[index].state == RULE_PARALLEL_PE_LOST)
+                continue;
+
+            if (pe[index].state == RULE_PARALLEL_PE_BUSY) {
+                job = &set->jobs[pe[index].job];
+                val_pe_cache_invalidate_range((uint64_t)(uintptr_t)&job->done, sizeof(job->done));
+                if (job->done) {
+                    pe[index].state = RULE_PARALLEL_PE_IDLE;
+                    busy--;
+                } else if (virtualcounter_read() > pe[index].deadline) {
+                    val_print(WARN, "\n       PE %d did not finish ", index);
+                    val_print(WARN, rule_id_string[job->rule_id]);
+                    val_print(WARN, ", running it serially");
+                    val_pe_mark_lost(index);
+                    pe[index].state = RULE_PARALLEL_PE_LOST;
+                    set->lost++;
+                    busy--;
+                    usable--;
+                    continue;
+                } else {
+                    continue;
+                }
+            }
+
+            if (next == set->count)
+                continue;
+
+            job = &set->jobs[next];
+            val_set_status(index, RESULT_PENDING(0));
+            val_execute_on_pe(index, rule_parallel_worker, (uint64_t)(uintptr_t)job);
+
+            /* A failed PSCI_CPU_ON reports through the status of the PE */
+            if (!IS_RESULT_PENDING(val_get_status(index))) {
+                dmbish();
+                val_pe_cache_invalidate_range((uint64_t)(uintptr_t)job,
+                                              sizeof(rule_parallel_job_t));
+                if (!job->started) {
+                    val_pe_mark_lost(index);
+                    pe[index].state = RULE_PARALLEL_PE_LOST;
+                    usable--;
+                    continue;
+                }
+            }
+
+            pe[index].job = next++;
+            pe[index].state = RULE_PARALLEL_PE_BUSY;
+            pe[index].deadline = virtualcounter_read() + timeout;
+            busy++;
+        }
+
+        val_log_drain();
+    }
+
+    val_pe_cache_invalidate_range((uint64_t)(uintptr_t)set->jobs,
+                                  set->count * sizeof(rule_parallel_job_t));
+}
+
+/**
+ * @brief Run the parallel-safe rules of the run list on secondary PEs.
+ *
+ * Collects the eligible base rules of the run list and of the alias rules
+ * without a precheck, and runs them through rule_parallel_dispatch(). Does
+ * nothing unless -ruleparallel is set, the system has several PEs and at
+ * least two rules qualify. On allocation failure all rules run serially.
+ *
+ * @param ctx     Run request.
+ * @param filter  -skip and -skipmodule selections of the run.
+ * @param set     On return, the jobs run; count is 0 if the pass did not run.
+ */
+static void rule_parallel_run(const acs_run_request_t *ctx, const rule_filter_t *filter,
+                              rule_parallel_set_t *set)
+{
+    uint32_t num_pe = val_pe_get_num();
+    uint32_t i, j;
+    uint32_t count = 0;
+    uint32_t index;
+    RULE_ID_e rule;
+    RULE_ID_e *rules;
+    RULE_ID_e *base_rule_list;
+    rule_parallel_pe_t *pe;
+    rule_bitset_t queued;
+
+    val_memory_set(set, sizeof(rule_parallel_set_t), 0);
+    if (!acs_policy_get_rule_parallel() || num_pe < 2)
+        return;
+
+    rules = val_memory_alloc(RULE_ID_SENTINEL * sizeof(RULE_ID_e));
+    if (rules == NULL)
+        return;
+
+    val_memory_set(&queued, sizeof(queued), 0);
+    for (i = 0; i < ctx->rule_count; i++) {
+        rule = ctx->rule_list[i];
+        if (rule_test_map[rule].flag == ALIAS_RULE) {
+            /* A precheck may rule out the base rules, leave those to the serial pass */
+            index = alias_rule_map_get_index(rule);
+            if ((check_rule_support(rule) != TEST_SUPPORTED) || (index == INVALID_IDX) ||
+                (rule_test_map[rule].test_entry_id != NULL_ENTRY))
+                continue;
+
+            base_rule_list = alias_rule_map[index].base_rule_list;
+            for (j = 0; base_rule_list[j] != RULE_ID_SENTINEL; j++) {
+                if (!rule_bitset_test(&queued, base_rule_list[j]) &&
+                    rule_parallel_eligible(filter, base_rule_list[j])) {
+                    rule_bitset_set(&queued, base_rule_list[j]);
+                    rules[count++] = base_rule_list[j];
+                }
+            }
+        } else if (!rule_bitset_test(&queued, rule) && rule_parallel_eligible(filter, rule)) {
+            rule_bitset_set(&queued, rule);
+            rules[count++] = rule;
+        }
+    }
+
+    if (count < 2) {
+        val_memory_free(rules);
+        return;
+    }
+
+    set->jobs = val_aligned_alloc(64, count * sizeof(rule_parallel_job_t));
+    set->output = val_aligned_alloc(64, count * RULE_PARALLEL_OUTPUT_SIZE);
+    pe = val_memory_calloc(num_pe, sizeof(rule_parallel_pe_t));
+    if ((set->jobs == NULL) || (set->output == NULL) || (pe == NULL)) {
+        val_print(WARN, "\n Parallel rule pass not run, out of memory");
+        if (set->jobs != NULL)
+            val_memory_free_aligned(set->jobs);
+        if (set->output != NULL)
+            val_memory_free_aligned(set->output);
+        if (pe != NULL)
+            val_memory_free(pe);
+        val_memory_free(rules);
+        val_memory_set(set, sizeof(rule_parallel_set_t), 0);
+        return;
+    }
+
+    val_memory_set(set->jobs, count * sizeof(rule_parallel_job_t), 0);
+    for (i = 0; i < count; i++) {
+        set->jobs[i].rule_id = rules[i];
+        set->jobs[i].output = set->output + i * RULE_PARALLEL_OUTPUT_SIZE;
+    }
+    set->count = count;
+    val_memory_free(rules);
+
+    val_print(INFO, "\n Running %d parallel-safe rules on secondary PEs", count);
+
+    /* Where handlers are registered through firmware, only the primary PE can
+       reset them, see val_initialize_test(). The config cache is not safe for
+       concurrent use. */
+    val_pe_initialize_default_exception_handler(val_pe_default_esr);
+    val_pcie_cfg_cache_suspend();
+    val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)set->jobs,
+                                        count * sizeof(rule_parallel_job_t));
+
+    rule_parallel_dispatch(set, pe);
+
+    val_pcie_cfg_cache_resume();
+    val_memory_free(pe);
+}
+
+/**
+ * @brief Release the jobs of the parallel pass. Buffers still referenced by
+ *        a PE that did not finish its rule are left allocated.
+ */
+static void rule_parallel_free(rule_parallel_set_t *set)
+{
+    if (set->count == 0 || set->lost)
+        return;
+
+    val_memory_free_aligned(set->output);
+    val_memory_free_aligned(set->jobs);
+    val_memory_set(set, sizeof(rule_parallel_set_t), 0);
+}
+#else
+static void rule_parallel_run(const acs_run_request_t *ctx, const rule_filter_t *filter,
+                              rule_parallel_set_t *set)
+{
+    (void)ctx;
+    (void)filter;
+    val_memory_set(set, sizeof(rule_parallel_set_t), 0);
+}
+
+static void rule_parallel_free(rule_parallel_set_t *set)
+{
+    (void)set;
+}
+#endif /* TARGET_LINUX */
+
+/**
+ * @brief Take the result of a rule run by the parallel pass.
+ *
+ * Prints the output captured while the rule ran on a secondary PE.
+ *
+ * @param set      Jobs of the parallel pass.
+ * @param rule_id  Rule about to be run by the serial pass.
+ * @param status   On return, the status of the rule.
+ * @param ticks    On return, the virtual counter ticks the rule took.
+ * @return 1 if the rule was run by the parallel pass, 0 if it is still to run.
+ */
+static uint32_t rule_parallel_take(const rule_parallel_set_t *set, RULE_ID_e rule_id,
+                                   uint32_t *status, uint64_t *ticks)
+{
+    const rule_parallel_job_t *job;
+    uint32_t i;
+
+    for (i = 0; i < set->count; i++) {
+        job = &set->jobs[i];
+        if (job->rule_id != rule_id)
+            continue;
+        if (!job->done || !job->ran)
+            return 0;
+
+        if (job->output_len < RULE_PARALLEL_OUTPUT_SIZE) {
+            val_log_replay(job->output, job->output_len);
+        } else {
+            val_log_replay(job->output, RULE_PARALLEL_OUTPUT_SIZE - 1);
+            val_print(WARN, "\n       %d bytes of output not kept",
+                      job->output_len - (RULE_PARALLEL_OUTPUT_SIZE - 1));
         }
+        *status = job->status;
+        *ticks = job->ticks;
+        return 1;
     }
 
     return 0;
@@ -105,9 +429,13 @@ static bool is_rule_skipped(const acs_run_request_t *ctx, RULE_ID_e rule_id)
  * - Rules whose module matches any in ctx->skip_modules are removed.
  * - If ctx->execute_modules is provided and non-empty, only rules whose module
  *   is in that list are kept.
+ * - With an architecture selected (-a), its rules are merged into the list
+ *   first, and the level and BSA software view selections are applied.
  *
- * No new memory is allocated. Elements beyond the returned count remain
- * unchanged but are considered out of range by callers.
+ * The selections and the architecture table are turned into per-rule lookups
+ * first, so the cost is linear in the number of rules. No new memory is
+ * allocated other than for the merged list. Elements beyond the returned count
+ * remain unchanged but are considered out of range by callers.
  *
  * @return New count of rules after filtering.
  */
@@ -115,117 +443,52 @@ uint32_t filter_rule_list_by_cli(acs_run_request_t *ctx)
 {
     uint32_t out;
     uint32_t i;
-    uint32_t si;
-    uint32_t mi;
+    uint32_t new_count;
     RULE_ID_e rule;
-    bool skip;
-    MODULE_NAME_e module;
-    bool found;
-    /* Pointers to lookup tables for selected arch (if any) */
-    const bsa_rule_entry_t   *bsa_tbl   = NULL;
-    const sbsa_rule_entry_t  *sbsa_tbl  = NULL;
-    const pcbsa_rule_entry_t *pcbsa_tbl = NULL;
-    const vbsa_rule_entry_t  *vbsa_tbl  = NULL;
-    const pfdi_rule_entry_t  *pfdi_tbl  = NULL;
-    uint32_t tbl_count = 0;
+    RULE_ID_e *old_list;
+    RULE_ID_e *new_list;
+    bool level_filter;
+    rule_filter_t filter;
+    rule_bitset_t listed;
+    const rule_arch_index_t *arch_index = NULL;
 
     if (ctx == NULL)
         return 0;
 
     /* If architecture is selected (-a), merge its rules into the list, deduped */
-    if (ctx->arch_selection != ARCH_NONE) {
-        uint32_t add_count = 0;
-
-        if (ctx->arch_selection == ARCH_BSA) {
-            /* count BSA entries */
-            while (bsa_rule_list[add_count].rule_id != RULE_ID_SENTINEL)
-                add_count++;
-            bsa_tbl = bsa_rule_list;
-        } else if (ctx->arch_selection == ARCH_SBSA) {
-            while (sbsa_rule_list[add_count].rule_id != RULE_ID_SENTINEL)
-                add_count++;
-            sbsa_tbl = sbsa_rule_list;
-        } else if (ctx->arch_selection == ARCH_PCBSA) {
-            while (pcbsa_rule_list[add_count].rule_id != RULE_ID_SENTINEL)
-                add_count++;
-            pcbsa_tbl = pcbsa_rule_list;
-        } else if (ctx->arch_selection == ARCH_VBSA) {
-            while (vbsa_rule_list[add_count].rule_id != RULE_ID_SENTINEL)
-                add_count++;
-            vbsa_tbl = vbsa_rule_list;
-        } else if (ctx->arch_selection == ARCH_PFDI) {
-            while (pfdi_rule_list[add_count].rule_id != RULE_ID_SENTINEL)
-                add_count++;
-            pfdi_tbl = pfdi_rule_list;
-        }
-
-        if (add_count > 0) {
-            /* Allocate a new buffer sized for worst-case unique merge */
-            RULE_ID_e *old_list = ctx->rule_list;
-            uint32_t old_count = ctx->rule_count;
-            RULE_ID_e *new_list = (RULE_ID_e *)val_memory_alloc((old_count + add_count)
-                                   * sizeof(RULE_ID_e));
-            if (new_list != NULL) {
-                /* Copy existing */
-                for (i = 0; i < old_count; i++) new_list[i] = old_list[i];
-                uint32_t new_count = old_count;
-                /* Append unique entries from table */
-                if (bsa_tbl) {
-                    for (i = 0; i < add_count; i++) {
-                        RULE_ID_e rid = bsa_tbl[i].rule_id;
-                        if (!rule_in_list(rid, new_list, new_count))
-                            new_list[new_count++] = rid;
-                    }
-                } else if (sbsa_tbl) {
-                    for (i = 0; i < add_count; i++) {
-                        RULE_ID_e rid = sbsa_tbl[i].rule_id;
-                        if (!rule_in_list(rid, new_list, new_count))
-                            new_list[new_count++] = rid;
-                    }
-                } else if (pcbsa_tbl) {
-                    for (i = 0; i < add_count; i++) {
-                        RULE_ID_e rid = pcbsa_tbl[i].rule_id;
-                        if (!rule_in_list(rid, new_list, new_count))
-                            new_list[new_count++] = rid;
-                    }
-                } else if (vbsa_tbl) {
-                    for (i = 0; i < add_count; i++) {
-                        RULE_ID_e rid = vbsa_tbl[i].rule_id;
-                        if (!rule_in_list(rid, new_list, new_count))
-                            new_list[new_count++] = rid;
-                    }
-                } else if (pfdi_tbl) {
-                    for (i = 0; i < add_count; i++) {
-                        RULE_ID_e rid = pfdi_tbl[i].rule_id;
-                        if (!rule_in_list(rid, new_list, new_count))
-                            new_list[new_count++] = rid;
-                    }
+    if (ctx->arch_selection != ARCH_NONE)
+        arch_index = rule_arch_index_get(ctx->arch_selection);
+
+    if (arch_index != NULL && arch_index->count > 0) {
+        /* Allocate a new buffer sized for worst-case unique merge */
+        old_list = ctx->rule_list;
+        new_list = (RULE_ID_e *)val_memory_alloc((ctx->rule_count + arch_index->count)
+                                                 * sizeof(RULE_ID_e));
+        if (new_list != NULL) {
+            val_memory_set(&listed, sizeof(listed), 0);
+
+            /* Copy existing */
+            for (i = 0; i < ctx->rule_count; i++) {
+                new_list[i] = old_list[i];
+                if (old_list[i] < RULE_ID_SENTINEL)
+                    rule_bitset_set(&listed, old_list[i]);
+            }
+            new_count = ctx->rule_count;
+
+            /* Append unique entries from table */
+            for (i = 0; i < arch_index->count; i++) {
+                rule = arch_index->order[i];
+                if (!rule_bitset_test(&listed, rule)) {
+                    rule_bitset_set(&listed, rule);
+                    new_list[new_count++] = rule;
                 }
-
-                if (ctx->rule_list_owned && old_list != NULL)
-                    val_memory_free(old_list);
-                ctx->rule_list = new_list;
-                ctx->rule_count = new_count;
-                ctx->rule_list_owned = true;
             }
-        }
 
-        /* Also capture the selected table pointer and count for filtering by level */
-        if (ctx->arch_selection == ARCH_BSA) {
-            bsa_tbl = bsa_rule_list;
-            while (bsa_tbl[tbl_count].rule_id != RULE_ID_SENTINEL) tbl_count++;
-        } else if (ctx->arch_selection == ARCH_SBSA) {
-            sbsa_tbl = sbsa_rule_list;
-            while (sbsa_tbl[tbl_count].rule_id != RULE_ID_SENTINEL) tbl_count++;
-        } else if (ctx->arch_selection == ARCH_PCBSA) {
-            pcbsa_tbl = pcbsa_rule_list;
-            while (pcbsa_tbl[tbl_count].rule_id != RULE_ID_SENTINEL) tbl_count++;
-        } else if (ctx->arch_selection == ARCH_VBSA) {
-            vbsa_tbl = vbsa_rule_list;
-            while (vbsa_tbl[tbl_count].rule_id != RULE_ID_SENTINEL) tbl_count++;
-        } else if (ctx->arch_selection == ARCH_PFDI) {
-            pfdi_tbl = pfdi_rule_list;
-            while (pfdi_tbl[tbl_count].rule_id != RULE_ID_SENTINEL) tbl_count++;
+            if (ctx->rule_list_owned && old_list != NULL)
+                val_memory_free(old_list);
+            ctx->rule_list = new_list;
+            ctx->rule_count = new_count;
+            ctx->rule_list_owned = true;
         }
     }
 
@@ -233,155 +496,26 @@ uint32_t filter_rule_list_by_cli(acs_run_request_t *ctx)
     if (ctx->rule_list == NULL || ctx->rule_count == 0)
         return 0;
 
+    rule_filter_init(ctx, &filter);
+
+    /* Level-based filtering and software view filtering (BSA) */
+    level_filter = (arch_index != NULL) &&
+                   ((ctx->level_filter_mode != LVL_FILTER_NONE) ||
+                    (ctx->arch_selection == ARCH_BSA && ctx->bsa_sw_view_mask != 0));
+
     out = 0;
     for (i = 0; i < ctx->rule_count; i++) {
         rule = ctx->rule_list[i];
-        skip = 0;
-
-        /* Skip explicit rule IDs provided via -skip */
-        if (!skip && ctx->skip_rule_count > 0 && ctx->skip_rule_list != NULL) {
-            for (si = 0; si < ctx->skip_rule_count; si++) {
-                if (ctx->skip_rule_list[si] == rule) {
-                    skip = 1;
-                    break;
-                }
-            }
-        }
-
-        module = rule_test_map[rule].module_id;
-
-        /* Skip rules belonging to modules listed in -skipmodule */
-        if (!skip && ctx->num_skip_modules > 0 && ctx->skip_modules != NULL) {
-            for (mi = 0; mi < ctx->num_skip_modules; mi++) {
-                if (ctx->skip_modules[mi] == (uint32_t)module) {
-                    skip = 1;
-                    break;
-                }
-            }
-        }
-
-        /* If -m provided, keep only selected modules */
-        if (!skip && ctx->num_modules > 0 && ctx->execute_modules != NULL) {
-            found = 0;
-            for (mi = 0; mi < ctx->num_modules; mi++) {
-                if (ctx->execute_modules[mi] == (uint32_t)module) {
-                    found = 1;
-                    break; }
-            }
-            if (!found)
-                skip = 1;
-        }
 
-        /* Level-based filtering and software view filtering (BSA) */
-        if (!skip && ctx->arch_selection != ARCH_NONE) {
-            if (ctx->level_filter_mode != LVL_FILTER_NONE ||
-                (ctx->arch_selection == ARCH_BSA && ctx->bsa_sw_view_mask != 0)) {
-                /* Find rule in the selected arch table */
-                bool found_entry = 0;
-                if (bsa_tbl) {
-                    for (uint32_t ti = 0; ti < tbl_count; ti++) {
-                        if (bsa_tbl[ti].rule_id == rule) {
-                            found_entry = 1;
-                            /* Software view filter if requested: keep if any selected */
-                            if (ctx->bsa_sw_view_mask != 0) {
-                                uint32_t bit = (1u << (uint32_t)bsa_tbl[ti].sw_view);
-                                if ((ctx->bsa_sw_view_mask & bit) == 0) {
-                                    skip = 1;
-                                    break;
-                                }
-                            }
-                            /* Level filtering */
-                            if (ctx->level_filter_mode == LVL_FILTER_FR) {
-                                /* Treat FR mode as MAX up to FR */
-                                if ((uint32_t)bsa_tbl[ti].level > (uint32_t)BSA_LEVEL_FR)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_ONLY) {
-                                if ((uint32_t)bsa_tbl[ti].level != ctx->level_value)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_MAX) {
-                                if ((uint32_t)bsa_tbl[ti].level > ctx->level_value)
-                                    skip = 1;
-                            }
-                            break;
-                        }
-                    }
-                } else if (sbsa_tbl) {
-                    for (uint32_t ti = 0; ti < tbl_count; ti++) {
-                        if (sbsa_tbl[ti].rule_id == rule) {
-                            found_entry = 1;
-                            if (ctx->level_filter_mode == LVL_FILTER_FR) {
-                                /* Treat FR mode as MAX up to FR */
-                                if ((uint32_t)sbsa_tbl[ti].level > (uint32_t)SBSA_LEVEL_FR)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_ONLY) {
-                                if ((uint32_t)sbsa_tbl[ti].level != ctx->level_value)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_MAX) {
-                                if ((uint32_t)sbsa_tbl[ti].level > ctx->level_value)
-                                    skip = 1;
-                            }
-                            break;
-                        }
-                    }
-                } else if (pcbsa_tbl) {
-                    for (uint32_t ti = 0; ti < tbl_count; ti++) {
-                        if (pcbsa_tbl[ti].rule_id == rule) {
-                            found_entry = 1;
-                            if (ctx->level_filter_mode == LVL_FILTER_FR) {
-                                /* Treat FR mode as MAX up to FR */
-                                if ((uint32_t)pcbsa_tbl[ti].level > (uint32_t)PCBSA_LEVEL_FR)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_ONLY) {
-                                if ((uint32_t)pcbsa_tbl[ti].level != ctx->level_value)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_MAX) {
-                                if ((uint32_t)pcbsa_tbl[ti].level > ctx->level_value)
-                                    skip = 1;
-                            }
-                            break;
-                        }
-                    }
-                } else if (vbsa_tbl) {
-                    for (uint32_t ti = 0; ti < tbl_count; ti++) {
-                        if (vbsa_tbl[ti].rule_id == rule) {
-                            found_entry = 1;
-                            if (ctx->level_filter_mode == LVL_FILTER_FR) {
-                                /* Treat FR mode as MAX up to FR */
-                                if ((uint32_t)vbsa_tbl[ti].level > (uint32_t)VBSA_LEVEL_FR)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_ONLY) {
-                                if ((uint32_t)vbsa_tbl[ti].level != ctx->level_value)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_MAX) {
-                                if ((uint32_t)vbsa_tbl[ti].level > ctx->level_value)
-                                    skip = 1;
-                            }
-                            break;
-                        }
-                    }
-                } else if (pfdi_tbl) {
-                    for (uint32_t ti = 0; ti < tbl_count; ti++) {
-                        if (pfdi_tbl[ti].rule_id == rule) {
-                            found_entry = 1;
-                            if (ctx->level_filter_mode == LVL_FILTER_ONLY) {
-                                if ((uint32_t)pfdi_tbl[ti].level != ctx->level_value)
-                                    skip = 1;
-                            } else if (ctx->level_filter_mode == LVL_FILTER_MAX) {
-                                if ((uint32_t)pfdi_tbl[ti].level > ctx->level_value)
-                                    skip = 1;
-                            }
-                            break;
-                        }
-                    }
-                }
+        /* -skip and -skipmodule, then -m */
+        if (rule_filter_skips(&filter, rule) || !rule_filter_module_selected(&filter, rule))
+            continue;
 
-                /* If not found in table, conservatively skip or keep? Keep by default */
-                (void)found_entry; /* silence unused if not used */
-            }
-        }
+        /* Rules missing from the arch table are kept */
+        if (level_filter && !rule_arch_level_selected(arch_index, ctx, rule))
+            continue;
 
-        if (!skip)
-            ctx->rule_list[out++] = rule;
+        ctx->rule_list[out++] = rule;
     }
 
     ctx->rule_count = out;
@@ -414,6 +548,12 @@ run_tests(const acs_run_request_t *ctx)
     RULE_ID_e *base_rule_list;
     RULE_ID_e *rule_list;
     uint32_t list_size;
+    uint32_t profile;
+    rule_profile_sample_t rule_sample;
+    rule_profile_sample_t sub_sample;
+    rule_parallel_set_t parallel;
+    uint64_t parallel_ticks;
+    rule_filter_t filter;
 
     if (ctx == NULL || ctx->rule_list == NULL || ctx->rule_count == 0)
         return;
@@ -426,12 +566,22 @@ run_tests(const acs_run_request_t *ctx)
     /* Initialize per-rule status map to TEST_STATUS_UNKNOWN for this run */
     rule_status_map_reset();
 
+    profile = acs_policy_get_rule_profile();
+    if (profile)
+        rule_profile_reset();
+
     /* Get number of PEs in the system */
     num_pe = val_pe_get_num();
 
     /* quick sort the rule list so that it is module wise as in RULE_ID_e typedef definition */
     quick_sort_rule_list(rule_list, list_size);
 
+    /* -skip and -skipmodule also apply to the base rules of alias rules */
+    rule_filter_init(ctx, &filter);
+
+    /* With -ruleparallel, run the parallel-safe rules ahead on secondary PEs */
+    rule_parallel_run(ctx, &filter, &parallel);
+
     for (i = 0 ; i < list_size; i++) {
         /* Invalid  rule_test_map entry check */
         // if (rule_test_map[rule_list[i]].flag == INVALID_ENTRY) {
@@ -453,6 +603,9 @@ run_tests(const acs_run_request_t *ctx)
         /* Print rule header */
         print_rule_test_start(rule_list[i], 0);
 
+        if (profile)
+            rule_profile_start(&rule_sample);
+
         /* Report rule ids not supported by ACS or doesn't have mapping rule_test_map */
         if (rule_support_status != TEST_SUPPORTED) {
             rule_status_map[rule_list[i]] = rule_support_status;
@@ -480,9 +633,15 @@ run_tests(const acs_run_request_t *ctx)
                function to do the precheck, if NULL_ENTRY then consider no precheck for
                the ALIAS */
             if (rule_test_map[rule_list[i]].test_entry_id != NULL_ENTRY) {
+                if (profile)
+                    rule_profile_start(&sub_sample);
+
                 precheck_status =
                     test_entry_func_table[rule_test_map[rule_list[i]].test_entry_id](num_pe);
 
+                if (profile)
+                    rule_profile_precheck_stop(rule_list[i], &sub_sample);
+
                 /* If precheck fails, report alias rule status as SKIP as it wont be applicable */
                 if ((GET_STATE(precheck_status) == TEST_FAIL)) {
                     rule_test_status = RESULT_SKIP(0);
@@ -518,7 +677,7 @@ run_tests(const acs_run_request_t *ctx)
 #endif
                 /* -skip and -skipmodule only apply to initial rule list; ensure
                    base rules of an alias honor these selections here. */
-                if (is_rule_skipped(ctx, base_rule_list[j])) {
+                if (rule_filter_skips(&filter, base_rule_list[j])) {
                     /* Skip executing this base rule as per CLI selection */
                     continue;
                 }
@@ -538,7 +697,19 @@ run_tests(const acs_run_request_t *ctx)
 
                 /* Run the base rule */
                 base_rule_id = alias_rule_map[alias_rule_map_index].base_rule_list[j];
-                if (test_entry_func_table[rule_test_map[base_rule_id].test_entry_id] != NULL)
+                if (profile)
+                    rule_profile_start(&sub_sample);
+
+                if (rule_parallel_take(&parallel, base_rule_id, &base_rule_status,
+                                       &parallel_ticks))
+                {
+                    /* Account the time the rule took on the secondary PE */
+                    if (profile) {
+                        sub_sample.start -= parallel_ticks;
+                        rule_sample.start -= parallel_ticks;
+                    }
+                }
+                else if (test_entry_func_table[rule_test_map[base_rule_id].test_entry_id] != NULL)
                 {
                     base_rule_status =
                         test_entry_func_table[rule_test_map[base_rule_id].test_entry_id](num_pe);
@@ -548,6 +719,9 @@ run_tests(const acs_run_request_t *ctx)
                     val_print(ERROR, "\n\n  Rule failed due to NULL entry \n\r ", 0);
                     base_rule_status = RESULT_FAIL(1);
                 }
+
+                if (profile)
+                    rule_profile_stop(base_rule_id, &sub_sample, 0);
                 /* record base rule status */
                 rule_status_map[base_rule_id] = base_rule_status;
                 if (GET_STATE(base_rule_status) == TEST_PASS)
@@ -586,7 +760,12 @@ run_tests(const acs_run_request_t *ctx)
 
         } else if (rule_test_map[rule_list[i]].flag == BASE_RULE) {
             /* Base rule would have single test entry, could be wrapper too */
-           if (test_entry_func_table[rule_test_map[rule_list[i]].test_entry_id] != NULL)
+            if (rule_parallel_take(&parallel, rule_list[i], &rule_test_status, &parallel_ticks))
+            {
+                if (profile)
+                    rule_sample.start -= parallel_ticks;
+            }
+            else if (test_entry_func_table[rule_test_map[rule_list[i]].test_entry_id] != NULL)
             {
                 rule_test_status =
                     test_entry_func_table[rule_test_map[rule_list[i]].test_entry_id](num_pe);
@@ -602,7 +781,14 @@ report_status:
         rule_status_map[rule_list[i]] = rule_test_status;
         print_rule_test_status(rule_list[i], 0, rule_test_status);
 
+        if (profile)
+            rule_profile_stop(rule_list[i], &rule_sample, 1);
     }
     val_print(INFO,
               "\n-------------------- Suite run complete --------------------\n");
+
+    rule_parallel_free(&parallel);
+
+    if (profile)
+        rule_profile_report(num_pe);
 }
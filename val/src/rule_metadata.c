@@ -49,6 +49,12 @@
  */
 uint32_t rule_status_map[RULE_ID_SENTINEL] = { 0 };
 
+/*
+ * Per-rule profile map, indexed by RULE_ID_e. Only filled when the rule_profile
+ * execution policy is set; see rule_profile_reset() and rule_profile_report().
+ */
+rule_profile_t rule_profile_map[RULE_ID_SENTINEL];
+
 /* The variable is used for special cases where a RULE needs to call
  * different set of entry functions depending on base rule it is been
  * called under, ex PCI_LI_01 needs to run only pci test when called
@@ -847,6 +853,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_MEMORY_MAP_TEST_NUM_BASE + 3,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [S_L3MM_01] = {
             .test_entry_id    = M005_ENTRY,
@@ -855,6 +862,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_MEMORY_MAP_TEST_NUM_BASE + 5,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [S_L3MM_02] = {
             .test_entry_id    = M008_ENTRY,
@@ -863,6 +871,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_MEMORY_MAP_TEST_NUM_BASE + 8,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
     /* PMU */
         [PMU_PE_01] = {
@@ -1715,6 +1724,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_PCIE_TEST_NUM_BASE + 10,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [PCI_ER_04] = {
             .test_entry_id    = E023_ENTRY,
@@ -1731,6 +1741,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_PCIE_TEST_NUM_BASE + 7,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [PCI_ER_06] = {
             .test_entry_id    = E024_ENTRY,
@@ -1794,6 +1805,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI | PLATFORM_LINUX,
             .flag             = BASE_RULE,
             .test_num         = ACS_PCIE_TEST_NUM_BASE + 1,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [PCI_IN_02] = {
             .test_entry_id    = P002_ENTRY,
@@ -1810,6 +1822,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_PCIE_TEST_NUM_BASE + 38,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [PCI_IN_04] = {
             .test_entry_id    = PCI_IN_04_ENTRY,
@@ -1885,6 +1898,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_PCIE_TEST_NUM_BASE + 9,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [PCI_LI_01] = {
             .test_entry_id    = PCI_LI_01_ENTRY,
@@ -1952,6 +1966,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_PCIE_TEST_NUM_BASE + 39,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [PCI_MSI_2] = {
             .test_entry_id    = PCI_MSI_2_ENTRY,
@@ -2013,6 +2028,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_PCIE_TEST_NUM_BASE + 87,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [RE_ACS_1] = {
             .test_entry_id    = P015_ENTRY,
@@ -2053,6 +2069,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_PCIE_TEST_NUM_BASE + 69,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [RI_ORD_1] = {
             .test_entry_id    = E021_ENTRY,
@@ -2085,6 +2102,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_PCIE_TEST_NUM_BASE + 84,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [RI_PWR_1] = {
             .test_entry_id    = P070_ENTRY,
@@ -2093,6 +2111,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_PCIE_TEST_NUM_BASE + 70,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [RE_REC_1] = {
             .test_entry_id    = RE_REC_1_ENTRY,
@@ -2218,6 +2237,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_PCIE_TEST_NUM_BASE + 100,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         [S_PCIe_10] = {
             .test_entry_id    = NULL_ENTRY,
@@ -2521,6 +2541,7 @@ rule_test_map_t rule_test_map[RULE_ID_SENTINEL] = {
             .platform_bitmask = PLATFORM_BAREMETAL | PLATFORM_UEFI,
             .flag             = BASE_RULE,
             .test_num         = ACS_PCIE_TEST_NUM_BASE + 87,
+            .exec_flags       = RULE_EXEC_PARALLEL_SAFE,
         },
         /* VBSA ACS entries */
         [V_L1PE_01] = {
@@ -4915,44 +4936,62 @@ RULE_ID_e v_l1pr_02_rule_list[]   = {
 
                                      RULE_ID_SENTINEL};
 
-const alias_rule_map_t alias_rule_map[] = {
-    /* BSA alias rules */
-    {B_WD_00,   b_wd_00_rule_list},
-    {B_PER_08,  b_per_08_rule_list},
-    {JKZMT,     jkzmt_rule_list},
-    {B_REP_1,   b_rep_1_rule_list},
-    {HVZJY,     hvzjy_rule_list},
-    {IE_CFG_3,  ie_cfg_3_rule_list},
-    {B_IEP_1,   b_iep_1_rule_list},
-    {B_SMMU_21, b_smmu_21_rule_list},
-
-    /* SBSA alias rules */
-    {S_L3_01,   bsa_l1_rule_list},
-    {S_L3PR_01, s_l3pr_01_rule_list},
-    {S_L3WD_01, s_l3wd_01_rule_list},
-    {S_L6PCI_1, s_l6pci_1_rule_list},
-    {S_L6PE_01, s_l6pe_01_rule_list},
-    {S_PCIe_10, s_pcie_10_rule_list},
-    {S_L7PMU,   s_l7pmu_rule_list},
-    {S_L8SHD_1, s_l8shd_1_rule_list},
-    {SYS_RAS,   sys_ras_rule_list},
-    {LVQBC,     lvqbc_rule_list},
-    {S_L8CXL_1, s_l8cxl_rule_list},
-    {XDGKZ,     xdgkz_rule_list},
+/*
+ * Alias rules and their base rule lists. Every entry is checked at build time:
+ * the alias must be a rule ID, its base rule list must hold at least one rule
+ * before the sentinel, and an alias may appear only once.
+ */
+#define ALIAS_RULE_MAP(X)             \
+    /* BSA alias rules */             \
+    X(B_WD_00,   b_wd_00_rule_list)   \
+    X(B_PER_08,  b_per_08_rule_list)  \
+    X(JKZMT,     jkzmt_rule_list)     \
+    X(B_REP_1,   b_rep_1_rule_list)   \
+    X(HVZJY,     hvzjy_rule_list)     \
+    X(IE_CFG_3,  ie_cfg_3_rule_list)  \
+    X(B_IEP_1,   b_iep_1_rule_list)   \
+    X(B_SMMU_21, b_smmu_21_rule_list) \
+    /* SBSA alias rules */            \
+    X(S_L3_01,   bsa_l1_rule_list)    \
+    X(S_L3PR_01, s_l3pr_01_rule_list) \
+    X(S_L3WD_01, s_l3wd_01_rule_list) \
+    X(S_L6PCI_1, s_l6pci_1_rule_list) \
+    X(S_L6PE_01, s_l6pe_01_rule_list) \
+    X(S_PCIe_10, s_pcie_10_rule_list) \
+    X(S_L7PMU,   s_l7pmu_rule_list)   \
+    X(S_L8SHD_1, s_l8shd_1_rule_list) \
+    X(SYS_RAS,   sys_ras_rule_list)   \
+    X(LVQBC,     lvqbc_rule_list)     \
+    X(S_L8CXL_1, s_l8cxl_rule_list)   \
+    X(XDGKZ,     xdgkz_rule_list)     \
+    /* PCBSA alias rules */           \
+    X(P_L1_01,   bsa_l1_rule_list)    \
+    X(P_L2WD_01, p_l2wd_01_rule_list) \
+    X(P_L1MM_01, p_l1mm_01_rule_list) \
+    /* VBSA alias rules */            \
+    X(V_L1PE_01, v_l1pe_01_rule_list) \
+    X(V_L1MM_01, v_l1mm_01_rule_list) \
+    X(V_L1GI_01, v_l1gi_01_rule_list) \
+    X(V_L1SM_01, v_l1sm_01_rule_list) \
+    X(V_L1PR_01, v_l1pr_01_rule_list) \
+    X(V_L1PR_02, v_l1pr_02_rule_list)
 
-    /* PCBSA alias rules */
-    {P_L1_01,   bsa_l1_rule_list},
-    {P_L2WD_01, p_l2wd_01_rule_list},
-    {P_L1MM_01, p_l1mm_01_rule_list},
+#define ALIAS_RULE_MAP_ENTRY(alias, list)   {alias, list},
+#define ALIAS_RULE_MAP_CHECK(alias, list)                                   \
+    static_assert((alias) < RULE_ID_SENTINEL, #alias " is not a rule ID");  \
+    static_assert(sizeof(list) >= 2 * sizeof(RULE_ID_e), #list " has no base rule");
+/* A second entry for an alias redeclares its enumerator */
+#define ALIAS_RULE_MAP_UNIQUE(alias, list)  alias_rule_map_has_##alias,
 
-    /* VBSA alias rules */
-    {V_L1PE_01, v_l1pe_01_rule_list},
-    {V_L1MM_01, v_l1mm_01_rule_list},
-    {V_L1GI_01, v_l1gi_01_rule_list},
-    {V_L1SM_01, v_l1sm_01_rule_list},
-    {V_L1PR_01, v_l1pr_01_rule_list},
-    {V_L1PR_02, v_l1pr_02_rule_list},
+ALIAS_RULE_MAP(ALIAS_RULE_MAP_CHECK)
+enum { ALIAS_RULE_MAP(ALIAS_RULE_MAP_UNIQUE) };
 
+const alias_rule_map_t alias_rule_map[] = {
+    ALIAS_RULE_MAP(ALIAS_RULE_MAP_ENTRY)
 };
 
 const uint32_t alias_rule_map_count = sizeof(alias_rule_map) / sizeof(alias_rule_map[0]);
+
+/* alias_rule_map_get_index() keeps index + 1 in 16 bits per rule */
+static_assert(sizeof(alias_rule_map) / sizeof(alias_rule_map[0]) < 0xFFFF,
+              "alias_rule_map too large for the alias rule index");
@@ -6,19 +6,48 @@
  */
 
 #include "val_logger.h"
+#ifndef TARGET_LINUX
+#include "acs_execution_policy.h"
+#include "val_interface.h"
+#include "acs_memory.h"
+#endif
 
 enum { LOG_MAX_STRING_LENGTH = 90 };
 
-static bool collect_log_output;
-static char collected_log[LOG_MAX_STRING_LENGTH * 2];
-static size_t collected_log_len;
-
-static void val_putc(char c)
+/*
+ * Line assembly state of val_printf. Payloads may log on several PEs at once,
+ * so each PE gets its own context once val_log_init() has run; until then only
+ * the primary PE runs and uses log_boot_ctx.
+ */
+typedef struct log_ring log_ring;
+
+typedef struct {
+    bool     collect;
+    char     collected[LOG_MAX_STRING_LENGTH * 2];
+    size_t   collected_len;
+    char     prev;
+    bool     last_was_newline;
+    bool     prefix_printed;
+    log_ring *ring;           /* secondary PEs: output goes here, not to the UART */
+    char     *capture;        /* val_log_capture_start(): output goes here instead */
+    uint32_t capture_size;
+    uint32_t capture_len;     /* bytes produced, may exceed capture_size */
+    uint32_t seq;             /* binary trace records made, orders ring and trace output */
+} log_ctx;
+
+#define LOG_NO_PE         0xFFFFFFFFu
+#define LOG_CACHE_LINE    64
+#define LOG_RING_ALIGN    16
+
+static log_ctx log_boot_ctx = { .last_was_newline = true };
+static log_ctx *log_pe_ctx;
+
+static void val_putc(log_ctx *ctx, char c)
 {
-    if (collect_log_output) {
-        if (collected_log_len + 1 < sizeof(collected_log)) {
-            collected_log[collected_log_len++] = c;
-            collected_log[collected_log_len] = '\0';
+    if (ctx->collect) {
+        if (ctx->collected_len + 1 < sizeof(ctx->collected)) {
+            ctx->collected[ctx->collected_len++] = c;
+            ctx->collected[ctx->collected_len] = '\0';
         }
         return;
     }
@@ -88,26 +117,28 @@ char log_buffer[LOG_BUFFER_SIZE];
 
 /**
  *   @brief    - Stores a character in a log buffer and outputs it via 'val_putc'
- *   @param    - c  : Input Character
+ *   @param    - ctx: Logging context of the calling PE
+ *             - c  : Input Character
  *   @return   - Sends the character using 'val_putc'
  **/
 
-static void log_putchar(char c)
+static void log_putchar(log_ctx *ctx, char c)
 {
-    static char prev;
-
-    log_buffer[log_buffer_offset] = c;
-    log_buffer_offset = (log_buffer_offset + 1) % LOG_BUFFER_SIZE;
+    /* The shared log_buffer is only fed from the primary PE */
+    if (ctx->ring == NULL) {
+        log_buffer[log_buffer_offset] = c;
+        log_buffer_offset = (log_buffer_offset + 1) % LOG_BUFFER_SIZE;
+    }
 
     /* If we are about to print '\n' and the previous char wasn't '\r',
      * inject '\r' so UART terminals go back to column 0. */
-    if (c == '\n' && prev != '\r') {
+    if (c == '\n' && ctx->prev != '\r') {
         char cr = '\r';
-        val_putc(cr);
+        val_putc(ctx, cr);
     }
 
-    val_putc(c);
-    prev = c;
+    val_putc(ctx, c);
+    ctx->prev = c;
 }
 
 /**
@@ -135,16 +166,17 @@ static size_t log_strnlen_s(const char *str, size_t strsz)
 
 /**
  *   @brief    - Prints a literal string (i.e. '%' is not interpreted specially) to the debug log
- *   @param    - str    : Input literal String
+ *   @param    - ctx    : Logging context of the calling PE
+ *             - str    : Input literal String
  *   @return   - Number of characters written
  **/
 
-static size_t print_raw_string(const char *str)
+static size_t print_raw_string(log_ctx *ctx, const char *str)
 {
     const char *c = str;
 
     for (; *c != '\0'; c++) {
-        log_putchar(*c);
+        log_putchar(ctx, *c);
     }
 
     return (size_t)(c - str);
@@ -152,14 +184,15 @@ static size_t print_raw_string(const char *str)
 
 /**
  *   @brief    - Prints a formatted string to the debug log
- *   @param    - str        : The full String
+ *   @param    - ctx        : Logging context of the calling PE
+ *             - str        : The full String
  *             - suffix     : Pointer within str that indicates where suffix begins
  *             - min_width  : Minimum width
  *             - flags      : Whether to align to left or right
  *             - fill       : The fill character
  *   @return   - Number of characters written
  **/
-static size_t print_string(const char *str, const char *suffix,
+static size_t print_string(log_ctx *ctx, const char *str, const char *suffix,
                int min_width, struct format_flags *flags,
                char fill)
 {
@@ -172,14 +205,14 @@ static size_t print_string(const char *str, const char *suffix,
         /* Left-aligned: prefix + suffix, then pad with spaces */
         while (str != suffix) {
             chars_written++;
-            log_putchar(*str++);
+            log_putchar(ctx, *str++);
         }
 
-        chars_written += print_raw_string(suffix);
+        chars_written += print_raw_string(ctx, suffix);
 
         while (total_len < (size_t)min_width) {
             chars_written++;
-            log_putchar(' ');
+            log_putchar(ctx, ' ');
             total_len++;
         }
         return chars_written;
@@ -190,45 +223,46 @@ static size_t print_string(const char *str, const char *suffix,
         /* Space padding goes BEFORE prefix/sign */
         while (total_len < (size_t)min_width) {
             chars_written++;
-            log_putchar(' ');
+            log_putchar(ctx, ' ');
             total_len++;
         }
 
         /* Now print prefix and suffix */
         while (str != suffix) {
             chars_written++;
-            log_putchar(*str++);
+            log_putchar(ctx, *str++);
         }
-        chars_written += print_raw_string(suffix);
+        chars_written += print_raw_string(ctx, suffix);
         return chars_written;
     }
 
     /* Zero padding (or other fill) goes AFTER prefix, BEFORE digits */
     while (str != suffix) {
         chars_written++;
-        log_putchar(*str++);
+        log_putchar(ctx, *str++);
     }
 
     while (total_len < (size_t)min_width) {
         chars_written++;
-        log_putchar(fill);
+        log_putchar(ctx, fill);
         total_len++;
     }
 
-    chars_written += print_raw_string(suffix);
+    chars_written += print_raw_string(ctx, suffix);
     return chars_written;
 }
 
 /**
  *   @brief    - Prints an integer to the debug log
- *   @param    - value      : Integer to be formatted and printed
+ *   @param    - ctx        : Logging context of the calling PE
+ *             - value      : Integer to be formatted and printed
  *             - base       : Base of the integer
  *             - min_width  : Minimum width of the integer
  *             - flags      : Printf-style flags
  *   @return   - Number of characters written
  **/
 
-static size_t print_int(size_t value, enum format_base base, int min_width,
+static size_t print_int(log_ctx *ctx, size_t value, enum format_base base, int min_width,
             struct format_flags *flags)
 {
     static const char *digits_lower = "0123456789abcdefxb";
@@ -281,7 +315,7 @@ static size_t print_int(size_t value, enum format_base base, int min_width,
     } else if (flags->space) {
         *--ptr = ' ';
     }
-    return print_string(ptr, num, min_width, flags, flags->zero ? '0' : ' ');
+    return print_string(ctx, ptr, num, min_width, flags, flags->zero ? '0' : ' ');
 }
 
 /**
@@ -477,12 +511,13 @@ static uint64_t reinterpret_signed_int(enum format_length length, uint64_t value
 
 /**
  *   @brief    - This function parses and formats a string according to specified format specifiers
- *   @param    - fmt      : Input String
+ *   @param    - ctx      : Logging context of the calling PE
+ *             - fmt      : Input String
  *             - args     : Arguments are passed as a va_list
  *   @return   - Number of characters written, or `-1` if format string is invalid
  **/
 
-static int val_log(const char *fmt, va_list args)
+static int val_log(log_ctx *ctx, const char *fmt, va_list args)
 {
     int chars_written = 0;
 
@@ -490,7 +525,7 @@ static int val_log(const char *fmt, va_list args)
         switch (*fmt) {
         default:
             chars_written++;
-            log_putchar(*fmt);
+            log_putchar(ctx, *fmt);
             fmt++;
             break;
 
@@ -515,14 +550,14 @@ static int val_log(const char *fmt, va_list args)
             case '%':
                 fmt++;
                 chars_written++;
-                log_putchar('%');
+                log_putchar(ctx, '%');
                 break;
 
             case 'c': {
                 char str[2] = {(char)va_arg(args, int), 0};
 
                 fmt++;
-                chars_written += print_string(
+                chars_written += print_string(ctx,
                     str, str, min_width, &flags, ' ');
                 break;
             }
@@ -533,7 +568,7 @@ static int val_log(const char *fmt, va_list args)
                     str = "(null)";
 
                 fmt++;
-                chars_written += print_string(
+                chars_written += print_string(ctx,
                     str, str, min_width, &flags, ' ');
                 break;
             }
@@ -551,7 +586,7 @@ static int val_log(const char *fmt, va_list args)
                 value = reinterpret_signed_int(length, value,
                                    &flags);
 
-                chars_written += print_int(value, base10,
+                chars_written += print_int(ctx, value, base10,
                                min_width, &flags);
                 break;
             }
@@ -567,7 +602,7 @@ static int val_log(const char *fmt, va_list args)
                  }
                 value = reinterpret_unsigned_int(length, value);
 
-                chars_written += print_int(value, base2,
+                chars_written += print_int(ctx, value, base2,
                                min_width, &flags);
                 break;
 
@@ -583,7 +618,7 @@ static int val_log(const char *fmt, va_list args)
                 }
                 value = reinterpret_unsigned_int(length, value);
 
-                chars_written += print_int(value, base2,
+                chars_written += print_int(ctx, value, base2,
                                min_width, &flags);
                 break;
 
@@ -598,7 +633,7 @@ static int val_log(const char *fmt, va_list args)
                 }
                 value = reinterpret_unsigned_int(length, value);
 
-                chars_written += print_int(value, base8,
+                chars_written += print_int(ctx, value, base8,
                                min_width, &flags);
                 break;
 
@@ -613,7 +648,7 @@ static int val_log(const char *fmt, va_list args)
                 }
                 value = reinterpret_unsigned_int(length, value);
 
-                chars_written += print_int(value, base16,
+                chars_written += print_int(ctx, value, base16,
                                min_width, &flags);
                 break;
 
@@ -629,7 +664,7 @@ static int val_log(const char *fmt, va_list args)
                 }
                 value = reinterpret_unsigned_int(length, value);
 
-                chars_written += print_int(value, base16,
+                chars_written += print_int(ctx, value, base16,
                                min_width, &flags);
                 break;
 
@@ -644,7 +679,7 @@ static int val_log(const char *fmt, va_list args)
                 }
                 value = reinterpret_unsigned_int(length, value);
 
-                chars_written += print_int(value, base10,
+                chars_written += print_int(ctx, value, base10,
                                min_width, &flags);
                 break;
 
@@ -655,7 +690,7 @@ static int val_log(const char *fmt, va_list args)
                 flags.zero = true;
                 flags.alt = true;
 
-                chars_written += print_int(value, base16,
+                chars_written += print_int(ctx, value, base16,
                                min_width, &flags);
                 break;
 
@@ -671,6 +706,1182 @@ out:
     return chars_written;
 }
 
+#ifndef TARGET_LINUX
+static uint32_t log_num_pe;
+static uint32_t log_primary_index;
+static uint64_t log_primary_mpid;
+
+/**
+ *   @brief    - Returns the index of the calling PE for the per-PE log state
+ *   @param    - None
+ *   @return   - PE index, or LOG_NO_PE before val_log_init()
+ **/
+
+static uint32_t log_pe_index(void)
+{
+    uint64_t mpid;
+    uint32_t index;
+
+    if (log_num_pe == 0)
+        return LOG_NO_PE;
+
+    mpid = val_pe_get_mpid();
+    if (mpid == log_primary_mpid)
+        return log_primary_index;
+
+    index = val_pe_get_index_mpid(mpid);
+    if (index >= log_num_pe)
+        return LOG_NO_PE;
+
+    return index;
+}
+
+/**
+ *   @brief    - Returns the logging context of the calling PE
+ *   @param    - None
+ *   @return   - Per-PE context, or the boot context before val_log_init()
+ **/
+
+static log_ctx *log_ctx_self(void)
+{
+    uint32_t index = log_pe_index();
+
+    if (log_pe_ctx == NULL || index == LOG_NO_PE)
+        return &log_boot_ctx;
+
+    return &log_pe_ctx[index];
+}
+
+static log_ctx *log_primary_ctx(void)
+{
+    return (log_pe_ctx != NULL) ? &log_pe_ctx[log_primary_index] : &log_boot_ctx;
+}
+
+/*
+ * Per-PE text rings. Output of val_printf on a secondary PE is not written to
+ * the UART: each formatted chunk is queued with its CNTVCT timestamp in a
+ * single-producer/single-consumer ring owned by that PE. The primary PE drains
+ * all rings in timestamp order at test boundaries and while waiting for a
+ * payload, and prefixes every line with the PE index. head is only written by
+ * the producer and tail only by the primary PE, so no lock is needed; they sit
+ * on separate cache lines. Entries also carry the number of binary trace
+ * records the PE made before the text, so that both kinds of output of one PE
+ * are printed in call order.
+ */
+#define LOG_RING_WRAP   0xFFFFFFFFu
+
+typedef struct {
+    uint64_t timestamp;
+    uint32_t len;             /* text length, or LOG_RING_WRAP */
+    uint32_t seq;             /* binary trace records of the PE made before */
+} log_ring_entry;
+
+struct log_ring {
+    volatile uint32_t head;   /* producer: bytes written */
+    volatile uint32_t dropped;
+    uint8_t  pad0[LOG_CACHE_LINE - 8];
+    volatile uint32_t tail;   /* primary PE: bytes consumed */
+    uint32_t dropped_seen;
+    uint32_t pe_index;
+    bool     line_start;
+    uint8_t  pad1[LOG_CACHE_LINE - 13];
+    uint8_t  data[LOG_PE_RING_SIZE];
+};
+
+static log_ring *log_rings;
+
+/**
+ *   @brief    - Queues the text collected by a secondary PE. Drops it when the ring
+ *               is full, as the secondary PE cannot wait for the primary PE.
+ *   @param    - ring  : Ring of the calling PE
+ *             - text  : Formatted text
+ *             - len   : Text length
+ *             - seq   : Binary trace records of the PE made before the text
+ *   @return   - None
+ **/
+
+static void log_ring_push(log_ring *ring, const char *text, uint32_t len, uint32_t seq)
+{
+    uint32_t size = (uint32_t)((sizeof(log_ring_entry) + len + LOG_RING_ALIGN - 1) &
+                               ~(LOG_RING_ALIGN - 1));
+    uint32_t head = ring->head;
+    uint32_t pos = head % LOG_PE_RING_SIZE;
+    uint32_t to_end = LOG_PE_RING_SIZE - pos;
+    uint32_t used, need;
+    log_ring_entry *entry;
+
+    val_data_cache_ops_by_va((addr_t)&ring->tail, INVALIDATE);
+    used = head - ring->tail;
+    need = (to_end < size) ? to_end + size : size;
+
+    if (LOG_PE_RING_SIZE - used < need) {
+        ring->dropped++;
+        val_data_cache_ops_by_va((addr_t)&ring->head, CLEAN_AND_INVALIDATE);
+        return;
+    }
+
+    /* Entries never wrap; mark the rest of the ring as unused instead */
+    if (to_end < size) {
+        entry = (log_ring_entry *)&ring->data[pos];
+        entry->len = LOG_RING_WRAP;
+        val_data_cache_ops_by_va((addr_t)entry, CLEAN_AND_INVALIDATE);
+        head += to_end;
+        pos = 0;
+    }
+
+    entry = (log_ring_entry *)&ring->data[pos];
+    entry->timestamp = virtualcounter_read();
+    entry->len = len;
+    entry->seq = seq;
+    val_mem_copy((char *)(entry + 1), text, len);
+    val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)entry, size);
+
+    /* Publish the entry only after its contents */
+    dmbish();
+    ring->head = head + size;
+    val_data_cache_ops_by_va((addr_t)&ring->head, CLEAN_AND_INVALIDATE);
+}
+
+/**
+ *   @brief    - Returns the next queued entry of a ring, skipping wrap markers
+ *   @param    - ring  : Ring to look at
+ *   @return   - Entry, or NULL if the ring is empty
+ **/
+
+static log_ring_entry *log_ring_peek(log_ring *ring)
+{
+    log_ring_entry *entry;
+    uint32_t pos;
+
+    val_data_cache_ops_by_va((addr_t)&ring->head, INVALIDATE);
+    while (ring->tail != ring->head) {
+        dmbish();
+        pos = ring->tail % LOG_PE_RING_SIZE;
+        entry = (log_ring_entry *)&ring->data[pos];
+        val_data_cache_ops_by_va((addr_t)entry, INVALIDATE);
+        if (entry->len != LOG_RING_WRAP)
+            return entry;
+        ring->tail += LOG_PE_RING_SIZE - pos;
+    }
+
+    return NULL;
+}
+
+/**
+ *   @brief    - Prints one queued entry with a PE prefix and releases it
+ *   @param    - ring   : Ring holding the entry
+ *             - entry  : Entry returned by log_ring_peek
+ *   @return   - None
+ **/
+
+static void log_ring_print(log_ring *ring, log_ring_entry *entry)
+{
+    char line[LOG_MAX_STRING_LENGTH * 2 + 16];
+    uint32_t len = entry->len, n = 0, index = ring->pe_index;
+    uint32_t size = (uint32_t)((sizeof(log_ring_entry) + len + LOG_RING_ALIGN - 1) &
+                               ~(LOG_RING_ALIGN - 1));
+    const char *text = (const char *)(entry + 1);
+    char digits[10];
+    uint32_t i = 0;
+
+    val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)entry, size);
+
+    if (len > LOG_MAX_STRING_LENGTH * 2)
+        len = LOG_MAX_STRING_LENGTH * 2;
+
+    /* A leading line break belongs to the previous line of this PE */
+    while (len > 0 && (*text == '\r' || *text == '\n')) {
+        line[n++] = *text++;
+        len--;
+        ring->line_start = true;
+    }
+
+    if (len > 0 && ring->line_start) {
+        line[n++] = 'P';
+        line[n++] = 'E';
+        do {
+            digits[i++] = (char)('0' + index % 10);
+            index /= 10;
+        } while (index);
+        while (i)
+            line[n++] = digits[--i];
+        line[n++] = ':';
+        line[n++] = ' ';
+    }
+
+    if (len > 0) {
+        val_mem_copy(&line[n], text, len);
+        n += len;
+        ring->line_start = (line[n - 1] == '\n');
+    }
+    line[n] = '\0';
+    pal_print((uint64_t)(uintptr_t)line);
+
+    dmbish();
+    ring->tail += size;
+    val_data_cache_ops_by_va((addr_t)&ring->tail, CLEAN_AND_INVALIDATE);
+}
+
+/**
+ *   @brief    - Hands the line collected by val_printf to the console, or to the
+ *               ring of the calling PE when it is a secondary PE
+ *   @param    - ctx  : Logging context of the calling PE
+ *   @return   - None
+ **/
+
+static void log_emit(log_ctx *ctx)
+{
+    uint32_t len = (uint32_t)ctx->collected_len;
+    uint32_t room;
+
+    if (len == 0)
+        return;
+
+    if (ctx->capture != NULL) {
+        /* Keep what fits, count the rest so the owner can report the loss */
+        if (ctx->capture_len + 1 < ctx->capture_size) {
+            room = ctx->capture_size - 1 - ctx->capture_len;
+            if (room > len)
+                room = len;
+            val_mem_copy(&ctx->capture[ctx->capture_len], ctx->collected, room);
+            ctx->capture[ctx->capture_len + room] = '\0';
+        }
+        ctx->capture_len += len;
+        return;
+    }
+
+    if (ctx->ring != NULL)
+        log_ring_push(ctx->ring, ctx->collected, (uint32_t)ctx->collected_len, ctx->seq);
+    else
+        pal_print((uint64_t)(uintptr_t)ctx->collected);
+}
+
+/*
+ * Binary trace mode. TRACE and DEBUG messages are not formatted on the target:
+ * each val_printf call appends a record holding the format string address and
+ * the raw arguments to a per-PE buffer. The records are printed as base64
+ * lines, merged with the text output in call order, and
+ * tools/scripts/acs_log_decode.py rebuilds the text using the format strings
+ * of the ACS ELF image. pal_print() takes NUL terminated strings, so the
+ * records cannot go out as raw bytes.
+ *
+ * Records are packed byte streams of LEB128 varints:
+ *   size                    - bytes of the record after this field
+ *   verbosity << 5 | num_args, one byte
+ *   fmt - &val_printf       - zigzag encoded
+ *   timestamp delta         - CNTVCT ticks since the previous record of the PE
+ *   num_args values         - zigzag encoded for '*' widths, %c, %d and %i; for
+ *                             %s the string length followed by its bytes
+ *
+ * Console lines:
+ *   @ACSBIN anchor=<hex address of val_printf> primary=<PE index>
+ *   @ACSBIN <pe>+<base64>     records continue on the next line
+ *   @ACSBIN <pe>:<base64>     last line of a run of records
+ *   @ACSBIN <pe> dropped=<n>
+ */
+/* One per PE and cache line; the primary PE owns the cursor fields */
+typedef struct {
+    uint8_t  *buf;
+    volatile uint32_t used;   /* producer: bytes recorded */
+    uint32_t dropped;
+    uint32_t first_seq;       /* sequence number of the record at buf[0] */
+    uint32_t off;             /* cursor: next record to print */
+    uint64_t first_ts;        /* timestamp of the record at buf[0] */
+    uint64_t last_ts;         /* producer: timestamp of the latest record */
+    uint64_t next_ts;         /* cursor: timestamp of the record at off */
+    uint32_t next_seq;        /* cursor: sequence number of the record at off */
+    uint8_t  pad[LOG_CACHE_LINE - 52];
+} log_trace_pe;
+
+static_assert(sizeof(log_trace_pe) == LOG_CACHE_LINE,
+              "log_trace_pe must fill one cache line");
+
+/* Position of a piece of output in the merged console stream */
+typedef struct {
+    uint64_t ts;
+    uint32_t seq;             /* record sequence number, records before ring text */
+    uint32_t pe;
+    bool     trace;           /* binary trace record or ring text */
+} log_key;
+
+static log_trace_pe *log_trace;
+
+static uint64_t log_zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static uint32_t log_varint_len(uint64_t value)
+{
+    uint32_t n = 1;
+
+    while (value >= 0x80) {
+        value >>= 7;
+        n++;
+    }
+    return n;
+}
+
+static uint8_t *log_varint_put(uint8_t *dst, uint64_t value)
+{
+    while (value >= 0x80) {
+        *dst++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *dst++ = (uint8_t)value;
+    return dst;
+}
+
+static const uint8_t *log_varint_get(const uint8_t *src, uint64_t *value)
+{
+    uint64_t result = 0;
+    uint32_t shift = 0;
+
+    do {
+        result |= (uint64_t)(*src & 0x7F) << shift;
+        shift += 7;
+    } while (*src++ & 0x80);
+
+    *value = result;
+    return src;
+}
+
+/**
+ *   @brief    - Orders two pieces of output: by record sequence number within a
+ *               PE, by timestamp across PEs
+ *   @param    - a, b : Positions to compare
+ *   @return   - true if a goes out before b
+ **/
+
+static bool log_key_before(const log_key *a, const log_key *b)
+{
+    /* Ring text with sequence number n follows record n - 1 and precedes record n */
+    if (a->pe == b->pe) {
+        if (a->trace || !b->trace)
+            return (int32_t)(a->seq - b->seq) < 0;
+        return (int32_t)(a->seq - b->seq) <= 0;
+    }
+    if (a->ts != b->ts)
+        return a->ts < b->ts;
+    return a->pe < b->pe;
+}
+
+/**
+ *   @brief    - Returns whether val_printf ends at the start of a line after
+ *               printing a message
+ *   @param    - fmt         : Format string of the message
+ *             - line_start  : Whether the output was at the start of a line before
+ *   @return   - true if the message leaves the output at the start of a line
+ **/
+
+static bool log_fmt_line_start(const char *fmt, bool line_start)
+{
+    size_t len;
+
+    while (*fmt == '\n') {
+        line_start = true;
+        fmt++;
+    }
+    if (*fmt == '\0')
+        return line_start;
+
+    /* Messages val_printf truncates end with a line break too */
+    len = log_strnlen_s(fmt, LOG_MAX_STRING_LENGTH - 2);
+    return fmt[len - 1] == '\n' || len == LOG_MAX_STRING_LENGTH - 2;
+}
+
+/**
+ *   @brief    - Returns the format string of a trace record
+ *   @param    - rec  : Record
+ *   @return   - Format string
+ **/
+
+static const char *log_trace_rec_fmt(const uint8_t *rec)
+{
+    uint64_t value;
+
+    rec = log_varint_get(rec, &value);
+    log_varint_get(rec + 1, &value);
+    return (const char *)((uintptr_t)&val_printf + ((value >> 1) ^ (0 - (value & 1))));
+}
+
+/**
+ *   @brief    - Collects the arguments of one call into trace record form
+ *   @param    - fmt      : Format string
+ *             - args     : Arguments of the call
+ *             - values   : Output argument values, string length for %s
+ *             - strs     : Output string argument pointers, NULL for non-strings
+ *   @return   - Number of argument slots filled
+ **/
+
+static uint32_t log_trace_collect(const char *fmt, va_list args, uint64_t *values,
+                                  const char **strs)
+{
+    uint32_t n = 0;
+
+    while (*fmt != '\0' && n < LOG_TRACE_MAX_ARGS) {
+        struct format_flags flags = {0};
+        enum format_length length = length32;
+        enum length_mod mod = mod_none;
+
+        if (*fmt++ != '%')
+            continue;
+
+        fmt = parse_flags(fmt, &flags);
+        if (*fmt == '*') {
+            fmt++;
+            strs[n] = NULL;
+            values[n++] = log_zigzag(va_arg(args, int));
+            if (n == LOG_TRACE_MAX_ARGS)
+                break;
+        }
+        while (*fmt >= '0' && *fmt <= '9')
+            fmt++;
+        fmt = parse_length_modifier(fmt, &length, &mod);
+        if (mod == mod_bad)
+            break;
+
+        strs[n] = NULL;
+        switch (*fmt) {
+        case '%':
+            fmt++;
+            continue;
+        case 's':
+            strs[n] = va_arg(args, const char *);
+            if (strs[n] == NULL)
+                strs[n] = "(null)";
+            values[n] = log_strnlen_s(strs[n], LOG_MAX_STRING_LENGTH);
+            break;
+        case 'c':
+            values[n] = log_zigzag(va_arg(args, int));
+            break;
+        case 'd':
+        case 'i':
+            if (mod == mod_ll)
+                values[n] = log_zigzag(va_arg(args, long long));
+            else if (length == length64)
+                values[n] = log_zigzag(va_arg(args, long));
+            else
+                values[n] = log_zigzag(va_arg(args, int));
+            break;
+        case 'b':
+        case 'B':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'u':
+            if (mod == mod_ll)
+                values[n] = (uint64_t)va_arg(args, unsigned long long);
+            else if (length == length64)
+                values[n] = (uint64_t)va_arg(args, unsigned long);
+            else
+                values[n] = (uint64_t)va_arg(args, unsigned int);
+            break;
+        case 'p':
+            values[n] = (uint64_t)(uintptr_t)va_arg(args, void *);
+            break;
+        default:
+            /* val_log rejects this specifier too, nothing further is consumed */
+            return n;
+        }
+        fmt++;
+        n++;
+    }
+
+    return n;
+}
+
+/**
+ *   @brief    - Returns whether a trace buffer holds records not printed yet, and
+ *               loads the cursor when printing starts at the first record
+ *   @param    - pe  : Trace buffer
+ *   @return   - true if records are pending
+ **/
+
+static bool log_trace_pending(log_trace_pe *pe)
+{
+    if (pe->off == 0) {
+        pe->next_ts = pe->first_ts;
+        pe->next_seq = pe->first_seq;
+    }
+    return pe->off < pe->used;
+}
+
+/**
+ *   @brief    - Moves the cursor of a trace buffer past one record
+ *   @param    - pe  : Trace buffer with a pending record
+ *   @return   - None
+ **/
+
+static void log_trace_advance(log_trace_pe *pe)
+{
+    const uint8_t *rec = pe->buf + pe->off;
+    uint64_t body, value;
+
+    rec = log_varint_get(rec, &body);
+    pe->off = (uint32_t)(rec - pe->buf + body);
+    if (pe->off >= pe->used)
+        return;
+
+    /* Skip the size, verbosity and format fields to the timestamp delta */
+    rec = log_varint_get(pe->buf + pe->off, &body);
+    rec = log_varint_get(rec + 1, &value);
+    log_varint_get(rec, &value);
+    pe->next_ts += value;
+    pe->next_seq++;
+}
+
+/**
+ *   @brief    - Prints a run of records of one PE as base64 lines
+ *   @param    - index  : PE index
+ *             - data   : First record of the run
+ *             - len    : Run length in bytes
+ *   @return   - None
+ **/
+
+static void log_trace_print_run(uint32_t index, const uint8_t *data, uint32_t len)
+{
+    static const char b64[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char line[sizeof(LOG_TRACE_MARKER) + 12 + LOG_TRACE_LINE_BYTES / 3 * 4 + 3];
+    char digits[10];
+    uint32_t chunk, i, n, prefix, word, value;
+
+    /* "@ACSBIN <pe>" is the same on every line of the run */
+    val_mem_copy(line, LOG_TRACE_MARKER " ", sizeof(LOG_TRACE_MARKER));
+    prefix = sizeof(LOG_TRACE_MARKER);
+    value = index;
+    i = 0;
+    do {
+        digits[i++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (i)
+        line[prefix++] = digits[--i];
+
+    while (len > 0) {
+        chunk = (len > LOG_TRACE_LINE_BYTES) ? LOG_TRACE_LINE_BYTES : len;
+        n = prefix;
+        line[n++] = (chunk < len) ? '+' : ':';
+        for (i = 0; i < chunk; i += 3) {
+            word = (uint32_t)data[i] << 16;
+            if (i + 1 < chunk)
+                word |= (uint32_t)data[i + 1] << 8;
+            if (i + 2 < chunk)
+                word |= data[i + 2];
+            line[n++] = b64[(word >> 18) & 0x3F];
+            line[n++] = b64[(word >> 12) & 0x3F];
+            line[n++] = (i + 1 < chunk) ? b64[(word >> 6) & 0x3F] : '=';
+            line[n++] = (i + 2 < chunk) ? b64[word & 0x3F] : '=';
+        }
+        line[n++] = '\r';
+        line[n++] = '\n';
+        line[n] = '\0';
+        pal_print((uint64_t)(uintptr_t)line);
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+/**
+ *   @brief    - Prints the pending records of one PE up to a limit
+ *   @param    - index  : PE index
+ *             - pe     : Trace buffer of that PE, with records pending
+ *             - limit  : Print only records that go out before the oldest output
+ *                        of the other PEs, NULL for no limit
+ *             - own    : and before the next text of the same PE, NULL for none
+ *   @return   - None
+ **/
+
+static void log_trace_print(uint32_t index, log_trace_pe *pe, const log_key *limit,
+                            const log_key *own)
+{
+    uint32_t start = pe->off;
+    log_key key = { .pe = index, .trace = true };
+    const uint8_t *rec;
+    log_ring *ring;
+    uint64_t size;
+
+    do {
+        log_trace_advance(pe);
+        key.ts = pe->next_ts;
+        key.seq = pe->next_seq;
+    } while (pe->off < pe->used && (limit == NULL || log_key_before(&key, limit)) &&
+             (own == NULL || log_key_before(&key, own)));
+
+    log_trace_print_run(index, pe->buf + start, pe->off - start);
+
+    /* Text of a secondary PE that follows the records needs to know where the line is */
+    if (index != log_primary_index) {
+        ring = &log_rings[index];
+        rec = pe->buf + start;
+        while (rec < pe->buf + pe->off) {
+            ring->line_start = log_fmt_line_start(log_trace_rec_fmt(rec), ring->line_start);
+            rec = log_varint_get(rec, &size);
+            rec += size;
+        }
+    }
+
+    if (pe->off == pe->used) {
+        pe->off = 0;
+        pe->used = 0;
+    }
+}
+
+/**
+ *   @brief    - Reports the records a secondary PE dropped on a full buffer
+ *   @param    - index  : PE index
+ *             - pe     : Trace buffer of that PE
+ *   @return   - None
+ **/
+
+static void log_trace_report_dropped(uint32_t index, log_trace_pe *pe)
+{
+    struct format_flags flags = {0};
+    log_ctx *ctx = log_primary_ctx();
+
+    if (pe->dropped == 0)
+        return;
+
+    /* Written by hand so that the report never recurses into the buffers */
+    ctx->collect = true;
+    ctx->collected_len = 0;
+    ctx->collected[0] = '\0';
+    print_raw_string(ctx, LOG_TRACE_MARKER " ");
+    print_int(ctx, index, base10, 0, &flags);
+    print_raw_string(ctx, " dropped=");
+    print_int(ctx, pe->dropped, base10, 0, &flags);
+    print_raw_string(ctx, "\n");
+    ctx->collect = false;
+    pal_print((uint64_t)(uintptr_t)ctx->collected);
+    pe->dropped = 0;
+}
+
+/**
+ *   @brief    - Appends one record to the trace buffer of the calling PE. A full
+ *               buffer is printed first on the primary PE; secondary PEs count the
+ *               record as dropped as they must not drive the console.
+ *   @param    - verbosity  : Print verbosity level
+ *             - msg        : Format string
+ *             - args       : Arguments of the call
+ *   @return   - None
+ **/
+
+static void log_trace_record(print_verbosity_t verbosity, const char *msg, va_list args)
+{
+    uint32_t index = log_pe_index();
+    log_ctx *ctx;
+    log_trace_pe *pe;
+    uint64_t values[LOG_TRACE_MAX_ARGS];
+    const char *strs[LOG_TRACE_MAX_ARGS];
+    uint64_t fmt, now, delta;
+    uint32_t num_args, body, size, i;
+    uint8_t *dst;
+
+    if (index == LOG_NO_PE)
+        return;
+
+    ctx = &log_pe_ctx[index];
+    pe = &log_trace[index];
+    num_args = log_trace_collect(msg, args, values, strs);
+
+    now = virtualcounter_read();
+    fmt = log_zigzag((int64_t)((uintptr_t)msg - (uintptr_t)&val_printf));
+    delta = now - pe->last_ts;
+
+    body = 1 + log_varint_len(fmt) + log_varint_len(delta);
+    for (i = 0; i < num_args; i++) {
+        body += log_varint_len(values[i]);
+        if (strs[i] != NULL)
+            body += (uint32_t)values[i];
+    }
+    size = log_varint_len(body) + body;
+
+    /* The primary PE empties the buffer of an idle secondary PE */
+    if (index != log_primary_index)
+        val_data_cache_ops_by_va((addr_t)pe, CLEAN_AND_INVALIDATE);
+
+    if (pe->used + size > LOG_TRACE_BUF_SIZE) {
+        if (index != log_primary_index) {
+            pe->dropped++;
+            val_data_cache_ops_by_va((addr_t)pe, CLEAN_AND_INVALIDATE);
+            return;
+        }
+        log_trace_pending(pe);
+        log_trace_print(index, pe, NULL, NULL);
+    }
+
+    dst = pe->buf + pe->used;
+    dst = log_varint_put(dst, body);
+    *dst++ = (uint8_t)((verbosity << 5) | num_args);
+    dst = log_varint_put(dst, fmt);
+    dst = log_varint_put(dst, delta);
+    for (i = 0; i < num_args; i++) {
+        dst = log_varint_put(dst, values[i]);
+        if (strs[i] != NULL) {
+            val_mem_copy((char *)dst, strs[i], values[i]);
+            dst += values[i];
+        }
+    }
+
+    if (pe->used == 0) {
+        pe->first_ts = now;
+        pe->first_seq = ctx->seq;
+    }
+    ctx->seq++;
+    pe->last_ts = now;
+
+    /* Leave the line state as val_printf would have, for the text that follows */
+    ctx->last_was_newline = log_fmt_line_start(msg, ctx->last_was_newline);
+    if (ctx->last_was_newline)
+        ctx->prefix_printed = false;
+    else if (*msg != '\0')
+        ctx->prefix_printed = true;
+
+    if (index != log_primary_index) {
+        /* Make the record visible to the primary PE before publishing it */
+        val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)(pe->buf + pe->used), size);
+        dmbish();
+        pe->used += size;
+        val_data_cache_ops_by_va((addr_t)pe, CLEAN_AND_INVALIDATE);
+    } else {
+        pe->used += size;
+    }
+}
+
+/**
+ *   @brief    - Prints the pending records of the primary PE ahead of its next
+ *               piece of text
+ *   @param    - None
+ *   @return   - None
+ **/
+
+static void log_trace_catch_up(void)
+{
+    log_trace_pe *pe;
+
+    if (log_pe_index() != log_primary_index)
+        return;
+
+    if (log_trace == NULL)
+        return;
+
+    pe = &log_trace[log_primary_index];
+    if (log_pe_ctx[log_primary_index].capture != NULL || !log_trace_pending(pe))
+        return;
+
+    log_trace_print(log_primary_index, pe, NULL, NULL);
+}
+
+/**
+ *   @brief    - Returns whether the head of a ring must wait for binary trace
+ *               records of the same PE that cannot be printed yet
+ *   @param    - index  : PE index
+ *             - entry  : Head entry of the ring of that PE
+ *   @return   - true if the entry must wait
+ **/
+
+static bool log_trace_holds(uint32_t index, const log_ring_entry *entry)
+{
+    log_trace_pe *pe;
+
+    if (log_trace == NULL)
+        return false;
+
+    pe = &log_trace[index];
+    dmbish();
+    val_data_cache_ops_by_va((addr_t)pe, INVALIDATE);
+    return pe->used != 0 && (int32_t)(entry->seq - pe->first_seq) > 0;
+}
+
+/**
+ *   @brief    - Allocates the per-PE trace buffers and switches TRACE/DEBUG messages
+ *               to binary trace mode. Does nothing unless the binary_log policy is set.
+ *   @param    - num_pe : Number of PEs in the system
+ *   @return   - None
+ **/
+
+static void log_trace_init(uint32_t num_pe)
+{
+    uint8_t *bufs;
+    uint32_t i;
+
+    if (!acs_policy_get_binary_log() || log_trace != NULL)
+        return;
+
+    bufs = val_memory_alloc(num_pe * LOG_TRACE_BUF_SIZE);
+    log_trace = val_aligned_alloc(LOG_CACHE_LINE, num_pe * sizeof(log_trace_pe));
+    if (bufs == NULL || log_trace == NULL) {
+        if (bufs != NULL)
+            val_memory_free(bufs);
+        if (log_trace != NULL)
+            val_memory_free_aligned(log_trace);
+        log_trace = NULL;
+        val_print(WARN, " Binary log buffers not allocated, using text log\n");
+        return;
+    }
+
+    val_memory_set(log_trace, num_pe * sizeof(log_trace_pe), 0);
+    for (i = 0; i < num_pe; i++)
+        log_trace[i].buf = bufs + i * LOG_TRACE_BUF_SIZE;
+    val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)log_trace,
+                                        num_pe * sizeof(log_trace_pe));
+
+    /* PAL prints bypass val_printf, records must go out ahead of them too */
+    pal_print_set_sync_hook(log_trace_catch_up);
+
+    val_print(INFO, " Binary log enabled, decode with tools/scripts/acs_log_decode.py\n");
+    val_printf(INFO, LOG_TRACE_MARKER " anchor=%lx primary=%d\n",
+               (uint64_t)(uintptr_t)&val_printf, log_primary_index);
+}
+
+/**
+ *   @brief    - Prints the queued output of all PEs, oldest first: the text rings
+ *               of the secondary PEs and the binary trace records. Only the primary
+ *               PE may call this.
+ *   @param    - idle : true if the secondary PEs are idle, so that their binary
+ *                      trace buffers may be printed. Otherwise only the records
+ *                      of the primary PE are, and ring entries of a secondary PE
+ *                      wait for its pending records.
+ *   @return   - None
+ **/
+
+static void log_drain(bool idle)
+{
+    log_ring_entry *entry, *best_entry = NULL;
+    log_trace_pe *pe;
+    log_key key, best, next, own, best_own;
+    bool have_best, have_next, have_own, best_has_own = false, best_trace = false;
+    uint32_t i, best_pe = 0;
+
+    if (log_rings == NULL || log_pe_index() != log_primary_index)
+        return;
+
+    if (idle && log_trace != NULL) {
+        for (i = 0; i < log_num_pe; i++) {
+            if (i == log_primary_index)
+                continue;
+            val_data_cache_ops_by_va((addr_t)&log_trace[i], CLEAN_AND_INVALIDATE);
+            val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)log_trace[i].buf,
+                                                log_trace[i].used);
+        }
+    }
+
+    do {
+        have_best = false;
+        have_next = false;
+        for (i = 0; i < log_num_pe; i++) {
+            key.pe = i;
+            have_own = false;
+            if (i != log_primary_index) {
+                entry = log_ring_peek(&log_rings[i]);
+                if (entry != NULL && (idle || !log_trace_holds(i, entry))) {
+                    key.ts = entry->timestamp;
+                    key.seq = entry->seq;
+                    key.trace = false;
+                    own = key;
+                    have_own = true;
+                    if (!have_best || log_key_before(&key, &best)) {
+                        next = best;
+                        have_next = have_best;
+                        best = key;
+                        best_entry = entry;
+                        best_trace = false;
+                        best_pe = i;
+                        have_best = true;
+                    } else if (!have_next || log_key_before(&key, &next)) {
+                        next = key;
+                        have_next = true;
+                    }
+                }
+            }
+
+            if (log_trace == NULL || (!idle && i != log_primary_index))
+                continue;
+            pe = &log_trace[i];
+            if (!log_trace_pending(pe))
+                continue;
+            key.ts = pe->next_ts;
+            key.seq = pe->next_seq;
+            key.trace = true;
+            if (!have_best || log_key_before(&key, &best)) {
+                next = best;
+                have_next = have_best;
+                best = key;
+                best_own = own;
+                best_has_own = have_own;
+                best_trace = true;
+                best_pe = i;
+                have_best = true;
+            } else if (!have_next || log_key_before(&key, &next)) {
+                next = key;
+                have_next = true;
+            }
+        }
+
+        if (!have_best)
+            break;
+
+        /* Records go out in runs, up to the next older output of another source */
+        if (best_trace)
+            log_trace_print(best_pe, &log_trace[best_pe], have_next ? &next : NULL,
+                            best_has_own ? &best_own : NULL);
+        else
+            log_ring_print(&log_rings[best_pe], best_entry);
+    } while (true);
+
+    if (idle && log_trace != NULL) {
+        for (i = 0; i < log_num_pe; i++) {
+            if (i == log_primary_index)
+                continue;
+            log_trace_report_dropped(i, &log_trace[i]);
+            val_data_cache_ops_by_va((addr_t)&log_trace[i], CLEAN_AND_INVALIDATE);
+        }
+    }
+
+    for (i = 0; i < log_num_pe; i++) {
+        log_ring *ring = &log_rings[i];
+
+        val_data_cache_ops_by_va((addr_t)&ring->dropped, INVALIDATE);
+        if (ring->dropped != ring->dropped_seen) {
+            val_print(WARN, " PE%d: %d log messages dropped, ring full\n",
+                      i, ring->dropped - ring->dropped_seen);
+            ring->dropped_seen = ring->dropped;
+        }
+    }
+}
+
+/**
+ *   @brief    - Sets up the per-PE logging contexts, the secondary PE text rings
+ *               and, if enabled, the binary trace buffers. Called on the primary
+ *               PE once the PE info table exists.
+ *   @param    - num_pe : Number of PEs in the system
+ *   @return   - None
+ **/
+
+void val_log_init(uint32_t num_pe)
+{
+    uint32_t i;
+
+    if (log_pe_ctx != NULL || num_pe == 0)
+        return;
+
+    log_pe_ctx = val_memory_calloc(num_pe, sizeof(log_ctx));
+    log_rings = val_aligned_alloc(LOG_CACHE_LINE, num_pe * sizeof(log_ring));
+    if (log_pe_ctx == NULL || log_rings == NULL) {
+        if (log_pe_ctx != NULL)
+            val_memory_free(log_pe_ctx);
+        if (log_rings != NULL)
+            val_memory_free_aligned(log_rings);
+        log_pe_ctx = NULL;
+        log_rings = NULL;
+        val_print(WARN, " Per-PE log buffers not allocated, secondary PEs print directly\n");
+        return;
+    }
+    val_memory_set(log_rings, num_pe * sizeof(log_ring), 0);
+
+    log_primary_mpid = val_pe_get_mpid();
+    log_primary_index = val_pe_get_index_mpid(log_primary_mpid);
+
+    for (i = 0; i < num_pe; i++) {
+        log_pe_ctx[i].last_was_newline = true;
+        log_rings[i].pe_index = i;
+        log_rings[i].line_start = true;
+        if (i != log_primary_index)
+            log_pe_ctx[i].ring = &log_rings[i];
+    }
+
+    /* The primary PE carries on with the line it may be in the middle of */
+    log_pe_ctx[log_primary_index] = log_boot_ctx;
+    log_pe_ctx[log_primary_index].ring = NULL;
+    val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)log_pe_ctx,
+                                        num_pe * sizeof(log_ctx));
+    val_pe_cache_clean_invalidate_range((uint64_t)(uintptr_t)log_rings,
+                                        num_pe * sizeof(log_ring));
+
+    log_num_pe = num_pe;
+    log_trace_init(num_pe);
+}
+
+/**
+ *   @brief    - Prints the queued output of the secondary PEs and the binary trace
+ *               records of all PEs, in call order. Must be called from the primary
+ *               PE while the secondary PEs are idle, as done at test boundaries.
+ *   @param    - None
+ *   @return   - None
+ **/
+
+void val_log_flush(void)
+{
+    /* Payloads call this on secondary PEs too, the drain is left to the primary */
+    log_drain(true);
+}
+
+/**
+ *   @brief    - Prints the queued output of the secondary PEs. Safe to call from
+ *               the primary PE while payloads are still running on other PEs.
+ *   @param    - None
+ *   @return   - None
+ **/
+
+void val_log_drain(void)
+{
+    log_drain(false);
+}
+
+/**
+ *   @brief    - Redirects the val_printf output of the calling PE to a buffer
+ *               until val_log_capture_stop(). Used to run a test on a secondary
+ *               PE and print its output later, in rule order. Binary trace
+ *               records are not captured.
+ *   @param    - buf  : Buffer, kept NUL terminated
+ *             - size : Buffer size in bytes
+ *   @return   - 0 on success, 1 if the calling PE has no logging context of its own
+ **/
+
+uint32_t val_log_capture_start(char *buf, uint32_t size)
+{
+    log_ctx *ctx = log_ctx_self();
+
+    if (buf == NULL || size == 0 || ctx == &log_boot_ctx)
+        return 1;
+
+    buf[0] = '\0';
+    ctx->capture = buf;
+    ctx->capture_size = size;
+    ctx->capture_len = 0;
+    ctx->last_was_newline = true;
+    ctx->prefix_printed = false;
+    return 0;
+}
+
+/**
+ *   @brief    - Ends the capture started by val_log_capture_start()
+ *   @param    - None
+ *   @return   - Bytes produced during the capture. More than size - 1 means the
+ *               output was cut short.
+ **/
+
+uint32_t val_log_capture_stop(void)
+{
+    log_ctx *ctx = log_ctx_self();
+    uint32_t len = ctx->capture_len;
+
+    ctx->capture = NULL;
+    ctx->capture_len = 0;
+    return len;
+}
+
+/**
+ *   @brief    - Prints captured output on the calling PE, normally the primary PE
+ *   @param    - text : Captured text
+ *             - len  : Text length
+ *   @return   - None
+ **/
+
+void val_log_replay(const char *text, uint32_t len)
+{
+    log_ctx *ctx = log_ctx_self();
+    uint32_t i;
+
+    ctx->collect = true;
+    ctx->collected_len = 0;
+    ctx->collected[0] = '\0';
+    for (i = 0; i < len; i++) {
+        /* Room for the character and a '\r' log_putchar may add */
+        if (ctx->collected_len + 3 > sizeof(ctx->collected)) {
+            log_emit(ctx);
+            ctx->collected_len = 0;
+            ctx->collected[0] = '\0';
+        }
+        log_putchar(ctx, text[i]);
+    }
+    ctx->collect = false;
+    log_emit(ctx);
+
+    if (len > 0) {
+        ctx->last_was_newline = (text[len - 1] == '\n');
+        if (ctx->last_was_newline)
+            ctx->prefix_printed = false;
+    }
+}
+
+/**
+ *   @brief    - Flushes pending output and releases the per-PE logging state
+ *   @param    - None
+ *   @return   - None
+ **/
+
+void val_log_free(void)
+{
+    if (log_pe_ctx == NULL)
+        return;
+
+    val_log_flush();
+
+    if (log_trace != NULL) {
+        pal_print_set_sync_hook(NULL);
+        val_memory_free(log_trace[0].buf);
+        val_memory_free_aligned(log_trace);
+        log_trace = NULL;
+    }
+
+    /* Later output comes from the primary PE only */
+    log_boot_ctx = log_pe_ctx[log_primary_index];
+    log_num_pe = 0;
+    val_memory_free_aligned(log_rings);
+    val_memory_free(log_pe_ctx);
+    log_rings = NULL;
+    log_pe_ctx = NULL;
+}
+#else
+static log_ctx *log_ctx_self(void)
+{
+    return &log_boot_ctx;
+}
+
+static void log_emit(log_ctx *ctx)
+{
+    if (ctx->collected_len > 0)
+        pal_print((uint64_t)(uintptr_t)ctx->collected);
+}
+
+void val_log_init(uint32_t num_pe)
+{
+    (void)num_pe;
+}
+
+void val_log_flush(void)
+{
+}
+
+void val_log_drain(void)
+{
+}
+
+void val_log_free(void)
+{
+}
+
+uint32_t val_log_capture_start(char *buf, uint32_t size)
+{
+    (void)buf;
+    (void)size;
+    return 1;
+}
+
+uint32_t val_log_capture_stop(void)
+{
+    return 0;
+}
+
+void val_log_replay(const char *text, uint32_t len)
+{
+    (void)text;
+    (void)len;
+}
+#endif /* TARGET_LINUX */
+
 /**
  *   @brief    - This function prints the given string and data onto the uart
  *   @param    - verbosity  : Print Verbosity level
@@ -682,64 +1893,75 @@ out:
 uint32_t val_printf(print_verbosity_t verbosity, const char *msg, ...)
 {
     int chars_written = 0;
-    static bool lastWasNewline = true;
-    static bool prefixPrinted;
+    log_ctx *ctx;
     char formatted_msg[LOG_MAX_STRING_LENGTH];
     va_list args;
 
     if (msg == NULL)
         return 0;
 
-    collect_log_output = true;
-    collected_log_len = 0;
-    collected_log[0] = '\0';
+#ifndef TARGET_LINUX
+    if (log_trace != NULL) {
+        if (verbosity < INFO) {
+            va_start(args, msg);
+            log_trace_record(verbosity, msg, args);
+            va_end(args);
+            return 1;
+        }
+        log_trace_catch_up();
+    }
+#endif
+
+    ctx = log_ctx_self();
+    ctx->collect = true;
+    ctx->collected_len = 0;
+    ctx->collected[0] = '\0';
 
     /* New line => allow prefix again */
-    if (lastWasNewline)
-        prefixPrinted = false;
+    if (ctx->last_was_newline)
+        ctx->prefix_printed = false;
 
     /* Emit any leading blank lines cleanly (and don't prefix blank lines) */
     while (*msg == '\n') {
-        print_raw_string("\r\n");
-        lastWasNewline = true;
-        prefixPrinted  = false;
+        print_raw_string(ctx, "\r\n");
+        ctx->last_was_newline = true;
+        ctx->prefix_printed  = false;
         msg++;
     }
 
     /* If msg was only newlines */
     if (*msg == '\0') {
-        collect_log_output = false;
-        if (collected_log_len > 0)
-            pal_print((uint64_t)(uintptr_t)collected_log);
+        ctx->collect = false;
+        log_emit(ctx);
         return 0;
     }
 
     /* Print prefix exactly once per logical line (supports multi-call line assembly) */
-    if (!prefixPrinted) {
+    if (!ctx->prefix_printed) {
         switch (verbosity)
         {
             case TRACE:
-                 print_raw_string("\t");
+                 print_raw_string(ctx, "\t");
                  break;
             case DEBUG:
-                 print_raw_string("\t");
+                 print_raw_string(ctx, "\t");
                  break;
             case INFO:
-                 print_raw_string("");
+                 print_raw_string(ctx, "");
                  break;
             case WARN:
-                 print_raw_string("\tWARN : ");
+                 print_raw_string(ctx, "\tWARN : ");
                  break;
             case ERROR:
-                 print_raw_string("\tERROR: ");
+                 print_raw_string(ctx, "\tERROR: ");
                  break;
             case FATAL:
-                 print_raw_string("\tFATAL: ");
+                 print_raw_string(ctx, "\tFATAL: ");
                  break;
             default:
                  break;
         }
-        prefixPrinted = true;
+        ctx->prefix_printed = true;
     }
 
     /* Bounded scan: we only safely inspect up to N-2 chars */
@@ -763,9 +1985,9 @@ uint32_t val_printf(print_verbosity_t verbosity, const char *msg, ...)
         formatted_msg[len]     = '\n';
         formatted_msg[len + 1] = '\0';
 
-        chars_written = val_log(formatted_msg, args);
-        lastWasNewline = true;
-        prefixPrinted  = false;
+        chars_written = val_log(ctx, formatted_msg, args);
+        ctx->last_was_newline = true;
+        ctx->prefix_printed  = false;
     }
     /* Case B: likely truncated (no '\0' found within max_scan) */
     else if (len == max_scan)
@@ -782,30 +2004,29 @@ uint32_t val_printf(print_verbosity_t verbosity, const char *msg, ...)
         formatted_msg[perm_len] = '\0';
 
         if (perm_len > 0)
-            chars_written += (int)print_raw_string(formatted_msg);
+            chars_written += (int)print_raw_string(ctx, formatted_msg);
 
-        chars_written += (int)print_raw_string(trunc_msg);
+        chars_written += (int)print_raw_string(ctx, trunc_msg);
 
-        lastWasNewline = true;
-        prefixPrinted  = false;  /* next line should get prefix */
+        ctx->last_was_newline = true;
+        ctx->prefix_printed  = false;  /* next line should get prefix */
      }
 
     /* Case C: short, no trailing '\n' */
     else
     {
-        chars_written = val_log(msg, args);
-        lastWasNewline = false;
+        chars_written = val_log(ctx, msg, args);
+        ctx->last_was_newline = false;
     }
 
     va_end(args);
 
-    collect_log_output = false;
+    ctx->collect = false;
 
     if (chars_written < 0)
     return 0;
 
-    if (collected_log_len > 0)
-        pal_print((uint64_t)(uintptr_t)collected_log);
+    log_emit(ctx);
 
     return (uint32_t)chars_written;
 }
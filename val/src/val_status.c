@@ -16,12 +16,44 @@
 
 #include "include/val_interface.h"
 #include "include/val_status.h"
+#include "include/acs_common.h"
 #include "val_logger.h"
+#ifndef TARGET_LINUX
+#include "include/val_sysreg.h"
+#include "include/val_memops.h"
+#endif
 
-/* Map shared memory as an array of status records */
-static inline volatile val_test_status_t *val_get_shared_address(void)
+/* Status record of a PE, one shared line per PE */
+static inline volatile val_test_status_t *val_get_shared_address(uint32_t index)
 {
-    return (volatile val_test_status_t *)val_get_status_region_base();
+    return (volatile val_test_status_t *)(val_get_status_region_base() +
+                                          (uintptr_t)index * val_get_shared_line_size());
+}
+
+/**
+ * @brief Updates the bit of a PE in the completion bitmap.
+ *
+ * Several PEs share a bitmap word, so the update is an exclusive
+ * load/store loop (MemOpsUpdateBits). The store has release semantics,
+ * which orders it after the status record written by the caller.
+ *
+ * @param index  PE index.
+ * @param done   Non-zero if the PE status is no longer pending.
+ */
+static void val_status_mark_done(uint32_t index, uint32_t done)
+{
+    volatile uint64_t *word = (volatile uint64_t *)val_get_done_bitmap_base() + (index / 64);
+    uint64_t bit = 1ULL << (index % 64);
+    uint64_t set = done ? bit : 0;
+#ifndef TARGET_LINUX
+    MemOpsUpdateBits(word, bit, set);
+    val_data_cache_ops_by_va((addr_t)word, CLEAN_AND_INVALIDATE);
+    /* Wake the primary PE waiting in val_wait_for_test_completion() */
+    dsbsy();
+    sev();
+#else
+    *word = (*word & ~bit) | set;
+#endif
 }
 
 /**
@@ -35,17 +67,20 @@ static inline volatile val_test_status_t *val_get_shared_address(void)
  */
 void val_set_status(uint32_t index, uint32_t test_res)
 {
-    volatile val_test_status_t *mem = val_get_shared_address();
+    volatile val_test_status_t *mem;
 
     if (index >= val_pe_get_num()) {
         val_print(ERROR, "val_set_status: invalid PE index %u\n",
                   (unsigned int)index);
         return;
     }
-    mem[index].index = index;
-    mem[index].state = (uint8_t)GET_STATE(test_res);
-    mem[index].status_code = (uint16_t)GET_CODE(test_res);
-    val_data_cache_ops_by_va((addr_t)&mem[index], CLEAN_AND_INVALIDATE);
+    mem = val_get_shared_address(index);
+    mem->index = index;
+    mem->state = (uint8_t)GET_STATE(test_res);
+    mem->status_code = (uint16_t)GET_CODE(test_res);
+    val_data_cache_ops_by_va((addr_t)mem, CLEAN_AND_INVALIDATE);
+
+    val_status_mark_done(index, GET_STATE(test_res) != TEST_PENDING_VAL);
 }
 
 /**
@@ -60,15 +95,16 @@ void val_set_status(uint32_t index, uint32_t test_res)
  */
 uint32_t val_get_status(uint32_t index)
 {
-    volatile val_test_status_t *mem = val_get_shared_address();
+    volatile val_test_status_t *mem;
 
     if (index >= val_pe_get_num()) {
         val_print(ERROR, "val_get_status: invalid PE index %u\n",
                   (unsigned int)index);
         return RESULT_UNKNOWN;
     }
-    val_data_cache_ops_by_va((addr_t)&mem[index], INVALIDATE);
-    return GENERATE_TEST_RESULT(mem[index].state, mem[index].status_code);
+    mem = val_get_shared_address(index);
+    val_data_cache_ops_by_va((addr_t)mem, INVALIDATE);
+    return GENERATE_TEST_RESULT(mem->state, mem->status_code);
 }
 
 /**